@@ -4,10 +4,16 @@
 
 #include "./BinarySort.h"
 #include <limits.h>
+#include <stdio.h>
+#include <sys/stat.h>
 #include <fstream>
 #include <vector>
 #include <algorithm>
 #include <string>
+#include "server/SortedRuns.h"
+
+// Number of records read or written at once by radixSortBinaryWordsFile.
+const size_t RADIX_SORT_BLOCK_SIZE = 1024 * 1024;
 // _____________________________________________________________________________
 // A Vector of this typ will sorted with stxxl::sort
 // It consists four variables of type unsigned int
@@ -93,6 +99,126 @@ void BinarySort::sortBinaryWordsFile(const string& file)
   }
 }
 // _____________________________________________________________________________
+// Writes the sorted records of radixSortBinaryWordsFile, leaving out a record
+// that is equal to the previous one if duplicates are to be removed.
+class SortedRecordsWriter
+{
+ public:
+  SortedRecordsWriter(const string& file, bool removeDuplicates)
+    : _file(file), _removeDuplicates(removeDuplicates), _nofRecords(0)
+  {
+    _out = fopen(file.c_str(), "w");
+    if (_out == NULL)
+    {
+      cerr << "File could not be open for writing: " << file << endl;
+      exit(1);
+    }
+    _records.reserve(RADIX_SORT_BLOCK_SIZE);
+  }
+
+  void add(const SortedRuns::Posting& record)
+  {
+    if (_removeDuplicates && _nofRecords > 0 && equal(record, _last)) return;
+    _last = record;
+    _nofRecords++;
+    _records.push_back(record);
+    if (_records.size() == RADIX_SORT_BLOCK_SIZE) flush();
+  }
+
+  void close()
+  {
+    flush();
+    fclose(_out);
+  }
+
+ private:
+  static bool equal(const SortedRuns::Posting& x, const SortedRuns::Posting& y)
+  {
+    return x.wordId == y.wordId && x.docId == y.docId && x.score == y.score
+           && x.position == y.position;
+  }
+
+  void flush()
+  {
+    if (_records.size() > 0 && fwrite(&_records[0], sizeof(SortedRuns::Posting),
+          _records.size(), _out) != _records.size())
+    {
+      cerr << "Could not write to file: " << _file << endl;
+      exit(1);
+    }
+    _records.clear();
+  }
+
+  string _file;
+  FILE* _out;
+  bool _removeDuplicates;
+  size_t _nofRecords;
+  SortedRuns::Posting _last;
+  std::vector<SortedRuns::Posting> _records;
+};
+// _____________________________________________________________________________
+void BinarySort::radixSortBinaryWordsFile(const string& file)
+{
+  checkFile(file);
+  struct stat buf;
+  if (stat(file.c_str(), &buf) != 0
+      || buf.st_size % sizeof(SortedRuns::Posting) != 0)
+  {
+    cerr << "Not a binary words file: " << file << endl;
+    exit(1);
+  }
+  size_t nofRecords = buf.st_size / sizeof(SortedRuns::Posting);
+  FILE* in = fopen(file.c_str(), "r");
+  std::vector<SortedRuns::Posting> records;
+  if (2 * nofRecords * sizeof(SortedRuns::Posting) <= _memoryInBytes)
+  {
+    // The records and the buffer of the sort fit into memory.
+    records.resize(nofRecords);
+    if (nofRecords > 0
+        && fread(&records[0], sizeof(SortedRuns::Posting), nofRecords, in)
+           != nofRecords)
+    {
+      cerr << "Could not read file: " << file << endl;
+      exit(1);
+    }
+    fclose(in);
+    std::vector<SortedRuns::Posting> buffer(nofRecords);
+    if (nofRecords > 0)
+      SortedRuns::sortInParallel(&records[0], nofRecords, &buffer[0],
+                                 _nofThreads);
+    buffer.clear();
+    SortedRecordsWriter writer(file, _removeDuplicates);
+    for (size_t i = 0; i < nofRecords; i++) writer.add(records[i]);
+    writer.close();
+    return;
+  }
+  // Otherwise write sorted runs and merge them.
+  string runsFile = file + ".runs";
+  {
+    SortedRunsWriter runsWriter(runsFile, _memoryInBytes, _nofThreads);
+    records.resize(RADIX_SORT_BLOCK_SIZE);
+    size_t n;
+    while ((n = fread(&records[0], sizeof(SortedRuns::Posting),
+                      RADIX_SORT_BLOCK_SIZE, in)) > 0)
+    {
+      for (size_t i = 0; i < n; i++)
+        runsWriter.add(records[i].wordId, records[i].docId, records[i].score,
+                       records[i].position);
+    }
+    fclose(in);
+    runsWriter.finish();
+  }
+  std::vector<SortedRuns::Posting>().swap(records);
+  {
+    SortedRunsReader runsReader(runsFile);
+    SortedRecordsWriter writer(file, _removeDuplicates);
+    SortedRuns::Posting record;
+    while (runsReader.next(&record)) writer.add(record);
+    writer.close();
+  }
+  remove(runsFile.c_str());
+}
+// _____________________________________________________________________________
 // This funktion schow given binary file, that consists 4*n Elements of
 // unsigned int. Out is a matrix with n lines and 4 columns
 void BinarySort::showBinaryWordsFileInAscii(const string& file)
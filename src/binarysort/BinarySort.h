@@ -32,6 +32,11 @@ using std::cerr;
 // SortBinary::sortBinaryWordsFile in SortBinary.cpp.
 // You can also see the contents of the binary file in ascii by using
 // SortBinary::schowBinaryWordsFileInAscii.
+//
+// BinarySort::radixSortBinaryWordsFile sorts the same files without stxxl:
+// with a parallel LSD radix sort (see server/SortedRuns.h) if the file fits
+// into the memory budget, and otherwise by writing sorted runs to a temporary
+// file and merging them. Duplicates are removed while writing the result.
 
 class BinarySort
 {
@@ -39,6 +44,8 @@ class BinarySort
   // Default construktor
 
   BinarySort()
+    : _removeDuplicates(false), _memoryInBytes(1024 * 1024 * 1024),
+      _nofThreads(1)
   {
   }
 
@@ -46,6 +53,10 @@ class BinarySort
   // First, second and fourth column will be sorted
   void sortBinaryWordsFile(const string& file);
 
+  // Sort binary file like sortBinaryWordsFile, but with a radix sort using at
+  // most the memory set with setMemory and the threads set with setNofThreads.
+  void radixSortBinaryWordsFile(const string& file);
+
   // Schow given binary file, that consists 4*n Elements of
   // unsigned int, in Ascii. Out is a matrix with n lines and 4 columns
   void showBinaryWordsFileInAscii(const string& file);
@@ -56,9 +67,19 @@ class BinarySort
     _removeDuplicates = value;
   }
 
+  // Memory budget and number of threads of radixSortBinaryWordsFile.
+  void setMemory(size_t memoryInBytes) { _memoryInBytes = memoryInBytes; }
+  void setNofThreads(size_t nofThreads)
+  {
+    _nofThreads = nofThreads > 0 ? nofThreads : 1;
+  }
+
  private:
   // Flag to be set that determines if duplicates are eliminated during sort
   bool _removeDuplicates;
+  // Memory budget and number of threads of radixSortBinaryWordsFile.
+  size_t _memoryInBytes;
+  size_t _nofThreads;
   // Check if file exists
   void checkFile(const string& file);
 };
@@ -44,6 +44,15 @@ void printUsage()
        << "\t--(u)nique:   if the flag is set, duplicates are removed."
        << " (default: false)."
        << endl
+       << "\t--(r)adix-sort:   sort with a parallel radix sort instead of"
+       << " stxxl (no stxxl disk needed)."
+       << endl
+       << "\t--(m)emory:       memory budget of the radix sort in MB; larger"
+       << " files are sorted in runs (default: 1024)."
+       << endl
+       << "\t--(t)hreads:      number of threads of the radix sort"
+       << " (default: 1)."
+       << endl
        << endl;
 }
 // _____________________________________________________________________________
@@ -371,6 +380,11 @@ int main(int argc, char** argv)
   // flag if duplicates should be removed
   bool unique = false;
 
+  // Whether to sort with the radix sort, and its memory and threads.
+  bool radixSort = false;
+  size_t memoryInMb = 1024;
+  size_t nofThreads = 1;
+
   // The size of stxxl disk
   int64_t stxxlDiskSize = -1;
 
@@ -388,10 +402,13 @@ int main(int argc, char** argv)
       {"stxxl-disk-file", required_argument, 0, 'd'},
       {"stxxl-disk-size", required_argument, 0, 's'},
       {"unique", no_argument, 0, 'u'},
+      {"radix-sort", no_argument, 0, 'r'},
+      {"memory", required_argument, 0, 'm'},
+      {"threads", required_argument, 0, 't'},
       {0, 0, 0, 0}
     };
 
-    optChr = getopt_long(argc, argv, "hf:p:b:d:s:u", longOptions, &optionIndex);
+    optChr = getopt_long(argc, argv, "hf:p:b:d:s:urm:t:", longOptions, &optionIndex);
 
     if (optChr == -1) break;
 
@@ -407,6 +424,19 @@ int main(int argc, char** argv)
         cout << "Enabled unique-option!" << endl;
         unique = true;
         break;
+      case 'r':
+        radixSort = true;
+        break;
+      case 'm':
+        memoryInMb = atoi(optarg);
+        cout << "Memory of radix sort:                "
+                << memoryInMb << "M" << endl;
+        break;
+      case 't':
+        nofThreads = atoi(optarg);
+        cout << "Threads of radix sort:               "
+                << nofThreads << endl;
+        break;
       case 'f':
         binaryWordsFile = string(optarg);
         cout << "Specified binary file:               "
@@ -451,7 +481,14 @@ int main(int argc, char** argv)
     }
   }
 
-  if ((path.length() == 0) && checkFile(binaryWordsFile))
+  if (radixSort && binaryWordsFile.length() == 0)
+  {
+    cerr << "wordsFile was not defined!" << endl;
+    printUsage();
+    exit(1);
+  }
+
+  if (!radixSort && (path.length() == 0) && checkFile(binaryWordsFile))
   {
     path = getPath(binaryWordsFile);
     cout << "Path for stxxl and words Files:      " << path << endl;
@@ -460,7 +497,8 @@ int main(int argc, char** argv)
   cout << endl << endl;
 
   // Wite config file for stxxl sort
-  writeSTXXLConfig(path, &binaryWordsFile, &stxxlDiskFile, stxxlDiskSize);
+  if (!radixSort)
+    writeSTXXLConfig(path, &binaryWordsFile, &stxxlDiskFile, stxxlDiskSize);
 
   if (wordsFileNameBase.length() == 0)
   {
@@ -469,14 +507,19 @@ int main(int argc, char** argv)
 
   BinarySort s;
   s.setRemoveDuplicates(unique);
+  s.setMemory(memoryInMb * 1024 * 1024);
+  s.setNofThreads(nofThreads);
   timeval start, end;
   gettimeofday(&start, 0);
 
-  // Sorting with stxxl::sort
+  // Sorting with stxxl::sort or the radix sort
   cout << "Sorting of " << binaryWordsFile << " and making "
           << wordsFileNameBase + ".words-sorted.binary"
           << "... " << flush;
-  s.sortBinaryWordsFile(binaryWordsFile);
+  if (radixSort)
+    s.radixSortBinaryWordsFile(binaryWordsFile);
+  else
+    s.sortBinaryWordsFile(binaryWordsFile);
 
   gettimeofday(&end, 0);
 
@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <time.h>
+#include <sys/time.h>
 #include <fstream>
 #include <string>
 #include "./BinarySort.h"
@@ -22,7 +23,9 @@ void printUsage()
        << "with random file and different range of numbers" << endl
        << endl
        << "2. Timetest of SortBinary::sortBinaryWordsFile with sorted file"
-       << endl;
+       << endl << endl
+       << "4. Timetest of BinarySort::radixSortBinaryWordsFile with random "
+       << "file, in memory and in runs, with 1 and 4 threads" << endl;
 }
 
 // _____________________________________________________________________________
@@ -190,6 +193,29 @@ void makeTest(unsigned numLines)
   cout << "; speed : "<< std::setw(5) << speed << " MB/sec" << endl;
 }
 
+// _____________________________________________________________________________
+// Test of BinarySort::radixSortBinaryWordsFile with created temp file
+void makeRadixTest(unsigned numLines, size_t memoryInBytes, size_t nofThreads)
+{
+  BinarySort os;
+  os.setMemory(memoryInBytes);
+  os.setNofThreads(nofThreads);
+  timeval start, end;
+
+  cout << "     Test BinarySort::radixSortBinaryWordsFile with "
+       << memoryInBytes / (1024 * 1024) << " MB and " << nofThreads
+       << " thread(s) ..." << endl;
+  gettimeofday(&start, 0);
+  os.radixSortBinaryWordsFile("BinarySortPerf.TMP.binary");
+  gettimeofday(&end, 0);
+  double time = (end.tv_sec - start.tv_sec)
+              + (end.tv_usec - start.tv_usec) / 1000000.0;
+  double speed = static_cast<double>(4 * 4 * ((numLines)
+               / (1024 * 1024))) / time;
+  cout << "      measured time : " << std::setw(4) << time << " sec";
+  cout << "; speed : "<< std::setw(5) << speed << " MB/sec" << endl;
+}
+
 // _____________________________________________________________________________
 void checkSortOrder(unsigned numLines)
 {
@@ -365,6 +391,28 @@ void perfSortBinaryWordsFile(unsigned numLines)
   {
     cout << "Could not create stxxl.disk for Test 3" << endl;
   }
+
+  cout << endl;
+  cout << "----------------------------------------------------------------"
+       << endl;
+  cout << "4. Timetest of BinarySort::radixSortBinaryWordsFile with random "
+       << "file" << endl;
+  cout << "(range 1000 as in test 1, in memory and with runs of 1/4 size)"
+       << endl;
+  cout << "----------------------------------------------------------------"
+       << endl;
+  size_t fileSize = static_cast<size_t>(numLines) * 4 * 4;
+  size_t memories[2] = { 1024 * 1024 * 1024, fileSize / 2 };
+  for (int i = 0; i < 2; i++)
+  {
+    for (size_t nofThreads = 1; nofThreads <= 4; nofThreads *= 4)
+    {
+      cout << endl;
+      makeRandomBinaryFile(numLines, 1000);
+      makeRadixTest(numLines, memories[i], nofThreads);
+      checkSortOrder(numLines);
+    }
+  }
 }
 
 // _____________________________________________________________________________
@@ -138,3 +138,42 @@ TEST(BinarySort, sortBinaryWordsFile)
   removeFile("stxxl.errlog");
 }
 
+// _____________________________________________________________________________
+TEST(BinarySort, radixSortBinaryWordsFile)
+{
+  // The same three inputs as above, sorted in memory and in runs.
+  int inputs[3][12] = { {3, 9, 1, 5, 2, 6, 9, 2, 1, 6, 0, 1},
+                        {5, 3, 1, 5, 5, 2, 9, 2, 5, 1, 0, 1},
+                        {5, 2, 1, 5, 5, 2, 9, 1, 5, 2, 0, 2} };
+  int answers[3][12] = { {1, 6, 0, 1, 2, 6, 9, 2, 3, 9, 1, 5},
+                         {5, 1, 0, 1, 5, 2, 9, 2, 5, 3, 1, 5},
+                         {5, 2, 9, 1, 5, 2, 0, 2, 5, 2, 1, 5} };
+  for (size_t memory = 32; memory <= 1024; memory *= 32)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      BinarySort bs;
+      // With 32 bytes, there is room for only one record per run.
+      bs.setMemory(memory);
+      bs.setNofThreads(2);
+      makeFile(inputs[i]);
+      bs.radixSortBinaryWordsFile("BinarySort.TMP.words-unsorted.binary");
+      ASSERT_TRUE(checkOut(answers[i], 12)) << memory << " " << i;
+    }
+  }
+
+  // Duplicates are removed while writing the result.
+  int input[12] = {5, 2, 1, 5, 1, 6, 0, 1, 5, 2, 1, 5};
+  int answer[8] = {1, 6, 0, 1, 5, 2, 1, 5};
+  for (size_t memory = 32; memory <= 1024; memory *= 32)
+  {
+    BinarySort bs;
+    bs.setRemoveDuplicates(true);
+    bs.setMemory(memory);
+    makeFile(input);
+    bs.radixSortBinaryWordsFile("BinarySort.TMP.words-unsorted.binary");
+    ASSERT_TRUE(checkOut(answer, 8)) << memory;
+  }
+  removeFile("BinarySort.TMP.words-unsorted.binary");
+}
+
@@ -71,6 +71,8 @@ void printUsage()
   << " -q, --min-frequency        minimum frequency for a frequent word" << endl
   << " -T, --build-trivial        build trivial clustering where each word is"
   << "a singleton cluster" << endl
+  << " -N, --num-threads          number of threads for building the clusters"
+      " and the index (default 1)" << endl
 
   << endl;
 }
@@ -89,6 +91,7 @@ int distanceMode = 0;
 int minimumFrequency = 500;
 int maxClustersPerFrequentWord = 1;
 int maxClustersPerInfrequentWord = 10;
+int nofThreads = 1;
 
 static enum {mode1 = 0, mode2 = 1, nofreq = 2} mode;
 const char algDesc[][17] = {"PermutedLexicon", "FastSS"};
@@ -135,10 +138,11 @@ int main(int argc, char** argv)
       {"max-infrequent"      , 0, NULL, 'i'},
       {"min-frequency"       , 0, NULL, 'q'},
       {"build-trivial"       , 0, NULL, 'T'},
+      {"num-threads"         , 1, NULL, 'N'},
       {NULL                  , 0, NULL,  0 }
     };
 
-    int c = getopt_long(argc, argv, "d:l:t:rna:s:km:cji:o:q:Tf",
+    int c = getopt_long(argc, argv, "d:l:t:rna:s:km:cji:o:q:TfN:",
         long_options, NULL);
     if (c == -1) break;
     switch (c)
@@ -159,6 +163,7 @@ int main(int argc, char** argv)
       case 'i': maxClustersPerInfrequentWord = atoi(optarg); break;
       case 'q': minimumFrequency = atoi(optarg); break;
       case 'T': buildTrivialClustering = true; break;
+      case 'N': nofThreads = atoi(optarg); break;
       case 'f': break;  // for backwards compatibility
       default : printUsage();
                 exit(1);
@@ -277,6 +282,7 @@ void startClustering(
   if (setlocale(LC_ALL, locale.c_str()) == NULL)
     locale = "ERROR setting " + locale;
   clusterBuilder.useNormalization(useNormalization);
+  clusterBuilder.setNofThreads(nofThreads);
 
   if (fuzzySearchAlgorithm < 0 || fuzzySearchAlgorithm > 1)
     fuzzySearchAlgorithm = 1;
@@ -329,6 +335,7 @@ void startClustering(
     }
   }
   assert(fsAlgorithm != NULL);
+  fsAlgorithm->setNofThreads(nofThreads);
 
   cout << endl;
   cout << "Templated version of FuzzySearch v. 2" << endl << endl;
@@ -358,6 +365,7 @@ void startClustering(
         << maxClustersPerFrequentWord << endl;
     cout << "Clusters per infr. word  : "
         << maxClustersPerInfrequentWord << endl;
+    cout << "Threads                  : " << nofThreads << endl;
   }
   else
   {
@@ -749,6 +757,7 @@ void startClustering(
         }
       }
     }
+    fsAlgorithm->setNofThreads(nofThreads);
     cout << endl;
     cout << "Generating fuzzy-search data structure for the clustering."
          << endl << endl;
@@ -19,6 +19,9 @@
 
 namespace FuzzySearch
 {
+// number of words indexed at once when building the index in parallel
+const size_t INDEX_BATCH_SIZE = 100000;
+
 using std::string;
 using std::wstring;
 using std::cout;
@@ -36,7 +39,7 @@ void FastSS<T>::index(const T& str, uint16_t beg, int depth)
   // TODO(celikik): check if it works right w.r.t filters
   if (depth == _threshold || _shortWordIndexed)
   {
-    vector<size_t>& list = _delNeigh[str];
+    vector<size_t>& list = (*_delNeigh)[str];
     // if (list.size() == 0)
     //  _totalTransformationLength += str.length();
     if (list.size() > 0)
@@ -73,7 +76,7 @@ void FastSS<T>::calcSpace(const T& str, uint16_t beg, int depth)
   // index only subseq. of length |w|-\delta
   if (depth == _threshold || _shortWordIndexed)
   {
-    vector<size_t>& list =_delNeigh[str];
+    vector<size_t>& list =(*_delNeigh)[str];
     if (list.size() == 0)
     {
       list.resize(2);
@@ -115,7 +118,7 @@ void FastSS<T>::index(const T& str, int depth)
 {
   if (str.length() == 0)
     return;
-  <Prefix>& list = _delNeigh[str];
+  <Prefix>& list = (*_delNeigh)[str];
   // if (list.size() == 0)
   //  _totalTransformationLength += str.length();
   list.push_back(_currentPrefix);
@@ -212,9 +215,12 @@ void FastSS<T>::buildIndex(const vector<T>& vocabulary, bool reserveMemory)
   _vocabulary = &vocabulary;
   _seenWords1.resize(vocabulary.size());
   _seenWords2.reserve(100000);
-  HashMap tmp;
-  _delNeigh = tmp;  // delete the old hash table
-  _delNeigh.rehash(vocabulary.size());  // NOTE(bast): was hash_map.resize
+  // a new hash table (copies made by clone keep the old one)
+  _delNeigh.reset(new HashMap());
+  _delNeigh->rehash(vocabulary.size());  // NOTE(bast): was hash_map.resize
+  _indexInParallel = _nofThreads > 1 && !reserveMemory;
+  _shards.assign(_indexInParallel ? _nofThreads : 0, HashMap());
+  _shardPointers.assign(_shards.size(), 0);
   cout << "[ Indexing started. ]" << endl;
   ProgressIndicator pi(_vocabulary->size(), 10);
 
@@ -248,10 +254,10 @@ void FastSS<T>::buildIndex(const vector<T>& vocabulary, bool reserveMemory)
       size_t wordId = getWordId(prefixes[j]);
       assert(wordId < vocabulary.size());
       const T& str = vocabulary[wordId];
-      setDynThreshold(str.length());
-      indexWord(str, prefixes[j]);
+      addToIndex(str, str.length(), prefixes[j]);
       pi.update(j);
     }
+    flushIndex(true);
     cout << " ]" << endl << flush;
   }
   else
@@ -298,17 +304,17 @@ void FastSS<T>::buildIndex(const vector<T>& vocabulary, bool reserveMemory)
       size_t wordId = getWordId(_prefixRanges[j]);
       assert(wordId < vocabulary.size());
       const T& str = vocabulary[wordId];
-      setDynThreshold(str.length());
       // if (str.length() > 8)
       //  _truncateLength = 7;
       // else
       //  _truncateLength = 6;
       if (j > 0)
         assert(_prefixRanges[j-1] != _prefixRanges[j]);
-      indexWord(str.substr(0, MY_MIN(_truncateLength, str.length())),
-          j);
+      addToIndex(str.substr(0, MY_MIN(_truncateLength, str.length())),
+          str.length(), j);
       pi.update(counter++);
     }
+    flushIndex(true);
     cout << " ]" << endl << flush;
   }
   else
@@ -364,10 +370,11 @@ void FastSS<T>::buildIndex(const vector<T>& vocabulary, bool reserveMemory)
       size_t wordId = getWordId(_prefixRanges[j]);
       assert(wordId < vocabulary.size());
       const T& str = vocabulary[wordId];
-      setDynThreshold(str.length());
-      indexWord(str.substr(0, MY_MIN(truncLen[j], str.length())), j);
+      addToIndex(str.substr(0, MY_MIN(truncLen[j], str.length())),
+          str.length(), j);
       pi.update(counter++);
     }
+    flushIndex(true);
     cout << " ]" << endl << flush;
     calculatePrefixLengths(vocabulary);
   }
@@ -390,6 +397,130 @@ void FastSS<T>::indexWord(const T& str, const PrefixRange& prefix)
   index(str, 0, 0);
 }
 
+// ____________________________________________________________________________
+template <class T>
+void FastSS<T>::addToIndex(const T& str, size_t length,
+                           const PrefixRange& prefix)
+{
+  if (!_indexInParallel)
+  {
+    setDynThreshold(length);
+    indexWord(str, prefix);
+    return;
+  }
+  _batchStrings.push_back(str);
+  _batchLengths.push_back(length);
+  _batchPrefixes.push_back(prefix);
+  if (_batchStrings.size() >= INDEX_BATCH_SIZE)
+    flushIndex(false);
+}
+
+// ____________________________________________________________________________
+template <class T>
+void FastSS<T>::flushIndex(bool last)
+{
+  if (!_indexInParallel)
+    return;
+  if (_batchStrings.size() > 0)
+  {
+    // the threshold of the last word, as after indexing the words one by one
+    setDynThreshold(_batchLengths.back());
+    _buckets.assign(_nofThreads,
+        vector<vector<pair<T, PrefixRange> > >(_nofThreads));
+    runInThreads(_nofThreads, &FastSS<T>::collectDeletionsThread, this);
+    runInThreads(_nofThreads, &FastSS<T>::insertDeletionsThread, this);
+    _batchStrings.clear();
+    _batchLengths.clear();
+    _batchPrefixes.clear();
+  }
+  if (last)
+  {
+    // each string is in exactly one shard
+    for (size_t s = 0; s < _shards.size(); s++)
+    {
+      typename HashMap::iterator it;
+      for (it = _shards[s].begin(); it != _shards[s].end(); it++)
+        (*_delNeigh)[it->first].swap(it->second);
+      _totalPointers += _shardPointers[s];
+    }
+    _shards.clear();
+    _shardPointers.clear();
+    _buckets.clear();
+    _indexInParallel = false;
+  }
+}
+
+// ____________________________________________________________________________
+template <class T>
+void FastSS<T>::collectDeletionsThread(size_t t, void* fastSS)
+{
+  FastSS<T>* self = static_cast<FastSS<T>*>(fastSS);
+  size_t nofThreads = self->_nofThreads;
+  size_t n = self->_batchStrings.size();
+  vector<vector<pair<T, PrefixRange> > >& buckets = self->_buckets[t];
+  StringHash<T> hash;
+  vector<T> deletions;
+  for (size_t u = t * n / nofThreads; u < (t + 1) * n / nofThreads; u++)
+  {
+    const T& str = self->_batchStrings[u];
+    deletions.clear();
+    self->collectDeletions(str, 0, 0,
+        self->dynThreshold(self->_batchLengths[u]),
+        str.length() < self->_truncateLength, &deletions);
+    for (size_t i = 0; i < deletions.size(); i++)
+      buckets[hash(deletions[i]) % nofThreads].push_back(
+          std::make_pair(deletions[i], self->_batchPrefixes[u]));
+  }
+}
+
+// ____________________________________________________________________________
+template <class T>
+void FastSS<T>::insertDeletionsThread(size_t s, void* fastSS)
+{
+  FastSS<T>* self = static_cast<FastSS<T>*>(fastSS);
+  HashMap& shard = self->_shards[s];
+  // the threads collected consecutive words, so going through their buckets
+  // in order gives the same lists as indexing the words one by one
+  for (size_t t = 0; t < self->_buckets.size(); t++)
+  {
+    vector<pair<T, PrefixRange> >& bucket = self->_buckets[t][s];
+    for (size_t i = 0; i < bucket.size(); i++)
+    {
+      vector<size_t>& list = shard[bucket[i].first];
+      if (list.size() == 0 || list.back() != bucket[i].second)
+        list.push_back(bucket[i].second);
+    }
+    self->_shardPointers[s] += bucket.size();
+    vector<pair<T, PrefixRange> >().swap(bucket);
+  }
+}
+
+// ____________________________________________________________________________
+template <class T>
+void FastSS<T>::collectDeletions(const T& str, uint16_t beg, int depth,
+                                 double threshold, bool shortWord,
+                                 vector<T>* deletions) const
+{
+  if (str.length() == 0)
+    return;
+  if (depth == threshold || shortWord)
+    deletions->push_back(str);
+  if (depth >= threshold)
+    return;
+  for (int i = beg; i < static_cast<int>(str.length()); i++)
+  {
+    T tempStr;
+    tempStr.resize(str.length() - 1);
+    int counter = 0;
+    for (int j = 0; j < static_cast<int>(str.length()); j++)
+    {
+      if (j != i)
+        tempStr[counter++] = str[j];
+    }
+    collectDeletions(tempStr, i, depth + 1, threshold, shortWord, deletions);
+  }
+}
+
 // ____________________________________________________________________________
 template <class T>
 void FastSS<T>::indexWord1(const T& str, const PrefixRange& prefix)
@@ -425,7 +556,7 @@ void FastSS<T>::findClosestWords(const T& query,
 {
   closestWordsIds->clear();
   distances->clear();
-  if (_delNeigh.size() == 0)
+  if (_delNeigh->size() == 0)
     return;
   _matches.clear();
   for (size_t i = 0; i < _seenWords2.size(); i++)
@@ -515,9 +646,11 @@ void FastSS<T>::findMatches(const T& str, uint16_t beg, int depth)
 {
   if (str.length() == 0)
     return;
-  if (_delNeigh.count(str) > 0)
+  // only find, since copies made by clone search the same hash table
+  typename HashMap::const_iterator found = _delNeigh->find(str);
+  if (found != _delNeigh->end())
   {
-    vector<size_t>& postingList = _delNeigh[str];
+    const vector<size_t>& postingList = found->second;
     double d = 0;
     if (_mode == FASTSS_COMPLETION_MATCHING)
     {
@@ -841,13 +974,13 @@ void FastSS<T>::saveDataStructureToFile(const string& filename)
   fprintf(outputFile, "1\n%f\n%d\n%d\n%d\n%d\n%u\n",
       _threshold,
       static_cast<int>((*_vocabulary).size()),
-      static_cast<int>(_delNeigh.size()),
+      static_cast<int>(_delNeigh->size()),
       static_cast<int>(_prefixRanges.size()),
       _mode,
       _truncateLength);
   FastSS<T>::saveTheLexiconPart(outputFile, (*_vocabulary));
   typename HashMap::const_iterator it;
-  for (it = _delNeigh.begin(); it != _delNeigh.end(); it++)
+  for (it = _delNeigh->begin(); it != _delNeigh->end(); it++)
   {
     writeLine(outputFile, it->first);
     fprintf(outputFile, "%zu ", it->second.size());
@@ -905,8 +1038,8 @@ void FastSS<T>::loadDataStructureFromFile(
   sstr << buff;
   sstr >> intValue;
   size_t nofTransformation = intValue;
-  _delNeigh.clear();
-  _delNeigh.rehash(nofTransformation);  // NOTE(bast): was hash_map.resize
+  _delNeigh.reset(new HashMap());
+  _delNeigh->rehash(nofTransformation);  // NOTE(bast): was hash_map.resize
   assert(fgets(buff, MAX_LENGTH + 2, fin) != NULL);
   sstr << buff;
   sstr >> intValue;
@@ -929,7 +1062,7 @@ void FastSS<T>::loadDataStructureFromFile(
   std::cout << vocabulary->size() << " words read." << std::endl;
 
   // 2. read the (truncated) deletion neighborhood index
-  _delNeigh.clear();
+  _delNeigh->clear();
   for (uint32_t i = 0; i < nofTransformation; i++)
   {
     FastSS<T>::readLine(fin, &stringValue, false);
@@ -939,7 +1072,7 @@ void FastSS<T>::loadDataStructureFromFile(
           "index. Line too long!" << endl;
       exit(1);
     }
-    vector<size_t>& list = _delNeigh[stringValue];
+    vector<size_t>& list = (*_delNeigh)[stringValue];
     assert(fgets(buff, MAX_LENGTH + 2, fin) != NULL);
     std::stringstream sstr;
     sstr << buff;
@@ -969,7 +1102,7 @@ void FastSS<T>::loadDataStructureFromFile(
   _seenWords2.reserve(100000);
   if (_mode == FASTSS_COMPLETION_MATCHING)
     calculatePrefixLengths(*vocabulary);
-  cout << endl << "* " << vocabulary->size() << " words, "<< _delNeigh.size()
+  cout << endl << "* " << vocabulary->size() << " words, "<< _delNeigh->size()
        << " subsequences, " << _prefixRanges.size()
        << " prefix ranges." << endl;
 }
@@ -13,6 +13,7 @@
 #include <google/sparse_hash_map>
 #include <google/dense_hash_map>
 #include <unordered_map>
+#include <memory>
 // #include <ext/hash_map>
 // #include <hash_map>
 // using __gnu_cxx::hash_map;
@@ -63,6 +64,27 @@ class FastSS : public FuzzySearchAlgorithm<T>
   // recursively find matches
   void findMatches(const T& str, uint16_t, int depth);
 
+  // index the given (possibly truncated) word with the threshold for a word
+  // of the given length. When indexing in parallel, the word is only
+  // collected, and indexed together with others in flushIndex
+  void addToIndex(const T& str, size_t length, const PrefixRange& prefix);
+
+  // index the words collected by addToIndex in parallel: each thread collects
+  // the deletion neighborhoods of a part of the words, then each thread
+  // inserts the strings of one shard (by hash value) into its own hash table.
+  // If last is true, move the shards into _delNeigh afterwards
+  void flushIndex(bool last);
+
+  // the two parallel steps of flushIndex (for thread i and this object)
+  static void collectDeletionsThread(size_t i, void* fastSS);
+  static void insertDeletionsThread(size_t i, void* fastSS);
+
+  // append the strings that index(str, beg, depth) would index with the given
+  // threshold and _shortWordIndexed = shortWord to deletions
+  void collectDeletions(const T& str, uint16_t beg, int depth,
+                        double threshold, bool shortWord,
+                        vector<T>* deletions) const;
+
   // reserve memory for the word-id pointers
   size_t reserveMemory()
   {
@@ -70,7 +92,7 @@ class FastSS : public FuzzySearchAlgorithm<T>
     size_t totalPointers = 0;
     // size_t totalWordIds = 0;
     size_t oneElLists = 0;
-    for (it = _delNeigh.begin(); it != _delNeigh.end(); it++)
+    for (it = _delNeigh->begin(); it != _delNeigh->end(); it++)
     {
       off_t size = it->second[0];
       // totalWordIds += it->second[1];
@@ -82,9 +104,9 @@ class FastSS : public FuzzySearchAlgorithm<T>
     }
     std::cout << " [ " << totalPointers << " pointers (" << oneElLists
          << " lists with single pointer, avg: "
-         << 1.0 * totalPointers / _delNeigh.size() << "), "
+         << 1.0 * totalPointers / _delNeigh->size() << "), "
          << _totalTransformationLength << " raw hash table size, "
-         << _delNeigh.size() << " hash entries ]" << std::endl;
+         << _delNeigh->size() << " hash entries ]" << std::endl;
     // std::cout << totalWordIds << " total word ids" << std::endl;
     return totalPointers;
   }
@@ -92,19 +114,25 @@ class FastSS : public FuzzySearchAlgorithm<T>
   // Set the threshold depending on the length of the current word being
   // indexed. If fixed threshold is used then use that value
   void setDynThreshold(size_t length)
+  {
+    _threshold = dynThreshold(length);
+  }
+
+  // the threshold set by setDynThreshold
+  double dynThreshold(size_t length) const
   {
     if (_fixedThreshold < 0)
     {
       if (length >= 11)
-        _threshold = 3;
+        return 3;
       else
       if (length > 5)
-        _threshold = 2;
+        return 2;
       else
-        _threshold = 1;
+        return 1;
     }
     else
-      _threshold = _fixedThreshold;
+      return _fixedThreshold;
   }
 
   // computes the prefix lengths of consecutive strings in the input vocabulary
@@ -183,8 +211,28 @@ class FastSS : public FuzzySearchAlgorithm<T>
   // used hash map type for the deletion neighborhoods
   typedef std::unordered_map<T, vector<size_t>, StringHash<T> > HashMap;
 
-  // hash table containing the deletion neighborhoods
-  HashMap _delNeigh;  // NOLINT
+  // hash table containing the deletion neighborhoods (shared with the copies
+  // made by clone)
+  std::shared_ptr<HashMap> _delNeigh;  // NOLINT
+
+  // number of threads used by buildIndex
+  size_t _nofThreads;
+
+  // whether buildIndex currently indexes in parallel, see addToIndex
+  bool _indexInParallel;
+
+  // the words collected by addToIndex: the (truncated) strings, the lengths
+  // of the full words, and the prefix ranges
+  vector<T> _batchStrings;
+  vector<size_t> _batchLengths;
+  vector<PrefixRange> _batchPrefixes;
+
+  // the strings collected by each thread in flushIndex, by shard
+  vector<vector<vector<pair<T, PrefixRange> > > > _buckets;
+
+  // the parts of the index built in parallel, and their number of pointers
+  vector<HashMap> _shards;
+  vector<size_t> _shardPointers;
 
   // needed for packing word-id and number of consecutive words
   // with equal prefixes into a single uint
@@ -227,20 +275,34 @@ class FastSS : public FuzzySearchAlgorithm<T>
 
   // the default constructor
   FastSS()
+    : _delNeigh(new HashMap()), _nofThreads(1), _indexInParallel(false)
   {
     init(2, 0, 7);
   }
 
   FastSS(int16_t mode, double threshold)
+    : _delNeigh(new HashMap()), _nofThreads(1), _indexInParallel(false)
   {
     init(mode, threshold, 7);
   }
 
   FastSS(int16_t mode, double threshold, int truncLength)
+    : _delNeigh(new HashMap()), _nofThreads(1), _indexInParallel(false)
   {
     init(mode, threshold, truncLength);
   }
 
+  // a copy for searching in another thread; it shares the deletion
+  // neighborhood index with this object
+  FuzzySearchAlgorithm<T>* clone() const { return new FastSS<T>(*this); }
+
+  // sets the number of threads used by buildIndex (the index is the same for
+  // any number of threads)
+  virtual void setNofThreads(size_t nofThreads)
+  {
+    _nofThreads = nofThreads > 0 ? nofThreads : 1;
+  }
+
   // initialize important stuff of the object
   void init(int16_t mode, double threshold, int truncLength)
   {
@@ -41,6 +41,10 @@ class FuzzySearchAlgorithm
     // build the fuzzy search index
     virtual void buildIndex(const vector<T>& vocabulary, bool reserved) = 0;
 
+    // set the number of threads used by buildIndex (ignored by algorithms
+    // that build their index with one thread)
+    virtual void setNofThreads(size_t nofThreads) {}
+
     // save the vocabulary and the index to disk
     virtual void saveDataStructureToFile(const string& filename) = 0;
 
@@ -107,6 +111,11 @@ class FuzzySearchAlgorithm
     // if word matching
     bool completionMatching() { return _isCompletionDistanceUsed; }
 
+    // returns a copy of this object (with its index) that can be used for
+    // findClosestWords in another thread, or NULL if that is not supported.
+    // The caller owns the copy.
+    virtual FuzzySearchAlgorithm<T>* clone() const { return NULL; }
+
     // virtual destructor
     virtual ~FuzzySearchAlgorithm() {}
 
@@ -589,6 +589,72 @@ TEST(FuzzySearchTest, FastSS_words_1)
   ASSERT_FALSE(isInLexicon);
 }
 
+// test that building the FastSS index and the word clustering with several
+// threads gives the same result as with one thread
+TEST(FuzzySearchTest, WordClustering_threads)
+{
+  vector<string> vocabulary;
+  vector<int> frequencies;
+  const char* stems[] = { "algorithm", "complexity", "variant", "graph" };
+  for (size_t i = 0; i < 4; i++)
+  {
+    string stem = stems[i];
+    for (size_t j = 0; j < stem.length(); j++)
+    {
+      vocabulary.push_back(stem.substr(0, j) + stem.substr(j + 1));
+      vocabulary.push_back(stem.substr(0, j) + "x" + stem.substr(j));
+    }
+  }
+  std::sort(vocabulary.begin(), vocabulary.end());
+  vocabulary.erase(std::unique(vocabulary.begin(), vocabulary.end()),
+      vocabulary.end());
+  frequencies.resize(vocabulary.size(), 1);
+  // the frequent words (the cluster centers) come last
+  for (size_t i = 0; i < 4; i++)
+  {
+    vocabulary.push_back(stems[i]);
+    frequencies.push_back(100);
+  }
+  vector<string> clusterCenters;
+  vector<int> frequencyCentroids;
+  WordClusteringBuilder<string> clusterBuilder;
+  clusterBuilder.pickClusterCenters(vocabulary, frequencies, 100,
+      &clusterCenters, &frequencyCentroids);
+
+  vector<vector<int> > expectedClusters;
+  vector<int> expectedIds;
+  vector<double> expectedDist;
+  bool isInLexicon;
+  for (size_t nofThreads = 1; nofThreads <= 3; nofThreads += 2)
+  {
+    FastSS<string> fastss(2, 1);
+    fastss.setFixedThreshold(2);
+    fastss.setNofThreads(nofThreads);
+    fastss.buildIndex(vocabulary, false);
+    vector<int> similarWordIds;
+    vector<double> dist;
+    fastss.findClosestWords("algorithm", vocabulary, vocabulary, &isInLexicon,
+        &similarWordIds, &dist);
+    clusterBuilder.setNofThreads(nofThreads);
+    vector<vector<int> > clusters;
+    vector<int> unclusteredWordIds;
+    clusterBuilder.buildWordClustering(vocabulary, clusterCenters,
+        frequencies, fastss, 10, false, &clusters, &unclusteredWordIds);
+    if (nofThreads == 1)
+    {
+      ASSERT_LT(0u, similarWordIds.size());
+      ASSERT_LT(0u, clusters.size());
+      expectedIds = similarWordIds;
+      expectedDist = dist;
+      expectedClusters = clusters;
+      continue;
+    }
+    ASSERT_EQ(expectedIds, similarWordIds);
+    ASSERT_EQ(expectedDist, dist);
+    ASSERT_EQ(expectedClusters, clusters);
+  }
+}
+
 int main(int argc, char** argv)
 {
   cout << "----------------" << endl;
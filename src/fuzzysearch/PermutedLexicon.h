@@ -72,6 +72,13 @@ class PermutedLexicon : public FuzzySearchAlgorithm<T>
     // build the fuzzy search index
     void buildIndex(const vector<T>& vocabulary, bool reserved);
 
+    // a copy for searching in another thread (with its own copy of the
+    // permuted lexicon)
+    FuzzySearchAlgorithm<T>* clone() const
+    {
+      return new PermutedLexicon<T>(*this);
+    }
+
     // save the vocabulary and the index to disk
     void saveDataStructureToFile(const string& filename);
 
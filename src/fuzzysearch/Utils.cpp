@@ -2,6 +2,7 @@
 // Structures.
 // Authors: Marjan Celikik <celikik>
 
+#include <pthread.h>
 #include <string.h>
 #include <string>
 #include "../fuzzysearch/Utils.h"
@@ -89,5 +90,44 @@ bool isStrictPrefix(const string& s1, const string& s2)
       return false;
   return true;
 }
+
+// ____________________________________________________________________________
+// the arguments of one thread of runInThreads
+struct ThreadCall
+{
+  void (*function)(size_t, void*);
+  size_t i;
+  void* arg;
+};
+
+// ____________________________________________________________________________
+void* runThreadCall(void* call)
+{
+  ThreadCall* c = static_cast<ThreadCall*>(call);
+  c->function(c->i, c->arg);
+  return NULL;
+}
+
+// ____________________________________________________________________________
+void runInThreads(size_t nofThreads, void (*function)(size_t, void*),
+                  void* arg)
+{
+  if (nofThreads <= 1)
+  {
+    function(0, arg);
+    return;
+  }
+  vector<ThreadCall> calls(nofThreads);
+  vector<pthread_t> threads(nofThreads);
+  for (size_t i = 0; i < nofThreads; i++)
+  {
+    calls[i].function = function;
+    calls[i].i = i;
+    calls[i].arg = arg;
+    pthread_create(&threads[i], NULL, &runThreadCall, &calls[i]);
+  }
+  for (size_t i = 0; i < nofThreads; i++)
+    pthread_join(threads[i], NULL);
+}
 }
 
@@ -96,6 +96,11 @@ bool wstring2string(const wstring& wstr, string* str);
 // but not algo and algo.
 bool isStrictPrefix(const string& s1, const string& s2);
 
+// call function(i, arg) for i = 0, ..., nofThreads - 1, each in its own
+// thread (directly if nofThreads is 1), and wait until all calls are done
+void runInThreads(size_t nofThreads, void (*function)(size_t, void*),
+                  void* arg);
+
 // Class used for fast % (modulo) calculation
 class Mod
 {
@@ -26,6 +26,101 @@ using std::fstream;
 template <class T>
 size_t WordClusteringBuilder<T>::totalNumberOfOccurences;
 
+// number of cluster centroids for which the closest words are computed at
+// once (in parallel)
+const size_t CLUSTERING_BATCH_SIZE = 10000;
+
+// ____________________________________________________________________________
+// the arguments of findClosestWordsInParallel, for each thread
+template <class T>
+class ClosestWordsTask
+{
+  public:
+    const vector<FuzzySearchAlgorithm<T>*>* searchers;
+    const vector<T>* vocabulary;
+    const vector<T>* centers;
+    size_t begin;
+    size_t end;
+    int prefixLength;
+    vector<vector<int> >* closestWords;
+    vector<vector<double> >* distances;
+};
+
+// ____________________________________________________________________________
+// thread i of findClosestWordsInParallel handles every i-th centroid
+template <class T>
+static void closestWordsThread(size_t i, void* arg)
+{
+  ClosestWordsTask<T>* task = static_cast<ClosestWordsTask<T>*>(arg);
+  FuzzySearchAlgorithm<T>* fsAlg = (*task->searchers)[i];
+  size_t nofThreads = task->searchers->size();
+  for (size_t j = task->begin + i; j < task->end; j += nofThreads)
+  {
+    const T& center = (*task->centers)[j];
+    T prefix = center.substr(0, MY_MIN(task->prefixLength,
+        static_cast<int>(center.length())));
+    fsAlg->findClosestWords(prefix,
+                            *task->vocabulary,
+                            *task->vocabulary,
+                            NULL,
+                            &(*task->closestWords)[j - task->begin],
+                            &(*task->distances)[j - task->begin]);
+  }
+}
+
+// ____________________________________________________________________________
+template <class T>
+void WordClusteringBuilder<T>::createSearchers(
+                                FuzzySearchAlgorithm<T>& fsAlg,
+                                vector<FuzzySearchAlgorithm<T>*>* searchers)
+{
+  searchers->clear();
+  searchers->push_back(&fsAlg);
+  for (size_t i = 1; i < _nofThreads; i++)
+  {
+    FuzzySearchAlgorithm<T>* copy = fsAlg.clone();
+    if (copy == NULL)
+      break;
+    searchers->push_back(copy);
+  }
+}
+
+// ____________________________________________________________________________
+template <class T>
+void WordClusteringBuilder<T>::deleteSearchers(
+                                vector<FuzzySearchAlgorithm<T>*>* searchers)
+{
+  for (size_t i = 1; i < searchers->size(); i++)
+    delete (*searchers)[i];
+  searchers->clear();
+}
+
+// ____________________________________________________________________________
+template <class T>
+void WordClusteringBuilder<T>::findClosestWordsInParallel(
+                              const vector<FuzzySearchAlgorithm<T>*>& searchers,
+                              const vector<T>& vocabulary,
+                              const vector<T>& centers,
+                              size_t begin,
+                              size_t end,
+                              int prefixLength,
+                              vector<vector<int> >* closestWords,
+                              vector<vector<double> >* distances)
+{
+  closestWords->resize(end - begin);
+  distances->resize(end - begin);
+  ClosestWordsTask<T> task;
+  task.searchers = &searchers;
+  task.vocabulary = &vocabulary;
+  task.centers = &centers;
+  task.begin = begin;
+  task.end = end;
+  task.prefixLength = prefixLength;
+  task.closestWords = closestWords;
+  task.distances = distances;
+  runInThreads(searchers.size(), &closestWordsThread<T>, &task);
+}
+
 // ____________________________________________________________________________
 template <class T>
 static bool orderByFirstCoord(const pair<T, int>& x,
@@ -1535,18 +1630,23 @@ void WordClusteringBuilder<T>::buildWordClustering(
   unsigned int nofSimilarWords;
   unsigned int totalNofClusters = 0;  // vocabulary.size();
   size_t spaceOverhead = 0;
+  vector<FuzzySearchAlgorithm<T>*> searchers;
+  vector<vector<int> > batchClosestWords;
+  vector<vector<double> > batchDistances;
+  createSearchers(fsAlg, &searchers);
 
   // 2.a the main loop for the clustering (goes for all words in the vocab.)
   nofClusteredWords = clusterCenters.size();
   for (size_t i = 0; i < clusterCenters.size(); i++)  // actual clustering
   {
-    // find the closest cluster words of a cluster centroid
-    fsAlg.findClosestWords(clusterCenters[i],
-                           vocabulary,
-                           vocabulary,
-                           NULL,
-                           &closestWords,
-                           &distances);
+    // find the closest cluster words of a cluster centroid (for the next
+    // batch of centroids at once, in parallel)
+    if (i % CLUSTERING_BATCH_SIZE == 0)
+      findClosestWordsInParallel(searchers, vocabulary, clusterCenters, i,
+          MY_MIN(i + CLUSTERING_BATCH_SIZE, clusterCenters.size()), INT_MAX,
+          &batchClosestWords, &batchDistances);
+    closestWords.swap(batchClosestWords[i % CLUSTERING_BATCH_SIZE]);
+    distances.swap(batchDistances[i % CLUSTERING_BATCH_SIZE]);
     nofSimilarWords = closestWords.size();
 
     // 2.b put the current word into the (selected) clusters
@@ -1592,6 +1692,7 @@ void WordClusteringBuilder<T>::buildWordClustering(
     }
     // progressIndicator.update(i);
   }
+  deleteSearchers(&searchers);
   for (size_t i = 0; i < vocabulary.size(); i++)
     if (clusterCounts[i] == 0 && unclusteredWords != NULL)
       unclusteredWords->push_back(i);
@@ -1670,6 +1771,10 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
   vector<int16_t> counts;
   counts.resize(vocabulary.size());
   ProgressIndicator progressIndicator(clusterCenters.size(), 10);
+  vector<FuzzySearchAlgorithm<T>*> searchers;
+  vector<vector<int> > batchClosestWords;
+  vector<vector<double> > batchDistances;
+  createSearchers(fsAlg, &searchers);
 
   // 3. do the actual cluster building
   // 3.a the main loop for the clustering (goes for all words in the vocab.)
@@ -1679,15 +1784,14 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
   {
     if (true)
     {
-      // find the closest cluster centroids of a prefix
-      T prefix = clusterCenters[i].substr(0, MY_MIN(prefixLength,
-          static_cast<int>(clusterCenters[i].length())));
-      fsAlg.findClosestWords(prefix,
-                             vocabulary,
-                             vocabulary,
-                             NULL,
-                             &closestClusters,
-                             &distances);
+      // find the closest cluster centroids of a prefix (for the next batch
+      // of centroids at once, in parallel)
+      if (i % CLUSTERING_BATCH_SIZE == 0)
+        findClosestWordsInParallel(searchers, vocabulary, clusterCenters, i,
+            MY_MIN(i + CLUSTERING_BATCH_SIZE, clusterCenters.size()),
+            prefixLength, &batchClosestWords, &batchDistances);
+      closestClusters.swap(batchClosestWords[i % CLUSTERING_BATCH_SIZE]);
+      distances.swap(batchDistances[i % CLUSTERING_BATCH_SIZE]);
       totalNofClusters += closestClusters.size();
 
       // 3.b put the current word into the (selected) clusters
@@ -1714,6 +1818,7 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
     }
     progressIndicator.update(i);
   }
+  deleteSearchers(&searchers);
   if (unclusteredWords != NULL)
   {
     unclusteredWords->clear();
@@ -1804,6 +1909,7 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
   vector<int> mapping;
   FastSS<T> fsAlg(3, 0);
   fsAlg.setFixedThreshold(1);
+  fsAlg.setNofThreads(_nofThreads);
 
   // 1. separate cluster centroids from non-cluster centroids in the vocabulary
   // and build a f.s. index on this vocabulary
@@ -1884,20 +1990,23 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
   Timer timer;
   timer.start();
   size_t counter = 0;
+  vector<FuzzySearchAlgorithm<T>*> searchers;
+  vector<vector<int> > batchClosestWords;
+  vector<vector<double> > batchDistances;
+  createSearchers(fsAlg, &searchers);
   for (size_t i = 0; i < clusterCenters.size(); i++)  // actual clustering
   {
     for (size_t k = 0; k < clusterCenters[i].size(); k++)  // actual clustering
     {
       nofClosestWords = 0;
-      // find the closest cluster centroids of a prefix
-      T prefix = clusterCenters[i][k].substr(0, MY_MIN(prefixLength,
-          static_cast<int>(clusterCenters[i][k].length())));
-      fsAlg.findClosestWords(prefix,
-                             vocabulary,
-                             vocabulary,
-                             NULL,
-                             &closestWords,
-                             &distances);
+      // find the closest cluster centroids of a prefix (for the next batch
+      // of centroids at once, in parallel)
+      if (k % CLUSTERING_BATCH_SIZE == 0)
+        findClosestWordsInParallel(searchers, vocabulary, clusterCenters[i],
+            k, MY_MIN(k + CLUSTERING_BATCH_SIZE, clusterCenters[i].size()),
+            prefixLength, &batchClosestWords, &batchDistances);
+      closestWords.swap(batchClosestWords[k % CLUSTERING_BATCH_SIZE]);
+      distances.swap(batchDistances[k % CLUSTERING_BATCH_SIZE]);
       nofClosestWords = closestWords.size();
 
       // cout << "! "; printStr(prefix); cout << endl;
@@ -1946,6 +2055,7 @@ void WordClusteringBuilder<T>::buildCompletionClustering(
       seenIds.clear();
     }
   }
+  deleteSearchers(&searchers);
   if (unclusteredWords != NULL && unclusteredFreq != NULL)
   {
     unclusteredWords->clear();
@@ -31,6 +31,16 @@ class WordClusteringBuilder
 
   static enum { ISO_8859_1 = 0, UTF_8 = 1 } encoding;
 
+  // default constructor
+  WordClusteringBuilder() : _nofThreads(1) {}
+
+  // Set the number of threads used to find the closest words of the cluster
+  // centroids (the clusters are the same for any number of threads)
+  void setNofThreads(size_t nofThreads)
+  {
+    _nofThreads = nofThreads > 0 ? nofThreads : 1;
+  }
+
   // build clusters for fuzzy word matching
   void buildWordClusteringOld(const vector<T>& vocabulary,
                            const vector<T>& clusterCenters,
@@ -294,6 +304,28 @@ class WordClusteringBuilder
 
   private:
 
+    // the given algorithm and up to _nofThreads - 1 copies of it made with
+    // clone (none if the algorithm cannot be copied)
+    void createSearchers(FuzzySearchAlgorithm<T>& fsAlg,
+                         vector<FuzzySearchAlgorithm<T>*>* searchers);
+
+    // delete the copies made by createSearchers
+    static void deleteSearchers(vector<FuzzySearchAlgorithm<T>*>* searchers);
+
+    // find the closest words (and their distances) of the prefixes of the
+    // given length of centers[begin], ..., centers[end - 1], with one thread
+    // per searcher. The result for centers[begin + i] is in (*closestWords)[i]
+    // and (*distances)[i]
+    static void findClosestWordsInParallel(
+        const vector<FuzzySearchAlgorithm<T>*>& searchers,
+        const vector<T>& vocabulary,
+        const vector<T>& centers,
+        size_t begin,
+        size_t end,
+        int prefixLength,
+        vector<vector<int> >* closestWords,
+        vector<vector<double> >* distances);
+
     // populate the stop-words
     static void getStopWords(
         std::unordered_map<string, bool, StringHashFunction>* hashMap);
@@ -342,6 +374,9 @@ class WordClusteringBuilder
     // needed for buildClusters - min freq. to be considered for the frequency
     // grpups in buildClusters; TODO(celikik): is this really needed?
     int _minimumFrequency;
+
+    // number of threads for finding the closest words of the centroids
+    size_t _nofThreads;
 };
 }
 
@@ -45,6 +45,7 @@ class CsvField
     _name = "";
     _format = TEXT;
     _multipleItemsAllowed = false;
+    _docValues = false;
   }
 
   // Getter.
@@ -70,6 +71,7 @@ class CsvField
   bool getOrderingLiteral() const { return _order_literal; }
   bool getOrderingPrecision() const { return _order_precision; }
   Precision getPrecision() const { return _precision; }
+  bool getDocValues() const { return _docValues; }
 
   // Setter.
   void setName(const string& value) { _name = value; }
@@ -180,6 +182,13 @@ class CsvField
       _multipleItemsAllowed = false;
   }
 
+  void setDocValues(const string& value)
+  {
+    if (value.compare("true") == 0) _docValues = true;
+    else
+      _docValues = false;
+  }
+
   // TODO(bast): drop requirement that argument needs to be of length 3.
   // TODO(bast): Add a test for this and other non-trivial functions in this
   // class. Check also in CsvParserOptions.{h,cpp}.
@@ -214,6 +223,7 @@ class CsvField
   bool _order_literal;
   bool _order_precision;
   Precision _precision;
+  bool _docValues;
 };
 
 typedef void (CsvField::*CsvFieldSetter)(const string& value);
@@ -3,7 +3,9 @@
 // Authors: Jens Hoffmann <hoffmaje>, Hannah Bast <bast>.
 
 #include <errno.h>
+#include <pthread.h>
 #include <time.h>
+#include <algorithm>
 #include <iomanip>
 #include <utility>
 #include <vector>
@@ -17,7 +19,8 @@ using std::endl;
 using std::flush;
 
 // _____________________________________________________________________________
-CsvParser::CsvParser() : ParserBase()
+CsvParser::CsvParser() : ParserBase(), _chunkOutput(NULL),
+  _excerptOffset(string::npos)
 {
 }
 
@@ -137,6 +140,14 @@ void CsvParser::writeConcatToWordsFile(const string& field,
 
     // And write the word to <basename>.words file.
     ParserBase::writeToWordsFile(wordToIndex, docID, score, _position);
+    if (_excerptOffset != string::npos)
+    {
+      char positionOffset[64];
+      snprintf(positionOffset, sizeof(positionOffset), "%s%zu:%zu:%zu",
+               _positionOffsets.empty() ? "" : ",", _position,
+               _excerptOffset + wordStart, wordEnd - wordStart);
+      _positionOffsets += positionOffset;
+    }
     ++_position;
   }
 }
@@ -516,6 +527,7 @@ void CsvParser::writeFieldItemToWordsFile(unsigned docID, unsigned colID,
   {
     fieldItem = new string(fieldItem->substr(1));
     facetAllowed = false;
+    if (_excerptOffset != string::npos) ++_excerptOffset;
   }
 
   // Option fulltext set?
@@ -525,6 +537,8 @@ void CsvParser::writeFieldItemToWordsFile(unsigned docID, unsigned colID,
                              docID,
                              csvField.getScore());
   }
+  // Only the offsets of the full-text words are written to the docs file.
+  _excerptOffset = string::npos;
 
   // Option phrase completion set?
   if (csvField.getPhraseCompletion())
@@ -578,6 +592,8 @@ void CsvParser::writeFieldItemToWordsFile(unsigned docID, unsigned colID,
                             csvField.getName(),
                             docID,
                             csvField.getScore());
+      if (_options.writeFacetIndex())
+        addFacetIndexValue(docID, colID, *fieldItem);
     }
     else
     {
@@ -628,6 +644,164 @@ void CsvParser::writeFieldItemToWordsFile(unsigned docID, unsigned colID,
                                        csvField.getScore(),
                                        csvField.getPrecision());
   }
+
+  // Option doc values set?
+  if (csvField.getDocValues())
+  {
+    addDocValue(docID, colID, *fieldItem);
+  }
+}
+
+
+// _____________________________________________________________________________
+uint32_t CsvParser::docValueOf(const string& field, const CsvField& csvField)
+{
+  uint64_t value = 0;
+  if (csvField.getOrderingDate())
+  {
+    // Same format check as in writeOrderingDateToWordsFile.
+    string date = _stringConverter.convertDate(field);
+    if (date.size() != 10 || date[2] != '-' || date[5] != '-')
+      return DocValues::NO_VALUE;
+    string digits = date.substr(6, 4) + date.substr(3, 2) + date.substr(0, 2);
+    for (size_t i = 0; i < digits.size(); i++)
+    {
+      if (!isdigit(digits[i])) return DocValues::NO_VALUE;
+      value = 10 * value + (digits[i] - '0');
+    }
+    return value;
+  }
+
+  // Skip everything before the first digit (e.g. a currency symbol).
+  size_t pos = 0;
+  while (pos < field.size() && !isdigit(field[pos])) ++pos;
+  if (pos == field.size()) return DocValues::NO_VALUE;
+  while (pos < field.size() && isdigit(field[pos]))
+  {
+    value = 10 * value + (field[pos++] - '0');
+    if (value >= DocValues::NO_VALUE) return DocValues::NO_VALUE;
+  }
+  if (csvField.getOrderingPrecision())
+  {
+    // Append exactly precision.second decimal digits, like in
+    // writeOrderingPrecisionToWordsFile.
+    size_t nofDecimals = csvField.getPrecision().second;
+    bool hasDecimals = pos + 1 < field.size()
+                       && (field[pos] == '.' || field[pos] == ',');
+    if (hasDecimals) ++pos;
+    for (size_t i = 0; i < nofDecimals; i++)
+    {
+      int digit = 0;
+      if (hasDecimals && pos < field.size() && isdigit(field[pos]))
+        digit = field[pos++] - '0';
+      value = 10 * value + digit;
+      if (value >= DocValues::NO_VALUE) return DocValues::NO_VALUE;
+    }
+  }
+  return value;
+}
+
+
+// _____________________________________________________________________________
+void CsvParser::addDocValue(unsigned docID, unsigned colID,
+                            const string& field)
+{
+  if (_chunkOutput != NULL)
+  {
+    ColumnItem item = { false, docID, colID, field };
+    _chunkOutput->columnItems.push_back(item);
+    return;
+  }
+  if (_docValues.size() <= colID) _docValues.resize(colID + 1);
+  vector<uint32_t>& column = _docValues[colID];
+  if (column.size() <= docID) column.resize(docID + 1, DocValues::NO_VALUE);
+  if (column[docID] != DocValues::NO_VALUE) return;
+  column[docID] = docValueOf(field, _fieldOptions[colID]);
+}
+
+
+// _____________________________________________________________________________
+void CsvParser::writeDocValuesFile()
+{
+  vector<string> fieldNames;
+  vector<vector<uint32_t> > values;
+  for (size_t i = 0; i < _fieldOptions.size(); i++)
+  {
+    if (!_fieldOptions[i].getDocValues()) continue;
+    fieldNames.push_back(_fieldOptions[i].getName());
+    values.push_back(vector<uint32_t>());
+    if (i < _docValues.size()) values.back().swap(_docValues[i]);
+  }
+  if (fieldNames.size() == 0) return;
+  string fileName = ParserBase::getFileNameBase() + ".docvalues";
+  cout << "Writing doc values of " << fieldNames.size() << " field(s) to "
+       << fileName << " ... " << flush;
+  DocValues::write(fileName, fieldNames, values);
+  cout << "done" << endl;
+}
+
+// _____________________________________________________________________________
+void CsvParser::addFacetIndexValue(unsigned docID, unsigned colID,
+                                   const string& field)
+{
+  if (_chunkOutput != NULL)
+  {
+    ColumnItem item = { true, docID, colID, field };
+    _chunkOutput->columnItems.push_back(item);
+    return;
+  }
+  // Same word as in writeFacetToWordsFile.
+  string suffix = field;
+  size_t pos;
+  while ((pos = suffix.find(' ')) != string::npos) suffix[pos] = '_';
+  if (suffix.empty()) return;
+  const CsvField& csvField = _fieldOptions[colID];
+  string word = _wordPartSep + string("facet") + _wordPartSep
+                + csvField.getName() + _wordPartSep + suffix;
+
+  if (_facetColumns.size() <= colID)
+  {
+    _facetColumns.resize(colID + 1);
+    _facetValueIds.resize(colID + 1);
+  }
+  FacetIndex::Column& column = _facetColumns[colID];
+  unordered_map<string, uint32_t, HashString>& valueIds
+    = _facetValueIds[colID];
+  unordered_map<string, uint32_t, HashString>::iterator it
+    = valueIds.find(word);
+  if (it == valueIds.end())
+  {
+    it = valueIds.insert(make_pair(word, column.words.size())).first;
+    column.words.push_back(word);
+  }
+  // Start the value ids of all doc ids up to the given one.
+  assert(column.offsets.size() <= docID + 1);
+  while (column.offsets.size() < docID + 1)
+    column.offsets.push_back(column.valueIds.size());
+  column.valueIds.push_back(it->second);
+}
+
+// _____________________________________________________________________________
+void CsvParser::writeFacetIndexFile()
+{
+  if (!_options.writeFacetIndex()) return;
+  vector<FacetIndex::Column> columns;
+  for (size_t i = 0; i < _fieldOptions.size(); i++)
+  {
+    if (!_fieldOptions[i].getFacet()) continue;
+    columns.push_back(FacetIndex::Column());
+    if (i < _facetColumns.size()) std::swap(columns.back(), _facetColumns[i]);
+    columns.back().name = _fieldOptions[i].getName();
+    columns.back().score = _fieldOptions[i].getScore();
+    // Close the value ids of the last doc id.
+    columns.back().offsets.push_back(columns.back().valueIds.size());
+  }
+  _facetValueIds.clear();
+  string fileName = ParserBase::getFileNameBase() + ".facet-index";
+  cout << "Writing facet index of " << columns.size() << " field(s) to "
+       << fileName << " ... " << flush;
+  FacetIndex::write(fileName, columns);
+  cout << "done" << endl;
 }
 
 
@@ -636,11 +810,21 @@ void CsvParser::writeFieldsToWordsAndDocsFile(unsigned docID,
                                               vector<FieldItem>* fields)
 {
   _position = 1;
-  // Add items to words file.
+  _positionOffsets.clear();
+  // Add items to words file. With --position-offsets, keep track of the offset
+  // of each field in the excerpt, see writeFieldsToDocsFile.
+  size_t excerptLength = 0;
   for (unsigned i = 0; i < fields->size(); ++i)
+  {
+    bool isExcerpt = _options.writePositionOffsets()
+      && _fieldOptions[fields->operator[](i).fieldIndex].getExcerpt();
+    if (isExcerpt && excerptLength > 0) excerptLength += 2;
+    _excerptOffset = isExcerpt ? excerptLength : string::npos;
     writeFieldItemToWordsFile(docID,
                               fields->operator[](i).fieldIndex,
                               &fields->operator[](i).fieldContent);
+    if (isExcerpt) excerptLength += fields->operator[](i).fieldContent.size();
+  }
   // Add items to docs file.
   writeFieldsToDocsFile(docID, fields);
 }
@@ -649,7 +833,7 @@ void CsvParser::writeFieldsToDocsFile(unsigned docID, vector<FieldItem>* fields)
 {
   if (ParserBase::_writeDocsFile)
   {
-    assert(_docs_file);
+    assert(_docs_file || _chunkOutput);
     assert(fields);
     string toShow;
     string excerpt;
@@ -805,16 +989,17 @@ void CsvParser::writeFieldsToDocsFile(unsigned docID, vector<FieldItem>* fields)
         excerpt += (*fields)[i].fieldContent;
       }
     }
-    fprintf(_docs_file,
-            "%d\t%s:%s%d\t%s:%s\t%s:%s\n",
-            docID,
-            "u",
-            "URL#",
-            docID,
-            "t",
-            toShow.c_str(),
-            "H",
-            excerpt.c_str());
+    char docIdString[16];
+    snprintf(docIdString, sizeof(docIdString), "%d", docID);
+    string line = docIdString + string("\tu:URL#") + docIdString
+                  + "\tt:" + toShow
+                  + (_options.writePositionOffsets()
+                     ? "\tp:" + _positionOffsets : string(""))
+                  + "\tH:" + excerpt + "\n";
+    if (_chunkOutput != NULL)
+      _chunkOutput->docs.append(line);
+    else
+      fwrite(line.data(), 1, line.size(), _docs_file);
   }
 }
 
@@ -917,6 +1102,19 @@ void CsvParser::parse()
 
   char* buffer = new char[CSV_MAX_LINE_LENGTH];
 
+  // With several threads, make one copy of this parser per thread. Do this
+  // before init, so that the copies do not get the open files and the
+  // vocabulary, fuzzy search clusters, etc.
+  vector<CsvParser*> workers;
+  if (_options.getNofThreads() > 1)
+  {
+    for (unsigned i = 0; i < _options.getNofThreads(); i++)
+    {
+      workers.push_back(new CsvParser(*this));
+      workers.back()->initWorker();
+    }
+  }
+
   // Open CSV file.
   string csvFileName = ParserBase::getFileNameBase()
                         + ParserBase::getCsvFileNameSuffix();
@@ -934,13 +1132,7 @@ void CsvParser::parse()
     exit(errno);
   }
   string record;
-  string field;
-
-  // How many field names did we read? In the folowing every fields has to have
-  // this number of entries.
-  int numberOfFields = _fieldOptions.size();
-  int numberOfFieldsRead = 0;
-  int docID = 1;
+  unsigned docID = 1;
   vector<FieldItem> fields;
 
   // Read first line without doing anything with it.
@@ -950,32 +1142,35 @@ void CsvParser::parse()
     perror("Can't read from file");
     exit(errno);
   }
-  cout << "Parsing " << csvFileName << " ... " << flush;
+  cout << "Parsing " << csvFileName;
+  if (workers.size() > 0) cout << " with " << workers.size() << " threads";
+  cout << " ... " << flush;
   cout.setf(std::ios::fixed);
   cout.precision(2);
   clock_t time = clock();
 
-  const char fieldSeparator = _options.getColumnSeperator();
-  const char fieldItemSeparator = _options.getFieldSeparator();
-
   #ifdef DEBUG_CSV_PARSER
   cout << endl
        << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<"   << endl
        << "CsvParser: column-separator: '"
-       << static_cast<int>(fieldSeparator) << "'"  << endl
+       << static_cast<int>(_options.getColumnSeperator()) << "'"  << endl
        << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<"   << endl
        << endl;
   cout << endl
        << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<"       << endl
        << "CsvParser: field-item-separator: '"
-       << static_cast<int>(fieldItemSeparator) << "'"  << endl
+       << static_cast<int>(_options.getFieldSeparator()) << "'"  << endl
        << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<"       << endl
        << endl;
   #endif
 
-
-  // Walk through all the records.
-  while (fgets(buffer, CSV_MAX_LINE_LENGTH, csvFile))
+  // Walk through all the records, either in parallel or one after the other.
+  if (workers.size() > 0)
+  {
+    parseInParallel(csvFile, workers, &docID);
+    for (size_t i = 0; i < workers.size(); i++) delete workers[i];
+  }
+  else while (fgets(buffer, CSV_MAX_LINE_LENGTH, csvFile))
   {
     // Buffer must contain a '\n'.
     bool lineTooLong = !containsNewLine(buffer);
@@ -986,14 +1181,7 @@ void CsvParser::parse()
       assert(CSV_MAX_LINE_LENGTH > 2);
       buffer[CSV_MAX_LINE_LENGTH - 2] = '\n';
     }
-    numberOfFieldsRead = 0;
-    fields.clear();
-
-    // Go through the fields and store the entries in the vector<FieldItem>
-    // fields.
     record = string(buffer);
-    size_t start = 0;
-    size_t pos = 0;
 
     // If line was too long, read in batches of CSV_MAX_LINE_LENGTH until
     // eventually a newline is found (and throw it all away). That way very long
@@ -1004,74 +1192,254 @@ void CsvParser::parse()
       lineTooLong = !containsNewLine(buffer);
     }
 
-    // Get a line from csv file.
-    while (pos <= record.size())
+    parseRecord(record, docID, &fields);
+    docID++;
+  }
+  fclose(csvFile);
+  size_t usecs = clock() - time;
+  cout << "done in " << static_cast<double>(usecs) / 1000000
+       << " seconds" << endl;
+
+  // Write the doc values (if any).
+  writeDocValuesFile();
+
+  // Write the facet index (if requested).
+  writeFacetIndexFile();
+
+  // Done. Closes output files and optionally writes the vocabulary file.
+  ParserBase::done();
+
+  delete[] buffer;
+}
+
+// _____________________________________________________________________________
+void CsvParser::parseRecord(const string& record, unsigned docID,
+                            vector<FieldItem>* fields)
+{
+  const char fieldSeparator = _options.getColumnSeperator();
+  const char fieldItemSeparator = _options.getFieldSeparator();
+  // How many field names did we read? In the folowing every fields has to have
+  // this number of entries.
+  int numberOfFields = _fieldOptions.size();
+  int numberOfFieldsRead = 0;
+  fields->clear();
+
+  // Go through the fields and store the entries in the vector<FieldItem>
+  // fields.
+  string field;
+  size_t start = 0;
+  size_t pos = 0;
+
+  // Get a line from csv file.
+  while (pos <= record.size())
+  {
+    while (pos < record.size() && record[pos] != fieldSeparator) ++pos;
+    field = start < record.size() ? record.substr(start, pos - start) : "";
+
+    // NEW 31Jan14 (baumgari): Fields, which may have multiple items, need to be
+    // defined now by using --allow-multiple-items. For other fields, it's not
+    // necessary to parse for the fieldItemSeparator.
+    // Each field can contain multiple items. Find all of them and add them to
+    // the fields vector.
+    const CsvField& csvField = _fieldOptions[numberOfFieldsRead];
+    size_t fieldSepPos = 0;
+    size_t fieldPos = 0;
+
+    if (csvField.getMultipleItems())
     {
-      while (pos < record.size() && record[pos] != fieldSeparator) ++pos;
-      field = start < record.size() ? record.substr(start, pos - start) : "";
-
-      // NEW 31Jan14 (baumgari): Fields, which may have multiple items, need to be
-      // defined now by using --allow-multiple-items. For other fields, it's not
-      // necessary to parse for the fieldItemSeparator.
-      // Each field can contain multiple items. Find all of them and add them to
-      // the fields vector.
-      const CsvField& csvField = _fieldOptions[numberOfFieldsRead];
-      size_t fieldSepPos = 0;
-      size_t fieldPos = 0;
-
-      if (csvField.getMultipleItems())
+      while ((fieldSepPos = field.find(fieldItemSeparator, fieldPos + 1))
+             != string::npos)
       {
-        while ((fieldSepPos = field.find(fieldItemSeparator, fieldPos + 1))
-               != string::npos)
-        {
-          const string& fieldItem =
-            field.substr(fieldPos, fieldSepPos - fieldPos);
-          fields.push_back(FieldItem(fieldItem, numberOfFieldsRead));
-          fieldPos = fieldSepPos + 1;
-        }
+        const string& fieldItem =
+          field.substr(fieldPos, fieldSepPos - fieldPos);
+        fields->push_back(FieldItem(fieldItem, numberOfFieldsRead));
+        fieldPos = fieldSepPos + 1;
       }
-      const string& fieldItem = field.substr(fieldPos);
-      fields.push_back(FieldItem(fieldItem, numberOfFieldsRead));
-
-      #ifdef DEBUG_CSV_PARSER
-      cout << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl
-           << "CsvParser:452: Column: " << field << endl
-           << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl
-           << endl;
-      #endif
-      // cout << "Field: \"" << field << "\"" << endl;
-      numberOfFieldsRead++;
-      ++pos;
-      start = pos;
     }
-    // If we read more or less fields than defined in the first line: log and
-    // continue.
-    if (numberOfFieldsRead != numberOfFields)
+    const string& fieldItem = field.substr(fieldPos);
+    fields->push_back(FieldItem(fieldItem, numberOfFieldsRead));
+
+    #ifdef DEBUG_CSV_PARSER
+    cout << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl
+         << "CsvParser:452: Column: " << field << endl
+         << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << endl
+         << endl;
+    #endif
+    // cout << "Field: \"" << field << "\"" << endl;
+    numberOfFieldsRead++;
+    ++pos;
+    start = pos;
+  }
+  // If we read more or less fields than defined in the first line: log and
+  // continue.
+  if (numberOfFieldsRead != numberOfFields)
+  {
+    std::ostringstream message;
+    message << "Skipping line " << (docID + 1) << " with "
+            << numberOfFieldsRead << " fields instead of "
+            << numberOfFields << endl;
+    if (_chunkOutput != NULL)
     {
-      cerr << "Skipping line " << (docID + 1) << " with "
-           << numberOfFieldsRead << " fields instead of "
-           << numberOfFields << endl;
-
+      _chunkOutput->messages.append(message.str());
+      _chunkOutput->log.append(record + "\n");
+    }
+    else
+    {
+      cerr << message.str();
       fputs(record.c_str(), _log_file);
       fputs("\n", _log_file);
-      fields.clear();
-      numberOfFieldsRead = 0;
-      docID++;
-      continue;
     }
-    // Pass fields to <basename>.docs and <basename>.words.
-    writeFieldsToWordsAndDocsFile(docID, &fields);
+    fields->clear();
+    return;
+  }
+  // Pass fields to <basename>.docs and <basename>.words.
+  writeFieldsToWordsAndDocsFile(docID, fields);
+}
 
-    docID++;
+// _____________________________________________________________________________
+void CsvParser::ChunkOutput::clear()
+{
+  words.clear();
+  docs.clear();
+  log.clear();
+  messages.clear();
+  columnItems.clear();
+}
+
+// _____________________________________________________________________________
+bool CsvParser::readChunk(FILE* csvFile, string* rest, unsigned* docID,
+                          Chunk* chunk)
+{
+  string& text = chunk->text;
+  chunk->output.clear();
+  text.clear();
+  text.swap(*rest);
+  // Read blocks until the new data contains a newline (or the file ends).
+  while (true)
+  {
+    size_t oldSize = text.size();
+    text.resize(oldSize + CSV_CHUNK_SIZE);
+    size_t nofBytesRead = fread(&text[oldSize], 1, CSV_CHUNK_SIZE, csvFile);
+    text.resize(oldSize + nofBytesRead);
+    if (nofBytesRead == 0) break;
+    size_t lastNewLine = text.rfind('\n');
+    if (lastNewLine != string::npos && lastNewLine >= oldSize) break;
   }
-  size_t usecs = clock() - time;
-  cout << "done in " << static_cast<double>(usecs) / 1000000
-       << " seconds" << endl;
+  // Leave the incomplete last record for the next chunk.
+  size_t lastNewLine = text.rfind('\n');
+  if (lastNewLine != string::npos && lastNewLine + 1 < text.size()
+      && !feof(csvFile))
+  {
+    rest->assign(text, lastNewLine + 1, string::npos);
+    text.resize(lastNewLine + 1);
+  }
+  if (text.empty()) return false;
+  chunk->firstDocID = *docID;
+  *docID += std::count(text.begin(), text.end(), '\n');
+  if (text[text.size() - 1] != '\n') (*docID)++;
+  return true;
+}
 
-  // Done. Closes output files and optionally writes the vocabulary file.
-  ParserBase::done();
+// _____________________________________________________________________________
+void CsvParser::parseChunk(Chunk* chunk)
+{
+  _chunkOutput = &chunk->output;
+  _wordsBuffer = &chunk->output.words;
+  const string& text = chunk->text;
+  unsigned docID = chunk->firstDocID;
+  string record;
+  vector<FieldItem> fields;
+  size_t start = 0;
+  while (start < text.size())
+  {
+    size_t end = text.find('\n', start);
+    if (end == string::npos) end = text.size();
+    // Like in parse, truncate lines that are too long.
+    if (end - start > CSV_MAX_LINE_LENGTH - 2)
+    {
+      std::ostringstream message;
+      message << "Line " << (docID + 1) << " too long, truncating to "
+              << CSV_MAX_LINE_LENGTH / (1000 * 1000) << "M bytes" << endl;
+      _chunkOutput->messages.append(message.str());
+      record.assign(text, start, CSV_MAX_LINE_LENGTH - 2);
+      record += '\n';
+    }
+    else
+    {
+      record.assign(text, start, end - start);
+    }
+    parseRecord(record, docID, &fields);
+    docID++;
+    start = end + 1;
+  }
+  _chunkOutput = NULL;
+  _wordsBuffer = NULL;
+}
 
-  delete[] buffer;
+// _____________________________________________________________________________
+void* CsvParser::parseChunkThread(void* task)
+{
+  ParseTask* parseTask = static_cast<ParseTask*>(task);
+  parseTask->worker->parseChunk(parseTask->chunk);
+  return NULL;
 }
 
+// _____________________________________________________________________________
+void CsvParser::writeChunkOutput(const ChunkOutput& output)
+{
+  fputs(output.messages.c_str(), stderr);
+  writeWordsBuffer(output.words);
+  if (_docs_file != NULL)
+    fwrite(output.docs.data(), 1, output.docs.size(), _docs_file);
+  if (_log_file != NULL)
+    fwrite(output.log.data(), 1, output.log.size(), _log_file);
+  for (size_t i = 0; i < output.columnItems.size(); i++)
+  {
+    const ColumnItem& item = output.columnItems[i];
+    if (item.facet) addFacetIndexValue(item.docID, item.colID, item.field);
+    else addDocValue(item.docID, item.colID, item.field);
+  }
+}
 
+// _____________________________________________________________________________
+void CsvParser::parseInParallel(FILE* csvFile,
+                                const vector<CsvParser*>& workers,
+                                unsigned* docID)
+{
+  size_t nofThreads = workers.size();
+  // The chunks being read, parsed, and written (the outputs of the previous
+  // batch), and how many of them are in use.
+  vector<Chunk> reading(nofThreads);
+  vector<Chunk> parsing(nofThreads);
+  vector<Chunk> writing(nofThreads);
+  size_t nofRead = 0;
+  size_t nofWritten = 0;
+  string rest;
+  while (nofRead < nofThreads
+         && readChunk(csvFile, &rest, docID, &reading[nofRead])) nofRead++;
+  vector<pthread_t> threads(nofThreads);
+  vector<ParseTask> tasks(nofThreads);
+  while (nofRead > 0)
+  {
+    // Parse the chunks read last.
+    reading.swap(parsing);
+    size_t nofParsed = nofRead;
+    for (size_t i = 0; i < nofParsed; i++)
+    {
+      tasks[i].worker = workers[i];
+      tasks[i].chunk = &parsing[i];
+      pthread_create(&threads[i], NULL, &CsvParser::parseChunkThread,
+                     &tasks[i]);
+    }
+    // Meanwhile, write the outputs of the previous batch and read the next.
+    for (size_t i = 0; i < nofWritten; i++)
+      writeChunkOutput(writing[i].output);
+    nofRead = 0;
+    while (nofRead < nofThreads
+           && readChunk(csvFile, &rest, docID, &reading[nofRead])) nofRead++;
+    for (size_t i = 0; i < nofParsed; i++) pthread_join(threads[i], NULL);
+    writing.swap(parsing);
+    nofWritten = nofParsed;
+  }
+  for (size_t i = 0; i < nofWritten; i++) writeChunkOutput(writing[i].output);
+}
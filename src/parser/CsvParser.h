@@ -33,6 +33,16 @@
 // where <show field="fieldi">...</show> gives the contents of the i-th field
 // specified by the --show option. As <text> put the concatenation of the text
 // of all fields specified by the --excerpts option.
+//
+// Outputfile <basename>.docvalues (only with the --doc-values option):
+//
+// For each field specified via the --doc-values option, a bit-packed column
+// with one numeric value per doc id, see server/DocValues.h.
+//
+// Outputfile <basename>.facet-index (only with the --write-facet-index option):
+//
+// For each field specified via the --facets option, the facet words of each
+// doc id, see server/FacetIndex.h.
 
 #include <vector>
 #include <string>
@@ -40,6 +50,8 @@
 #include "./ParserBase.h"
 #include "./SimpleTextParser.h"
 #include "./StringConversion.h"
+#include "../server/DocValues.h"
+#include "../server/FacetIndex.h"
 
 class CsvParser : public ParserBase
 {
@@ -55,7 +67,7 @@ class CsvParser : public ParserBase
   // Run Parser. Reads file <basename>.csv and produces files
   // <basename>.words, <basename>.docs, and <basename>.parse-log. The latter
   // contains a log of peculiar things (warnings) that happened during
-  // parsing.
+  // parsing. With --num-threads > 1, see parseInParallel.
   void parse();
  private:
   // A pair of the content string and Index of a field.
@@ -73,6 +85,79 @@ class CsvParser : public ParserBase
   // by a '\0'.
   bool containsNewLine(char* buffer);
 
+  // Parse a single record (a line of the CSV file, without the newline) with
+  // the given doc id, and write its fields to the words and docs file. Lines
+  // with the wrong number of fields are logged and skipped.
+  void parseRecord(const string& record, unsigned docID,
+                   vector<FieldItem>* fields);
+
+  // A field item for the doc values or the facet index, see ChunkOutput.
+  struct ColumnItem
+  {
+    bool facet;
+    unsigned docID;
+    unsigned colID;
+    string field;
+  };
+
+  // The output of parsing a chunk of records in a worker thread: what would
+  // otherwise have been written to the words, docs, and log file and to cerr,
+  // and the field items for _docValues and _facetColumns (which depend on the
+  // order of the doc ids).
+  struct ChunkOutput
+  {
+    WordsBuffer words;
+    string docs;
+    string log;
+    string messages;
+    vector<ColumnItem> columnItems;
+    void clear();
+  };
+
+  // A chunk of complete records from the CSV file, and its output.
+  struct Chunk
+  {
+    string text;
+    unsigned firstDocID;
+    ChunkOutput output;
+  };
+
+  // Parse the remaining records of the given CSV file with the given worker
+  // parsers, one thread each. The file is read in chunks of about
+  // CSV_CHUNK_SIZE bytes that end at a record boundary. One batch of chunks is
+  // parsed in parallel, while the outputs of the previous batch are written
+  // (in the order of the chunks, so that the doc ids and all files are the
+  // same as with a single thread) and the next batch is read.
+  void parseInParallel(FILE* csvFile, const vector<CsvParser*>& workers,
+                       unsigned* docID);
+
+  // Read the next chunk from the given file into the given chunk, starting
+  // with the incomplete record left over from the previous chunk in *rest.
+  // Sets the first doc id of the chunk and advances *docID by its number of
+  // records. Returns false if there are no more records.
+  bool readChunk(FILE* csvFile, string* rest, unsigned* docID, Chunk* chunk);
+
+  // Parse all records of the given chunk into its output (called in a worker
+  // thread for a worker parser).
+  void parseChunk(Chunk* chunk);
+
+  // A chunk and the worker parser to parse it, for parseChunkThread.
+  struct ParseTask
+  {
+    CsvParser* worker;
+    Chunk* chunk;
+  };
+
+  // Thread function: calls parseChunk for the given ParseTask.
+  static void* parseChunkThread(void* task);
+
+  // Write the output of a chunk to the files and add its field items to
+  // _docValues and _facetColumns.
+  void writeChunkOutput(const ChunkOutput& output);
+
+  // If not NULL, the output of parseRecord goes here, see ChunkOutput.
+  ChunkOutput* _chunkOutput;
+
 
   // Parsing record to <basename>.words and <basename>.doc.
   void writeFieldsToWordsAndDocsFile(unsigned docID, vector<FieldItem>* fields);
@@ -153,6 +238,23 @@ class CsvParser : public ParserBase
       unsigned score,
       const CsvField::Precision& precision);
 
+  // Interpret the given field as a number for the doc values of the given
+  // column: dates (--ordering=<fld>:date) as YYYYMMDD, numbers with a
+  // precision p.q (--ordering=<fld>:p.q) as integer with q decimal digits, and
+  // otherwise the leading digits of the field. Returns DocValues::NO_VALUE if
+  // the field is not a number.
+  uint32_t docValueOf(const string& field, const CsvField& csvField);
+  // Remember the value of the given field for the given doc id in
+  // _docValues. For fields with multiple items, only the first one counts.
+  void addDocValue(unsigned docID, unsigned colID, const string& field);
+  // Write <basename>.docvalues if any field has the --doc-values option.
+  void writeDocValuesFile();
+  // Remember the facet word of the given field item for the given doc id in
+  // _facetColumns. Doc ids must be added in increasing order.
+  void addFacetIndexValue(unsigned docID, unsigned colID, const string& field);
+  // Write <basename>.facet-index if the --write-facet-index option is given.
+  void writeFacetIndexFile();
+
   // The index support some artificial words, which can be read out from the
   // server and interpreted. For example it's possible to write the encoding,
   // the date if index construction or the output formats of each specified
@@ -168,10 +270,23 @@ class CsvParser : public ParserBase
 
   // The current position.
   size_t _position;
+  // With --position-offsets: the offset in the excerpt of the docs file of the
+  // field whose full-text words are written (string::npos if none), and the
+  // words written so far for the current document, as
+  // <position>:<offset>:<length>,... (see writeFieldsToDocsFile).
+  size_t _excerptOffset;
+  string _positionOffsets;
   // TODO(hoffmaje): Perhaps better use locally.
   static const char* _fileExtension;
   // This fields holds the options set for any csv-field.
   vector<CsvField> _fieldOptions;
+  // The doc values collected during parsing, one column (indexed by doc id)
+  // per field; empty for fields without the --doc-values option.
+  vector<vector<uint32_t> > _docValues;
+  // The facet words of each doc id collected during parsing, one column per
+  // field, and for each field the value id of each facet word.
+  vector<FacetIndex::Column> _facetColumns;
+  vector<unordered_map<string, uint32_t, HashString> > _facetValueIds;
   // Needed to parse strings.
   SimpleTextParser _simpleTextParser;
   // Needed to conversion to lower case.
@@ -22,6 +22,9 @@ CsvParserOptions::CsvParserOptions()
   _fieldSeparator = 0;
   _noShowPrefix = 0;
   _oldWordsFormat = false;
+  _writeFacetIndex = false;
+  _writePositionOffsets = false;
+  _nofThreads = 1;
   CsvField::resetStaticShowList();
 }
 
@@ -85,6 +88,32 @@ void CsvParserOptions::printUsage() const
        << endl
        << "--allow-multiple-items       : fields, which may have more than one"
        <<                               " item. A typical case is \"author\"."
+       << endl
+       << "--doc-values                 : numeric fields to write to"
+       <<                               " <basename>.docvalues, a bit-packed"
+       <<                               " column per field for fast range"
+       <<                               " filters and sorting in the server"
+       <<                               " (dates with --ordering=<fld>:date as"
+       <<                               " YYYYMMDD, numbers with a precision as"
+       <<                               " in --ordering, otherwise the leading"
+       <<                               " digits of the first item)."
+       << endl
+       << "--write-facet-index          : write <basename>.facet-index, the"
+       <<                               " facet values of each document for"
+       <<                               " all --facets fields, for fast facet"
+       <<                               " counts in the server."
+       << endl
+       << "--position-offsets           : write the position, byte offset and"
+       <<                               " length of each full-text word of"
+       <<                               " the --excerpts fields to the docs"
+       <<                               " file (field p:), from which"
+       <<                               " buildDocsDB stores the text in"
+       <<                               " blocks, so that the server reads"
+       <<                               " only the parts around the positions"
+       <<                               " of a hit for its excerpts."
+       << endl
+       << "--num-threads                : number of threads that parse the"
+       <<                               " records (default: 1)."
        << endl << endl;
   ParserBase::printUsage();
   cout << endl;
@@ -251,6 +280,7 @@ void CsvParserOptions::parseFromCommandLine(int argc, char** argv,
   string facetids;
   string ordering;
   string multipleItemsFields;
+  string docValues;
 
   FILE *csvFile = NULL;
 
@@ -280,9 +310,13 @@ void CsvParserOptions::parseFromCommandLine(int argc, char** argv,
       {"old-words-format",       0, NULL, 'w'},
       {"field-format",           1, NULL, 't'},
       {"allow-multiple-items"  , 1, NULL, 'M'},
+      {"doc-values",             1, NULL, 'D'},
+      {"write-facet-index",      0, NULL, 'I'},
+      {"position-offsets",       0, NULL, 'O'},
+      {"num-threads",            1, NULL, 'T'},
       { NULL,                    0, NULL,  0 }
     };
-    int c = getopt_long(argc, argv, "hn:f:s:C:e:c:S:p:F:P:a:i:x:o:m:t:wM:",
+    int c = getopt_long(argc, argv, "hn:f:s:C:e:c:S:p:F:P:a:i:x:o:m:t:wM:D:IOT:",
                         longOptions, NULL);
     // cout << "CsvParserOptions::parseCommendLineOptions ["
     //      << c << "|" << (char)(c) << "]" << endl;
@@ -356,6 +390,18 @@ void CsvParserOptions::parseFromCommandLine(int argc, char** argv,
       case 'M':
         multipleItemsFields = string(optarg);
         break;
+      case 'D':
+        docValues = string(optarg);
+        break;
+      case 'I':
+        _writeFacetIndex = true;
+        break;
+      case 'O':
+        _writePositionOffsets = true;
+        break;
+      case 'T':
+        _nofThreads = atoi(optarg) > 1 ? atoi(optarg) : 1;
+        break;
     }
   }
   // Okay. Finished parsing command line options. Now read first line in
@@ -418,6 +464,8 @@ void CsvParserOptions::parseFromCommandLine(int argc, char** argv,
   if (ordering != "") parseListOfOptArgs_Typ1(ordering, &CsvField::setOrdering);
   if (multipleItemsFields != "")
     parseListOfOptArgs_Typ0(multipleItemsFields, &CsvField::setMultipleItems);
+  if (docValues != "")
+    parseListOfOptArgs_Typ0(docValues, &CsvField::setDocValues);
 }
 
 void CsvParserOptions::readFromFile(const string& fileName)
@@ -95,11 +95,16 @@ using std::cerr;
 // is always handled as array (e.g. "author": [] and
 // "author": ["Peter", "Paul"]). Example:
 // --allow-multiple-entries=author,editor.
+//
+// --num-threads: number of threads that parse the records (default 1). With
+// more than one thread, the CSV file is read in large chunks, which are parsed
+// in parallel and written in their original order, see CsvParser::parse.
 
 #define TAB '\t'
 #define SPACE ' '
 #define EOL '\n'
 #define CSV_MAX_LINE_LENGTH 10 * 1024 * 1024
+#define CSV_CHUNK_SIZE (8 * 1024 * 1024)
 
 class CsvParserOptions
 {
@@ -131,6 +136,9 @@ class CsvParserOptions
   const vector<CsvField>& getFieldOptions() const { return _fieldOptions; }
   void getFieldName(unsigned int column, string* result) const;
   bool isOldWordsFormat() const { return _oldWordsFormat; }
+  bool writeFacetIndex() const { return _writeFacetIndex; }
+  bool writePositionOffsets() const { return _writePositionOffsets; }
+  unsigned int getNofThreads() const { return _nofThreads; }
 
  private:
   // The separator between columns in the CSV file.
@@ -155,6 +163,16 @@ class CsvParserOptions
   // now.
   bool _oldWordsFormat;
 
+  // Whether to write <basename>.facet-index for the --facets fields.
+  bool _writeFacetIndex;
+
+  // Whether to write the byte offsets of the words of the excerpts to the
+  // docs file (field p:).
+  bool _writePositionOffsets;
+
+  // The number of threads for parsing the records.
+  unsigned int _nofThreads;
+
   // Our textparser.
   SimpleTextParser _simpleTextParser;
 
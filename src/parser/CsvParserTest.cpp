@@ -283,6 +283,21 @@ TEST_F(CsvParserTest, optionExcerpts)
   EXPECT_EQ(expectedDocsOutput, fileToString("testbase.docs-unsorted"));
 }
 
+// _____________________________________________________________________________
+TEST_F(CsvParserTest, optionPositionOffsets)
+{
+  const char* csventry = "field1\tfield2\tfield3\n"
+    "ab cd\tnot shown\tef gh\n";
+  write("testbase.csv", csventry);
+  const char* expectedDocsOutput =
+    "1\tu:URL#1\tt:\tp:1:0:2,2:3:2,5:7:2,6:10:2\tH:ab cd. ef gh\n";
+  execute("./CsvParserMain --base-name=testbase"
+          " --full-text=field1,field2,field3 --excerpts=field1,field3"
+          " --position-offsets --write-words-file-ascii --write-docs-file"
+          " > /dev/null");
+  EXPECT_EQ(expectedDocsOutput, fileToString("testbase.docs-unsorted"));
+}
+
 // ____________________________________________________________________________
 TEST_F(CsvParserTest, optionFieldSeparator)
 {
@@ -458,6 +473,121 @@ TEST_F(CsvParserTest, optionOrderingLiteral)
   EXPECT_EQ(expectedDocsOutput, fileToString("testbase.docs-unsorted"));
 }
 
+// _____________________________________________________________________________
+TEST_F(CsvParserTest, optionDocValues)
+{
+  const char* csventry = "title\tyear\tdate\tprice\n"
+    "a\t1997\t22-01-2010\t12,99 Euro\n"
+    "b\tunknown\t31-10-1983\t3\n"
+    "c\t2004\t01-01-2000\t\n";
+  write("testbase.csv", csventry);
+  execute("./CsvParserMain --base-name=testbase"
+          " --ordering=date:date,price:8.2"
+          " --doc-values=year,date,price"
+          " --write-words-file-ascii"
+          " --write-docs-file > /dev/null");
+  DocValues docValues;
+  docValues.open("testbase.docvalues");
+  ASSERT_EQ(3u, docValues.getNofFields());
+  int year = docValues.getFieldId("year");
+  int date = docValues.getFieldId("date");
+  int price = docValues.getFieldId("price");
+  ASSERT_EQ(-1, docValues.getFieldId("title"));
+  EXPECT_EQ(1997u, docValues.getValue(year, 1));
+  EXPECT_EQ(DocValues::NO_VALUE, docValues.getValue(year, 2));
+  EXPECT_EQ(2004u, docValues.getValue(year, 3));
+  EXPECT_EQ(20100122u, docValues.getValue(date, 1));
+  EXPECT_EQ(19831031u, docValues.getValue(date, 2));
+  EXPECT_EQ(1299u, docValues.getValue(price, 1));
+  EXPECT_EQ(300u, docValues.getValue(price, 2));
+  EXPECT_EQ(DocValues::NO_VALUE, docValues.getValue(price, 3));
+  remove("testbase.docvalues");
+}
+
+// _____________________________________________________________________________
+TEST_F(CsvParserTest, optionWriteFacetIndex)
+{
+  const char* csventry = "title\tauthor\tvenue\n"
+    "a\tHannah Bast\tSIGIR\n"
+    "b\t\tSIGIR\n"
+    "c\tIngmar Weber\tCIKM\n"
+    "d\tHannah Bast\t\n";
+  write("testbase.csv", csventry);
+  execute("./CsvParserMain --base-name=testbase"
+          " --facets=author,venue"
+          " --write-facet-index"
+          " --write-words-file-ascii"
+          " --write-docs-file > /dev/null");
+  FacetIndex facetIndex;
+  facetIndex.open("testbase.facet-index");
+  ASSERT_EQ(2u, facetIndex.getNofFields());
+  int author = facetIndex.getFieldId("author");
+  int venue = facetIndex.getFieldId("venue");
+  ASSERT_EQ(-1, facetIndex.getFieldId("title"));
+  ASSERT_EQ(2u, facetIndex.getNofValues(author));
+  ASSERT_EQ(2u, facetIndex.getNofValues(venue));
+  EXPECT_EQ(string("!facet!author!Hannah_Bast"), facetIndex.getWord(author, 0));
+  EXPECT_EQ(string("!facet!venue!CIKM"), facetIndex.getWord(venue, 1));
+  const uint32_t* begin;
+  const uint32_t* end;
+  facetIndex.getValueIds(author, 2, &begin, &end);
+  EXPECT_EQ(0, end - begin);
+  facetIndex.getValueIds(author, 4, &begin, &end);
+  ASSERT_EQ(1, end - begin);
+  EXPECT_EQ(0u, *begin);
+  facetIndex.getValueIds(venue, 3, &begin, &end);
+  ASSERT_EQ(1, end - begin);
+  EXPECT_EQ(1u, *begin);
+  facetIndex.getValueIds(venue, 4, &begin, &end);
+  EXPECT_EQ(0, end - begin);
+  remove("testbase.facet-index");
+}
+
+// _____________________________________________________________________________
+TEST_F(CsvParserTest, optionNumThreads)
+{
+  // Enough records for several chunks (of CSV_CHUNK_SIZE bytes), with a
+  // skipped line and a last line without newline.
+  string csventry = "title\tauthor\tyear\n";
+  char line[200];
+  for (int i = 0; i < 200000; i++)
+  {
+    snprintf(line, sizeof(line), "Record number %d about topic %d and %d,"
+             " with some more words to make the line longer\tAuthor %d;"
+             "Author %d\t%d\n", i, i % 97, i % 1013, i % 11, i % 13,
+             1900 + i % 120);
+    csventry += line;
+    if (i == 100000) csventry += "a line with too few fields\n";
+  }
+  csventry += "last\tAuthor 1\t2000";
+  ASSERT_GT(csventry.size(), 2u * CSV_CHUNK_SIZE);
+  write("testbase.csv", csventry.c_str());
+  string options = " --base-name=testbase --full-text=title"
+                   " --facets=author --allow-multiple-items=author"
+                   " --within-field-separator=';' --doc-values=year"
+                   " --write-facet-index --write-words-file-ascii"
+                   " --write-docs-file > /dev/null 2>&1";
+  execute(("./CsvParserMain" + options).c_str());
+  const char* files[] = { "testbase.words-unsorted.ascii",
+    "testbase.docs-unsorted", "testbase.parse-log", "testbase.docvalues",
+    "testbase.facet-index" };
+  for (size_t i = 0; i < 5; i++)
+    rename(files[i], (string(files[i]) + ".single").c_str());
+  execute(("./CsvParserMain --num-threads=3" + options).c_str());
+  // All output files must be the same as with a single thread.
+  for (size_t i = 0; i < 5; i++)
+  {
+    string single = string(files[i]) + ".single";
+    string cmp = "cmp -s " + string(files[i]) + " " + single;
+    EXPECT_EQ(0, system(cmp.c_str())) << files[i];
+    remove(single.c_str());
+  }
+  EXPECT_EQ("a line with too few fields\n",
+            fileToString("testbase.parse-log"));
+  remove("testbase.docvalues");
+  remove("testbase.facet-index");
+}
+
 // _____________________________________________________________________________
 TEST_F(CsvParserTest, userDefinedWords)
 {
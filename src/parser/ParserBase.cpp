@@ -13,6 +13,7 @@
 
 // ____________________________________________________________________________
 const unsigned int ParserBase::MAX_BUFFER_SIZE = 100 * 1000;
+const size_t ParserBase::OUTPUT_BUFFER_SIZE = 16 * 1024 * 1024;
 
 // ____________________________________________________________________________
 void ParserBase::printUsage()
@@ -36,6 +37,18 @@ void ParserBase::printUsage()
        << "--write-words-file-binary     : write .words-unsorted.binary file"
        <<                                " (default = false)"
        << endl
+       << "--write-sorted-runs           : write .words-runs file with sorted"
+       <<                                " runs of postings, which buildIndex"
+       <<                                " can read without a separate sort;"
+       <<                                " needs --read-vocabulary"
+       <<                                " (default = false)"
+       << endl
+       << "--sorted-runs-memory          : memory for the postings of a run"
+       <<                                " in MB (default = 1024)"
+       << endl
+       << "--sorted-runs-threads         : number of threads for sorting a run"
+       <<                                " (default = 1)"
+       << endl
        << "--write-log-file              : write .parse-log file"
        <<                                " (default = true)"
        << endl
@@ -96,6 +109,9 @@ void ParserBase::parseCommandLineOptions(int argc, char** argv)
       {"write-docs-file"             , 0, NULL, 'd'},
       {"write-words-file-ascii"      , 0, NULL, 'w'},
       {"write-words-file-binary"     , 0, NULL, 'b'},
+      {"write-sorted-runs"           , 0, NULL, 'r'},
+      {"sorted-runs-memory"          , 1, NULL, 'R'},
+      {"sorted-runs-threads"         , 1, NULL, 'P'},
       {"write-log-file"              , 0, NULL, 'l'},
       {"write-vocabulary"            , 0, NULL, 'v'},
       {"read-vocabulary"             , 0, NULL, 'V'},
@@ -106,7 +122,8 @@ void ParserBase::parseCommandLineOptions(int argc, char** argv)
       {"output-doc-frequencies"      , 0, NULL, 'z'},
       { NULL                         , 0, NULL,  0 }
     };
-    int c = getopt_long(argc, argv, "EmisdwblvVYSUfz", long_options, NULL);
+    int c = getopt_long(argc, argv, "EmisdwbrR:P:lvVYSUfz", long_options,
+                        NULL);
     if (c == -1) break;
     // cout << "ParserBase::parseCommandLineOptions ["
     //      << c << "|" << (char)(c) << "]" << endl;
@@ -132,6 +149,13 @@ void ParserBase::parseCommandLineOptions(int argc, char** argv)
       case 'd': _writeDocsFile = true; break;
       case 'w': _writeAsciiWordsFile = true; break;
       case 'b': _writeBinaryWordsFile = true; break;
+      case 'r': _writeSortedRuns = true; break;
+      case 'R':
+        _sortedRunsMemoryInMb = atoi(optarg) > 0 ? atoi(optarg) : 1;
+        break;
+      case 'P':
+        _sortedRunsNofThreads = atoi(optarg) > 0 ? atoi(optarg) : 1;
+        break;
       case 'l': _writeLogFile = true; break;
       case 'v': _writeVocabulary = true; break;
       case 'V': _readVocabulary = true; break;
@@ -155,6 +179,7 @@ void ParserBase::parseCommandLineOptions(int argc, char** argv)
   cout << boolalpha << "Will write: docs file = " << _writeDocsFile
        << ", words file = " << _writeAsciiWordsFile
        << ", binary words file = " << _writeBinaryWordsFile
+       << ", sorted runs = " << _writeSortedRuns
        << ", vocabulary file = " << _writeVocabulary
        << ", vocabulary+frequencies file = " << _outputWordFrequencies << endl;
   cout << "Will read: vocabulary = " << _readVocabulary
@@ -184,6 +209,9 @@ ParserBase::ParserBase()
   _writeDocsFile = false;
   _writeAsciiWordsFile = false;
   _writeBinaryWordsFile = false;
+  _writeSortedRuns = false;
+  _sortedRunsMemoryInMb = 1024;
+  _sortedRunsNofThreads = 1;
   _writeVocabulary = false;
   _readVocabulary = false;
   _readFuzzySearchClusters = false;
@@ -198,7 +226,9 @@ ParserBase::ParserBase()
   _docs_file = NULL;
   _ascii_words_file = NULL;
   _binary_words_file = NULL;
+  _sortedRunsWriter = NULL;
   _log_file = NULL;
+  _wordsBuffer = NULL;
   _encoding = ISO;
   _csvFileNameSuffix = ".csv";
 
@@ -223,6 +253,7 @@ void ParserBase::init(const string& fileNameBase)
   _docsFileName = fileNameBase + ".docs-unsorted";
   _asciiWordsFileName = fileNameBase + ".words-unsorted.ascii";
   _binaryWordsFileName = fileNameBase + ".words-unsorted.binary";
+  _sortedRunsFileName = fileNameBase + ".words-runs";
   _logFileName = fileNameBase + ".parse-log";
   _vocabularyFileName = fileNameBase + ".vocabulary";
   _fuzzySearchClustersFileName = fileNameBase + ".fuzzysearch-clusters";
@@ -243,6 +274,7 @@ void ParserBase::init(const string& fileNameBase)
       perror("fopen docs file:");
       exit(1);
     }
+    setvbuf(_docs_file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
   }
   if (_writeAsciiWordsFile)
   {
@@ -252,6 +284,7 @@ void ParserBase::init(const string& fileNameBase)
       perror("fopen ascii words file:");
       exit(1);
     }
+    setvbuf(_ascii_words_file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
   }
   if (_writeBinaryWordsFile)
   {
@@ -261,6 +294,13 @@ void ParserBase::init(const string& fileNameBase)
       perror("fopen binary words file:");
       exit(1);
     }
+    setvbuf(_binary_words_file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+  }
+  if (_writeSortedRuns)
+  {
+    _sortedRunsWriter = new SortedRunsWriter(_sortedRunsFileName,
+                                             _sortedRunsMemoryInMb << 20,
+                                             _sortedRunsNofThreads);
   }
   if (_writeLogFile)
   {
@@ -293,12 +333,36 @@ void ParserBase::init(const string& fileNameBase)
 }
 
 
+// ____________________________________________________________________________
+void ParserBase::initWorker()
+{
+  if (_readUserDefinedWords)
+  {
+    _userDefinedIndexWords.init(_fileNameBase + ".user-defined-words");
+  }
+  if (_stringConverter.init(_pathToMaps) == false)
+  {
+    cerr << _stringConverter.getLastError() << endl;
+    exit(1);
+  }
+}
+
+
 // ____________________________________________________________________________
 void ParserBase::done()
 {
   if (_docs_file) fclose(_docs_file);
   if (_ascii_words_file) fclose(_ascii_words_file);
   if (_binary_words_file) fclose(_binary_words_file);
+  if (_sortedRunsWriter)
+  {
+    _sortedRunsWriter->finish();
+    cout << "Wrote " << _sortedRunsWriter->getNofPostings() << " postings in "
+         << _sortedRunsWriter->getNofRuns() << " sorted runs to "
+         << _sortedRunsFileName << endl;
+    delete _sortedRunsWriter;
+    _sortedRunsWriter = NULL;
+  }
   if (_log_file) fclose(_log_file);
 
   if (_writeVocabulary) writeVocabulary(_vocabularyFileName);
@@ -376,7 +440,7 @@ void ParserBase::writeVocabulary(const string& fileName)
 // ____________________________________________________________________________
 void ParserBase::readVocabulary(const string& fileName)
 {
-  assert(_writeBinaryWordsFile);
+  assert(_writeBinaryWordsFile || _writeSortedRuns);
   cout << "Reading vocabulary from file \"" << fileName << "\" ... " << flush;
   assert(_wordsToWordsIds.size() == 0);
   FILE* file = fopen(fileName.c_str(), "r");
@@ -692,6 +756,7 @@ void ParserBase::writeToWordsFile(const string& word, unsigned int docId,
   // do.
   if (_writeAsciiWordsFile == false &&
       _writeBinaryWordsFile == false &&
+      _writeSortedRuns == false &&
       _writeVocabulary == false) return;
 
   // TODO(celikik): this is a hack which ignores very long words that might
@@ -711,6 +776,16 @@ void ParserBase::writeToWordsFile(const string& word, unsigned int docId,
     // It shouldn't occur anymore, but just to be sure at the moment:
     return;
   }
+  // When parsing into a buffer, the rest is done by writeWordsBuffer.
+  if (_wordsBuffer != NULL)
+  {
+    _wordsBuffer->words.append(word);
+    _wordsBuffer->postings.push_back(_wordsBuffer->words.size());
+    _wordsBuffer->postings.push_back(docId);
+    _wordsBuffer->postings.push_back(score);
+    _wordsBuffer->postings.push_back(position);
+    return;
+  }
   // Get all words to be written: the original word + optionally words from
   // related fuzzy search clusters + optionally words from related synonym
   // groups.
@@ -767,8 +842,8 @@ void ParserBase::writeToWordsFile(const string& word, unsigned int docId,
       fprintf(_ascii_words_file, "%s\t%d\t%d\t%d\n",
               resulting_words[i].c_str(), docId, score, position);
     }
-    // Write to words file in binary.
-    if (_writeBinaryWordsFile)
+    // Write to words file in binary, or add to the sorted runs.
+    if (_writeBinaryWordsFile || _writeSortedRuns)
     {
       const string& word = resulting_words[i];
       if (_wordsToWordsIds.count(word) == 0)
@@ -785,12 +860,32 @@ void ParserBase::writeToWordsFile(const string& word, unsigned int docId,
       buf[1] = docId;
       buf[2] = score;
       buf[3] = position;
-      assert(_binary_words_file);
-      fwrite(&buf, 1, sizeof(buf), _binary_words_file);
+      if (_sortedRunsWriter != NULL)
+        _sortedRunsWriter->add(buf[0], docId, score, position);
+      if (_writeBinaryWordsFile)
+      {
+        assert(_binary_words_file);
+        fwrite(&buf, 1, sizeof(buf), _binary_words_file);
+      }
     }
   }
 }
 
+// ____________________________________________________________________________
+void ParserBase::writeWordsBuffer(const WordsBuffer& buffer)
+{
+  string word;
+  size_t wordStart = 0;
+  for (size_t i = 0; i + 3 < buffer.postings.size(); i += 4)
+  {
+    size_t wordEnd = buffer.postings[i];
+    word.assign(buffer.words, wordStart, wordEnd - wordStart);
+    writeToWordsFile(word, buffer.postings[i + 1], buffer.postings[i + 2],
+                     buffer.postings[i + 3]);
+    wordStart = wordEnd;
+  }
+}
+
 // ____________________________________________________________________________
 void ParserBase::addGlobalInformationToWordsFile()
 {
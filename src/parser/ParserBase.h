@@ -14,6 +14,7 @@
 #include "fuzzysearch/Utils.h"
 #include "parser/SimpleTextParser.h"
 #include "parser/UserDefinedIndexWords.h"
+#include "server/SortedRuns.h"
 #include "synonymsearch/SynonymDictionary.h"
 #include "utility/StringConverter.h"
 
@@ -81,6 +82,22 @@ class ParserBase
   // Maximal length ofy a line that can be read in buffer at one time.
   static const unsigned int MAX_BUFFER_SIZE;
 
+  // Size of the stdio buffers of the output files, so that they are written
+  // in large batches.
+  static const size_t OUTPUT_BUFFER_SIZE;
+
+  // Postings collected by writeToWordsFile instead of writing them, see
+  // _wordsBuffer.
+  struct WordsBuffer
+  {
+    // The words of all postings, one after the other.
+    string words;
+    // Four numbers per posting: the end of its word in words, the doc id, the
+    // score, and the position.
+    vector<unsigned int> postings;
+    void clear() { words.clear(); postings.clear(); }
+  };
+
   // Empty function, which can be redefined to add application based
   // information to the index, e.g. date, name.
   virtual void addGlobalInformationToWordsFile();
@@ -103,6 +120,12 @@ class ParserBase
   bool _writeDocsFile;
   bool _writeAsciiWordsFile;
   bool _writeBinaryWordsFile;
+  // Write sorted runs of postings instead of a words file, see SortedRuns.h.
+  bool _writeSortedRuns;
+  // Memory for the postings of a run (in MB) and the number of threads for
+  // sorting them.
+  size_t _sortedRunsMemoryInMb;
+  size_t _sortedRunsNofThreads;
   bool _writeVocabulary;
   bool _readVocabulary;
   bool _readFuzzySearchClusters;
@@ -116,6 +139,7 @@ class ParserBase
   string _docsFileName;
   string _asciiWordsFileName;
   string _binaryWordsFileName;
+  string _sortedRunsFileName;
   string _logFileName;
   string _vocabularyFileName;
   string _fuzzySearchClustersFileName;
@@ -127,6 +151,7 @@ class ParserBase
   FILE* _docs_file;
   FILE* _ascii_words_file;
   FILE* _binary_words_file;
+  SortedRunsWriter* _sortedRunsWriter;
   FILE* _log_file;
   // Open output files and optionally read vocabulary, synonyn groups, fuzzy
   // search clusters, and user-defined words.
@@ -153,6 +178,22 @@ class ParserBase
   void writeToWordsFile(const string& word, unsigned int docId,
                         unsigned int score, unsigned int position);
 
+  // If not NULL, writeToWordsFile only appends the words to this buffer. This
+  // is for parsers that parse in several threads, each with its own buffer;
+  // the buffers are then written in order with writeWordsBuffer. Words from
+  // fuzzy search clusters and synonym groups are added only then.
+  WordsBuffer* _wordsBuffer;
+
+  // Write all postings from the given buffer to the words file, as if
+  // writeToWordsFile had been called for each of them.
+  void writeWordsBuffer(const WordsBuffer& buffer);
+
+  // Prepare a copy of this parser that was made before init, for parsing
+  // into a words buffer in another thread: read what is needed to produce the
+  // words (user-defined words, maps for the string converter), but open no
+  // files.
+  void initWorker();
+
   // Write the word ":info:<key>:<value>" to the word file for document 0 at
   // position 0 with score 0, where ":" is the configured word separator.
   // This method should be used to add global meta information (see
@@ -0,0 +1,517 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/BlockBoundaries.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include "server/Exception.h"
+#include "server/Globals.h"
+#include "server/Vocabulary.h"
+#include "server/WordsFile.h"
+
+using std::pair;
+
+namespace
+{
+// Sort the most frequent query words first, and equally frequent ones by name.
+template<class Query>
+bool moreFrequent(const Query* x, const Query* y)
+{
+  return x->frequency != y->frequency ? x->frequency > y->frequency
+                                      : x->word < y->word;
+}
+
+// Compare a prefix with the same-length prefix of a word, for upper_bound.
+struct PrefixLess
+{
+  bool operator()(const string& prefix, const string& word) const
+  {
+    return word.compare(0, prefix.size(), prefix) > 0;
+  }
+};
+
+// Split the given line into words at whitespace.
+void splitAtWhitespace(const char* p, const char* end, vector<string>* words)
+{
+  while (p < end)
+  {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+      p++;
+    const char* word = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+      p++;
+    if (word < p) words->push_back(string(word, p - word));
+  }
+}
+}
+
+// _____________________________________________________________________________
+BlockBoundaries::BlockBoundaries()
+  : _totalFrequency(0), _blockOverhead(1000), _backgroundWeight(0.1)
+{
+  _volumeSums.push_back(0);
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::countWordVolumes(const string& wordsFileName,
+                                       const string& format,
+                                       const string& vocabularyFileName)
+{
+  WordsFile wordsFile(wordsFileName);
+  if (format == "ASCII") wordsFile.setFormat(WordsFile::FORMAT_HTDIG);
+  else if (format == "BINARY") wordsFile.setFormat(WordsFile::FORMAT_BINARY);
+  else if (format == "RUNS") wordsFile.setFormat(WordsFile::FORMAT_RUNS);
+  else if (format == "SHORT") wordsFile.setFormat(WordsFile::FORMAT_SHORT);
+  else
+    CS_THROW(Exception::OTHER, "unknown words file format \"" << format << "\"");
+
+  vector<string> words;
+  vector<uint64_t> volumes;
+  if (wordsFile.formatIsBinary())
+  {
+    Vocabulary vocabulary;
+    readWordsFromFile(vocabularyFileName, vocabulary, "vocabulary");
+    words.reserve(vocabulary.size());
+    for (unsigned int i = 0; i < vocabulary.size(); i++)
+      words.push_back(vocabulary[i]);
+    volumes.resize(words.size(), 0);
+  }
+
+  string word;
+  WordId wordId;
+  DocId docId;
+  DiskScore score;
+  Position position;
+  while (true)
+  {
+    if (wordsFile.getNextLine(word, wordId, docId, score, position) == false)
+    {
+      if (wordsFile.isEof()) break;
+      continue;
+    }
+    if (wordsFile.formatIsBinary())
+    {
+      if (wordId < 0 || static_cast<size_t>(wordId) >= volumes.size())
+        CS_THROW(Exception::OTHER, "word id " << wordId << " in \""
+                 << wordsFileName << "\" not in the vocabulary");
+      volumes[wordId]++;
+    }
+    else if (!words.empty() && word == words.back())
+    {
+      volumes.back()++;
+    }
+    else if (!word.empty())
+    {
+      if (!words.empty() && word < words.back())
+        CS_THROW(Exception::OTHER, "words in \"" << wordsFileName
+                 << "\" not sorted (\"" << words.back() << "\" -> \"" << word
+                 << "\")");
+      words.push_back(word);
+      volumes.push_back(1);
+    }
+  }
+  setWordVolumes(words, volumes);
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::setWordVolumes(const vector<string>& words,
+                                     const vector<uint64_t>& volumes)
+{
+  CS_ASSERT_EQ(words.size(), volumes.size());
+  _words = words;
+  _volumeSums.resize(words.size() + 1);
+  _volumeSums[0] = 0;
+  for (size_t i = 0; i < volumes.size(); i++)
+    _volumeSums[i + 1] = _volumeSums[i] + volumes[i];
+  _queries.clear();
+  _queryIds.clear();
+  _totalFrequency = 0;
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::readQueryLog(const string& fileName)
+{
+  FILE* file = fopen(fileName.c_str(), "r");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName << "\"");
+  map<string, size_t> counts;
+  vector<string> words;
+  char* line = NULL;
+  size_t capacity = 0;
+  ssize_t length;
+  while ((length = getline(&line, &capacity, file)) != -1)
+  {
+    words.clear();
+    splitAtWhitespace(line, line + length, &words);
+    for (size_t i = 0; i < words.size(); i++)
+    {
+      const string& word = words[i];
+      size_t start = word[0] == '-' ? 1 : 0;
+      while (start < word.size())
+      {
+        size_t end = word.find('|', start);
+        if (end == string::npos) end = word.size();
+        if (end > start) counts[word.substr(start, end - start)]++;
+        start = end + 1;
+      }
+    }
+  }
+  free(line);
+  fclose(file);
+  for (map<string, size_t>::const_iterator it = counts.begin();
+       it != counts.end(); ++it)
+    addQueryWord(it->first, it->second);
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::addQueryWord(const string& queryWord, size_t count)
+{
+  map<string, size_t>::const_iterator it = _queryIds.find(queryWord);
+  if (it != _queryIds.end())
+  {
+    _queries[it->second].frequency += count;
+    _totalFrequency += count;
+    return;
+  }
+  Query query;
+  if (!wordRange(queryWord, &query.first, &query.last)) return;
+  query.word = queryWord;
+  query.frequency = count;
+  _queryIds[queryWord] = _queries.size();
+  _queries.push_back(query);
+  _totalFrequency += count;
+}
+
+// _____________________________________________________________________________
+bool BlockBoundaries::wordRange(const string& queryWord, size_t* first,
+                                size_t* last) const
+{
+  vector<string>::const_iterator begin, end;
+  size_t separator = queryWord.find("--");
+  if (queryWord.size() >= 2 && queryWord[queryWord.size() - 1] == '*')
+  {
+    // All words with the given prefix: from the prefix up to the first word
+    // whose prefix of the same length is larger.
+    string prefix = queryWord.substr(0, queryWord.size() - 1);
+    begin = std::lower_bound(_words.begin(), _words.end(), prefix);
+    end = std::upper_bound(begin, _words.end(), prefix, PrefixLess());
+  }
+  else if (separator != string::npos && separator > 0
+           && separator + 2 < queryWord.size())
+  {
+    begin = std::lower_bound(_words.begin(), _words.end(),
+                             queryWord.substr(0, separator));
+    end = std::upper_bound(_words.begin(), _words.end(),
+                           queryWord.substr(separator + 2));
+  }
+  else
+  {
+    begin = std::lower_bound(_words.begin(), _words.end(), queryWord);
+    end = std::upper_bound(begin, _words.end(), queryWord);
+  }
+  if (begin >= end) return false;
+  *first = begin - _words.begin();
+  *last = end - _words.begin() - 1;
+  return true;
+}
+
+// _____________________________________________________________________________
+vector<size_t> BlockBoundaries::volumeLayout(uint64_t blockVolume) const
+{
+  vector<size_t> firstWordIds;
+  if (_words.empty()) return firstWordIds;
+  firstWordIds.push_back(0);
+  uint64_t currentVolume = 0;
+  for (size_t i = 0; i < _words.size(); i++)
+  {
+    if (i > 0 && currentVolume >= blockVolume)
+    {
+      firstWordIds.push_back(i);
+      currentVolume = 0;
+    }
+    currentVolume += volume(i, i + 1);
+  }
+  return firstWordIds;
+}
+
+// _____________________________________________________________________________
+vector<size_t> BlockBoundaries::optimize(size_t nofBlocks) const
+{
+  vector<size_t> firstWordIds;
+  size_t n = _words.size();
+  if (n == 0) return firstWordIds;
+  if (nofBlocks < 1) nofBlocks = 1;
+  uint64_t targetVolume = getTotalVolume() / nofBlocks + 1;
+
+  // The candidate first words of a block: words at volume steps of a quarter
+  // of the target volume, and the boundaries of the word ranges of the most
+  // frequent query words.
+  vector<size_t> candidates;
+  candidates.push_back(0);
+  uint64_t step = targetVolume / 4 > 0 ? targetVolume / 4 : 1;
+  uint64_t currentVolume = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (currentVolume >= step)
+    {
+      candidates.push_back(i);
+      currentVolume = 0;
+    }
+    currentVolume += volume(i, i + 1);
+  }
+  vector<const Query*> queries;
+  for (size_t i = 0; i < _queries.size(); i++) queries.push_back(&_queries[i]);
+  std::sort(queries.begin(), queries.end(), &moreFrequent<Query>);
+  size_t maxNofQueries = std::max(static_cast<size_t>(1000), 4 * nofBlocks);
+  for (size_t i = 0; i < queries.size() && i < maxNofQueries; i++)
+  {
+    candidates.push_back(queries[i]->first);
+    candidates.push_back(queries[i]->last + 1);
+  }
+  candidates.push_back(n);
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+
+  // The total frequency of the queries whose range ends before each candidate
+  // and of those whose range starts at or after it.
+  vector<pair<size_t, double> > ends, starts;
+  for (size_t i = 0; i < _queries.size(); i++)
+  {
+    ends.push_back(std::make_pair(_queries[i].last + 1, _queries[i].frequency));
+    starts.push_back(std::make_pair(_queries[i].first, _queries[i].frequency));
+  }
+  std::sort(ends.begin(), ends.end());
+  std::sort(starts.begin(), starts.end());
+  vector<double> frequencyBefore(candidates.size());
+  vector<double> frequencyAfter(candidates.size());
+  double sum = 0;
+  size_t j = 0;
+  for (size_t i = 0; i < candidates.size(); i++)
+  {
+    while (j < ends.size() && ends[j].first <= candidates[i])
+      sum += ends[j++].second;
+    frequencyBefore[i] = sum;
+  }
+  sum = 0;
+  j = starts.size();
+  for (size_t i = candidates.size(); i-- > 0;)
+  {
+    while (j > 0 && starts[j - 1].first >= candidates[i])
+      sum += starts[--j].second;
+    frequencyAfter[i] = sum;
+  }
+
+  // Without a cost per block, the optimum may already have few enough blocks.
+  // Otherwise, find the least cost per block for which it has (binary search
+  // over the cost per block, which is like a Lagrange multiplier).
+  uint64_t maxVolume = 4 * targetVolume;
+  firstWordIds = optimize(candidates, frequencyBefore, frequencyAfter,
+                          maxVolume, 0);
+  if (firstWordIds.size() <= nofBlocks) return firstWordIds;
+  double low = 0;
+  double high = 1;
+  vector<size_t> best;
+  for (size_t i = 0; i < 100; i++, high *= 4)
+  {
+    best = optimize(candidates, frequencyBefore, frequencyAfter, maxVolume,
+                    high);
+    if (best.size() <= nofBlocks) break;
+    low = high;
+  }
+  for (size_t i = 0; i < 40; i++)
+  {
+    double lambda = (low + high) / 2;
+    firstWordIds = optimize(candidates, frequencyBefore, frequencyAfter,
+                            maxVolume, lambda);
+    if (firstWordIds.size() <= nofBlocks)
+    {
+      high = lambda;
+      best.swap(firstWordIds);
+    }
+    else
+    {
+      low = lambda;
+    }
+  }
+  return best;
+}
+
+// _____________________________________________________________________________
+vector<size_t> BlockBoundaries::optimize(const vector<size_t>& candidates,
+                                         const vector<double>& frequencyBefore,
+                                         const vector<double>& frequencyAfter,
+                                         uint64_t maxVolume,
+                                         double lambda) const
+{
+  // cost[b] is the least cost of a layout of the words [0, candidates[b]),
+  // previous[b] the candidate that starts the last block in it.
+  size_t m = candidates.size();
+  double totalFrequency = _totalFrequency > 0 ? _totalFrequency : 1;
+  double backgroundPerPosting = _backgroundWeight * totalFrequency
+      / std::max(getTotalVolume(), static_cast<uint64_t>(1));
+  vector<double> cost(m, 0);
+  vector<size_t> previous(m, 0);
+  for (size_t b = 1; b < m; b++)
+  {
+    cost[b] = -1;
+    for (size_t a = b; a-- > 0;)
+    {
+      uint64_t blockVolume = volume(candidates[a], candidates[b]);
+      if (a + 1 < b && blockVolume > maxVolume) break;
+      double frequency = _totalFrequency - frequencyBefore[a]
+          - frequencyAfter[b];
+      double c = cost[a] + lambda + (blockVolume + _blockOverhead)
+          * (frequency + backgroundPerPosting * blockVolume);
+      if (cost[b] < 0 || c < cost[b])
+      {
+        cost[b] = c;
+        previous[b] = a;
+      }
+    }
+  }
+  vector<size_t> firstWordIds;
+  for (size_t b = m - 1; b > 0; b = previous[b])
+    firstWordIds.push_back(candidates[previous[b]]);
+  std::reverse(firstWordIds.begin(), firstWordIds.end());
+  return firstWordIds;
+}
+
+// _____________________________________________________________________________
+uint64_t BlockBoundaries::readVolume(const vector<size_t>& firstWordIds,
+                                     const Query& query,
+                                     size_t* nofBlocks) const
+{
+  size_t firstBlock = std::upper_bound(firstWordIds.begin(),
+      firstWordIds.end(), query.first) - firstWordIds.begin() - 1;
+  size_t endBlock = std::upper_bound(firstWordIds.begin(),
+      firstWordIds.end(), query.last) - firstWordIds.begin();
+  *nofBlocks = endBlock - firstBlock;
+  size_t end = endBlock < firstWordIds.size() ? firstWordIds[endBlock]
+                                              : _words.size();
+  return volume(firstWordIds[firstBlock], end);
+}
+
+// _____________________________________________________________________________
+BlockBoundaries::Cost BlockBoundaries::predictCost(
+    const vector<size_t>& firstWordIds) const
+{
+  CS_ASSERT(!firstWordIds.empty());
+  CS_ASSERT_EQ(0u, firstWordIds[0]);
+  Cost cost;
+  cost.nofBlocks = firstWordIds.size();
+  cost.maxBlockVolume = 0;
+  for (size_t i = 0; i < firstWordIds.size(); i++)
+  {
+    size_t end = i + 1 < firstWordIds.size() ? firstWordIds[i + 1]
+                                             : _words.size();
+    cost.maxBlockVolume = std::max(cost.maxBlockVolume,
+                                   volume(firstWordIds[i], end));
+  }
+  cost.postingsPerQuery = 0;
+  cost.blocksPerQuery = 0;
+  cost.postingsInRangePerQuery = 0;
+  for (size_t i = 0; i < _queries.size(); i++)
+  {
+    const Query& query = _queries[i];
+    size_t nofBlocks;
+    uint64_t postings = readVolume(firstWordIds, query, &nofBlocks);
+    cost.postingsPerQuery += query.frequency * postings;
+    cost.blocksPerQuery += query.frequency * nofBlocks;
+    cost.postingsInRangePerQuery += query.frequency
+        * volume(query.first, query.last + 1);
+  }
+  if (_totalFrequency > 0)
+  {
+    cost.postingsPerQuery /= _totalFrequency;
+    cost.blocksPerQuery /= _totalFrequency;
+    cost.postingsInRangePerQuery /= _totalFrequency;
+  }
+  return cost;
+}
+
+// _____________________________________________________________________________
+string BlockBoundaries::boundaryPrefix(size_t wordId) const
+{
+  const string& word = _words[wordId];
+  if (wordId == 0) return word.substr(0, 1);
+  const string& previousWord = _words[wordId - 1];
+  size_t i = 0;
+  while (i < previousWord.size() && i < word.size()
+         && previousWord[i] == word[i])
+    i++;
+  return word.substr(0, i + 1);
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::writeBoundaries(const vector<size_t>& firstWordIds,
+                                      const string& fileName) const
+{
+  FILE* file = fopen(fileName.c_str(), "w");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName << "\"");
+  for (size_t i = 0; i < firstWordIds.size(); i++)
+    fprintf(file, "%s\n", boundaryPrefix(firstWordIds[i]).c_str());
+  if (fclose(file) != 0)
+    CS_THROW(Exception::OTHER, "could not write to \"" << fileName << "\"");
+}
+
+// _____________________________________________________________________________
+void BlockBoundaries::writeReport(const vector<size_t>& firstWordIds,
+                                  const vector<size_t>& baselineFirstWordIds,
+                                  ostream& os) const
+{
+  Cost cost = predictCost(firstWordIds);
+  Cost baselineCost = predictCost(baselineFirstWordIds);
+  os << "Predicted cost of the block layout for " << _queries.size()
+     << " distinct query words (total frequency " << _totalFrequency
+     << "), " << _words.size() << " words, " << getTotalVolume()
+     << " postings" << std::endl << std::endl;
+  os << std::fixed << std::setprecision(1);
+  os << std::setw(40) << "" << std::setw(16) << "baseline"
+     << std::setw(16) << "optimised" << std::endl;
+  os << std::setw(40) << std::left << "number of blocks" << std::right
+     << std::setw(16) << baselineCost.nofBlocks
+     << std::setw(16) << cost.nofBlocks << std::endl;
+  os << std::setw(40) << std::left << "max block volume" << std::right
+     << std::setw(16) << baselineCost.maxBlockVolume
+     << std::setw(16) << cost.maxBlockVolume << std::endl;
+  os << std::setw(40) << std::left << "postings decoded per query word"
+     << std::right << std::setw(16) << baselineCost.postingsPerQuery
+     << std::setw(16) << cost.postingsPerQuery << std::endl;
+  os << std::setw(40) << std::left << "blocks read per query word"
+     << std::right << std::setw(16) << baselineCost.blocksPerQuery
+     << std::setw(16) << cost.blocksPerQuery << std::endl;
+  os << std::setw(40) << std::left << "postings in range per query word"
+     << std::right << std::setw(16) << baselineCost.postingsInRangePerQuery
+     << std::setw(16) << cost.postingsInRangePerQuery << std::endl;
+
+  vector<const Query*> queries;
+  for (size_t i = 0; i < _queries.size(); i++) queries.push_back(&_queries[i]);
+  std::sort(queries.begin(), queries.end(), &moreFrequent<Query>);
+  os << std::endl << "Most frequent query words (postings decoded, blocks "
+     << "read):" << std::endl << std::endl;
+  os << std::setw(30) << std::left << "query word" << std::right
+     << std::setw(10) << "count" << std::setw(14) << "in range"
+     << std::setw(20) << "baseline" << std::setw(20) << "optimised"
+     << std::endl;
+  for (size_t i = 0; i < queries.size() && i < 50; i++)
+  {
+    size_t baselineBlocks, blocks;
+    uint64_t baselinePostings = readVolume(baselineFirstWordIds, *queries[i],
+                                           &baselineBlocks);
+    uint64_t postings = readVolume(firstWordIds, *queries[i], &blocks);
+    std::ostringstream baseline, optimised;
+    baseline << baselinePostings << " (" << baselineBlocks << ")";
+    optimised << postings << " (" << blocks << ")";
+    os << std::setw(30) << std::left << queries[i]->word << std::right
+       << std::setw(10) << std::setprecision(0) << queries[i]->frequency
+       << std::setw(14) << volume(queries[i]->first, queries[i]->last + 1)
+       << std::setw(20) << baseline.str() << std::setw(20) << optimised.str()
+       << std::endl;
+  }
+}
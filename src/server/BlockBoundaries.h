@@ -0,0 +1,161 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_BLOCKBOUNDARIES_H_
+#define SERVER_BLOCKBOUNDARIES_H_
+
+#include <stdint.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::ostream;
+using std::string;
+using std::vector;
+
+// Block boundaries of a HYB index chosen for a query log.
+//
+// For a query word (a prefix like info*, a range like a--b or a single word),
+// processBasicQuery reads and decodes every block that overlaps the word
+// range. The predicted cost of a block layout is therefore the expected number
+// of postings decoded per query word, plus a fixed overhead per block read.
+// For each block B, with vol(B) its number of postings and F(B) the total
+// frequency of the query words overlapping it, the cost is
+//
+//   (vol(B) + blockOverhead) * (F(B) + background(B)),
+//
+// where background(B) = backgroundWeight * (total frequency) * vol(B) / (total
+// volume) accounts for queries not in the log (a random posting's word). The
+// cost of a layout is the sum over its blocks, so the best layout with a given
+// number of blocks is found by dynamic programming over the candidate
+// boundaries: the first and one past the last word of each query word range
+// (so that boundaries align with frequently queried prefixes), and words at
+// regular volume steps (so that hot wide blocks can be split anywhere).
+//
+// The boundaries are written as the file of prefixes read by HYBIndex::build
+// (buildIndex -b <file>): one per block, the shortest prefix of its first word
+// that is not a prefix of the word before.
+class BlockBoundaries
+{
+ public:
+  BlockBoundaries();
+
+  // Count the postings of each word in the given words file (format as for
+  // buildIndex; for BINARY and RUNS, the words are read from the given
+  // vocabulary file).
+  void countWordVolumes(const string& wordsFileName, const string& format,
+                        const string& vocabularyFileName);
+
+  // Set the words (sorted) and their number of postings directly.
+  void setWordVolumes(const vector<string>& words,
+                      const vector<uint64_t>& volumes);
+
+  // Count the query words in the given file with one query per line, e.g.
+  // extracted from a query log. The words are matched against the vocabulary
+  // as they are (not normalised). A leading - is ignored, alternatives
+  // separated by | count as separate words, and words that match nothing are
+  // ignored.
+  void readQueryLog(const string& fileName);
+
+  // Add the given query word with the given count.
+  void addQueryWord(const string& queryWord, size_t count);
+
+  // The predicted cost of reading one block, in postings. Default 1000.
+  void setBlockOverhead(double blockOverhead) { _blockOverhead = blockOverhead; }
+
+  // The weight of the queries not in the log, relative to those in the log.
+  // Default 0.1.
+  void setBackgroundWeight(double weight) { _backgroundWeight = weight; }
+
+  // Compute the layout with at most the given number of blocks and the least
+  // predicted cost (fewer blocks if more would not pay off the overhead).
+  // Returns the ids of the first words of the blocks, the first is 0.
+  vector<size_t> optimize(size_t nofBlocks) const;
+
+  // The layout of HYBIndex::build for the given block volume: a block ends
+  // with the first word that makes its volume at least blockVolume.
+  vector<size_t> volumeLayout(uint64_t blockVolume) const;
+
+  // The predicted cost of the given layout.
+  struct Cost
+  {
+    size_t nofBlocks;
+    uint64_t maxBlockVolume;
+    // Per query word in the log (weighted by frequency): postings decoded,
+    // blocks read, and postings in the word range (the least possible).
+    double postingsPerQuery;
+    double blocksPerQuery;
+    double postingsInRangePerQuery;
+  };
+  Cost predictCost(const vector<size_t>& firstWordIds) const;
+
+  // Write the boundary prefixes of the given layout to the given file.
+  void writeBoundaries(const vector<size_t>& firstWordIds,
+                       const string& fileName) const;
+
+  // Write a report comparing the predicted costs of the given layout and of
+  // the given baseline layout, including the most frequent query words.
+  void writeReport(const vector<size_t>& firstWordIds,
+                   const vector<size_t>& baselineFirstWordIds,
+                   ostream& os) const;
+
+  // The number of words, the total volume, and the number of distinct query
+  // words and their total frequency.
+  size_t getNofWords() const { return _words.size(); }
+  uint64_t getTotalVolume() const
+  { return _volumeSums.empty() ? 0 : _volumeSums.back(); }
+  size_t getNofQueryWords() const { return _queries.size(); }
+  double getTotalFrequency() const { return _totalFrequency; }
+
+ private:
+  // A query word: its word range [first, last] and its frequency.
+  struct Query
+  {
+    string word;
+    size_t first;
+    size_t last;
+    double frequency;
+  };
+
+  // The volume of the words [first, end).
+  uint64_t volume(size_t first, size_t end) const
+  {
+    return _volumeSums[end] - _volumeSums[first];
+  }
+
+  // The number of postings in the blocks of the given layout that overlap the
+  // word range of the given query, and the number of these blocks.
+  uint64_t readVolume(const vector<size_t>& firstWordIds, const Query& query,
+                      size_t* nofBlocks) const;
+
+  // The shortest prefix of the given word that is not a prefix of the word
+  // before.
+  string boundaryPrefix(size_t wordId) const;
+
+  // The word range of the given query word, false if it is empty.
+  bool wordRange(const string& queryWord, size_t* first, size_t* last) const;
+
+  // The layout with the least cost + lambda * (number of blocks), over the
+  // given candidate first words (sorted, starting with 0 and ending with the
+  // number of words), with blocks of at most maxVolume (unless one candidate
+  // step alone is larger). The sums of the frequencies of the queries before
+  // and after each candidate are given.
+  vector<size_t> optimize(const vector<size_t>& candidates,
+                          const vector<double>& frequencyBefore,
+                          const vector<double>& frequencyAfter,
+                          uint64_t maxVolume, double lambda) const;
+
+  vector<string> _words;
+  // _volumeSums[i] is the number of postings of the words [0, i).
+  vector<uint64_t> _volumeSums;
+  vector<Query> _queries;
+  // The index in _queries of each query word.
+  map<string, size_t> _queryIds;
+  double _totalFrequency;
+  double _blockOverhead;
+  double _backgroundWeight;
+};
+
+#endif  // SERVER_BLOCKBOUNDARIES_H_
@@ -0,0 +1,165 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "server/BlockBoundaries.h"
+#include "server/Exception.h"
+
+// Words with prefixes a*, b*, c*, each word with the given volume.
+void setWords(BlockBoundaries* boundaries, uint64_t volume)
+{
+  const char* words[] = { "aa", "ab", "ac", "ad", "ba", "bb", "bc", "bd",
+                          "ca", "cb", "cc", "cd" };
+  vector<string> w(words, words + 12);
+  vector<uint64_t> volumes(12, volume);
+  boundaries->setWordVolumes(w, volumes);
+}
+
+// The layout of HYBIndex::build for a given block volume.
+TEST(BlockBoundariesTest, volumeLayout)
+{
+  BlockBoundaries boundaries;
+  setWords(&boundaries, 10);
+  ASSERT_EQ(12u, boundaries.getNofWords());
+  ASSERT_EQ(120u, boundaries.getTotalVolume());
+  vector<size_t> layout = boundaries.volumeLayout(25);
+  ASSERT_EQ(4u, layout.size());
+  ASSERT_EQ(0u, layout[0]);
+  ASSERT_EQ(3u, layout[1]);
+  ASSERT_EQ(6u, layout[2]);
+  ASSERT_EQ(9u, layout[3]);
+}
+
+// Query words and their word ranges.
+TEST(BlockBoundariesTest, addQueryWord)
+{
+  BlockBoundaries boundaries;
+  setWords(&boundaries, 10);
+  boundaries.addQueryWord("b*", 2);
+  boundaries.addQueryWord("ab--ba", 1);
+  boundaries.addQueryWord("cc", 1);
+  boundaries.addQueryWord("b*", 1);
+  boundaries.addQueryWord("x*", 5);
+  boundaries.addQueryWord("ae", 5);
+  ASSERT_EQ(3u, boundaries.getNofQueryWords());
+  ASSERT_EQ(5, boundaries.getTotalFrequency());
+
+  // One block: every query word reads all postings.
+  vector<size_t> layout(1, 0);
+  BlockBoundaries::Cost cost = boundaries.predictCost(layout);
+  ASSERT_EQ(1u, cost.nofBlocks);
+  ASSERT_EQ(120u, cost.maxBlockVolume);
+  ASSERT_DOUBLE_EQ(120, cost.postingsPerQuery);
+  ASSERT_DOUBLE_EQ(1, cost.blocksPerQuery);
+  // b* has 40 postings, ab--ba 40, cc 10.
+  ASSERT_DOUBLE_EQ((3 * 40 + 40 + 10) / 5.0, cost.postingsInRangePerQuery);
+
+  // Blocks [aa, ac), [ac, ba), [ba, cc), [cc, cd].
+  layout.push_back(2);
+  layout.push_back(4);
+  layout.push_back(10);
+  cost = boundaries.predictCost(layout);
+  ASSERT_EQ(4u, cost.nofBlocks);
+  ASSERT_EQ(60u, cost.maxBlockVolume);
+  ASSERT_DOUBLE_EQ((3 * 60 + 100 + 20) / 5.0, cost.postingsPerQuery);
+  ASSERT_DOUBLE_EQ((3 * 1 + 3 + 1) / 5.0, cost.blocksPerQuery);
+}
+
+// Read a query log.
+TEST(BlockBoundariesTest, readQueryLog)
+{
+  string fileName = "BlockBoundariesTest.TMP.queries";
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "a* b*\n");
+  fprintf(file, "-b*\tcc|cd\r\n");
+  fprintf(file, "x* ccc\n");
+  fclose(file);
+  BlockBoundaries boundaries;
+  setWords(&boundaries, 10);
+  boundaries.readQueryLog(fileName);
+  ASSERT_EQ(4u, boundaries.getNofQueryWords());
+  ASSERT_EQ(5, boundaries.getTotalFrequency());
+  remove(fileName.c_str());
+  ASSERT_THROW(boundaries.readQueryLog(fileName), Exception);
+}
+
+// The optimised layout aligns the boundaries with the frequent query words
+// and has no more than the given number of blocks.
+TEST(BlockBoundariesTest, optimize)
+{
+  BlockBoundaries boundaries;
+  setWords(&boundaries, 100);
+  boundaries.setBlockOverhead(10);
+  boundaries.addQueryWord("b*", 100);
+  vector<size_t> baseline = boundaries.volumeLayout(300);
+  ASSERT_EQ(4u, baseline.size());
+  vector<size_t> layout = boundaries.optimize(4);
+  ASSERT_LE(layout.size(), 4u);
+  ASSERT_EQ(0u, layout[0]);
+  // b* is exactly one block.
+  BlockBoundaries::Cost cost = boundaries.predictCost(layout);
+  ASSERT_DOUBLE_EQ(400, cost.postingsPerQuery);
+  ASSERT_DOUBLE_EQ(1, cost.blocksPerQuery);
+  ASSERT_GT(boundaries.predictCost(baseline).postingsPerQuery,
+            cost.postingsPerQuery);
+
+  // A very frequent word in a wide block is split off.
+  boundaries.addQueryWord("bb", 10000);
+  layout = boundaries.optimize(3);
+  ASSERT_EQ(3u, layout.size());
+  ASSERT_EQ(0u, layout[0]);
+  ASSERT_EQ(5u, layout[1]);
+  ASSERT_EQ(6u, layout[2]);
+  cost = boundaries.predictCost(layout);
+  ASSERT_DOUBLE_EQ((10000 * 100 + 100 * 1200) / 10100.0,
+                   cost.postingsPerQuery);
+  layout = boundaries.optimize(2);
+  ASSERT_LE(layout.size(), 2u);
+
+  // Without query words, the blocks have about the same volume.
+  setWords(&boundaries, 100);
+  layout = boundaries.optimize(3);
+  ASSERT_EQ(3u, layout.size());
+  ASSERT_EQ(0u, layout[0]);
+  ASSERT_EQ(4u, layout[1]);
+  ASSERT_EQ(8u, layout[2]);
+}
+
+// The boundary prefixes and the report.
+TEST(BlockBoundariesTest, writeBoundariesAndReport)
+{
+  BlockBoundaries boundaries;
+  const char* words[] = { "algo", "algorithm", "algorithms", "b", "bach" };
+  vector<uint64_t> volumes(5, 1);
+  boundaries.setWordVolumes(vector<string>(words, words + 5), volumes);
+  boundaries.addQueryWord("algorithm*", 3);
+  vector<size_t> layout;
+  layout.push_back(0);
+  layout.push_back(1);
+  layout.push_back(2);
+  layout.push_back(3);
+  layout.push_back(4);
+  string fileName = "BlockBoundariesTest.TMP.boundaries";
+  boundaries.writeBoundaries(layout, fileName);
+  FILE* file = fopen(fileName.c_str(), "r");
+  ASSERT_TRUE(file != NULL);
+  char buffer[100];
+  size_t n = fread(buffer, 1, sizeof(buffer), file);
+  fclose(file);
+  remove(fileName.c_str());
+  ASSERT_EQ("a\nalgor\nalgorithms\nb\nba\n", string(buffer, n));
+
+  std::ostringstream os;
+  boundaries.writeReport(layout, boundaries.volumeLayout(5), os);
+  ASSERT_NE(string::npos, os.str().find("algorithm*"));
+  ASSERT_NE(string::npos, os.str().find("postings decoded per query word"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
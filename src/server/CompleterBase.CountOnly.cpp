@@ -0,0 +1,212 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "CompleterBase.h"
+#include "InfixIndex.h"
+
+extern bool fuzzySearchEnabled;
+
+// _____________________________________________________________________________
+//! Whether the given query asks only for counts
+/*!
+ *    This is the case when no hits are sent (hits are needed neither for the
+ *    result nor for the edit-distance or fuzzy ranking), no positions are
+ *    needed, and the completions are words of the vocabulary (no word id
+ *    map). If the result of the query is in the history already, it is
+ *    cheaper to take it from there.
+ */
+template <unsigned char MODE>
+bool CompleterBase<MODE>::isCountOnlyQuery(const Query& query)
+{
+  return countOnlyQueries
+    && _queryParameters.nofHitsToSend == 0
+    && _queryParameters.howToRankWords
+         != QueryParameters::RANK_WORDS_BY_EDIT_DISTANCE
+    && _queryParameters.howToRankDocs
+         != QueryParameters::RANK_DOCS_BY_FUZZY_SCORE
+    && !_positionsNeeded
+    && _vocabulary->isWordMapTrivial()
+    && query.length() >= MIN_QUERY_LENGTH
+    && getStatusOfHistoryEntry(query) == QueryResult::DOES_NOT_EXIST;
+}
+
+// _____________________________________________________________________________
+//! Process a query for which no hits are sent, from the counts only
+/*!
+ *    Like processComplexQuery, the first part of the query is processed
+ *    recursively (its result is needed as input and is added to the history
+ *    as usual), but for the last part only the counts are computed:
+ *
+ *    1. The counts are in the history            -> take them from there
+ *    2. The last part can use the facet index    -> count its postings
+ *    3. The result of the last part is in history -> count the intersection
+ *    4. Otherwise                                -> countBasicQuery
+ *
+ *    The counts are the same as those computeTopHitsAndCompletions computes
+ *    from the result of the query, and the top completions are selected from
+ *    them like there.
+ */
+template <unsigned char MODE>
+bool CompleterBase<MODE>::processCountOnlyQuery(const Query& query,
+                                                QueryResult*& result)
+{
+  // Only plain prefixes as last part, and only separators that output the
+  // postings of the last part in the docs of the first part.
+  Query firstPart, lastPart;
+  Separator separator;
+  const bool hasManyParts
+    = query.splitAtLastSeparator(&firstPart, &lastPart, &separator);
+  const string& lastPartString = lastPart.getQueryString();
+  if (!hasManyParts)
+    separator = Separator("", pair<signed int, signed int>(-1, -1), FULL);
+  else if (separator._separatorIndex != SAME_DOC
+           || separator.getOutputMode() != Separator::OUTPUT_MATCHES)
+    return false;
+  if (lastPartString == "*"
+      || lastPartString.find(NOT_QUERY_SEP) != string::npos
+      || lastPartString.find(ENHANCED_QUERY_SEP) != string::npos
+      || lastPartString.find(OR_QUERY_SEP) != string::npos
+      || isDocValuesQuery(lastPartString)
+      || (globalInfixIndex != NULL && isInfixQuery(lastPartString))
+      || (fuzzySearchEnabled && lastPart.getLastCharacter() == '~')
+      || lastPart.getLastCharacter() == '^') return false;
+
+  // If the result can be filtered from the result for a prefix of the last
+  // part (CASE 2.1 of processComplexQuery), that is cheaper than counting.
+  if (_queryParameters.useFiltering)
+  {
+    for (signed short i = lastPart.length() - 2; i > 0; --i)
+    {
+      string queryPrefix = query.getQueryString().substr(0,
+          query.length() - lastPart.length() + i);
+      if (getStatusOfHistoryEntry(Query(queryPrefix + "*"))
+            & QueryResult::FINISHED) return false;
+    }
+  }
+
+  log << IF_VERBOSITY_HIGH << "! counting hits and completions of \""
+      << query << "\" only" << endl;
+
+  // The counts depend on how the word scores are aggregated, but not on how
+  // the completions are ranked.
+  ostringstream key;
+  key << query.getQueryString() << getFlagForHistory() << "&counts="
+      << _queryParameters.getScoreAggregationChars();
+  CompletionCountsPtr counts = history->getCounts(key.str());
+  const string* howComputed = &QueryResult::COUNTS_FROM_HISTORY;
+  if (counts == NULL)
+  {
+    howComputed = &QueryResult::COUNTS_ONLY;
+    std::shared_ptr<CompletionCounts> newCounts
+      = std::make_shared<CompletionCounts>();
+    CompletionCounter counter(_queryParameters.wordScoreAggSameDocument,
+                              _queryParameters.wordScoreAggDifferentDocuments);
+
+    // The input: the result of the first part, or all postings.
+    QueryResult fullResult(true);
+    QueryResult* resultFirstPart = &fullResult;
+    if (hasManyParts)
+    {
+      resultFirstPart = NULL;
+      processComplexQuery(firstPart, resultFirstPart);
+      CS_ASSERT(resultFirstPart != NULL);
+      setStatusOfHistoryEntry(firstPart, QueryResult::FINISHED);
+      setStatusOfHistoryEntry(firstPart,
+                              QueryResult::FINISHED | QueryResult::IN_USE);
+      if (!resultFirstPart->check())
+        CS_THROW(Exception::BAD_QUERY_RESULT, "");
+    }
+
+    bool notIntersectionMode;
+    const WordRange wordRange = prefixToRange(lastPartString,
+                                              notIntersectionMode);
+    int facetFieldId = -1;
+    QueryResult* resultLastPart = NULL;
+    if (lastPart.length() == 0 || wordRange.isEmptyRange()
+        || resultFirstPart->isEmpty())
+    {
+      // No hits and no completions.
+    }
+    else if ((facetFieldId = getFacetIndexField(*resultFirstPart, lastPart,
+                                                separator)) != -1)
+    {
+      QueryResult list;
+      processFacetIndexQuery(*resultFirstPart, firstPart, lastPart, separator,
+                             facetFieldId, list);
+      counter.beginSegment(wordRange.firstElement(), wordRange.lastElement());
+      counter.addAll(list, -1, 0);
+      counter.endSegment(newCounts.get());
+    }
+    else if (hasManyParts
+             && (getStatusOfHistoryEntry(lastPart) & QueryResult::FINISHED)
+             && isInHistory(lastPart, resultLastPart))
+    {
+      setStatusOfHistoryEntry(lastPart,
+                              QueryResult::FINISHED | QueryResult::IN_USE);
+      counter.beginSegment(wordRange.firstElement(), wordRange.lastElement());
+      counter.intersect(resultFirstPart->_docIds, *resultLastPart);
+      counter.endSegment(newCounts.get());
+    }
+    else
+    {
+      countBasicQuery(*resultFirstPart, wordRange, separator, &counter,
+                      newCounts.get());
+    }
+    counter.finish(newCounts.get());
+    history->addCounts(key.str(), newCounts, historyMaxSizeOfCountsInBytes);
+    counts = newCounts;
+  }
+
+  // The result with the counts and the top completions, but without postings
+  // and hits.
+  _countOnlyResult = std::make_shared<QueryResult>();
+  QueryResult& countResult = *_countOnlyResult;
+  countResult._query = query;
+  countResult._prefixCompleted = lastPartString;
+  countResult._queryParameters = _queryParameters;
+  countResult.nofTotalHits = counts->nofTotalHits;
+  countResult.nofTotalCompletions = counts->wordIds.size();
+  countResult._topWordIds = counts->wordIds;
+  countResult._topWordScores = counts->scores;
+  countResult._topWordDocCounts = counts->docCounts;
+  countResult._topWordOccCounts = counts->occCounts;
+  selectTopCompletions(countResult, counts->lastDocIds);
+  countResult.setCompletions(countResult._topWordScores,
+                             countResult._topWordDocCounts,
+                             countResult._topWordOccCounts,
+                             *_vocabulary);
+  countResult.setHowResultWasComputed(*howComputed);
+  countResult._status = QueryResult::FINISHED;
+  result = &countResult;
+  return true;
+}
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+void CompleterBase<MODE>::countBasicQuery(const QueryResult& inputList,
+                                          const WordRange& wordRange,
+                                          const Separator& separator,
+                                          CompletionCounter* counter,
+                                          CompletionCounts* counts)
+{
+  QueryResult list;
+  processBasicQuery(inputList, wordRange, list, separator);
+  counter->beginSegment(wordRange.firstElement(), wordRange.lastElement());
+  counter->addAll(list, -1, 0);
+  counter->endSegment(counts);
+}
+
+// EXPLICIT INSTANTIATIONS (so that actual code gets generated)
+template bool
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::isCountOnlyQuery(
+        const Query& query);
+
+template bool
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::processCountOnlyQuery(
+        const Query& query, QueryResult*& result);
+
+template void
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::countBasicQuery(
+        const QueryResult& inputList, const WordRange& wordRange,
+        const Separator& separator, CompletionCounter* counter,
+        CompletionCounts* counts);
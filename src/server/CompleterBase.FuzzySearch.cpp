@@ -305,7 +305,7 @@ void CompleterBase<MODE>::findFuzzySearchQuerySuggestions(
 
   // Check if the whole query has been processed by checking if it is in
   // the history;
-  QueryResult* resultListFromHistory = history->isContained(
+  QueryResult* resultListFromHistory = useHistoryResult(
       query.getQueryString() + "&hf=" + getFlagForHistory());
   if (resultListFromHistory == NULL)
   {
@@ -326,7 +326,7 @@ void CompleterBase<MODE>::findFuzzySearchQuerySuggestions(
     first = temp;
     if (first.getQueryString().size() == 0)
       break;
-    QueryResult* resultListFromHistory = history->isContained(
+    QueryResult* resultListFromHistory = useHistoryResult(
         first.getQueryString() + "&hf=" + getFlagForHistory());
     if (resultListFromHistory == NULL)
     {
@@ -337,6 +337,12 @@ void CompleterBase<MODE>::findFuzzySearchQuerySuggestions(
     else
       if (resultListFromHistory->_docIds.size() == 0)
         return;
+    if (suggestOnlyPhrases && !resultListFromHistory->hasPositions())
+    {
+      log << "! FUZZY: query part " << first.getQueryString()
+          << " has no positions. Query suggestion canceled!" << endl;
+      return;
+    }
     lists.resize(lists.size() + 1);
     lists[keywordCount] = resultListFromHistory;
     keywordCount++;
@@ -794,12 +800,14 @@ void CompleterBase<MODE>::fuzzySearchFilterList(
   newResultList->_positions.reserve(oldResultList._positions.size());
   newResultList->_wordIdsOriginal.reserve(oldResultList._wordIdsOriginal.size());
   newResultList->_scores.reserve(oldResultList._scores.size());
+  const bool withPositions = oldResultList.hasPositions();
   for (size_t i = 0; i < oldResultList._docIds.size(); i++)
   {
     if (hashSet.find(oldResultList._wordIdsOriginal[i]) != hashSet.end())
     {
       newResultList->_docIds.push_back(oldResultList._docIds[i]);
-      newResultList->_positions.push_back(oldResultList._positions[i]);
+      if (withPositions)
+        newResultList->_positions.push_back(oldResultList._positions[i]);
       newResultList->_wordIdsOriginal.push_back(oldResultList._wordIdsOriginal[i]);
       newResultList->_scores.push_back(oldResultList._scores[i]);
     }
@@ -1227,7 +1235,7 @@ void CompleterBase<MODE>::processFuzzySearchQuery
     for (int i = fullQuery.size() - 1; i >= minLength; i--)
     {
       string prefixQuery = fullQuery.substr(0, i) + star + "~" + "&hf=" + getFlagForHistory();
-      QueryResult* resultListFromHistory = history->isContained(prefixQuery);
+      QueryResult* resultListFromHistory = useHistoryResult(prefixQuery);
       if (resultListFromHistory != NULL)
       {
         computedFromHistory = true;
@@ -353,6 +353,12 @@ void CompleterBase<MODE>::intersectTwoPostingListsTemplated
   //Score score;
   //DocId lastDocId1;
   const bool needToCheckPositions = checkPosition.needToCheckPositions();
+  // The lists come without positions if the query does not need them (see
+  // CompleterBase::_positionsNeeded); then the result has none either.
+  const bool copyPositions = input2.hasPositions();
+  if ((MODE & WITH_POS) && needToCheckPositions
+      && !(copyPositions && input1.hasPositions()))
+    CS_THROW(Exception::OTHER, "positions needed but not available");
   const bool needToScanListsToEnd = outputMode == Separator::OUTPUT_MATCHES ? false : true;
   CS_ASSERT(checkPosition.getRight() >= checkPosition.getLeft());
   // at most one of the two is non-zero, examples:
@@ -447,7 +453,7 @@ void CompleterBase<MODE>::intersectTwoPostingListsTemplated
         {
           docIds3.   push_back(docIds2[j]);
           wordIds3.  push_back(wordIds2[j]);
-          positions3.push_back(positions2[j]);
+          if (copyPositions) positions3.push_back(positions2[j]);
           scores3.   push_back(scores2[j]);
           #ifdef CHECK_INTERSECT
           trace.push_back(3);
@@ -505,7 +511,7 @@ void CompleterBase<MODE>::intersectTwoPostingListsTemplated
             {
               docIds3.push_back(docIds2[j]);
               wordIds3.push_back(wordIds2[j]);
-              positions3.push_back(positions2[j]);
+              if (copyPositions) positions3.push_back(positions2[j]);
               scores3.push_back(scores2[j]);
               atLeastOnePostingWritten = true;
               // scores3.push_back(aggregateScores.aggregate(scores1[i], scores2[j]) +
@@ -542,7 +548,7 @@ void CompleterBase<MODE>::intersectTwoPostingListsTemplated
           {
             docIds3.push_back(docId);
             wordIds3.push_back(SPECIAL_WORD_ID);
-            positions3.push_back(SPECIAL_POSITION);
+            if (copyPositions) positions3.push_back(SPECIAL_POSITION);
             scores3.push_back(score);
           }
         }
@@ -1465,14 +1471,9 @@ void CompleterBase<MODE>::intersect
   assert(!andIntersection());
   assert((sizeof(scoreType) == sizeof(DiskScore)) || (sizeof(scoreType) == sizeof(Score)));
   
-  if (resultLists.isLockedForReading) 
-    throw Exception(Exception::RESULT_LOCKED_FOR_READING, "in intersect");
   if (resultLists.isLockedForWriting) 
     throw Exception(Exception::RESULT_LOCKED_FOR_WRITING, "in intersect");
   resultLists.isLockedForWriting = true;
-  if (candidateLists.isLockedForWriting) 
-    throw Exception(Exception::RESULT_LOCKED_FOR_WRITING, "in intersect");
-  candidateLists.isLockedForReading = true; // only unlockd in clean up      
   switch(intersectionMode)
   {
     case SAME_DOC:
@@ -1,4 +1,5 @@
 #include "CompleterBase.h"
+#include "DocValues.h"
 #include <google/dense_hash_map>
 #include <unordered_map>
 #include <unordered_set>
@@ -227,7 +228,7 @@ void CompleterBase<MODE>::computeTopHitsAndCompletions(QueryResult& result,
   CS_ASSERT_EQ(result._docIds.size(), result._wordIdsMapped.size());
   CS_ASSERT_EQ(result._docIds.size(), result._wordIdsOriginal.size());
   CS_ASSERT_EQ(result._docIds.size(), result._scores.size());
-  CS_ASSERT_EQ(result._docIds.size(), result._positions.size());
+  CS_ASSERT(result.hasPositions() || result._positions.size() == 0);
   CS_ASSERT_EQ(result._topDocIds.size(), result._topDocScores.size());
   CS_ASSERT_EQ(result._topWordIds.size(), result._topWordScores.size());
   CS_ASSERT_EQ(result._topWordIds.size(), result._topWordDocCounts.size());
@@ -555,6 +556,34 @@ void CompleterBase<MODE>::computeTopHits(QueryResult& result,
     topDocWordIds.partialSortParallel(topDocScores, topDocIds, k, sortOrder);
     break;
 
+  case QueryParameters::RANK_DOCS_BY_DOC_VALUE:
+    {
+      // Sort by the value of the given field in globalDocValues, with the score
+      // as secondary key. Documents without a value always come last: they get
+      // the largest key when sorting in ascending order and key 0 otherwise.
+      if (globalDocValues == NULL)
+        CS_THROW(Exception::INVALID_PARAMETER_VALUE, "howToRankDocs = "
+                 << _queryParameters.howToRankDocs
+                 << ", but no doc values were read");
+      int fieldId = globalDocValues->getFieldId(_queryParameters.docValuesField);
+      if (fieldId == -1)
+        CS_THROW(Exception::INVALID_PARAMETER_VALUE, "no doc values for field \""
+                 << _queryParameters.docValuesField << "\"");
+      const bool ascending = sortOrder == SORT_ORDER_ASCENDING;
+      Vector<unsigned int> topDocValues;
+      topDocValues.resize(topDocIds.size());
+      for (size_t j = 0; j < topDocIds.size(); j++)
+      {
+        unsigned int value = globalDocValues->getValue(fieldId, topDocIds[j]);
+        if (value == DocValues::NO_VALUE)
+          topDocValues[j] = ascending ? value : 0;
+        else
+          topDocValues[j] = ascending ? value : value + 1;
+      }
+      topDocValues.partialSortParallel(topDocScores, topDocIds, k, sortOrder);
+    }
+    break;
+
   case QueryParameters::RANK_DOCS_BY_DOC_ID:
     if (sortOrder == SORT_ORDER_ASCENDING)
     {
@@ -639,13 +668,10 @@ void CompleterBase<MODE>::computeTopCompletions(QueryResult& result,
   result.nofTotalCompletions = topWordDocIds.size();
 
   //
-  // 2. Partial sort the matching word ids to obtain the top-k completions (k = 0 means all)
+  // 2. For ranking by edit distance, overwrite the scores by the edit
+  // distances, then partial sort the matching word ids to obtain the top-k
+  // completions (see selectTopCompletions).
   //
-  //   Note: partialSortParallel resizes array to size k after partial sort
-  //
-  unsigned int k = _queryParameters.nofTopCompletionsToCompute;
-  if (k == 0 || k > topWordIds.size()) k = topWordIds.size();
-  SortOrderEnum sortOrder = _queryParameters.sortOrderWords;
   if (_queryParameters.howToRankWords == QueryParameters::RANK_WORDS_BY_EDIT_DISTANCE ||
       _queryParameters.howToRankDocs  == QueryParameters::RANK_DOCS_BY_FUZZY_SCORE)
   {
@@ -797,6 +823,40 @@ void CompleterBase<MODE>::computeTopCompletions(QueryResult& result,
       log << IF_VERBOSITY_HIGH << EMPH_OFF BLACK << endl;
     }
   }
+  selectTopCompletions(result, topWordDocIds);
+
+  scoreWordsTimer.stop();
+  CS_ASSERT_EQ(topWordIds.size(), topWordScores.size());
+  CS_ASSERT_EQ(topWordIds.size(), topWordDocCounts.size());
+  CS_ASSERT_EQ(topWordIds.size(), topWordOccCounts.size());
+  log << AT_END_OF_METHOD << "; computed top " << topWordIds.size()
+      << " completions" << endl;
+}
+
+// _____________________________________________________________________________
+//! Select the top-k completions from the aggregated completions
+/*!
+ *    The completions of result (_topWordIds, _topWordScores, _topWordDocCounts
+ *    and _topWordOccCounts, by increasing word id, with the largest doc id of
+ *    each in topWordDocIds) are partially sorted according to howToRankWords
+ *    and sortOrderWords, and cut to k = nofTopCompletionsToCompute (k = 0
+ *    means all). Also stores the scores of the top completions in
+ *    _completionScoresByWordId.
+ *
+ *    Note: partialSortParallel resizes array to size k after partial sort
+ */
+template<unsigned char MODE>
+void CompleterBase<MODE>::selectTopCompletions(QueryResult& result,
+                                               const DocList& topWordDocIds)
+{
+  WordList& topWordIds = result._topWordIds;
+  ScoreList& topWordScores = result._topWordScores;
+  Vector<unsigned int>& topWordDocCounts = result._topWordDocCounts;
+  Vector<unsigned int>& topWordOccCounts = result._topWordOccCounts;
+  unsigned int k = _queryParameters.nofTopCompletionsToCompute;
+  if (k == 0 || k > topWordIds.size()) k = topWordIds.size();
+  SortOrderEnum sortOrder = _queryParameters.sortOrderWords;
+
   switch (_queryParameters.howToRankWords)
   {
   case QueryParameters::RANK_WORDS_BY_SCORE:
@@ -857,13 +917,6 @@ void CompleterBase<MODE>::computeTopCompletions(QueryResult& result,
       << "! NEW: stored " << result._completionScoresByWordId.size()
       << " scores in a hash map --- hopefully not too many, are they?"
       << endl;
-
-  scoreWordsTimer.stop();
-  CS_ASSERT_EQ(topWordIds.size(), topWordScores.size());
-  CS_ASSERT_EQ(topWordIds.size(), topWordDocCounts.size());
-  CS_ASSERT_EQ(topWordIds.size(), topWordOccCounts.size());
-  log << AT_END_OF_METHOD << "; computed top " << topWordIds.size()
-      << " completions" << endl;
 }
 
 template<unsigned char MODE>
@@ -1154,5 +1207,29 @@ template void
     CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::computeTopHitsAndCompletions(
         QueryResult& result);
 
+template void
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::selectTopCompletions(
+        QueryResult& result, const DocList& topWordDocIds);
+
 template void CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::remapWordIds(
     const WordList& wordListIn, WordList* wordListOut);
+
+template void
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::sortAndAggregateByWordId(
+        const DocList& docIds, const WordList& wordIds,
+        const ScoreList& scores, DocList* docIdsAggregated,
+        WordList* wordIdsAggregated, ScoreList* scoresAggregated,
+        Vector<unsigned int>* docCountsAggregated,
+        Vector<unsigned int>* occCountsAggregated,
+        const SumAggregation& wordScoreAggSameDocument,
+        const SumAggregation& wordScoreAggDifferentDocuments);
+
+template void
+    CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS>::sortAndAggregateByWordId(
+        const DocList& docIds, const WordList& wordIds,
+        const ScoreList& scores, DocList* docIdsAggregated,
+        WordList* wordIdsAggregated, ScoreList* scoresAggregated,
+        Vector<unsigned int>* docCountsAggregated,
+        Vector<unsigned int>* occCountsAggregated,
+        const MaxAggregation& wordScoreAggSameDocument,
+        const MaxAggregation& wordScoreAggDifferentDocuments);
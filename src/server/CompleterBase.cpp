@@ -4,6 +4,11 @@
 #include "../utility/TimerStatistics.h"
 #include "./CompleterBase.h"
 #include "./Exception.h"
+#include "./DocValues.h"
+#include "./FacetIndex.h"
+#include "./InfixIndex.h"
+#include "./CustomScorer.h"
+#include "./ExcerptsGenerator.h"
 
 //  Needed for CompleterBase default constructor below.
 Vocabulary emptyVocabulary;
@@ -43,11 +48,15 @@ CompleterBase<MODE>::CompleterBase(      TimedHistory*    history,
   CS_ASSERT(metaInfo);
   CS_ASSERT(fuzzySearcher);
   CompleterBase<MODE>();
+  _positionsNeeded = true;
+  _insideProcessQuery = false;
+  _lastBestMatchWordId = -1;
   _vocabulary = vocabulary;
   _metaInfo = metaInfo;
   _fuzzySearcher = fuzzySearcher;
   this->history = history;
   statusCode = -1;
+  keepAlive = false;
 }
 
 
@@ -62,6 +71,8 @@ CompleterBase<MODE>::CompleterBase(const CompleterBase& orig)
   _fuzzySearcher(orig._fuzzySearcher)
 {
   CompleterBase<MODE>();
+  _positionsNeeded = true;
+  _insideProcessQuery = false;
   #ifndef NDEBUG
   log << " In copy constructor of CompleterBase ..." << endl;
   log << " size of copied vocabulary : " << _vocabulary.size() << endl;
@@ -240,25 +251,48 @@ void CompleterBase<MODE>::processQuery
   {
     Query queryRewritten = query;
 
+    // 0. Decide whether positions are needed (only in the outermost call, the
+    // recursive calls for parts of the query go with the decision made for
+    // the whole query).
+    bool isOutermostCall = !_insideProcessQuery;
+    if (isOutermostCall)
+    {
+      _positionsNeeded = (MODE & WITH_POS)
+        && (queryNeedsPositions(query) || excerptsNeedPositions());
+      _insideProcessQuery = true;
+      // The results of the previous query are no longer used.
+      _historyResultsInUse.clear();
+      _countOnlyResult.reset();
+    }
+
     // 1. Rewrite join blocks: [...#...#...] -> ...#...#... with separators masked
     rewriteJoinBlocks(queryRewritten);
     log << IF_VERBOSITY_HIGH
         << "! query with join blocks rewritten: \"" << queryRewritten << "\"" << endl << flush;
 
-    // 2. Call the internal recursive query processing method
+    // 2. Call the internal recursive query processing method; for a query
+    // without hits, only count (see processCountOnlyQuery)
     try
     {
-      processComplexQuery(queryRewritten, result);
-        // k1_docs, k2_words,
-        // filterResults, useLinearWordlistIntersection);
-      #ifndef NDEBUG
-      cout << "! returned from recursive call (1)" << endl;
-      #endif
-      assert(result); // there will always be a (possibly empty) result
-      assert(result->_status & QueryResult::FINISHED);
-      assert(isInHistoryConst(queryRewritten));
-      setStatusOfHistoryEntry(queryRewritten, QueryResult::FINISHED);
-      setStatusOfHistoryEntry(queryRewritten, QueryResult::FINISHED | QueryResult::IN_USE);
+      if (isOutermostCall && isCountOnlyQuery(queryRewritten)
+          && processCountOnlyQuery(queryRewritten, result))
+      {
+        assert(result != NULL);
+      }
+      else
+      {
+        processComplexQuery(queryRewritten, result);
+          // k1_docs, k2_words,
+          // filterResults, useLinearWordlistIntersection);
+        #ifndef NDEBUG
+        cout << "! returned from recursive call (1)" << endl;
+        #endif
+        assert(result); // there will always be a (possibly empty) result
+        assert(result->_status & QueryResult::FINISHED);
+        assert(isInHistoryConst(queryRewritten));
+        setStatusOfHistoryEntry(queryRewritten, QueryResult::FINISHED);
+        setStatusOfHistoryEntry(queryRewritten, QueryResult::FINISHED | QueryResult::IN_USE);
+      }
     }
 
     // 3. If something went wrong, set result to NULL
@@ -268,11 +302,13 @@ void CompleterBase<MODE>::processQuery
           << "! " << (e.getErrorCode() != Exception::HISTORY_ENTRY_CONFLICT ? "Removing(?) " : "Not removing(?) ")
           << "\"" << queryRewritten << "\" from history" << endl;
       result = NULL;
+      if (isOutermostCall) _insideProcessQuery = false;
       CS_RETHROW(e);
         // log << "! " << e.getFullErrorMessage() << endl;
         // CS_THROW(Exception::ERROR_PASSED_ON, e.getErrorMessage());
         // throw Exception(Exception::ERROR_PASSED_ON, e.getFullErrorMessage());
     }
+    if (isOutermostCall) _insideProcessQuery = false;
   }
 
   if (result->check() == false) CS_THROW(Exception::BAD_QUERY_RESULT, "");
@@ -283,6 +319,40 @@ void CompleterBase<MODE>::processQuery
 } // end: processQuery
 
 
+// _____________________________________________________________________________
+//! Whether positions are needed for the given query.
+/*
+ *    Positions are looked at only by the positional separators (. .. = , ;),
+ *    and by the special queries: or (|), join (#), fuzzy search (~), synonyms
+ *    (^), and masked separators ([ ' ?). For all other queries, e.g. word and
+ *    prefix queries and their intersection, only doc ids, word ids, and
+ *    scores matter.
+ */
+template <unsigned char MODE>
+bool CompleterBase<MODE>::queryNeedsPositions(const Query& query)
+{
+  return query.getQueryString().find_first_of(".=,;|#[~^?'")
+           != string::npos;
+}
+
+// _____________________________________________________________________________
+//! Whether the excerpts for the current query need positions.
+/*
+ *    This is the case when hits are sent with excerpts, and the docs DB has
+ *    word positions: then the excerpts are computed from only the parts of
+ *    the documents around the positions of the hits (see
+ *    ExcerptsGenerator::getExcerpts).
+ */
+template <unsigned char MODE>
+bool CompleterBase<MODE>::excerptsNeedPositions() const
+{
+  return _queryParameters.nofHitsToSend > 0
+    && _queryParameters.nofExcerptsPerHit > 0
+    && excerptsGenerator != NULL
+    && excerptsGenerator->hasDocsWithPositions();
+}
+
+
 // _____________________________________________________________________________
 //! Get the top continuation for a query, e.g. utf8 for !encoding:*
 //
@@ -516,12 +586,8 @@ void CompleterBase<MODE>::processOrQuery
       << "; result2 has " << result2->getNofPostings() << " postings"
       << endl;
   mergeResultsTimer.cont();
-  if (result1->isLockedForWriting) CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "");
-  if (result2->isLockedForWriting) CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "");
   if (result.isLockedForWriting) CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "");
   result.isLockedForWriting = true;
-  result1->isLockedForReading = true; // only unlockd in clean up
-  result2->isLockedForReading = true; // only unlockd in clean up
   // // DEBUG(hannah): OR of equal lists gave trailing zero postings in result list.
   // log << "! result1, result2, and result before merging:" << endl;
   // log << "! result1 address = " << (int)(result1);
@@ -690,7 +756,7 @@ void CompleterBase<MODE>::processBasicQuery
   assert(inputList._status & QueryResult::FINISHED);
   assert( inputList._docIds.isFullList() || inputList._docIds.size() > 0 );
   assert( !(MODE & WITH_SCORES) || inputList._scores.size() == inputList._docIds.size() );
-  assert( !(MODE & WITH_POS) || inputList._positions.size() == inputList._docIds.size() );
+  assert( !(MODE & WITH_POS) || inputList.hasPositions() || inputList._positions.size() == 0);
 
   assert((firstPartOfQuery.length() > 0) || (separator._separatorIndex == FULL));
   assert((separator._separatorIndex != FULL) || (firstPartOfQuery.getQueryString() == ""));
@@ -718,7 +784,7 @@ void CompleterBase<MODE>::processBasicQuery
   // inputList make sense.
   assert( inputList._docIds.isFullList() || inputList._docIds.size() > 0 );
   assert( !(MODE & WITH_SCORES) || inputList._scores.size() == inputList._docIds.size() );
-  assert( !(MODE & WITH_POS) || inputList._positions.size() == inputList._docIds.size() );
+  assert( !(MODE & WITH_POS) || inputList.hasPositions() || inputList._positions.size() == 0);
 
   // NEW(bast, 21Jan10): Maintain _lastBestMatchWordId. In CASE 3 (fuzzy
   // search) this will be set to the id of the word closest to the query word,
@@ -729,6 +795,7 @@ void CompleterBase<MODE>::processBasicQuery
   // word) and in CompleterBase::intersectTwoPostingListsNewTemplated (multiple
   // query words) for each posting that matches _lastBestMatchWordId.
   WordId _lastBestMatchWordId = -1;
+  int facetFieldId = -1;
 
   // CASE 1:  Last part is a join query (of the form [...#...#...])
   if (lastPartOfQuery.getQueryString().find(ENHANCED_QUERY_SEP) != string::npos)
@@ -743,6 +810,31 @@ void CompleterBase<MODE>::processBasicQuery
                      result);
   }
 
+  // CASE 1b: Last part is a doc-values range (of the form
+  // :docvalues:<field>:<low>--<high>)
+  else if (isDocValuesQuery(lastPartOfQuery.getQueryString()))
+  {
+    processDocValuesQuery(inputList,
+                          firstPartOfQuery,
+                          lastPartOfQuery,
+                          separator,
+                          result);
+  }
+
+  // CASE 1c: Last part is a facet prefix (of the form :facet:<field>:...*)
+  // and the facet index can be used for it.
+  else if ((facetFieldId = getFacetIndexField(inputList,
+                                              lastPartOfQuery,
+                                              separator)) != -1)
+  {
+    processFacetIndexQuery(inputList,
+                           firstPartOfQuery,
+                           lastPartOfQuery,
+                           separator,
+                           facetFieldId,
+                           result);
+  }
+
   // CASE 2:  Last part is an or query (of the form ...|...|...)
   else if (lastPartOfQuery.getQueryString().find(OR_QUERY_SEP) != string::npos)
   {
@@ -756,6 +848,18 @@ void CompleterBase<MODE>::processBasicQuery
                    result);
   }
 
+  // CASE 2b: Last part is an infix query (of the form *...*) and there is an
+  // infix index for it.
+  else if (globalInfixIndex != NULL
+           && isInfixQuery(lastPartOfQuery.getQueryString()))
+  {
+    processInfixQuery(inputList,
+                      firstPartOfQuery,
+                      lastPartOfQuery,
+                      separator,
+                      result);
+  }
+
   else if (fuzzySearchEnabled && lastPartOfQuery.getLastCharacter() == '~')
   {
       processFuzzySearchQuery(inputList,
@@ -832,7 +936,7 @@ void CompleterBase<MODE>::processBasicQuery
 
     assert( inputList._docIds.isFullList() || inputList._docIds.size() > 0 );
     assert( !(MODE & WITH_SCORES) || inputList._scores.size() == inputList._docIds.size() );
-    assert( !(MODE & WITH_POS) || inputList._positions.size() == inputList._docIds.size() );
+    assert( !(MODE & WITH_POS) || inputList.hasPositions() || inputList._positions.size() == 0);
 
     // Translate the prefix to the corresponding word range.
     result._query = firstPartOfQuery.getQueryString() + 
@@ -873,7 +977,7 @@ void CompleterBase<MODE>::processBasicQuery
     assert(inputList._status & QueryResult::FINISHED);
     assert( inputList._docIds.isFullList() || inputList._docIds.size() > 0 );
     assert( !(MODE & WITH_SCORES) || inputList._scores.size() == inputList._docIds.size() );
-    assert( !(MODE & WITH_POS) || inputList._positions.size() == inputList._docIds.size() );
+    assert( !(MODE & WITH_POS) || inputList.hasPositions() || inputList._positions.size() == 0);
     // Set _lastBestMatchWordId in case there is an exact match for the query
     // prefix.
     WordId firstWordIdInRange = wordRange.firstElement();
@@ -889,6 +993,378 @@ void CompleterBase<MODE>::processBasicQuery
 }  // end: processBasicQuery
 
 
+// _____________________________________________________________________________
+template <unsigned char MODE>
+bool CompleterBase<MODE>::isDocValuesQuery(const string& queryString)
+{
+  return queryString.find(wordPartSep + string("docvalues") + wordPartSep)
+           != string::npos;
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+bool CompleterBase<MODE>::parseDocValuesQuery(const string& queryString,
+                                              string* fieldName,
+                                              uint32_t* low,
+                                              uint32_t* high)
+{
+  const string prefix = wordPartSep + string("docvalues") + wordPartSep;
+  if (queryString.compare(0, prefix.size(), prefix) != 0) return false;
+  size_t fieldEnd = queryString.find(wordPartSep, prefix.size());
+  if (fieldEnd == string::npos || fieldEnd == prefix.size()) return false;
+  *fieldName = queryString.substr(prefix.size(), fieldEnd - prefix.size());
+  string range = queryString.substr(fieldEnd + 1);
+  if (range.size() > 0 && range[range.size() - 1] == '*')
+    range.erase(range.size() - 1);
+  size_t dashes = range.find("--");
+  if (dashes == string::npos) return false;
+  // Parse the two ends; an empty end means no bound.
+  for (int i = 0; i < 2; i++)
+  {
+    string end = i == 0 ? range.substr(0, dashes) : range.substr(dashes + 2);
+    uint64_t value = 0;
+    for (size_t j = 0; j < end.size(); j++)
+    {
+      if (!isdigit(end[j])) return false;
+      value = 10 * value + (end[j] - '0');
+      if (value >= DocValues::NO_VALUE) return false;
+    }
+    if (i == 0) *low = end.size() > 0 ? value : 0;
+    else *high = end.size() > 0 ? value : DocValues::NO_VALUE - 1;
+  }
+  return true;
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+void CompleterBase<MODE>::processDocValuesQuery
+                            (const QueryResult& inputList,
+                             const Query&       firstPartOfQuery,
+                             const Query&       lastPartOfQuery,
+                             const Separator&   separator,
+                                   QueryResult& result)
+{
+  string fieldName;
+  uint32_t low, high;
+  if (!parseDocValuesQuery(lastPartOfQuery.getQueryString(),
+                           &fieldName, &low, &high))
+    CS_THROW(Exception::BAD_QUERY, "doc values range must be of the form "
+             << wordPartSep << "docvalues" << wordPartSep << "<field>"
+             << wordPartSep << "<low>--<high>, but is \""
+             << lastPartOfQuery.getQueryString() << "\"");
+  if (globalDocValues == NULL)
+    CS_THROW(Exception::BAD_QUERY, "no doc values were read (start the server "
+             "with --read-doc-values)");
+  int fieldId = globalDocValues->getFieldId(fieldName);
+  if (fieldId == -1)
+    CS_THROW(Exception::BAD_QUERY, "no doc values for field \""
+             << fieldName << "\"");
+  // The postings are those of the first part, so there must be one.
+  if (inputList._docIds.isFullList())
+    CS_THROW(Exception::BAD_QUERY, "doc values range \""
+             << lastPartOfQuery.getQueryString()
+             << "\" needs a preceding query part");
+
+  result._query = firstPartOfQuery.getQueryString() +
+                  separator.getSeparatorString() +
+                  lastPartOfQuery.getQueryString();
+  result._prefixCompleted = lastPartOfQuery.getQueryString();
+
+  // Keep the postings of all documents with a value in the range. The postings
+  // of a document are consecutive, so we look up each document only once.
+  const bool withPositions = (MODE & WITH_POS) && inputList.hasPositions();
+  const size_t n = inputList._docIds.size();
+  result._docIds.reserve(n);
+  result._wordIdsOriginal.reserve(n);
+  if (MODE & WITH_SCORES) result._scores.reserve(n);
+  if (withPositions) result._positions.reserve(n);
+  DocId lastDocId = 0;
+  bool keep = false;
+  for (size_t i = 0; i < n; i++)
+  {
+    DocId docId = inputList._docIds[i];
+    if (i == 0 || docId != lastDocId)
+    {
+      keep = globalDocValues->isInRange(fieldId, docId, low, high);
+      lastDocId = docId;
+    }
+    if (!keep) continue;
+    result._docIds.push_back(docId);
+    result._wordIdsOriginal.push_back(inputList._wordIdsOriginal[i]);
+    if (MODE & WITH_SCORES) result._scores.push_back(inputList._scores[i]);
+    if (withPositions) result._positions.push_back(inputList._positions[i]);
+  }
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+bool CompleterBase<MODE>::isInfixQuery(const string& queryString)
+{
+  return queryString.size() >= 3 && queryString[0] == '*'
+         && queryString[queryString.size() - 1] == '*';
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+void CompleterBase<MODE>::processInfixQuery
+                            (const QueryResult& inputList,
+                             const Query&       firstPartOfQuery,
+                             const Query&       lastPartOfQuery,
+                             const Separator&   separator,
+                                   QueryResult& result)
+{
+  const string& queryString = lastPartOfQuery.getQueryString();
+  const string infix
+    = Query::normalizeQueryPart(queryString.substr(1, queryString.size() - 2));
+  log << AT_BEGINNING_OF_METHOD << "; infix is \"" << infix << "\"" << endl;
+  result._query = firstPartOfQuery.getQueryString() +
+                  separator.getSeparatorString() +
+                  queryString;
+  result._prefixCompleted = queryString;
+  if (infix.empty())
+    CS_THROW(Exception::SINGLE_STAR_NOT_ALLOWED, queryString);
+
+  // The words that contain the infix.
+  vector<uint32_t> wordIds;
+  globalInfixIndex->findWordIds(infix, &wordIds);
+  if (infix.find(wordPartSep) == string::npos)
+  {
+    size_t k = 0;
+    for (size_t j = 0; j < wordIds.size(); j++)
+      if ((*_vocabulary)[wordIds[j]].find(wordPartSep) == string::npos)
+        wordIds[k++] = wordIds[j];
+    wordIds.resize(k);
+  }
+  log << IF_VERBOSITY_HIGH << "! infix \"" << infix << "\" is in "
+      << wordIds.size() << " words" << endl;
+  if (wordIds.empty()) return;
+
+  // The postings of each range of these words, via the blocks. Keep the
+  // postings of the infix words, and the special postings (with the scores
+  // from the first part) of the documents where one of these is kept.
+  vector<WordRange> wordRanges;
+  wordRangesForWordIds(wordIds, &wordRanges);
+  log << IF_VERBOSITY_HIGH << "! processing " << wordRanges.size()
+      << " word ranges" << endl;
+  size_t j = 0;
+  for (size_t r = 0; r < wordRanges.size(); r++)
+  {
+    const WordId firstWordId = wordRanges[r].firstElement();
+    const WordId lastWordId = wordRanges[r].lastElement();
+    QueryResult rangeResult;
+    processBasicQuery(inputList, wordRanges[r], rangeResult, separator);
+    vector<bool> isInfixWord(lastWordId - firstWordId + 1, false);
+    for (; j < wordIds.size() && WordId(wordIds[j]) <= lastWordId; j++)
+      isInfixWord[wordIds[j] - firstWordId] = true;
+
+    const bool withPositions = (MODE & WITH_POS) && rangeResult.hasPositions();
+    const DocList& docIds = rangeResult._docIds;
+    const WordList& wordIdsOfPostings = rangeResult._wordIdsOriginal;
+    const size_t n = docIds.size();
+    size_t i = 0;
+    while (i < n)
+    {
+      const DocId docId = docIds[i];
+      size_t end = i;
+      bool keep = false;
+      for (; end < n && docIds[end] == docId; end++)
+      {
+        WordId wordId = wordIdsOfPostings[end];
+        keep = keep || (wordId >= firstWordId && wordId <= lastWordId
+                        && isInfixWord[wordId - firstWordId]);
+      }
+      for (; keep && i < end; i++)
+      {
+        WordId wordId = wordIdsOfPostings[i];
+        if (wordId != SPECIAL_WORD_ID
+            && (wordId < firstWordId || wordId > lastWordId
+                || !isInfixWord[wordId - firstWordId])) continue;
+        result._docIds.push_back(docId);
+        result._wordIdsOriginal.push_back(wordId);
+        if (MODE & WITH_SCORES)
+          result._scores.push_back(rangeResult._scores[i]);
+        if (withPositions)
+          result._positions.push_back(rangeResult._positions[i]);
+      }
+      i = end;
+    }
+  }
+
+  // Merge the results of the ranges. A document can then have a special
+  // posting from each range; keep one, at the end of its postings.
+  if (wordRanges.size() > 1)
+  {
+    DocList& docIds = result._docIds;
+    WordList& wordIdsOfPostings = result._wordIdsOriginal;
+    Vector<Score>& scores = result._scores;
+    Vector<Position>& positions = result._positions;
+    const bool withPositions = (MODE & WITH_POS) && result.hasPositions();
+    if (withPositions)
+      docIds.sortParallel(positions, scores, wordIdsOfPostings);
+    else
+      docIds.sortParallel(scores, wordIdsOfPostings);
+    size_t k = 0;
+    size_t i = 0;
+    while (i < docIds.size())
+    {
+      const DocId docId = docIds[i];
+      bool hasSpecialPosting = false;
+      Score specialScore = 0;
+      Position specialPosition = 0;
+      for (; i < docIds.size() && docIds[i] == docId; i++)
+      {
+        if (wordIdsOfPostings[i] == SPECIAL_WORD_ID)
+        {
+          if (!hasSpecialPosting)
+          {
+            specialScore = scores[i];
+            if (withPositions) specialPosition = positions[i];
+          }
+          hasSpecialPosting = true;
+          continue;
+        }
+        docIds[k] = docId;
+        wordIdsOfPostings[k] = wordIdsOfPostings[i];
+        scores[k] = scores[i];
+        if (withPositions) positions[k] = positions[i];
+        k++;
+      }
+      if (!hasSpecialPosting) continue;
+      docIds[k] = docId;
+      wordIdsOfPostings[k] = SPECIAL_WORD_ID;
+      scores[k] = specialScore;
+      if (withPositions) positions[k] = specialPosition;
+      k++;
+    }
+    docIds.resize(k);
+    wordIdsOfPostings.resize(k);
+    scores.resize(k);
+    if (withPositions) positions.resize(k);
+  }
+  log << AT_END_OF_METHOD << "; result has " << result.getSize()
+      << " postings" << endl;
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+void CompleterBase<MODE>::wordRangesForWordIds(const vector<uint32_t>& wordIds,
+                                               vector<WordRange>* wordRanges)
+  const
+{
+  wordRanges->clear();
+  if (wordIds.empty()) return;
+  wordRanges->push_back(WordRange(wordIds.front(), wordIds.back()));
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+int CompleterBase<MODE>::getFacetIndexField(const QueryResult& inputList,
+                                            const Query& lastPartOfQuery,
+                                            const Separator& separator) const
+{
+  if (globalFacetIndex == NULL || _positionsNeeded) return -1;
+  if (separator._separatorIndex != SAME_DOC
+      || separator.getOutputMode() != Separator::OUTPUT_MATCHES) return -1;
+  if (inputList._docIds.isFullList()) return -1;
+  const string& queryString = lastPartOfQuery.getQueryString();
+  const string prefix = wordPartSep + string("facet") + wordPartSep;
+  if (queryString.compare(0, prefix.size(), prefix) != 0) return -1;
+  if (queryString[queryString.size() - 1] != '*') return -1;
+  size_t fieldEnd = queryString.find(wordPartSep, prefix.size());
+  if (fieldEnd == string::npos) return -1;
+  return globalFacetIndex->getFieldId(
+      queryString.substr(prefix.size(), fieldEnd - prefix.size()));
+}
+
+
+// _____________________________________________________________________________
+template <unsigned char MODE>
+void CompleterBase<MODE>::processFacetIndexQuery
+                            (const QueryResult& inputList,
+                             const Query&       firstPartOfQuery,
+                             const Query&       lastPartOfQuery,
+                             const Separator&   separator,
+                                   int          fieldId,
+                                   QueryResult& result)
+{
+  log << AT_BEGINNING_OF_METHOD << "; field is \""
+      << globalFacetIndex->getFieldName(fieldId) << "\"" << endl;
+  result._query = firstPartOfQuery.getQueryString() +
+                  separator.getSeparatorString() +
+                  lastPartOfQuery.getQueryString();
+  result._prefixCompleted = lastPartOfQuery.getQueryString();
+  bool notIntersectionMode;
+  const WordRange wordRange = prefixToRange(lastPartOfQuery.getQueryString(),
+                                            notIntersectionMode);
+  if (wordRange.isEmptyRange()) return;
+  const WordId firstWordId = wordRange.firstElement();
+  const WordId lastWordId = wordRange.lastElement();
+
+  // All facet postings of a field have the same score (truncated to a disk
+  // score like in WordsFile::getNextLine), see FacetIndex.h.
+  const DiskScore facetScore = static_cast<DiskScore>(
+      globalFacetIndex->getScore(fieldId));
+
+  // For each document of the first part, write a posting for each of its facet
+  // words in the word range, followed by a special posting with the aggregated
+  // scores from the first part. This is exactly what intersectTwoPostingLists
+  // gives when positions need not be checked.
+  SumAggregation sumAggregation;
+  MaxAggregation maxAggregation;
+  const bool aggregateByMax
+    = _queryParameters.docScoreAggDifferentQueryParts == SCORE_AGG_MAX;
+  const DocList& docIds1 = inputList._docIds;
+  const WordList& wordIds1 = inputList._wordIdsOriginal;
+  const ScoreList& scores1 = inputList._scores;
+  const size_t len1 = docIds1.size();
+  DocList& docIds3 = result._docIds;
+  WordList& wordIds3 = result._wordIdsOriginal;
+  ScoreList& scores3 = result._scores;
+  size_t i = 0;
+  while (i < len1)
+  {
+    DocId docId = docIds1[i];
+    const uint32_t* valueId;
+    const uint32_t* valueIdsEnd;
+    globalFacetIndex->getValueIds(fieldId, docId, &valueId, &valueIdsEnd);
+    bool atLeastOnePostingWritten = false;
+    for (; valueId < valueIdsEnd; ++valueId)
+    {
+      WordId wordId = globalFacetIndex->getWordId(fieldId, *valueId);
+      if (wordId < firstWordId || wordId > lastWordId) continue;
+      docIds3.push_back(docId);
+      wordIds3.push_back(wordId);
+      scores3.push_back(globalCustomScorer != NULL
+          ? globalCustomScorer->getScore(wordId, facetScore)
+          : static_cast<Score>(facetScore));
+      atLeastOnePostingWritten = true;
+    }
+    if (!atLeastOnePostingWritten)
+    {
+      while (i < len1 && docIds1[i] == docId) ++i;
+      continue;
+    }
+    Score score = scores1[i++];
+    while (i < len1 && docIds1[i] == docId)
+      score = wordIds1[i] == SPECIAL_WORD_ID
+        ? sumAggregation.aggregate(score, scores1[i++])
+        : aggregateByMax ? maxAggregation.aggregate(score, scores1[i++])
+                         : sumAggregation.aggregate(score, scores1[i++]);
+    docIds3.push_back(docId);
+    wordIds3.push_back(SPECIAL_WORD_ID);
+    scores3.push_back(score);
+  }
+  log << AT_END_OF_METHOD << "; result has " << result.getSize()
+      << " postings" << endl;
+}
+
+
 // _____________________________________________________________________________
 //! Process query, by recursing on part preceding last separator
 /*!
@@ -1118,7 +1594,7 @@ void CompleterBase<MODE>::processComplexQuery
     //
     //   - larger value for nofTopHitsToCompute
     //   - larger value for nofTopCompletionsToCompute
-    //   - different value of howToRankDocs
+    //   - different value of howToRankDocs (or docValuesField)
     //   - different value of howToRankWords
     //   - different value of sortOrderDocs
     //   - different value of sortOrderWords
@@ -1132,6 +1608,7 @@ void CompleterBase<MODE>::processComplexQuery
     bool needToRecomputeCompletions =    result->nofTotalCompletions > (WordId)(result->_topWordIds.size())
                                       && k2_words                    > (WordId)(result->_topWordIds.size());
     bool needToRerankHits           =    _queryParameters.howToRankDocs                   != result->_queryParameters.howToRankDocs
+                                      || _queryParameters.docValuesField                  != result->_queryParameters.docValuesField
                                       || _queryParameters.fuzzyDamping                    != result->_queryParameters.fuzzyDamping
                                       || _queryParameters.docScoreAggSameCompletion       != result->_queryParameters.docScoreAggSameCompletion
                                       || _queryParameters.docScoreAggDifferentCompletions != result->_queryParameters.docScoreAggDifferentCompletions;
@@ -1182,8 +1659,6 @@ void CompleterBase<MODE>::processComplexQuery
       broadHistoryTimer0.stop();
       broadHistoryTimer.stop();
       assert(!(result->_status & QueryResult::FINISHED));
-      if (result->isLockedForReading)
-      CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "in method topMatchesFromAllMatches");
       if (result->isLockedForWriting)
       CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "in method topMatchesFromAllMatches");
       result->isLockedForWriting = true;
@@ -1210,11 +1685,9 @@ void CompleterBase<MODE>::processComplexQuery
         assert (result->_topWordDocCounts.operator[](i) <=  result->_topWordOccCounts.operator[](i));
       }
       #endif
-      assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+      assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
       assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
       // create the strings to display
-      if (result->isLockedForReading)
-        throw Exception(Exception::RESULT_LOCKED_FOR_READING, "before setting completions");
       if (result->isLockedForWriting)
         throw Exception(Exception::RESULT_LOCKED_FOR_WRITING, "before setting completions");
       result->isLockedForWriting = true;
@@ -1225,14 +1698,12 @@ void CompleterBase<MODE>::processComplexQuery
       if (!result->isLockedForWriting)
         throw Exception(Exception::RESULT_NOT_LOCKED_FOR_WRITING, "after setting completions");
       result->isLockedForWriting = false;
-      assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+      assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
       assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
       assert(result->_docIds.isSorted());
       result->_docIds.markAsSorted(true); // TODO: obsolete, but leave here for now for some checks
 
       assert(result == isInHistory(query));
-      if (result->isLockedForReading)
-       throw Exception(Exception::RESULT_LOCKED_FOR_READING, "before freeExtraSpace");
       if (result->isLockedForWriting)
        throw Exception(Exception::RESULT_LOCKED_FOR_WRITING, "before freeExtraSpace");
       result->isLockedForWriting = true;
@@ -1244,7 +1715,7 @@ void CompleterBase<MODE>::processComplexQuery
       //history.finalizeSize(query.getQueryString());
       finalizeSizeOfHistory(query);
       result->setHowResultWasComputed(QueryResult::FROM_HISTORY_TOPK_AGAIN);
-      assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+      assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
       assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
     }
     //
@@ -1292,7 +1763,7 @@ void CompleterBase<MODE>::processComplexQuery
     log << "! adding query : " << query.getQueryString()  << " to history " << endl;
     #endif
 
-    addToHistory(query, QueryResult()); // add an empty result to history: ONLY DONE HERE!
+    addToHistory(query, std::make_shared<QueryResult>()); // add an empty result to history: ONLY DONE HERE!
     assert(getStatusOfHistoryEntry(query)==QueryResult::UNDER_CONSTRUCTION);
     assert(result == NULL);
 
@@ -1367,6 +1838,7 @@ void CompleterBase<MODE>::processComplexQuery
          && lastPart.getQueryString().find(NOT_QUERY_SEP)      == string::npos
          && lastPart.getQueryString().find(ENHANCED_QUERY_SEP) == string::npos
          && lastPart.getQueryString().find(OR_QUERY_SEP)       == string::npos
+         && isDocValuesQuery(lastPart.getQueryString())        == false
          && splitSeparator.getOutputMode()                     == Separator::OUTPUT_MATCHES
          && wordRange.isEmptyRange()                           == false)
     {
@@ -1403,11 +1875,6 @@ void CompleterBase<MODE>::processComplexQuery
               || resultForFiltering->_docIds.size() == 0);
           broadHistoryTimer1.stop();
           broadHistoryTimer2.cont();
-          if (resultForFiltering->isLockedForWriting)
-            CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before copy and filter");
-          resultForFiltering->isLockedForReading = true; // only unlockd in clean up
-          if (result->isLockedForReading)
-            CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before copy and filter");
           if (result->isLockedForWriting)
             CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before copy and filter");
           result->isLockedForWriting = true;
@@ -1458,6 +1925,7 @@ void CompleterBase<MODE>::processComplexQuery
          && lastPart .getQueryString().find(NOT_QUERY_SEP)      == string::npos
          && firstPart.getQueryString().find(ENHANCED_QUERY_SEP) == string::npos
          && lastPart .getQueryString().find(OR_QUERY_SEP)       == string::npos
+         && isDocValuesQuery(query.getQueryString())            == false
          && splitSeparator.getOutputMode()                      == Separator::OUTPUT_MATCHES
          && wordRange.isEmptyRange()                            == false
          && resultFoundByFiltering                              == false
@@ -1847,7 +2315,7 @@ void CompleterBase<MODE>::processComplexQuery
         assert(resultFirstPart->_status & QueryResult::FINISHED);
         assert( resultFirstPart->_docIds.isFullList() || resultFirstPart->_docIds.size() > 0 );
         if (MODE & WITH_SCORES) assert(resultFirstPart->_scores.size() == resultFirstPart->_docIds.size());
-        if (MODE & WITH_POS)    assert(resultFirstPart->_positions.size() == resultFirstPart->_docIds.size());
+        if (MODE & WITH_POS)    assert(resultFirstPart->hasPositions() || resultFirstPart->_positions.size() == 0);
         //
         // TODO: deal with case here that last part of query is in history. This
         // was previously dealt with in HybCompleter::processBasicQuery, which
@@ -1923,7 +2391,7 @@ void CompleterBase<MODE>::processComplexQuery
       broadHistoryTimer.stop();
       assert( fullResult._docIds.isFullList() || fullResult._docIds.size() > 0 );
       if (MODE & WITH_SCORES) assert(fullResult._scores.size() == fullResult._docIds.size());
-      if (MODE & WITH_POS) assert(fullResult._positions.size() == fullResult._docIds.size());
+      if (MODE & WITH_POS) assert(fullResult.hasPositions() || fullResult._positions.size() == 0);
       assert(fullResult._status & QueryResult::FINISHED);
       processBasicQuery(fullResult, firstPart, lastPart, fullSeparator, *result); // , NULL, useLinearWordlistIntersection); // NULL: 'Last part' cannot be read from history
       assert(result->_docIds.size() == result->_wordIdsOriginal.size());
@@ -1950,12 +2418,10 @@ void CompleterBase<MODE>::processComplexQuery
     // 2.7 TOP-K HITS AND COMPLETIONS
     //
     assert((result->_status == QueryResult::UNDER_CONSTRUCTION) || (notIntersectionMode));
-    assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+    assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
     assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      if (result->isLockedForReading)
-        CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before topMatchesFromAllMatches");
       if (result->isLockedForWriting)
         CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before topMatchesFromAllMatches");
       result->isLockedForWriting = true;
@@ -1972,7 +2438,7 @@ void CompleterBase<MODE>::processComplexQuery
     }
     broadHistoryTimer.cont();
     broadHistoryTimer5.cont();
-    assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+    assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
     assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
     assert( ( result->_docIds.size() == 0) || ( result->_topWordScores.size() > 0  ));
     assert(result->_docIds.isSorted());
@@ -1996,7 +2462,7 @@ void CompleterBase<MODE>::processComplexQuery
     //
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+      assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
       assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
       result->setCompletions(result->_topWordScores, result->_topWordDocCounts,
           result->_topWordOccCounts, *_vocabulary);
@@ -2010,10 +2476,8 @@ void CompleterBase<MODE>::processComplexQuery
     assert(result == isInHistory(query));
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      if (MODE & WITH_POS )    assert(result->_docIds.size() == result->_positions.size());
+      if (MODE & WITH_POS )    assert(result->hasPositions() || result->_positions.size() == 0);
       if (MODE & WITH_SCORES ) assert(result->_docIds.size() == result->_scores.size());
-      if (result->isLockedForReading)
-        CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before freeExtraSpace");
       if (result->isLockedForWriting)
         CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before freeExtraSpace");
       result->isLockedForWriting = true;
@@ -2024,7 +2488,7 @@ void CompleterBase<MODE>::processComplexQuery
       // CHANGE(hagn, 28Jan11):
       //history.finalizeSize(query.getQueryString());
       finalizeSizeOfHistory(query);
-      if (MODE & WITH_POS)    assert(result->_docIds.size() == result->_positions.size());
+      if (MODE & WITH_POS)    assert(result->hasPositions() || result->_positions.size() == 0);
       if (MODE & WITH_SCORES) assert(result->_docIds.size() == result->_scores.size());
       assert(isInHistoryConst(query));
       setStatusOfHistoryEntry(query, QueryResult::FINISHED);
@@ -2445,8 +2909,11 @@ void CompleterBase<MODE>::copyAndFilter(      vW& filteredWords,
                                               vP& filteredPositionlist,
                                               vS& filteredScorelist)
 {
+  // Positions are copied only if there are any, see _positionsNeeded.
+  const bool withPositions = (MODE & WITH_POS)
+    && unfilteredPositionlist.size() == unfilteredDoclist.size();
   if (MODE & WITH_POS)
-    assert(unfilteredPositionlist.size() == unfilteredDoclist.size());
+    assert(withPositions || unfilteredPositionlist.size() == 0);
   if (MODE & WITH_POS)
     assert(unfilteredDoclist.isSorted());
   if (MODE & WITH_SCORES)
@@ -2457,7 +2924,7 @@ void CompleterBase<MODE>::copyAndFilter(      vW& filteredWords,
   const unsigned long nofElementsToScan = unfilteredWordlist.size();
   filteredWords.resize(nofElementsToScan);
   filteredDocs.resize(nofElementsToScan);
-  if (MODE & WITH_POS)    filteredPositionlist.resize(nofElementsToScan);
+  if (withPositions)      filteredPositionlist.resize(nofElementsToScan);
   if (MODE & WITH_SCORES) filteredScorelist.resize(nofElementsToScan);
   unsigned int nofMatches = 0;
   unsigned int lastDocIdThatPassedThroughFilter = MAX_DOC_ID;
@@ -2475,7 +2942,7 @@ void CompleterBase<MODE>::copyAndFilter(      vW& filteredWords,
       filteredWords[nofMatches] = wordId;
       filteredDocs [nofMatches] = docId;
       lastDocIdThatPassedThroughFilter = docId;
-      if (MODE & WITH_POS)
+      if (withPositions)
         filteredPositionlist[nofMatches] = unfilteredPositionlist[i];
       if (MODE & WITH_SCORES)
         filteredScorelist[nofMatches] = unfilteredScorelist[i];
@@ -2496,7 +2963,8 @@ void CompleterBase<MODE>::copyAndFilter(      vW& filteredWords,
   }
   filteredWords.resize(nofMatches);
   filteredDocs.resize(nofMatches);
-  if (MODE & WITH_POS) filteredPositionlist.resize(nofMatches);
+  if (withPositions) filteredPositionlist.resize(nofMatches);
+  else filteredPositionlist.clear();
   if (MODE & WITH_SCORES) filteredScorelist.resize(nofMatches);
 }
 
@@ -3083,6 +3551,9 @@ string CompleterBase<MODE>::getFlagForHistory()
     default:
       retVal << History::HISTORY_FLAG_STD;
   }
+  // Results computed without positions must not be reused for a query that
+  // needs them, see _positionsNeeded.
+  if (_positionsNeeded && (MODE & WITH_POS)) retVal << "&pos=1";
   // NEW (baumgari) 12Nov14:
   // If ".." is used, also store start and end of the intersection window, since
   // the results differs for the same query.
@@ -3111,7 +3582,7 @@ void CompleterBase<MODE>::finalizeSizeOfHistory(const Query& query)
 
 template <unsigned char MODE>
 void CompleterBase<MODE>::addToHistory(const Query& query,
-                                       const QueryResult& result)
+                                       const QueryResultPtr& result)
 {
   // historyTimer.cont();
   // CHANGE(hagn, 28Jan11):
@@ -3142,7 +3613,7 @@ QueryResult* CompleterBase<MODE>::isInHistory(const Query& query)
   //QueryResult* retVal = history.isContained(query.getQueryString());
   ostringstream strQuery;
   strQuery << query.getQueryString() << getFlagForHistory();
-  QueryResult* retVal = history->isContained(strQuery.str());
+  QueryResult* retVal = useHistoryResult(strQuery.str());
   // historyTimer.stop();
   return retVal;
 }
@@ -3155,7 +3626,7 @@ const QueryResult* CompleterBase<MODE>::isInHistoryConst(const Query& query)
   //const QueryResult* retVal = history.isContained(query.getQueryString());
   ostringstream strQuery;
   strQuery << query.getQueryString() << getFlagForHistory();
-  const QueryResult* retVal = history->isContained(strQuery.str());
+  const QueryResult* retVal = useHistoryResult(strQuery.str());
   // historyTimer.stop();
   return retVal;
 }
@@ -3170,12 +3641,23 @@ bool CompleterBase<MODE>::isInHistory(const Query& query, QueryResult*& result)
   //bool retVal = history.isContained(query.getQueryString(), result);
   ostringstream strQuery;
   strQuery << query.getQueryString() << getFlagForHistory();
-  bool retVal = history->isContained(strQuery.str(), result);
+  result = useHistoryResult(strQuery.str());
+  bool retVal = result != NULL;
   // historyTimer.stop();
   assert((!retVal && !isInHistory(query)) || (retVal && isInHistory(query)));
   return retVal;
 }
 
+// _____________________________________________________________________________
+template <unsigned char MODE>
+QueryResult* CompleterBase<MODE>::useHistoryResult(const string& key)
+{
+  QueryResultPtr result = history->get(key);
+  if (!result) return NULL;
+  _historyResultsInUse.insert(result);
+  return result.get();
+}
+
 template <unsigned char MODE>
 //unsigned char CompleterBase<MODE>::getStatusOfHistoryEntry(const Query& query) const
 unsigned char CompleterBase<MODE>::getStatusOfHistoryEntry(const Query& query)
@@ -3360,8 +3842,28 @@ CompleterBase<MODE>::processQuery_NEW
     rewriteJoinBlocks(queryRewritten);
     log << IF_VERBOSITY_HIGH
         << "! query with join blocks rewritten: \"" << queryRewritten << "\"" << endl << flush;
-    // 2. Call the internal recursive query processing method
-    unsigned int retval = processComplexQuery_NEW(queryRewritten, result);
+    // 2. Call the internal recursive query processing method (deciding
+    // whether positions are needed, as in processQuery)
+    bool isOutermostCall = !_insideProcessQuery;
+    if (isOutermostCall)
+    {
+      _positionsNeeded = (MODE & WITH_POS)
+        && (queryNeedsPositions(query) || excerptsNeedPositions());
+      _insideProcessQuery = true;
+      // The results of the previous query are no longer used.
+      _historyResultsInUse.clear();
+    }
+    unsigned int retval;
+    try
+    {
+      retval = processComplexQuery_NEW(queryRewritten, result);
+    }
+    catch (Exception& e)
+    {
+      if (isOutermostCall) _insideProcessQuery = false;
+      CS_RETHROW(e);
+    }
+    if (isOutermostCall) _insideProcessQuery = false;
     switch (retval)
     {
       // case 0:
@@ -3438,7 +3940,6 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
       setStatusOfHistoryEntry(query, QueryResult::UNDER_CONSTRUCTION);
       broadHistoryTimer0.stop();
       broadHistoryTimer.stop();
-      if (result->isLockedForReading) return Exception::RESULT_LOCKED_FOR_READING;
       if (result->isLockedForWriting) return Exception::RESULT_LOCKED_FOR_WRITING;
       
       // Do the recomputation.
@@ -3504,7 +4005,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
     log << "! adding query : " << query.getQueryString()  << " to history " << endl;
     #endif
 
-    addToHistory(query, QueryResult()); // add an empty result to history: ONLY DONE HERE!
+    addToHistory(query, std::make_shared<QueryResult>()); // add an empty result to history: ONLY DONE HERE!
     assert(getStatusOfHistoryEntry(query)==QueryResult::UNDER_CONSTRUCTION);
     assert(result == NULL);
 
@@ -3578,6 +4079,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
          && lastPart.getQueryString().find(NOT_QUERY_SEP)      == string::npos
          && lastPart.getQueryString().find(ENHANCED_QUERY_SEP) == string::npos
          && lastPart.getQueryString().find(OR_QUERY_SEP)       == string::npos
+         && isDocValuesQuery(lastPart.getQueryString())        == false
          && splitSeparator.getOutputMode()                     == Separator::OUTPUT_MATCHES
          && wordRange.isEmptyRange()                           == false)
     {
@@ -3613,11 +4115,6 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
               || resultForFiltering->_docIds.size() == 0);
           broadHistoryTimer1.stop();
           broadHistoryTimer2.cont();
-          if (resultForFiltering->isLockedForWriting)
-            CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before copy and filter");
-          resultForFiltering->isLockedForReading = true; // only unlockd in clean up
-          if (result->isLockedForReading)
-            CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before copy and filter");
           if (result->isLockedForWriting)
             CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before copy and filter");
           result->isLockedForWriting = true;
@@ -3668,6 +4165,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
          && lastPart .getQueryString().find(NOT_QUERY_SEP)      == string::npos
          && firstPart.getQueryString().find(ENHANCED_QUERY_SEP) == string::npos
          && lastPart .getQueryString().find(OR_QUERY_SEP)       == string::npos
+         && isDocValuesQuery(query.getQueryString())            == false
          && splitSeparator.getOutputMode()                      == Separator::OUTPUT_MATCHES
          && wordRange.isEmptyRange()                            == false
          && resultFoundByFiltering                              == false
@@ -4052,7 +4550,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
         assert(resultFirstPart->_status & QueryResult::FINISHED);
         assert( resultFirstPart->_docIds.isFullList() || resultFirstPart->_docIds.size() > 0 );
         if (MODE & WITH_SCORES) assert(resultFirstPart->_scores.size() == resultFirstPart->_docIds.size());
-        if (MODE & WITH_POS)    assert(resultFirstPart->_positions.size() == resultFirstPart->_docIds.size());
+        if (MODE & WITH_POS)    assert(resultFirstPart->hasPositions() || resultFirstPart->_positions.size() == 0);
         //
         // TODO: deal with case here that last part of query is in history. This
         // was previously dealt with in HybCompleter::processBasicQuery, which
@@ -4128,7 +4626,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
       broadHistoryTimer.stop();
       assert( fullResult._docIds.isFullList() || fullResult._docIds.size() > 0 );
       if (MODE & WITH_SCORES) assert(fullResult._scores.size() == fullResult._docIds.size());
-      if (MODE & WITH_POS) assert(fullResult._positions.size() == fullResult._docIds.size());
+      if (MODE & WITH_POS) assert(fullResult.hasPositions() || fullResult._positions.size() == 0);
       assert(fullResult._status & QueryResult::FINISHED);
       processBasicQuery(fullResult, firstPart, lastPart, fullSeparator, *result); // , NULL, useLinearWordlistIntersection); // NULL: 'Last part' cannot be read from history
       assert(result->_docIds.size() == result->_wordIdsOriginal.size());
@@ -4155,12 +4653,10 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
     // 2.7 TOP-K HITS AND COMPLETIONS
     //
     assert((result->_status == QueryResult::UNDER_CONSTRUCTION) || (notIntersectionMode));
-    assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+    assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
     assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      if (result->isLockedForReading)
-        CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before topMatchesFromAllMatches");
       if (result->isLockedForWriting)
         CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before topMatchesFromAllMatches");
       result->isLockedForWriting = true;
@@ -4177,7 +4673,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
     }
     broadHistoryTimer.cont();
     broadHistoryTimer5.cont();
-    assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+    assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
     assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
     assert( ( result->_docIds.size() == 0) || ( result->_topWordScores.size() > 0  ));
     assert(result->_docIds.isSorted());
@@ -4201,7 +4697,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
     //
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      assert((!(MODE & WITH_POS )) || (result->_docIds.size() == result->_positions.size()));
+      assert((!(MODE & WITH_POS )) || (result->hasPositions() || result->_positions.size() == 0));
       assert((!(MODE & WITH_SCORES )) || (result->_docIds.size() == result->_scores.size()));
       result->setCompletions(result->_topWordScores, result->_topWordDocCounts,
           result->_topWordOccCounts, *_vocabulary);
@@ -4215,10 +4711,8 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
     assert(result == isInHistory(query));
     if (result->_status == QueryResult::UNDER_CONSTRUCTION)
     {
-      if (MODE & WITH_POS )    assert(result->_docIds.size() == result->_positions.size());
+      if (MODE & WITH_POS )    assert(result->hasPositions() || result->_positions.size() == 0);
       if (MODE & WITH_SCORES ) assert(result->_docIds.size() == result->_scores.size());
-      if (result->isLockedForReading)
-        CS_THROW(Exception::RESULT_LOCKED_FOR_READING, "before freeExtraSpace");
       if (result->isLockedForWriting)
         CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "before freeExtraSpace");
       result->isLockedForWriting = true;
@@ -4229,7 +4723,7 @@ unsigned int CompleterBase<MODE>::processComplexQuery_NEW
       // CHANGE(hagn, 28Jan11):
       //history.finalizeSize(query.getQueryString());
       finalizeSizeOfHistory(query);
-      if (MODE & WITH_POS)    assert(result->_docIds.size() == result->_positions.size());
+      if (MODE & WITH_POS)    assert(result->hasPositions() || result->_positions.size() == 0);
       if (MODE & WITH_SCORES) assert(result->_docIds.size() == result->_scores.size());
       assert(isInHistoryConst(query));
       setStatusOfHistoryEntry(query, QueryResult::FINISHED);
@@ -4324,6 +4818,9 @@ unsigned int CompleterBase<MODE>::processQuery_NeedToRecompute(
     (_queryParameters.howToRankDocs !=
      result._queryParameters.howToRankDocs
      ||
+     _queryParameters.docValuesField !=
+     result._queryParameters.docValuesField
+     ||
      _queryParameters.fuzzyDamping !=
      result._queryParameters.fuzzyDamping
      ||
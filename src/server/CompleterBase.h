@@ -17,6 +17,7 @@
 #include "WordList.h"
 #include "WordsFile.h"
 #include "ScoreAggregators.h"
+#include "CompletionCounter.h"
 #include "ConcurrentLog.h"
 #include <unordered_set>
 #include <gtest/gtest.h>
@@ -90,6 +91,16 @@ class CompleterBase
     // History (cache) of query results.
     TimedHistory* history;
 
+    // References to the history results used by this completer (each once). A
+    // completer is created per request, so the results it reads stay valid
+    // until it is done, even if the history removes them meanwhile.
+    std::unordered_set<QueryResultPtr> _historyResultsInUse;
+
+    // The result of the last query processed by processCountOnlyQuery. It is
+    // not added to the history (the counts it is made of are), so it is kept
+    // here until the next query.
+    QueryResultPtr _countOnlyResult;
+
     // Object providing fuzzy search functionality.
     FuzzySearch::FuzzySearcherBase* _fuzzySearcher;
 
@@ -102,6 +113,11 @@ class CompleterBase
     //! header.
     int statusCode;
 
+    //! Whether the connection of the request is kept open after the response
+    //! (HTTP/1.1 keep-alive). Like the status code, this is needed to build
+    //! the correct header.
+    bool keepAlive;
+
   protected:
 
     //! Query parameters;
@@ -128,6 +144,21 @@ class CompleterBase
     // CompleterBase::processBasicQuery, where this is initialized to -1.
     WordId _lastBestMatchWordId;
 
+    //! Whether the positions of the postings are needed for the current query.
+    /*!
+     *   Only positional separators (phrase, near, flexi, pairs) and the special
+     *   queries (or, join, fuzzy, synonyms) look at positions, and so do the
+     *   excerpts when the docs DB has word positions (see
+     *   excerptsNeedPositions). Otherwise, the position lists of the index are
+     *   neither read nor decoded, and the results have no positions (see
+     *   QueryResult::hasPositions).
+     *   Such results are kept in the history under a different key than those
+     *   with positions (see getFlagForHistory). Set by the outermost call of
+     *   processQuery, nested calls for parts of the query leave it as is.
+     */
+    bool _positionsNeeded;
+    bool _insideProcessQuery;
+
     //! How to rank words  NEW 01Dec07
     //enum HowToRankWordsEnum { RANK_WORDS_BY_SCORE, RANK_WORDS_BY_ID } _howToRankWords;
 
@@ -159,6 +190,8 @@ class CompleterBase
       _topWordDocCountsBuffer = NULL;
       _topWordOccCountsBuffer = NULL;
       _compressionBuffer = NULL;
+      _positionsNeeded = true;
+      _insideProcessQuery = false;
     }
     /*
      CompleterBase(History& passedHistory) : history(passedHistory) { _compressionBuffer = NULL; }// vectorError = 0;}
@@ -368,6 +401,45 @@ class CompleterBase
     //! Process complex query from left to right; new interface but OLD IMPLEMENTATION (Ingmar's)
     void processComplexQuery(const Query& query, QueryResult*& result);
     unsigned processComplexQuery_NEW(const Query&, QueryResult*&);
+
+    //! Whether positions are needed for the given query, see _positionsNeeded.
+    static bool queryNeedsPositions(const Query& query);
+
+    //! Whether the excerpts for the current query need positions, see
+    //! _positionsNeeded.
+    bool excerptsNeedPositions() const;
+
+    //! Whether the given query asks only for counts (no hits are sent), so
+    //! that processCountOnlyQuery may be tried for it.
+    bool isCountOnlyQuery(const Query& query);
+
+    //! Process a query for which no hits are sent, from the counts of its
+    //! completions only.
+    /*!
+     *    Instead of the postings of the result, only the number of hits and,
+     *    per completion, its score, doc count, and occurrence count are
+     *    computed (see CompletionCounter), and they are cached in the history
+     *    apart from the results (see History::addCounts). The top completions
+     *    are then selected from these counts like in computeTopCompletions.
+     *    The result is neither added to the history nor has it any hits.
+     *
+     *    Returns false, without a result, for queries whose last part is not a
+     *    plain prefix or whose separator outputs more than the matches; these
+     *    are processed as usual by processComplexQuery.
+     */
+    bool processCountOnlyQuery(const Query& query, QueryResult*& result);
+
+    //! Whether the given query (part) contains a doc-values range, see
+    //! processDocValuesQuery.
+    static bool isDocValuesQuery(const string& queryString);
+
+    //! Parse a doc-values range <sep>docvalues<sep><field><sep><low>--<high>.
+    /*!
+     *    Either end may be omitted (e.g., 1997-- or --2004), and a trailing *
+     *    is ignored. Returns false if the query part is not of this form.
+     */
+    static bool parseDocValuesQuery(const string& queryString,
+        string* fieldName, uint32_t* low, uint32_t* high);
   
     //! Get top continuation of a query; e.g. utf8 for !encoding:*
     string getTopContinuationOfQuery(string queryString);
@@ -398,6 +470,22 @@ class CompleterBase
         //const QueryResult* listsForPrefixFromHistory =  NULL   //!< list of postings for word range, if available from history
         ) { CS_THROW(Exception::NOT_YET_IMPLEMENTED, "abstract"); }
 
+    //! Count the postings of the given word range in the docs of the given
+    //! input list (all postings for the full list) with the given counter,
+    //! and append the counts to the given counts (see processCountOnlyQuery).
+    //! The default computes the postings with processBasicQuery and counts
+    //! them; a completer can count them without writing them.
+    virtual void countBasicQuery(const QueryResult& inputList,
+        const WordRange& wordRange, const Separator& separator,
+        CompletionCounter* counter, CompletionCounts* counts);
+
+    //! Split the given sorted word ids into word ranges, each of which is
+    //! processed with one processBasicQuery (see processInfixQuery). The
+    //! default is the one range from the first to the last; a completer with
+    //! blocks leaves out the blocks without any of the word ids.
+    virtual void wordRangesForWordIds(const vector<uint32_t>& wordIds,
+        vector<WordRange>* wordRanges) const;
+
     //! Process OR query, with last part of the form q1|q2|...|qm
     /*!
      *    Implementation note: Uses an indirect recursion, for example if the
@@ -413,6 +501,61 @@ class CompleterBase
         const Query& firstPartOfQuery, const Query& lastPartOfQuery,
         const Separator& separator, QueryResult& result);
 
+    //! Process doc-values range, with last part of the form
+    //! <sep>docvalues<sep><field><sep><low>--<high>
+    /*!
+     *    Keeps those postings of resultFirstPart, whose document has a value
+     *    in the given range for the given field in globalDocValues (see
+     *    DocValues.h). This is a lookup per document instead of the union of
+     *    the posting lists of all values in the range, and the completions are
+     *    those of the first part. Throws an exception if there is no first part
+     *    or no doc values were read.
+     */
+    void processDocValuesQuery(const QueryResult& resultFirstPart,
+        const Query& firstPartOfQuery, const Query& lastPartOfQuery,
+        const Separator& separator, QueryResult& result);
+
+    //! The field in globalFacetIndex for a last part of the form
+    //! <sep>facet<sep><field><sep>...*, or -1.
+    /*!
+     *    Returns -1 also if the facet index cannot be used for this query:
+     *    when positions are needed, when the separator is not the same-document
+     *    separator, or when there is no first part.
+     */
+    int getFacetIndexField(const QueryResult& resultFirstPart,
+        const Query& lastPartOfQuery, const Separator& separator) const;
+
+    //! Process facet query, with last part of the form
+    //! <sep>facet<sep><field><sep>...*, using globalFacetIndex
+    /*!
+     *    Gives the same postings as the intersection of resultFirstPart with
+     *    the facet lists (without positions), but looks up the facet words of
+     *    each document of resultFirstPart in the forward index (see
+     *    FacetIndex.h) instead of reading, decoding, and intersecting the
+     *    blocks of all facet words of the field.
+     */
+    void processFacetIndexQuery(const QueryResult& resultFirstPart,
+        const Query& firstPartOfQuery, const Query& lastPartOfQuery,
+        const Separator& separator, int fieldId, QueryResult& result);
+
+    //! Whether the given query part is an infix query *<infix>* (for
+    //! processInfixQuery).
+    static bool isInfixQuery(const string& queryString);
+
+    //! Process infix query, with last part of the form *<infix>*, using
+    //! globalInfixIndex
+    /*!
+     *    Looks up the ids of the words that contain <infix> in the FM-index of
+     *    the vocabulary (see InfixIndex.h), processes the word ranges from
+     *    wordRangesForWordIds like a prefix, keeps only the postings of these
+     *    words, and merges the results of the ranges. Words with the word part
+     *    separator (like C:1234:... or :facet:...) match only if <infix>
+     *    contains it, too.
+     */
+    void processInfixQuery(const QueryResult& resultFirstPart,
+        const Query& firstPartOfQuery, const Query& lastPartOfQuery,
+        const Separator& separator, QueryResult& result);
+
     //! Process join query, with last part of the form [q1#q2#...#qm]
     void processJoinQuery(const QueryResult& resultFirstPart,
         const Query& firstPartOfQuery, const Query& lastPartOfQuery,
@@ -503,6 +646,15 @@ class CompleterBase
         const V& wordScoreAggSameDocument,
         const W& wordScoreAggDifferentDocuments);
 
+    // Helper function used in computeTopCompletions and processCountOnlyQuery.
+    // Selects the top completions from the aggregated ones in
+    // result._topWordIds, _topWordScores, _topWordDocCounts, and
+    // _topWordOccCounts (all completions, by increasing word id, with the given
+    // largest doc id for each), according to howToRankWords and
+    // sortOrderWords.
+    void selectTopCompletions(QueryResult& result,
+        const DocList& topWordDocIds);
+
     // Helper function used in computeTopCompletions. Maps the word ids according
     // to the (optional) word id map.
     void remapWordIds(const WordList& wordIdsIn, WordList* wordIdsOut);
@@ -900,6 +1052,8 @@ class CompleterBase
     virtual void showStatistics(ConcurrentLog& os, off_t totalTime, string indent = "");
 
     //  TIMERS (also moved "global Timers" here on 05Jun07)
+    //  The FineTimers are breakdowns of single methods and only measure with
+    //  -DTIMER_DETAIL_LEVEL=2, see Timer.h.
     mutable Timer threadTimer; // NEW 13Sep13 (baumgari): was part of CompletionServer
     mutable Timer receiveQueryTimer; // NEW 25Dec07 (Holger): was part of CompletionServer
     mutable Timer sendResultTimer; // NEW 25Dec07 (Holger): was part of CompletionServer
@@ -918,35 +1072,35 @@ class CompleterBase
     mutable Timer externalTimer; // Timer for total time in HYB/INV
     mutable Timer getExcerptsTimer; // NEW 18Sep06 (Holger): should be part of query summary
     mutable Timer intersectWordlistsTimer; // 18Jul06 so far this times the whole method, no breakdown yet
-    mutable Timer intersectWordlistsTimer1;
-    mutable Timer intersectWordlistsTimer2;
-    mutable Timer intersectWordlistsTimer3;
-    mutable Timer intersectWordlistsTimer4;
-    mutable Timer intersectWordlistsTimer5;
+    mutable FineTimer intersectWordlistsTimer1;
+    mutable FineTimer intersectWordlistsTimer2;
+    mutable FineTimer intersectWordlistsTimer3;
+    mutable FineTimer intersectWordlistsTimer4;
+    mutable FineTimer intersectWordlistsTimer5;
     mutable Timer mergeResultsTimer; // 31Oct06 so far this times the whole method, no breakdown yet
     mutable Timer resizeAndReserveTimer;
     mutable Timer stlSortTimer; // only measures sorting outside of scoring
     mutable Timer invMergeTimer;
     mutable Timer scoreDocsTimer; //includes time for removing duplicates and also for sorting
-    mutable Timer scoreDocsTimer1;
-    mutable Timer scoreDocsTimer2;
-    mutable Timer scoreDocsTimer3;
-    mutable Timer scoreDocsTimer4;
+    mutable FineTimer scoreDocsTimer1;
+    mutable FineTimer scoreDocsTimer2;
+    mutable FineTimer scoreDocsTimer3;
+    mutable FineTimer scoreDocsTimer4;
     mutable Timer scoreWordsTimer; //includes time for the bucket sort (which also removes duplicates)
     mutable Timer appendTimer;
     mutable Timer broadHistoryTimer; //includes everything to do with filtering, TODO: always >= historyTimer ?
-    mutable Timer broadHistoryTimer0;
-    mutable Timer broadHistoryTimer1;
-    mutable Timer broadHistoryTimer2;
-    mutable Timer broadHistoryTimer3;
-    mutable Timer broadHistoryTimer4;
-    mutable Timer broadHistoryTimer5;
-    mutable Timer broadHistoryTimer6;
-    mutable Timer broadHistoryTimer7;
-    mutable Timer timerTimer;
+    mutable FineTimer broadHistoryTimer0;
+    mutable FineTimer broadHistoryTimer1;
+    mutable FineTimer broadHistoryTimer2;
+    mutable FineTimer broadHistoryTimer3;
+    mutable FineTimer broadHistoryTimer4;
+    mutable FineTimer broadHistoryTimer5;
+    mutable FineTimer broadHistoryTimer6;
+    mutable FineTimer broadHistoryTimer7;
+    mutable FineTimer timerTimer;
     mutable Timer setCompletionsTimer;
-    mutable Timer setCompletionsTimer1;
-    mutable Timer setCompletionsTimer2;
+    mutable FineTimer setCompletionsTimer1;
+    mutable FineTimer setCompletionsTimer2;
     mutable Timer mapWordIdsTimer;
 
     // timer for the k-way merge
@@ -962,7 +1116,7 @@ class CompleterBase
     // the total time for fuzzy search on the last key-word
     mutable Timer fuzzySearchTotalTimer;
     // auxilary timer
-    mutable Timer fuzzySearchAuxTimer;
+    mutable FineTimer fuzzySearchAuxTimer;
     // list merge timer
     mutable Timer fuzzySearchMergeTimer;
     // timer used for merging short list in fuzzy search
@@ -1071,12 +1225,15 @@ class CompleterBase
     string getFlagForHistory();
     // NEW(hagn, 28Jan11):
     void finalizeSizeOfHistory(const Query& query);
-    void addToHistory(const Query& key, const QueryResult& result);
+    void addToHistory(const Query& key, const QueryResultPtr& result);
     void removeFromHistory(const Query& query);
     // CHANGE(hagn, 28Jan11):
     QueryResult* isInHistory(const Query& query);
     const QueryResult* isInHistoryConst(const Query& query);
     bool isInHistory(const Query& key, QueryResult*& result);
+    // The result for the given history key (with flag), NULL if there is none.
+    // The result is referenced in _historyResultsInUse.
+    QueryResult* useHistoryResult(const string& key);
     // CHANGE(hagn, 28Jan11):
     //unsigned char getStatusOfHistoryEntry(const Query& key) const;
     unsigned char getStatusOfHistoryEntry(const Query& key);
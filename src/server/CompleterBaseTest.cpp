@@ -2,6 +2,9 @@
 #include "Globals.h"
 #include "CompleterBase.h"
 #include "HYBCompleter.h"
+#include "DocValues.h"
+#include "FacetIndex.h"
+#include "InfixIndex.h"
 #include <stdio.h>
 
 
@@ -204,23 +207,23 @@ QueryResultPair queryResultPairs_SIMPLE[] = {
   // Simple query.
   std::make_pair(
       "aachen",
-      "aachen, 12, '', 0, '', 2, 1, [1 2], [0 0], [1 1], [1 1]"),
+      "aachen, 12, '', 0, '', 2, 1, [1 2], [0 0], [1 1], []"),
   // Prefix query simple.
   std::make_pair(
       "aal*",
-      "aal*, 12, '', 0, '', 2, 2, [1 1 2 2], [1 2 2 1], [1 1 1 1], [2 3 2 3]"),
-  // AND query simple.
+      "aal*, 12, '', 0, '', 2, 2, [1 1 2 2], [1 2 2 1], [1 1 1 1], []"),
+  // AND query simple (positions are not needed, hence not computed).
   std::make_pair(
       "aachen aal",
-      "aal, 12, '', 0, '', 2, 1, [1 1 2 2], [1 -1 1 -1], [1 1 1 1], [2 99999 3 99999]"),
+      "aal, 12, '', 0, '', 2, 1, [1 1 2 2], [1 -1 1 -1], [1 1 1 1], []"),
   // AND query with * left hand side.
   std::make_pair(
       "aachen* aal",
-      "aal, 12, '', 0, '', 2, 1, [1 1 2 2], [1 -1 1 -1], [1 1 1 1], [2 99999 3 99999]"),
+      "aal, 12, '', 0, '', 2, 1, [1 1 2 2], [1 -1 1 -1], [1 1 1 1], []"),
   // AND query with * right hand side.
   std::make_pair(
       "aachen aal*",
-      "aal*, 12, '', 0, '', 2, 2, [1 1 1 2 2 2], [1 2 -1 2 1 -1], [1 1 1 1 1 1], [2 3 99999 2 3 99999]"),
+      "aal*, 12, '', 0, '', 2, 2, [1 1 1 2 2 2], [1 2 -1 2 1 -1], [1 1 1 1 1 1], []"),
   // . query simple.
   std::make_pair(
       "aachen.aal",
@@ -299,7 +302,7 @@ TEST_F(CompleterBaseTest, processComplexQuery_filters_history)
   ASSERT_EQ(static_cast<unsigned>(1),
             _completerEnv.getHistory()->getNofQueries());
   _completerEnv.getCompleter()->processQuery(Query("aachen"), result2);
-  EXPECT_STREQ("aachen, 12, '', 1, '', 2, 1, [1 2], [0 0], [1 1], [1 1]",
+  EXPECT_STREQ("aachen, 12, '', 1, '', 2, 1, [1 2], [0 0], [1 1], []",
                result2->asStringFlat().c_str())    
     << "Query was: '" << "aachen" <<  "'";
 }
@@ -360,6 +363,311 @@ TEST_F(CompleterBaseTest, intersectTwoPostingLists)
   ASSERT_EQ("[1 1 -1]", result._wordIdsOriginal.asString());
   ASSERT_EQ("[1 1 1]", result._scores.asString());
   ASSERT_EQ("[1 1 99999]", result._positions.asString());
+
+  // Without positions (for queries that do not need them), the result has no
+  // positions either.
+  input1._positions.clear();
+  input2._positions.clear();
+  result.clear();
+  completer.intersectTwoPostingLists
+        (input2, input1, result,
+         separator, scoreAggregation, wordIdRange);
+  ASSERT_EQ("[1 1 1]", result._docIds.asString());
+  ASSERT_EQ("[1 1 -1]", result._wordIdsOriginal.asString());
+  ASSERT_EQ("[1 1 1]", result._scores.asString());
+  ASSERT_EQ("[]", result._positions.asString());
+  ASSERT_FALSE(result.hasPositions());
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, queryNeedsPositions)
+{
+  typedef CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS> Completer;
+  ASSERT_FALSE(Completer::queryNeedsPositions(Query("aachen")));
+  ASSERT_FALSE(Completer::queryNeedsPositions(Query("aachen bon*")));
+  ASSERT_FALSE(Completer::queryNeedsPositions(Query("ct:author:*")));
+  ASSERT_TRUE(Completer::queryNeedsPositions(Query("aachen.bonn")));
+  ASSERT_TRUE(Completer::queryNeedsPositions(Query("aachen..bonn")));
+  ASSERT_TRUE(Completer::queryNeedsPositions(Query("aachen|bonn")));
+  ASSERT_TRUE(Completer::queryNeedsPositions(Query("aachen~")));
+  ASSERT_TRUE(Completer::queryNeedsPositions(Query("[a#b]")));
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, parseDocValuesQuery)
+{
+  typedef CompleterBase<WITH_SCORES + WITH_POS + WITH_DUPS> Completer;
+  string sep(1, wordPartSep);
+  string prefix = sep + "docvalues" + sep;
+  string field;
+  uint32_t low, high;
+  ASSERT_TRUE(Completer::isDocValuesQuery(prefix + "year" + sep + "1--2"));
+  ASSERT_FALSE(Completer::isDocValuesQuery("docvalues"));
+  ASSERT_TRUE(Completer::parseDocValuesQuery(prefix + "year" + sep
+                                             + "1997--2004", &field, &low, &high));
+  ASSERT_EQ("year", field);
+  ASSERT_EQ(1997u, low);
+  ASSERT_EQ(2004u, high);
+  ASSERT_TRUE(Completer::parseDocValuesQuery(prefix + "price" + sep + "--50*",
+                                             &field, &low, &high));
+  ASSERT_EQ("price", field);
+  ASSERT_EQ(0u, low);
+  ASSERT_EQ(50u, high);
+  ASSERT_TRUE(Completer::parseDocValuesQuery(prefix + "year" + sep + "2000--",
+                                             &field, &low, &high));
+  ASSERT_EQ(2000u, low);
+  ASSERT_EQ(DocValues::NO_VALUE - 1, high);
+  ASSERT_FALSE(Completer::parseDocValuesQuery(prefix + "year" + sep + "2000",
+                                              &field, &low, &high));
+  ASSERT_FALSE(Completer::parseDocValuesQuery(prefix + "year" + sep + "a--b",
+                                              &field, &low, &high));
+  ASSERT_FALSE(Completer::parseDocValuesQuery(prefix + "1--2",
+                                              &field, &low, &high));
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, processQuery_docValues)
+{
+  string fileName = "CompleterBaseTest.TMP.docvalues";
+  vector<string> fieldNames(1, "year");
+  vector<vector<uint32_t> > values(1);
+  values[0].push_back(DocValues::NO_VALUE);
+  values[0].push_back(1990);
+  values[0].push_back(2005);
+  values[0].push_back(2000);
+  DocValues::write(fileName, fieldNames, values);
+  DocValues docValues;
+  docValues.open(fileName);
+  globalDocValues = &docValues;
+  string range = wordPartSep + string("docvalues") + wordPartSep + "year"
+                 + wordPartSep;
+
+  // Filter the postings of the first part.
+  QueryResult* result = NULL;
+  _completerEnv.getCompleter()->processQuery(
+      Query("aal* " + range + "2000--2010"), result);
+  ASSERT_EQ("[2 2]", result->_docIds.asString());
+  ASSERT_EQ("[2 1]", result->_wordIdsOriginal.asString());
+  result = NULL;
+  _completerEnv.getCompleter()->processQuery(
+      Query("ba* " + range + "--2003"), result);
+  ASSERT_EQ("[3 3 3 3]", result->_docIds.asString());
+  // Documents without a value never match.
+  result = NULL;
+  _completerEnv.getCompleter()->processQuery(
+      Query("ba* " + range + "--"), result);
+  ASSERT_EQ("[3 3 3 3]", result->_docIds.asString());
+
+  // A range alone or for an unknown field is an error.
+  result = NULL;
+  ASSERT_THROW(_completerEnv.getCompleter()->processQuery(
+      Query(range + "2000--2010"), result), Exception);
+  result = NULL;
+  ASSERT_THROW(_completerEnv.getCompleter()->processQuery(
+      Query(string("aal* ") + wordPartSep + "docvalues" + wordPartSep
+            + "month" + wordPartSep + "1--2"), result), Exception);
+  globalDocValues = NULL;
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, processQuery_facetIndex)
+{
+  // An index with facet words for two fields.
+  string author = wordPartSep + string("facet") + wordPartSep + "author"
+                  + wordPartSep;
+  string venue = wordPartSep + string("facet") + wordPartSep + "venue"
+                 + wordPartSep;
+  WordsFileEntries entries;
+  entries.push_back("aachen",          1, 1, 1);
+  entries.push_back(author + "Bast",   1, 3, 2);
+  entries.push_back(author + "Weber",  1, 3, 3);
+  entries.push_back("aachen",          2, 1, 1);
+  entries.push_back(author + "Weber",  2, 3, 2);
+  entries.push_back(venue + "SIGIR",   2, 5, 3);
+  entries.push_back("aal",             3, 1, 1);
+  entries.push_back(author + "Bast",   3, 3, 2);
+  entries.push_back("aachen",          4, 1, 1);
+  std::sort(entries.begin(), entries.end(), wordsFileEntryCompare);
+  string wordsFileName = "CompleterBaseTest.TMP.words";
+  string indexFileName = "CompleterBaseTest.TMP.hybrid";
+  string vocFileName = "CompleterBaseTest.TMP.vocabulary";
+  FILE* wordsFile = fopen(wordsFileName.c_str(), "w");
+  for (size_t i = 0; i < entries.size(); i++)
+    writePostingToWordsFileAscii(wordsFile, entries[i]._word.c_str(),
+        entries[i]._docId, entries[i]._score, entries[i]._position);
+  fclose(wordsFile);
+  FILE* fd = freopen("/dev/null", "a", stdout);
+  HYBIndex index(indexFileName, vocFileName, MODE);
+  index.build(wordsFileName, "ASCII");
+  fd = freopen("/dev/tty", "a", stdout);
+
+  // The forward index for the author field (but not for the venue field).
+  vector<FacetIndex::Column> columns(1);
+  columns[0].name = "author";
+  columns[0].score = 3;
+  columns[0].words.push_back(author + "Bast");
+  columns[0].words.push_back(author + "Weber");
+  columns[0].words.push_back(author + "Nobody");
+  uint32_t offsets[] = { 0, 0, 2, 3, 4, 4 };
+  uint32_t valueIds[] = { 0, 1, 1, 0 };
+  columns[0].offsets.assign(offsets, offsets + 6);
+  columns[0].valueIds.assign(valueIds, valueIds + 4);
+  string facetIndexFileName = "CompleterBaseTest.TMP.facet-index";
+  FacetIndex::write(facetIndexFileName, columns);
+  FacetIndex facetIndex;
+  facetIndex.open(facetIndexFileName);
+  facetIndex.computeWordIds(index._vocabulary);
+  ASSERT_EQ(-1, facetIndex.getWordId(0, 2));
+
+  // With and without the forward index, the results are the same.
+  vector<string> queries;
+  queries.push_back("aachen " + author + "*");
+  queries.push_back("aachen " + author + "W*");
+  queries.push_back("aa* " + author + "*");
+  queries.push_back("aachen " + author + "X*");
+  queries.push_back("aachen " + venue + "*");
+  for (size_t i = 0; i < queries.size(); i++)
+  {
+    TimedHistory history1;
+    TimedHistory history2;
+    HybCompleter<MODE> completer1(&index, &history1, _completerEnv.getFuzzy());
+    HybCompleter<MODE> completer2(&index, &history2, _completerEnv.getFuzzy());
+    QueryResult* result1 = NULL;
+    QueryResult* result2 = NULL;
+    globalFacetIndex = NULL;
+    completer1.processQuery(Query(queries[i]), result1);
+    globalFacetIndex = &facetIndex;
+    completer2.processQuery(Query(queries[i]), result2);
+    ASSERT_EQ(result1->_docIds.asString(), result2->_docIds.asString())
+      << queries[i];
+    ASSERT_EQ(result1->_wordIdsOriginal.asString(),
+              result2->_wordIdsOriginal.asString()) << queries[i];
+    ASSERT_EQ(result1->_scores.asString(), result2->_scores.asString())
+      << queries[i];
+    ASSERT_EQ(result1->_topWordIds.asString(), result2->_topWordIds.asString())
+      << queries[i];
+    if (i == 0)
+    {
+      ASSERT_EQ("[1 1 1 2 2]", result2->_docIds.asString());
+    }
+  }
+
+  // The postings come from the forward index: without Weber for document 2,
+  // document 2 is no longer a hit.
+  offsets[3] = 2;
+  offsets[4] = offsets[5] = 3;
+  valueIds[2] = 0;
+  columns[0].offsets.assign(offsets, offsets + 6);
+  columns[0].valueIds.assign(valueIds, valueIds + 3);
+  FacetIndex::write(facetIndexFileName, columns);
+  FacetIndex facetIndex2;
+  facetIndex2.open(facetIndexFileName);
+  facetIndex2.computeWordIds(index._vocabulary);
+  globalFacetIndex = &facetIndex2;
+  TimedHistory history;
+  HybCompleter<MODE> completer(&index, &history, _completerEnv.getFuzzy());
+  QueryResult* result = NULL;
+  completer.processQuery(Query("aachen " + author + "*"), result);
+  ASSERT_EQ("[1 1 1]", result->_docIds.asString());
+  ASSERT_EQ("[3 3 1]", result->_scores.asString());
+  // Queries that need positions do not use the forward index.
+  result = NULL;
+  completer.processQuery(Query("aachen.." + author + "*"), result);
+  ASSERT_EQ("[1 1 2]", result->_docIds.asString());
+
+  globalFacetIndex = NULL;
+  remove(wordsFileName.c_str());
+  remove(indexFileName.c_str());
+  remove(vocFileName.c_str());
+  remove(facetIndexFileName.c_str());
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, processQuery_infixIndex)
+{
+  string infixIndexFileName = "CompleterBaseTest.TMP.infix-index";
+  InfixIndex::build(_completerEnv.getIndex()->_vocabulary, infixIndexFileName);
+  InfixIndex infixIndex;
+  infixIndex.open(infixIndexFileName);
+  globalInfixIndex = &infixIndex;
+  CompleterBase<MODE>* completer = _completerEnv.getCompleter();
+  QueryResult* result = NULL;
+  completer->processQuery(Query("*ab*"), result);
+  ASSERT_EQ("[3 3 3 3 4 4 4]", result->_docIds.asString());
+  result = NULL;
+  completer->processQuery(Query("*glat*"), result);
+  ASSERT_EQ("[1 2]", result->_docIds.asString());
+  ASSERT_EQ("[2 2]", result->_wordIdsOriginal.asString());
+  // Like the prefix query when the infix words are those of the prefix.
+  QueryResult* prefixResult = NULL;
+  result = NULL;
+  completer->processQuery(Query("aal*"), prefixResult);
+  completer->processQuery(Query("*aal*"), result);
+  ASSERT_EQ(prefixResult->_docIds.asString(), result->_docIds.asString());
+  ASSERT_EQ(prefixResult->_wordIdsOriginal.asString(),
+            result->_wordIdsOriginal.asString());
+  // After a first part, and in an or query.
+  result = NULL;
+  completer->processQuery(Query("ba* *boom*"), result);
+  ASSERT_EQ("[3 3 4 4]", result->_docIds.asString());
+  ASSERT_EQ("[6 -1 6 -1]", result->_wordIdsOriginal.asString());
+  result = NULL;
+  completer->processQuery(Query("aa* *boom*"), result);
+  ASSERT_EQ("[]", result->_docIds.asString());
+  result = NULL;
+  completer->processQuery(Query("*lat*|*lon*"), result);
+  ASSERT_EQ("[1 2 3]", result->_docIds.asString());
+  result = NULL;
+  completer->processQuery(Query("*xyz*"), result);
+  ASSERT_EQ("[]", result->_docIds.asString());
+  globalInfixIndex = NULL;
+  remove(infixIndexFileName.c_str());
+}
+
+// _____________________________________________________________________________
+TEST_F(CompleterBaseTest, computeTopHitsByDocValue)
+{
+  string fileName = "CompleterBaseTest.TMP.docvalues";
+  vector<string> fieldNames(1, "year");
+  vector<vector<uint32_t> > values(1);
+  values[0].push_back(DocValues::NO_VALUE);
+  values[0].push_back(2005);
+  values[0].push_back(DocValues::NO_VALUE);
+  values[0].push_back(1990);
+  values[0].push_back(2000);
+  DocValues::write(fileName, fieldNames, values);
+  DocValues docValues;
+  docValues.open(fileName);
+  globalDocValues = &docValues;
+
+  const int MODE = WITH_SCORES + WITH_POS + WITH_DUPS;
+  HybCompleter<MODE> completer;
+  QueryParameters queryParameters;
+  queryParameters.howToRankDocs = QueryParameters::RANK_DOCS_BY_DOC_VALUE;
+  queryParameters.docValuesField = "year";
+  queryParameters.howToRankWords = QueryParameters::RANK_WORDS_BY_WORD_ID;
+  queryParameters.sortOrderDocs = SORT_ORDER_ASCENDING;
+  queryParameters.sortOrderWords = SORT_ORDER_ASCENDING;
+  completer.setQueryParameters(queryParameters);
+  QueryResult result;
+  result._docIds.parseFromString("1 2 3 4");
+  result._wordIdsOriginal.parseFromString("1 2 3 4");
+  result._scores.parseFromString("1 1 1 1");
+  result._positions.parseFromString("1 1 1 1");
+  completer.computeTopHitsAndCompletions(result);
+  ASSERT_EQ("[3 4 1 2]", result._topDocIds.asString());
+
+  // Documents without a value also come last in descending order.
+  queryParameters.sortOrderDocs = SORT_ORDER_DESCENDING;
+  completer.setQueryParameters(queryParameters);
+  QueryResult result2;
+  result2._docIds.parseFromString("1 2 3 4");
+  result2._wordIdsOriginal.parseFromString("1 2 3 4");
+  result2._scores.parseFromString("1 1 1 1");
+  result2._positions.parseFromString("1 1 1 1");
+  completer.computeTopHitsAndCompletions(result2);
+  ASSERT_EQ("[1 4 3 2]", result2._topDocIds.asString());
+  globalDocValues = NULL;
 }
 
 // _____________________________________________________________________________
@@ -0,0 +1,114 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/CompletionCounter.h"
+#include <algorithm>
+#include "server/Exception.h"
+
+// _____________________________________________________________________________
+CompletionCounter::CompletionCounter(
+    ScoreAggregation wordScoreAggSameDocument,
+    ScoreAggregation wordScoreAggDifferentDocuments)
+  : _firstWordId(0), _lastWordId(-1)
+{
+  if (wordScoreAggSameDocument == SCORE_AGG_NONE)
+    CS_THROW(Exception::INVALID_PARAMETER_VALUE,
+             "wordScoreAggSameDocument = " << wordScoreAggSameDocument);
+  if (wordScoreAggDifferentDocuments == SCORE_AGG_NONE)
+    CS_THROW(Exception::INVALID_PARAMETER_VALUE,
+             "wordScoreAggDifferentDocuments = "
+             << wordScoreAggDifferentDocuments);
+  _maxSameDocument = wordScoreAggSameDocument == SCORE_AGG_MAX;
+  _maxDifferentDocuments = wordScoreAggDifferentDocuments == SCORE_AGG_MAX;
+}
+
+// _____________________________________________________________________________
+void CompletionCounter::beginSegment(WordId firstWordId, WordId lastWordId)
+{
+  CS_ASSERT_LE(firstWordId, lastWordId);
+  CS_ASSERT_GE(firstWordId, 0);
+  _firstWordId = firstWordId;
+  _lastWordId = lastWordId;
+  size_t n = lastWordId - firstWordId + 1;
+  _docCounts.assign(n, 0);
+  _occCounts.assign(n, 0);
+  _scoresDifferentDocuments.assign(n, 0);
+  _scoresSameDocument.assign(n, 0);
+  _lastDocIds.assign(n, INFTY_DOCID);
+}
+
+// _____________________________________________________________________________
+void CompletionCounter::intersect(const DocList& docIds,
+                                  const QueryResult& list)
+{
+  const DocList& docIds2 = list._docIds;
+  const WordList& wordIds2 = list._wordIdsOriginal;
+  const ScoreList& scores2 = list._scores;
+  CS_ASSERT_EQ(docIds2.size(), wordIds2.size());
+  CS_ASSERT_EQ(docIds2.size(), scores2.size());
+  size_t len1 = docIds.size();
+  size_t len2 = docIds2.size();
+  size_t i = 0;
+  size_t j = 0;
+  while (i < len1 && j < len2)
+  {
+    if (docIds[i] < docIds2[j]) { ++i; continue; }
+    if (docIds2[j] < docIds[i]) { ++j; continue; }
+    DocId docId = docIds[i];
+    bool counted = false;
+    for (; j < len2 && docIds2[j] == docId; ++j)
+    {
+      WordId wordId = wordIds2[j];
+      if (wordId < _firstWordId || wordId > _lastWordId) continue;
+      add(wordId, docId, scores2[j]);
+      counted = true;
+    }
+    if (counted) markDoc(docId);
+    while (i < len1 && docIds[i] == docId) ++i;
+  }
+}
+
+// _____________________________________________________________________________
+void CompletionCounter::addAll(const QueryResult& list,
+                               WordId bestMatchWordId, Score bonus)
+{
+  const DocList& docIds = list._docIds;
+  const WordList& wordIds = list._wordIdsOriginal;
+  const ScoreList& scores = list._scores;
+  CS_ASSERT_EQ(docIds.size(), wordIds.size());
+  CS_ASSERT_EQ(docIds.size(), scores.size());
+  for (size_t i = 0; i < docIds.size(); ++i)
+  {
+    WordId wordId = wordIds[i];
+    if (wordId < _firstWordId || wordId > _lastWordId) continue;
+    add(wordId, docIds[i],
+        scores[i] + (wordId == bestMatchWordId ? bonus : 0));
+    markDoc(docIds[i]);
+  }
+}
+
+// _____________________________________________________________________________
+void CompletionCounter::endSegment(CompletionCounts* counts)
+{
+  for (size_t i = 0; i < _lastDocIds.size(); ++i)
+  {
+    if (_lastDocIds[i] == INFTY_DOCID) continue;
+    counts->wordIds.push_back(_firstWordId + i);
+    counts->scores.push_back(aggregate(_maxDifferentDocuments,
+        _scoresDifferentDocuments[i], _scoresSameDocument[i]));
+    counts->docCounts.push_back(_docCounts[i]);
+    counts->occCounts.push_back(_occCounts[i]);
+    counts->lastDocIds.push_back(_lastDocIds[i]);
+  }
+  // Count nothing until the next segment begins.
+  _lastWordId = _firstWordId - 1;
+}
+
+// _____________________________________________________________________________
+void CompletionCounter::finish(CompletionCounts* counts) const
+{
+  size_t nofDocs = 0;
+  for (size_t i = 0; i < _docBits.size(); ++i)
+    nofDocs += __builtin_popcountll(_docBits[i]);
+  counts->nofTotalHits = nofDocs;
+}
@@ -0,0 +1,108 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_COMPLETIONCOUNTER_H_
+#define SERVER_COMPLETIONCOUNTER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "server/Globals.h"
+#include "server/QueryResult.h"
+#include "server/ScoreAggregators.h"
+
+using std::vector;
+
+// Counts the hits and completions of a query from the postings for its last
+// part, without writing the postings of the result: the count-only kernel of
+// CompleterBase::processCountOnlyQuery. The counts are the same as those that
+// CompleterBase::computeTopHitsAndCompletions computes from the result of the
+// intersection with a same-doc separator (see CompletionCounts).
+//
+// The postings are given in segments of consecutive word ids (e.g. one per
+// block of a HYB index, so that each word is in one segment). Per segment, the
+// counts of its words are kept in arrays indexed by word id, and appended to
+// the counts (by increasing word id) when the segment ends. The docs with a
+// counted posting are marked in a bit vector, for the number of hits.
+class CompletionCounter
+{
+ public:
+  // Aggregate the scores of a word in the same doc and in different docs
+  // like the two-argument aggregate of the given aggregations (that is,
+  // SCORE_AGG_SUM and SCORE_AGG_SUM_WITH_BONUS add and SCORE_AGG_MAX takes the
+  // maximum). Throws an exception for SCORE_AGG_NONE.
+  CompletionCounter(ScoreAggregation wordScoreAggSameDocument,
+                    ScoreAggregation wordScoreAggDifferentDocuments);
+
+  // Begin a segment with the given word ids (inclusive); postings with other
+  // word ids are not counted.
+  void beginSegment(WordId firstWordId, WordId lastWordId);
+
+  // Count the postings of the given list (sorted by doc id) in the docs of
+  // the given doc ids (sorted, duplicates allowed).
+  void intersect(const DocList& docIds, const QueryResult& list);
+
+  // Count all postings of the given list (sorted by doc id); postings with
+  // the given word id get the given bonus added to their score.
+  void addAll(const QueryResult& list, WordId bestMatchWordId, Score bonus);
+
+  // End the segment: append the counts of its words with at least one posting
+  // to the given counts.
+  void endSegment(CompletionCounts* counts);
+
+  // Set the number of hits of the given counts: the number of distinct docs
+  // with a counted posting.
+  void finish(CompletionCounts* counts) const;
+
+ private:
+  // Count one posting; the word id must be in the segment.
+  void add(WordId wordId, DocId docId, Score score)
+  {
+    size_t i = wordId - _firstWordId;
+    ++_occCounts[i];
+    if (docId != _lastDocIds[i])
+    {
+      _scoresDifferentDocuments[i] = aggregate(_maxDifferentDocuments,
+          _scoresDifferentDocuments[i], _scoresSameDocument[i]);
+      _scoresSameDocument[i] = score;
+      ++_docCounts[i];
+      _lastDocIds[i] = docId;
+    }
+    else
+    {
+      _scoresSameDocument[i] = aggregate(_maxSameDocument,
+          _scoresSameDocument[i], score);
+    }
+  }
+
+  // Mark the given doc as a hit.
+  void markDoc(DocId docId)
+  {
+    size_t word = docId >> 6;
+    if (word >= _docBits.size()) _docBits.resize(2 * word + 1, 0);
+    _docBits[word] |= uint64_t(1) << (docId & 63);
+  }
+
+  static Score aggregate(bool max, Score x, Score y)
+  {
+    return max ? MAX(x, y) : x + y;
+  }
+
+  bool _maxSameDocument;
+  bool _maxDifferentDocuments;
+
+  // The word ids of the current segment, and per word id the counts, the
+  // score aggregated over the previous docs and over the current doc, and the
+  // current doc (INFTY_DOCID if none yet).
+  WordId _firstWordId;
+  WordId _lastWordId;
+  vector<unsigned int> _docCounts;
+  vector<unsigned int> _occCounts;
+  vector<Score> _scoresDifferentDocuments;
+  vector<Score> _scoresSameDocument;
+  vector<DocId> _lastDocIds;
+
+  // One bit per doc id, set for the docs with a counted posting.
+  vector<uint64_t> _docBits;
+};
+
+#endif  // SERVER_COMPLETIONCOUNTER_H_
@@ -0,0 +1,92 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include "server/CompletionCounter.h"
+#include "server/Exception.h"
+
+// A list with the postings (doc id, word id, score) (1, 5, 1), (1, 5, 2),
+// (1, 6, 4), (2, 5, 3), (3, 7, 1), (4, 6, 2), (4, 9, 8), (1000000, 5, 1).
+QueryResult makeList()
+{
+  DocId docIds[] = { 1, 1, 1, 2, 3, 4, 4, 1000000 };
+  WordId wordIds[] = { 5, 5, 6, 5, 7, 6, 9, 5 };
+  Score scores[] = { 1, 2, 4, 3, 1, 2, 8, 1 };
+  QueryResult list;
+  for (size_t i = 0; i < 8; i++)
+  {
+    list._docIds.push_back(docIds[i]);
+    list._wordIdsOriginal.push_back(wordIds[i]);
+    list._scores.push_back(scores[i]);
+  }
+  return list;
+}
+
+// The counts as a string: the number of hits, and word id, score, doc count,
+// occurrence count and last doc id of each completion.
+string countsAsString(const CompletionCounts& counts)
+{
+  std::ostringstream os;
+  os << counts.nofTotalHits << ":";
+  for (size_t i = 0; i < counts.wordIds.size(); i++)
+    os << " " << counts.wordIds[i] << "/" << counts.scores[i] << "/"
+       << counts.docCounts[i] << "/" << counts.occCounts[i] << "/"
+       << counts.lastDocIds[i];
+  return os.str();
+}
+
+// Intersection with doc ids (with duplicates), with sum and max aggregation.
+TEST(CompletionCounterTest, intersect)
+{
+  QueryResult list = makeList();
+  DocList docIds;
+  docIds.push_back(1);
+  docIds.push_back(1);
+  docIds.push_back(3);
+  docIds.push_back(4);
+  {
+    CompletionCounter counter(SCORE_AGG_SUM, SCORE_AGG_SUM);
+    CompletionCounts counts;
+    counter.beginSegment(5, 7);
+    counter.intersect(docIds, list);
+    counter.endSegment(&counts);
+    counter.finish(&counts);
+    ASSERT_EQ("3: 5/3/1/2/1 6/6/2/2/4 7/1/1/1/3", countsAsString(counts));
+  }
+  {
+    CompletionCounter counter(SCORE_AGG_SUM, SCORE_AGG_MAX);
+    CompletionCounts counts;
+    counter.beginSegment(5, 9);
+    counter.intersect(docIds, list);
+    counter.endSegment(&counts);
+    counter.finish(&counts);
+    ASSERT_EQ("3: 5/3/1/2/1 6/4/2/2/4 7/1/1/1/3 9/8/1/1/4",
+              countsAsString(counts));
+  }
+  ASSERT_THROW(CompletionCounter(SCORE_AGG_NONE, SCORE_AGG_SUM), Exception);
+}
+
+// All postings, with a bonus for the best match, in two segments. Postings
+// outside of a segment, or between segments, are not counted.
+TEST(CompletionCounterTest, addAll)
+{
+  QueryResult list = makeList();
+  CompletionCounter counter(SCORE_AGG_MAX, SCORE_AGG_SUM);
+  CompletionCounts counts;
+  counter.beginSegment(5, 5);
+  counter.addAll(list, 6, 10);
+  counter.endSegment(&counts);
+  counter.addAll(list, 6, 10);
+  counter.beginSegment(6, 6);
+  counter.addAll(list, 6, 10);
+  counter.endSegment(&counts);
+  counter.finish(&counts);
+  ASSERT_EQ("4: 5/6/3/4/1000000 6/26/2/2/4", countsAsString(counts));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/resource.h>
 #include <netinet/in.h>
 #include <algorithm>
 #include <fstream>
@@ -13,6 +14,11 @@
 #include "../utility/XmlToJson.h"
 #include "../fuzzysearch/StringDistances.h"
 #include "server/CustomScorer.h"
+#include "server/DocValues.h"
+#include "server/FacetIndex.h"
+#include "server/HotLists.h"
+#include "server/InfixIndex.h"
+#include "server/MemoryPool.h"
 
 // MMM TODO: declare which ever parameters you need for the fuzzy search. They
 // are set in StartCompletionServer.cpp, where these variables are declared as
@@ -22,6 +28,10 @@ bool fuzzySearchNormalizeWords = false;
 bool rankByGeneralizedEditDistance = false;
 bool fuzzySearchUseClustering = true;
 bool readCustomScores = false;
+bool readDocValues = false;
+bool readFacetIndex = false;
+bool readHotLists = false;
+bool readInfixIndex = false;
 bool alreadyWellformedXml = false;
 char infoDelim = '\0';
 FuzzySearch::GeneralizedEditDistance* generalizedDistanceCalculator = NULL;
@@ -58,12 +68,6 @@ vector<string> multipleAttributes = vector<string>();
 //! additional operations are executed on each sort.
 float parallelSortTimePerMillionIntegers = FLT_MAX;
 
-#ifdef DEBUG_PTHREAD_CREATE_TIME
-//! Timer for thread creation overhead (only measured when multithreading is off)
-template<class Completer, class Index>
-Timer CompletionServer<Completer, Index>::threadCreateTimer;
-#endif
-
 //! MUTEX FOR EXCERPT GENERATION (not yet thread-safe, TODO: why?)
 pthread_mutex_t excerpts_generation;
 
@@ -72,6 +76,25 @@ pthread_mutex_t excerpts_generation;
 //! allow access from other domains and ports.
 bool corsEnabled = false;
 
+//! Idle time in milliseconds after which a kept-alive connection is closed if
+//! no new request arrives. A value of 0 disables keep-alive.
+unsigned int keepAliveTimeoutMsecs = 5000;
+
+//! Maximal number of requests processed on one connection before it is closed.
+unsigned int keepAliveMaxNofRequests = 100;
+
+//! Number of threads doing the network I/O (accept, read, write) for all
+//! connections.
+unsigned int nofIoThreads = 1;
+
+//! Number of threads processing queries. If 0, this is the number of cores in
+//! multithreaded mode and 1 otherwise.
+unsigned int nofComputeThreads = 0;
+
+//! Time in milliseconds we wait for the (remaining part of a) request, once the
+//! client has started sending it.
+static const unsigned int READ_TIMEOUT_MSECS = 1000;
+
 //! GET SIGNAL NAME (copied from man page for signal, cf. man 7 signal)
 string signalName(int signal)
 {
@@ -179,6 +202,12 @@ string getHTTPStatusMessage(int statusCode) {
   }
 }
 
+//! The Connection header field of a response.
+const char* connectionHeaderField(bool keepAlive)
+{
+  return keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+}
+
 //! KILL SERVER 
 void killServer(string pidFileName)
 {
@@ -218,6 +247,8 @@ CompletionServer<Completer, Index>::CompletionServer(
     FILE* log_file, bool killServerIfRunning) :
   io_service(),
   acceptor(io_service),
+  computeService(),
+  computeWork(computeService),
   index(passedIndexStructureFile, passedVocabularyFile, mode)
 {
   index.read();
@@ -412,6 +443,58 @@ CompletionServer<Completer, Index>::CompletionServer(
     globalCustomScorer->readCustomScores(customScoresFileName);
   }
 
+  // Optionally mmap the doc values written by the CSV parser.
+  if (readDocValues == true)
+  {
+    globalDocValues = new DocValues();
+    string docValuesFileName = baseName + ".docvalues";
+    globalDocValues->open(docValuesFileName);
+    cout << "* read doc values for " << globalDocValues->getNofFields()
+         << " field(s) from \"" << docValuesFileName << "\"" << endl;
+  }
+
+  // Optionally mmap the facet index written by the CSV parser, and map its
+  // facet words to word ids.
+  if (readFacetIndex == true)
+  {
+    globalFacetIndex = new FacetIndex();
+    string facetIndexFileName = baseName + ".facet-index";
+    globalFacetIndex->open(facetIndexFileName);
+    globalFacetIndex->computeWordIds(index._vocabulary);
+    cout << "* read facet index for " << globalFacetIndex->getNofFields()
+         << " field(s) from \"" << facetIndexFileName << "\"" << endl;
+  }
+
+  // Optionally read the materialised lists of hot prefixes written by
+  // buildIndex.
+  if (readHotLists == true)
+  {
+    globalHotLists = new HotLists();
+    string hotListsFileName = baseName + ".hot-lists";
+    globalHotLists->read(hotListsFileName, index._vocabulary.size());
+    cout << "* read " << globalHotLists->getNofLists() << " hot lists with "
+         << commaStr(globalHotLists->getNofPostings()) << " postings ("
+         << commaStr(globalHotLists->getSizeInBytes() / 1024) << " KB) from \""
+         << hotListsFileName << "\"" << endl;
+  }
+
+  // Optionally mmap the FM-index of the vocabulary written by buildIndex, for
+  // infix queries.
+  if (readInfixIndex == true)
+  {
+    globalInfixIndex = new InfixIndex();
+    string infixIndexFileName = baseName + ".infix-index";
+    globalInfixIndex->open(infixIndexFileName);
+    if (globalInfixIndex->getNofWords() != index._vocabulary.size())
+      CS_THROW(Exception::OTHER, "infix index \"" << infixIndexFileName
+               << "\" has " << globalInfixIndex->getNofWords()
+               << " words, but the vocabulary has "
+               << index._vocabulary.size());
+    cout << "* read infix index of " << globalInfixIndex->getNofWords()
+         << " words (" << commaStr(globalInfixIndex->getSizeInBytes() / 1024)
+         << " KB) from \"" << infixIndexFileName << "\"" << endl;
+  }
+
   // NEW 18Oct13 (baumgari): Compute c in c * n * log n. This is done to
   // estimate the sorting time, which can take very long. Sorting is in O(n log
   // n).
@@ -528,73 +611,115 @@ CompletionServer<Completer, Index>::~CompletionServer()
       << " ********** COMPLETIONSERVER DESTRUCTED ***********" << endl << endl;
 }
 
-// WAIT FOR REQUEST AND PROCESS IN OWN THREAD (forever until killed)
+// START COMPUTE AND I/O THREADS AND PROCESS REQUESTS (forever until killed)
 template<class Completer, class Index>
 void CompletionServer<Completer, Index>::waitForRequestsAndProcess()
 {
   query_id = 0;
-  ConcurrentLog log;
-  cout << endl;
-  while (true)
+  if (nofComputeThreads == 0)
+    nofComputeThreads = runMultithreaded ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+  if (nofIoThreads == 0) nofIoThreads = 1;
+  cout << "* starting " << nofComputeThreads << " compute thread(s) and "
+       << nofIoThreads << " I/O thread(s)" << endl;
+
+  for (unsigned int i = 0; i < nofComputeThreads; i++)
   {
-    // Wait for new query
-    query_id++;
-    log.setId(query_id);
-    log << endl;
-    log << "---------- WAITING FOR QUERY AT PORT \"" << port << "\" ... " << endl;
-    boost::asio::ip::tcp::socket client(io_service);
-    acceptor.accept(client);
-    time_t NOW = time(NULL);
-    string currentTime = ctime(&NOW);
-    size_t pos = currentTime.find_first_of("\r\n");
-    if (pos != string::npos) currentTime.erase(pos);
-    log << "new query from " << client.remote_endpoint().address().to_string()
-        << " at " << currentTime << endl;
+    pthread_t pthread_id;
+    int ret = pthread_create(&pthread_id, NULL, runIoServiceThreadFunction,
+                             (void*) &computeService);
+    if (ret != 0) throw Exception(Exception::COULD_NOT_CREATE_THREAD,
+        strerror(errno));
+  }
 
-    // Launch thread that will process query (connection must be closed in that function).
-    processRequestLaunchThread(client, query_id);
-  } // end of while(true)
+  startAccept();
 
+  // The calling thread is one of the I/O threads.
+  for (unsigned int i = 1; i < nofIoThreads; i++)
+  {
+    pthread_t pthread_id;
+    int ret = pthread_create(&pthread_id, NULL, runIoServiceThreadFunction,
+                             (void*) &io_service);
+    if (ret != 0) throw Exception(Exception::COULD_NOT_CREATE_THREAD,
+        strerror(errno));
+  }
+  runIoServiceThreadFunction(&io_service);
 } // end of waitForRequestsAndProcess()
 
 
-//! Create and run the thread that will process the request from the given client.
+//! Thread function of the I/O and compute threads.
 template<class Completer, class Index>
-void CompletionServer<Completer, Index>::processRequestLaunchThread(
-    boost::asio::ip::tcp::socket& client, int query_id)
+void* CompletionServer<Completer, Index>::runIoServiceThreadFunction(
+    void* ioService)
 {
-  pthread_struct* args = new pthread_struct();
-  args->query_id = query_id;
-  args->index = &index;
-  args->history = &history;
-  args->fuzzySearcher = _fuzzySearcher;
-  args->client = &client;
-  args->io_service = &io_service;
+  boost::asio::io_service* service = (boost::asio::io_service*) ioService;
+  while (true)
+  {
+    // Exceptions from handlers should not end the thread.
+    try
+    {
+      service->run();
+      break;
+    }
+    catch (Exception& e)
+    {
+      cout << "! " << e.getFullErrorMessage() << endl;
+    }
+    catch (exception& e)
+    {
+      cout << "! STD EXCEPTION: " << e.what() << endl;
+    }
+  }
+  return NULL;
+}
 
-  ConcurrentLog log;
-  log.setId(query_id);
-  log << IF_VERBOSITY_HIGH << "* creating new thread " << endl;
 
-#ifdef DEBUG_PTHREAD_CREATE_TIME
-  if (runMultithreaded == false) CompletionServer<Completer, Index>::threadCreateTimer.start();
-#endif
+//! Accept the next connection.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::startAccept()
+{
+  query_id++;
+  ConnectionPtr connection(new Connection(this, query_id));
+  acceptor.async_accept(connection->socket,
+      boost::bind(&CompletionServer<Completer, Index>::handleAccept, this,
+                  connection, boost::asio::placeholders::error));
+}
 
-  pthread_t pthread_id;
-  int ret = pthread_create(&pthread_id, NULL,
-      CompletionServer<Completer, Index>::processRequestThreadFunction,
-      (void*) args);
-  if (ret != 0) throw Exception(Exception::COULD_NOT_CREATE_THREAD,
-      strerror(errno));
 
-  // NEW 11Sep07 (Holger): optionally wait for thread to finish
-  if (runMultithreaded == false) pthread_join(pthread_id, NULL); // dared to remove this 08Jun07
-} // end of processRequestInOwnThread
+//! Called by boost::asio::async_accept(...)
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::handleAccept(
+    ConnectionPtr connection, const boost::system::error_code& error)
+{
+  ConcurrentLog log;
+  log.setId(connection->id);
+  if (error)
+  {
+    log << "! accepting connection failed (" << error.message() << ")"
+        << endl;
+  }
+  else
+  {
+    time_t NOW = time(NULL);
+    string currentTime = ctime(&NOW);
+    size_t pos = currentTime.find_first_of("\r\n");
+    if (pos != string::npos) currentTime.erase(pos);
+    boost::system::error_code endpoint_error;
+    boost::asio::ip::tcp::endpoint remote
+      = connection->socket.remote_endpoint(endpoint_error);
+    log << endl;
+    log << "new query from " << (endpoint_error ? string("[unknown]")
+                                 : remote.address().to_string())
+        << " at " << currentTime << endl;
+    connection->start();
+  }
+  startAccept();
+}
 
 
-//! Thread function called by processRequestLaunchThread (required to be of type void*(*)(void*) by pthreads)
+//! Process a request, runs in a compute thread.
 template<class Completer, class Index>
-void* CompletionServer<Completer, Index>::processRequestThreadFunction(
-    void* arguments)
+void CompletionServer<Completer, Index>::processRequestInComputeThread(
+    ConnectionPtr connection, RequestPtr request)
 {
   // Keep track of number of threads
   pthread_mutex_lock(&process_query_thread_mutex);
@@ -604,57 +729,50 @@ void* CompletionServer<Completer, Index>::processRequestThreadFunction(
   cout << "In processRequest: currently " << nofRunningProcessorThreads << " threads running" << endl;
 #endif
 
-#ifndef NDEBUG
-  // Measure time for thread creation (as of 26Dec07 on dork: around 50 microseconds)
-  if (runMultithreaded == false) CompletionServer<Completer, Index>::threadCreateTimer.stop();
-#endif
-
-  // Get arguments and free the memory for the struct pointer
-  assert(arguments != NULL);
-  pthread_struct args = *(struct pthread_struct*) arguments;
-
-  // Each thread gets its own completer, with own buffers, timers, etc.
-  // (but they all share the same Index and History)
-  Completer completer(args.index, args.history, args.fuzzySearcher);
-  //Completer completer(*(Index*)(((void**)(args))[2]), *(History*)(((void**)(args))[3]));
-  completer.log.setId(args.query_id);
-
-  // Process request in separate function with proper exception handling (can't
-  // do exception handling with thread function directly, since it is only
-  // called implicitly via pthread_create)   NEW 26Dec07 (Holger)
-  try
   {
-    CompletionServer<Completer, Index>::processRequest(*args.client, *args.io_service, completer);
-  }
-  // Report any communication errors that occurred during processing (errors in
-  // the actual computation are dealt with inside processRequest already)
-  catch (Exception& e)
-  {
-    completer.log << "! " << e.getFullErrorMessage() << endl;
-    // currently assuming that all \c throws come before the connection to
-    // the client has been closed, so make sure to close it here
-    args.client->close();
-  }
-  catch (exception& e)
-  {
-    completer.log << "! STD EXCEPTION: " << e.what() << endl;
-  }
-  catch (...)
-  {
-    completer.log << "! UNKNOWN EXCEPTION (should never happen)" << endl;
+    // Each request gets its own completer, with own buffers, timers, etc.
+    // (but they all share the same Index and History)
+    Completer completer(&index, &history, _fuzzySearcher);
+    completer.log.setId(connection->id);
+
+    // Process request in separate function with proper exception handling.
+    try
+    {
+      processRequest(*connection, *request, completer);
+    }
+    // Report any communication errors that occurred during processing (errors
+    // in the actual computation are dealt with inside processRequest already).
+    // No response could be sent, so close the connection.
+    catch (Exception& e)
+    {
+      completer.log << "! " << e.getFullErrorMessage() << endl;
+      connection->strand.post(boost::bind(&Connection::close, connection));
+    }
+    catch (exception& e)
+    {
+      completer.log << "! STD EXCEPTION: " << e.what() << endl;
+      connection->strand.post(boost::bind(&Connection::close, connection));
+    }
+    catch (...)
+    {
+      completer.log << "! UNKNOWN EXCEPTION (should never happen)" << endl;
+      connection->strand.post(boost::bind(&Connection::close, connection));
+    }
   }
 
-  // End thread
+  // All buffers of the request are freed now (those of results in the history
+  // live on). Keep only a limited number of them cached for the next request
+  // of this thread.
+  MemoryPool::trimThreadCache();
+
   assert(nofRunningProcessorThreads > 0);
   pthread_mutex_lock(&process_query_thread_mutex);
   --nofRunningProcessorThreads;
   pthread_mutex_unlock(&process_query_thread_mutex);
-  return NULL;
-
-} // end of processRequestThreadFunction
+} // end of processRequestInComputeThread
 
 
-//! The function where the query is actually processed (called from processRequestThreadFunction)
+//! The function where the query is actually processed (called from processRequestInComputeThread)
 /*
  *   1. Get request string from client
  *   2. Parse request string (extract parameters and actual query)
@@ -665,9 +783,8 @@ void* CompletionServer<Completer, Index>::processRequestThreadFunction(
  *   7. History maintenance (cut down if it has become too large)
  */
 template<class Completer, class Index>
-void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::socket& client,
-    boost::asio::io_service& io_service,
-    Completer& completer)
+void CompletionServer<Completer, Index>::processRequest(Connection& connection,
+    Request& request, Completer& completer)
 {
   ConcurrentLog& log = completer.log;
   completer.resetTimersAndCounters(); // TODO: not really necessary for newly created completer, is it?
@@ -679,140 +796,47 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
   QueryResult resultOnError;
   bool errorOccurred = false;
   string errorMessage;
-  string requestString = "";
+  string requestString;
   string resultString = "";
-  string postRequestContent;
+  // Note: the parameters are url-decoded in place, in the request buffers.
+  string& postRequestContent = request.postRequestContent;
   // Protocol (GET, HEAD, POST)   NEW 17Oct13 (baumgari)
-  int completionServerProtocol = CS_PROTOCOL_UNDEFINED;
+  int completionServerProtocol = request.protocol;
+  // The request line and header fields, already parsed by the I/O thread.
+  const HttpRequestHeader& header = request.header;
+  char* requestBuffer = &request.requestString[0];
+  string requestLine = request.requestString.substr(0, header.requestLineLength);
 
-#ifdef DEBUG_PTHREAD_CREATE_TIME
-  if (runMultithreaded == false) log << IF_VERBOSITY_HIGH
-      << "! time passed between pthread_create and call of thread function: "
-      << CompletionServer<Completer, Index>::threadCreateTimer << endl;
-#endif
   try
   {
     //
-    // 1. Get request string from client
+    // 1. Get request string from client (already read by the I/O threads)
     //
-    log << "reading from client ... " << flush;
-    completer.receiveQueryTimer.start();
-    char* buf = new char[MAX_POST_QUERY_LENGTH + 1];
-    unsigned int postRequestContentLength = 0;
-    size_t endOfHeader = string::npos;
-    boost::asio::deadline_timer timeout(io_service);
-    boost::system::error_code read_error;
-    boost::system::error_code wait_error;
-
-    // Receive data.
-    client.async_read_some(boost::asio::buffer(buf, MAX_POST_QUERY_LENGTH + 1),
-      boost::bind(&read_callback, boost::ref(buf), boost::ref(completionServerProtocol),
-                  boost::ref(completer), boost::ref(timeout), read_error,
-                  boost::asio::placeholders::bytes_transferred));
-    timeout.expires_from_now(boost::posix_time::milliseconds(1000));
-    timeout.async_wait(boost::bind(&wait_callback, boost::ref(client), wait_error));
-
-    // Will block until async callbacks are finished
-    io_service.run();
-    io_service.reset();
-  
-    // Interpret received data.
-    requestString = buf;
-    delete[] buf;
-
-    if (requestString.empty()) {
-      ostringstream os;
-      os << "Empty request string";
-      completer.statusCode = 0;
-      CS_THROW(Exception::BAD_REQUEST, os.str());
-    }
-
-    if (completionServerProtocol == CS_PROTOCOL_UNDEFINED)
-    {
-      if (requestString.compare(0, 3, "GET") == 0)
-        completionServerProtocol = CS_PROTOCOL_HTTP_GET;
-      else if (requestString.compare(0, 4, "POST") == 0)
-        completionServerProtocol = CS_PROTOCOL_HTTP_POST;
-      else if (requestString.compare(0, 4, "HEAD") == 0)
-       completionServerProtocol = CS_PROTOCOL_HTTP_HEAD;
-    } 
-    if (endOfHeader == string::npos) endOfHeader = requestString.find("\r\n\r\n");
-
-    // POST request procedure.
-    // Read out content length, if not already done.
-    if (completionServerProtocol == CS_PROTOCOL_HTTP_POST
-        && endOfHeader != string::npos && postRequestContentLength == 0)
+    completer.receiveQueryTimer = request.receiveTimer;
+    // Keep the connection only if the client wants it and there is a limit on
+    // how long we wait for the next request.
+    completer.keepAlive = request.keepAlive && keepAliveTimeoutMsecs > 0
+      && connection.nofRequests < keepAliveMaxNofRequests;
+    if (request.errorStatusCode != 0)
     {
-      // NEW 04Oct13 (baumgari): Big data is often requested by using the
-      // header "Expect: 100-continue". This means, that the client needs a
-      // confirmation before sending the data itself and sends afterwards
-      // the data without response body using the same connection.
-      // This can be initiated by answering with a response header with
-      // status code 100 Continue. I tried that by using curl. After
-      // answering it did nothing else. Don't know how to initiate it or if
-      // the server just "oversights" the following request.
-      // TODO(baumgari): Take a deeper look into that. Until that we
-      // respond with the correct error status code.
-      string expectHeader = "Expect: 100-continue";
-      if (requestString.find(expectHeader) != string::npos)
-      {
-        completer.receiveQueryTimer.stop();
-        completer.statusCode = 417;
-        ostringstream os;
-        os << "Header \"Expect: 100-continue\": data is sent in the next request." << endl;
-        CS_THROW(Exception::BAD_REQUEST, os.str());
-      }
-
-      // Get content length header.
-      string contentLengthHeader = "Content-Length: ";
-      size_t pos = requestString.find(contentLengthHeader);
-      if (pos != string::npos) pos += contentLengthHeader.size();
-      else
-      {
-        ostringstream os;
-        os << "Content length header in post request is missing: "
-           << requestString << ".";
-        completer.statusCode = 411;
-        CS_THROW(Exception::BAD_REQUEST, os.str());
-      }
-
-      // Get content length.
-      string strContentLength = requestString.substr(pos, pos + requestString.find('\r'));
-      postRequestContentLength = atoi(strContentLength.c_str());
-
-      // Check content length.
-      if (postRequestContentLength != 0) {
-	postRequestContent = "?" + requestString.substr(endOfHeader + 4, postRequestContentLength);
-      }
-      else
-      {
-        ostringstream os;
-        os << "Content length is zero or could not be converted to an integer: \""
-           << strContentLength << "\"";
-        completer.statusCode = 400;
-        CS_THROW(Exception::BAD_REQUEST, os.str());
-      }
+      completer.statusCode = request.errorStatusCode;
+      CS_THROW(Exception::BAD_REQUEST, request.errorMessage);
     }
-  
-    completer.receiveQueryTimer.stop();
 
     // Read buffer -> request string
     if (completionServerProtocol == CS_PROTOCOL_HTTP_POST && postRequestContent.empty())
     {
       ostringstream os;
       os << "Could not extract content of POST request:\n"
-         << requestString << endl;
+         << request.requestString << endl;
       completer.statusCode = 400;
       CS_THROW(Exception::BAD_REQUEST, os.str());
     }
       
-    unsigned int requestStringLength = requestString.length();
-    size_t pos = requestString.find('\r');
-    if (pos != string::npos) requestString.erase(pos) + "...";
-    log << "received \"" << requestString
+    log << "received \"" << requestLine
         << (postRequestContent.empty() ? ""  : 
 	   ("\" with query parameters: \"" + postRequestContent))
-        << "\" (" << requestStringLength << " characters) in " 
+        << "\" (" << request.requestString.length() << " characters) in " 
         << completer.receiveQueryTimer 
 	<< endl;
 
@@ -821,33 +845,26 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
     //
 
     log << IF_VERBOSITY_HIGH << "! completion server protocol: HTTP" << endl;
-    pos = requestString.find(" HTTP/1.");
-    if (pos == string::npos)
+    if (!header.hasVersion)
     {
       ostringstream os;
-      os << "missing \"HTTP/1.x\" in HTTP request \"" << requestString
+      os << "missing \"HTTP/1.x\" in HTTP request \"" << requestLine
           << "\"";
       completer.statusCode = 400;
       CS_THROW(Exception::BAD_REQUEST, os.str());
     }
-    requestString.erase(pos);
 
-    // Erase request method string ("GET ", "POST ", "HEAD ").
+    // Check the request method (GET, POST, HEAD).
     switch (completionServerProtocol) 
     {
       case CS_PROTOCOL_HTTP_GET:
-        requestString.erase(0, 4);
-        break;
       case CS_PROTOCOL_HTTP_POST:
-        requestString.erase(0, 5);
-        break;
       case CS_PROTOCOL_HTTP_HEAD:
-        requestString.erase(0, 5);
         break;
       case CS_PROTOCOL_UNDEFINED:
       {
         ostringstream os;
-        os << "missing \"GET\" or \"HEAD\" or \"POST\" in HTTP request \"" << requestString << "\"";
+        os << "missing \"GET\" or \"HEAD\" or \"POST\" in HTTP request \"" << requestLine << "\"";
         completer.statusCode = 400;
         CS_THROW(Exception::BAD_REQUEST, os.str());
         break;
@@ -863,18 +880,44 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
     }
 
 
-    // This was a post request.
-    if (!postRequestContent.empty()) requestString = postRequestContent;
-    // NEW 01Nov12 (baumgari) I: Move query type checking to QueryParameters.
-    // Erase "/" but not the question mark - relevant for parsing.
-    else if (requestString.compare(0, 2, "/?") == 0) requestString.erase(0, 1);
+    // The request target, e.g. "/?q=test&h=10".
+    char* target = requestBuffer + header.target.begin;
+    char* targetEnd = target + header.target.length;
+
+    // Metrics for monitoring (not recorded themselves).
+    if (postRequestContent.empty()
+        && HttpRequestHeader::equals(requestBuffer, header.target, "/metrics"))
+    {
+      resultString = metricsResponse(completer);
+      log << IF_VERBOSITY_HIGH << "* returning metrics" << endl;
+      if (completionServerProtocol == CS_PROTOCOL_HTTP_HEAD)
+        resultString.erase(resultString.find("\r\n\r\n") + 4);
+      sendResult(resultString.length(), resultString, connection, completer, log);
+      return;
+    }
+
+    // Get the query parameters, from the body of a POST request (url-encoded
+    // or JSON) or from the request target without the "/" (the question mark
+    // is relevant for parsing).
+    bool parametersOk = false;
+    if (!postRequestContent.empty())
+    {
+      char* content = &postRequestContent[0];
+      char* contentEnd = content + postRequestContent.size();
+      parametersOk = header.hasJsonContent
+        ? queryParameters.extractFromJson(content, contentEnd)
+        : queryParameters.extractFromRequestStringHttp(content, contentEnd);
+    }
+    else if (targetEnd - target >= 2 && target[0] == '/' && target[1] == '?')
+      parametersOk = queryParameters.extractFromRequestStringHttp(target + 1,
+                                                                  targetEnd);
     // NEW 25Mar12 (baumgari): In case /? is missing, we want to be able to
     // return the requested file, e.g. <host>:<port>/index.html, if a
     // document root is specified.
     else
     {
       // NEW 13Mar09 (Hannah): url decode the request string (+ -> space, %20 -> space, etc.)
-      requestString = decodeHexNumbers(requestString);
+      requestString = decodeHexNumbers(string(target, targetEnd));
  
       ostringstream os;
       if (!documentRoot.empty())
@@ -924,7 +967,7 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
 
         os << "HTTP/1.1 200 OK\r\n"
            << "Content-Length: " << resultString.size() << "\r\n"
-           << "Connection: close\r\n" 
+           << connectionHeaderField(completer.keepAlive)
            << "Content-Type: " << contentType
            << "; charset=" << encodingAsString << "\r\n";
         if (corsEnabled)
@@ -934,7 +977,7 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
 
         log << "* NEW: Returning specified file: \"" << path << "\""
             << " ... extension was: \"" << extension << "\"" << endl;
-        sendResult(resultString.length(), resultString, client, completer, log);
+        sendResult(resultString.length(), resultString, connection, completer, log);
         return;
       }
       else
@@ -947,17 +990,15 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
       }
     }
 
-    // NEW 01Nov12 (baumgari) II: Get queryParameters.
-    if (queryParameters.extractFromRequestStringHttp(requestString) == false) {
+    if (parametersOk == false) {
       ostringstream os;
       os << "! ERROR in QueryParameters.cpp.";
       completer.statusCode = 400;
       CS_THROW(Exception::BAD_REQUEST, os.str());
     }
 
+    // Note: the query is already url-decoded.
     requestString = queryParameters.query;
-    // NEW 13Mar09 (Hannah): url decode the request string (+ -> space, %20 -> space, etc.)
-    requestString = decodeHexNumbers(requestString);
  
     if (queryParameters.queryType == QueryParameters::NORMAL)
     {
@@ -1179,7 +1220,15 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
   //   TODO: ignore SIGPIPE!!! (process gets SIGPIPE when client aborts during
   //   write, and probably also during read above)
   //
-  sendResult(resultString.length(), resultString, client, completer, log);
+  //   The response to a HEAD request must not have a body, otherwise the
+  //   client would take it for the response to its next request.
+  //
+  if (completionServerProtocol == CS_PROTOCOL_HTTP_HEAD)
+  {
+    size_t endOfHeader = resultString.find("\r\n\r\n");
+    if (endOfHeader != string::npos) resultString.erase(endOfHeader + 4);
+  }
+  sendResult(resultString.length(), resultString, connection, completer, log);
 
   if (errorOccurred)
   {
@@ -1187,6 +1236,8 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
     {
       completer.removeFromHistory(query);
     }
+    completer.threadTimer.stop();
+    recordMetrics(completer, errorOccurred);
     return;
   }
   //
@@ -1200,7 +1251,10 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
 #endif
 
   // Check if result that was just computed is still in history; TODO: why?
-  if (result != NULL)
+  // The result of a count-only query is never in the history.
+  if (result != NULL
+      && result->_howResultWasComputed != QueryResult::COUNTS_ONLY
+      && result->_howResultWasComputed != QueryResult::COUNTS_FROM_HISTORY)
   {
     if (!completer.isInHistoryConst(query)) log
         << " In CompletionServer.h: query " << query
@@ -1230,7 +1284,10 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
   }
   pthread_mutex_unlock(&process_query_thread_mutex);
 
-  // Check if history has become too large and if so, remove some old results
+  // Check if history has become too large and if so, remove some old results.
+  // Only if no other thread is processing a query: its code expects the
+  // results it has just added or looked up to be in the history until it is
+  // done with them (the references of its completer only keep them valid).
   log << "checking history size ... " << flush;
   pthread_mutex_lock(&process_query_thread_mutex);
   bool wasHistoryCutDown = false;
@@ -1263,6 +1320,7 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
   //
 
   completer.threadTimer.stop();
+  recordMetrics(completer, errorOccurred);
         
   if (queryParameters.queryType == QueryParameters::NORMAL)
   {
@@ -1287,6 +1345,94 @@ void CompletionServer<Completer, Index>::processRequest(boost::asio::ip::tcp::so
   }
 } // end of processRequest
 
+// ____________________________________________________________________________
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::recordMetrics(
+    const Completer& completer, bool errorOccurred)
+{
+  serverMetrics.nofRequests.add(1);
+  if (errorOccurred) serverMetrics.nofErrors.add(1);
+  serverMetrics.requestTime.add(completer.threadTimer.usecs());
+
+  // Stages which did not run for this query are not recorded, otherwise they
+  // would drown the stage's real distribution in zeros.
+  struct
+  {
+    Histogram& histogram;
+    const Timer& timer;
+  }
+  stages[] =
+  {
+    { serverMetrics.receiveQueryTime, completer.receiveQueryTimer },
+    { serverMetrics.processQueryTime, completer.processQueryTimer },
+    { serverMetrics.intersectionTime, completer.intersectionTimer },
+    { serverMetrics.fileReadTime, completer.fileReadTimer },
+    { serverMetrics.doclistDecompressionTime,
+      completer.doclistDecompressionTimer },
+    { serverMetrics.positionlistDecompressionTime,
+      completer.positionlistDecompressionTimer },
+    { serverMetrics.wordlistDecompressionTime,
+      completer.wordlistDecompressionTimer },
+    { serverMetrics.mergeResultsTime, completer.mergeResultsTimer },
+    { serverMetrics.scoreDocsTime, completer.scoreDocsTimer },
+    { serverMetrics.scoreWordsTime, completer.scoreWordsTimer },
+    { serverMetrics.getExcerptsTime, completer.getExcerptsTimer },
+    { serverMetrics.buildResultStringTime, completer.buildResultStringTimer },
+    { serverMetrics.historyCleanUpTime, completer.historyCleanUpTimer },
+    { serverMetrics.fuzzySearchTime, completer.fuzzySearchTotalTimer }
+  };
+  for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++)
+    if (stages[i].timer.usecs() > 0)
+      stages[i].histogram.add(stages[i].timer.usecs());
+
+  serverMetrics.nofQueriesFromHistory.add(completer.nofQueriesFromHistory);
+  serverMetrics.nofQueriesByFiltering.add(completer.nofQueriesByFiltering);
+  serverMetrics.nofBlocksReadFromFile.add(completer.nofBlocksReadFromFile);
+  serverMetrics.volumeReadFromFile.add(completer.volumeReadFromFile);
+  serverMetrics.doclistVolumeDecompressed.add(
+      completer.doclistVolumeDecompressed);
+  serverMetrics.nofIntersections.add(completer.nofIntersections);
+  serverMetrics.intersectNofPostings.add(completer.intersectNofPostings);
+  serverMetrics.fuzzySearchNofClusters.add(completer.fuzzySearchCoverIndex);
+  serverMetrics.fuzzySearchNofSimilarWords.add(
+      completer.fuzzySearchNumSimilarWords);
+}
+
+// ____________________________________________________________________________
+template<class Completer, class Index>
+string CompletionServer<Completer, Index>::metricsResponse(
+    const Completer& completer)
+{
+  ostringstream body;
+  serverMetrics.write(body);
+  ServerMetrics::writeGauge(body, "completesearch_history_bytes",
+      "Size of the results in the history.",
+      completer.getSizeOfHistoryInBytes());
+  ServerMetrics::writeGauge(body, "completesearch_history_queries",
+      "Number of queries in the history.",
+      completer.getNofQueriesInHistory());
+  ServerMetrics::writeGauge(body, "completesearch_running_compute_threads",
+      "Number of requests currently processed.", nofRunningProcessorThreads);
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  ServerMetrics::writeGauge(body, "completesearch_process_cpu_seconds",
+      "User and system CPU time of the server.",
+      usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+      + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+  ServerMetrics::writeGauge(body, "completesearch_process_max_resident_bytes",
+      "Maximal resident set size of the server.", usage.ru_maxrss * 1024.0);
+
+  ostringstream os;
+  os << "HTTP/1.1 200 OK\r\n"
+     << "Content-Length: " << body.str().size() << "\r\n"
+     << connectionHeaderField(completer.keepAlive)
+     << "Content-Type: text/plain; version=0.0.4\r\n";
+  if (corsEnabled)
+    os << "Access-Control-Allow-Origin: *\r\n";
+  os << "\r\n" << body.str();
+  return os.str();
+}
+
 // ____________________________________________________________________________
 template<class Completer, class Index>
 string CompletionServer<Completer, Index>
@@ -1373,42 +1519,14 @@ string CompletionServer<Completer, Index>
 
 }
 
-//! Send given result to client.
+//! Hand the given result to the connection, which sends it to the client.
 template<class Completer, class Index>
 void CompletionServer<Completer, Index>::sendResult(
-    const unsigned int len, const string& resultString, boost::asio::ip::tcp::socket& client,
+    const unsigned int len, const string& resultString, Connection& connection,
     const Completer& completer, ConcurrentLog& log)
 {
-  log << "sending result ... " << flush;
-  completer.sendResultTimer.start();
-  boost::system::error_code write_error;
-  boost::asio::write(client, boost::asio::buffer(resultString),
-                     boost::asio::transfer_all(), write_error);
-  if (write_error) {
-    ostringstream os;
-    os << "sending result failed (" << write_error.message() << ")";
-    CS_THROW(Exception::OTHER, os.str());
-  }
-  boost::system::error_code send_error;
-  client.shutdown(boost::asio::ip::tcp::socket::shutdown_both, send_error);
-  if (send_error) {
-    ostringstream os;
-    os << "Shutting down socket failed (" << send_error.message() << ")";
-    CS_THROW(Exception::OTHER, os.str());
-  }
-  client.close(send_error);
-  if (send_error) {
-    ostringstream os;
-    os << "Closing socketfailed (" << send_error.message() << ")";
-    CS_THROW(Exception::OTHER, os.str());
-  }
-
-  completer.sendResultTimer.stop();
-  log << "done, sent " << commaStr(int(len)) << " bytes in "
-      << completer.sendResultTimer << " ("
-      << (completer.sendResultTimer.usecs() != 0 ? commaStr(
-          int(len) / completer.sendResultTimer.usecs()) : "???")
-      << " MB/sec)" << endl;
+  log << "sending result of " << commaStr(int(len)) << " bytes" << endl;
+  connection.send(resultString, completer.keepAlive);
 }
 
 template<class Completer, class Index>
@@ -1586,7 +1704,7 @@ string CompletionServer<Completer, Index>::resultAsHttpResponse(
   int statusCode = (completer.statusCode == -1 ? 500 : completer.statusCode);
   os << "HTTP/1.1 " << statusCode << " " << getHTTPStatusMessage(statusCode) << "\r\n"
      << "Content-Length: " << content.size() << "\r\n"
-     << "Connection: close\r\n"
+     << connectionHeaderField(completer.keepAlive)
      << "Content-Type: text/xml; charset=" << encodingAsString << "\r\n";
   if (corsEnabled)
     os << "Access-Control-Allow-Origin: *\r\n";
@@ -1736,7 +1854,7 @@ string CompletionServer<Completer, Index>::resultAsJsonObject(
   int statusCode = (completer.statusCode == -1 ? 500 : completer.statusCode);
   os << "HTTP/1.1 " << statusCode << " " << getHTTPStatusMessage(statusCode) << "\r\n"
      << "Content-Length: " << content.size() << "\r\n"
-     << "Connection: close\r\n";
+     << connectionHeaderField(completer.keepAlive);
 
   if (queryParameters.format == QueryParameters::JSONP)
     os << "Content-Type: application/javascript; charset=" << encodingAsString << "\r\n";
@@ -1750,75 +1868,389 @@ string CompletionServer<Completer, Index>::resultAsJsonObject(
   return os.str();
 }
 
+//! CONNECTION CONSTRUCTOR
+template<class Completer, class Index>
+CompletionServer<Completer, Index>::Connection::Connection(
+    CompletionServer* server, int id) :
+  socket(server->io_service),
+  strand(server->io_service),
+  nofRequests(0),
+  id(id),
+  _server(server),
+  _timer(server->io_service),
+  _continueSent(false),
+  _continuePending(false),
+  _responseWaiting(false),
+  _responseKeepAlive(false),
+  _timedOut(false)
+{
+  _log.setId(id);
+}
+
+//! Start reading the first request.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::start()
+{
+  strand.post(boost::bind(&Connection::readRequest, this->shared_from_this()));
+}
+
+//! Parse the request from the buffer or read more.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::readRequest()
+{
+  if (!_request)
+  {
+    _request.reset(new Request());
+    _continueSent = false;
+  }
+  if (parseRequest())
+  {
+    // Hand the complete request to the compute threads. Note that the
+    // connection does nothing until it gets the response via send.
+    nofRequests++;
+    _request->receiveTimer.stop();
+    RequestPtr request = _request;
+    _request.reset();
+    _server->computeService.post(boost::bind(
+        &CompletionServer<Completer, Index>::processRequestInComputeThread,
+        _server, this->shared_from_this(), request));
+    return;
+  }
+  if (!socket.is_open()) return;
+
+  // When waiting for a new request on a kept-alive connection, wait up to the
+  // keep-alive timeout, otherwise only READ_TIMEOUT_MSECS.
+  asyncRead(_buffer.empty() && nofRequests > 0 ? keepAliveTimeoutMsecs
+                                               : READ_TIMEOUT_MSECS);
+}
+
+//! Read more data (with timeout).
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::asyncRead(
+    unsigned int timeoutMsecs)
+{
+  _timedOut = false;
+  _timer.expires_from_now(boost::posix_time::milliseconds(timeoutMsecs));
+  _timer.async_wait(strand.wrap(boost::bind(&Connection::handleTimeout,
+      this->shared_from_this(), boost::asio::placeholders::error)));
+  socket.async_read_some(boost::asio::buffer(_readBuffer, sizeof(_readBuffer)),
+      strand.wrap(boost::bind(&Connection::handleRead,
+          this->shared_from_this(), boost::asio::placeholders::error,
+          boost::asio::placeholders::bytes_transferred)));
+}
+
+//! Called by boost::asio::async_wait(...)
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::handleTimeout(
+    const boost::system::error_code& error)
+{
+  // Data was read and this timeout was canceled (or it belongs to an earlier
+  // read and the timer has been set again since).
+  if (error || _timer.expires_at()
+               > boost::asio::deadline_timer::traits_type::now()) return;
+  // will cause handleRead to fire with an error
+  _timedOut = true;
+  boost::system::error_code cancel_error;
+  socket.cancel(cancel_error);
+}
+
 //! Called by boost::asio::async_read_some(...)
 template<class Completer, class Index>
-void CompletionServer<Completer, Index>::read_callback(const char* buffer, int& completionServerProtocol,
-                                                       Completer& completer,
-                                                       boost::asio::deadline_timer& timeout,
-                                                       const boost::system::error_code& error,
-                                                       std::size_t bytesTransferred)
+void CompletionServer<Completer, Index>::Connection::handleRead(
+    const boost::system::error_code& error, size_t bytesRead)
+{
+  boost::system::error_code cancel_error;
+  _timer.cancel(cancel_error);
+  if (bytesRead > 0)
+  {
+    if (_buffer.empty()) _request->receiveTimer.start();
+    _buffer.append(_readBuffer, bytesRead);
+    readRequest();
+    return;
+  }
+
+  // Client closed the connection, or the connection was idle before a new
+  // request started: nothing to answer.
+  if (_buffer.empty() && (error == boost::asio::error::eof
+      || nofRequests > 0))
+  {
+    _log << IF_VERBOSITY_HIGH << "connection closed by client or idle" << endl;
+    close();
+    return;
+  }
+  // A timeout while a request is read is answered with an error, everything
+  // else means that the client is gone.
+  if (_timedOut)
+  {
+    _request->keepAlive = false;
+    _request->errorStatusCode = 408;
+    _request->errorMessage = "timeout while reading request";
+    _buffer.clear();
+    nofRequests++;
+    RequestPtr request = _request;
+    _request.reset();
+    _server->computeService.post(boost::bind(
+        &CompletionServer<Completer, Index>::processRequestInComputeThread,
+        _server, this->shared_from_this(), request));
+    return;
+  }
+  _log << "! An error occured while retrieving the request: \""
+       << error.message() << "\"" << endl;
+  close();
+}
+
+//! Parse the request at the beginning of the buffer.
+/*
+ *   The request is complete when the header is complete and, for POST
+ *   requests, the body of length Content-Length. Answers
+ *   "Expect: 100-continue" with an interim "100 Continue" response. Errors are
+ *   recorded in the request (which then counts as complete) and answered by
+ *   the compute thread like all other errors.
+ */
+template<class Completer, class Index>
+bool CompletionServer<Completer, Index>::Connection::parseRequest()
 {
-  if (error || !bytesTransferred)
+  Request& request = *_request;
+  size_t endOfHeader = _buffer.find("\r\n\r\n");
+  if (endOfHeader == string::npos)
   {
-    if (error) 
+    // Check for maximal request length. Note that a GET or HEAD request is
+    // too long if its first line is too long.
+    size_t endOfFirstLine = _buffer.find("\r\n");
+    if (_buffer.compare(0, 4, "POST") != 0 && _buffer.size() >= MAX_QUERY_LENGTH
+        && (endOfFirstLine == string::npos
+            || endOfFirstLine >= MAX_QUERY_LENGTH))
     {
       ostringstream os;
-      os << "An error occured while retrieving the request: \""
-         << error.message() << "\"";
-      completer.statusCode = 400;
-      CS_THROW(Exception::BAD_REQUEST, os.str());
+      os << "string too long: " << _buffer.size() << " bytes, max is "
+         << MAX_QUERY_LENGTH;
+      request.errorStatusCode = 414;
+      request.errorMessage = os.str();
     }
-    // No data was read!
-    return;
+    else if (_buffer.size() >= MAX_POST_QUERY_LENGTH)
+    {
+      ostringstream os;
+      os << "header exceeds the limit \"" << MAX_POST_QUERY_LENGTH << "\"";
+      request.errorStatusCode = 413;
+      request.errorMessage = os.str();
+    }
+    else
+    {
+      return false;
+    }
+    // The rest of the connection cannot be interpreted anymore.
+    _buffer.clear();
+    request.keepAlive = false;
+    return true;
   }
-  
+  request.requestString = _buffer.substr(0, endOfHeader);
+  size_t endOfRequest = endOfHeader + 4;
+  const string& requestString = request.requestString;
+  // Find the parts of the header in one pass (a missing HTTP version is
+  // reported by processRequest).
+  const char* header = requestString.data();
+  request.header.parse(header, requestString.size());
+
   // Read request type.
-  if (completionServerProtocol == CS_PROTOCOL_UNDEFINED)
+  if (HttpRequestHeader::equals(header, request.header.method, "GET"))
+    request.protocol = CS_PROTOCOL_HTTP_GET;
+  else if (HttpRequestHeader::equals(header, request.header.method, "POST"))
+    request.protocol = CS_PROTOCOL_HTTP_POST;
+  else if (HttpRequestHeader::equals(header, request.header.method, "HEAD"))
+    request.protocol = CS_PROTOCOL_HTTP_HEAD;
+
+  // HTTP/1.1 connections are persistent unless the client says otherwise,
+  // HTTP/1.0 connections only if the client asks for it.
+  const HttpRequestHeader::Range& connectionField = request.header.connection;
+  if (request.header.isHttp11)
+    request.keepAlive = !HttpRequestHeader::equalsIgnoreCase(header,
+        connectionField, "close");
+  else
+    request.keepAlive = HttpRequestHeader::equalsIgnoreCase(header,
+        connectionField, "keep-alive");
+
+  size_t requestLineLength = request.header.requestLineLength;
+  if (request.protocol != CS_PROTOCOL_HTTP_POST
+      && requestLineLength >= MAX_QUERY_LENGTH)
   {
-    if (strncmp(buffer, "GET", 3) == 0)
-      completionServerProtocol = CS_PROTOCOL_HTTP_GET;
-    else if (strncmp(buffer, "POST", 4) == 0)
-      completionServerProtocol = CS_PROTOCOL_HTTP_POST;
-    else if (strncmp(buffer, "HEAD", 4) == 0)
-     completionServerProtocol = CS_PROTOCOL_HTTP_HEAD;
+    ostringstream os;
+    os << "string too long: " << requestLineLength << " bytes, max is "
+       << MAX_QUERY_LENGTH;
+    request.errorStatusCode = 414;
+    request.errorMessage = os.str();
   }
-  // Check for maximal request length.
-  if (completionServerProtocol == CS_PROTOCOL_HTTP_POST)
+
+  // POST request procedure: get the body.
+  if (request.protocol == CS_PROTOCOL_HTTP_POST)
   {
-    if (bytesTransferred >= MAX_POST_QUERY_LENGTH)
+    string strContentLength = HttpRequestHeader::asString(header,
+        request.header.contentLength);
+    size_t postRequestContentLength = atoi(strContentLength.c_str());
+    string expectField = HttpRequestHeader::asString(header,
+        request.header.expect);
+    if (strContentLength.empty())
+    {
+      ostringstream os;
+      os << "Content length header in post request is missing: "
+         << requestString << ".";
+      request.errorStatusCode = 411;
+      request.errorMessage = os.str();
+    }
+    else if (postRequestContentLength == 0)
+    {
+      ostringstream os;
+      os << "Content length is zero or could not be converted to an integer: \""
+         << strContentLength << "\"";
+      request.errorStatusCode = 400;
+      request.errorMessage = os.str();
+    }
+    else if (postRequestContentLength > MAX_POST_QUERY_LENGTH)
     {
       ostringstream os;
       os << "Content length exceeds the limit \""
          << MAX_POST_QUERY_LENGTH << "\"";
-      completer.statusCode = 414;
-      CS_THROW(Exception::BAD_REQUEST, os.str());
+      request.errorStatusCode = 413;
+      request.errorMessage = os.str();
     }
-  }
-  else
-  {
-    if (bytesTransferred >= MAX_QUERY_LENGTH)
+    else if (!expectField.empty()
+             && strcasecmp(expectField.c_str(), "100-continue") != 0)
     {
-      completer.receiveQueryTimer.stop();
-      completer.statusCode = 414;
       ostringstream os;
-      os << "string too long: " << bytesTransferred << " bytes, max is "
-         << MAX_QUERY_LENGTH;
-      CS_THROW(Exception::BAD_REQUEST, os.str());
+      os << "Unsupported expectation: \"" << expectField << "\"";
+      request.errorStatusCode = 417;
+      request.errorMessage = os.str();
+    }
+    else
+    {
+      endOfRequest += postRequestContentLength;
+      if (_buffer.size() < endOfRequest)
+      {
+        // Big data is often requested by using the header "Expect:
+        // 100-continue". This means that the client waits for a confirmation
+        // before sending the body.
+        if (!expectField.empty() && !_continueSent)
+        {
+          _continueSent = true;
+          _continuePending = true;
+          static const string continueResponse
+            = "HTTP/1.1 100 Continue\r\n\r\n";
+          boost::asio::async_write(socket,
+              boost::asio::buffer(continueResponse),
+              strand.wrap(boost::bind(&Connection::handleContinueSent,
+                  this->shared_from_this(), boost::asio::placeholders::error)));
+        }
+        return false;
+      }
+      // A JSON body is parsed as it is, a url-encoded one like the query
+      // string of a GET request.
+      request.postRequestContent.reserve(postRequestContentLength + 1);
+      if (!request.header.hasJsonContent) request.postRequestContent = "?";
+      request.postRequestContent.append(_buffer, endOfHeader + 4,
+                                        postRequestContentLength);
     }
   }
-  // will cause wait_callback to fire with an error
-  timeout.cancel();
+
+  if (request.errorStatusCode != 0)
+  {
+    // The framing of the following requests is lost.
+    _buffer.clear();
+    request.keepAlive = false;
+    return true;
+  }
+  // Keep what follows for the next request.
+  _buffer.erase(0, endOfRequest);
+  return true;
 }
 
-//! Called by boost::asio::async_wait(...)
+//! Called by boost::asio::async_write(...) for "100 Continue".
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::handleContinueSent(
+    const boost::system::error_code& error)
+{
+  // Note: reading the body is already under way, a failed write shows there.
+  if (error)
+    _log << "! sending \"100 Continue\" failed (" << error.message() << ")"
+         << endl;
+  _continuePending = false;
+  // Only one write may be pending on the socket at a time, so a response
+  // that came in the meantime is written only now.
+  if (_responseWaiting)
+  {
+    _responseWaiting = false;
+    writeResponse(_responseKeepAlive);
+  }
+}
+
+//! Send the response to the current request.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::send(
+    const string& response, bool keepAlive)
+{
+  // Note: called from a compute thread, everything else happens in the
+  // strand. The bound pointer keeps the connection alive until then.
+  strand.post(boost::bind(&Connection::write, this->shared_from_this(),
+                          response, keepAlive));
+}
+
+//! Write the response to the socket.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::write(
+    const string& response, bool keepAlive)
+{
+  _response = response;
+  if (_continuePending)
+  {
+    _responseWaiting = true;
+    _responseKeepAlive = keepAlive;
+    return;
+  }
+  writeResponse(keepAlive);
+}
+
+//! Start writing _response to the socket.
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::writeResponse(
+    bool keepAlive)
+{
+  boost::asio::async_write(socket, boost::asio::buffer(_response),
+      strand.wrap(boost::bind(&Connection::handleWrite,
+          this->shared_from_this(), boost::asio::placeholders::error,
+          keepAlive)));
+}
+
+//! Called by boost::asio::async_write(...)
+template<class Completer, class Index>
+void CompletionServer<Completer, Index>::Connection::handleWrite(
+    const boost::system::error_code& error, bool keepAlive)
+{
+  if (error)
+  {
+    _log << "! sending result failed (" << error.message() << ")" << endl;
+    close();
+    return;
+  }
+  _log << IF_VERBOSITY_HIGH << "sent " << commaStr(int(_response.size()))
+       << " bytes" << endl;
+  _response.clear();
+  if (keepAlive) readRequest();
+  else close();
+}
+
+//! Shut down and close the connection.
 template<class Completer, class Index>
-void CompletionServer<Completer, Index>::wait_callback(boost::asio::ip::tcp::socket& client,
-                                                       const boost::system::error_code& error)
+void CompletionServer<Completer, Index>::Connection::close()
 {
-  // Data was read and this timeout was canceled
-  if (error) return;
-  // will cause read_callback to fire with an error
-  client.cancel();
+  boost::system::error_code error;
+  _timer.cancel(error);
+  if (!socket.is_open()) return;
+  socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+  // Note: shutdown fails if the client has already closed the connection,
+  // which is not an error from our point of view.
+  if (error && error != boost::asio::error::not_connected)
+    _log << "! shutting down socket failed (" << error.message() << ")" << endl;
+  socket.close(error);
+  if (error)
+    _log << "! closing socket failed (" << error.message() << ")" << endl;
 }
 
 //! EXPLICIT INSTANTIATION (so that actual code gets generated)
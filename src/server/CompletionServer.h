@@ -3,6 +3,7 @@
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
+#include <memory>
 #include <netinet/in.h> /* for sockets */
 #include <arpa/inet.h>
 #include <signal.h> /* for signal handling */
@@ -12,9 +13,11 @@
                         http://yolinux.com/TUTORIALS/LinuxTutorialPosixThreads.html */
 #include "Globals.h"
 #include "History.h"
+#include "HttpRequestHeader.h"
 #include "QueryParameters.h"
 #include "ExcerptsGenerator.h"
 #include "Timer.h"
+#include "Metrics.h"
 #include "../fuzzysearch/FuzzySearcher.h"
 
 // GLOBALS (implemented in CompletionServer.cpp, used in constructor below as well as in main)
@@ -39,19 +42,28 @@ enum InfoFieldFormat
 
 extern int completionServerProtocol;
 extern bool sendErrorDetailsToClient;
+extern unsigned int keepAliveTimeoutMsecs;
+extern unsigned int keepAliveMaxNofRequests;
+extern unsigned int nofIoThreads;
+extern unsigned int nofComputeThreads;
 
 //! Class that provides the main server loop: listen to query requests on a certain port and process them
 /*!
  *   -# Read vocabulary file and open index file (in constructor CompletionServer())
  *   -# Create socket (in method createSocket())
  *   -# Start server loop (in method waitForRequestsAndProcess())
- *   -# Upon query request:
- *   -# Create own thread
- *   -# Read query
+ *   -# The I/O threads accept connections and read requests asynchronously
+ *   -# A complete request is handed to one of the compute threads:
  *   -# Process query (via HYBCompleter / CompleterBase)
  *   -# Get excerpts for top-ranked documents
- *   -# Send result string
- *   -# Close connection and finish thread
+ *   -# Hand the result string back to the I/O threads, which send it
+ *   -# If the connection is kept alive (HTTP/1.1), continue with the next
+ *      (possibly already pipelined) request on the same connection,
+ *      otherwise close it
+ *
+ *   An idle connection or a slow client does not occupy a compute thread.
+ *   Only the compute threads process queries, so with one compute thread
+ *   (the default without -m) queries are processed one after the other.
  */
 template<class Completer, class Index>
 class CompletionServer
@@ -69,11 +81,6 @@ class CompletionServer
      static Protocol protocol;
      */
 
-#ifdef DEBUG_PTHREAD_CREATE_TIME
-    //! Timer for thread creation overhead (only measured when multithreading is off)
-    static Timer threadCreateTimer;
-#endif
-
     //! Constructor; reads vocabulary, opens index file, and creates socket.
     /*!
      *    TODO: Wouldn't it make more sense to create the index before, and pass
@@ -94,22 +101,143 @@ class CompletionServer
     void createSocket(int port, FILE* log_file, bool killServerIfRunning =
         true);
 
-    //! Main server loop: Wait for requests and process each in its own thread.
+    //! Main server loop: start the compute and I/O threads and run forever.
     void waitForRequestsAndProcess();
 
-    //! Create and run the thread that will process the request from the given client.
-    void processRequestLaunchThread(boost::asio::ip::tcp::socket& client, int query_id);
+    //! A request as read from a connection by an I/O thread, to be processed
+    //! by a compute thread.
+    struct Request
+    {
+      //! One of CS_PROTOCOL_*.
+      int protocol;
+      //! The request line and the header fields.
+      string requestString;
+      //! The parts of requestString needed for processing the request.
+      HttpRequestHeader header;
+      //! For POST requests "?" followed by the body (just the body if it is
+      //! JSON), empty otherwise.
+      string postRequestContent;
+      //! Whether the client wants the connection to be kept alive.
+      bool keepAlive;
+      //! If the request could not be read properly, the status code and the
+      //! message of the error response; 0 otherwise.
+      int errorStatusCode;
+      string errorMessage;
+      //! Time for receiving the request, from its first byte on.
+      Timer receiveTimer;
+      Request() : protocol(CS_PROTOCOL_UNDEFINED), keepAlive(false),
+                  errorStatusCode(0) { }
+    };
+
+    //! A client connection.
+    /*!
+     *    All asynchronous operations of a connection are run via its strand,
+     *    so at most one of its handlers runs at a time, no matter how many I/O
+     *    threads there are. The pending operations hold a shared pointer to
+     *    the connection, it is deleted when the last of them is done.
+     *
+     *    The requests on a connection are processed one after the other: the
+     *    next request is only read after the response to the previous one has
+     *    been sent. The bytes received after the end of a request are the
+     *    beginning of the next (pipelined) request.
+     */
+    class Connection : public std::enable_shared_from_this<Connection>
+    {
+     public:
+      Connection(CompletionServer* server, int id);
+
+      //! Start reading the first request.
+      void start();
+
+      //! Send the response to the current request (called from a compute
+      //! thread). If keepAlive is true, read the next request afterwards,
+      //! otherwise close the connection.
+      void send(const string& response, bool keepAlive);
+
+      //! Shut down and close the connection.
+      void close();
+
+      //! The socket and the strand of this connection.
+      boost::asio::ip::tcp::socket socket;
+      boost::asio::io_service::strand strand;
+
+      //! Number of requests read so far on this connection.
+      unsigned int nofRequests;
+
+      //! Id of this connection (used for the log).
+      int id;
+
+     private:
+      //! Parse the request from the buffer, if complete hand it to the compute
+      //! threads, otherwise read more.
+      void readRequest();
+
+      //! Parse the request at the beginning of the buffer. Returns false if it
+      //! is not yet complete.
+      bool parseRequest();
+
+      //! Write the response to the socket (in the strand). If "100 Continue"
+      //! is still being written, the response follows in handleContinueSent.
+      void write(const string& response, bool keepAlive);
+
+      //! Start writing _response, see write.
+      void writeResponse(bool keepAlive);
+
+      //! Read more data (with the given timeout) and continue with readRequest.
+      void asyncRead(unsigned int timeoutMsecs);
+
+      //! Handlers of the asynchronous operations.
+      void handleRead(const boost::system::error_code& error, size_t bytesRead);
+      void handleTimeout(const boost::system::error_code& error);
+      void handleContinueSent(const boost::system::error_code& error);
+      void handleWrite(const boost::system::error_code& error, bool keepAlive);
+
+      CompletionServer* _server;
+      boost::asio::deadline_timer _timer;
+      //! Bytes received but not yet consumed.
+      string _buffer;
+      //! Buffer for async_read_some.
+      char _readBuffer[64 * 1024];
+      //! The request currently read or processed.
+      std::shared_ptr<Request> _request;
+      //! Whether "100 Continue" has been sent for the current request.
+      bool _continueSent;
+      //! Whether the write of "100 Continue" has not completed yet.
+      bool _continuePending;
+      //! Whether _response waits for the write of "100 Continue" and the
+      //! keep-alive it is to be written with.
+      bool _responseWaiting;
+      bool _responseKeepAlive;
+      //! The response currently sent.
+      string _response;
+      //! Whether the timer fired while reading.
+      bool _timedOut;
+      ConcurrentLog _log;
+    };
+
+    typedef std::shared_ptr<Connection> ConnectionPtr;
+    typedef std::shared_ptr<Request> RequestPtr;
+
+    //! Process the given request in a compute thread (posted by the I/O
+    //! threads once the request is read completely).
+    void processRequestInComputeThread(ConnectionPtr connection,
+                                       RequestPtr request);
 
-    //! Thread function called by processRequestLaunchThread (required to be of type void*(*)(void*) by pthreads)
+    //! The function where the query is actually processed (called from processRequestInComputeThread)
     /*!
-     *    Note: method must be declared static, otherwise not of type
-     *    \c void*(*)(void*) as required by \c pthread_create from the pthreads
-     *    library
+     *    The response is handed to the connection, which sends it
+     *    asynchronously. What follows (history maintenance, statistics) is
+     *    done in parallel to sending.
      */
-    static void* processRequestThreadFunction(void* args);
+    static void processRequest(Connection& connection, Request& request,
+                               Completer& completer);
 
-    //! The function where the query is actually processed (called from processRequestThreadFunction)
-    static void processRequest(boost::asio::ip::tcp::socket& client, boost::asio::io_service& io_service, Completer& completer);
+    //! Add the timers and counters of the completer (after a request) to the
+    //! server metrics.
+    static void recordMetrics(const Completer& completer, bool errorOccurred);
+
+    //! Build the response to a request for /metrics (Prometheus text format).
+    static string metricsResponse(const Completer& completer);
 
   private:
     //! Maximal allowed request length of GET and HEAD requests.
@@ -117,23 +245,28 @@ class CompletionServer
     //! Maximal allowed request length of POST requests.
     static const unsigned int MAX_POST_QUERY_LENGTH = 2 * 1024 * 1024 - 1;
 
-    // NEW (baumgari) Apr14: We used to use an array of pointers to pass all
-    // necessary thread parameters. That was unclear. Changed that.
-    //! Struct containing all parameters needed by a thread.
-    struct pthread_struct {
-      int query_id;
-      Index* index;
-      TimedHistory* history;
-      FuzzySearch::FuzzySearcherBase* fuzzySearcher;
-      boost::asio::ip::tcp::socket* client;
-      boost::asio::io_service* io_service;
-    };
-
-    //! Provides core functionality for async network services.
+    //! Provides core functionality for async network services (run by the I/O
+    //! threads).
     boost::asio::io_service io_service;
     //! Used for accepting new incoming socket connections.
     boost::asio::ip::tcp::acceptor acceptor;
 
+    //! The compute threads run the handlers posted to this io_service. The
+    //! work object keeps them running when there is nothing to do.
+    boost::asio::io_service computeService;
+    boost::asio::io_service::work computeWork;
+
+    //! Accept the next connection (asynchronously).
+    void startAccept();
+
+    //! Handler for async_accept.
+    void handleAccept(ConnectionPtr connection,
+                      const boost::system::error_code& error);
+
+    //! Thread function of the I/O and compute threads: run the given
+    //! io_service (forever).
+    static void* runIoServiceThreadFunction(void* ioService);
+
     //! Query Id (will be 1,2,3,...)
     int query_id;
 
@@ -156,9 +289,9 @@ class CompletionServer
     //! everything would be returned.
     static string cleanupQuery(const string& query, ConcurrentLog& log);
 
-    //! Send result to client.
+    //! Hand the result to the connection, which sends it to the client.
     static void sendResult(const unsigned int len, const string& resultString,
-        boost::asio::ip::tcp::socket& client, const Completer& completer, ConcurrentLog& log);
+        Connection& connection, const Completer& completer, ConcurrentLog& log);
 
     //! Build a response string using the function resultAsJsonObject and
     //! resultAsHttpResponse.
@@ -177,16 +310,6 @@ class CompletionServer
         const Completer& completer, const vector<HitData>& hits, ConcurrentLog& log,
         bool convertXmlToJson = false);
 
-    //! Callback for boost::asio::read_some(...)
-    static void wait_callback(boost::asio::ip::tcp::socket& client,
-                              const boost::system::error_code& error);
-    
-    //! Callback for boost::asio::wait(...)
-    static void read_callback(const char* buffer, int& completionServerProtocotol,
-                              Completer& completer, boost::asio::deadline_timer& timeout,
-                              const boost::system::error_code& error, std::size_t bytes_transferred);
-
-
 }; // end of class CompletionServer
 
 #endif
@@ -147,7 +147,8 @@ INSTANTIATE_TEST_CASE_P(OPTIONS,
 
 TEST_P(CompletionServerTest, processRequest_GET)
 {
-  // run requests
+  // run requests (curl speaks HTTP/1.1, so the server keeps the connection,
+  // except after errors)
   for (unsigned int i = 0; i < 10; i++)
   {
     // Generate a word with different lengths. Content is not relevant.
@@ -162,7 +163,7 @@ TEST_P(CompletionServerTest, processRequest_GET)
     ASSERT_NO_THROW(header.at("Connection"));
     ASSERT_NO_THROW(header.at("Content-Type"));
     EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-    EXPECT_EQ("close", header["Connection"]);
+    EXPECT_EQ("keep-alive", header["Connection"]);
     EXPECT_EQ("text/xml; charset=UTF-8", header["Content-Type"]);
     EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
     if (isCorsEnabled) {
@@ -213,7 +214,7 @@ TEST_P(CompletionServerTest, processRequest_POST)
     ASSERT_NO_THROW(header.at("Connection"));
     ASSERT_NO_THROW(header.at("Content-Type"));
     EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-    EXPECT_EQ("close", header["Connection"]);
+    EXPECT_EQ("keep-alive", header["Connection"]);
     EXPECT_EQ("text/xml; charset=UTF-8", header["Content-Type"]);
     EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
     if (isCorsEnabled) {
@@ -229,20 +230,17 @@ TEST_P(CompletionServerTest, processRequest_POST)
   // hard to test the critical values.
   unsigned int requestSize = 2084;
   string word (requestSize, 'b');
-  // TODO (baumgari):
-  // The server cannot handle "Expect: 100-continue" right now. Therefore we
-  // just erase ist. Nevertheless the server should return the proper error code
-  // "417 Expectation Failed" in this case. This is not working right now and
-  // needs to be implemented.
-  // NEW (baumgari): Done. Test both cases.
-  string request = generateHTTPRequest("POST", string("q=") + word, outputFilename);
+  // The server answers "Expect: 100-continue" with "100 Continue" and then
+  // reads the body. Test both with and without the header.
+  string request = generateHTTPRequest("POST", string("q=") + word, outputFilename,
+                                       "--header \"Expect: 100-continue\"");
   execute(request.c_str());
   map<string, string> header = parseHeader(fileToString(outputFilename.c_str()));
   ASSERT_NO_THROW(header.at("Status"));
   ASSERT_NO_THROW(header.at("Connection"));
   ASSERT_NO_THROW(header.at("Content-Type"));
-  EXPECT_EQ("HTTP/1.1 417 Expectation Failed", header["Status"]);
-  EXPECT_EQ("close", header["Connection"]);
+  EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
+  EXPECT_EQ("keep-alive", header["Connection"]);
   EXPECT_EQ("text/xml; charset=UTF-8", header["Content-Type"]);
   if (isCorsEnabled) {
     ASSERT_NO_THROW(header.at("Access-Control-Allow-Origin"));
@@ -259,7 +257,7 @@ TEST_P(CompletionServerTest, processRequest_POST)
   ASSERT_NO_THROW(header.at("Connection"));
   ASSERT_NO_THROW(header.at("Content-Type"));
   EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-  EXPECT_EQ("close", header["Connection"]);
+  EXPECT_EQ("keep-alive", header["Connection"]);
   EXPECT_EQ("text/xml; charset=UTF-8", header["Content-Type"]);
   EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
   if (isCorsEnabled) {
@@ -285,7 +283,7 @@ TEST_P(CompletionServerTest, processRequest_FORMAT)
   ASSERT_NO_THROW(header.at("Connection"));
   ASSERT_NO_THROW(header.at("Content-Type"));
   EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-  EXPECT_EQ("close", header["Connection"]);
+  EXPECT_EQ("keep-alive", header["Connection"]);
   EXPECT_EQ("text/xml; charset=UTF-8", header["Content-Type"]);
   EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
   if (isCorsEnabled) {
@@ -304,7 +302,7 @@ TEST_P(CompletionServerTest, processRequest_FORMAT)
   ASSERT_NO_THROW(header.at("Connection"));
   ASSERT_NO_THROW(header.at("Content-Type"));
   EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-  EXPECT_EQ("close", header["Connection"]);
+  EXPECT_EQ("keep-alive", header["Connection"]);
   EXPECT_EQ("application/json; charset=UTF-8", header["Content-Type"]);
   EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
   if (isCorsEnabled) {
@@ -323,7 +321,7 @@ TEST_P(CompletionServerTest, processRequest_FORMAT)
   ASSERT_NO_THROW(header.at("Connection"));
   ASSERT_NO_THROW(header.at("Content-Type"));
   EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
-  EXPECT_EQ("close", header["Connection"]);
+  EXPECT_EQ("keep-alive", header["Connection"]);
   EXPECT_EQ("application/javascript; charset=UTF-8", header["Content-Type"]);
   EXPECT_LE(0, atoi(header["Content-Length"].c_str()));
   if (isCorsEnabled) {
@@ -334,6 +332,85 @@ TEST_P(CompletionServerTest, processRequest_FORMAT)
   }
 
 }
+TEST_P(CompletionServerTest, processRequest_METRICS)
+{
+  // One query, then the metrics must count it.
+  string request = generateHTTPRequest("GET", "q=test", outputFilename);
+  execute(request.c_str());
+  string metricsFilename = outputFilename + ".metrics";
+  request = string("curl -s -o ") + metricsFilename + " -D " + outputFilename
+            + " 127.0.0.1:" + port + "/metrics";
+  execute(request.c_str());
+  map<string, string> header = parseHeader(fileToString(outputFilename.c_str()));
+  ASSERT_NO_THROW(header.at("Status"));
+  ASSERT_NO_THROW(header.at("Content-Type"));
+  EXPECT_EQ("HTTP/1.1 200 OK", header["Status"]);
+  EXPECT_EQ("text/plain; version=0.0.4", header["Content-Type"]);
+  string metrics = fileToString(metricsFilename.c_str());
+  removeFile(metricsFilename.c_str());
+  EXPECT_NE(string::npos, metrics.find("\ncompletesearch_requests_total 1\n"));
+  EXPECT_NE(string::npos,
+            metrics.find("\ncompletesearch_request_duration_seconds_count 1\n"));
+  EXPECT_NE(string::npos, metrics.find("\ncompletesearch_history_queries "));
+}
+
+TEST_P(CompletionServerTest, processRequest_PIPELINING)
+{
+  // Send three requests at once on one connection. All three must be answered
+  // in order, the first two with "Connection: keep-alive" and the last one
+  // with "Connection: close", because it asks for that.
+  boost::asio::io_service io_service;
+  boost::asio::ip::tcp::socket socket(io_service);
+  boost::asio::ip::tcp::endpoint endpoint(
+      boost::asio::ip::address::from_string("127.0.0.1"), atoi(port.c_str()));
+  // The server might not listen yet.
+  boost::system::error_code error;
+  for (int i = 0; i < 50; i++)
+  {
+    socket.connect(endpoint, error);
+    if (!error) break;
+    socket.close();
+    usleep(100 * 1000);
+  }
+  ASSERT_FALSE(error);
+  string requests =
+      "GET /?q=test&format=xml HTTP/1.1\r\nHost: localhost\r\n\r\n"
+      "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 18\r\n\r\n"
+      "q=test&format=json"
+      "GET /?q=test&format=xml HTTP/1.1\r\nConnection: close\r\n\r\n";
+  boost::asio::write(socket, boost::asio::buffer(requests));
+
+  // Read until the server closes the connection.
+  string responses;
+  char buffer[4096];
+  while (!error)
+  {
+    size_t n = socket.read_some(boost::asio::buffer(buffer), error);
+    responses.append(buffer, n);
+  }
+  EXPECT_EQ(boost::asio::error::eof, error);
+
+  vector<map<string, string> > headers;
+  size_t pos = 0;
+  while (pos < responses.size())
+  {
+    size_t endOfHeader = responses.find("\r\n\r\n", pos);
+    ASSERT_NE(string::npos, endOfHeader);
+    headers.push_back(parseHeader(responses.substr(pos, endOfHeader + 2 - pos)));
+    pos = endOfHeader + 4 + atoi(headers.back()["Content-Length"].c_str());
+  }
+  ASSERT_EQ(3u, headers.size());
+  EXPECT_EQ("HTTP/1.1 200 OK", headers[0]["Status"]);
+  EXPECT_EQ("keep-alive", headers[0]["Connection"]);
+  EXPECT_EQ("text/xml; charset=UTF-8", headers[0]["Content-Type"]);
+  EXPECT_EQ("HTTP/1.1 200 OK", headers[1]["Status"]);
+  EXPECT_EQ("keep-alive", headers[1]["Connection"]);
+  EXPECT_EQ("application/json; charset=UTF-8", headers[1]["Content-Type"]);
+  EXPECT_EQ("HTTP/1.1 200 OK", headers[2]["Status"]);
+  EXPECT_EQ("close", headers[2]["Connection"]);
+  EXPECT_EQ(pos, responses.size());
+}
+
 // Run all tests. TODO(bast): Remove and link all tests against -lgtest_main.
 int main(int argc, char** argv)
 {
@@ -104,3 +104,6 @@ template ConcurrentLog& operator<<<std::_Setprecision>(ConcurrentLog&, std::_Set
 template ConcurrentLog& operator<<<std::_Setw>(ConcurrentLog&, std::_Setw);
 template ConcurrentLog& operator<<<std::ios_base&(*)(std::ios_base&)>(ConcurrentLog&, std::ios_base&(*)(std::ios_base&));
 template ConcurrentLog& operator<<<Timer>(ConcurrentLog&, Timer);
+#if TIMER_DETAIL_LEVEL < 2
+template ConcurrentLog& operator<<<FineTimer>(ConcurrentLog&, FineTimer);
+#endif
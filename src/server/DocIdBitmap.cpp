@@ -0,0 +1,422 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/DocIdBitmap.h"
+#include <string.h>
+#include <algorithm>
+#include "server/Exception.h"
+
+namespace
+{
+inline size_t popcount(uint64_t x) { return __builtin_popcountll(x); }
+
+// Round up to a multiple of 8.
+size_t align8(size_t x) { return (x + 7) & ~size_t(7); }
+}
+
+const size_t DocIdBitmap::MAX_ARRAY_SIZE;
+const size_t DocIdBitmap::NOF_WORDS;
+
+// _____________________________________________________________________________
+bool DocIdBitmap::Container::contains(uint16_t low) const
+{
+  if (isBitmap()) return (words[low >> 6] >> (low & 63)) & 1;
+  return std::binary_search(array.begin(), array.end(), low);
+}
+
+// _____________________________________________________________________________
+size_t DocIdBitmap::Container::rank(uint16_t low) const
+{
+  if (isBitmap())
+    return wordRanks[low >> 6]
+           + popcount(words[low >> 6] & ((uint64_t(1) << (low & 63)) - 1));
+  return std::lower_bound(array.begin(), array.end(), low) - array.begin();
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::normalize(Container* container)
+{
+  vector<uint64_t>& words = container->words;
+  vector<uint16_t>& array = container->array;
+  if (container->isBitmap())
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < NOF_WORDS; i++) count += popcount(words[i]);
+    container->count = count;
+    if (count <= MAX_ARRAY_SIZE)
+    {
+      array.clear();
+      for (size_t i = 0; i < NOF_WORDS; i++)
+        for (uint64_t word = words[i]; word != 0; word &= word - 1)
+          array.push_back(64 * i + __builtin_ctzll(word));
+      vector<uint64_t>().swap(words);
+      vector<uint16_t>().swap(container->wordRanks);
+    }
+  }
+  else
+  {
+    container->count = array.size();
+    if (array.size() > MAX_ARRAY_SIZE)
+    {
+      words.assign(NOF_WORDS, 0);
+      for (size_t i = 0; i < array.size(); i++)
+        words[array[i] >> 6] |= uint64_t(1) << (array[i] & 63);
+      vector<uint16_t>().swap(array);
+    }
+  }
+  if (container->isBitmap())
+  {
+    container->wordRanks.resize(NOF_WORDS);
+    size_t rank = 0;
+    for (size_t i = 0; i < NOF_WORDS; i++)
+    {
+      container->wordRanks[i] = rank;
+      rank += popcount(words[i]);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::finish()
+{
+  _count = 0;
+  for (size_t i = 0; i < _containers.size(); i++)
+  {
+    _containers[i].firstRank = _count;
+    _count += _containers[i].count;
+  }
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::build(const DocList& docIds)
+{
+  _containers.clear();
+  for (size_t i = 0; i < docIds.size(); i++)
+  {
+    uint32_t key = docIds[i] >> 16;
+    uint16_t low = docIds[i] & 0xFFFF;
+    if (_containers.empty() || _containers.back().key != key)
+    {
+      if (!_containers.empty()) normalize(&_containers.back());
+      _containers.push_back(Container());
+      _containers.back().key = key;
+    }
+    vector<uint16_t>& array = _containers.back().array;
+    if (array.empty() || array.back() != low) array.push_back(low);
+  }
+  if (!_containers.empty()) normalize(&_containers.back());
+  finish();
+}
+
+// _____________________________________________________________________________
+size_t DocIdBitmap::findContainer(uint32_t key) const
+{
+  size_t low = 0;
+  size_t high = _containers.size();
+  while (low < high)
+  {
+    size_t middle = low + (high - low) / 2;
+    if (_containers[middle].key < key) low = middle + 1;
+    else high = middle;
+  }
+  return low;
+}
+
+// _____________________________________________________________________________
+bool DocIdBitmap::contains(DocId docId) const
+{
+  size_t c = findContainer(docId >> 16);
+  return c < _containers.size() && _containers[c].key == (docId >> 16)
+         && _containers[c].contains(docId & 0xFFFF);
+}
+
+// _____________________________________________________________________________
+size_t DocIdBitmap::rank(DocId docId) const
+{
+  size_t c = findContainer(docId >> 16);
+  if (c == _containers.size()) return _count;
+  const Container& container = _containers[c];
+  if (container.key > (docId >> 16)) return container.firstRank;
+  return container.firstRank + container.rank(docId & 0xFFFF);
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::getDocIds(DocList* docIds) const
+{
+  docIds->reserve(docIds->size() + _count);
+  for (size_t c = 0; c < _containers.size(); c++)
+  {
+    const Container& container = _containers[c];
+    DocId base = container.key << 16;
+    if (container.isBitmap())
+    {
+      for (size_t i = 0; i < NOF_WORDS; i++)
+        for (uint64_t word = container.words[i]; word != 0; word &= word - 1)
+          docIds->push_back(base + 64 * i + __builtin_ctzll(word));
+    }
+    else
+    {
+      for (size_t i = 0; i < container.array.size(); i++)
+        docIds->push_back(base + container.array[i]);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::intersect(const DocList& list, DocList* docIds,
+                            vector<uint32_t>* ranks) const
+{
+  size_t c = 0;
+  for (size_t i = 0; i < list.size(); i++)
+  {
+    DocId docId = list[i];
+    if (i > 0 && docId == list[i - 1]) continue;
+    uint32_t key = docId >> 16;
+    while (c < _containers.size() && _containers[c].key < key) c++;
+    if (c == _containers.size()) break;
+    const Container& container = _containers[c];
+    if (container.key != key) continue;
+    uint16_t low = docId & 0xFFFF;
+    if (!container.contains(low)) continue;
+    docIds->push_back(docId);
+    if (ranks != NULL)
+      ranks->push_back(container.firstRank + container.rank(low));
+  }
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::intersect(const DocIdBitmap& x, const DocIdBitmap& y,
+                            DocIdBitmap* result)
+{
+  vector<Container> containers;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < x._containers.size() && j < y._containers.size())
+  {
+    const Container& a = x._containers[i];
+    const Container& b = y._containers[j];
+    if (a.key < b.key) { i++; continue; }
+    if (b.key < a.key) { j++; continue; }
+    Container container;
+    container.key = a.key;
+    if (a.isBitmap() && b.isBitmap())
+    {
+      container.words.resize(NOF_WORDS);
+      for (size_t k = 0; k < NOF_WORDS; k++)
+        container.words[k] = a.words[k] & b.words[k];
+    }
+    else
+    {
+      // Test the doc ids of an array container against the other one.
+      const Container& small = a.isBitmap() ? b : a;
+      const Container& other = a.isBitmap() ? a : b;
+      for (size_t k = 0; k < small.array.size(); k++)
+        if (other.contains(small.array[k]))
+          container.array.push_back(small.array[k]);
+    }
+    normalize(&container);
+    if (container.count > 0) containers.push_back(container);
+    i++;
+    j++;
+  }
+  result->_containers.swap(containers);
+  result->finish();
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::unite(const DocIdBitmap& x, const DocIdBitmap& y,
+                        DocIdBitmap* result)
+{
+  vector<Container> containers;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < x._containers.size() || j < y._containers.size())
+  {
+    if (j == y._containers.size()
+        || (i < x._containers.size()
+            && x._containers[i].key < y._containers[j].key))
+    {
+      containers.push_back(x._containers[i++]);
+      continue;
+    }
+    if (i == x._containers.size()
+        || y._containers[j].key < x._containers[i].key)
+    {
+      containers.push_back(y._containers[j++]);
+      continue;
+    }
+    const Container& a = x._containers[i++];
+    const Container& b = y._containers[j++];
+    Container container;
+    container.key = a.key;
+    if (!a.isBitmap() && !b.isBitmap())
+    {
+      std::set_union(a.array.begin(), a.array.end(), b.array.begin(),
+                     b.array.end(), std::back_inserter(container.array));
+    }
+    else
+    {
+      container.words.assign(NOF_WORDS, 0);
+      const Container* parts[2] = { &a, &b };
+      for (size_t p = 0; p < 2; p++)
+      {
+        const Container& part = *parts[p];
+        if (part.isBitmap())
+        {
+          for (size_t k = 0; k < NOF_WORDS; k++)
+            container.words[k] |= part.words[k];
+        }
+        else
+        {
+          for (size_t k = 0; k < part.array.size(); k++)
+            container.words[part.array[k] >> 6]
+              |= uint64_t(1) << (part.array[k] & 63);
+        }
+      }
+    }
+    normalize(&container);
+    containers.push_back(container);
+  }
+  result->_containers.swap(containers);
+  result->finish();
+}
+
+// _____________________________________________________________________________
+size_t DocIdBitmap::intersectionCount(const DocIdBitmap& x,
+                                      const DocIdBitmap& y)
+{
+  size_t count = 0;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < x._containers.size() && j < y._containers.size())
+  {
+    const Container& a = x._containers[i];
+    const Container& b = y._containers[j];
+    if (a.key < b.key) { i++; continue; }
+    if (b.key < a.key) { j++; continue; }
+    if (a.isBitmap() && b.isBitmap())
+    {
+      for (size_t k = 0; k < NOF_WORDS; k++)
+        count += popcount(a.words[k] & b.words[k]);
+    }
+    else
+    {
+      const Container& small = a.isBitmap() ? b : a;
+      const Container& other = a.isBitmap() ? a : b;
+      for (size_t k = 0; k < small.array.size(); k++)
+        count += other.contains(small.array[k]);
+    }
+    i++;
+    j++;
+  }
+  return count;
+}
+
+// Format: <uint32 nofContainers> <uint32 0>, per container <uint32 key>
+// <uint32 count>, then per container its data: 1024 uint64 words for a bitmap
+// (count > 4096), count uint16 values for an array (padded to 8 bytes).
+
+// _____________________________________________________________________________
+void DocIdBitmap::write(vector<char>* bytes) const
+{
+  size_t start = bytes->size();
+  bytes->resize(start + getSizeInBytes(), 0);
+  char* p = &(*bytes)[start];
+  uint32_t header[2] = { static_cast<uint32_t>(_containers.size()), 0 };
+  memcpy(p, header, sizeof(header));
+  p += sizeof(header);
+  for (size_t c = 0; c < _containers.size(); c++)
+  {
+    uint32_t entry[2] = { _containers[c].key, _containers[c].count };
+    memcpy(p, entry, sizeof(entry));
+    p += sizeof(entry);
+  }
+  for (size_t c = 0; c < _containers.size(); c++)
+  {
+    const Container& container = _containers[c];
+    if (container.isBitmap())
+    {
+      memcpy(p, &container.words[0], NOF_WORDS * sizeof(uint64_t));
+      p += NOF_WORDS * sizeof(uint64_t);
+    }
+    else
+    {
+      memcpy(p, &container.array[0], container.count * sizeof(uint16_t));
+      p += align8(container.count * sizeof(uint16_t));
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void DocIdBitmap::read(const char* bytes, size_t size)
+{
+  uint32_t header[2];
+  if (size < sizeof(header))
+    CS_THROW(Exception::OTHER, "doc id bitmap is truncated");
+  memcpy(header, bytes, sizeof(header));
+  size_t nofContainers = header[0];
+  size_t offset = sizeof(header) + 2 * sizeof(uint32_t) * nofContainers;
+  if (nofContainers > 65536 || size < offset)
+    CS_THROW(Exception::OTHER, "doc id bitmap is truncated");
+  vector<Container> containers(nofContainers);
+  for (size_t c = 0; c < nofContainers; c++)
+  {
+    Container& container = containers[c];
+    uint32_t entry[2];
+    memcpy(entry, bytes + sizeof(header) + c * sizeof(entry), sizeof(entry));
+    container.key = entry[0];
+    container.count = entry[1];
+    size_t dataSize = container.count > MAX_ARRAY_SIZE
+      ? NOF_WORDS * sizeof(uint64_t)
+      : align8(container.count * sizeof(uint16_t));
+    if (container.key > 0xFFFF || container.count == 0
+        || container.count > 65536
+        || (c > 0 && containers[c - 1].key >= container.key)
+        || size - offset < dataSize)
+      CS_THROW(Exception::OTHER, "doc id bitmap has an invalid container #"
+               << c);
+    uint32_t count = container.count;
+    if (count > MAX_ARRAY_SIZE)
+    {
+      container.words.resize(NOF_WORDS);
+      memcpy(&container.words[0], bytes + offset, dataSize);
+    }
+    else
+    {
+      container.array.resize(count);
+      memcpy(&container.array[0], bytes + offset, count * sizeof(uint16_t));
+      for (size_t i = 1; i < count; i++)
+        if (container.array[i - 1] >= container.array[i])
+          CS_THROW(Exception::OTHER, "doc id bitmap has an unsorted "
+                   "container #" << c);
+    }
+    offset += dataSize;
+    normalize(&container);
+    if (container.count != count)
+      CS_THROW(Exception::OTHER, "doc id bitmap has a wrong count for "
+               "container #" << c);
+  }
+  _containers.swap(containers);
+  finish();
+}
+
+// _____________________________________________________________________________
+size_t DocIdBitmap::getSizeInBytes() const
+{
+  size_t size = 2 * sizeof(uint32_t) * (1 + _containers.size());
+  for (size_t c = 0; c < _containers.size(); c++)
+    size += _containers[c].isBitmap()
+      ? NOF_WORDS * sizeof(uint64_t)
+      : align8(_containers[c].count * sizeof(uint16_t));
+  return size;
+}
+
+// _____________________________________________________________________________
+bool DocIdBitmap::isDense(const DocList& docIds)
+{
+  if (docIds.size() == 0) return false;
+  for (size_t i = 1; i < docIds.size(); i++)
+    if (docIds[i - 1] >= docIds[i]) return false;
+  return 16 * static_cast<uint64_t>(docIds.size())
+         >= static_cast<uint64_t>(docIds[docIds.size() - 1]) + 1;
+}
@@ -0,0 +1,119 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_DOCIDBITMAP_H_
+#define SERVER_DOCIDBITMAP_H_
+
+#include <stdint.h>
+#include <vector>
+#include "server/Globals.h"
+#include "server/DocList.h"
+
+using std::vector;
+
+// A set of doc ids, compressed like a Roaring bitmap: the doc ids are split
+// into chunks of 2^16 by their upper 16 bits, and each non-empty chunk is a
+// container with the lower 16 bits of its doc ids. A container with at most
+// 4096 doc ids is a sorted array (2 bytes per doc id), a fuller one is a
+// bitmap of 2^16 bits (8 KB). So a dense set costs at most one bit per doc id,
+// and a sparse one at most 2 bytes per doc id.
+//
+// Used for the doc ids of dense hot lists (see HotLists.h). Besides
+// membership, the set supports rank (the index of a doc id among the doc ids
+// of the set, so that the postings of a list with one posting per doc can be
+// accessed by doc id) and intersection with a sorted list of doc ids. The
+// intersection and union of two sets work on whole 64-bit words of the bitmap
+// containers (loops the compiler vectorizes), and the counts come from
+// popcounts.
+class DocIdBitmap
+{
+ public:
+  DocIdBitmap() : _count(0) { }
+
+  // Build the set of the given doc ids, which must be sorted (duplicates are
+  // allowed).
+  void build(const DocList& docIds);
+
+  // The number of doc ids in the set.
+  size_t count() const { return _count; }
+
+  bool contains(DocId docId) const;
+
+  // The number of doc ids in the set smaller than the given one; for a doc id
+  // in the set, its index in the sorted set.
+  size_t rank(DocId docId) const;
+
+  // Append the doc ids of the set to the given list, in increasing order.
+  void getDocIds(DocList* docIds) const;
+
+  // Intersect with the given sorted list of doc ids (duplicates are allowed):
+  // append each doc id of the list which is in the set once to docIds, and
+  // (if ranks is not NULL) its rank to ranks.
+  void intersect(const DocList& list, DocList* docIds,
+                 vector<uint32_t>* ranks) const;
+
+  // The intersection and the union of the two sets, and the size of the
+  // intersection (without computing it).
+  static void intersect(const DocIdBitmap& x, const DocIdBitmap& y,
+                        DocIdBitmap* result);
+  static void unite(const DocIdBitmap& x, const DocIdBitmap& y,
+                    DocIdBitmap* result);
+  static size_t intersectionCount(const DocIdBitmap& x, const DocIdBitmap& y);
+
+  // Append the set to the given bytes, in a format for read below. The size
+  // is a multiple of 8.
+  void write(vector<char>* bytes) const;
+
+  // Read the set from the given bytes, as written by write. Throws an
+  // exception if they are not a valid set.
+  void read(const char* bytes, size_t size);
+
+  // The size of the set in bytes, as written by write.
+  size_t getSizeInBytes() const;
+
+  // Whether a list with the given doc ids (sorted) would be stored as a
+  // bitmap in a hot list: if it has one posting per doc, and at least one in
+  // 16 doc ids up to its largest is in the list (the density at which the
+  // containers become bitmaps).
+  static bool isDense(const DocList& docIds);
+
+ private:
+  // The containers have at most this many doc ids as an array.
+  static const size_t MAX_ARRAY_SIZE = 4096;
+  // The number of 64-bit words of a bitmap container.
+  static const size_t NOF_WORDS = 1024;
+
+  struct Container
+  {
+    // The upper 16 bits of the doc ids in the container.
+    uint32_t key;
+    // The number of doc ids in the set before this container.
+    uint32_t firstRank;
+    uint32_t count;
+    // The lower 16 bits of the doc ids, either as a sorted array, or as a
+    // bitmap with the number of bits set before each word.
+    vector<uint16_t> array;
+    vector<uint64_t> words;
+    vector<uint16_t> wordRanks;
+
+    bool isBitmap() const { return !words.empty(); }
+    bool contains(uint16_t low) const;
+    size_t rank(uint16_t low) const;
+  };
+
+  // Turn the given container into an array or a bitmap, depending on its
+  // count, and compute its count and word ranks.
+  static void normalize(Container* container);
+
+  // Set the ranks of the containers and the count of the set.
+  void finish();
+
+  // The index of the first container with a key not smaller than the given
+  // one (binary search).
+  size_t findContainer(uint32_t key) const;
+
+  vector<Container> _containers;
+  size_t _count;
+};
+
+#endif  // SERVER_DOCIDBITMAP_H_
@@ -0,0 +1,144 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "server/DocIdBitmap.h"
+#include "server/Exception.h"
+
+// Doc ids with a sparse (array) container, a dense (bitmap) container and a
+// single doc id in a third one: every 100th doc id below 2^16, every 3rd doc id
+// in [2^16, 2^17), and 2^20 + 5.
+DocList makeDocIds()
+{
+  DocList docIds;
+  for (DocId d = 0; d < 65536; d += 100) docIds.push_back(d);
+  for (DocId d = 65536; d < 131072; d += 3) docIds.push_back(d);
+  docIds.push_back((1 << 20) + 5);
+  return docIds;
+}
+
+// Build, membership, rank and getting the doc ids back.
+TEST(DocIdBitmapTest, buildContainsRank)
+{
+  DocList docIds = makeDocIds();
+  DocIdBitmap bitmap;
+  bitmap.build(docIds);
+  ASSERT_EQ(docIds.size(), bitmap.count());
+  for (size_t i = 0; i < docIds.size(); i++)
+  {
+    ASSERT_TRUE(bitmap.contains(docIds[i])) << docIds[i];
+    ASSERT_EQ(i, bitmap.rank(docIds[i])) << docIds[i];
+  }
+  ASSERT_FALSE(bitmap.contains(1));
+  ASSERT_FALSE(bitmap.contains(65537));
+  ASSERT_FALSE(bitmap.contains(200000));
+  ASSERT_EQ(1u, bitmap.rank(1));
+  ASSERT_EQ(docIds.size() - 1, bitmap.rank(200000));
+  ASSERT_EQ(docIds.size(), bitmap.rank(2000000));
+  DocList result;
+  bitmap.getDocIds(&result);
+  ASSERT_EQ(docIds.asString(), result.asString());
+
+  // Duplicates count once.
+  DocList withDuplicates;
+  withDuplicates.push_back(3);
+  withDuplicates.push_back(3);
+  withDuplicates.push_back(7);
+  bitmap.build(withDuplicates);
+  ASSERT_EQ(2u, bitmap.count());
+  ASSERT_EQ(1u, bitmap.rank(7));
+}
+
+// Intersection with a list, and intersection and union of two sets, compared
+// to the same on sorted lists.
+TEST(DocIdBitmapTest, intersectAndUnite)
+{
+  DocList docIds1 = makeDocIds();
+  DocList docIds2;
+  for (DocId d = 0; d < 140000; d += 5) docIds2.push_back(d);
+  DocIdBitmap bitmap1;
+  DocIdBitmap bitmap2;
+  bitmap1.build(docIds1);
+  bitmap2.build(docIds2);
+
+  DocList expectedIntersection;
+  std::set_intersection(docIds1.begin(), docIds1.end(), docIds2.begin(),
+                        docIds2.end(),
+                        std::back_inserter(expectedIntersection));
+  DocList expectedUnion;
+  std::set_union(docIds1.begin(), docIds1.end(), docIds2.begin(),
+                 docIds2.end(), std::back_inserter(expectedUnion));
+
+  // With duplicates in the list, each doc id is in the result once.
+  DocList list;
+  for (size_t i = 0; i < docIds2.size(); i++)
+  {
+    list.push_back(docIds2[i]);
+    if (i % 7 == 0) list.push_back(docIds2[i]);
+  }
+  DocList docIds;
+  vector<uint32_t> ranks;
+  bitmap1.intersect(list, &docIds, &ranks);
+  ASSERT_EQ(expectedIntersection.asString(), docIds.asString());
+  ASSERT_EQ(docIds.size(), ranks.size());
+  for (size_t i = 0; i < docIds.size(); i++)
+    ASSERT_EQ(docIds[i], docIds1[ranks[i]]);
+
+  DocIdBitmap result;
+  DocIdBitmap::intersect(bitmap1, bitmap2, &result);
+  docIds.clear();
+  result.getDocIds(&docIds);
+  ASSERT_EQ(expectedIntersection.asString(), docIds.asString());
+  ASSERT_EQ(expectedIntersection.size(),
+            DocIdBitmap::intersectionCount(bitmap1, bitmap2));
+  DocIdBitmap::unite(bitmap1, bitmap2, &result);
+  ASSERT_EQ(expectedUnion.size(), result.count());
+  docIds.clear();
+  result.getDocIds(&docIds);
+  ASSERT_EQ(expectedUnion.asString(), docIds.asString());
+  ASSERT_EQ(expectedUnion.size() - 1, result.rank((1 << 20) + 5));
+}
+
+// Write and read back, and reading something invalid.
+TEST(DocIdBitmapTest, writeAndRead)
+{
+  DocIdBitmap bitmap;
+  bitmap.build(makeDocIds());
+  vector<char> bytes(3, 'x');
+  bitmap.write(&bytes);
+  ASSERT_EQ(3 + bitmap.getSizeInBytes(), bytes.size());
+  ASSERT_EQ(0u, bitmap.getSizeInBytes() % 8);
+  DocIdBitmap read;
+  read.read(&bytes[3], bytes.size() - 3);
+  DocList docIds;
+  read.getDocIds(&docIds);
+  ASSERT_EQ(makeDocIds().asString(), docIds.asString());
+  ASSERT_EQ(bitmap.count() - 1, read.rank((1 << 20) + 5));
+
+  ASSERT_THROW(read.read(&bytes[3], 4), Exception);
+  ASSERT_THROW(read.read(&bytes[3], bytes.size() - 11), Exception);
+  bytes[3 + 8 + 4] = 0;
+  ASSERT_THROW(read.read(&bytes[3], bytes.size() - 3), Exception);
+}
+
+// Dense lists: one posting per doc, and at least one in 16 doc ids.
+TEST(DocIdBitmapTest, isDense)
+{
+  DocList docIds;
+  ASSERT_FALSE(DocIdBitmap::isDense(docIds));
+  docIds.push_back(15);
+  ASSERT_TRUE(DocIdBitmap::isDense(docIds));
+  docIds.push_back(32);
+  ASSERT_FALSE(DocIdBitmap::isDense(docIds));
+  docIds[1] = 31;
+  ASSERT_TRUE(DocIdBitmap::isDense(docIds));
+  docIds[1] = 15;
+  ASSERT_FALSE(DocIdBitmap::isDense(docIds));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
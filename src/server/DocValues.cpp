@@ -0,0 +1,180 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/DocValues.h"
+#include "server/Exception.h"
+#include <string.h>
+
+// Pointer to global DocValues object.
+DocValues* globalDocValues = NULL;
+
+const uint32_t DocValues::NO_VALUE;
+
+namespace
+{
+const char DOC_VALUES_MAGIC[8] = { 'C', 'S', 'D', 'O', 'C', 'V', 'A', 'L' };
+const uint32_t DOC_VALUES_VERSION = 1;
+
+// Number of bits needed to represent the given number.
+uint32_t nofBits(uint64_t x)
+{
+  uint32_t bits = 1;
+  while (bits < 64 && (x >> bits) > 0) bits++;
+  return bits;
+}
+}
+
+// _____________________________________________________________________________
+DocValues::DocValues() : _nofDocs(0)
+{
+}
+
+// _____________________________________________________________________________
+void DocValues::write(const string& fileName, const vector<string>& fieldNames,
+                      const vector<vector<uint32_t> >& values)
+{
+  CS_ASSERT_EQ(fieldNames.size(), values.size());
+  uint64_t nofDocs = 0;
+  for (size_t i = 0; i < values.size(); i++)
+    if (values[i].size() > nofDocs) nofDocs = values[i].size();
+
+  // Compute min and number of bits of each column, and the size of the header
+  // (which gives the offset of the first column).
+  size_t nofFields = fieldNames.size();
+  vector<uint32_t> mins(nofFields);
+  vector<uint32_t> bits(nofFields);
+  vector<uint64_t> nofWords(nofFields);
+  uint64_t offset = sizeof(DOC_VALUES_MAGIC) + 2 * sizeof(uint32_t)
+                    + sizeof(uint64_t);
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    uint32_t min = NO_VALUE;
+    uint32_t max = 0;
+    for (size_t j = 0; j < values[i].size(); j++)
+    {
+      uint32_t value = values[i][j];
+      if (value == NO_VALUE) continue;
+      if (value < min) min = value;
+      if (value > max) max = value;
+    }
+    if (min > max) min = max = 0;
+    mins[i] = min;
+    bits[i] = nofBits(uint64_t(max) - min + 1);
+    // One extra word, so that reading two words never goes beyond the column.
+    nofWords[i] = (nofDocs * bits[i] + 63) / 64 + 1;
+    offset += sizeof(uint32_t) + fieldNames[i].size() + 2 * sizeof(uint32_t)
+              + 2 * sizeof(uint64_t);
+  }
+  offset = (offset + 7) & ~uint64_t(7);
+
+  FILE* file = fopen(fileName.c_str(), "w");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName
+             << "\" for writing");
+  uint32_t nofFields32 = nofFields;
+  writeOrThrow(file, DOC_VALUES_MAGIC, sizeof(DOC_VALUES_MAGIC), fileName);
+  writeOrThrow(file, &DOC_VALUES_VERSION, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofFields32, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofDocs, sizeof(uint64_t), fileName);
+  uint64_t headerSize = offset;
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    uint32_t nameLength = fieldNames[i].size();
+    writeOrThrow(file, &nameLength, sizeof(uint32_t), fileName);
+    writeOrThrow(file, fieldNames[i].data(), nameLength, fileName);
+    writeOrThrow(file, &mins[i], sizeof(uint32_t), fileName);
+    writeOrThrow(file, &bits[i], sizeof(uint32_t), fileName);
+    writeOrThrow(file, &offset, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &nofWords[i], sizeof(uint64_t), fileName);
+    offset += nofWords[i] * sizeof(uint64_t);
+  }
+  // Pad the header to 8 bytes.
+  uint64_t written = ftell(file);
+  const char zeros[8] = { 0 };
+  writeOrThrow(file, zeros, headerSize - written, fileName);
+
+  // Bit-pack each column.
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    vector<uint64_t> data(nofWords[i], 0);
+    for (uint64_t docId = 0; docId < values[i].size(); docId++)
+    {
+      uint32_t value = values[i][docId];
+      if (value == NO_VALUE) continue;
+      uint64_t code = uint64_t(value) - mins[i] + 1;
+      uint64_t bitPos = docId * bits[i];
+      unsigned int shift = bitPos & 63;
+      data[bitPos >> 6] |= code << shift;
+      if (shift + bits[i] > 64) data[(bitPos >> 6) + 1] |= code >> (64 - shift);
+    }
+    writeOrThrow(file, &data[0], data.size() * sizeof(uint64_t), fileName);
+  }
+  fclose(file);
+}
+
+// _____________________________________________________________________________
+void DocValues::open(const string& fileName)
+{
+  _file.open(fileName, "doc values file");
+  const char* mapped = _file.data();
+  size_t size = _file.size();
+  _fields.clear();
+
+  // Parse the header.
+  const char* p = static_cast<const char*>(mapped);
+  const char* end = p + size;
+  uint32_t version;
+  uint32_t nofFields;
+  if (size < sizeof(DOC_VALUES_MAGIC) + 2 * sizeof(uint32_t) + sizeof(uint64_t)
+      || memcmp(p, DOC_VALUES_MAGIC, sizeof(DOC_VALUES_MAGIC)) != 0)
+    CS_THROW(Exception::OTHER, "\"" << fileName << "\" is not a doc values file");
+  p += sizeof(DOC_VALUES_MAGIC);
+  memcpy(&version, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&nofFields, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&_nofDocs, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+  if (version != DOC_VALUES_VERSION)
+    CS_THROW(Exception::OTHER, "doc values file \"" << fileName
+             << "\" has version " << version << ", expected "
+             << DOC_VALUES_VERSION);
+  for (uint32_t i = 0; i < nofFields; i++)
+  {
+    Field field;
+    uint32_t nameLength;
+    uint64_t offset;
+    uint64_t nofWords;
+    if (p + sizeof(uint32_t) > end) break;
+    memcpy(&nameLength, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    if (p + nameLength + 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) > end)
+      break;
+    field.name.assign(p, nameLength); p += nameLength;
+    memcpy(&field.min, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    memcpy(&field.bits, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    memcpy(&offset, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&nofWords, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    if (field.bits == 0 || field.bits > 32 || offset % 8 != 0
+        || offset + nofWords * sizeof(uint64_t) > size
+        || nofWords < (_nofDocs * field.bits + 63) / 64 + 1)
+      break;
+    field.mask = (uint64_t(1) << field.bits) - 1;
+    field.data = reinterpret_cast<const uint64_t*>(
+        static_cast<const char*>(mapped) + offset);
+    _fields.push_back(field);
+  }
+  if (_fields.size() != nofFields)
+    CS_THROW(Exception::OTHER, "doc values file \"" << fileName
+             << "\" is truncated or corrupt");
+}
+
+// _____________________________________________________________________________
+int DocValues::getFieldId(const string& fieldName) const
+{
+  for (size_t i = 0; i < _fields.size(); i++)
+    if (_fields[i].name == fieldName) return i;
+  return -1;
+}
+
+// _____________________________________________________________________________
+const string& DocValues::getFieldName(int fieldId) const
+{
+  return _fields[fieldId].name;
+}
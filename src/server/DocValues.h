@@ -0,0 +1,125 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_DOCVALUES_H_
+#define SERVER_DOCVALUES_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "server/MappedFile.h"
+
+using std::string;
+using std::vector;
+
+// Columnar store of numeric per-document attributes ("doc values"), like the
+// year or the price of a document. There is one column per field, with one
+// unsigned 32-bit value per doc id, or no value.
+//
+// The file <basename>.docvalues is written by the CSV parser (option
+// --doc-values) and mmap'ed by the server (option --read-doc-values). Each
+// column is bit-packed: the value v of a document is stored as v - min + 1
+// with just as many bits as needed for max - min + 1, where min and max are
+// the smallest and largest value of the column; code 0 means "no value".
+// Looking up the value of a document hence is a random access to at most two
+// 64-bit words, instead of decoding the postings of all the words of a field.
+//
+// File format (all numbers in host byte order):
+//   "CSDOCVAL" <uint32 version> <uint32 nofFields> <uint64 nofDocs>
+//   per field: <uint32 nameLength> <name> <uint32 min> <uint32 bits>
+//              <uint64 offset of data> <uint64 number of 64-bit data words>
+//   per field: the data, aligned to 8 bytes.
+class DocValues
+{
+ public:
+  // The value returned for documents without a value.
+  static const uint32_t NO_VALUE = UINT32_MAX;
+
+  DocValues();
+
+  // Write the given columns to the given file. values[i][docId] is the value
+  // of document docId for field i (NO_VALUE if it has none); the columns may
+  // have different lengths.
+  static void write(const string& fileName, const vector<string>& fieldNames,
+                    const vector<vector<uint32_t> >& values);
+
+  // Map the given file into memory. Throws an exception if the file does not
+  // exist or has the wrong format.
+  void open(const string& fileName);
+
+  // The number of fields.
+  size_t getNofFields() const { return _fields.size(); }
+
+  // The id of the field with the given name, or -1 if there is no such field.
+  int getFieldId(const string& fieldName) const;
+
+  // The name of the field with the given id.
+  const string& getFieldName(int fieldId) const;
+
+  // The value of the given document for the given field, or NO_VALUE. This is
+  // implemented below, so that we can inline this function.
+  inline uint32_t getValue(int fieldId, uint32_t docId) const;
+
+  // Whether the value of the given document for the given field is in [low,
+  // high]. Documents without a value are never in the range. This is
+  // implemented below, so that we can inline this function.
+  inline bool isInRange(int fieldId, uint32_t docId,
+                        uint32_t low, uint32_t high) const;
+
+ private:
+  struct Field
+  {
+    string name;
+    uint32_t min;
+    uint32_t bits;
+    uint64_t mask;
+    const uint64_t* data;
+  };
+
+  // The code (value - min + 1, or 0 for no value) of the given document. The
+  // last data word of each column is padding, so that we can always read two
+  // words without a branch. Note that shifting by 64 is undefined, hence the
+  // second word is shifted in two steps.
+  uint64_t getCode(const Field& field, uint32_t docId) const
+  {
+    if (docId >= _nofDocs) return 0;
+    uint64_t bitPos = static_cast<uint64_t>(docId) * field.bits;
+    const uint64_t* word = field.data + (bitPos >> 6);
+    unsigned int shift = bitPos & 63;
+    return ((word[0] >> shift) | ((word[1] << 1) << (63 - shift)))
+           & field.mask;
+  }
+
+  vector<Field> _fields;
+  uint64_t _nofDocs;
+
+  // The mmap'ed file.
+  MappedFile _file;
+};
+
+// _____________________________________________________________________________
+uint32_t DocValues::getValue(int fieldId, uint32_t docId) const
+{
+  const Field& field = _fields[fieldId];
+  uint64_t code = getCode(field, docId);
+  return code == 0 ? NO_VALUE : static_cast<uint32_t>(field.min + code - 1);
+}
+
+// _____________________________________________________________________________
+bool DocValues::isInRange(int fieldId, uint32_t docId,
+                          uint32_t low, uint32_t high) const
+{
+  const Field& field = _fields[fieldId];
+  // Compare in the code domain with one unsigned comparison: code 0 (no value)
+  // and codes below the range wrap around to huge numbers.
+  uint64_t lowCode = low <= field.min ? 1 : uint64_t(low) - field.min + 1;
+  uint64_t highCode = high < field.min ? 0 : uint64_t(high) - field.min + 1;
+  if (highCode < lowCode) return false;
+  return getCode(field, docId) - lowCode <= highCode - lowCode;
+}
+
+// Whoever includes this should be able to use the global DocValues object
+// declared in the .cpp file (NULL if no doc values were read).
+extern DocValues* globalDocValues;
+
+#endif  // SERVER_DOCVALUES_H_
@@ -0,0 +1,85 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "server/DocValues.h"
+#include "server/Exception.h"
+
+// Write two columns, one of them spanning word boundaries, and read them back.
+TEST(DocValuesTest, writeAndOpen)
+{
+  string fileName = "DocValuesTest.TMP.docvalues";
+  vector<string> fieldNames;
+  fieldNames.push_back("year");
+  fieldNames.push_back("price");
+  vector<vector<uint32_t> > values(2);
+  for (uint32_t docId = 0; docId < 1000; docId++)
+    values[0].push_back(docId % 7 == 0 ? DocValues::NO_VALUE
+                                       : 1950 + docId % 70);
+  values[1].push_back(DocValues::NO_VALUE);
+  values[1].push_back(123456789);
+  values[1].push_back(5);
+  DocValues::write(fileName, fieldNames, values);
+
+  DocValues docValues;
+  docValues.open(fileName);
+  ASSERT_EQ(2u, docValues.getNofFields());
+  ASSERT_EQ(0, docValues.getFieldId("year"));
+  ASSERT_EQ(1, docValues.getFieldId("price"));
+  ASSERT_EQ(-1, docValues.getFieldId("title"));
+  ASSERT_EQ("price", docValues.getFieldName(1));
+  for (uint32_t docId = 0; docId < 1000; docId++)
+    ASSERT_EQ(values[0][docId], docValues.getValue(0, docId)) << docId;
+  ASSERT_EQ(DocValues::NO_VALUE, docValues.getValue(0, 1000));
+  ASSERT_EQ(DocValues::NO_VALUE, docValues.getValue(1, 0));
+  ASSERT_EQ(123456789u, docValues.getValue(1, 1));
+  ASSERT_EQ(5u, docValues.getValue(1, 2));
+  // The shorter column has no values for the remaining documents.
+  ASSERT_EQ(DocValues::NO_VALUE, docValues.getValue(1, 3));
+  ASSERT_EQ(DocValues::NO_VALUE, docValues.getValue(1, 999));
+}
+
+// Range checks, including documents without a value and ranges outside of the
+// values of a column.
+TEST(DocValuesTest, isInRange)
+{
+  string fileName = "DocValuesTest.TMP.docvalues";
+  vector<string> fieldNames(1, "year");
+  vector<vector<uint32_t> > values(1);
+  values[0].push_back(DocValues::NO_VALUE);
+  values[0].push_back(1997);
+  values[0].push_back(2004);
+  values[0].push_back(2010);
+  DocValues::write(fileName, fieldNames, values);
+  DocValues docValues;
+  docValues.open(fileName);
+  ASSERT_FALSE(docValues.isInRange(0, 0, 0, DocValues::NO_VALUE));
+  ASSERT_TRUE(docValues.isInRange(0, 1, 1997, 2004));
+  ASSERT_TRUE(docValues.isInRange(0, 2, 1997, 2004));
+  ASSERT_FALSE(docValues.isInRange(0, 3, 1997, 2004));
+  ASSERT_TRUE(docValues.isInRange(0, 3, 2005, DocValues::NO_VALUE));
+  ASSERT_TRUE(docValues.isInRange(0, 1, 0, 1997));
+  ASSERT_FALSE(docValues.isInRange(0, 1, 0, 1996));
+  ASSERT_FALSE(docValues.isInRange(0, 1, 2011, 3000));
+  ASSERT_FALSE(docValues.isInRange(0, 2, 2004, 1997));
+  ASSERT_FALSE(docValues.isInRange(0, 4, 0, DocValues::NO_VALUE));
+}
+
+// Opening a file that is not a doc values file fails.
+TEST(DocValuesTest, openInvalidFile)
+{
+  string fileName = "DocValuesTest.TMP.docvalues";
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "this is not a doc values file\n");
+  fclose(file);
+  DocValues docValues;
+  ASSERT_THROW(docValues.open(fileName), Exception);
+  ASSERT_THROW(docValues.open("DocValuesTest.TMP.nonexisting"), Exception);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,7 @@
 #include "DocsDB.h"
 #include <zlib.h>
+#include <algorithm>
+#include <map>
 
 #define MY_MIN(a,b) ( (a) < (b) ? (a) : (b) )
 #define MY_MAX(a,b) ( (a) < (b) ? (b) : (a) )
@@ -8,6 +10,159 @@
 unsigned int MAX_IN_DOC_SIZE = 10*1000*1000;
 // according to zlib, compressed document can be 0.1% large + 12 bytes
 unsigned int MAX_OUT_DOC_SIZE = MAX_IN_DOC_SIZE + MAX_IN_DOC_SIZE/1000 + 13;
+
+// first byte of the record of a document stored in blocks (a zlib stream never
+// starts with 0 or 1, since the lower four bits of its first byte are 8, see
+// the NOTE in build below)
+const char BLOCKED_RECORD = 1;
+
+namespace
+{
+// append the bytes of x to the given string
+template <class T> void appendBytes(string* s, const T& x)
+{
+  s->append(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+// compress the given bytes like a whole document in build (a 0-byte followed by
+// the bytes for level -1), exit on error
+void compressBytes(const string& in, int compressionLevel, unsigned int minSize,
+                   string* out)
+{
+  if (compressionLevel == -1)
+  {
+    out->assign(1, 0);
+    out->append(in);
+    return;
+  }
+  uLongf out_len = compressBound(in.size());
+  out->resize(out_len);
+  int ret = compress2((Bytef*)(&(*out)[0]), &out_len,
+                      (const Bytef*)(in.data()), in.size(),
+                      in.size() >= minSize ? compressionLevel : 0);
+  if (ret != Z_OK)
+  {
+    cerr << endl << endl << "ERROR compressing block (zlib error code "
+         << ret << ")" << endl << endl;
+    exit(1);
+  }
+  out->resize(out_len);
+}
+
+static_assert(sizeof(DocumentWord) == 12, "DocumentWord must have 12 bytes");
+
+bool wordOffsetLess(const DocumentWord& x, const DocumentWord& y)
+{
+  return x.offset < y.offset;
+}
+
+// build the record of a document with word positions, that is, of a line
+//
+//   <doc id> TAB u:<url> TAB t:<title> TAB p:<words> TAB H:<text>
+//
+// where <words> is a comma-separated list of <position>:<offset>:<length>, the
+// offsets and lengths being in bytes of the text; returns false for a line
+// without the p: field
+//
+//   the record is: the byte BLOCKED_RECORD; the length of the line up to the
+//   text without the p: field, and that part of the line; the length of the
+//   text, the block size, and the number of blocks (each as 32 bits); for each
+//   block the smallest position of a word starting in it or later; for each
+//   block the end of its compressed bytes, relative to the first block; the
+//   blocks, each being its uncompressed size (32 bits) followed by the
+//   compressed: number of words starting in the block (32 bits), these words
+//   (see DocumentWord) sorted by offset, and the text of the block
+//
+bool buildBlockedRecord(const char* line, int compressionLevel,
+                        unsigned int minSize, unsigned int blockSize,
+                        string* record)
+{
+  const char* p = line;
+  for (int nofTabs = 0; *p != 0 && nofTabs < 3; ++p)
+    if (*p == '\t') ++nofTabs;
+  if (p[0] != 'p' || p[1] != ':') return false;
+  string head(line, p - line);
+  head += "H:";
+
+  // parse the words
+  vector<DocumentWord> words;
+  p += 2;
+  while (*p != '\t' && *p != 0)
+  {
+    DocumentWord word;
+    char* end;
+    word.position = strtoul(p, &end, 10);
+    if (*end == ':') word.offset = strtoul(end + 1, &end, 10);
+    if (*end == ':') word.length = strtoul(end + 1, &end, 10);
+    if (end == p || (*end != ',' && *end != '\t'))
+    {
+      cerr << "ERROR: p: field has wrong format (doc " << atoi(line) << ")"
+           << endl << endl;
+      exit(1);
+    }
+    words.push_back(word);
+    p = *end == ',' ? end + 1 : end;
+  }
+  if (p[0] != '\t' || p[1] != 'H' || p[2] != ':')
+  {
+    cerr << "ERROR: no text after p: field (doc " << atoi(line) << ")"
+         << endl << endl;
+    exit(1);
+  }
+  p += 3;
+  size_t textLength = strlen(p);
+  if (textLength > 0 && p[textLength - 1] == '\n') --textLength;
+
+  // distribute the words to the blocks (words beyond the text are ignored)
+  size_t nofBlocks = (textLength + blockSize - 1) / blockSize;
+  vector<vector<DocumentWord> > blockWords(nofBlocks);
+  for (size_t i = 0; i < words.size(); ++i)
+    if (words[i].offset + words[i].length <= textLength)
+      blockWords[words[i].offset / blockSize].push_back(words[i]);
+  vector<Position> firstPositions(nofBlocks, UINT_MAX);
+  for (size_t b = nofBlocks; b > 0; --b)
+  {
+    vector<DocumentWord>& w = blockWords[b - 1];
+    std::sort(w.begin(), w.end(), wordOffsetLess);
+    if (b < nofBlocks) firstPositions[b - 1] = firstPositions[b];
+    for (size_t i = 0; i < w.size(); ++i)
+      firstPositions[b - 1] = MY_MIN(firstPositions[b - 1], w[i].position);
+  }
+
+  // compress the blocks
+  string blocks;
+  vector<uint32_t> blockEnds;
+  string block;
+  string compressedBlock;
+  for (size_t b = 0; b < nofBlocks; ++b)
+  {
+    block.clear();
+    appendBytes(&block, static_cast<uint32_t>(blockWords[b].size()));
+    if (!blockWords[b].empty())
+      block.append(reinterpret_cast<const char*>(&blockWords[b][0]),
+                   blockWords[b].size() * sizeof(DocumentWord));
+    block.append(p + b * blockSize,
+                 MY_MIN(textLength - b * blockSize, (size_t)blockSize));
+    compressBytes(block, compressionLevel, minSize, &compressedBlock);
+    appendBytes(&blocks, static_cast<uint32_t>(block.size()));
+    blocks += compressedBlock;
+    blockEnds.push_back(blocks.size());
+  }
+
+  record->assign(1, BLOCKED_RECORD);
+  appendBytes(record, static_cast<uint32_t>(head.size()));
+  *record += head;
+  appendBytes(record, static_cast<uint32_t>(textLength));
+  appendBytes(record, static_cast<uint32_t>(blockSize));
+  appendBytes(record, static_cast<uint32_t>(nofBlocks));
+  for (size_t b = 0; b < nofBlocks; ++b)
+    appendBytes(record, firstPositions[b]);
+  for (size_t b = 0; b < nofBlocks; ++b)
+    appendBytes(record, blockEnds[b]);
+  *record += blocks;
+  return true;
+}
+}
                     
 
 
@@ -66,6 +221,16 @@ DocsDB::DocsDB(string dbFileName)
   }
   }
 
+  // CHECK FOR WORD POSITIONS (see hasWordPositions)
+  _hasWordPositions = false;
+  for (unsigned int i = 0; i < _nofDocs && i < 10 && !_hasWordPositions; ++i)
+  {
+    if (_offsets[i + 1] <= _offsets[i]) continue;
+    char marker;
+    readBytes(_offsets[i], 1, &marker);
+    _hasWordPositions = marker == BLOCKED_RECORD;
+  }
+
 } // end construct from <db>.docs.db
 
 
@@ -84,18 +249,8 @@ void DocsDB::getDocument(const DocId docId, Document& document) const
   char* out_buf = new char[MAX_OUT_DOC_SIZE + 1]; // dito
 
   // BINARY SEARCH OF DOC ID
-  unsigned int l = 0;
-  assert(_docIds.size() > 0);
-  unsigned int r = _docIds.size() - 1;
-  // maintain invariant: docIds[l] <= docId <= docIds[r]
-  while (l < r)
-  {
-  unsigned int m = (l + r)/2;
-  if (docId <= _docIds[m]) r = m; else l = m + 1;
-  }
-  assert(l == r);
-  unsigned int i = l;
-  if (_docIds[i] != docId)
+  unsigned int i;
+  if (!findDocument(docId, &i))
   {
   ostringstream os;
   os << "document with id " << docId << " not found";
@@ -103,6 +258,37 @@ void DocsDB::getDocument(const DocId docId, Document& document) const
   return;
   }
 
+  // CASE: stored in blocks (see build), uncompress all of them
+  try
+  {
+    BlockedRecord record;
+    if (readBlockedRecord(i, &record))
+    {
+      delete[] in_buf;
+      delete[] out_buf;
+      string line = record.head;
+      vector<DocumentWord> words;
+      string text;
+      for (size_t b = 0; b + 1 < record.blockOffsets.size(); ++b)
+      {
+        readBlock(record, b, &words, &text);
+        line += text;
+      }
+      document.set(line.c_str());
+      return;
+    }
+  }
+  catch (Exception& e)
+  {
+    document.setIfError(e.getFullErrorMessage());
+    return;
+  }
+  catch (DocumentException e)
+  {
+    document.setIfError(e.getMessage());
+    return;
+  }
+
   // READ COMPRESSED LINE AND UNCOMPRESS
   off_t out_len = _offsets[i+1] - _offsets[i];
   uLongf in_len = MAX_IN_DOC_SIZE;
@@ -176,14 +362,306 @@ void DocsDB::getDocument(const DocId docId, Document& document) const
 
 
 
+//! INDEX OF DOCUMENT WITH GIVEN ID
+bool DocsDB::findDocument(DocId docId, unsigned int* i) const
+{
+  if (_docIds.size() == 0) return false;
+  unsigned int l = 0;
+  unsigned int r = _docIds.size() - 1;
+  // maintain invariant: docIds[l] <= docId <= docIds[r]
+  while (l < r)
+  {
+  unsigned int m = (l + r)/2;
+  if (docId <= _docIds[m]) r = m; else l = m + 1;
+  }
+  *i = l;
+  return _docIds[l] == docId;
+}
+
+
+
+//! READ THE GIVEN BYTES FROM THE FILE
+void DocsDB::readBytes(off_t offset, size_t nofBytes, char* buffer) const
+{
+  fseeko(_file, offset, SEEK_SET);
+  size_t numItemsRead = fread(buffer, 1, nofBytes, _file);
+  CS_ASSERT_EQ(nofBytes, numItemsRead);
+}
+
+
+
+//! READ HEADER OF I-TH DOCUMENT
+bool DocsDB::readBlockedRecord(unsigned int i, BlockedRecord* record) const
+{
+  off_t offset = _offsets[i];
+  if (_offsets[i + 1] <= offset) return false;
+  char marker;
+  readBytes(offset, 1, &marker);
+  if (marker != BLOCKED_RECORD) return false;
+  offset += 1;
+  uint32_t headLength;
+  readBytes(offset, sizeof(headLength), reinterpret_cast<char*>(&headLength));
+  offset += sizeof(headLength);
+  CS_ASSERT_LE(offset + headLength, _offsets[i + 1]);
+  record->head.resize(headLength);
+  if (headLength > 0) readBytes(offset, headLength, &record->head[0]);
+  offset += headLength;
+  uint32_t sizes[3];
+  readBytes(offset, sizeof(sizes), reinterpret_cast<char*>(sizes));
+  offset += sizeof(sizes);
+  record->textLength = sizes[0];
+  record->blockSize = sizes[1];
+  size_t nofBlocks = sizes[2];
+  CS_ASSERT_LE(offset + static_cast<off_t>(8 * nofBlocks), _offsets[i + 1]);
+  record->firstPositions.resize(nofBlocks);
+  vector<uint32_t> blockEnds(nofBlocks);
+  if (nofBlocks > 0)
+  {
+    readBytes(offset, nofBlocks * sizeof(Position),
+              reinterpret_cast<char*>(&record->firstPositions[0]));
+    offset += nofBlocks * sizeof(Position);
+    readBytes(offset, nofBlocks * sizeof(uint32_t),
+              reinterpret_cast<char*>(&blockEnds[0]));
+    offset += nofBlocks * sizeof(uint32_t);
+  }
+  record->blockOffsets.resize(nofBlocks + 1);
+  record->blockOffsets[0] = offset;
+  for (size_t b = 0; b < nofBlocks; ++b)
+    record->blockOffsets[b + 1] = offset + blockEnds[b];
+  CS_ASSERT_EQ(record->blockOffsets.back(), _offsets[i + 1]);
+  return true;
+}
+
+
+
+//! READ AND UNCOMPRESS BLOCK OF DOCUMENT
+void DocsDB::readBlock(const BlockedRecord& record, size_t block,
+                       vector<DocumentWord>* words, string* text) const
+{
+  size_t nofBytes = record.blockOffsets[block + 1] - record.blockOffsets[block];
+  CS_ASSERT_LE(sizeof(uint32_t) + 1, nofBytes);
+  vector<char> bytes(nofBytes);
+  readBytes(record.blockOffsets[block], nofBytes, &bytes[0]);
+  uint32_t uncompressedLength;
+  memcpy(&uncompressedLength, &bytes[0], sizeof(uncompressedLength));
+  const char* data = &bytes[sizeof(uncompressedLength)];
+  size_t dataLength = nofBytes - sizeof(uncompressedLength);
+  string uncompressed(uncompressedLength, 0);
+  // CASE: not compressed with zlib (see build)
+  if (*data == 0)
+  {
+    CS_ASSERT_EQ(dataLength - 1, uncompressed.size());
+    uncompressed.assign(data + 1, dataLength - 1);
+  }
+  else
+  {
+    uLongf in_len = uncompressedLength;
+    int ret = uncompress((Bytef*)(&uncompressed[0]), &in_len,
+                         (const Bytef*)(data), dataLength);
+    if (ret != Z_OK || in_len != uncompressedLength)
+      CS_THROW(Exception::UNCOMPRESS_ERROR, "block " << block
+               << " of document, zlib error code " << ret);
+  }
+  uint32_t nofWords;
+  CS_ASSERT_LE(sizeof(nofWords), uncompressed.size());
+  memcpy(&nofWords, &uncompressed[0], sizeof(nofWords));
+  size_t textOffset = sizeof(nofWords) + nofWords * sizeof(DocumentWord);
+  CS_ASSERT_LE(textOffset, uncompressed.size());
+  words->resize(nofWords);
+  if (nofWords > 0)
+    memcpy(&(*words)[0], &uncompressed[sizeof(nofWords)],
+           nofWords * sizeof(DocumentWord));
+  text->assign(uncompressed, textOffset, string::npos);
+}
+
+
+
+//! THE BLOCKS OF A DOCUMENT READ SO FAR
+//
+//    a word is given by its block and its index in the words of the block
+//
+class DocsDB::BlockCache
+{
+ public:
+  typedef pair<size_t, size_t> WordHandle;
+
+  BlockCache(const DocsDB& docsDB, const BlockedRecord& record)
+    : _docsDB(docsDB), _record(record) { }
+
+  //! words and text of the given block (read when first needed)
+  const vector<DocumentWord>& words(size_t block) { return get(block).first; }
+  const string& text(size_t block) { return get(block).second; }
+
+  //! the given word
+  const DocumentWord& word(const WordHandle& w) { return words(w.first)[w.second]; }
+
+  //! move to the previous / next word of the text, false if there is none
+  bool previous(WordHandle* w)
+  {
+    if (w->second > 0) { --w->second; return true; }
+    for (size_t b = w->first; b > 0; --b)
+    {
+      if (words(b - 1).empty()) continue;
+      *w = WordHandle(b - 1, words(b - 1).size() - 1);
+      return true;
+    }
+    return false;
+  }
+  bool next(WordHandle* w)
+  {
+    if (w->second + 1 < words(w->first).size()) { ++w->second; return true; }
+    for (size_t b = w->first + 1; b + 1 < _record.blockOffsets.size(); ++b)
+    {
+      if (words(b).empty()) continue;
+      *w = WordHandle(b, 0);
+      return true;
+    }
+    return false;
+  }
+
+  //! the character at the given offset of the text
+  char charAt(size_t offset)
+  {
+    return text(offset / _record.blockSize)[offset % _record.blockSize];
+  }
+
+  //! append the text from offset from to offset to
+  void appendText(size_t from, size_t to, string* s)
+  {
+    while (from < to)
+    {
+      size_t b = from / _record.blockSize;
+      size_t blockStart = b * _record.blockSize;
+      const string& t = text(b);
+      size_t end = MY_MIN(to, blockStart + t.size());
+      CS_ASSERT_LT(from, end);
+      s->append(t, from - blockStart, end - from);
+      from = end;
+    }
+  }
+
+ private:
+  const pair<vector<DocumentWord>, string>& get(size_t block)
+  {
+    std::map<size_t, pair<vector<DocumentWord>, string> >::iterator it
+      = _blocks.find(block);
+    if (it == _blocks.end())
+    {
+      it = _blocks.insert(std::make_pair(block,
+            pair<vector<DocumentWord>, string>())).first;
+      _docsDB.readBlock(_record, block, &it->second.first, &it->second.second);
+    }
+    return it->second;
+  }
+
+  const DocsDB& _docsDB;
+  const BlockedRecord& _record;
+  std::map<size_t, pair<vector<DocumentWord>, string> > _blocks;
+};
+
+
+
+//! GET PARTS OF DOCUMENT AROUND THE WORDS AT THE GIVEN POSITIONS
+bool DocsDB::getDocumentParts(const DocId docId,
+                              const vector<Position>& positions,
+                              unsigned int radius, size_t maxNofWords,
+                              Document& document, vector<DocumentPart>& parts,
+                              bool& moreWords) const
+{
+  typedef BlockCache::WordHandle WordHandle;
+  parts.clear();
+  moreWords = false;
+  try
+  {
+    unsigned int i;
+    BlockedRecord record;
+    if (!findDocument(docId, &i) || !readBlockedRecord(i, &record))
+      return false;
+    document.set(record.head.c_str());
+    BlockCache blocks(*this, record);
+
+    // the windows around the words at the positions, in the order of the
+    // text, overlapping ones united to one part
+    vector<pair<WordHandle, WordHandle> > windows;
+    size_t nofWords = 0;
+    for (size_t k = 0; k < positions.size(); ++k)
+    {
+      if (k > 0 && positions[k] == positions[k - 1]) continue;
+      // the block with the word (if any), see BlockedRecord::firstPositions
+      size_t b = std::upper_bound(record.firstPositions.begin(),
+                                  record.firstPositions.end(), positions[k])
+                 - record.firstPositions.begin();
+      if (b == 0) continue;
+      const vector<DocumentWord>& words = blocks.words(b - 1);
+      size_t j = 0;
+      while (j < words.size() && words[j].position != positions[k]) ++j;
+      if (j == words.size()) continue;
+      if (nofWords == maxNofWords) { moreWords = true; break; }
+      ++nofWords;
+      WordHandle start(b - 1, j);
+      WordHandle end(b - 1, j);
+      for (unsigned int r = 0; r < radius && blocks.previous(&start); ++r) { }
+      for (unsigned int r = 0; r < radius && blocks.next(&end); ++r) { }
+      if (!windows.empty() && blocks.word(start).offset
+                              <= blocks.word(windows.back().second).offset)
+      {
+        if (blocks.word(end).offset > blocks.word(windows.back().second).offset)
+          windows.back().second = end;
+      }
+      else
+      {
+        windows.push_back(std::make_pair(start, end));
+      }
+    }
+
+    // the text and the words of each part
+    for (size_t k = 0; k < windows.size(); ++k)
+    {
+      const WordHandle& start = windows[k].first;
+      const WordHandle& end = windows[k].second;
+      DocumentPart part;
+      WordHandle w = start;
+      part.isAtStart = !blocks.previous(&w);
+      w = end;
+      part.isAtEnd = !blocks.next(&w);
+      // from the very beginning of the text if the part starts with its first
+      // word, and with the non-space characters after the last word (like
+      // ExcerptsGenerator::generateExcerptsFromIntervals)
+      part.offset = part.isAtStart ? 0 : blocks.word(start).offset;
+      size_t to = blocks.word(end).offset + blocks.word(end).length;
+      while (to < record.textLength && blocks.charAt(to) != ' ') ++to;
+      blocks.appendText(part.offset, to, &part.text);
+      w = start;
+      part.words.push_back(blocks.word(w));
+      while (w != end && blocks.next(&w)) part.words.push_back(blocks.word(w));
+      parts.push_back(part);
+    }
+  }
+  catch (Exception& e)
+  {
+    parts.clear();
+    return false;
+  }
+  catch (DocumentException e)
+  {
+    parts.clear();
+    return false;
+  }
+  return true;
+}
+
+
+
 //! BUILD FROM <db>.docs -> <db>.docs.DB 
 //    level is from 0 (no compression, fast) to 9 (high compression, slow)
 //    NEW: can also specify -1 now, much faster than 0, see below ZZZ
 //    docs with less than minSize bytes are not compressed
+//    docs with word positions are stored in blocks of blockSize bytes of text
 void DocsDB::build(string&      inFileName, 
                    string&      outFileName, 
                    int          compressionLevel, 
-                   unsigned int minSize)
+                   unsigned int minSize,
+                   unsigned int blockSize)
 {
   //const char* ERROR_MSG = "ERROR in DocsDB::build"; 
   Timer timer;
@@ -214,6 +692,7 @@ void DocsDB::build(string&      inFileName,
   cout << "compressing \"" << inFileName << "\" doc by doc " << flush; 
   off_t milestone = 0;
   off_t mile = MY_MAX(1, in_size / 10);
+  string blockedRecord;
   while (true)
   {
     // read next line and remember doc id (exit loop if end of _file)
@@ -228,6 +707,23 @@ void DocsDB::build(string&      inFileName,
     }
     docIds.push_back(docId);
 
+    // documents with word positions are stored in blocks (see
+    // buildBlockedRecord above)
+    if (buildBlockedRecord(in_buf, compressionLevel, minSize, blockSize,
+                           &blockedRecord))
+    {
+      offsets.push_back(ftello(out_file));
+      size_t ret4 = fwrite(blockedRecord.data(), 1, blockedRecord.size(),
+                           out_file);
+      if (ret4 != blockedRecord.size()) { cerr << endl << endl
+                                << "ERROR fwrite blocked document:"
+                                << " (" << ret4 << " != "
+                                << blockedRecord.size() << ")"
+                                << endl << endl; exit(1); }
+      while (ftello(in_file) > milestone) { cout << "." << flush; milestone += mile; }
+      continue;
+    }
+
     uLong in_len = strlen(in_buf);
     uLongf out_len;
 
@@ -13,6 +13,35 @@ class Document;
 //
 //   NOTE: buffers are per getDocument request, so thread-safe in this respect
 //
+//   documents with word positions (field p: in <db>.docs, see the option
+//   --position-offsets of the CsvParser) are stored in blocks of the text,
+//   each compressed separately together with the positions and byte offsets
+//   of the words starting in it; the excerpts around given positions then
+//   need only the few blocks around them (see getDocumentParts)
+//
+
+//! A WORD OF THE TEXT OF A DOCUMENT: its position (as in the index) and its
+//  bytes in the text
+struct DocumentWord
+{
+  Position position;
+  unsigned int offset;
+  unsigned int length;
+};
+
+//! A PART OF THE TEXT OF A DOCUMENT (see DocsDB::getDocumentParts)
+struct DocumentPart
+{
+  //! offset of the part in the text, and the part
+  size_t offset;
+  string text;
+  //! whether the part is at the very beginning / end of the text
+  bool isAtStart;
+  bool isAtEnd;
+  //! the words in the part (offsets relative to the whole text)
+  vector<DocumentWord> words;
+};
+
 class DocsDB
 {
 
@@ -30,6 +59,39 @@ class DocsDB
   //! FILE
   FILE* _file;
 
+  //! WHETHER THE DOCUMENTS ARE STORED WITH WORD POSITIONS (see hasWordPositions)
+  bool _hasWordPositions;
+
+  //! THE HEADER OF A DOCUMENT STORED IN BLOCKS (see build)
+  struct BlockedRecord
+  {
+    //! the line up to the text: <doc id> TAB u:<url> TAB t:<title> TAB H:
+    string head;
+    size_t textLength;
+    size_t blockSize;
+    //! for each block, the smallest position of a word starting in it or in
+    //  one of the following blocks
+    vector<Position> firstPositions;
+    //! for each block, its offset in the file, and the end of the last block
+    vector<off_t> blockOffsets;
+  };
+
+  //! INDEX OF DOCUMENT WITH GIVEN ID (false if there is no such document)
+  bool findDocument(DocId docId, unsigned int* i) const;
+
+  //! READ THE GIVEN BYTES FROM THE FILE
+  void readBytes(off_t offset, size_t nofBytes, char* buffer) const;
+
+  //! READ HEADER OF I-TH DOCUMENT (false if not stored in blocks)
+  bool readBlockedRecord(unsigned int i, BlockedRecord* record) const;
+
+  //! READ AND UNCOMPRESS BLOCK OF DOCUMENT: its words and its text
+  void readBlock(const BlockedRecord& record, size_t block,
+                 vector<DocumentWord>* words, string* text) const;
+
+  //! THE BLOCKS OF A DOCUMENT READ SO FAR (see getDocumentParts)
+  class BlockCache;
+
  public:
 
   //! CONSTRUCT FROM <db>.docs.DB
@@ -38,16 +100,40 @@ class DocsDB
   //! GET DOCUMENT VIA ID
   void getDocument(const DocId docId, Document& document) const;
 
+  //! GET PARTS OF DOCUMENT AROUND THE WORDS AT THE GIVEN POSITIONS
+  //
+  //    only for documents with word positions, returns false for the others;
+  //    the positions must be sorted, positions that are not of a word of the
+  //    text are ignored
+  //
+  //    sets doc id, url, and title of document (not the text), and one part
+  //    for each run of overlapping windows of radius words around the words at
+  //    the first maxNofWords positions; sets moreWords if there are more
+  //
+  bool getDocumentParts(const DocId docId, const vector<Position>& positions,
+                        unsigned int radius, size_t maxNofWords,
+                        Document& document, vector<DocumentPart>& parts,
+                        bool& moreWords) const;
+
   //! GET NUMBER OF DOCUMENTS
   DocId getNofDocs() const { return _nofDocs; }
 
+  //! WHETHER THE DOCUMENTS ARE STORED WITH WORD POSITIONS
+  //
+  //    judged from the first few non-empty documents (the parser writes the
+  //    p: field for all documents or for none), see getDocumentParts
+  //
+  bool hasWordPositions() const { return _hasWordPositions; }
+
   //! BUILD FROM <db>.docs -> <db>.docs.DB 
   //    level is from 0 (no compression, fast) to 9 (high compression, slow)
   //    docs with less than minSize bytes are not compressed
+  //    the text of docs with word positions is stored in blocks of blockSize
   static void build(string&      inFileName, 
                     string&      outFileName, 
 	                int          compressionLevel = 6,
-					unsigned int minSize = 100);
+					unsigned int minSize = 100,
+                    unsigned int blockSize = 16 * 1024);
   
   //! FOR DEBUGGING AND TESTING
   vector<off_t>& getOffsets() { return _offsets; }
@@ -0,0 +1,118 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "server/DocsDB.h"
+
+// A document without and one with word positions (the words of the title
+// have positions 1 and 2, those of the text 3 to 10).
+const char* DOCS =
+  "1\tu:url1\tt:First\tH:the first document\n"
+  "2\tu:url2\tt:Second one\tp:3:0:5,4:6:4,5:11:5,6:17:5,7:23:7,8:31:4,"
+  "9:36:3,10:40:5\tH:alpha beta gamma delta epsilon zeta eta theta\n";
+
+// Write the docs file above and build the docs DB from it.
+void buildDocsDB(int compressionLevel, unsigned int blockSize)
+{
+  FILE* file = fopen("DocsDBTest.docs", "w");
+  fputs(DOCS, file);
+  fclose(file);
+  string docsFileName = "DocsDBTest.docs";
+  string dbFileName = "DocsDBTest.docs.DB";
+  DocsDB::build(docsFileName, dbFileName, compressionLevel, 0, blockSize);
+}
+
+// The texts of the given parts, separated by |.
+string partsAsString(const vector<DocumentPart>& parts)
+{
+  string s;
+  for (size_t i = 0; i < parts.size(); i++)
+    s += (i > 0 ? "|" : "") + parts[i].text;
+  return s;
+}
+
+// Documents with and without word positions, whole.
+TEST(DocsDBTest, getDocument)
+{
+  for (int compressionLevel = -1; compressionLevel <= 6; compressionLevel += 7)
+  {
+    buildDocsDB(compressionLevel, 8);
+    DocsDB docsDB("DocsDBTest.docs.DB");
+    ASSERT_EQ(2u, docsDB.getNofDocs());
+    Document document;
+    docsDB.getDocument(1, document);
+    ASSERT_EQ("First", document.getTitle());
+    ASSERT_EQ("the first document", document.getText());
+    docsDB.getDocument(2, document);
+    ASSERT_EQ(2u, document.getDocId());
+    ASSERT_EQ("url2", document.getUrl());
+    ASSERT_EQ("Second one", document.getTitle());
+    ASSERT_EQ("alpha beta gamma delta epsilon zeta eta theta",
+              document.getText());
+  }
+  remove("DocsDBTest.docs");
+  remove("DocsDBTest.docs.DB");
+}
+
+// Parts around positions, across blocks of 8 bytes.
+TEST(DocsDBTest, getDocumentParts)
+{
+  buildDocsDB(6, 8);
+  DocsDB docsDB("DocsDBTest.docs.DB");
+  Document document;
+  vector<DocumentPart> parts;
+  bool more;
+  ASSERT_FALSE(docsDB.getDocumentParts(1, vector<Position>(1, 3), 1, 10,
+                                       document, parts, more));
+
+  ASSERT_TRUE(docsDB.getDocumentParts(2, vector<Position>(1, 5), 1, 10,
+                                      document, parts, more));
+  ASSERT_EQ("Second one", document.getTitle());
+  ASSERT_EQ("", document.getText());
+  ASSERT_EQ("beta gamma delta", partsAsString(parts));
+  ASSERT_EQ(6u, parts[0].offset);
+  ASSERT_FALSE(parts[0].isAtStart);
+  ASSERT_FALSE(parts[0].isAtEnd);
+  ASSERT_EQ(3u, parts[0].words.size());
+  ASSERT_EQ(4u, parts[0].words[0].position);
+  ASSERT_EQ(11u, parts[0].words[1].offset);
+  ASSERT_EQ(5u, parts[0].words[2].length);
+  ASSERT_FALSE(more);
+
+  // At the start and at the end of the text.
+  vector<Position> positions;
+  positions.push_back(3);
+  positions.push_back(10);
+  ASSERT_TRUE(docsDB.getDocumentParts(2, positions, 1, 10,
+                                      document, parts, more));
+  ASSERT_EQ("alpha beta|eta theta", partsAsString(parts));
+  ASSERT_TRUE(parts[0].isAtStart);
+  ASSERT_TRUE(parts[1].isAtEnd);
+
+  // Overlapping windows, and positions that are not of the text.
+  positions.clear();
+  positions.push_back(1);
+  positions.push_back(5);
+  positions.push_back(6);
+  positions.push_back(6);
+  ASSERT_TRUE(docsDB.getDocumentParts(2, positions, 1, 10,
+                                      document, parts, more));
+  ASSERT_EQ("beta gamma delta epsilon", partsAsString(parts));
+  ASSERT_TRUE(docsDB.getDocumentParts(2, positions, 1, 1,
+                                      document, parts, more));
+  ASSERT_EQ("beta gamma delta", partsAsString(parts));
+  ASSERT_TRUE(more);
+  ASSERT_TRUE(docsDB.getDocumentParts(2, vector<Position>(1, 1), 1, 10,
+                                      document, parts, more));
+  ASSERT_EQ(0u, parts.size());
+  remove("DocsDBTest.docs");
+  remove("DocsDBTest.docs.DB");
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
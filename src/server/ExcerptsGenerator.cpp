@@ -165,6 +165,113 @@ bool ExcerptsGenerator::wordList(unsigned long i, std::string& word) const
   }
 }
 
+// _____________________________________________________________________________
+bool ExcerptsGenerator::hasWord(unsigned long i) const
+{
+  if (i >= _wordList.size()) computeWordsAndPositions(i);
+  return i < _wordList.size();
+}
+
+// _____________________________________________________________________________
+void ExcerptsGenerator::compileQuery(const Query& query) const
+{
+  if (query.getQueryString() == _compiledQueryString && _queryWords.size() > 0)
+    return;
+  _queryWords.clear();
+  _queryWordParts.clear();
+  _compiledQueryString = query.getQueryString();
+  // Split like hitDataForDocAndQuery.
+  vector<Query> queryParts = query.splitAt(
+      fixed_separators._separators[SAME_DOC]._separatorString
+      + fixed_separators._separators[PAIRS]._separatorString);
+  for (size_t j = 0; j < queryParts.size(); j++)
+  {
+    vector<Query> dotsSeparatedParts = queryParts[j].splitAtDots();
+    size_t keyIndex = 0;
+    while (keyIndex < dotsSeparatedParts.size()
+           && !dotsSeparatedParts[keyIndex].isKeyword()) keyIndex++;
+    if (keyIndex == dotsSeparatedParts.size())
+    {
+      addQueryWords(queryParts[j]);
+    }
+    else
+    {
+      for (size_t k = 0; k < dotsSeparatedParts.size(); k++)
+        if (k != keyIndex) addQueryWordsInInterval(dotsSeparatedParts[k]);
+    }
+    while (_queryWordParts.size() < _queryWords.size())
+      _queryWordParts.push_back(j);
+  }
+}
+
+// _____________________________________________________________________________
+void ExcerptsGenerator::addQueryWords(Query query) const
+{
+  // Like computePositionsAndIntervals.
+  query.cleanForHighlighting();
+  string queryString = query.getQueryString();
+  for (size_t i = 0; i < queryString.length(); ++i)
+    if (queryString[i] == ':') queryString[i] = 'x';
+  query.setQueryString(queryString);
+  Query queryFirst, querySecond;
+  Separator splitSeparator;
+  if (query.splitAtLastSeparator(&queryFirst, &querySecond, &splitSeparator))
+  {
+    addQueryWord(querySecond);
+    addQueryWords(queryFirst);
+    return;
+  }
+  // Like computePositionsAndIntervalsBaseCase.
+  vector<Query> queryParts = query.splitAt("|");
+  for (size_t i = 0; i < queryParts.size(); i++)
+  {
+    queryParts[i].setQueryString(
+        decodeHexNumbers(queryParts[i].getQueryString()));
+    addQueryWord(queryParts[i]);
+  }
+}
+
+// _____________________________________________________________________________
+void ExcerptsGenerator::addQueryWordsInInterval(const Query& query) const
+{
+  // Like computePositionsInInterval.
+  Query queryFirst, queryLast;
+  Separator splitSeparator;
+  query.splitAtLastSeparator(&queryFirst, &queryLast, &splitSeparator);
+  if (queryLast.empty()) return;
+  addQueryWord(queryLast);
+  if (!queryFirst.empty()) addQueryWordsInInterval(queryFirst);
+}
+
+// _____________________________________________________________________________
+void ExcerptsGenerator::addQueryWord(Query queryWord) const
+{
+  bool isCompleteWord = queryWord.getLastCharacter() != '*';
+  if (!isCompleteWord) queryWord.removeLastCharacter();
+  _queryWords.add(queryWord.getQueryString(), isCompleteWord);
+}
+
+// _____________________________________________________________________________
+bool ExcerptsGenerator::matches(unsigned long i, const Query& queryWord,
+                                bool isCompleteWord) const
+{
+  assert(i < _wordList.size());
+  const string& word = queryWord.getQueryString();
+  size_t id = _queryWords.find(word, isCompleteWord);
+  if (id == PrefixMatcher::NOT_FOUND)
+    return isCompleteWord ? isEqual(word, _wordList[i])
+                          : isPrefix(word, _wordList[i]);
+  // Match the words up to the i-th against all query words, in one go each.
+  size_t maskSize = _queryWords.maskSize();
+  while (_wordMatchMasks.size() <= i * maskSize)
+  {
+    size_t k = _wordMatchMasks.size() / maskSize;
+    _wordMatchMasks.resize(_wordMatchMasks.size() + maskSize, 0);
+    _queryWords.match(_wordList[k], &_wordMatchMasks[k * maskSize]);
+  }
+  return (_wordMatchMasks[i * maskSize + id / 64] >> (id % 64)) & 1;
+}
+
 // _____________________________________________________________________________
 string ExcerptsGenerator::cleanedUpExcerpt(const string& excerpt) const
 {
@@ -354,16 +461,14 @@ vector<unsigned long> ExcerptsGenerator::computePositionsInInterval(
     if (!isCompleteWord.back()) prefixes[i].removeLastCharacter();
       }
     
-      string word;
-    
       if (queryFirst.empty())
       {
     for (size_t i=searchInterval.first+1; i<searchInterval.second && returnPositions.size()<(size_t)max; i++)
     {
-      if (!(wordList(i, word))) assert(wordList(i, word));
+      if (!hasWord(i)) assert(hasWord(i));
       for (size_t j=0; j<prefixes.size(); j++)
       {
-        if (isCompleteWord[j] ? isEqual(prefixes[j], word) : isPrefix(prefixes[j], word))
+        if (matches(i, prefixes[j], isCompleteWord[j]))
         {
           // If the current word matches the query, store its position and the corresponding interval
           returnPositions.push_back(i);
@@ -385,10 +490,10 @@ vector<unsigned long> ExcerptsGenerator::computePositionsInInterval(
     {
       if (positionsFirst[i] < searchInterval.second-1)
       {
-        if (!(wordList(positionsFirst[i]+1, word))) assert(wordList(positionsFirst[i]+1, word));
+        if (!hasWord(positionsFirst[i]+1)) assert(hasWord(positionsFirst[i]+1));
         for (size_t j=0; j<prefixes.size(); j++)
 	{
-          if (isCompleteWord[j] ? isEqual(prefixes[j], word) : isPrefix(prefixes[j], word))
+          if (matches(positionsFirst[i]+1, prefixes[j], isCompleteWord[j]))
           {
             // If the current word matches the query, store its position and the corresponding interval
             returnPositions.push_back(positionsFirst[i]+1);
@@ -498,6 +603,25 @@ for (size_t j=0; j<allHighlightedPositions[i].size(); j++)
   }
 }
 
+namespace
+{
+// The positions of the matching postings of the given document (the postings
+// are sorted by doc id), sorted. Returns false if there are none.
+bool positionsOfDoc(const QueryResult& result, DocId docId,
+                    vector<Position>* positions)
+{
+  positions->clear();
+  if (result._docIds.size() == 0) return false;
+  const DocId* docIds = &result._docIds[0];
+  const DocId* end = docIds + result._docIds.size();
+  for (const DocId* p = std::lower_bound(docIds, end, docId);
+       p < end && *p == docId; ++p)
+    positions->push_back(result._positions[p - docIds]);
+  std::sort(positions->begin(), positions->end());
+  return !positions->empty();
+}
+}
+
 // _____________________________________________________________________________
 void ExcerptsGenerator::getExcerpts(const Query&           query,      
 				    const QueryParameters& queryParameters,
@@ -519,6 +643,7 @@ void ExcerptsGenerator::getExcerpts(const Query&           query,
   // result._topDocIds[i] in the loop with the index i going to lastHit - 1.
   unsigned int nofHitsComputed = result._topDocIds.size();
   if (lastHit > nofHitsComputed) lastHit = nofHitsComputed;
+  vector<Position> positions;
   for (unsigned int i = queryParameters.firstHitToSend; i < lastHit; ++i)
   {
     assert(i < result.nofTotalHits);
@@ -526,7 +651,16 @@ void ExcerptsGenerator::getExcerpts(const Query&           query,
     #ifndef NDEBUG
     cout << "i = " << i << ", score = " << result._topDocScores[i] << ", docId = " << result._topDocIds[i] << endl;
     #endif
-    hits.push_back(hitDataForDocAndQuery(query, result._topDocIds[i], queryParameters.titleIndex, HL_XML));
+    // For documents with word positions in the docs DB, only the parts
+    // around the positions of the matching postings are read.
+    HitData hitData;
+    if (!result.hasPositions()
+        || !positionsOfDoc(result, result._topDocIds[i], &positions)
+        || !hitDataForDocAndPositions(query, result._topDocIds[i], positions,
+                                      queryParameters.titleIndex, &hitData,
+                                      HL_XML))
+      hitData = hitDataForDocAndQuery(query, result._topDocIds[i], queryParameters.titleIndex, HL_XML);
+    hits.push_back(hitData);
     hits.back().score =  result._topDocScores[i];
     #ifndef NDEBUG
     cout << "pushed back hit (i = " << i << ")" << flush;
@@ -700,8 +834,11 @@ HitData ExcerptsGenerator::hitDataForDocAndQuery(const Query& query,
   // the positions of these words in the document string (in the same order).
   _wordList.clear();
   _positionList.clear();
+  _wordMatchMasks.clear();
   _document = &(document.getText());
   _listsComplete = false;
+  // Compile the query words (only once for all documents of a query).
+  compileQuery(query);
 
   // the list of excerpts that will be returned for this document, initially empty
   _excerpts.clear();
@@ -805,23 +942,112 @@ HitData ExcerptsGenerator::hitDataForDocAndQuery(const Query& query,
 
   // title, url, and list of excerpts of a single hit (initialized)
   HitData hitData;                  
+  setTitleAndUrl(document, titleIndex, &hitData);
+  // set list of excerpts
+  hitData.excerpts = _excerpts;
+
+  // add to list of hits
+  return hitData;
+}
+
+// _____________________________________________________________________________
+void ExcerptsGenerator::setTitleAndUrl(const Document& document,
+                                       const unsigned int titleIndex,
+                                       HitData* hitData) const
+{
   // set docId
-  hitData.docId = document.getDocId();
+  hitData->docId = document.getDocId();
   // set title (with special characters removed)
   string documentTitle = document.getTitle();
   for (size_t j = 0; j < documentTitle.length(); j++)
-    if (documentTitle[j] != wordPartSeparator) hitData.title += documentTitle[j];
+    if (documentTitle[j] != wordPartSeparator) hitData->title += documentTitle[j];
   if (infoDelim != '\0')
-    hitData.title = getPartOfMultipleField(titleIndex, hitData.title);
+    hitData->title = getPartOfMultipleField(titleIndex, hitData->title);
   // set URL (with special characters removed)
   string documentUrl = document.getUrl();
   for (size_t j = 0; j < documentUrl.length(); j++)
-    if (documentUrl[j] != wordPartSeparator) hitData.url += documentUrl[j];
-  // set list of excerpts
-  hitData.excerpts = _excerpts;
+    if (documentUrl[j] != wordPartSeparator) hitData->url += documentUrl[j];
+}
 
-  // add to list of hits
-  return hitData;
+// _____________________________________________________________________________
+bool ExcerptsGenerator::hitDataForDocAndPositions(const Query& query,
+                                                  const DocId& docId,
+                                                  const vector<Position>& positions,
+                                                  const unsigned int titleIndex,
+                                                  HitData* hitData,
+                                                  int _highlight) const
+{
+  highlight = (Highlighting)(_highlight);
+  Document document;
+  vector<DocumentPart> parts;
+  bool more;
+  if (!_docsDB.getDocumentParts(docId, positions, showRange.second, maxHits,
+                                document, parts, more) || parts.empty())
+    return false;
+  compileQuery(query);
+  *hitData = HitData();
+  setTitleAndUrl(document, titleIndex, hitData);
+  for (size_t i = 0; i < parts.size(); i++)
+    hitData->excerpts.push_back(excerptFromPart(parts[i], positions));
+  if (more) hitData->excerpts.push_back("... [there are more matches] ...");
+  return true;
+}
+
+// _____________________________________________________________________________
+string ExcerptsGenerator::excerptFromPart(const DocumentPart& part,
+                                          const vector<Position>& positions) const
+{
+  static const string dots(" ... ");
+  string excerpt = part.text;
+  if (highlight != HL_NONE)
+  {
+    // From the last word to the first, so that the offsets stay valid.
+    vector<uint64_t> mask;
+    string word, normChar;
+    for (size_t i = part.words.size(); i > 0; i--)
+    {
+      const DocumentWord& w = part.words[i - 1];
+      size_t offset = w.offset - part.offset;
+      // The query part of the first query word the word matches, if any.
+      word.clear();
+      for (size_t k = offset; k < offset + w.length;)
+      {
+        k += normalize(&excerpt[k], normChar);
+        word += normChar;
+      }
+      mask.assign(_queryWords.maskSize(), 0);
+      if (!mask.empty()) _queryWords.match(word, &mask[0]);
+      size_t idx = 0;
+      bool isMatch = false;
+      for (size_t id = 0; id < _queryWords.size(); id++)
+      {
+        if (((mask[id / 64] >> (id % 64)) & 1) == 0) continue;
+        if (!isMatch || _queryWordParts[id] < idx) idx = _queryWordParts[id];
+        isMatch = true;
+      }
+      if (!isMatch && !std::binary_search(positions.begin(), positions.end(),
+                                          w.position)) continue;
+      string first, last;
+      if (highlight == HL_HTML)
+      {
+        first = string("<b style=\"color:black;background-color:#")
+                + color[idx % numberOfColors] + "\">";
+        last = "</b>";
+      }
+      else if (highlight == HL_XML)
+      {
+        ostringstream os;
+        os << "<hl idx='" << idx << "'>";
+        first = os.str();
+        last = "</hl>";
+      }
+      insertIntoExcerpt(offset + w.length, last, &excerpt);
+      insertIntoExcerpt(offset, first, &excerpt);
+    }
+  }
+  if (!part.isAtStart) excerpt = dots + excerpt;
+  if (!part.isAtEnd) excerpt += dots;
+  return cleanedUpExcerpt(excerpt);
 }
 
 
@@ -910,7 +1136,7 @@ std::vector<unsigned long> ExcerptsGenerator::computePositionsAndIntervals(
       {
         for (k=0; k<prefixes.size(); k++)
         {
-          if (isCompleteWord[k] ? isEqual(prefixes[k], _wordList[j]) : isPrefix(prefixes[k], _wordList[j]))
+          if (matches(j, prefixes[k], isCompleteWord[k]))
           {
             // If the current word matches the query, store its position and the corresponding interval
             ReturnPositions.push_back(j);
@@ -971,9 +1197,8 @@ vector<unsigned long> ExcerptsGenerator::computePositionsAndIntervalsBaseCase(
     if (!isCompleteWord.back()) queryParts[i].removeLastCharacter();
   }
 
-  string word;
   i = 0;
-  while (wordList(i, word) && positions.size() < (size_t)max)
+  while (hasWord(i) && positions.size() < (size_t)max)
   {
     for (k=0; k<queryParts.size(); k++)
     {
@@ -981,11 +1206,11 @@ vector<unsigned long> ExcerptsGenerator::computePositionsAndIntervalsBaseCase(
       {
         // If we are looking for a keyword, the current word must be a tag. If the keyword(-prefix) matches this tag,
         // we store its position.
-        if (isTag(word) && queryParts[k].matchesTag(word, isCompleteWord[k])) positions.push_back(i);
+        if (isTag(_wordList[i]) && queryParts[k].matchesTag(_wordList[i], isCompleteWord[k])) positions.push_back(i);
       }
       else
       {
-        if (isCompleteWord[k] ? isEqual(queryParts[k], word) : isPrefix(queryParts[k], word))
+        if (matches(i, queryParts[k], isCompleteWord[k]))
         {
           positions.push_back(i);
           if (highlight != HL_NONE) 
@@ -11,6 +11,7 @@
 #include "QueryParameters.h"
 #include "DocsDB.h"
 #include "Separator.h"
+#include "PrefixMatcher.h"
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -144,6 +145,31 @@ class ExcerptsGenerator
         pair<unsigned long, unsigned long>& pos_pair) const;
     // Same but returns the word.
     bool wordList(unsigned long i, std::string& word) const;
+    // Same but only returns whether there was an i-th word.
+    bool hasWord(unsigned long i) const;
+
+    // The words of the current query (prefixes and complete words), compiled
+    // once per query, and the query they were compiled for.
+    mutable PrefixMatcher _queryWords;
+    mutable string _compiledQueryString;
+    // For each query word, the index of the (first) query part it is from.
+    mutable vector<unsigned short> _queryWordParts;
+    // For each word of _wordList matched so far, the bits of the query words
+    // it matches (_queryWords.maskSize() entries per word).
+    mutable vector<uint64_t> _wordMatchMasks;
+
+    // Compile the words of the given query, as they are split off by
+    // computePositionsAndIntervals and computePositionsInInterval.
+    void compileQuery(const Query& query) const;
+    void addQueryWords(Query query) const;
+    void addQueryWordsInInterval(const Query& query) const;
+    void addQueryWord(Query queryWord) const;
+    // Whether the i-th word of the document (which must exist) matches the
+    // given query word, like isEqual or isPrefix. The document words are
+    // matched against all compiled query words when first needed; a query word
+    // that was not compiled is matched directly.
+    bool matches(unsigned long i, const Query& queryWord,
+                 bool isCompleteWord) const;
 
     // Check if candidate string is a prefix of word. The "Real" pertains to the
     // fact that no special characters like ^ are considered here, it's just a
@@ -332,6 +358,16 @@ class ExcerptsGenerator
     static string getPartOfMultipleField(const unsigned int index, const string& field);
     FRIEND_TEST(ExcerptsGeneratorTest, getPartOfMultipleField);
 
+    // Set the title (the one with the given index) and the URL of the given
+    // hit from the given document.
+    void setTitleAndUrl(const Document& document, const unsigned int titleIndex,
+        HitData* hitData) const;
+
+    // The excerpt for the given part of a document, with the words at the
+    // given positions (sorted) and the words matching the query highlighted.
+    string excerptFromPart(const DocumentPart& part,
+        const vector<Position>& positions) const;
+
   public:
     // Construct from docs.DB file.
     ExcerptsGenerator(const std::string& filename,
@@ -385,6 +421,21 @@ class ExcerptsGenerator
     // Computes relevant excerpts for given query and document.
     HitData hitDataForDocAndQuery(const Query& query, const DocId& docId,
 	const unsigned int titleIndex, int _highlight = HL_HTML) const;
+    // Computes the excerpts around the given positions (sorted) of the words
+    // of the given document that match the query, from only the blocks of the
+    // document around them (see DocsDB::getDocumentParts). Returns false if the
+    // document has no word positions in the docs DB or if none of the
+    // positions is of a word of its text.
+    bool hitDataForDocAndPositions(const Query& query, const DocId& docId,
+        const vector<Position>& positions, const unsigned int titleIndex,
+        HitData* hitData, int _highlight = HL_HTML) const;
+    // Whether the documents in the docs DB have word positions, so that
+    // excerpts are computed from the positions of the hits if the result has
+    // them (see getExcerpts and CompleterBase::_positionsNeeded).
+    bool hasDocsWithPositions() const
+    {
+      return _docsDB.hasWordPositions();
+    }
     // Insert a string into an excerpt, paying attention not to insert in the
     // middle of a UTF-8 multibyte sequence.
     static void insertIntoExcerpt(size_t pos, const string& insert,
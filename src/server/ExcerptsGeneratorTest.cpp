@@ -81,6 +81,48 @@ TEST(ExcerptsGeneratorTest, getPartOfMultipleField)
   ASSERT_EQ("abc", ExcerptsGenerator::getPartOfMultipleField(3, s));
 }
 
+// _____________________________________________________________________________
+TEST(ExcerptsGeneratorTest, hitDataForDocAndPositions)
+{
+  FILE* file = fopen("ExcerptsGeneratorTest.docs", "w");
+  fputs("1\tu:url1\tt:First\tH:the first document\n"
+        "2\tu:url2\tt:Second\tp:2:0:5,3:6:4,4:11:5,5:17:5,6:23:7"
+        "\tH:alpha beta gamma delta epsilon\n", file);
+  fclose(file);
+  string docsFileName = "ExcerptsGeneratorTest.docs";
+  string dbFileName = "ExcerptsGeneratorTest.docs.DB";
+  DocsDB::build(docsFileName, dbFileName, 6, 0, 8);
+  ExcerptsGenerator excerptsGenerator(dbFileName);
+  excerptsGenerator.setExcerptRadius(-1, 1);
+  HitData hitData;
+  vector<Position> positions(1, 4);
+  ASSERT_TRUE(excerptsGenerator.hitDataForDocAndPositions(Query("gamma delt*"),
+      2, positions, 0, &hitData, ExcerptsGenerator::HL_XML));
+  ASSERT_EQ(2u, hitData.docId);
+  ASSERT_EQ("Second", hitData.title);
+  ASSERT_EQ("url2", hitData.url);
+  ASSERT_EQ(1u, hitData.excerpts.size());
+  ASSERT_EQ(" ... beta <hl idx='0'>gamma</hl> <hl idx='1'>delta</hl> ... ",
+            hitData.excerpts[0]);
+  // A word at a position of the hit is highlighted even if it does not match.
+  positions.push_back(6);
+  ASSERT_TRUE(excerptsGenerator.hitDataForDocAndPositions(Query("gamma"),
+      2, positions, 0, &hitData, ExcerptsGenerator::HL_XML));
+  ASSERT_EQ(1u, hitData.excerpts.size());
+  ASSERT_EQ(" ... beta <hl idx='0'>gamma</hl> delta "
+            "<hl idx='0'>epsilon</hl>", hitData.excerpts[0]);
+  excerptsGenerator.setMaxHits(1);
+  ASSERT_TRUE(excerptsGenerator.hitDataForDocAndPositions(Query("gamma"),
+      2, positions, 0, &hitData, ExcerptsGenerator::HL_XML));
+  ASSERT_EQ(2u, hitData.excerpts.size());
+  ASSERT_EQ("... [there are more matches] ...", hitData.excerpts[1]);
+  // Documents without word positions.
+  ASSERT_FALSE(excerptsGenerator.hitDataForDocAndPositions(Query("first"),
+      1, positions, 0, &hitData, ExcerptsGenerator::HL_XML));
+  remove("ExcerptsGeneratorTest.docs");
+  remove("ExcerptsGeneratorTest.docs.DB");
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
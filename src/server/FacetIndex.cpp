@@ -0,0 +1,185 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/FacetIndex.h"
+#include "server/Exception.h"
+
+// Pointer to global FacetIndex object.
+FacetIndex* globalFacetIndex = NULL;
+
+namespace
+{
+const char FACET_INDEX_MAGIC[8] = { 'C', 'S', 'F', 'A', 'C', 'E', 'T', 'S' };
+const uint32_t FACET_INDEX_VERSION = 1;
+
+// Round up to a multiple of 8.
+uint64_t align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+}
+
+// _____________________________________________________________________________
+void FacetIndex::write(const string& fileName, const vector<Column>& columns)
+{
+  // Compute the size of the header (which gives the offset of the data of the
+  // first field) and the size of the words of each field.
+  size_t nofFields = columns.size();
+  vector<uint64_t> wordsSizes(nofFields, 0);
+  uint64_t offset = sizeof(FACET_INDEX_MAGIC) + 2 * sizeof(uint32_t);
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    const Column& column = columns[i];
+    CS_ASSERT_GT(column.offsets.size(), 0);
+    CS_ASSERT_EQ(column.offsets.back(), column.valueIds.size());
+    for (size_t j = 0; j < column.words.size(); j++)
+      wordsSizes[i] += column.words[j].size() + 1;
+    offset += sizeof(uint32_t) + column.name.size() + 2 * sizeof(uint32_t)
+              + 6 * sizeof(uint64_t);
+  }
+  offset = align8(offset);
+
+  FILE* file = fopen(fileName.c_str(), "w");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName
+             << "\" for writing");
+  uint32_t nofFields32 = nofFields;
+  writeOrThrow(file, FACET_INDEX_MAGIC, sizeof(FACET_INDEX_MAGIC), fileName);
+  writeOrThrow(file, &FACET_INDEX_VERSION, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofFields32, sizeof(uint32_t), fileName);
+  uint64_t headerSize = offset;
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    const Column& column = columns[i];
+    uint32_t nameLength = column.name.size();
+    uint32_t nofValues = column.words.size();
+    uint64_t nofDocs = column.offsets.size() - 1;
+    uint64_t nofPostings = column.valueIds.size();
+    uint64_t wordsOffset = offset;
+    uint64_t offsetsOffset = align8(wordsOffset + wordsSizes[i]);
+    uint64_t valueIdsOffset
+      = align8(offsetsOffset + column.offsets.size() * sizeof(uint32_t));
+    writeOrThrow(file, &nameLength, sizeof(uint32_t), fileName);
+    writeOrThrow(file, column.name.data(), nameLength, fileName);
+    writeOrThrow(file, &column.score, sizeof(uint32_t), fileName);
+    writeOrThrow(file, &nofValues, sizeof(uint32_t), fileName);
+    writeOrThrow(file, &nofDocs, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &nofPostings, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &wordsOffset, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &wordsSizes[i], sizeof(uint64_t), fileName);
+    writeOrThrow(file, &offsetsOffset, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &valueIdsOffset, sizeof(uint64_t), fileName);
+    offset = align8(valueIdsOffset + nofPostings * sizeof(uint32_t));
+  }
+
+  // Write the data of each field, padded to 8 bytes after each part.
+  const char zeros[8] = { 0 };
+  writeOrThrow(file, zeros, headerSize - ftell(file), fileName);
+  for (size_t i = 0; i < nofFields; i++)
+  {
+    const Column& column = columns[i];
+    for (size_t j = 0; j < column.words.size(); j++)
+      writeOrThrow(file, column.words[j].c_str(), column.words[j].size() + 1,
+                   fileName);
+    writeOrThrow(file, zeros, align8(ftell(file)) - ftell(file), fileName);
+    writeOrThrow(file, &column.offsets[0],
+                 column.offsets.size() * sizeof(uint32_t), fileName);
+    writeOrThrow(file, zeros, align8(ftell(file)) - ftell(file), fileName);
+    if (column.valueIds.size() > 0)
+      writeOrThrow(file, &column.valueIds[0],
+                   column.valueIds.size() * sizeof(uint32_t), fileName);
+    writeOrThrow(file, zeros, align8(ftell(file)) - ftell(file), fileName);
+  }
+  fclose(file);
+}
+
+// _____________________________________________________________________________
+void FacetIndex::open(const string& fileName)
+{
+  _file.open(fileName, "facet index file");
+  const char* mapped = _file.data();
+  size_t size = _file.size();
+  _fields.clear();
+
+  // Parse the header.
+  const char* base = static_cast<const char*>(mapped);
+  const char* p = base;
+  const char* end = p + size;
+  uint32_t version;
+  uint32_t nofFields;
+  if (size < sizeof(FACET_INDEX_MAGIC) + 2 * sizeof(uint32_t)
+      || memcmp(p, FACET_INDEX_MAGIC, sizeof(FACET_INDEX_MAGIC)) != 0)
+    CS_THROW(Exception::OTHER, "\"" << fileName
+             << "\" is not a facet index file");
+  p += sizeof(FACET_INDEX_MAGIC);
+  memcpy(&version, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&nofFields, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  if (version != FACET_INDEX_VERSION)
+    CS_THROW(Exception::OTHER, "facet index file \"" << fileName
+             << "\" has version " << version << ", expected "
+             << FACET_INDEX_VERSION);
+  for (uint32_t i = 0; i < nofFields; i++)
+  {
+    Field field;
+    uint32_t nameLength;
+    uint64_t nofPostings;
+    uint64_t wordsOffset;
+    uint64_t wordsSize;
+    uint64_t offsetsOffset;
+    uint64_t valueIdsOffset;
+    if (p + sizeof(uint32_t) > end) break;
+    memcpy(&nameLength, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    if (p + nameLength + 2 * sizeof(uint32_t) + 6 * sizeof(uint64_t) > end)
+      break;
+    field.name.assign(p, nameLength); p += nameLength;
+    memcpy(&field.score, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    memcpy(&field.nofValues, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+    memcpy(&field.nofDocs, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&nofPostings, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&wordsOffset, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&wordsSize, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&offsetsOffset, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&valueIdsOffset, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    if (wordsOffset + wordsSize > size
+        || offsetsOffset % 8 != 0 || valueIdsOffset % 8 != 0
+        || offsetsOffset + (field.nofDocs + 1) * sizeof(uint32_t) > size
+        || valueIdsOffset + nofPostings * sizeof(uint32_t) > size)
+      break;
+    field.words = base + wordsOffset;
+    field.offsets = reinterpret_cast<const uint32_t*>(base + offsetsOffset);
+    field.valueIds = reinterpret_cast<const uint32_t*>(base + valueIdsOffset);
+    if (field.offsets[field.nofDocs] != nofPostings) break;
+    // Find the start of each word, and check that all value ids are valid.
+    field.wordOffsets.reserve(field.nofValues);
+    uint64_t wordOffset = 0;
+    while (wordOffset < wordsSize
+           && field.wordOffsets.size() < field.nofValues)
+    {
+      field.wordOffsets.push_back(wordOffset);
+      const void* zero = memchr(field.words + wordOffset, 0,
+                                wordsSize - wordOffset);
+      if (zero == NULL) break;
+      wordOffset = static_cast<const char*>(zero) - field.words + 1;
+    }
+    if (field.wordOffsets.size() != field.nofValues) break;
+    uint64_t j = 0;
+    while (j < nofPostings && field.valueIds[j] < field.nofValues) j++;
+    if (j < nofPostings) break;
+    field.wordIds.assign(field.nofValues, -1);
+    _fields.push_back(field);
+  }
+  if (_fields.size() != nofFields)
+    CS_THROW(Exception::OTHER, "facet index file \"" << fileName
+             << "\" is truncated or corrupt");
+}
+
+// _____________________________________________________________________________
+int FacetIndex::getFieldId(const string& fieldName) const
+{
+  for (size_t i = 0; i < _fields.size(); i++)
+    if (_fields[i].name == fieldName) return i;
+  return -1;
+}
+
+// _____________________________________________________________________________
+const string& FacetIndex::getFieldName(int fieldId) const
+{
+  return _fields[fieldId].name;
+}
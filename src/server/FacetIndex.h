@@ -0,0 +1,147 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_FACETINDEX_H_
+#define SERVER_FACETINDEX_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "server/MappedFile.h"
+
+using std::string;
+using std::vector;
+
+// Forward index from doc ids to facet words, for computing facet counts
+// (completions of :facet:<field>:*) without reading and intersecting the
+// posting lists of all facet words of a field.
+//
+// For each field, the distinct facet words (e.g. :facet:author:Hannah_Bast)
+// are numbered 0, 1, 2, ... in the order given by the parser ("value ids"),
+// and the value ids of each document are stored in CSR form: those of
+// document d are valueIds[offsets[d]], ..., valueIds[offsets[d + 1] - 1].
+//
+// The file <basename>.facet-index is written by the CSV parser (option
+// --write-facet-index) and mmap'ed by the server (option --read-facet-index).
+// The server maps the value ids to word ids once after reading the file.
+//
+// File format (all numbers in host byte order):
+//   "CSFACETS" <uint32 version> <uint32 nofFields>
+//   per field: <uint32 nameLength> <name> <uint32 score> <uint32 nofValues>
+//              <uint64 nofDocs> <uint64 nofPostings> <uint64 offset of words>
+//              <uint64 size of words> <uint64 offset of offsets>
+//              <uint64 offset of value ids>
+//   per field: the words (each terminated by a zero byte), the nofDocs + 1
+//              offsets (uint32) and the nofPostings value ids (uint32), each
+//              aligned to 8 bytes.
+class FacetIndex
+{
+ public:
+  // The contents of one field, as collected by the parser.
+  struct Column
+  {
+    // The name of the field.
+    string name;
+    // The score of the postings of the facet words.
+    uint32_t score;
+    // The facet words; value id i stands for words[i].
+    vector<string> words;
+    // The value ids of document d are valueIds[offsets[d] .. offsets[d + 1]).
+    // offsets[0] == 0, and offsets.size() is the number of documents + 1.
+    vector<uint32_t> offsets;
+    vector<uint32_t> valueIds;
+  };
+
+  // Write the given columns to the given file.
+  static void write(const string& fileName, const vector<Column>& columns);
+
+  // Map the given file into memory. Throws an exception if the file does not
+  // exist or has the wrong format. The word ids are all -1 until
+  // computeWordIds is called.
+  void open(const string& fileName);
+
+  // Look up the word id of each facet word in the given vocabulary (-1 for
+  // words that are not in it). This is a template, so that the parser, which
+  // only writes facet indexes, does not depend on the vocabulary class.
+  template <class Vocabulary>
+  void computeWordIds(const Vocabulary& vocabulary);
+
+  // The number of fields.
+  size_t getNofFields() const { return _fields.size(); }
+
+  // The id of the field with the given name, or -1 if there is no such field.
+  int getFieldId(const string& fieldName) const;
+
+  // The name and the posting score of the field with the given id.
+  const string& getFieldName(int fieldId) const;
+  uint32_t getScore(int fieldId) const { return _fields[fieldId].score; }
+
+  // The number of facet words of the given field, and the word with the given
+  // value id.
+  uint32_t getNofValues(int fieldId) const { return _fields[fieldId].nofValues; }
+  const char* getWord(int fieldId, uint32_t valueId) const
+  {
+    return _fields[fieldId].words + _fields[fieldId].wordOffsets[valueId];
+  }
+
+  // The word id of the given value id (-1 if it is not in the vocabulary).
+  int getWordId(int fieldId, uint32_t valueId) const
+  {
+    return _fields[fieldId].wordIds[valueId];
+  }
+
+  // The value ids of the given document: [*begin, *end). Empty for documents
+  // beyond the end of the column.
+  void getValueIds(int fieldId, uint32_t docId,
+                   const uint32_t** begin, const uint32_t** end) const
+  {
+    const Field& field = _fields[fieldId];
+    if (docId >= field.nofDocs) { *begin = *end = field.valueIds; return; }
+    *begin = field.valueIds + field.offsets[docId];
+    *end = field.valueIds + field.offsets[docId + 1];
+  }
+
+ private:
+  struct Field
+  {
+    string name;
+    uint32_t score;
+    uint32_t nofValues;
+    uint64_t nofDocs;
+    const char* words;
+    const uint32_t* offsets;
+    const uint32_t* valueIds;
+    // Offset of each word in words, and the word ids (see computeWordIds).
+    vector<uint64_t> wordOffsets;
+    vector<int> wordIds;
+  };
+
+  vector<Field> _fields;
+
+  // The mmap'ed file.
+  MappedFile _file;
+};
+
+// _____________________________________________________________________________
+template <class Vocabulary>
+void FacetIndex::computeWordIds(const Vocabulary& vocabulary)
+{
+  for (size_t i = 0; i < _fields.size(); i++)
+  {
+    Field& field = _fields[i];
+    for (uint32_t valueId = 0; valueId < field.nofValues; valueId++)
+    {
+      string word = getWord(i, valueId);
+      unsigned int wordId = vocabulary.findWord(word);
+      field.wordIds[valueId] = wordId < vocabulary.size()
+                               && vocabulary[wordId] == word ? wordId : -1;
+    }
+  }
+}
+
+// Whoever includes this should be able to use the global FacetIndex object
+// declared in the .cpp file (NULL if no facet index was read).
+extern FacetIndex* globalFacetIndex;
+
+#endif  // SERVER_FACETINDEX_H_
@@ -0,0 +1,113 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "server/FacetIndex.h"
+#include "server/Exception.h"
+
+// A vocabulary with the interface needed by FacetIndex::computeWordIds.
+class SimpleVocabulary : public vector<string>
+{
+ public:
+  unsigned int findWord(const string& word) const
+  {
+    return std::lower_bound(begin(), end(), word) - begin();
+  }
+};
+
+// Helper: the value ids of the given document as a string.
+string valueIdsAsString(const FacetIndex& facetIndex, int fieldId,
+                        uint32_t docId)
+{
+  const uint32_t* begin;
+  const uint32_t* end;
+  facetIndex.getValueIds(fieldId, docId, &begin, &end);
+  string result;
+  for (const uint32_t* it = begin; it < end; ++it)
+    result += (it == begin ? "" : " ") + std::to_string(*it);
+  return "[" + result + "]";
+}
+
+// Write two columns and read them back.
+TEST(FacetIndexTest, writeAndOpen)
+{
+  string fileName = "FacetIndexTest.TMP.facet-index";
+  vector<FacetIndex::Column> columns(2);
+  columns[0].name = "author";
+  columns[0].score = 7;
+  columns[0].words.push_back(":facet:author:Hannah_Bast");
+  columns[0].words.push_back(":facet:author:Ingmar_Weber");
+  columns[0].words.push_back(":facet:author:Nobody");
+  uint32_t offsets[] = { 0, 0, 2, 3 };
+  uint32_t valueIds[] = { 1, 0, 1 };
+  columns[0].offsets.assign(offsets, offsets + 4);
+  columns[0].valueIds.assign(valueIds, valueIds + 3);
+  columns[1].name = "venue";
+  columns[1].score = 1;
+  columns[1].offsets.push_back(0);
+  FacetIndex::write(fileName, columns);
+
+  FacetIndex facetIndex;
+  facetIndex.open(fileName);
+  ASSERT_EQ(2u, facetIndex.getNofFields());
+  ASSERT_EQ(0, facetIndex.getFieldId("author"));
+  ASSERT_EQ(1, facetIndex.getFieldId("venue"));
+  ASSERT_EQ(-1, facetIndex.getFieldId("title"));
+  ASSERT_EQ("venue", facetIndex.getFieldName(1));
+  ASSERT_EQ(7u, facetIndex.getScore(0));
+  ASSERT_EQ(3u, facetIndex.getNofValues(0));
+  ASSERT_EQ(0u, facetIndex.getNofValues(1));
+  ASSERT_EQ(string(":facet:author:Ingmar_Weber"), facetIndex.getWord(0, 1));
+  ASSERT_EQ("[]", valueIdsAsString(facetIndex, 0, 0));
+  ASSERT_EQ("[1 0]", valueIdsAsString(facetIndex, 0, 1));
+  ASSERT_EQ("[1]", valueIdsAsString(facetIndex, 0, 2));
+  // Documents beyond the end of a column have no values.
+  ASSERT_EQ("[]", valueIdsAsString(facetIndex, 0, 3));
+  ASSERT_EQ("[]", valueIdsAsString(facetIndex, 1, 1));
+}
+
+// Map the facet words to word ids.
+TEST(FacetIndexTest, computeWordIds)
+{
+  string fileName = "FacetIndexTest.TMP.facet-index";
+  vector<FacetIndex::Column> columns(1);
+  columns[0].name = "author";
+  columns[0].score = 1;
+  columns[0].words.push_back(":facet:author:Ingmar_Weber");
+  columns[0].words.push_back(":facet:author:Nobody");
+  columns[0].words.push_back(":facet:author:Hannah_Bast");
+  columns[0].offsets.push_back(0);
+  FacetIndex::write(fileName, columns);
+  FacetIndex facetIndex;
+  facetIndex.open(fileName);
+  ASSERT_EQ(-1, facetIndex.getWordId(0, 0));
+
+  SimpleVocabulary vocabulary;
+  vocabulary.push_back(":facet:author:Hannah_Bast");
+  vocabulary.push_back(":facet:author:Ingmar_Weber");
+  vocabulary.push_back(":facet:author:Nobody_Else");
+  facetIndex.computeWordIds(vocabulary);
+  ASSERT_EQ(1, facetIndex.getWordId(0, 0));
+  ASSERT_EQ(-1, facetIndex.getWordId(0, 1));
+  ASSERT_EQ(0, facetIndex.getWordId(0, 2));
+}
+
+// Opening a file that is not a facet index fails.
+TEST(FacetIndexTest, openInvalidFile)
+{
+  string fileName = "FacetIndexTest.TMP.facet-index";
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "this is not a facet index file\n");
+  fclose(file);
+  FacetIndex facetIndex;
+  ASSERT_THROW(facetIndex.open(fileName), Exception);
+  ASSERT_THROW(facetIndex.open("FacetIndexTest.TMP.nonexisting"), Exception);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,6 +7,8 @@ string MSG_BEG = "! "; /* per default put two newlines after messages like buffe
 string MSG_END = "\n"; /* per default put two newlines after messages like buffer resize etc. */
 unsigned int HYB_BLOCK_VOLUME = 200*1000; /* the default will give about 1 MB for a block */
                                           /* can be changed via -b option of buildIndex */
+unsigned int HYB_BUILD_NOF_THREADS = 1;   /* threads for sorting and compressing blocks */
+                                          /* can be changed via -t option of buildIndex */
 string HYB_BOUNDARY_WORDS_FILE_NAME = ""; /* files of prefixes for block division of HYB */
                                           /* can be changed via -b option of buildIndex */
 bool SHOW_HUFFMAN_STAT = false;
@@ -25,6 +27,10 @@ int nofRunningProcessorThreads = 0;
 size_t excerptsDBCacheSize = 16*1024*1024; /* in bytes */
 size_t historyMaxSizeInBytes = 32*1024*1024; 
 unsigned int historyMaxNofQueries = 200; // Note: current impl. is quadratic!
+//! The counts of count-only queries are kept in the history apart from the
+//! results, up to this size (see CompleterBase::processCountOnlyQuery).
+size_t historyMaxSizeOfCountsInBytes = 8*1024*1024;
+bool countOnlyQueries = true;
 bool runMultithreaded = false; // Note: not yet stable, turn on with -m
 //! The maximal number of items in a block/list of HYB/INV. Block ignored
 //! otherwise. To avoid buildIndex crash when lists > 2GB encountered (e.g. the
@@ -264,13 +270,22 @@ string replaceWordPartSeparatorBackendToFrontend(const string& text)
 // _____________________________________________________________________________
 string decodeHexNumbers(const string& text)
 {
-  string decodedText = "";
-  for (size_t i = 0; i < text.size(); ++i)
+  string decodedText = text;
+  if (!text.empty())
+    decodedText.resize(decodeHexNumbersInPlace(&decodedText[0], text.size()));
+  return decodedText;
+}
+
+// _____________________________________________________________________________
+size_t decodeHexNumbersInPlace(char* text, size_t length)
+{
+  size_t j = 0;
+  for (size_t i = 0; i < length; ++i)
   {
     // Replace + by a whitespace.
-    if (text[i] == '+') decodedText += ' ';
+    if (text[i] == '+') text[j++] = ' ';
     // Escaped character found.
-    else if (text[i] == '%' && i + 2 < text.size())
+    else if (text[i] == '%' && i + 2 < length)
     {
       // First part of hex digit.
       char h1 = tolower(text[i+1]);
@@ -290,16 +305,16 @@ string decodeHexNumbers(const string& text)
       // Iff escaped character, convert to corresponding char.
       if (h1 != -1 && h2 != -1)
       {
-        decodedText += (char)(h1 * 16 + h2);
+        text[j++] = (char)(h1 * 16 + h2);
         i += 2;
       }
       // Iff mistake, % stays %.
-      else decodedText += '%';
+      else text[j++] = '%';
     }
     // If there is no escaped character, just append the given character.
-    else decodedText += text[i];
+    else text[j++] = text[i];
   }
-  return decodedText;
+  return j;
 }
 
 // _____________________________________________________________________________
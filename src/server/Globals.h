@@ -68,6 +68,8 @@ extern int nofRunningProcessorThreads;
 extern size_t excerptsDBCacheSize;
 extern size_t historyMaxSizeInBytes;
 extern unsigned int historyMaxNofQueries;
+extern size_t historyMaxSizeOfCountsInBytes;
+extern bool countOnlyQueries;
 extern bool runMultithreaded;
 extern size_t maxBlockVolume;
 extern StringConverter globalStringConverter;
@@ -193,6 +195,7 @@ const static Ten Full    = Ten(); // To mark the very first word
 extern string MSG_BEG; /* prefix of messages like buffer resize etc. */
 extern string MSG_END; /* postfix of messages like buffer resize etc. */
 extern unsigned int HYB_BLOCK_VOLUME; 
+extern unsigned int HYB_BUILD_NOF_THREADS; 
 extern string HYB_BOUNDARY_WORDS_FILE_NAME; 
 extern bool SHOW_HUFFMAN_STAT; 
 #define FILE_BUFFER_SIZE 1000000 /* buffer size when using fread, fwrite, etc. */
@@ -332,6 +335,10 @@ string addCdataTagIfNecessary(string text, bool alreadyWellformedXml);
 // the corresponding character). See CompleterBase.cpp:237 8Feb13.
 string decodeHexNumbers(const string& text);
 
+// Same as decodeHexNumbers, but in place: the decoded text is never longer, it
+// is written to the beginning of the given text. Returns its length.
+size_t decodeHexNumbersInPlace(char* text, size_t length);
+
 // Encode a text by replacing special characters by the corresponding hex %hh
 // character. See CompleterBase.cpp:237 8Feb13.
 string encodeQuotedQueryParts(const string& query);
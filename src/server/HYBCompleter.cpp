@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <functional>
+#include <map>
 #include "server/HYBCompleter.h"
 #include "server/CustomScorer.h"
 
@@ -136,21 +139,26 @@ void HybCompleter<MODE>::processBasicQuery
                                  ? wordRange.lastElement() + 1 == (WordId)(CompleterBase<MODE>::_metaInfo->getNofWords())
                                  : wordRange.lastElement() + 1 == _boundaryWordIds[lastBlockId + 1];
 
+  // If there is a materialised list for this word range, process it instead
+  // of the blocks, like a single block.
+  int hotListId = findHotList(wordRange, firstBlockId, lastBlockId);
+  if (hotListId >= 0) lastBlockId = firstBlockId;
+
+  // If the list has a bitmap and the intersection only outputs the postings
+  // in the docs of the input list (no positions), fetch only these.
+  bool hotListForInputDocs = hotListId >= 0
+    && globalHotLists->hasBitmap(hotListId)
+    && inputList.isFullResult() == false
+    && separator.hasInfiniteIntersectionWindow()
+    && separator.getOutputMode() == Separator::OUTPUT_MATCHES
+    && !((MODE & WITH_POS) && CompleterBase<MODE>::_positionsNeeded);
+
   // 2. Process query for each of these blocks; note that intersect appends
   QueryResult currentBlock;
   for (BlockId currentBlockId = firstBlockId; currentBlockId <= lastBlockId; currentBlockId++)
   {
     // Check if the query processing took to long and abort if necessary.
-    off_t totalProcessingTimeInMsecs =
-        CompleterBase<MODE>::getTotalProcessingTimeInUsecs() / 1000.0;
-    if (totalProcessingTimeInMsecs >= queryTimeout)
-    {
-      CompleterBase<MODE>::statusCode = 413;
-      ostringstream os;
-      os << "time elapsed: " << totalProcessingTimeInMsecs << " msecs > "
-         << queryTimeout << " msecs";
-      CS_THROW(Exception::QUERY_TIMEOUT, os.str());
-    }
+    checkQueryTimeout();
 
     // In some cases all word ids are in range and need not be checked by intersection
     bool allWordIdsFromBlockInRange =
@@ -166,7 +174,10 @@ void HybCompleter<MODE>::processBasicQuery
 
     // Get block (must clear result from previous round, otherwise getDataForBlockId will throw exception)
     currentBlock.clear();
-    getDataForBlockId(currentBlockId, currentBlock);
+    if (hotListForInputDocs)
+      getDataForHotList(hotListId, inputList._docIds, currentBlock);
+    else if (hotListId >= 0) getDataForHotList(hotListId, currentBlock);
+    else getDataForBlockId(currentBlockId, currentBlock);
 
     // Process query for this block; Note: will append to resultList
     //
@@ -205,7 +216,8 @@ void HybCompleter<MODE>::processBasicQuery
         {
           resultListDocIds .push_back(currentBlockDocIds[i]);
           resultListWordIds.push_back(currentBlockWordIds[i]);
-          if (MODE & WITH_POS)    resultListPositions.push_back(currentBlockPositions[i]);
+          if ((MODE & WITH_POS) && currentBlock.hasPositions())
+            resultListPositions.push_back(currentBlockPositions[i]);
           if (MODE & WITH_SCORES) resultListScores   .push_back(currentBlockScores[i] +
               (currentBlockWordIds[i] == CompleterBase<MODE>::_lastBestMatchWordId ? BEST_MATCH_BONUS : 0));
         }
@@ -271,6 +283,102 @@ void HybCompleter<MODE>::processBasicQuery
 }
 
 
+// _____________________________________________________________________________
+template<unsigned char MODE>
+int HybCompleter<MODE>::findHotList(const WordRange& wordRange,
+                                    BlockId firstBlockId,
+                                    BlockId lastBlockId) const
+{
+  if (globalHotLists == NULL) return -1;
+  int hotListId = globalHotLists->find(wordRange.firstElement(),
+                                       wordRange.lastElement());
+  if (hotListId >= 0 && lastBlockId == firstBlockId
+      && !globalHotLists->hasBitmap(hotListId)) return -1;
+  return hotListId;
+}
+
+
+// _____________________________________________________________________________
+template<unsigned char MODE>
+void HybCompleter<MODE>::checkQueryTimeout()
+{
+  off_t totalProcessingTimeInMsecs =
+      CompleterBase<MODE>::getTotalProcessingTimeInUsecs() / 1000.0;
+  if (totalProcessingTimeInMsecs >= queryTimeout)
+  {
+    CompleterBase<MODE>::statusCode = 413;
+    ostringstream os;
+    os << "time elapsed: " << totalProcessingTimeInMsecs << " msecs > "
+       << queryTimeout << " msecs";
+    CS_THROW(Exception::QUERY_TIMEOUT, os.str());
+  }
+}
+
+
+//! Count the postings of a basic query without writing them
+/*!
+ *    Like processBasicQuery, but each block (or the hot list) is counted as
+ *    it is read, as its own segment of the counter (the word ids of the
+ *    blocks are disjoint), so that neither the result postings nor their
+ *    sorting across blocks are needed.
+ */
+template<unsigned char MODE>
+void HybCompleter<MODE>::countBasicQuery
+      (const QueryResult&       inputList,
+       const WordRange&         wordRange,
+       const Separator&         separator,
+             CompletionCounter* counter,
+             CompletionCounts*  counts)
+{
+  LOG << AT_BEGINNING_OF_METHOD << "; separator is " << separator.infoString() << endl;
+  CS_ASSERT(wordRange.isEmptyRange() == false);
+  BlockId firstBlockId;
+  BlockId lastBlockId;
+  blockRangeForNonEmptyWordRange(wordRange, firstBlockId, lastBlockId);
+  CS_ASSERT(lastBlockId >= firstBlockId);
+  bool isFullInput = inputList.isFullResult();
+  QueryResult currentBlock;
+
+  // A materialised list is a single segment; with a bitmap, only the
+  // postings in the docs of the input are fetched.
+  int hotListId = findHotList(wordRange, firstBlockId, lastBlockId);
+  if (hotListId >= 0)
+  {
+    checkQueryTimeout();
+    if (globalHotLists->hasBitmap(hotListId) && !isFullInput)
+      getDataForHotList(hotListId, inputList._docIds, currentBlock);
+    else getDataForHotList(hotListId, currentBlock);
+    counter->beginSegment(wordRange.firstElement(), wordRange.lastElement());
+    if (isFullInput)
+      counter->addAll(currentBlock, CompleterBase<MODE>::_lastBestMatchWordId,
+                      BEST_MATCH_BONUS);
+    else counter->intersect(inputList._docIds, currentBlock);
+    counter->endSegment(counts);
+    return;
+  }
+
+  // Otherwise one segment per block: the part of the word range in it.
+  WordId nofWords = CompleterBase<MODE>::_metaInfo->getNofWords();
+  for (BlockId blockId = firstBlockId; blockId <= lastBlockId; blockId++)
+  {
+    checkQueryTimeout();
+    WordId firstWordId = MAX(wordRange.firstElement(), _boundaryWordIds[blockId]);
+    WordId lastWordId = blockId + 1 < _boundaryWordIds.size()
+                          ? _boundaryWordIds[blockId + 1] - 1 : nofWords - 1;
+    lastWordId = MIN(lastWordId, wordRange.lastElement());
+    if (firstWordId > lastWordId) continue;
+    currentBlock.clear();
+    getDataForBlockId(blockId, currentBlock);
+    counter->beginSegment(firstWordId, lastWordId);
+    if (isFullInput)
+      counter->addAll(currentBlock, CompleterBase<MODE>::_lastBestMatchWordId,
+                      BEST_MATCH_BONUS);
+    else counter->intersect(inputList._docIds, currentBlock);
+    counter->endSegment(counts);
+  }
+}
+
+
 //! Process basic prefix completion query; OLD CODE BY INGMAR
 /*
 template<unsigned char MODE>
@@ -323,10 +431,6 @@ void HybCompleter<MODE>::allMatchesForWordRangeAndCandidates
     LOG << "! using last prefix from history ... " << flush;
     #endif
 
-    if (listsForPrefixFromHistory->isLockedForWriting)
-      CS_THROW(Exception::RESULT_LOCKED_FOR_WRITING, "");
-    listsForPrefixFromHistory->isLockedForReading = true;
-
     if(!listsForPrefixFromHistory->check()) CS_THROW(Exception::BAD_QUERY_RESULT, "");
     if (MODE & WITH_SCORES) assert(candidateLists._scores.size() == candidateLists._docIds.size());
     if (MODE & WITH_POS)    assert(candidateLists._positions.size() == candidateLists._docIds.size());
@@ -763,15 +867,74 @@ void HybCompleter<MODE>::getDataForBlockId(BlockId blockId, QueryResult& block)
   // Block must be empty
   CS_ASSERT(block.isEmpty());
 
-  // Use Ingmar's old method to fetch the individual lists, with scores of type DiskScore
+  // Use Ingmar's old method to fetch the individual lists, with scores of type
+  // DiskScore. Positions only if the current query needs them.
   Vector<DiskScore> diskScores;
-  Vector<Score>& scores = block._scores;
-  const WordList& wordIds = block._wordIdsOriginal;
   getDataForBlockId(blockId,
                     block._docIds,
                     block._positions,
                     diskScores,
-                    block._wordIdsOriginal);
+                    block._wordIdsOriginal,
+                    CompleterBase<MODE>::_positionsNeeded);
+  setScoresFromDiskScores(diskScores, block);
+}
+
+
+//! Get materialised list from globalHotLists; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::getDataForHotList(int listId, QueryResult& block)
+{
+  CS_ASSERT(block.isEmpty());
+  CS_ASSERT(globalHotLists != NULL);
+  Vector<DiskScore> diskScores;
+  CompleterBase<MODE>::doclistDecompressionTimer.cont();
+  globalHotLists->get(listId,
+                      &block._docIds,
+                      &block._positions,
+                      &block._wordIdsOriginal,
+                      &diskScores,
+                      (MODE & WITH_POS) && CompleterBase<MODE>::_positionsNeeded);
+  CompleterBase<MODE>::doclistDecompressionTimer.stop();
+  LOG << IF_VERBOSITY_HIGH << "! Used hot list for word range ["
+      << globalHotLists->getFirstWordId(listId) << ", "
+      << globalHotLists->getLastWordId(listId) << "], "
+      << commaStr(block._docIds.size()) << " index items" << endl;
+  setScoresFromDiskScores(diskScores, block);
+}
+
+
+//! Get materialised list from globalHotLists, in given docs; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::getDataForHotList(int listId, const DocList& docIds,
+                                           QueryResult& block)
+{
+  CS_ASSERT(block.isEmpty());
+  CS_ASSERT(globalHotLists != NULL);
+  Vector<DiskScore> diskScores;
+  CompleterBase<MODE>::intersectionTimer.cont();
+  globalHotLists->getForDocs(listId,
+                             docIds,
+                             &block._docIds,
+                             &block._wordIdsOriginal,
+                             &diskScores);
+  CompleterBase<MODE>::intersectionTimer.stop();
+  LOG << IF_VERBOSITY_HIGH << "! Used bitmap of hot list for word range ["
+      << globalHotLists->getFirstWordId(listId) << ", "
+      << globalHotLists->getLastWordId(listId) << "], "
+      << commaStr(block._docIds.size()) << " of "
+      << commaStr(globalHotLists->getBitmap(listId).count())
+      << " index items in " << commaStr(docIds.size()) << " input items" << endl;
+  setScoresFromDiskScores(diskScores, block);
+}
+
+
+//! Set scores from disk scores; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::setScoresFromDiskScores
+      (const Vector<DiskScore>& diskScores, QueryResult& block)
+{
+  Vector<Score>& scores = block._scores;
+  const WordList& wordIds = block._wordIdsOriginal;
 
   // Copy list of disk scores (1 byte each) to list of block scores (4 bytes each)
   CompleterBase<MODE>::resizeAndReserveTimer.cont();
@@ -824,7 +987,8 @@ void HybCompleter<MODE>::getDataForBlockId
        DocList&           doclist,
        Vector<Position>&  positionlist,
        Vector<DiskScore>& scorelist,
-       WordList&          wordlist)
+       WordList&          wordlist,
+       bool               decodePositions)
 {
   // + 2 here because:
   //   the last but one byte offset points to the boundary word IDs vector
@@ -861,6 +1025,9 @@ void HybCompleter<MODE>::getDataForBlockId
   if(MODE & WITH_SCORES) { CompleterBase<MODE>::_indexStructureFile.read(&offsetForScorelist,sizeof(off_t));}
   if(!(MODE & WITH_POS)) { assert(offsetForPositionlist ==2);offsetForPositionlist=offsetForWordlist;}
   else {assert(offsetForWordlist > offsetForPositionlist); }
+  if (!(MODE & WITH_POS)) decodePositions = false;
+  if ((MODE & WITH_POS) && !decodePositions)
+    CompleterBase<MODE>::volumeReadFromFile -= offsetForWordlist - offsetForPositionlist;
 
   //
   // R.1 Read list of compressed doc ids (will be uncompressed later)
@@ -893,7 +1060,7 @@ void HybCompleter<MODE>::getDataForBlockId
   // R.2 Read list of compressed positions (optional)
   //
 
-  if (MODE & WITH_POS)
+  if (decodePositions)
   {
     assert(offsetForPositionlist + (off_t) sizeof(unsigned long int) < offsetForWordlist);
     // Read number of positions; check that equal to the number of doc ids
@@ -922,7 +1089,14 @@ void HybCompleter<MODE>::getDataForBlockId
   // R.3 Read list of compressed word ids
   //
 
-  CompleterBase<MODE>::_indexStructureFile.read(&nofWordsInCompressedList,sizeof(unsigned long int));
+  // If the positions were skipped, seek to the word ids.
+  if ((MODE & WITH_POS) && !decodePositions)
+    CompleterBase<MODE>::_indexStructureFile.read(&nofWordsInCompressedList,
+                                                  sizeof(unsigned long int),
+                                                  offsetForWordlist);
+  else
+    CompleterBase<MODE>::_indexStructureFile.read(&nofWordsInCompressedList,
+                                                  sizeof(unsigned long int));
   assert(nofDocsInCompressedList == nofWordsInCompressedList);
   assert(offsetForDoclist + (off_t) sizeof(unsigned long int) < offsetForWordlist);
   if (MODE & WITH_SCORES)
@@ -1034,7 +1208,11 @@ void HybCompleter<MODE>::getDataForBlockId
   // D.2 Decompress list of positions
   //
 
-  if (MODE & WITH_POS)
+  if (!decodePositions)
+  {
+    positionlist.clear();
+  }
+  else if (MODE & WITH_POS)
   {
     assert(nofPositionsInCompressedList == nofDocsInCompressedList);
     positionlist.resize(nofPositionsInCompressedList);
@@ -1123,6 +1301,139 @@ void HybCompleter<MODE>::getDataForBlockId
 //end: getDataForBlockId
 
 
+//! Split word ids into runs of consecutive blocks; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::wordRangesForWordIds
+      (const vector<uint32_t>&  wordIds,
+             vector<WordRange>* wordRanges) const
+{
+  wordRanges->clear();
+  BlockId lastBlockId = 0;
+  for (size_t i = 0; i < wordIds.size(); i++)
+  {
+    // The block of the word: the last one that starts at or before it.
+    BlockId blockId = std::upper_bound(_boundaryWordIds.begin(),
+                                       _boundaryWordIds.end(),
+                                       WordId(wordIds[i]))
+                      - _boundaryWordIds.begin() - 1;
+    if (wordRanges->empty() || blockId > lastBlockId + 1)
+      wordRanges->push_back(WordRange(wordIds[i], wordIds[i]));
+    else
+      wordRanges->back() = WordRange(wordRanges->back().firstElement(),
+                                     wordIds[i]);
+    lastBlockId = blockId;
+  }
+}
+
+
+//! Merge postings of blocks for hot list; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::getHotList(const WordRange& wordRange, QueryResult& list)
+{
+  BlockId firstBlockId;
+  BlockId lastBlockId;
+  blockRangeForNonEmptyWordRange(wordRange, firstBlockId, lastBlockId);
+  for (BlockId blockId = firstBlockId; blockId <= lastBlockId; blockId++)
+  {
+    DocList docIds;
+    Vector<Position> positions;
+    Vector<DiskScore> scores;
+    WordList wordIds;
+    getDataForBlockId(blockId, docIds, positions, scores, wordIds, true);
+    for (size_t j = 0; j < docIds.size(); j++)
+    {
+      if (!wordRange.isInRange(wordIds[j])) continue;
+      list._docIds.push_back(docIds[j]);
+      list._wordIdsOriginal.push_back(wordIds[j]);
+      if (MODE & WITH_POS) list._positions.push_back(positions[j]);
+      list._scores.push_back(MODE & WITH_SCORES ? scores[j] : 0);
+    }
+  }
+  if (firstBlockId < lastBlockId) list.sortLists();
+}
+
+
+//! Materialise posting lists for hot prefixes; see HYBCompleter.h
+template<unsigned char MODE>
+void HybCompleter<MODE>::writeHotLists
+      (const vector<pair<string, size_t> >& prefixes,
+       size_t                              maxNofLists,
+       const string&                       fileName)
+{
+  // 1. Compute the word range and the cost of each prefix. Prefixes with the
+  // same word range add up.
+  map<pair<WordId, WordId>, size_t> costs;
+  for (size_t i = 0; i < prefixes.size(); i++)
+  {
+    bool notIntersectionMode;
+    WordRange wordRange = CompleterBase<MODE>::prefixToRange(prefixes[i].first,
+                                                             notIntersectionMode);
+    if (wordRange.isEmptyRange()
+        || wordRange.firstElement() > wordRange.lastElement()) continue;
+    BlockId firstBlockId;
+    BlockId lastBlockId;
+    blockRangeForNonEmptyWordRange(wordRange, firstBlockId, lastBlockId);
+    costs[make_pair(wordRange.firstElement(), wordRange.lastElement())]
+      += prefixes[i].second * (lastBlockId - firstBlockId + 1);
+  }
+
+  // 2. Take the most costly ranges, in order of word range. A range within one
+  // block is only taken if its list is dense (and hence gets a bitmap).
+  vector<pair<size_t, pair<WordId, WordId> > > ranges;
+  for (map<pair<WordId, WordId>, size_t>::const_iterator it = costs.begin();
+       it != costs.end(); ++it)
+    ranges.push_back(make_pair(it->second, it->first));
+  sort(ranges.begin(), ranges.end(), greater<pair<size_t, pair<WordId, WordId> > >());
+  vector<pair<WordId, WordId> > wordRanges;
+  for (size_t i = 0; i < ranges.size() && wordRanges.size() < maxNofLists; i++)
+  {
+    WordRange wordRange(ranges[i].second.first, ranges[i].second.second);
+    BlockId firstBlockId;
+    BlockId lastBlockId;
+    blockRangeForNonEmptyWordRange(wordRange, firstBlockId, lastBlockId);
+    if (lastBlockId == firstBlockId)
+    {
+      QueryResult list;
+      getHotList(wordRange, list);
+      if (!DocIdBitmap::isDense(list._docIds)) continue;
+    }
+    wordRanges.push_back(ranges[i].second);
+  }
+  sort(wordRanges.begin(), wordRanges.end());
+
+  // 3. For each range, read its blocks and merge the postings in range.
+  HotLists hotLists;
+  for (size_t i = 0; i < wordRanges.size(); i++)
+  {
+    WordRange wordRange(wordRanges[i].first, wordRanges[i].second);
+    BlockId firstBlockId;
+    BlockId lastBlockId;
+    blockRangeForNonEmptyWordRange(wordRange, firstBlockId, lastBlockId);
+    QueryResult list;
+    Vector<DiskScore> diskScores;
+    getHotList(wordRange, list);
+    if (list._docIds.size() == 0) continue;
+    diskScores.resize(list._scores.size());
+    for (size_t j = 0; j < list._scores.size(); j++)
+      diskScores[j] = list._scores[j];
+    hotLists.add(wordRange.firstElement(), wordRange.lastElement(),
+                 list._docIds, list._positions, list._wordIdsOriginal,
+                 diskScores);
+    cout << "* hot list for \"" << this->getWordFromVocabulary(wordRange.firstElement())
+         << "\" - \"" << this->getWordFromVocabulary(wordRange.lastElement())
+         << "\": " << commaStr(list._docIds.size()) << " postings from "
+         << (lastBlockId - firstBlockId + 1) << " blocks"
+         << (hotLists.hasBitmap(hotLists.getNofLists() - 1) ? " (bitmap)" : "")
+         << endl;
+  }
+  hotLists.write(fileName, CompleterBase<MODE>::_vocabulary->size());
+  cout << "* wrote " << hotLists.getNofLists() << " hot lists with "
+       << commaStr(hotLists.getNofPostings()) << " postings ("
+       << commaStr(hotLists.getSizeInBytes() / 1024) << " KB) to \""
+       << fileName << "\"" << endl;
+}
+
+
 
 
 
@@ -16,6 +16,7 @@
 #include "TrivialCompressionAlgorithm.h"
 #include "Vector.h"
 #include "HYBIndex.h"
+#include "HotLists.h"
 
 #include "../fuzzysearch/FuzzySearcher.h"
 
@@ -103,6 +104,33 @@ class HybCompleter : public CompleterBase<MODE>
          const Separator&   separator);
 
 
+  //! Count the postings of the given word range in the docs of the given input
+  //! list, block by block (see CompleterBase::countBasicQuery)
+  void countBasicQuery
+        (const QueryResult&       inputList,
+         const WordRange&         wordRange,
+         const Separator&         separator,
+               CompletionCounter* counter,
+               CompletionCounts*  counts);
+
+  //! One word range per run of consecutive blocks with any of the given word
+  //! ids, from the first to the last of them in the run (see
+  //! CompleterBase::wordRangesForWordIds).
+  void wordRangesForWordIds
+        (const vector<uint32_t>&  wordIds,
+               vector<WordRange>* wordRanges) const;
+
+  //! The id of the materialised list (see HotLists.h) to process instead of
+  //! the given blocks for the given word range, or -1. It has the postings of
+  //! all words in the range, already sorted by doc id. For a range within one
+  //! block, only a list with a bitmap is worth it.
+  int findHotList(const WordRange& wordRange, BlockId firstBlockId,
+                  BlockId lastBlockId) const;
+
+  //! Throw an exception (and set status code 413) if the query processing
+  //! took longer than queryTimeout.
+  void checkQueryTimeout();
+
   //! Process basic prefix completion query; OLD IMPLEMENTATION BY INGMAR
   /*
   void allMatchesForWordRangeAndCandidates
@@ -137,19 +165,50 @@ class HybCompleter : public CompleterBase<MODE>
    *    is really efficient.
    */
   void getDataForBlockId(BlockId blockId, QueryResult& block);
+
+  //! Get the materialised list with the given id from globalHotLists (see
+  //! HotLists.h), like getDataForBlockId above.
+  void getDataForHotList(int listId, QueryResult& block);
+
+  //! The same, but only the postings in the given docs (without positions),
+  //! from a list with a bitmap.
+  void getDataForHotList(int listId, const DocList& docIds, QueryResult& block);
+
+  //! Set the scores of the given block from the given disk scores (or from the
+  //! custom scorer, if there is one).
+  void setScoresFromDiskScores(const Vector<DiskScore>& diskScores,
+                               QueryResult& block);
   
   //! Read block with given id from disk (doc ids, word ids, positions, scores)
+  //! If decodePositions is false, the positions are neither read nor
+  //! decompressed and positionlist is left empty.
   void getDataForBlockId(BlockId blockId, 
 			 DocList& doclist, 
 			 Vector<Position>& positionlist, 
 			 Vector<DiskScore>& scorelist, 
-			 WordList& wordlist);
+			 WordList& wordlist,
+			 bool decodePositions = true);
 
  public:
 
     //! Get offsets of blocks in index file (needed by Holger for test-compression)
     const vector<off_t>& getByteOffsetsForBlocks() { return _byteOffsetsForBlocks; } 
 
+    //! Materialise the posting lists for the given prefixes (e.g. "a*"), with
+    //! the given counts, and write them to the given file (see HotLists.h).
+    //! The cost of a prefix is its count times the number of blocks read for
+    //! it; the at most maxNofLists most costly ones are written. Prefixes with
+    //! an empty word range are skipped, and so are ranges within one block
+    //! (their block is as cheap to read as a hot list) unless their list is
+    //! dense and gets a bitmap.
+    void writeHotLists(const vector<pair<string, size_t> >& prefixes,
+                       size_t maxNofLists, const string& fileName);
+
+    //! Read the blocks of the given word range and merge its postings, sorted
+    //! by doc id, exactly like processBasicQuery does for the full list
+    //! (without a custom scorer).
+    void getHotList(const WordRange& wordRange, QueryResult& list);
+
     //! Print size (number of postings) of block with given id (for debugging)
     void printListLengthForBlockId(BlockId blockId);
 
@@ -1,4 +1,7 @@
 #include "HYBIndex.h"
+#include <deque>
+#include <map>
+#include <memory>
 #include "../synonymsearch/SynonymDictionary.h"
 
 // HACK(bast): Define stuff for fuzzy search and synonym search here. If
@@ -29,72 +32,87 @@ void HYBIndex::showMetaInfo() const
   _metaInfo.show();
 }
 
-void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock, 
-                                  WordList& wordlistForCurrentBlock, 
-                                  Vector<DiskScore>& scorelistForCurrentBlock, 
-                                  Vector<Position>& positionlistForCurrentBlock, 
-                                  BlockId currentBlock,
-                                  File& indexStructureFile)
+#define NUMBER_OF_LISTS_PER_BLOCK ( 2 + ((MODE & WITH_POS) ? (1) : (0)) + ((MODE & WITH_SCORES) ? (1) : (0)) )
+
+HYBIndex::Block::Block(BlockId id)
+  : id(id), compressedDoclistSize(0), compressedPositionlistSize(0),
+    compressedWordlistSize(0), sortUsecs(0), doclistCompressionUsecs(0),
+    positionlistCompressionUsecs(0), wordlistCompressionUsecs(0)
+{
+}
+
+void HYBIndex::Block::swapLists(DocList& doclist, WordList& wordlist,
+                                Vector<DiskScore>& scorelist,
+                                Vector<Position>& positionlist)
+{
+  this->doclist.swap(doclist);
+  this->wordlist.swap(wordlist);
+  this->scorelist.swap(scorelist);
+  this->positionlist.swap(positionlist);
+}
+
+void HYBIndex::compressBlock(Block* block) const
 {
-  #define NUMBER_OF_LISTS_PER_BLOCK ( 2 + ((MODE & WITH_POS) ? (1) : (0)) + ((MODE & WITH_SCORES) ? (1) : (0)) )
   #define SIZE_COMPRESSION_BUFFER_FOR_POSITIONS ((MODE & WITH_POS) ? \
-              (2*sizeof(Position)*MAX(_positionlistCompressionAlgorithm.getIncreaseFactor()*positionlistForCurrentBlock.size(),1000)) : (0))
+              (2*sizeof(Position)*MAX(_positionlistCompressionAlgorithm.getIncreaseFactor()*positionlist.size(),1000)) : (0))
   // Scores are currently NOT compressed
+  DocList& doclist = block->doclist;
+  WordList& wordlist = block->wordlist;
+  Vector<DiskScore>& scorelist = block->scorelist;
+  Vector<Position>& positionlist = block->positionlist;
+  Timer timer;
 
   assert((!(MODE & WITH_POS)) || (MODE & WITH_DUPS));
-  assert(((!(MODE & WITH_POS ))&& (positionlistForCurrentBlock.size()==0 )) || ((MODE & WITH_POS) && (positionlistForCurrentBlock.size()==doclistForCurrentBlock.size()) ));
-  assert(((!(MODE & WITH_SCORES ))&& (scorelistForCurrentBlock.size()==0 )) || ((MODE & WITH_SCORES) && (scorelistForCurrentBlock.size()==doclistForCurrentBlock.size()) ));
-  assert((!(MODE & WITH_SCORES ))|| (scorelistForCurrentBlock.isPositive() ));
+  assert(((!(MODE & WITH_POS ))&& (positionlist.size()==0 )) || ((MODE & WITH_POS) && (positionlist.size()==doclist.size()) ));
+  assert(((!(MODE & WITH_SCORES ))&& (scorelist.size()==0 )) || ((MODE & WITH_SCORES) && (scorelist.size()==doclist.size()) ));
+  assert((!(MODE & WITH_SCORES ))|| (scorelist.isPositive() ));
   // SORT THE WORD-DOC PAIRS BY DOC ID 
-  sortTimer.cont(); 
+  timer.start();
 
-  if((!(MODE & WITH_POS)) && (!(MODE & WITH_SCORES ))) {doclistForCurrentBlock.sortParallel(wordlistForCurrentBlock);}
-  else if ((MODE & WITH_POS ) && (!(MODE & WITH_SCORES))) {doclistForCurrentBlock.sortParallel(positionlistForCurrentBlock, wordlistForCurrentBlock);}
-  else if ((!(MODE & WITH_POS)) && (MODE & WITH_SCORES)) {doclistForCurrentBlock.sortParallel(scorelistForCurrentBlock, wordlistForCurrentBlock);}
+  if((!(MODE & WITH_POS)) && (!(MODE & WITH_SCORES ))) {doclist.sortParallel(wordlist);}
+  else if ((MODE & WITH_POS ) && (!(MODE & WITH_SCORES))) {doclist.sortParallel(positionlist, wordlist);}
+  else if ((!(MODE & WITH_POS)) && (MODE & WITH_SCORES)) {doclist.sortParallel(scorelist, wordlist);}
   else {
     assert((MODE & WITH_POS) && (MODE & WITH_SCORES));
-    doclistForCurrentBlock.sortParallel(positionlistForCurrentBlock, wordlistForCurrentBlock, scorelistForCurrentBlock);
-    assert(((!(MODE & WITH_SCORES ))&& (scorelistForCurrentBlock.size()==0 )) || ((MODE & WITH_SCORES) && (scorelistForCurrentBlock.size()==doclistForCurrentBlock.size()) ));
-    assert((!(MODE & WITH_SCORES ))|| (scorelistForCurrentBlock.isPositive() ));
+    doclist.sortParallel(positionlist, wordlist, scorelist);
+    assert(((!(MODE & WITH_SCORES ))&& (scorelist.size()==0 )) || ((MODE & WITH_SCORES) && (scorelist.size()==doclist.size()) ));
+    assert((!(MODE & WITH_SCORES ))|| (scorelist.isPositive() ));
   }
-  sortTimer.stop();
+  timer.stop();
+  block->sortUsecs = timer.usecs();
 
 
- // RESIZE COMPRESSION LIST IF APPROPRIATE
-  if( sizeof(DocId)*(MAX(doclistForCurrentBlock.size()*_doclistCompressionAlgorithm.getIncreaseFactor(),1000))        \
-      + wordlistForCurrentBlock.size()*sizeof(WordId)*_wordlistCompressionAlgorithm.getIncreaseFactor()   \
-      +  SIZE_COMPRESSION_BUFFER_FOR_POSITIONS >    compressionBufferSize() )
-    { resizeCompressionBuffer( (unsigned long) ceil(1.3*( sizeof(DocId)*(MAX(doclistForCurrentBlock.size()*_doclistCompressionAlgorithm.getIncreaseFactor(),1000))        \
-                             + wordlistForCurrentBlock.size()*sizeof(WordId)*_wordlistCompressionAlgorithm.getIncreaseFactor()   \
-                             + SIZE_COMPRESSION_BUFFER_FOR_POSITIONS) ));}
+ // RESERVE THE COMPRESSION BUFFER OF THIS BLOCK
+  block->compressed.resize( (unsigned long) ceil(1.3*( sizeof(DocId)*(MAX(doclist.size()*_doclistCompressionAlgorithm.getIncreaseFactor(),1000))        \
+                             + wordlist.size()*sizeof(WordId)*_wordlistCompressionAlgorithm.getIncreaseFactor()   \
+                             + SIZE_COMPRESSION_BUFFER_FOR_POSITIONS) ));
+  char* compressionBuffer = &block->compressed[0];
 
  // COMPRESS DOC LIST
-  doclistCompressionTimer.cont();
-
-  //  const size_t compressedDoclistSize = 0;
-  const size_t compressedDoclistSize = _doclistCompressionAlgorithm.compress(doclistForCurrentBlock, _compressionBuffer);
+  timer.start();
+  const size_t compressedDoclistSize = _doclistCompressionAlgorithm.compress(doclist, compressionBuffer);
   assert(compressedDoclistSize > 0);
-  doclistCompressionTimer.stop();
-  doclistVolumeCompressed += compressedDoclistSize;
+  timer.stop();
+  block->doclistCompressionUsecs = timer.usecs();
 
  // COMPRESS POSITION LIST
   size_t compressedPositionlistSize = 0;
   if(MODE & WITH_POS) {
-    positionlistCompressionTimer.cont();
+    timer.start();
     compressedPositionlistSize  = _positionlistCompressionAlgorithm.                                         \
-    compress(positionlistForCurrentBlock, _compressionBuffer +compressedDoclistSize,2);//2 indicates: gaps with boundaries
+    compress(positionlist, compressionBuffer +compressedDoclistSize,2);//2 indicates: gaps with boundaries
     assert(compressedPositionlistSize > 0);
-    positionlistCompressionTimer.stop();
-    positionlistVolumeCompressed += compressedPositionlistSize;}
+    timer.stop();
+    block->positionlistCompressionUsecs = timer.usecs();}
 
   // DECOMPRESS DOC LIST FOR ERROR CHECKING ONLY
  #ifndef NDEBUG
   DocList uncompressedDocs;
-  uncompressedDocs.resize(doclistForCurrentBlock.size());
-  _doclistCompressionAlgorithm.decompress(_compressionBuffer,&uncompressedDocs[0],doclistForCurrentBlock.size());
-     for(unsigned int i=0;i<doclistForCurrentBlock.size();i++)
+  uncompressedDocs.resize(doclist.size());
+  _doclistCompressionAlgorithm.decompress(compressionBuffer,&uncompressedDocs[0],doclist.size());
+     for(unsigned int i=0;i<doclist.size();i++)
        {
-         assert(uncompressedDocs[i] == doclistForCurrentBlock[i]);
+         assert(uncompressedDocs[i] == doclist[i]);
        }
   #endif
 
@@ -103,14 +121,13 @@ void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock,
  #ifndef NDEBUG
  if(MODE & WITH_POS)
    {
-     assert(positionlistForCurrentBlock.size() > 0);
+     assert(positionlist.size() > 0);
      Vector<Position> uncompressedPositions;
-     uncompressedPositions.resize(positionlistForCurrentBlock.size());
-     ////     assert(*((unsigned long*) (CompleterBase<MODE>::_compressionBuffer + compressedDoclistSize  )) > positionlistForCurrentBlock.size()  ); // only hols for simple9 with gaps==2 and non-trivial list
-     _positionlistCompressionAlgorithm.decompress(_compressionBuffer + compressedDoclistSize,&uncompressedPositions[0],positionlistForCurrentBlock.size() ,2);//2 indicates: gaps with artificial boundaries
-     for(unsigned int i=0;i<positionlistForCurrentBlock.size();i++)
+     uncompressedPositions.resize(positionlist.size());
+     _positionlistCompressionAlgorithm.decompress(compressionBuffer + compressedDoclistSize,&uncompressedPositions[0],positionlist.size() ,2);//2 indicates: gaps with artificial boundaries
+     for(unsigned int i=0;i<positionlist.size();i++)
        {
-         assert(uncompressedPositions[i] == positionlistForCurrentBlock[i]);
+         assert(uncompressedPositions[i] == positionlist[i]);
        }
    }
   #endif
@@ -118,29 +135,56 @@ void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock,
 
   // COMPRESS WORD LIST
   #ifndef NDEBUG
-  for(unsigned int i=0; i<wordlistForCurrentBlock.size();i++) {assert((currentBlock==0)||(wordlistForCurrentBlock[i]>0));}
+  for(unsigned int i=0; i<wordlist.size();i++) {assert((block->id==0)||(wordlist[i]>0));}
   #endif
-  wordlistCompressionTimer.cont();
+  timer.start();
   const size_t compressedWordlistSize                                                                                               \
    = _wordlistCompressionAlgorithm.                                                                                                \
-       compress(wordlistForCurrentBlock,_compressionBuffer + compressedDoclistSize+compressedPositionlistSize);
+       compress(wordlist,compressionBuffer + compressedDoclistSize+compressedPositionlistSize);
   assert(compressedWordlistSize > 0);
-  assert(compressedDoclistSize + compressedPositionlistSize + compressedWordlistSize <= compressionBufferSize());
-  wordlistCompressionTimer.stop();
-  wordlistVolumeCompressed += compressedWordlistSize;
+  assert(compressedDoclistSize + compressedPositionlistSize + compressedWordlistSize <= block->compressed.size());
+  timer.stop();
+  block->wordlistCompressionUsecs = timer.usecs();
 
   // DECOMPRESS WORD LIST FOR ERROR CHECKING ONLY
   #ifndef NDEBUG
   WordList uncompressedWords;
-  uncompressedWords.resize(wordlistForCurrentBlock.size());
-  _wordlistCompressionAlgorithm.decompress(_compressionBuffer + compressedDoclistSize + compressedPositionlistSize,&uncompressedWords[0],wordlistForCurrentBlock.size());
-     for(unsigned int i=0;i<wordlistForCurrentBlock.size();i++)
+  uncompressedWords.resize(wordlist.size());
+  ZipfCompressionAlgorithm<WordId> wordlistCompressionAlgorithm(_wordlistCompressionAlgorithm);
+  wordlistCompressionAlgorithm.decompress(compressionBuffer + compressedDoclistSize + compressedPositionlistSize,&uncompressedWords[0],wordlist.size());
+     for(unsigned int i=0;i<wordlist.size();i++)
        {
-         assert(uncompressedWords[i] == wordlistForCurrentBlock[i]);
+         assert(uncompressedWords[i] == wordlist[i]);
        }
   #endif
 
-  const size_t scorelistSize = sizeof(DiskScore)*scorelistForCurrentBlock.size();
+  block->compressedDoclistSize = compressedDoclistSize;
+  block->compressedPositionlistSize = compressedPositionlistSize;
+  block->compressedWordlistSize = compressedWordlistSize;
+
+  #ifdef SIZE_COMPRESSION_BUFFER_FOR_POSITIONS
+  #undef SIZE_COMPRESSION_BUFFER_FOR_POSITIONS
+  #endif
+}
+
+void HYBIndex::writeCompressedBlock(const Block& block, File& indexStructureFile)
+{
+  const size_t compressedDoclistSize = block.compressedDoclistSize;
+  const size_t compressedPositionlistSize = block.compressedPositionlistSize;
+  const size_t compressedWordlistSize = block.compressedWordlistSize;
+  const char* compressionBuffer = &block.compressed[0];
+
+  // The timers add up the times of all blocks (if several threads compress
+  // blocks, the sum over all threads).
+  sortTimer.setUsecs(sortTimer.usecs() + block.sortUsecs);
+  doclistCompressionTimer.setUsecs(doclistCompressionTimer.usecs() + block.doclistCompressionUsecs);
+  positionlistCompressionTimer.setUsecs(positionlistCompressionTimer.usecs() + block.positionlistCompressionUsecs);
+  wordlistCompressionTimer.setUsecs(wordlistCompressionTimer.usecs() + block.wordlistCompressionUsecs);
+  doclistVolumeCompressed += compressedDoclistSize;
+  positionlistVolumeCompressed += compressedPositionlistSize;
+  wordlistVolumeCompressed += compressedWordlistSize;
+
+  const size_t scorelistSize = sizeof(DiskScore)*block.scorelist.size();
   assert(((MODE & WITH_SCORES) && (scorelistSize >0)) || ((!(MODE & WITH_SCORES)) && (scorelistSize == 0 )));
   scorelistVolumeWritten += scorelistSize;// in bytes 
 
@@ -161,10 +205,10 @@ void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock,
   assert(_byteOffsetsForBlocks[_byteOffsetsForBlocks.size()-1] > _byteOffsetsForBlocks[_byteOffsetsForBlocks.size()-2]);
 
   // the following four are identical. just clearer this way
-  const unsigned long int lengthOfCurrentDoclist  = (unsigned long int) doclistForCurrentBlock.size();
-  const unsigned long int lengthOfCurrentPositionlist = (unsigned long int) positionlistForCurrentBlock.size();
-  const unsigned long int lengthOfCurrentWordlist = (unsigned long int) wordlistForCurrentBlock.size();
-  const unsigned long int lengthOfCurrentScorelist = (unsigned long int) scorelistForCurrentBlock.size();
+  const unsigned long int lengthOfCurrentDoclist  = (unsigned long int) block.doclist.size();
+  const unsigned long int lengthOfCurrentPositionlist = (unsigned long int) block.positionlist.size();
+  const unsigned long int lengthOfCurrentWordlist = (unsigned long int) block.wordlist.size();
+  const unsigned long int lengthOfCurrentScorelist = (unsigned long int) block.scorelist.size();
 
   assert(lengthOfCurrentDoclist > 0);
   assert(lengthOfCurrentDoclist == lengthOfCurrentWordlist);
@@ -187,29 +231,46 @@ void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock,
   // WRITE DOCLIST
   assert(offsetForDoclist == indexStructureFile.tell());
   indexStructureFile.write(&lengthOfCurrentDoclist,sizeof(unsigned long int));
-  indexStructureFile.write(_compressionBuffer,compressedDoclistSize);
+  indexStructureFile.write(compressionBuffer,compressedDoclistSize);
   // WRITE POSITIONLIST
   if(MODE & WITH_POS)
     {
       assert(offsetForPositionlist == indexStructureFile.tell());
       assert(offsetForPositionlist == offsetForDoclist + (off_t) sizeof(unsigned long int) + (off_t) compressedDoclistSize);
       indexStructureFile.write(&lengthOfCurrentPositionlist,sizeof(unsigned long int));
-      indexStructureFile.write(_compressionBuffer+compressedDoclistSize,compressedPositionlistSize);
+      indexStructureFile.write(compressionBuffer+compressedDoclistSize,compressedPositionlistSize);
     }
   // WRITE WORDLIST
   assert(offsetForWordlist == indexStructureFile.tell());
   indexStructureFile.write(&lengthOfCurrentWordlist,sizeof(unsigned long int));
   assert((MODE & WITH_POS) || (compressedPositionlistSize == 0 ));
-  indexStructureFile.write(_compressionBuffer+compressedDoclistSize+compressedPositionlistSize,compressedWordlistSize);
+  indexStructureFile.write(compressionBuffer+compressedDoclistSize+compressedPositionlistSize,compressedWordlistSize);
   // WRITE SCORELIST
   if(MODE & WITH_SCORES)
     {
       assert(offsetForScorelist == indexStructureFile.tell());
       indexStructureFile.write(&lengthOfCurrentScorelist,sizeof(unsigned long int));
-      assert(scorelistForCurrentBlock.isContiguous());
-      indexStructureFile.write(&scorelistForCurrentBlock[0],scorelistSize);
+      assert(block.scorelist.isContiguous());
+      indexStructureFile.write(&block.scorelist[0],scorelistSize);
     }
   writeToDiskTimer.stop();
+}
+
+void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock, 
+                                  WordList& wordlistForCurrentBlock, 
+                                  Vector<DiskScore>& scorelistForCurrentBlock, 
+                                  Vector<Position>& positionlistForCurrentBlock, 
+                                  BlockId currentBlock,
+                                  File& indexStructureFile)
+{
+  Block block(currentBlock);
+  block.swapLists(doclistForCurrentBlock, wordlistForCurrentBlock,
+                  scorelistForCurrentBlock, positionlistForCurrentBlock);
+  compressBlock(&block);
+  writeCompressedBlock(block, indexStructureFile);
+  // Give the lists (and their memory) back to the caller.
+  block.swapLists(doclistForCurrentBlock, wordlistForCurrentBlock,
+                  scorelistForCurrentBlock, positionlistForCurrentBlock);
 
   // clear calls free  ->  memory fragmentation
   //doclistForCurrentBlock.clear();
@@ -221,12 +282,159 @@ void HYBIndex::writeCurrentBlockToIndexFile(DocList& doclistForCurrentBlock,
   wordlistForCurrentBlock.resize(0);
   positionlistForCurrentBlock.resize(0);//
   scorelistForCurrentBlock.resize(0);
+} // end: writeCurrentBlockToIndexFile(..)
 
-  #ifdef SIZE_COMPRESSION_BUFFER_FOR_POSITIONS
-  #undef SIZE_COMPRESSION_BUFFER_FOR_POSITIONS
-  #endif
+//! PIPELINE FOR BUILDING THE BLOCKS WITH SEVERAL THREADS
+/*
+ *   The thread calling HYBIndex::build reads the words file and submits the
+ *   blocks in order of their ids. Worker threads sort and compress them
+ *   independently (compressBlock), and a writer thread writes them to the index
+ *   file in the order of their ids (writeCompressedBlock), so that the index is
+ *   the same as the one built by a single thread.
+ *
+ *   At most twice as many blocks as there are workers are in the pipeline at
+ *   any time, the reader waits when this limit is reached.
+ */
+class HYBIndex::BuildPipeline
+{
+ public:
+  BuildPipeline(HYBIndex* index, File* indexStructureFile,
+                unsigned int nofWorkers);
+  ~BuildPipeline();
+
+  //! Hand the next block to the workers (takes ownership).
+  void submit(Block* block);
+
+  //! Wait until all submitted blocks are written.
+  void finish();
+
+ private:
+  static void* workerThreadFunction(void* pipeline);
+  static void* writerThreadFunction(void* pipeline);
+  void work();
+  void write();
+
+  HYBIndex* _index;
+  File* _indexStructureFile;
+  pthread_mutex_t _mutex;
+  //! Signalled whenever one of the members below changes.
+  pthread_cond_t _changed;
+  //! Blocks to be compressed, in order of their ids.
+  deque<Block*> _blocksToCompress;
+  //! Compressed blocks, which are not yet written.
+  map<BlockId, Block*> _blocksToWrite;
+  BlockId _nextBlockToWrite;
+  unsigned int _nofBlocksInPipeline;
+  unsigned int _maxNofBlocksInPipeline;
+  bool _noMoreBlocks;
+  vector<pthread_t> _workers;
+  pthread_t _writer;
+  bool _finished;
+};
+
+HYBIndex::BuildPipeline::BuildPipeline(HYBIndex* index,
+    File* indexStructureFile, unsigned int nofWorkers)
+  : _index(index), _indexStructureFile(indexStructureFile),
+    _nextBlockToWrite(0), _nofBlocksInPipeline(0),
+    _maxNofBlocksInPipeline(2 * nofWorkers), _noMoreBlocks(false),
+    _finished(false)
+{
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_changed, NULL);
+  _workers.resize(nofWorkers);
+  for (unsigned int i = 0; i < nofWorkers; i++)
+  {
+    if (pthread_create(&_workers[i], NULL, workerThreadFunction, this) != 0)
+      CS_THROW(Exception::COULD_NOT_CREATE_THREAD, strerror(errno));
+  }
+  if (pthread_create(&_writer, NULL, writerThreadFunction, this) != 0)
+    CS_THROW(Exception::COULD_NOT_CREATE_THREAD, strerror(errno));
+}
 
-  } // end: writeCurrentBlockToIndexFile(..)
+HYBIndex::BuildPipeline::~BuildPipeline()
+{
+  finish();
+  pthread_cond_destroy(&_changed);
+  pthread_mutex_destroy(&_mutex);
+}
+
+void HYBIndex::BuildPipeline::submit(Block* block)
+{
+  pthread_mutex_lock(&_mutex);
+  while (_nofBlocksInPipeline >= _maxNofBlocksInPipeline)
+    pthread_cond_wait(&_changed, &_mutex);
+  _blocksToCompress.push_back(block);
+  _nofBlocksInPipeline++;
+  pthread_cond_broadcast(&_changed);
+  pthread_mutex_unlock(&_mutex);
+}
+
+void HYBIndex::BuildPipeline::finish()
+{
+  if (_finished) return;
+  pthread_mutex_lock(&_mutex);
+  _noMoreBlocks = true;
+  pthread_cond_broadcast(&_changed);
+  pthread_mutex_unlock(&_mutex);
+  for (unsigned int i = 0; i < _workers.size(); i++)
+    pthread_join(_workers[i], NULL);
+  pthread_join(_writer, NULL);
+  _finished = true;
+}
+
+void* HYBIndex::BuildPipeline::workerThreadFunction(void* pipeline)
+{
+  static_cast<BuildPipeline*>(pipeline)->work();
+  return NULL;
+}
+
+void* HYBIndex::BuildPipeline::writerThreadFunction(void* pipeline)
+{
+  static_cast<BuildPipeline*>(pipeline)->write();
+  return NULL;
+}
+
+void HYBIndex::BuildPipeline::work()
+{
+  pthread_mutex_lock(&_mutex);
+  while (true)
+  {
+    while (_blocksToCompress.empty() && !_noMoreBlocks)
+      pthread_cond_wait(&_changed, &_mutex);
+    if (_blocksToCompress.empty()) break;
+    Block* block = _blocksToCompress.front();
+    _blocksToCompress.pop_front();
+    pthread_mutex_unlock(&_mutex);
+    _index->compressBlock(block);
+    pthread_mutex_lock(&_mutex);
+    _blocksToWrite[block->id] = block;
+    pthread_cond_broadcast(&_changed);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+void HYBIndex::BuildPipeline::write()
+{
+  pthread_mutex_lock(&_mutex);
+  while (true)
+  {
+    map<BlockId, Block*>::iterator it;
+    while ((it = _blocksToWrite.find(_nextBlockToWrite)) == _blocksToWrite.end()
+           && !(_noMoreBlocks && _nofBlocksInPipeline == 0))
+      pthread_cond_wait(&_changed, &_mutex);
+    if (it == _blocksToWrite.end()) break;
+    Block* block = it->second;
+    _blocksToWrite.erase(it);
+    pthread_mutex_unlock(&_mutex);
+    _index->writeCompressedBlock(*block, *_indexStructureFile);
+    delete block;
+    pthread_mutex_lock(&_mutex);
+    _nextBlockToWrite++;
+    _nofBlocksInPipeline--;
+    pthread_cond_broadcast(&_changed);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
 
 void HYBIndex::build(const string& wordsFileName, const string& format)
 {
@@ -293,6 +501,7 @@ void HYBIndex::build(const string& wordsFileName, const string& format)
    WordsFile wordsFile(wordsFileName.c_str());
    if (format == "ASCII") wordsFile.setFormat(WordsFile::FORMAT_HTDIG);
    else if (format == "BINARY") wordsFile.setFormat(WordsFile::FORMAT_BINARY);
+   else if (format == "RUNS") wordsFile.setFormat(WordsFile::FORMAT_RUNS);
    wordsFile.setSkipLineWithSameWordAndDoc(MODE & WITH_POS ? false : true);
    // NOTE(bast, 8Jul11): Max doc id by default was no longer maintained after
    // r244 (where Hannah re-factored WordsFile). However, DBLP produces
@@ -350,6 +559,17 @@ void HYBIndex::build(const string& wordsFileName, const string& format)
    bool shownIgnoreMessage = false;
    // NEW(Hannah): do not show the block boundaries anymore.
    // cout << endl; 
+   // With more than one thread, blocks are sorted and compressed by worker
+   // threads while reading goes on, see BuildPipeline.
+   std::unique_ptr<BuildPipeline> pipeline;
+   if (HYB_BUILD_NOF_THREADS > 1)
+   {
+     cout << "* sorting and compressing blocks with " << HYB_BUILD_NOF_THREADS
+          << " threads" << endl;
+     pipeline.reset(new BuildPipeline(this, &indexStructureFile,
+                                      HYB_BUILD_NOF_THREADS));
+   }
+
    #define WORD(x) (x)
    while (true)
    {
@@ -467,8 +687,23 @@ void HYBIndex::build(const string& wordsFileName, const string& format)
          {
            // NEW(Hannah): do not show the block boundaries anymore.
            // cout << printable(WORD(previousWord)) << "]" << flush;
-           writeCurrentBlockToIndexFile(doclistForCurrentBlock, wordlistForCurrentBlock, 
-      	                                scorelistForCurrentBlock, positionlistForCurrentBlock, blockId, indexStructureFile);
+           if (pipeline.get() != NULL)
+           {
+             Block* block = new Block(blockId);
+             size_t blockVolume = doclistForCurrentBlock.size();
+             block->swapLists(doclistForCurrentBlock, wordlistForCurrentBlock,
+                              scorelistForCurrentBlock, positionlistForCurrentBlock);
+             pipeline->submit(block);
+             doclistForCurrentBlock.reserve(blockVolume);
+             wordlistForCurrentBlock.reserve(blockVolume);
+             if (MODE & WITH_POS) { positionlistForCurrentBlock.reserve(blockVolume); }
+             if (MODE & WITH_SCORES) { scorelistForCurrentBlock.reserve(blockVolume); }
+           }
+           else
+           {
+             writeCurrentBlockToIndexFile(doclistForCurrentBlock, wordlistForCurrentBlock, 
+      	                                  scorelistForCurrentBlock, positionlistForCurrentBlock, blockId, indexStructureFile);
+           }
            blockId++;
          }
 
@@ -537,6 +772,8 @@ void HYBIndex::build(const string& wordsFileName, const string& format)
      }
 
    }  // End of main loop reading the words file line by line / record by record.
+   // Wait until the last blocks are written.
+   if (pipeline.get() != NULL) pipeline->finish();
    
    //cout << "\n size of boundary wordsIds : " <<  _boundaryWordIds.size() << "\n id of current block : " << currentBlock;
    assert(  _boundaryWordIds.size() == blockId);
@@ -565,11 +802,11 @@ void HYBIndex::build(const string& wordsFileName, const string& format)
    buildIndexTimer.stop();
    freeCompressionBuffer();
 
-   // WRITE VOCABULARY to separate file (not for BINARY!)
+   // WRITE VOCABULARY to separate file (not for BINARY and RUNS!)
    // NEW(Hannah): do not show the block boundaries anymore.
    // cout << endl << endl;
-   if (format != "BINARY") writeVocabularyToFile();
-   else cout << "! no vocabulary written when reading BINARY format" << endl;
+   if (!wordsFile.formatIsBinary()) writeVocabularyToFile();
+   else cout << "! no vocabulary written when reading " << format << " format" << endl;
    cout << endl;     
    
    // SHOW TIMINGS AND STATISTICS 
@@ -614,6 +851,9 @@ void HYBIndex::showBuildStatistics(off_t fileSizeInBytes)
   if (positionlistCompressionTimer.usecs() == 0) cout << endl;
   else cout   << " (" << setw(2) << nofTokens/positionlistCompressionTimer.usecs()
     << " million position ids per second)" << endl;
+  if (HYB_BUILD_NOF_THREADS > 1)
+    cout << HF1 << "" << "   (sorting and compressing summed over "
+         << HYB_BUILD_NOF_THREADS << " threads)" << endl;
   cout << endl;
   assert(_metaInfo.getNofBlocks() > 0); 
   assert(nofTokens > 0); 
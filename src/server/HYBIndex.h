@@ -50,6 +50,43 @@ class HYBIndex : public IndexBase
                                     BlockId currentBlock,
                                     File& indexStructureFile);
  private:
+  //! A block of the index during building: its lists (moved out of the lists
+  //! of the reading thread) and, once compressed, the compressed lists.
+  struct Block
+  {
+    explicit Block(BlockId id);
+    //! Swap the lists with the given ones.
+    void swapLists(DocList& doclist, WordList& wordlist,
+                   Vector<DiskScore>& scorelist,
+                   Vector<Position>& positionlist);
+    BlockId id;
+    DocList doclist;
+    WordList wordlist;
+    Vector<DiskScore> scorelist;
+    Vector<Position> positionlist;
+    //! The compressed doc, position and word list, one after the other.
+    vector<char> compressed;
+    size_t compressedDoclistSize;
+    size_t compressedPositionlistSize;
+    size_t compressedWordlistSize;
+    //! Times for sorting and compressing this block (in microseconds).
+    off_t sortUsecs;
+    off_t doclistCompressionUsecs;
+    off_t positionlistCompressionUsecs;
+    off_t wordlistCompressionUsecs;
+  };
+
+  //! Sort the lists of the given block by doc id and compress them. Only
+  //! touches the block, so several blocks can be compressed concurrently.
+  void compressBlock(Block* block) const;
+
+  //! Write the given compressed block to the index file (at the offset after
+  //! the previous block) and update the offsets and statistics.
+  void writeCompressedBlock(const Block& block, File& indexStructureFile);
+
+  //! Compresses and writes blocks with several threads, see HYBIndex.cpp.
+  class BuildPipeline;
+
   void writeMetaInfo(File *file);
 
   void readBlockOffsets(File* file, off_t lastOffsetOffset,
@@ -2,6 +2,11 @@
 #include <gtest/gtest.h>
 #include "HYBIndex.h"
 #include "HYBCompleter.h"
+#include "ExcerptsGenerator.h"
+#include "SortedRuns.h"
+#include "InfixIndex.h"
+#include <algorithm>
+#include <sstream>
 
 
 // Test class with some useful functions for the test below.
@@ -15,6 +20,28 @@ class HYBIndexTest : public ::testing::Test
     fprintf(file, "%s\t%u\t%u\t%u\n", word, docId, score, position);
   }
             
+  // The postings of the given result as a string, in a canonical order (the
+  // order of the postings of a document may depend on how the result was
+  // computed).
+  string canonicalString(const QueryResult& result)
+  {
+    vector<string> postings;
+    for (size_t i = 0; i < result._docIds.size(); i++)
+    {
+      std::ostringstream os;
+      os << result._docIds[i] << "/" << result._wordIdsOriginal[i] << "/"
+         << result._scores[i] << "/"
+         << (result._positions.size() > 0 ? result._positions[i] : 0);
+      postings.push_back(os.str());
+    }
+    std::sort(postings.begin(), postings.end());
+    std::ostringstream os;
+    os << result._prefixCompleted << ", " << result.nofTotalHits << ", "
+       << result.nofTotalCompletions << ":";
+    for (size_t i = 0; i < postings.size(); i++) os << " " << postings[i];
+    return os.str();
+  }
+
   // Write posting to words file in BINARY.
   void writePostingToWordsFileBinary(FILE* file,
       WordId wordId, DocId docId, Score score, Position position)
@@ -76,6 +103,18 @@ TEST_F(HYBIndexTest, BuildIndexFormatHtdig)
       ASSERT_EQ("{2,5,8}", block._scores.debugString());
       ASSERT_EQ("{1,4,9}", block._positions.debugString());
     }
+    // Same block without decoding the positions.
+    {
+      DocList docIds;
+      WordList wordIds;
+      Vector<Position> positions;
+      Vector<DiskScore> scores;
+      completer.getDataForBlockId(1, docIds, positions, scores, wordIds, false);
+      ASSERT_EQ("{4,3,2}", wordIds.debugString());
+      ASSERT_EQ("{3,6,7}", docIds.debugString());
+      ASSERT_EQ((size_t) 3, scores.size());
+      ASSERT_EQ((size_t) 0, positions.size());
+    }
   }
 }
 
@@ -136,7 +175,508 @@ TEST_F(HYBIndexTest, BuildIndexFormatBinary)
   }
 }
 
+// Test that building from sorted runs gives exactly the same index as building
+// from the sorted binary words file.
+TEST_F(HYBIndexTest, BuildIndexFormatRuns)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string runsFileName = "HYBIndexTest.TMP.words-runs";
+  string vocabularyFileName = "HYBIndexTest.TMP.vocabulary";
+  // Add the postings to the runs in random order, with room for 100 postings
+  // per run, and write them to the words file in sorted order.
+  vector<SortedRuns::Posting> postings;
+  {
+    FILE* vocabulary_file = fopen(vocabularyFileName.c_str(), "w");
+    for (WordId wordId = 0; wordId < 26 * 26; wordId++)
+    {
+      fprintf(vocabulary_file, "%c%c\n", 'a' + wordId / 26, 'a' + wordId % 26);
+      for (DocId docId = 1; docId <= 3; docId++)
+      {
+        SortedRuns::Posting posting = { static_cast<uint32_t>(wordId),
+                                        docId * wordId % 97 + 1,
+                                        docId, wordId % 5 + docId };
+        postings.push_back(posting);
+      }
+    }
+    fclose(vocabulary_file);
+    srand(42);
+    std::random_shuffle(postings.begin(), postings.end());
+    SortedRunsWriter writer(runsFileName,
+                            100 * 2 * sizeof(SortedRuns::Posting), 2);
+    for (size_t i = 0; i < postings.size(); i++)
+      writer.add(postings[i].wordId, postings[i].docId, postings[i].score,
+                 postings[i].position);
+    writer.finish();
+    ASSERT_GT(writer.getNofRuns(), 10u);
+    std::stable_sort(postings.begin(), postings.end(), &SortedRuns::less);
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    for (size_t i = 0; i < postings.size(); i++)
+      writePostingToWordsFileBinary(words_file, postings[i].wordId,
+          postings[i].docId, postings[i].score, postings[i].position);
+    fclose(words_file);
+  }
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  HYB_BLOCK_VOLUME = 1;
+  string indexFileNames[2] = { "HYBIndexTest.TMP.binary.hybrid",
+                               "HYBIndexTest.TMP.runs.hybrid" };
+  {
+    HYBIndex index(indexFileNames[0], vocabularyFileName, MODE);
+    index.build(wordsFileName, "BINARY");
+    ASSERT_EQ((unsigned) 26, index._metaInfo.getNofBlocks());
+  }
+  {
+    HYBIndex index(indexFileNames[1], vocabularyFileName, MODE);
+    index.build(runsFileName, "RUNS");
+    ASSERT_EQ((unsigned) 26, index._metaInfo.getNofBlocks());
+    ASSERT_EQ(postings.size(), index._metaInfo.getNofWordInDocPairs());
+  }
+  string contents[2];
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    FILE* index_file = fopen(indexFileNames[i].c_str(), "r");
+    ASSERT_TRUE(index_file != NULL);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), index_file)) > 0)
+      contents[i].append(buffer, n);
+    fclose(index_file);
+  }
+  ASSERT_GT(contents[0].size(), (size_t) 0);
+  ASSERT_TRUE(contents[0] == contents[1]);
+}
+
+// Test that building with several threads gives exactly the same index as
+// building with one thread.
+TEST_F(HYBIndexTest, BuildIndexMultipleThreads)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string vocabularyFileName = "HYBIndexTest.TMP.vocabulary";
+  // Create a words file with many blocks (one per first letter) of different
+  // sizes, the postings of each word in decreasing order of doc id.
+  {
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    for (char c1 = 'a'; c1 <= 'z'; c1++)
+      for (char c2 = 'a'; c2 <= c1; c2++)
+      {
+        char word[3] = { c1, c2, 0 };
+        for (int docId = 100 + c1 + c2; docId > 0; docId -= 7)
+          writePostingToWordsFileAscii(words_file, word, docId,
+                                       docId % 5 + 1, c2 * docId % 97);
+      }
+    fclose(words_file);
+  }
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  HYB_BLOCK_VOLUME = 1;
+  string indexFileNames[2] = { "HYBIndexTest.TMP.1.hybrid",
+                               "HYBIndexTest.TMP.4.hybrid" };
+  unsigned int nofThreads[2] = { 1, 4 };
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    HYB_BUILD_NOF_THREADS = nofThreads[i];
+    HYBIndex index(indexFileNames[i], vocabularyFileName, MODE);
+    index.build(wordsFileName, "ASCII");
+    ASSERT_EQ((unsigned) 26, index._metaInfo.getNofBlocks());
+  }
+  HYB_BUILD_NOF_THREADS = 1;
+  string contents[2];
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    FILE* index_file = fopen(indexFileNames[i].c_str(), "r");
+    ASSERT_TRUE(index_file != NULL);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), index_file)) > 0)
+      contents[i].append(buffer, n);
+    fclose(index_file);
+  }
+  ASSERT_GT(contents[0].size(), (size_t) 0);
+  ASSERT_TRUE(contents[0] == contents[1]);
+}
+
+// Test that queries give the same result with materialised lists for hot
+// prefixes as without, and that the blocks are not read then.
+TEST_F(HYBIndexTest, HotLists)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string vocabularyFileName = "HYBIndexTest.TMP.vocabulary";
+  string indexFileName = "HYBIndexTest.TMP.hybrid";
+  string hotListsFileName = "HYBIndexTest.TMP.hot-lists";
+  // Create a words file with one block per two-letter prefix. The positions
+  // of the words in a document differ, so that the order of the postings is
+  // unique.
+  {
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    for (char c1 = 'a'; c1 <= 'c'; c1++)
+      for (char c2 = 'a'; c2 <= 'd'; c2++)
+        for (char c3 = 'a'; c3 <= 'b'; c3++)
+        {
+          char word[4] = { c1, c2, c3, 0 };
+          for (int docId = 30 + c2 + c3; docId > 0; docId -= c1 - 'a' + 2)
+            writePostingToWordsFileAscii(words_file, word, docId,
+                                         (docId + c3) % 7 + 1,
+                                         docId % 3 * 100 + c1 * 10 + c2 * 2
+                                         + c3);
+        }
+    fclose(words_file);
+  }
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  HYB_BLOCK_VOLUME = 2;
+  HYBIndex index(indexFileName, vocabularyFileName, MODE);
+  index.build(wordsFileName, "ASCII");
+  ASSERT_EQ((unsigned) 12, index._metaInfo.getNofBlocks());
+  FuzzySearch::FuzzySearcherUtf8 nullFuzzySearcher;
+  const char* queries[] = { "a*", "b*", "c*", "b* a*", "aab a*", "c*..a*",
+                            "ab*", "c* ab*", "c* -ab*", "c*..ab*" };
+  const size_t nofQueries = sizeof(queries) / sizeof(queries[0]);
+  vector<string> expected;
+  {
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    for (size_t i = 0; i < nofQueries; i++)
+    {
+      QueryResult* result = NULL;
+      completer.processQuery(Query(queries[i]), result);
+      expected.push_back(canonicalString(*result));
+    }
+
+    // The prefix ab* is within one block, b* is not hot enough.
+    vector<pair<string, size_t> > prefixes;
+    prefixes.push_back(make_pair("c*", 3));
+    prefixes.push_back(make_pair("a*", 2));
+    prefixes.push_back(make_pair("ab*", 5));
+    prefixes.push_back(make_pair("b*", 1));
+    completer.writeHotLists(prefixes, 2, hotListsFileName);
+  }
+  HotLists hotLists;
+  hotLists.read(hotListsFileName, index._vocabulary.size());
+  ASSERT_EQ(2u, hotLists.getNofLists());
+  globalHotLists = &hotLists;
+  {
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    for (size_t i = 0; i < nofQueries; i++)
+    {
+      QueryResult* result = NULL;
+      completer.processQuery(Query(queries[i]), result);
+      ASSERT_EQ(expected[i], canonicalString(*result))
+        << "Query was: '" << queries[i] << "'";
+      ASSERT_TRUE(result->_docIds.isSorted());
+      if (i == 0)
+      {
+        ASSERT_EQ(0u, completer.nofBlocksReadFromFile);
+      }
+      if (i == 1)
+      {
+        ASSERT_EQ(4u, completer.nofBlocksReadFromFile);
+      }
+    }
+  }
+
+  // The prefix ab* and the word aab are within one block, but have one
+  // posting per doc (ab* has the doc ids 1, ..., 226), so they get a list with
+  // a bitmap. For c* ab*, only the postings of ab* in the docs of c* are
+  // fetched.
+  {
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    vector<pair<string, size_t> > prefixes;
+    prefixes.push_back(make_pair("ab*", 5));
+    prefixes.push_back(make_pair("aab", 3));
+    completer.writeHotLists(prefixes, 2, hotListsFileName);
+  }
+  hotLists.read(hotListsFileName, index._vocabulary.size());
+  ASSERT_EQ(2u, hotLists.getNofLists());
+  ASSERT_TRUE(hotLists.hasBitmap(0));
+  ASSERT_TRUE(hotLists.hasBitmap(1));
+  ASSERT_EQ(226u, hotLists.getBitmap(1).count());
+  {
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    for (size_t i = 0; i < nofQueries; i++)
+    {
+      size_t nofBlocksRead = completer.nofBlocksReadFromFile;
+      QueryResult* result = NULL;
+      completer.processQuery(Query(queries[i]), result);
+      ASSERT_EQ(expected[i], canonicalString(*result))
+        << "Query was: '" << queries[i] << "'";
+      if (i == 6)
+      {
+        ASSERT_EQ(nofBlocksRead, completer.nofBlocksReadFromFile);
+      }
+    }
+  }
+  // Without the history, c* ab* reads the blocks of c* and intersects with
+  // the bitmap of ab*, with the same result as with the block of ab*.
+  string resultWithBitmap;
+  string resultWithBlock;
+  for (int withHotLists = 0; withHotLists < 2; withHotLists++)
+  {
+    globalHotLists = withHotLists ? &hotLists : NULL;
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    QueryResult* result = NULL;
+    completer.processQuery(Query("c* ab*"), result);
+    ASSERT_EQ(withHotLists ? 4u : 5u, completer.nofBlocksReadFromFile);
+    (withHotLists ? resultWithBitmap : resultWithBlock)
+      = canonicalString(*result);
+  }
+  ASSERT_EQ(resultWithBlock, resultWithBitmap);
+  globalHotLists = NULL;
+  remove(hotListsFileName.c_str());
+}
+
+// Test that queries without hits, for which only the hits and completions are
+// counted, give the same counts and top completions as the full result, also
+// with hot lists and from the counts in the history.
+TEST_F(HYBIndexTest, CountOnlyQueries)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string vocabularyFileName = "HYBIndexTest.TMP.vocabulary";
+  string indexFileName = "HYBIndexTest.TMP.hybrid";
+  string hotListsFileName = "HYBIndexTest.TMP.hot-lists";
+  {
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    for (char c1 = 'a'; c1 <= 'c'; c1++)
+      for (char c2 = 'a'; c2 <= 'd'; c2++)
+        for (char c3 = 'a'; c3 <= 'b'; c3++)
+        {
+          char word[4] = { c1, c2, c3, 0 };
+          for (int docId = 30 + c2 + c3; docId > 0; docId -= c1 - 'a' + 2)
+          {
+            writePostingToWordsFileAscii(words_file, word, docId,
+                                         (docId + c3) % 7 + 1, 2 * docId);
+            if (docId % 5 == 0)
+              writePostingToWordsFileAscii(words_file, word, docId,
+                                           docId % 3 + 1, 2 * docId + 1);
+          }
+        }
+    fclose(words_file);
+  }
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  HYB_BLOCK_VOLUME = 2;
+  HYBIndex index(indexFileName, vocabularyFileName, MODE);
+  index.build(wordsFileName, "ASCII");
+  FuzzySearch::FuzzySearcherUtf8 nullFuzzySearcher;
+  {
+    TimedHistory history;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    vector<pair<string, size_t> > prefixes;
+    prefixes.push_back(make_pair("c*", 3));
+    prefixes.push_back(make_pair("ab*", 5));
+    completer.writeHotLists(prefixes, 2, hotListsFileName);
+  }
+  HotLists hotLists;
+  hotLists.read(hotListsFileName, index._vocabulary.size());
+
+  // The last two queries are not counted. The results of a* and b* are in the
+  // history after b* a* and a* b* (as their first parts), so the second time
+  // they are taken from there, and ab* and aab are filtered from a*. For
+  // a* b*, the result of b* for its last part is in the history.
+  const char* queries[] = { "a*", "b*", "ab*", "aab", "b* a*", "a* b*",
+                            "c* ab*", "c* xyz*", "c*..a*", "c* -ab*" };
+  const size_t nofQueries = sizeof(queries) / sizeof(queries[0]);
+  for (int rankWords = 0; rankWords <= 4; rankWords++)
+  {
+    QueryParameters queryParameters;
+    queryParameters.nofHitsToSend = 0;
+    queryParameters.nofTopCompletionsToCompute = 5;
+    queryParameters.howToRankWords
+      = (QueryParameters::HowToRankWordsEnum) rankWords;
+    if (rankWords == 1) queryParameters.sortOrderWords = SORT_ORDER_ASCENDING;
+    if (rankWords == 2)
+    {
+      queryParameters.wordScoreAggSameDocument = SCORE_AGG_MAX;
+      queryParameters.wordScoreAggDifferentDocuments = SCORE_AGG_MAX;
+    }
+    vector<string> results[2];
+    for (int countOnly = 0; countOnly < 2; countOnly++)
+    {
+      countOnlyQueries = countOnly;
+      globalHotLists = countOnly ? &hotLists : NULL;
+      TimedHistory history;
+      for (int round = 0; round < 2; round++)
+      {
+        for (size_t i = 0; i < nofQueries; i++)
+        {
+          HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+          completer.setQueryParameters(queryParameters);
+          QueryResult* result = NULL;
+          completer.processQuery(Query(queries[i]), result);
+          std::ostringstream os;
+          os << queries[i] << ": " << result->nofTotalHits << " "
+             << result->nofTotalCompletions << ":";
+          for (size_t j = 0; j < result->_topWordIds.size(); j++)
+            os << " " << result->_topWordIds[j] << "/"
+               << result->_topWordScores[j] << "/"
+               << result->_topWordDocCounts[j] << "/"
+               << result->_topWordOccCounts[j];
+          if (round == 0) results[countOnly].push_back(os.str());
+          else ASSERT_EQ(results[countOnly][i], os.str());
+          bool isCounted = countOnly && i + 2 < nofQueries
+                             && !(round == 1 && i < 4);
+          const string& howComputed = result->_howResultWasComputed;
+          ASSERT_EQ(isCounted, howComputed == QueryResult::COUNTS_ONLY
+                               || howComputed == QueryResult::COUNTS_FROM_HISTORY)
+            << "Query was: '" << queries[i] << "'";
+          if (isCounted)
+          {
+            ASSERT_EQ(round == 0 ? QueryResult::COUNTS_ONLY
+                                 : QueryResult::COUNTS_FROM_HISTORY,
+                      howComputed);
+            ASSERT_EQ(0u, result->_docIds.size());
+            ASSERT_EQ(0u, result->_topDocIds.size());
+          }
+        }
+      }
+    }
+    for (size_t i = 0; i < nofQueries; i++)
+      ASSERT_EQ(results[0][i], results[1][i]) << "rankWords = " << rankWords;
+  }
+  countOnlyQueries = true;
+  globalHotLists = NULL;
+  remove(hotListsFileName.c_str());
+}
+
+// Test that the excerpts for a plain word query are computed from the
+// positions of the hits when the docs DB has word positions. The posting of
+// gamma is at the position of epsilon in the docs DB, so epsilon is
+// highlighted only if the excerpt is made from the positions.
+TEST_F(HYBIndexTest, ExcerptsFromPositions)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string vocabularyFileName = "HYBIndexTest.TMP.vocabulary";
+  string indexFileName = "HYBIndexTest.TMP.hybrid";
+  string docsFileName = "HYBIndexTest.TMP.docs";
+  string docsDBFileName = "HYBIndexTest.TMP.docs.DB";
+  {
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    writePostingToWordsFileAscii(words_file, "alpha", 2, 1, 2);
+    writePostingToWordsFileAscii(words_file, "beta", 2, 1, 3);
+    writePostingToWordsFileAscii(words_file, "delta", 2, 1, 5);
+    writePostingToWordsFileAscii(words_file, "first", 1, 1, 1);
+    writePostingToWordsFileAscii(words_file, "gamma", 2, 1, 6);
+    fclose(words_file);
+    FILE* docs_file = fopen(docsFileName.c_str(), "w");
+    fputs("1\tu:url1\tt:First\tH:the first document\n"
+          "2\tu:url2\tt:Second\tp:2:0:5,3:6:4,4:11:5,5:17:5,6:23:7"
+          "\tH:alpha beta gamma delta epsilon\n", docs_file);
+    fclose(docs_file);
+  }
+  DocsDB::build(docsFileName, docsDBFileName, 6, 0, 8);
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  HYB_BLOCK_VOLUME = 1;
+  HYBIndex index(indexFileName, vocabularyFileName, MODE);
+  index.build(wordsFileName, "ASCII");
+  FuzzySearch::FuzzySearcherUtf8 nullFuzzySearcher;
+  ExcerptsGenerator generator(docsDBFileName);
+  ASSERT_TRUE(generator.hasDocsWithPositions());
+  excerptsGenerator = &generator;
+  TimedHistory history;
+  for (int nofExcerptsPerHit = 0; nofExcerptsPerHit <= 1; nofExcerptsPerHit++)
+  {
+    QueryParameters queryParameters;
+    queryParameters.nofExcerptsPerHit = nofExcerptsPerHit;
+    queryParameters.excerptRadius = 1;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    completer.setQueryParameters(queryParameters);
+    QueryResult* result = NULL;
+    completer.processQuery(Query("gamma"), result);
+    ASSERT_EQ(1u, result->_topDocIds.size());
+    ASSERT_EQ(nofExcerptsPerHit > 0, result->hasPositions());
+  }
+  {
+    QueryParameters queryParameters;
+    queryParameters.excerptRadius = 1;
+    HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+    completer.setQueryParameters(queryParameters);
+    QueryResult* result = NULL;
+    completer.processQuery(Query("gamma"), result);
+    vector<HitData> hits;
+    generator.getExcerpts(Query("gamma"), queryParameters, *result, hits);
+    ASSERT_EQ(1u, hits.size());
+    ASSERT_EQ(2u, hits[0].docId);
+    ASSERT_EQ(1u, hits[0].excerpts.size());
+    ASSERT_EQ(" ... delta <hl idx='0'>epsilon</hl>", hits[0].excerpts[0]);
+  }
+  excerptsGenerator = NULL;
+  remove(docsFileName.c_str());
+  remove(docsDBFileName.c_str());
+}
+
+// Test that an infix query reads only the blocks with a matching word, and
+// gives the same result as with all words in one block.
+TEST_F(HYBIndexTest, InfixQueryFarApartWords)
+{
+  string wordsFileName = "HYBIndexTest.TMP.words";
+  string infixIndexFileName = "HYBIndexTest.TMP.infix-index";
+  // One block per first letter, the words with "qq" are in the first and the
+  // last block.
+  {
+    FILE* words_file = fopen(wordsFileName.c_str(), "w");
+    for (char c1 = 'a'; c1 <= 'z'; c1++)
+    {
+      for (char c2 = 'a'; c2 <= 'c'; c2++)
+      {
+        char word[3] = { c1, c2, 0 };
+        for (int docId = 30; docId > 0; docId -= (c1 + c2) % 4 + 2)
+          writePostingToWordsFileAscii(words_file, word, docId,
+                                       docId % 5 + 1, c1 * 10 + c2);
+      }
+      if (c1 != 'a' && c1 != 'z') continue;
+      char word[4] = { c1, 'q', 'q', 0 };
+      for (int docId = (c1 == 'a' ? 20 : 30); docId > (c1 == 'a' ? 0 : 10);
+           docId -= 3)
+        writePostingToWordsFileAscii(words_file, word, docId, 2, c1 * 10);
+    }
+    fclose(words_file);
+  }
+  const int MODE = WITH_DUPS + WITH_POS + WITH_SCORES;
+  const char* queries[] = { "*qq*", "aa* *qq*", "*qq* zb" };
+  const size_t nofQueries = sizeof(queries) / sizeof(queries[0]);
+  FuzzySearch::FuzzySearcherUtf8 nullFuzzySearcher;
+  unsigned int blockVolumes[2] = { 1000 * 1000, 1 };
+  unsigned int nofBlocks[2] = { 1, 26 };
+  vector<string> expected;
+  for (int k = 0; k < 2; k++)
+  {
+    HYB_BLOCK_VOLUME = blockVolumes[k];
+    HYBIndex index("HYBIndexTest.TMP.hybrid", "HYBIndexTest.TMP.vocabulary",
+                   MODE);
+    index.build(wordsFileName, "ASCII");
+    ASSERT_EQ(nofBlocks[k], index._metaInfo.getNofBlocks());
+    InfixIndex::build(index._vocabulary, infixIndexFileName);
+    InfixIndex infixIndex;
+    infixIndex.open(infixIndexFileName);
+    globalInfixIndex = &infixIndex;
+    for (size_t i = 0; i < nofQueries; i++)
+    {
+      TimedHistory history;
+      HybCompleter<MODE> completer(&index, &history, &nullFuzzySearcher);
+      QueryResult* result = NULL;
+      completer.processQuery(Query(queries[i]), result);
+      ASSERT_TRUE(result->_docIds.isSorted());
+      if (k == 0)
+      {
+        expected.push_back(canonicalString(*result));
+        continue;
+      }
+      ASSERT_EQ(expected[i], canonicalString(*result)) << queries[i];
+      // The blocks a and z, not the 24 in between.
+      if (i == 0)
+      {
+        ASSERT_EQ(2u, completer.nofBlocksReadFromFile);
+      }
+    }
+    globalInfixIndex = NULL;
+  }
+  ASSERT_NE(string::npos, expected[0].find(" 30/"));
+  ASSERT_NE(string::npos, expected[0].find(" 2/"));
+  remove(wordsFileName.c_str());
+  remove(infixIndexFileName.c_str());
+}
+
 int main(int argc, char **argv) {
+  globalStringConverter.init();
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
@@ -1,7 +1,7 @@
 #include "History.h"
 
 //! Constructor; creates empty history.
-History::History() : _currentSize(0)
+History::History() : _currentSize(0), _countsSize(0)
 {
   pthread_mutex_init(&history_change, NULL);
   assert(&history_change);
@@ -51,10 +51,12 @@ void History::show(bool doLock) const
 }
 
 //! Add query to keepInHistoryQueries. Will add query with flags &hf=0 and
-//&hf=1.
+//&hf=1, each with and without positions (see CompleterBase::getFlagForHistory).
 void History::addKeepInHistoryQuery(string query) {
   _keepInHistoryQueries.insert(query + "&hf=0");
   _keepInHistoryQueries.insert(query + "&hf=1");
+  _keepInHistoryQueries.insert(query + "&hf=0&pos=1");
+  _keepInHistoryQueries.insert(query + "&hf=1&pos=1");
 }
 
 //! Ask if given string (query + hf flag) is in keepInHistoryQueries.
@@ -282,7 +284,13 @@ bool History::cutToSizeAndNumber(size_t maxSizeInBytes, unsigned int maxNofQueri
       _queries.push_back(pair<string, size_t > (specialString, 0));
       assert(check(DONT_LOCK));
     }
-	// Case 2: ordinary query -> just remove the result
+    // Case 2: result is being recomputed (see CompleterBase, CASE 1.1) -> keep
+    else if (!(getStatusOfEntry(_queries[i].first, DONT_LOCK) & QueryResult::FINISHED))
+    {
+      ++i;
+    }
+    // Case 3: ordinary query -> just remove the result (it stays valid for
+    // whoever still holds a reference to it, see get)
     else
     {
       // cout << "Removing string '" << _queries[i].first << "' from history " << endl;
@@ -371,6 +379,9 @@ void History::clear(bool doLock)
   _results.clear(); 
   _queries.clear();
   _currentSize = 0;
+  _counts.clear();
+  _countsQueue.clear();
+  _countsSize = 0;
   if(doLock) { pthread_mutex_unlock(&history_change); }
 }
 
@@ -443,7 +454,7 @@ void History::finalizeSize(const std::string& key, bool doLock)
   if (doLock) {pthread_mutex_unlock(&history_change);}
 }
 
-void History::add(const std::string& key, const QueryResult& result, bool doLock)
+void History::add(const std::string& key, const QueryResultPtr& result, bool doLock)
 {
   // NEW (baumgari) 06Mar13: See CompleterBase:237 8Feb13
   // NEW (baumgari) 18Apr13: This leads to the problem, that e.g. quer* =
@@ -472,21 +483,21 @@ void History::add(const std::string& key, const QueryResult& result, bool doLock
     CS_THROW(Exception::HISTORY_ENTRY_CONFLICT, string("key: ") + key);
   }
   assert(!isContainedConst(key, DONT_LOCK));
-  assert(result._lastBlockScores.size() == 0); //currently always adding an empty element to history, which is then filled
-  assert(( result._lastBlockScores.size() ==  result._topDocIds.size()) || (   result._lastBlockScores.size() == 0));
-  assert(( result._lastBlockScores.size() ==  0) || (   result._lastBlockScores.isPositive()));
-  assert(result._docIds.size() == result._wordIds.size());
-  assert(result._topDocIds.size() <=  result._docIds.size());
-  assert(result._topWordIds.size() <= result._wordIds.size() );
-  assert(((result._topDocIds.size()>0  )&&( result._topWordIds.size()>0  ))  ||  (( result._topDocIds.size()==0  ) && (result._topWordIds.size()==0  )));
+  assert(result);
+  assert(result->_lastBlockScores.size() == 0); //currently always adding an empty element to history, which is then filled
+  assert(( result->_lastBlockScores.size() ==  result->_topDocIds.size()) || (   result->_lastBlockScores.size() == 0));
+  assert(( result->_lastBlockScores.size() ==  0) || (   result->_lastBlockScores.isPositive()));
+  assert(result->_docIds.size() == result->_wordIdsOriginal.size());
+  assert(result->_topDocIds.size() <=  result->_docIds.size());
+  assert(result->_topWordIds.size() <= result->_wordIdsOriginal.size() );
+  assert(((result->_topDocIds.size()>0  )&&( result->_topWordIds.size()>0  ))  ||  (( result->_topDocIds.size()==0  ) && (result->_topWordIds.size()==0  )));
   // TODO: CHECK THAT THE KEY IS NOT CONTAINED/IS NOT UNDER CONSTRUCTION
-  // This also calls the copy constructor
   if (_results.find(key) != _results.end())
   {
     if(doLock) { pthread_mutex_unlock(&history_change); }
     CS_THROW(Exception::HISTORY_ENTRY_CONFLICT, string("key: ") + key);
   }
-  _results[key] = result; // here an initially empty object is copied (as result will be empty)
+  _results[key] = result; // shared, not copied
   assert ( _results.find(key) != _results.end() );
   assert(isContainedConst(key,DONT_LOCK));
   if (doLock) { pthread_mutex_unlock(&history_change); }
@@ -515,13 +526,8 @@ bool History::remove(std::string key, bool doLock)
   }
 
   assert(isContainedConst(key, DONT_LOCK));
-  if (isContainedConst(key, DONT_LOCK)->_status & QueryResult::IN_USE)
-  {
-    assert(isContainedConst(key, DONT_LOCK)->_status & QueryResult::FINISHED);
-    cout << "! NOT removing string '" << key << "' from history, as it is being used !" << endl;
-    if (doLock) { pthread_mutex_unlock(&history_change); }
-    return false;
-  }
+  // NOTE: a result that is in use (IN_USE) is removed as well. Whoever uses it
+  // holds a reference to it (see get), so it is only freed after the last use.
 
   assert(check(DONT_LOCK));
 
@@ -635,19 +641,69 @@ QueryResult* History::isContained(const std::string& key, bool doLock)
       //             pthread_exit(NULL);
     }
   QueryResultMap::iterator it = _results.find(key); // do NOT use a const_iterator here
+  QueryResult* result = it == _results.end() ? NULL : it->second.get();
   if (doLock) { pthread_mutex_unlock(&history_change); }
-  if (it == _results.end())
+  //          historyTimer.stop();
+  return result;
+}
+
+// _____________________________________________________________________________
+QueryResultPtr History::get(const std::string& key, bool doLock) const
+{
+  if (doLock && pthread_mutex_timed_trylock(&history_change, MUTEX_TIMEOUT))
   {
-    //          historyTimer.stop();
-    return NULL;
+    cout << endl << " ERROR: Cut not get lock on history_change mutex within " << timeAsString(MUTEX_TIMEOUT) << endl << flush;
+    throw Exception(Exception::COULD_NOT_GET_MUTEX, "in method get");
   }
-  else
+  QueryResultMap::const_iterator it = _results.find(key);
+  QueryResultPtr result = it == _results.end() ? QueryResultPtr() : it->second;
+  if (doLock) pthread_mutex_unlock(&history_change);
+  return result;
+}
+
+
+// _____________________________________________________________________________
+void History::addCounts(const std::string& key,
+                        const CompletionCountsPtr& counts,
+                        size_t maxSizeInBytes, bool doLock)
+{
+  if (doLock && pthread_mutex_timed_trylock(&history_change, MUTEX_TIMEOUT))
   {
-    //          historyTimer.stop();
-    return &(it->second);
+    cout << endl << " ERROR: Cut not get lock on history_change mutex within " << timeAsString(MUTEX_TIMEOUT) << endl << flush;
+    throw Exception(Exception::COULD_NOT_GET_MUTEX, "in method addCounts");
+  }
+  // Another thread may have added counts for the same key meanwhile; they are
+  // the same, keep them.
+  if (_counts.count(key) == 0)
+  {
+    size_t size = counts->sizeInBytes() + key.size();
+    _counts[key] = counts;
+    _countsQueue.push_back(make_pair(key, size));
+    _countsSize += size;
+    while (_countsSize > maxSizeInBytes && _countsQueue.size() > 1)
+    {
+      _counts.erase(_countsQueue.front().first);
+      _countsSize -= _countsQueue.front().second;
+      _countsQueue.pop_front();
+    }
   }
+  if (doLock) pthread_mutex_unlock(&history_change);
 }
 
+// _____________________________________________________________________________
+CompletionCountsPtr History::getCounts(const std::string& key,
+                                       bool doLock) const
+{
+  if (doLock && pthread_mutex_timed_trylock(&history_change, MUTEX_TIMEOUT))
+  {
+    cout << endl << " ERROR: Cut not get lock on history_change mutex within " << timeAsString(MUTEX_TIMEOUT) << endl << flush;
+    throw Exception(Exception::COULD_NOT_GET_MUTEX, "in method getCounts");
+  }
+  CompletionCountsMap::const_iterator it = _counts.find(key);
+  CompletionCountsPtr counts = it == _counts.end() ? CompletionCountsPtr() : it->second;
+  if (doLock) pthread_mutex_unlock(&history_change);
+  return counts;
+}
 
 
 //! GET STATUS OF A HISTORY ENTRY (does not exist, under construction, is finished, is being used)
@@ -671,7 +727,7 @@ int History::getStatusOfEntry(const std::string& key, bool doLock) const
   }
   else
   {
-    unsigned char status = (it->second)._status;
+    unsigned char status = it->second->_status;
     if (doLock) pthread_mutex_unlock(&history_change); 
     return status;
   }
@@ -706,24 +762,24 @@ void History::setStatusOfEntry(const std::string& key, int status, bool doLock)
 
   // CASE: setting to "under construction" when this bit is already set
   assert(it != _results.end());
-  if(!((!(status & QueryResult::UNDER_CONSTRUCTION)) || (!((it->second)._status & QueryResult::UNDER_CONSTRUCTION ))))
+  if(!((!(status & QueryResult::UNDER_CONSTRUCTION)) || (!(it->second->_status & QueryResult::UNDER_CONSTRUCTION ))))
   {
     if (doLock) pthread_mutex_unlock(&history_change); 
     CS_THROW(Exception::BAD_HISTORY_ENTRY, string("key: ") + key);
   }
 
   // CASE: setting to "is being used" when still "under construction"
-  if(!((!(status & QueryResult::IN_USE)) || (!((it->second)._status & QueryResult::UNDER_CONSTRUCTION ))))
+  if(!((!(status & QueryResult::IN_USE)) || (!(it->second->_status & QueryResult::UNDER_CONSTRUCTION ))))
   {
     if(doLock) pthread_mutex_unlock(&history_change); 
     CS_THROW(Exception::BAD_HISTORY_ENTRY, string("key: ") + key);
   }
 
-  assert((!(status & QueryResult::UNDER_CONSTRUCTION)) || (!((it->second)._status & QueryResult::UNDER_CONSTRUCTION )));
-  assert((!(status & QueryResult::IN_USE)) || (!((it->second)._status & QueryResult::UNDER_CONSTRUCTION )));
+  assert((!(status & QueryResult::UNDER_CONSTRUCTION)) || (!(it->second->_status & QueryResult::UNDER_CONSTRUCTION )));
+  assert((!(status & QueryResult::IN_USE)) || (!(it->second->_status & QueryResult::UNDER_CONSTRUCTION )));
 
   // OTHERWISE: DO SET THE STATUS 
-  (it->second)._status = (QueryResult::StatusEnum)(status);
+  it->second->_status = (QueryResult::StatusEnum)(status);
 
   if (doLock) pthread_mutex_unlock(&history_change); 
 }
@@ -744,9 +800,10 @@ const QueryResult* History::isContainedConst(const std::string& key, bool doLock
     //pthread_exit(NULL);
   }
   QueryResultMap::const_iterator it = _results.find(key); // use a const_iterator here
+  const QueryResult* result = it == _results.end() ? NULL : it->second.get();
   if (doLock) pthread_mutex_unlock(&history_change); 
   //historyTimer.stop();
-  return it == _results.end() ? NULL : &(it->second);
+  return result;
 }
 
 
@@ -775,7 +832,7 @@ bool History::isContained(const std::string& key, QueryResult*& result, bool doL
   }
   else
   {
-    result = &(it->second);
+    result = it->second.get();
     //historyTimer.stop();
     if (doLock) pthread_mutex_unlock(&history_change); 
     return true;
@@ -793,7 +850,7 @@ std::string History::asString(void) const
   
   for (it = _results.begin(); it != _results.end(); ++it)
   {
-    ss << " \"" << it->first << "\": " << it->second._topCompletions.asString() << ",";
+    ss << " \"" << it->first << "\": " << it->second->_topCompletions.asString() << ",";
   }
   ss << "}";
   return ss.str();
@@ -4,8 +4,10 @@
 #include <pthread.h>
 #include "Globals.h" 
 #include "QueryResult.h"
+#include <memory>
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_set>
 
 #define MUTEX_TIMEOUT 100000 // in microseconds
@@ -17,7 +19,10 @@
 using std::string;
 using std::vector;
 using std::unordered_map;
-typedef std::unordered_map<std::string, QueryResult, StringHashFunction> QueryResultMap;
+typedef std::shared_ptr<QueryResult> QueryResultPtr;
+typedef std::unordered_map<std::string, QueryResultPtr, StringHashFunction> QueryResultMap;
+typedef std::shared_ptr<const CompletionCounts> CompletionCountsPtr;
+typedef std::unordered_map<std::string, CompletionCountsPtr, StringHashFunction> CompletionCountsMap;
 
 // TODO: Have bool 'lock' parameter for all method calls which employ mutexes (to avoid double-locking)
 // TODO: After a lock is obtained check/assert the state
@@ -34,6 +39,11 @@ typedef std::unordered_map<std::string, QueryResult, StringHashFunction> QueryRe
  *
  *    Multiple threads accessing the same object will be serialized. TODO: still
  *    a bit rough though.
+ *
+ *    The results are reference-counted: the history holds one reference, and
+ *    whoever uses a result can hold another one (see get), so that removing a
+ *    result from the history (e.g. in cutToSizeAndNumber) never frees a result
+ *    that another thread is still reading. Results are added without copying.
  */
 class History
 {
@@ -51,6 +61,14 @@ class History
     //! Keep results for these queries in history (= don't remove in cut down).
     unordered_set<string, StringHashFunction> _keepInHistoryQueries;
 
+    //! The counts of count-only queries (see addCounts), by key, and the keys
+    //! in the order in which they were added, with the size of the counts.
+    CompletionCountsMap _counts;
+    std::deque<pair<string, size_t> > _countsQueue;
+
+    //! Current total size of the counts stored, in bytes
+    size_t _countsSize;
+
     //! Mutex for serializing history change operations
     mutable pthread_mutex_t history_change;
 
@@ -92,12 +110,14 @@ class History
     /*
      *   Note: queries from _stringsToKeep (defined in Globals, TODO: why?),
      *   like "ct:author:*" are never removed, so history may be larger than
-     *   specified size even after the call
+     *   specified size even after the call. Neither are results that are
+     *   not FINISHED (being recomputed). Results in use are removed, but stay
+     *   valid for whoever holds a reference to them (see get).
      */
     bool cutToSizeAndNumber(size_t maxSizeInBytes, unsigned int maxNofQueries, bool doLock = true);
 
     //! Add query to keepInHistoryQueries. Will add query with flags &hf=0 and
-    //&hf=1.
+    //&hf=1, each with and without positions.
     void addKeepInHistoryQuery(string query);
 
     //! Ask if given string (query + hf flag) is in keepInHistoryQueries.
@@ -135,8 +155,8 @@ class History
     //! TODO: explain
     void finalizeSize(const std::string& key, bool doLock = true);
 
-    //! Add a result. 
-    void add(const std::string& key, const QueryResult& result, bool doLock = true);
+    //! Add a result (the history shares it, no copy is made).
+    void add(const std::string& key, const QueryResultPtr& result, bool doLock = true);
 
     //! Remove entry for given query; TODO: correct?
     bool remove(std::string key, bool doLock = true);
@@ -144,6 +164,25 @@ class History
     //! Get size of result for given query, in bytes.
     size_t sizeOfEntry(const std::string& key, bool doLock = true) const;
 
+    //! Get a reference to the result for given query, or NULL if not in
+    //! history. The result stays valid as long as the reference is held, even
+    //! if it is removed from the history meanwhile.
+    QueryResultPtr get(const std::string& key, bool doLock = true) const;
+
+    //! Add the counts of a count-only query (see
+    //! CompleterBase::processCountOnlyQuery). They are kept apart from the
+    //! results; when their total size exceeds maxSizeInBytes, the oldest are
+    //! removed.
+    void addCounts(const std::string& key, const CompletionCountsPtr& counts,
+                   size_t maxSizeInBytes, bool doLock = true);
+
+    //! Get the counts for the given key, or NULL if there are none.
+    CompletionCountsPtr getCounts(const std::string& key, bool doLock = true) const;
+
+    //! Get the number of counts stored and their total size, in bytes.
+    size_t getNofCounts() const { return _counts.size(); }
+    size_t countsSizeInBytes() const { return _countsSize; }
+
     //! Get pointer to result for given query or NULL if not in history
     QueryResult* isContained(const std::string& key, bool doLock = true);
 
@@ -0,0 +1,96 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include "server/History.h"
+#include "server/Exception.h"
+
+// Add a finished result with the given doc ids to the given history.
+QueryResultPtr addFinished(History* history, const string& key, size_t n)
+{
+  QueryResultPtr result = std::make_shared<QueryResult>();
+  history->add(key, result);
+  for (size_t i = 0; i < n; i++) result->_docIds.push_back(i + 1);
+  history->finalizeSize(key);
+  history->setStatusOfEntry(key, QueryResult::FINISHED);
+  history->setStatusOfEntry(key, QueryResult::FINISHED | QueryResult::IN_USE);
+  return result;
+}
+
+// Results are shared with the history, not copied.
+TEST(HistoryTest, addAndGet)
+{
+  History history;
+  QueryResultPtr result = addFinished(&history, "a*", 3);
+  ASSERT_EQ(result, history.get("a*"));
+  ASSERT_EQ(result.get(), history.isContained("a*"));
+  ASSERT_EQ(3u, history.get("a*")->_docIds.size());
+  ASSERT_FALSE(history.get("b*"));
+  ASSERT_TRUE(history.isContained("b*") == NULL);
+  ASSERT_THROW(history.add("a*", std::make_shared<QueryResult>()), Exception);
+}
+
+// Removing a result that is in use does not free it.
+TEST(HistoryTest, removeWhileInUse)
+{
+  History history;
+  addFinished(&history, "a*", 3);
+  QueryResultPtr inUse = history.get("a*");
+  ASSERT_TRUE(history.remove("a*"));
+  ASSERT_FALSE(history.get("a*"));
+  ASSERT_EQ(0u, history.getNofQueries());
+  ASSERT_EQ(3u, inUse->_docIds.size());
+  ASSERT_EQ(1, inUse.use_count());
+}
+
+// Cutting the history removes results in use, but keeps those that are
+// being recomputed.
+TEST(HistoryTest, cutToSizeAndNumber)
+{
+  History history;
+  QueryResultPtr a = addFinished(&history, "a*", 3);
+  addFinished(&history, "b*", 5);
+  addFinished(&history, "c*", 7);
+  history.setStatusOfEntry("b*", QueryResult::UNDER_CONSTRUCTION);
+  ASSERT_EQ(3u, history.getNofQueries());
+  ASSERT_TRUE(history.cutToSizeAndNumber(0, 0));
+  ASSERT_EQ(1u, history.getNofQueries());
+  ASSERT_FALSE(history.get("a*"));
+  ASSERT_TRUE(history.get("b*"));
+  ASSERT_FALSE(history.get("c*"));
+  ASSERT_EQ(3u, a->_docIds.size());
+}
+
+// Counts are kept apart from the results, and the oldest are removed when
+// they get too large.
+TEST(HistoryTest, counts)
+{
+  History history;
+  std::shared_ptr<CompletionCounts> counts
+    = std::make_shared<CompletionCounts>();
+  counts->nofTotalHits = 5;
+  for (WordId w = 0; w < 10; w++) counts->wordIds.push_back(w);
+  size_t maxSize = 2 * (counts->sizeInBytes() + 2);
+  history.addCounts("a*", counts, maxSize);
+  history.addCounts("b*", counts, maxSize);
+  ASSERT_EQ(2u, history.getNofCounts());
+  ASSERT_EQ(0u, history.getNofQueries());
+  ASSERT_FALSE(history.get("a*"));
+  ASSERT_EQ(5u, history.getCounts("a*")->nofTotalHits);
+  history.addCounts("c*", counts, maxSize);
+  ASSERT_EQ(2u, history.getNofCounts());
+  ASSERT_FALSE(history.getCounts("a*"));
+  ASSERT_TRUE(history.getCounts("b*"));
+  ASSERT_TRUE(history.getCounts("c*"));
+  ASSERT_EQ(maxSize, history.countsSizeInBytes());
+  history.clear();
+  ASSERT_EQ(0u, history.getNofCounts());
+  ASSERT_EQ(0u, history.countsSizeInBytes());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
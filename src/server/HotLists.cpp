@@ -0,0 +1,421 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/HotLists.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include "server/Exception.h"
+#include "server/MappedFile.h"
+#include "server/Simple9CompressionAlgorithm.h"
+#include "server/ZipfCompressionAlgorithm.h"
+
+// Pointer to global HotLists object.
+HotLists* globalHotLists = NULL;
+
+namespace
+{
+const char HOT_LISTS_MAGIC[8] = { 'C', 'S', 'H', 'O', 'T', 'L', 'S', 'T' };
+const uint32_t HOT_LISTS_VERSION = 2;
+// The size of the table entry of one list, in version 2 and in version 1
+// (without the format).
+const size_t LIST_ENTRY_SIZE = 2 * sizeof(int32_t) + 6 * sizeof(uint64_t);
+const size_t LIST_ENTRY_SIZE_V1 = 2 * sizeof(int32_t) + 5 * sizeof(uint64_t);
+
+// Round up to a multiple of 8.
+uint64_t align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+
+// Pack the word ids minus base with the given number of bits each into uint64
+// words at the given address, and return their size in bytes.
+uint64_t packWordIds(const WordList& wordIds, WordId base, size_t width,
+                     char* p)
+{
+  if (width == 0) return 0;
+  vector<uint64_t> words((wordIds.size() * width + 63) / 64, 0);
+  for (size_t i = 0; i < wordIds.size(); i++)
+  {
+    uint64_t value = wordIds[i] - base;
+    size_t bit = i * width;
+    words[bit / 64] |= value << (bit % 64);
+    if (bit % 64 + width > 64) words[bit / 64 + 1] |= value >> (64 - bit % 64);
+  }
+  memcpy(p, &words[0], words.size() * sizeof(uint64_t));
+  return words.size() * sizeof(uint64_t);
+}
+
+// The word id with the given index, packed by packWordIds (minus base).
+uint64_t unpackWordId(const char* p, size_t width, size_t index)
+{
+  if (width == 0) return 0;
+  size_t bit = index * width;
+  uint64_t word;
+  memcpy(&word, p + bit / 64 * sizeof(uint64_t), sizeof(uint64_t));
+  uint64_t value = word >> (bit % 64);
+  if (bit % 64 + width > 64)
+  {
+    memcpy(&word, p + (bit / 64 + 1) * sizeof(uint64_t), sizeof(uint64_t));
+    value |= word << (64 - bit % 64);
+  }
+  return value & ((uint64_t(1) << width) - 1);
+}
+
+// Sort the most frequent prefixes first, and equally frequent ones by name.
+bool moreFrequent(const pair<string, size_t>& x,
+                  const pair<string, size_t>& y)
+{
+  return x.second != y.second ? x.second > y.second : x.first < y.first;
+}
+}
+
+// _____________________________________________________________________________
+HotLists::HotLists()
+{
+}
+
+// _____________________________________________________________________________
+void HotLists::add(WordId firstWordId, WordId lastWordId,
+                   const DocList& docIds, const Vector<Position>& positions,
+                   const WordList& wordIds, const Vector<DiskScore>& scores)
+{
+  size_t n = docIds.size();
+  CS_ASSERT_GT(n, 0);
+  CS_ASSERT_EQ(n, wordIds.size());
+  CS_ASSERT_EQ(n, scores.size());
+  CS_ASSERT(positions.size() == 0 || positions.size() == n);
+  CS_ASSERT_LE(firstWordId, lastWordId);
+  CS_ASSERT(_lists.empty() || _lists.back().firstWordId < firstWordId
+            || (_lists.back().firstWordId == firstWordId
+                && _lists.back().lastWordId < lastWordId));
+
+  // Room for each part in the worst case: the codebook of the word ids has one
+  // entry per word in the range.
+  List list;
+  list.firstWordId = firstWordId;
+  list.lastWordId = lastWordId;
+  list.nofPostings = n;
+  list.offset = _data.size();
+  // A bitmap only for dense lists with all word ids in the range (they are
+  // stored relative to firstWordId).
+  list.format = DocIdBitmap::isDense(docIds) ? 1 : 0;
+  for (size_t i = 0; i < n && list.format == 1; i++)
+    if (wordIds[i] < firstWordId || wordIds[i] > lastWordId) list.format = 0;
+  DocIdBitmap bitmap;
+  vector<char> bitmapBytes;
+  if (list.format == 1)
+  {
+    bitmap.build(docIds);
+    bitmap.write(&bitmapBytes);
+  }
+  size_t maxPartSize = (2 * n + (lastWordId - firstWordId + 1) + 1024)
+                       * sizeof(unsigned int);
+  _data.resize(list.offset + 3 * maxPartSize + align8(n) + bitmapBytes.size());
+  char* p = &_data[list.offset];
+
+  Simple9CompressionAlgorithm simple9;
+  if (list.format == 1)
+  {
+    memcpy(p, &bitmapBytes[0], bitmapBytes.size());
+    list.docIdsSize = bitmapBytes.size();
+  }
+  else
+  {
+    list.docIdsSize = align8(simple9.compress(docIds, p));
+  }
+  p += list.docIdsSize;
+  list.positionsSize = 0;
+  if (positions.size() > 0)
+  {
+    // 2 indicates: gaps with boundaries (as in the HYB blocks).
+    list.positionsSize = align8(simple9.compress(positions, p, 2));
+    p += list.positionsSize;
+  }
+  if (list.format == 1)
+  {
+    list.wordIdsSize = packWordIds(wordIds, firstWordId, wordIdWidth(list), p);
+  }
+  else
+  {
+    ZipfCompressionAlgorithm<WordId> zipf;
+    list.wordIdsSize = align8(zipf.compress(wordIds, p));
+  }
+  p += list.wordIdsSize;
+  memcpy(p, &scores[0], n * sizeof(DiskScore));
+  p += align8(n * sizeof(DiskScore));
+  _data.resize(p - &_data[0]);
+  _lists.push_back(list);
+  _bitmaps.push_back(bitmap);
+}
+
+// _____________________________________________________________________________
+void HotLists::write(const string& fileName, size_t nofWords) const
+{
+  FILE* file = fopen(fileName.c_str(), "w");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName
+             << "\" for writing");
+  uint32_t nofLists = _lists.size();
+  uint64_t nofWords64 = nofWords;
+  uint64_t headerSize = align8(sizeof(HOT_LISTS_MAGIC) + 2 * sizeof(uint32_t)
+                               + sizeof(uint64_t)
+                               + nofLists * LIST_ENTRY_SIZE);
+  writeOrThrow(file, HOT_LISTS_MAGIC, sizeof(HOT_LISTS_MAGIC), fileName);
+  writeOrThrow(file, &HOT_LISTS_VERSION, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofLists, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofWords64, sizeof(uint64_t), fileName);
+  for (size_t i = 0; i < _lists.size(); i++)
+  {
+    const List& list = _lists[i];
+    int32_t firstWordId = list.firstWordId;
+    int32_t lastWordId = list.lastWordId;
+    uint64_t offset = headerSize + list.offset;
+    writeOrThrow(file, &firstWordId, sizeof(int32_t), fileName);
+    writeOrThrow(file, &lastWordId, sizeof(int32_t), fileName);
+    writeOrThrow(file, &list.nofPostings, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &offset, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &list.docIdsSize, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &list.positionsSize, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &list.wordIdsSize, sizeof(uint64_t), fileName);
+    writeOrThrow(file, &list.format, sizeof(uint64_t), fileName);
+  }
+  const char zeros[8] = { 0 };
+  writeOrThrow(file, zeros, headerSize - ftell(file), fileName);
+  if (_data.size() > 0) writeOrThrow(file, &_data[0], _data.size(), fileName);
+  fclose(file);
+}
+
+// _____________________________________________________________________________
+void HotLists::read(const string& fileName, size_t nofWords)
+{
+  FILE* file = fopen(fileName.c_str(), "r");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open hot lists file \""
+             << fileName << "\"");
+  vector<char> contents;
+  char buffer[1 << 16];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.insert(contents.end(), buffer, buffer + n);
+  fclose(file);
+
+  // Parse the header.
+  const char* p = contents.empty() ? NULL : &contents[0];
+  uint32_t version;
+  uint32_t nofLists;
+  uint64_t fileNofWords;
+  size_t fixedSize = sizeof(HOT_LISTS_MAGIC) + 2 * sizeof(uint32_t)
+                     + sizeof(uint64_t);
+  if (contents.size() < fixedSize
+      || memcmp(p, HOT_LISTS_MAGIC, sizeof(HOT_LISTS_MAGIC)) != 0)
+    CS_THROW(Exception::OTHER, "\"" << fileName
+             << "\" is not a hot lists file");
+  p += sizeof(HOT_LISTS_MAGIC);
+  memcpy(&version, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&nofLists, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&fileNofWords, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+  if (version != HOT_LISTS_VERSION && version != 1)
+    CS_THROW(Exception::OTHER, "hot lists file \"" << fileName
+             << "\" has version " << version << ", expected "
+             << HOT_LISTS_VERSION);
+  if (fileNofWords != nofWords)
+    CS_THROW(Exception::OTHER, "hot lists file \"" << fileName
+             << "\" was written for " << fileNofWords << " words, but the "
+             << "vocabulary has " << nofWords);
+  size_t entrySize = version == 1 ? LIST_ENTRY_SIZE_V1 : LIST_ENTRY_SIZE;
+  uint64_t headerSize = align8(fixedSize + nofLists * entrySize);
+  if (contents.size() < headerSize)
+    CS_THROW(Exception::OTHER, "hot lists file \"" << fileName
+             << "\" is truncated");
+
+  // Read the table, with offsets relative to the data after the header.
+  vector<List> lists(nofLists);
+  uint64_t dataSize = contents.size() - headerSize;
+  for (uint32_t i = 0; i < nofLists; i++)
+  {
+    List& list = lists[i];
+    int32_t firstWordId;
+    int32_t lastWordId;
+    memcpy(&firstWordId, p, sizeof(int32_t)); p += sizeof(int32_t);
+    memcpy(&lastWordId, p, sizeof(int32_t)); p += sizeof(int32_t);
+    memcpy(&list.nofPostings, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&list.offset, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&list.docIdsSize, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&list.positionsSize, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    memcpy(&list.wordIdsSize, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+    list.format = 0;
+    if (version > 1)
+    {
+      memcpy(&list.format, p, sizeof(uint64_t));
+      p += sizeof(uint64_t);
+    }
+    list.firstWordId = firstWordId;
+    list.lastWordId = lastWordId;
+    list.offset -= headerSize;
+    if (list.offset > dataSize
+        || dataSize - list.offset < list.docIdsSize + list.positionsSize
+                                    + list.wordIdsSize + list.nofPostings
+        || firstWordId > lastWordId
+        || (uint64_t) lastWordId >= nofWords
+        || list.format > 1
+        || (list.format == 1
+            && list.wordIdsSize * 8 < list.nofPostings * wordIdWidth(list))
+        || (i > 0 && !(lists[i - 1].firstWordId < firstWordId
+                       || (lists[i - 1].firstWordId == firstWordId
+                           && lists[i - 1].lastWordId < lastWordId))))
+      CS_THROW(Exception::OTHER, "hot lists file \"" << fileName
+               << "\" has an invalid entry for list #" << i);
+  }
+  // The bitmaps, which must have one doc id per posting.
+  vector<DocIdBitmap> bitmaps(nofLists);
+  for (uint32_t i = 0; i < nofLists; i++)
+  {
+    if (lists[i].format != 1) continue;
+    bitmaps[i].read(&contents[0] + headerSize + lists[i].offset,
+                    lists[i].docIdsSize);
+    if (bitmaps[i].count() != lists[i].nofPostings)
+      CS_THROW(Exception::OTHER, "hot lists file \"" << fileName
+               << "\" has an invalid bitmap for list #" << i);
+  }
+  _lists.swap(lists);
+  _bitmaps.swap(bitmaps);
+  _data.assign(contents.begin() + headerSize, contents.end());
+}
+
+// _____________________________________________________________________________
+size_t HotLists::getNofPostings() const
+{
+  size_t nofPostings = 0;
+  for (size_t i = 0; i < _lists.size(); i++)
+    nofPostings += _lists[i].nofPostings;
+  return nofPostings;
+}
+
+// _____________________________________________________________________________
+int HotLists::find(WordId firstWordId, WordId lastWordId) const
+{
+  size_t low = 0;
+  size_t high = _lists.size();
+  while (low < high)
+  {
+    size_t middle = low + (high - low) / 2;
+    const List& list = _lists[middle];
+    if (list.firstWordId < firstWordId
+        || (list.firstWordId == firstWordId && list.lastWordId < lastWordId))
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low < _lists.size() && _lists[low].firstWordId == firstWordId
+      && _lists[low].lastWordId == lastWordId)
+    return low;
+  return -1;
+}
+
+// _____________________________________________________________________________
+void HotLists::get(int listId, DocList* docIds, Vector<Position>* positions,
+                   WordList* wordIds, Vector<DiskScore>* scores,
+                   bool decodePositions) const
+{
+  const List& list = _lists[listId];
+  size_t n = list.nofPostings;
+  const char* p = &_data[list.offset];
+
+  Simple9CompressionAlgorithm simple9;
+  if (list.format == 1)
+  {
+    docIds->clear();
+    _bitmaps[listId].getDocIds(docIds);
+  }
+  else
+  {
+    docIds->resize(n);
+    simple9.decompress(p, &(*docIds)[0], n);
+  }
+  p += list.docIdsSize;
+  positions->clear();
+  if (decodePositions && list.positionsSize > 0)
+  {
+    positions->resize(n);
+    simple9.decompress(p, &(*positions)[0], n, 2);
+  }
+  p += list.positionsSize;
+  wordIds->resize(n);
+  if (list.format == 1)
+  {
+    size_t width = wordIdWidth(list);
+    for (size_t i = 0; i < n; i++)
+      (*wordIds)[i] = list.firstWordId + unpackWordId(p, width, i);
+  }
+  else
+  {
+    ZipfCompressionAlgorithm<WordId> zipf;
+    zipf.decompress(p, &(*wordIds)[0], n);
+  }
+  p += list.wordIdsSize;
+  scores->resize(n);
+  memcpy(&(*scores)[0], p, n * sizeof(DiskScore));
+}
+
+// _____________________________________________________________________________
+void HotLists::getForDocs(int listId, const DocList& docIds,
+                          DocList* resultDocIds, WordList* wordIds,
+                          Vector<DiskScore>* scores) const
+{
+  CS_ASSERT(hasBitmap(listId));
+  const List& list = _lists[listId];
+  vector<uint32_t> ranks;
+  resultDocIds->clear();
+  _bitmaps[listId].intersect(docIds, resultDocIds, &ranks);
+  const char* p = &_data[list.offset] + list.docIdsSize + list.positionsSize;
+  const char* diskScores = p + list.wordIdsSize;
+  size_t width = wordIdWidth(list);
+  wordIds->resize(ranks.size());
+  scores->resize(ranks.size());
+  for (size_t i = 0; i < ranks.size(); i++)
+  {
+    (*wordIds)[i] = list.firstWordId + unpackWordId(p, width, ranks[i]);
+    memcpy(&(*scores)[i], diskScores + ranks[i] * sizeof(DiskScore),
+           sizeof(DiskScore));
+  }
+}
+
+// _____________________________________________________________________________
+size_t HotLists::wordIdWidth(const List& list)
+{
+  uint32_t range = list.lastWordId - list.firstWordId;
+  size_t width = 0;
+  while (width < 32 && (range >> width) != 0) width++;
+  return width;
+}
+
+// _____________________________________________________________________________
+vector<pair<string, size_t> > HotLists::countPrefixes(const string& fileName)
+{
+  FILE* file = fopen(fileName.c_str(), "r");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName << "\"");
+  std::map<string, size_t> counts;
+  char* line = NULL;
+  size_t capacity = 0;
+  ssize_t length;
+  while ((length = getline(&line, &capacity, file)) != -1)
+  {
+    const char* p = line;
+    const char* end = line + length;
+    while (p < end)
+    {
+      while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+      const char* word = p;
+      while (p < end && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+        p++;
+      if (word < p && *word == '-') word++;
+      if (p - word >= 2) counts[string(word, p - word)]++;
+    }
+  }
+  free(line);
+  fclose(file);
+  vector<pair<string, size_t> > prefixes(counts.begin(), counts.end());
+  std::sort(prefixes.begin(), prefixes.end(), &moreFrequent);
+  return prefixes;
+}
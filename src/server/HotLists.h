@@ -0,0 +1,143 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_HOTLISTS_H_
+#define SERVER_HOTLISTS_H_
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "server/Globals.h"
+#include "server/DocIdBitmap.h"
+#include "server/DocList.h"
+#include "server/WordList.h"
+#include "server/Vector.h"
+
+using std::pair;
+using std::string;
+using std::vector;
+
+// Materialised posting lists for hot word ranges, typically those of short or
+// frequently queried prefixes like a* or :facet:author:*. Without them, the
+// HYB completer reads every block overlapping such a range, filters the
+// postings by word id and sorts them by doc id, for every query that misses
+// the history. A hot list is exactly that result, compressed like a HYB block
+// and kept in memory by the server, so that processBasicQuery can use it like
+// a single block.
+//
+// Dense lists with one posting per doc, typically those of popular facet
+// values like :facet:type:article, keep their doc ids as a DocIdBitmap. For
+// these, a query that only needs the postings in the docs of its input list
+// (see getForDocs) intersects the input with the bitmap and picks the word ids
+// and scores of the matches by rank, without decompressing the list.
+//
+// The file <basename>.hot-lists is written by buildIndex (option -H) and read
+// by the server (option --read-hot-lists).
+//
+// File format (all numbers in host byte order):
+//   "CSHOTLST" <uint32 version> <uint32 nofLists> <uint64 nofWords>
+//   per list: <int32 firstWordId> <int32 lastWordId> <uint64 nofPostings>
+//             <uint64 offset> <uint64 size of doc ids>
+//             <uint64 size of positions> <uint64 size of word ids>
+//             <uint64 format>
+//   per list, at the given offset: the doc ids, the positions (Simple9, gaps
+//             with boundaries; size 0 if there are none), the word ids and the
+//             nofPostings scores (one DiskScore each), each part padded to 8
+//             bytes. With format 0, the doc ids are Simple9 (gaps) and the word
+//             ids Zipf. With format 1, the doc ids are a DocIdBitmap, and the
+//             word ids minus firstWordId are packed into uint64 words with as
+//             many bits as lastWordId - firstWordId needs.
+// The lists are sorted by word range, and no two lists have the same range.
+// Files of version 1 have no format in the table (all lists are format 0).
+class HotLists
+{
+ public:
+  HotLists();
+
+  // Add the list for the word range [firstWordId, lastWordId]. The postings
+  // must be sorted by doc id, positions may be empty. Ranges must be added in
+  // increasing order. The list is stored with a bitmap if
+  // DocIdBitmap::isDense holds for its doc ids.
+  void add(WordId firstWordId, WordId lastWordId, const DocList& docIds,
+           const Vector<Position>& positions, const WordList& wordIds,
+           const Vector<DiskScore>& scores);
+
+  // Write the lists to the given file. The number of words of the vocabulary
+  // is stored, so that a file for a different index is recognised.
+  void write(const string& fileName, size_t nofWords) const;
+
+  // Read the lists from the given file. Throws an exception if the file does
+  // not exist, has the wrong format or was written for a vocabulary of a
+  // different size.
+  void read(const string& fileName, size_t nofWords);
+
+  // The number of lists, and the total number of postings in them.
+  size_t getNofLists() const { return _lists.size(); }
+  size_t getNofPostings() const;
+
+  // The size of the compressed lists in bytes.
+  size_t getSizeInBytes() const { return _data.size(); }
+
+  // The id of the list for exactly the given word range, or -1 if there is
+  // none.
+  int find(WordId firstWordId, WordId lastWordId) const;
+
+  // The word range and number of postings of the list with the given id.
+  WordId getFirstWordId(int listId) const { return _lists[listId].firstWordId; }
+  WordId getLastWordId(int listId) const { return _lists[listId].lastWordId; }
+  size_t getNofPostings(int listId) const { return _lists[listId].nofPostings; }
+
+  // Decompress the list with the given id. The positions are only decompressed
+  // if decodePositions is true (otherwise positions is left empty).
+  void get(int listId, DocList* docIds, Vector<Position>* positions,
+           WordList* wordIds, Vector<DiskScore>* scores,
+           bool decodePositions) const;
+
+  // Whether the list with the given id is stored with a bitmap, and the
+  // bitmap (e.g. for its count).
+  bool hasBitmap(int listId) const { return _lists[listId].format == 1; }
+  const DocIdBitmap& getBitmap(int listId) const { return _bitmaps[listId]; }
+
+  // The postings of the list with the given id (which must have a bitmap) in
+  // the docs of the given sorted list of doc ids, without positions.
+  void getForDocs(int listId, const DocList& docIds, DocList* resultDocIds,
+                  WordList* wordIds, Vector<DiskScore>* scores) const;
+
+  // Count the words (with at least two characters) in the given file with one
+  // query per line, e.g. extracted from a query log: the prefixes ending in *,
+  // and the exact words like :facet:type:article, whose list can be dense. A
+  // leading - of a word is ignored. Returns the distinct words with their
+  // counts, most frequent first.
+  static vector<pair<string, size_t> > countPrefixes(const string& fileName);
+
+ private:
+  struct List
+  {
+    WordId firstWordId;
+    WordId lastWordId;
+    uint64_t nofPostings;
+    uint64_t offset;
+    uint64_t docIdsSize;
+    uint64_t positionsSize;
+    uint64_t wordIdsSize;
+    uint64_t format;
+  };
+
+  // The number of bits per word id of a list with a bitmap.
+  static size_t wordIdWidth(const List& list);
+
+  // The lists, sorted by word range, and their compressed data.
+  vector<List> _lists;
+  vector<char> _data;
+
+  // For each list, its doc ids if it is stored with a bitmap (otherwise
+  // empty).
+  vector<DocIdBitmap> _bitmaps;
+};
+
+// Whoever includes this should be able to use the global HotLists object
+// declared in the .cpp file (NULL if no hot lists were read).
+extern HotLists* globalHotLists;
+
+#endif  // SERVER_HOTLISTS_H_
@@ -0,0 +1,175 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "server/HotLists.h"
+#include "server/Exception.h"
+
+// Fill the given lists with n postings for the word range [first, last],
+// sorted by doc id.
+void makeList(size_t n, WordId first, WordId last, DocList* docIds,
+              Vector<Position>* positions, WordList* wordIds,
+              Vector<DiskScore>* scores)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    docIds->push_back(3 * i / 2 + 1);
+    positions->push_back(i % 5 == 0 ? 1 : 7 * i % 101);
+    wordIds->push_back(first + (i * i) % (last - first + 1));
+    scores->push_back(i % 200 + 1);
+  }
+}
+
+// Write some lists, read them back and decompress them.
+TEST(HotListsTest, writeAndRead)
+{
+  string fileName = "HotListsTest.TMP.hot-lists";
+  DocList docIds[2];
+  Vector<Position> positions[2];
+  WordList wordIds[2];
+  Vector<DiskScore> scores[2];
+  makeList(1000, 10, 20, &docIds[0], &positions[0], &wordIds[0], &scores[0]);
+  makeList(3, 10, 12, &docIds[1], &positions[1], &wordIds[1], &scores[1]);
+  {
+    HotLists hotLists;
+    hotLists.add(10, 20, docIds[0], positions[0], wordIds[0], scores[0]);
+    // Without positions.
+    Vector<Position> noPositions;
+    hotLists.add(11, 12, docIds[1], noPositions, wordIds[1], scores[1]);
+    // Ranges must be added in order.
+    ASSERT_THROW(hotLists.add(10, 12, docIds[1], noPositions, wordIds[1],
+                              scores[1]), Exception);
+    hotLists.write(fileName, 100);
+  }
+  HotLists hotLists;
+  hotLists.read(fileName, 100);
+  ASSERT_EQ(2u, hotLists.getNofLists());
+  ASSERT_EQ(1003u, hotLists.getNofPostings());
+  ASSERT_EQ(0, hotLists.find(10, 20));
+  ASSERT_EQ(1, hotLists.find(11, 12));
+  ASSERT_EQ(-1, hotLists.find(10, 12));
+  ASSERT_EQ(-1, hotLists.find(11, 20));
+  ASSERT_EQ(-1, hotLists.find(30, 40));
+  ASSERT_EQ(11, hotLists.getFirstWordId(1));
+  ASSERT_EQ(3u, hotLists.getNofPostings(1));
+
+  DocList docIdsRead;
+  Vector<Position> positionsRead;
+  WordList wordIdsRead;
+  Vector<DiskScore> scoresRead;
+  hotLists.get(0, &docIdsRead, &positionsRead, &wordIdsRead, &scoresRead,
+               true);
+  ASSERT_EQ(docIds[0].asString(), docIdsRead.asString());
+  ASSERT_EQ(positions[0].asString(), positionsRead.asString());
+  ASSERT_EQ(wordIds[0].asString(), wordIdsRead.asString());
+  ASSERT_EQ(scores[0].asString(), scoresRead.asString());
+  hotLists.get(0, &docIdsRead, &positionsRead, &wordIdsRead, &scoresRead,
+               false);
+  ASSERT_EQ(0u, positionsRead.size());
+  ASSERT_EQ(wordIds[0].asString(), wordIdsRead.asString());
+  hotLists.get(1, &docIdsRead, &positionsRead, &wordIdsRead, &scoresRead,
+               true);
+  ASSERT_EQ(docIds[1].asString(), docIdsRead.asString());
+  ASSERT_EQ(0u, positionsRead.size());
+  ASSERT_EQ(wordIds[1].asString(), wordIdsRead.asString());
+  ASSERT_EQ(scores[1].asString(), scoresRead.asString());
+
+  // A file for a different vocabulary, and a file that is not a hot lists file.
+  ASSERT_THROW(hotLists.read(fileName, 99), Exception);
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "this is not a hot lists file\n");
+  fclose(file);
+  ASSERT_THROW(hotLists.read(fileName, 100), Exception);
+  ASSERT_THROW(hotLists.read("HotListsTest.TMP.nonexisting", 100), Exception);
+  remove(fileName.c_str());
+}
+
+// A dense list is stored with a bitmap, a list with more than one posting per
+// doc is not. Fetch the postings for the docs of another list.
+TEST(HotListsTest, bitmapLists)
+{
+  string fileName = "HotListsTest.TMP.hot-lists";
+  DocList docIds[2];
+  Vector<Position> positions[2];
+  WordList wordIds[2];
+  Vector<DiskScore> scores[2];
+  makeList(1000, 10, 20, &docIds[0], &positions[0], &wordIds[0], &scores[0]);
+  makeList(5, 30, 30, &docIds[1], &positions[1], &wordIds[1], &scores[1]);
+  docIds[1][1] = docIds[1][0];
+  {
+    HotLists hotLists;
+    hotLists.add(10, 20, docIds[0], positions[0], wordIds[0], scores[0]);
+    hotLists.add(30, 30, docIds[1], positions[1], wordIds[1], scores[1]);
+    hotLists.write(fileName, 100);
+  }
+  HotLists hotLists;
+  hotLists.read(fileName, 100);
+  ASSERT_TRUE(hotLists.hasBitmap(0));
+  ASSERT_FALSE(hotLists.hasBitmap(1));
+  ASSERT_EQ(1000u, hotLists.getBitmap(0).count());
+  DocList docIdsRead;
+  Vector<Position> positionsRead;
+  WordList wordIdsRead;
+  Vector<DiskScore> scoresRead;
+  for (int listId = 0; listId < 2; listId++)
+  {
+    hotLists.get(listId, &docIdsRead, &positionsRead, &wordIdsRead,
+                 &scoresRead, true);
+    ASSERT_EQ(docIds[listId].asString(), docIdsRead.asString());
+    ASSERT_EQ(positions[listId].asString(), positionsRead.asString());
+    ASSERT_EQ(wordIds[listId].asString(), wordIdsRead.asString());
+    ASSERT_EQ(scores[listId].asString(), scoresRead.asString());
+  }
+
+  // The docs 1, 2, ..., 200 (with duplicates), of which every third is not in
+  // the list.
+  DocList docs;
+  for (DocId d = 1; d <= 200; d++)
+  {
+    docs.push_back(d);
+    if (d % 10 == 0) docs.push_back(d);
+  }
+  hotLists.getForDocs(0, docs, &docIdsRead, &wordIdsRead, &scoresRead);
+  ASSERT_EQ(134u, docIdsRead.size());
+  ASSERT_EQ(docIdsRead.size(), wordIdsRead.size());
+  ASSERT_EQ(docIdsRead.size(), scoresRead.size());
+  for (size_t i = 0; i < docIdsRead.size(); i++)
+  {
+    ASSERT_EQ(docIds[0][i], docIdsRead[i]);
+    ASSERT_EQ(wordIds[0][i], wordIdsRead[i]);
+    ASSERT_EQ(scores[0][i], scoresRead[i]);
+  }
+  remove(fileName.c_str());
+}
+
+// Count the prefixes and words in a file with queries.
+TEST(HotListsTest, countPrefixes)
+{
+  string fileName = "HotListsTest.TMP.queries";
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "a* b*\n");
+  fprintf(file, "info* -b*\tc\r\n");
+  fprintf(file, "* b* a* b*\n");
+  fprintf(file, "  :facet:x\n");
+  fclose(file);
+  vector<pair<string, size_t> > prefixes = HotLists::countPrefixes(fileName);
+  ASSERT_EQ(4u, prefixes.size());
+  ASSERT_EQ("b*", prefixes[0].first);
+  ASSERT_EQ(4u, prefixes[0].second);
+  ASSERT_EQ("a*", prefixes[1].first);
+  ASSERT_EQ(2u, prefixes[1].second);
+  ASSERT_EQ(":facet:x", prefixes[2].first);
+  ASSERT_EQ(1u, prefixes[2].second);
+  ASSERT_EQ("info*", prefixes[3].first);
+  ASSERT_EQ(1u, prefixes[3].second);
+  remove(fileName.c_str());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
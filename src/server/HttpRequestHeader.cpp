@@ -0,0 +1,106 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <string.h>
+#include <strings.h>
+#include "server/HttpRequestHeader.h"
+
+namespace {
+// The end of the line starting at the given position, that is, the position of
+// the next "\r\n" (or the end of the header).
+const char* lineEnd(const char* p, const char* end)
+{
+  while (p < end)
+  {
+    const char* cr = static_cast<const char*>(memchr(p, '\r', end - p));
+    if (cr == NULL) return end;
+    if (cr + 1 < end && cr[1] == '\n') return cr;
+    p = cr + 1;
+  }
+  return end;
+}
+}
+
+// _____________________________________________________________________________
+HttpRequestHeader::HttpRequestHeader()
+{
+  Range none = { 0, 0 };
+  method = target = connection = contentLength = contentType = expect = none;
+  requestLineLength = 0;
+  hasVersion = false;
+  isHttp11 = false;
+  hasJsonContent = false;
+}
+
+// _____________________________________________________________________________
+bool HttpRequestHeader::parse(const char* header, size_t length)
+{
+  *this = HttpRequestHeader();
+  const char* end = header + length;
+
+  // The request line: "<method> <target> HTTP/1.x".
+  const char* line = header;
+  const char* eol = lineEnd(line, end);
+  requestLineLength = eol - line;
+  const char* space = static_cast<const char*>(memchr(line, ' ', eol - line));
+  method.length = (space != NULL ? space : eol) - line;
+  if (space != NULL)
+  {
+    static const char version[] = " HTTP/1.";
+    static const size_t versionLength = sizeof(version) - 1;
+    target.begin = space + 1 - header;
+    for (const char* p = space; p + versionLength <= eol; p++)
+    {
+      if (*p == ' ' && memcmp(p, version, versionLength) == 0)
+      {
+        target.length = p - (space + 1);
+        hasVersion = true;
+        isHttp11 = p + versionLength < eol && p[versionLength] == '1';
+        break;
+      }
+    }
+  }
+
+  // The header fields: "<name>: <value>".
+  while (eol < end)
+  {
+    line = eol + 2;
+    eol = lineEnd(line, end);
+    const char* colon = static_cast<const char*>(memchr(line, ':', eol - line));
+    if (colon == NULL) continue;
+    Range* field = NULL;
+    size_t nameLength = colon - line;
+    if (nameLength == 10 && strncasecmp(line, "Connection", 10) == 0)
+      field = &connection;
+    else if (nameLength == 14 && strncasecmp(line, "Content-Length", 14) == 0)
+      field = &contentLength;
+    else if (nameLength == 12 && strncasecmp(line, "Content-Type", 12) == 0)
+      field = &contentType;
+    else if (nameLength == 6 && strncasecmp(line, "Expect", 6) == 0)
+      field = &expect;
+    if (field == NULL || field->begin != 0) continue;
+    const char* value = colon + 1;
+    while (value < eol && (*value == ' ' || *value == '\t')) value++;
+    field->begin = value - header;
+    field->length = eol - value;
+  }
+  hasJsonContent = contentType.length >= 16
+    && strncasecmp(header + contentType.begin, "application/json", 16) == 0;
+  return hasVersion;
+}
+
+// _____________________________________________________________________________
+bool HttpRequestHeader::equals(const char* header, const Range& range,
+                               const char* s)
+{
+  return strlen(s) == range.length
+         && memcmp(header + range.begin, s, range.length) == 0;
+}
+
+// _____________________________________________________________________________
+bool HttpRequestHeader::equalsIgnoreCase(const char* header,
+                                         const Range& range, const char* s)
+{
+  return strlen(s) == range.length
+         && strncasecmp(header + range.begin, s, range.length) == 0;
+}
@@ -0,0 +1,63 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_HTTPREQUESTHEADER_H_
+#define SERVER_HTTPREQUESTHEADER_H_
+
+#include <stddef.h>
+#include <string>
+
+using std::string;
+
+// The parts of an HTTP request header that the completion server needs, found
+// in one pass over the header. The parts are given as ranges of the parsed
+// header, nothing is copied.
+class HttpRequestHeader
+{
+ public:
+  // A part of the header: its offset and length (both 0 if it is missing).
+  struct Range
+  {
+    size_t begin;
+    size_t length;
+  };
+
+  HttpRequestHeader();
+
+  // Parse the given header (the request line and the header fields, without
+  // the empty line at the end). Returns false if the request line is not of
+  // the form "<method> <target> HTTP/1.x"; the parts found are set anyway.
+  bool parse(const char* header, size_t length);
+
+  // Whether the given part of the header is the given string, with and without
+  // ignoring case.
+  static bool equals(const char* header, const Range& range, const char* s);
+  static bool equalsIgnoreCase(const char* header, const Range& range,
+                               const char* s);
+
+  // The given part of the header as a string.
+  static string asString(const char* header, const Range& range)
+  {
+    return string(header + range.begin, range.length);
+  }
+
+  // The method (the first word of the request line) and the request target
+  // (e.g. "/?q=test&h=10").
+  Range method;
+  Range target;
+  // The length of the request line.
+  size_t requestLineLength;
+  // Whether the request line has the HTTP version, and whether it is 1.1.
+  bool hasVersion;
+  bool isHttp11;
+  // The values of the header fields used by the server (without leading
+  // whitespace). If a field occurs more than once, the first one counts.
+  Range connection;
+  Range contentLength;
+  Range contentType;
+  Range expect;
+  // Whether the content type is application/json.
+  bool hasJsonContent;
+};
+
+#endif  // SERVER_HTTPREQUESTHEADER_H_
@@ -0,0 +1,68 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <string>
+#include "server/HttpRequestHeader.h"
+
+// A GET request with some header fields.
+TEST(HttpRequestHeaderTest, parseGet)
+{
+  string request = "GET /?q=test&h=10 HTTP/1.1\r\n"
+                   "Host: localhost:8888\r\n"
+                   "connection:  Close\r\n"
+                   "Connection: keep-alive";
+  const char* header = request.data();
+  HttpRequestHeader h;
+  ASSERT_TRUE(h.parse(header, request.size()));
+  ASSERT_TRUE(HttpRequestHeader::equals(header, h.method, "GET"));
+  ASSERT_EQ("/?q=test&h=10", HttpRequestHeader::asString(header, h.target));
+  ASSERT_EQ(26u, h.requestLineLength);
+  ASSERT_TRUE(h.isHttp11);
+  // The first field counts, names are case insensitive.
+  ASSERT_EQ("Close", HttpRequestHeader::asString(header, h.connection));
+  ASSERT_TRUE(HttpRequestHeader::equalsIgnoreCase(header, h.connection,
+                                                  "close"));
+  ASSERT_FALSE(HttpRequestHeader::equals(header, h.connection, "close"));
+  ASSERT_EQ(0u, h.contentLength.length);
+  ASSERT_EQ(0u, h.expect.length);
+  ASSERT_FALSE(h.hasJsonContent);
+}
+
+// A POST request with a JSON body.
+TEST(HttpRequestHeaderTest, parsePost)
+{
+  string request = "POST / HTTP/1.0\r\n"
+                   "Content-Length: 12\r\n"
+                   "Content-Type: application/json; charset=UTF-8\r\n"
+                   "Expect: 100-continue";
+  const char* header = request.data();
+  HttpRequestHeader h;
+  ASSERT_TRUE(h.parse(header, request.size()));
+  ASSERT_TRUE(HttpRequestHeader::equals(header, h.method, "POST"));
+  ASSERT_EQ("/", HttpRequestHeader::asString(header, h.target));
+  ASSERT_FALSE(h.isHttp11);
+  ASSERT_EQ("12", HttpRequestHeader::asString(header, h.contentLength));
+  ASSERT_EQ("100-continue", HttpRequestHeader::asString(header, h.expect));
+  ASSERT_TRUE(h.hasJsonContent);
+}
+
+// Request lines without HTTP version or target.
+TEST(HttpRequestHeaderTest, parseInvalid)
+{
+  HttpRequestHeader h;
+  string request = "GET /?q=test\r\nHost: localhost";
+  ASSERT_FALSE(h.parse(request.data(), request.size()));
+  ASSERT_TRUE(HttpRequestHeader::equals(request.data(), h.method, "GET"));
+  ASSERT_EQ(12u, h.requestLineLength);
+  request = "GET";
+  ASSERT_FALSE(h.parse(request.data(), request.size()));
+  ASSERT_TRUE(HttpRequestHeader::equals(request.data(), h.method, "GET"));
+  ASSERT_EQ(0u, h.target.length);
+  ASSERT_FALSE(h.parse("", 0));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,277 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/InfixIndex.h"
+#include <string.h>
+#include <algorithm>
+
+// gsacak.h defines its own MAX, keep the one of Globals.h.
+#pragma push_macro("MAX")
+#undef MAX
+extern "C" {
+#include "partialwords/gsacak.h"
+}
+#undef MAX
+#pragma pop_macro("MAX")
+
+// Pointer to global InfixIndex object.
+InfixIndex* globalInfixIndex = NULL;
+
+namespace
+{
+const char INFIX_INDEX_MAGIC[8] = { 'C', 'S', 'I', 'N', 'F', 'I', 'X', 'I' };
+const uint32_t INFIX_INDEX_VERSION = 1;
+const uint16_t NO_CODE = 0xffff;
+
+// The number of 64-bit words between two samples of the rank directory.
+const uint64_t WORDS_PER_RANK_SAMPLE = 8;
+
+// The number of 64-bit words and rank samples of a level with n bits.
+uint64_t nofBitWords(uint64_t n) { return (n + 63) / 64; }
+uint64_t nofRankSamples(uint64_t n)
+{
+  return nofBitWords(n) / WORDS_PER_RANK_SAMPLE + 1;
+}
+
+// The size of the fixed part of the file, up to the zeros of the levels.
+const size_t HEADER_SIZE = sizeof(INFIX_INDEX_MAGIC) + 2 * sizeof(uint32_t)
+                           + 2 * sizeof(uint64_t) + 256 * sizeof(uint16_t)
+                           + 257 * sizeof(uint64_t) + 256 * sizeof(uint64_t);
+}
+
+// _____________________________________________________________________________
+InfixIndex::InfixIndex()
+  : _nofLevels(0), _textLength(0), _nofWords(0), _codes(NULL), _counts(NULL),
+    _starts(NULL), _zeros(NULL)
+{
+}
+
+// _____________________________________________________________________________
+void InfixIndex::write(const string& fileName, vector<unsigned char>* text,
+                       uint64_t nofWords)
+{
+  // The suffix array of the text, with the separators \1 like for the partial
+  // words, and from it the BWT.
+  const uint64_t n = text->size();
+  if (n >= static_cast<uint64_t>(U_MAX))
+    CS_THROW(Exception::OTHER, "vocabulary too large for an infix index ("
+             << n << " bytes)");
+  vector<uint_t> suffixArray(n);
+  gsacak(&(*text)[0], &suffixArray[0], NULL, NULL, n);
+
+  // Number the distinct bytes of the text in increasing order.
+  uint16_t codes[256];
+  uint64_t counts[257] = { 0 };
+  bool occurs[256] = { false };
+  for (uint64_t i = 0; i < n; i++) occurs[(*text)[i]] = true;
+  uint32_t nofCodes = 0;
+  for (int b = 0; b < 256; b++) codes[b] = occurs[b] ? nofCodes++ : NO_CODE;
+  uint32_t nofLevels = 1;
+  while ((1u << nofLevels) < nofCodes) nofLevels++;
+
+  // The codes of the BWT, which is the first level.
+  vector<unsigned char> level(n);
+  for (uint64_t i = 0; i < n; i++)
+  {
+    level[i] = codes[suffixArray[i] > 0 ? (*text)[suffixArray[i] - 1]
+                                        : (*text)[n - 1]];
+    counts[level[i] + 1]++;
+  }
+  vector<uint_t>().swap(suffixArray);
+  vector<unsigned char>().swap(*text);
+  for (int c = 0; c < 256; c++) counts[c + 1] += counts[c];
+
+  // The levels of the wavelet matrix: level l has the bit nofLevels - 1 - l of
+  // each code, after which the codes are stably partitioned by that bit for
+  // the next level.
+  vector<uint64_t> zeros(nofLevels, 0);
+  vector<vector<uint64_t> > bits(nofLevels);
+  vector<vector<uint64_t> > ranks(nofLevels);
+  vector<unsigned char> nextLevel(n);
+  for (uint32_t l = 0; l < nofLevels; l++)
+  {
+    const uint32_t shift = nofLevels - 1 - l;
+    bits[l].assign(nofBitWords(n), 0);
+    for (uint64_t i = 0; i < n; i++)
+    {
+      if ((level[i] >> shift) & 1) bits[l][i / 64] |= uint64_t(1) << (i % 64);
+      else zeros[l]++;
+    }
+    ranks[l].resize(nofRankSamples(n));
+    uint64_t ones = 0;
+    for (uint64_t w = 0; w <= bits[l].size(); w++)
+    {
+      if (w % WORDS_PER_RANK_SAMPLE == 0)
+        ranks[l][w / WORDS_PER_RANK_SAMPLE] = ones;
+      if (w < bits[l].size()) ones += __builtin_popcountll(bits[l][w]);
+    }
+    uint64_t nextZero = 0;
+    uint64_t nextOne = zeros[l];
+    for (uint64_t i = 0; i < n; i++)
+    {
+      if ((level[i] >> shift) & 1) nextLevel[nextOne++] = level[i];
+      else nextLevel[nextZero++] = level[i];
+    }
+    level.swap(nextLevel);
+  }
+
+  // At the last level, the occurrences of each code are consecutive.
+  uint64_t starts[256] = { 0 };
+  for (uint64_t i = n; i > 0; i--) starts[level[i - 1]] = i - 1;
+
+  FILE* file = fopen(fileName.c_str(), "w");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName
+             << "\" for writing");
+  writeOrThrow(file, INFIX_INDEX_MAGIC, sizeof(INFIX_INDEX_MAGIC), fileName);
+  writeOrThrow(file, &INFIX_INDEX_VERSION, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &nofLevels, sizeof(uint32_t), fileName);
+  writeOrThrow(file, &n, sizeof(uint64_t), fileName);
+  writeOrThrow(file, &nofWords, sizeof(uint64_t), fileName);
+  writeOrThrow(file, codes, sizeof(codes), fileName);
+  writeOrThrow(file, counts, sizeof(counts), fileName);
+  writeOrThrow(file, starts, sizeof(starts), fileName);
+  writeOrThrow(file, &zeros[0], nofLevels * sizeof(uint64_t), fileName);
+  for (uint32_t l = 0; l < nofLevels; l++)
+  {
+    writeOrThrow(file, &bits[l][0], bits[l].size() * sizeof(uint64_t),
+                 fileName);
+    writeOrThrow(file, &ranks[l][0], ranks[l].size() * sizeof(uint64_t),
+                 fileName);
+  }
+  fclose(file);
+}
+
+// _____________________________________________________________________________
+void InfixIndex::open(const string& fileName)
+{
+  _file.open(fileName, "infix index file");
+  const char* mapped = _file.data();
+  size_t size = _file.size();
+  _bits.clear();
+  _ranks.clear();
+
+  // Parse the header.
+  const char* p = static_cast<const char*>(mapped);
+  uint32_t version;
+  if (size < HEADER_SIZE
+      || memcmp(p, INFIX_INDEX_MAGIC, sizeof(INFIX_INDEX_MAGIC)) != 0)
+    CS_THROW(Exception::OTHER, "\"" << fileName
+             << "\" is not an infix index file");
+  p += sizeof(INFIX_INDEX_MAGIC);
+  memcpy(&version, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  if (version != INFIX_INDEX_VERSION)
+    CS_THROW(Exception::OTHER, "infix index file \"" << fileName
+             << "\" has version " << version << ", expected "
+             << INFIX_INDEX_VERSION);
+  memcpy(&_nofLevels, p, sizeof(uint32_t)); p += sizeof(uint32_t);
+  memcpy(&_textLength, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+  memcpy(&_nofWords, p, sizeof(uint64_t)); p += sizeof(uint64_t);
+  _codes = reinterpret_cast<const uint16_t*>(p);
+  p += 256 * sizeof(uint16_t);
+  _counts = reinterpret_cast<const uint64_t*>(p);
+  p += 257 * sizeof(uint64_t);
+  _starts = reinterpret_cast<const uint64_t*>(p);
+  p += 256 * sizeof(uint64_t);
+  _zeros = reinterpret_cast<const uint64_t*>(p);
+  const size_t levelSize = (nofBitWords(_textLength)
+                            + nofRankSamples(_textLength)) * sizeof(uint64_t);
+  if (_nofLevels == 0 || _nofLevels > 8
+      || size != HEADER_SIZE + _nofLevels * (sizeof(uint64_t) + levelSize)
+      || _counts[256] != _textLength)
+    CS_THROW(Exception::OTHER, "infix index file \"" << fileName
+             << "\" is corrupt");
+  p += _nofLevels * sizeof(uint64_t);
+  for (uint32_t l = 0; l < _nofLevels; l++)
+  {
+    _bits.push_back(reinterpret_cast<const uint64_t*>(p));
+    p += nofBitWords(_textLength) * sizeof(uint64_t);
+    _ranks.push_back(reinterpret_cast<const uint64_t*>(p));
+    p += nofRankSamples(_textLength) * sizeof(uint64_t);
+  }
+}
+
+// _____________________________________________________________________________
+uint64_t InfixIndex::rank1(uint32_t level, uint64_t i) const
+{
+  const uint64_t* bits = _bits[level];
+  const uint64_t word = i / 64;
+  uint64_t w = word - word % WORDS_PER_RANK_SAMPLE;
+  uint64_t ones = _ranks[level][word / WORDS_PER_RANK_SAMPLE];
+  for (; w < word; w++) ones += __builtin_popcountll(bits[w]);
+  if (i % 64 > 0)
+    ones += __builtin_popcountll(bits[word] & ((uint64_t(1) << (i % 64)) - 1));
+  return ones;
+}
+
+// _____________________________________________________________________________
+uint64_t InfixIndex::lastLevelPosition(uint32_t code, uint64_t i) const
+{
+  for (uint32_t l = 0; l < _nofLevels; l++)
+  {
+    uint64_t ones = rank1(l, i);
+    i = (code >> (_nofLevels - 1 - l)) & 1 ? _zeros[l] + ones : i - ones;
+  }
+  return i;
+}
+
+// _____________________________________________________________________________
+uint32_t InfixIndex::access(uint64_t i, uint64_t* lastLevelPosition) const
+{
+  uint32_t code = 0;
+  for (uint32_t l = 0; l < _nofLevels; l++)
+  {
+    uint64_t ones = rank1(l, i);
+    if ((_bits[l][i / 64] >> (i % 64)) & 1)
+    {
+      code = 2 * code + 1;
+      i = _zeros[l] + ones;
+    }
+    else
+    {
+      code = 2 * code;
+      i = i - ones;
+    }
+  }
+  *lastLevelPosition = i;
+  return code;
+}
+
+// _____________________________________________________________________________
+void InfixIndex::findWordIds(const string& infix,
+                             vector<uint32_t>* wordIds) const
+{
+  CS_ASSERT(infix.size() > 0);
+  wordIds->clear();
+  if (_file.data() == NULL) return;
+
+  // Backward search: [first, last) are the rows of the suffixes that start
+  // with the part of the infix processed so far.
+  uint64_t first = 0;
+  uint64_t last = _textLength;
+  for (size_t k = infix.size(); k > 0 && first < last; k--)
+  {
+    uint32_t code = _codes[static_cast<unsigned char>(infix[k - 1])];
+    if (code == NO_CODE || code <= 1) return;
+    first = _counts[code] + lastLevelPosition(code, first) - _starts[code];
+    last = _counts[code] + lastLevelPosition(code, last) - _starts[code];
+  }
+
+  // Walk back from each row to the start of its word, where the BWT has \0 or
+  // \1 (codes 0 and 1). The rows with codes 0 and 1 are those of the word
+  // starts, in the order of the words, after the row of the suffix \0.
+  for (uint64_t row = first; row < last; row++)
+  {
+    uint64_t i = row;
+    uint64_t position;
+    uint32_t code;
+    while ((code = access(i, &position)) > 1)
+      i = _counts[code] + position - _starts[code];
+    uint64_t nofWordStarts = position - _starts[code]
+      + lastLevelPosition(1 - code, i) - _starts[1 - code];
+    wordIds->push_back(nofWordStarts - 1);
+  }
+  std::sort(wordIds->begin(), wordIds->end());
+  wordIds->erase(std::unique(wordIds->begin(), wordIds->end()),
+                 wordIds->end());
+}
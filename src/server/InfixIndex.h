@@ -0,0 +1,125 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_INFIXINDEX_H_
+#define SERVER_INFIXINDEX_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "server/Exception.h"
+#include "server/MappedFile.h"
+
+using std::string;
+using std::vector;
+
+// FM-index over the vocabulary, for infix queries *sub* (all words that
+// contain sub), instead of adding the partial words of src/partialwords to
+// the words file.
+//
+// The indexed text is w_0 \1 w_1 \1 ... w_{n-1} \1 \0 for the words w_i of
+// the vocabulary, like in PartialWords::buildSuffixArray. Only its
+// Burrows-Wheeler transform (BWT) is stored, as a wavelet matrix over the
+// distinct bytes of the text, with a rank directory for each level. The rows
+// of the words are found by backward search, and each row is walked back to
+// the start of its word. Because the vocabulary is sorted, the suffixes that
+// start a word are sorted like the words, so the word id is the number of word
+// starts before it. No suffix array and no word id table is stored: the file
+// has about ceil(log2 sigma) * 1.125 bits per byte of the vocabulary.
+//
+// The file <basename>.infix-index is written by buildIndex (option -I) and
+// mmap'ed by the server (option --read-infix-index).
+//
+// File format (all numbers in host byte order):
+//   "CSINFIXI" <uint32 version> <uint32 nofLevels> <uint64 textLength>
+//   <uint64 nofWords> <uint16 codes[256]> (0xffff for bytes not in the text)
+//   <uint64 counts[257]> (the number of bytes with a smaller code)
+//   <uint64 starts[256]> (the first position of each code at the last level)
+//   <uint64 zeros[nofLevels]>
+//   per level: the bits of the BWT (uint64 words), and the number of ones
+//   before every 8-th word (uint64).
+class InfixIndex
+{
+ public:
+  InfixIndex();
+
+  // Write the infix index of the given vocabulary (any class with size() and
+  // operator[] giving the words, sorted) to the given file. Throws an exception
+  // if the words are not sorted or contain a byte \0 or \1.
+  template <class Vocabulary>
+  static void build(const Vocabulary& vocabulary, const string& fileName);
+
+  // Map the given file into memory. Throws an exception if the file does not
+  // exist or has the wrong format.
+  void open(const string& fileName);
+
+  // The number of words and the size of the mapped file.
+  size_t getNofWords() const { return _nofWords; }
+  size_t getSizeInBytes() const { return _file.size(); }
+
+  // The ids of the words that contain the given non-empty string, sorted and
+  // without duplicates.
+  void findWordIds(const string& infix, vector<uint32_t>* wordIds) const;
+
+ private:
+  // Write the index for the given text (see above).
+  static void write(const string& fileName, vector<unsigned char>* text,
+                    uint64_t nofWords);
+
+  // The number of ones in the first i bits of the given level.
+  uint64_t rank1(uint32_t level, uint64_t i) const;
+
+  // The position of BWT row i at the last level, for the given code. The
+  // number of occurrences of the code in the first i rows is that minus
+  // _starts[code].
+  uint64_t lastLevelPosition(uint32_t code, uint64_t i) const;
+
+  // The code of BWT row i, and its position at the last level.
+  uint32_t access(uint64_t i, uint64_t* lastLevelPosition) const;
+
+  uint32_t _nofLevels;
+  uint64_t _textLength;
+  uint64_t _nofWords;
+  const uint16_t* _codes;
+  const uint64_t* _counts;
+  const uint64_t* _starts;
+  const uint64_t* _zeros;
+  vector<const uint64_t*> _bits;
+  vector<const uint64_t*> _ranks;
+
+  // The mmap'ed file.
+  MappedFile _file;
+};
+
+// _____________________________________________________________________________
+template <class Vocabulary>
+void InfixIndex::build(const Vocabulary& vocabulary, const string& fileName)
+{
+  size_t textLength = 1;
+  for (size_t i = 0; i < vocabulary.size(); i++)
+    textLength += vocabulary[i].size() + 1;
+  vector<unsigned char> text;
+  text.reserve(textLength);
+  for (size_t i = 0; i < vocabulary.size(); i++)
+  {
+    const string& word = vocabulary[i];
+    if (i > 0 && !(vocabulary[i - 1] < word))
+      CS_THROW(Exception::OTHER, "vocabulary is not sorted at word \""
+               << word << "\"");
+    for (size_t j = 0; j < word.size(); j++)
+    {
+      if (static_cast<unsigned char>(word[j]) <= 1)
+        CS_THROW(Exception::OTHER, "word with byte 0 or 1: \"" << word << "\"");
+      text.push_back(word[j]);
+    }
+    text.push_back(1);
+  }
+  text.push_back(0);
+  write(fileName, &text, vocabulary.size());
+}
+
+// Whoever includes this should be able to use the global InfixIndex object
+// declared in the .cpp file (NULL if no infix index was read).
+extern InfixIndex* globalInfixIndex;
+
+#endif  // SERVER_INFIXINDEX_H_
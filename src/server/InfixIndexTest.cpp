@@ -0,0 +1,105 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "server/InfixIndex.h"
+
+// The ids of the words that contain the given infix, as a string like "0 2".
+string wordIdsAsString(const InfixIndex& index, const string& infix)
+{
+  vector<uint32_t> wordIds;
+  index.findWordIds(infix, &wordIds);
+  string ids;
+  for (size_t i = 0; i < wordIds.size(); i++)
+    ids += (i > 0 ? " " : "") + std::to_string(wordIds[i]);
+  return ids;
+}
+
+// Finding words in a small vocabulary.
+TEST(InfixIndexTest, findWordIds)
+{
+  vector<string> words;
+  words.push_back("anweisung");         // 0
+  words.push_back("banane");            // 1
+  words.push_back("dienstanweisung");   // 2
+  words.push_back("na");                // 3
+  words.push_back("nan");               // 4
+  words.push_back("weis");              // 5
+  InfixIndex::build(words, "InfixIndexTest.TMP.infix-index");
+  InfixIndex index;
+  index.open("InfixIndexTest.TMP.infix-index");
+  ASSERT_EQ(6u, index.getNofWords());
+  ASSERT_EQ("0 2 5", wordIdsAsString(index, "weis"));
+  ASSERT_EQ("0 2", wordIdsAsString(index, "anweisung"));
+  ASSERT_EQ("1 3 4", wordIdsAsString(index, "na"));
+  ASSERT_EQ("1 4", wordIdsAsString(index, "nan"));
+  ASSERT_EQ("0 1 2 3 4", wordIdsAsString(index, "n"));
+  ASSERT_EQ("", wordIdsAsString(index, "nanu"));
+  ASSERT_EQ("", wordIdsAsString(index, "x"));
+  // Not across words.
+  ASSERT_EQ("", wordIdsAsString(index, "nad"));
+  ASSERT_EQ("", wordIdsAsString(index, "sna"));
+  remove("InfixIndexTest.TMP.infix-index");
+}
+
+// The same words as a linear scan, for random words.
+TEST(InfixIndexTest, randomWords)
+{
+  srand(17);
+  vector<string> words;
+  for (int i = 0; i < 2000; i++)
+  {
+    string word;
+    size_t length = 1 + rand() % 10;
+    for (size_t j = 0; j < length; j++) word += "abcd\xc3\xbc"[rand() % 6];
+    words.push_back(word);
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+  InfixIndex::build(words, "InfixIndexTest.TMP.infix-index");
+  InfixIndex index;
+  index.open("InfixIndexTest.TMP.infix-index");
+  for (int i = 0; i < 200; i++)
+  {
+    string infix;
+    size_t length = 1 + rand() % 4;
+    for (size_t j = 0; j < length; j++) infix += "abcd\xc3\xbc"[rand() % 6];
+    vector<uint32_t> expected;
+    for (size_t j = 0; j < words.size(); j++)
+      if (words[j].find(infix) != string::npos) expected.push_back(j);
+    vector<uint32_t> wordIds;
+    index.findWordIds(infix, &wordIds);
+    ASSERT_EQ(expected, wordIds) << infix;
+  }
+  remove("InfixIndexTest.TMP.infix-index");
+}
+
+// Vocabularies that cannot be indexed, and files that are no infix index.
+TEST(InfixIndexTest, errors)
+{
+  vector<string> words;
+  words.push_back("b");
+  words.push_back("a");
+  ASSERT_THROW(InfixIndex::build(words, "InfixIndexTest.TMP.infix-index"),
+               Exception);
+  words[1] = "c\x01";
+  ASSERT_THROW(InfixIndex::build(words, "InfixIndexTest.TMP.infix-index"),
+               Exception);
+  FILE* file = fopen("InfixIndexTest.TMP.infix-index", "w");
+  fputs("CSFACETS", file);
+  fclose(file);
+  InfixIndex index;
+  ASSERT_THROW(index.open("InfixIndexTest.TMP.infix-index"), Exception);
+  remove("InfixIndexTest.TMP.infix-index");
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,44 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/MappedFile.h"
+#include "server/Exception.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// _____________________________________________________________________________
+MappedFile::~MappedFile()
+{
+  if (_data != NULL) munmap(_data, _size);
+}
+
+// _____________________________________________________________________________
+void MappedFile::open(const string& fileName, const string& description)
+{
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    CS_THROW(Exception::OTHER, "could not open " << description << " \""
+             << fileName << "\"");
+  struct stat fileStat;
+  fstat(fd, &fileStat);
+  size_t size = fileStat.st_size;
+  void* mapped = size > 0 ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)
+                          : MAP_FAILED;
+  close(fd);
+  if (mapped == MAP_FAILED)
+    CS_THROW(Exception::OTHER, "could not mmap " << description << " \""
+             << fileName << "\"");
+  if (_data != NULL) munmap(_data, _size);
+  _data = static_cast<char*>(mapped);
+  _size = size;
+}
+
+// _____________________________________________________________________________
+void writeOrThrow(FILE* file, const void* data, size_t size,
+                  const string& fileName)
+{
+  if (size > 0 && fwrite(data, 1, size, file) != size)
+    CS_THROW(Exception::OTHER, "could not write to \"" << fileName << "\"");
+}
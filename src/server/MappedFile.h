@@ -0,0 +1,44 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_MAPPEDFILE_H_
+#define SERVER_MAPPEDFILE_H_
+
+#include <stdio.h>
+#include <string>
+
+using std::string;
+
+// A whole file mmap'ed read-only, for the index files that are read in place
+// (see DocValues.h, FacetIndex.h, and InfixIndex.h). The mapping is released
+// when the object is destroyed or another file is opened.
+class MappedFile
+{
+ public:
+  MappedFile() : _data(NULL), _size(0) { }
+  ~MappedFile();
+
+  // Map the given file, instead of the one mapped so far. The description of
+  // the file (like "doc values file") is for the message of the exception
+  // thrown if the file cannot be opened or mapped (an empty file cannot).
+  void open(const string& fileName, const string& description);
+
+  // The mapped bytes, or NULL if no file is mapped.
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+
+ private:
+  char* _data;
+  size_t _size;
+
+  // Not copyable, the mapping belongs to one object.
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+};
+
+// Write the given number of bytes to the given file and throw an exception if
+// that fails. The file name is for the message.
+void writeOrThrow(FILE* file, const void* data, size_t size,
+                  const string& fileName);
+
+#endif  // SERVER_MAPPEDFILE_H_
@@ -0,0 +1,59 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include "server/MappedFile.h"
+#include "server/Exception.h"
+
+// Write two files, map one after the other, and fail on files that cannot be
+// mapped.
+TEST(MappedFileTest, writeAndOpen)
+{
+  string fileName1 = "MappedFileTest.TMP.1";
+  string fileName2 = "MappedFileTest.TMP.2";
+  FILE* file = fopen(fileName1.c_str(), "w");
+  writeOrThrow(file, "abc", 3, fileName1);
+  writeOrThrow(file, NULL, 0, fileName1);
+  fclose(file);
+  file = fopen(fileName2.c_str(), "w");
+  writeOrThrow(file, "hello", 5, fileName2);
+  fclose(file);
+
+  MappedFile mappedFile;
+  ASSERT_TRUE(mappedFile.data() == NULL);
+  ASSERT_EQ(0u, mappedFile.size());
+  mappedFile.open(fileName1, "test file");
+  ASSERT_EQ(3u, mappedFile.size());
+  ASSERT_EQ("abc", string(mappedFile.data(), mappedFile.size()));
+  mappedFile.open(fileName2, "test file");
+  ASSERT_EQ("hello", string(mappedFile.data(), mappedFile.size()));
+
+  // A failed open keeps the file mapped so far.
+  file = fopen(fileName1.c_str(), "w");
+  fclose(file);
+  ASSERT_THROW(mappedFile.open(fileName1, "test file"), Exception);
+  ASSERT_THROW(mappedFile.open("MappedFileTest.TMP.nonexisting", "test file"),
+               Exception);
+  ASSERT_EQ("hello", string(mappedFile.data(), mappedFile.size()));
+  remove(fileName1.c_str());
+  remove(fileName2.c_str());
+}
+
+// Writing to a file opened for reading fails.
+TEST(MappedFileTest, writeOrThrowFails)
+{
+  string fileName = "MappedFileTest.TMP.3";
+  FILE* file = fopen(fileName.c_str(), "w");
+  fclose(file);
+  file = fopen(fileName.c_str(), "r");
+  ASSERT_THROW(writeOrThrow(file, "abc", 3, fileName), Exception);
+  fclose(file);
+  remove(fileName.c_str());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
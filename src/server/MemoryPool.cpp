@@ -0,0 +1,226 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/MemoryPool.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include "server/Exception.h"
+
+size_t MemoryPool::maxThreadCacheBytes = 256 * 1024 * 1024;
+size_t MemoryPool::maxTrimmedCacheBytes = 64 * 1024 * 1024;
+size_t MemoryPool::maxCachedBlockBytes = 64 * 1024 * 1024;
+const size_t MemoryPool::HUGE_PAGE_BYTES;
+
+namespace
+{
+// The smallest size class has 2^MIN_BLOCK_BITS bytes, the largest has
+// 2^MAX_BLOCK_BITS.
+const unsigned int MIN_BLOCK_BITS = 6;
+const unsigned int MAX_BLOCK_BITS = 48;
+const size_t NOF_SIZE_CLASSES = 4 * (MAX_BLOCK_BITS - MIN_BLOCK_BITS) + 1;
+
+// The header in front of each block. Its size keeps the blocks aligned like
+// those of malloc.
+struct BlockHeader
+{
+  size_t sizeClass;
+  // The next free block in the cache of the same size class.
+  BlockHeader* next;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must have 16 bytes");
+
+// The cache of the calling thread: the free blocks of each size class, and
+// their total size. Plain data, so that it is valid until the thread ends
+// (also for Vector objects destroyed after the thread-local destructors).
+thread_local BlockHeader* freeBlocks[NOF_SIZE_CLASSES];
+thread_local size_t nofCachedBytes = 0;
+thread_local size_t nofBlocksFromSystem = 0;
+thread_local bool isCacheRegistered = false;
+thread_local bool isThreadExiting = false;
+
+// The key whose destructor releases the cache when a thread exits.
+pthread_key_t cacheKey;
+pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+// The size class of a block of the given number of bytes: four classes per
+// power of two, 64, 80, 96, 112, 128, 160, ...
+size_t sizeClass(size_t nofBytes)
+{
+  if (nofBytes <= (1ul << MIN_BLOCK_BITS)) return 0;
+  unsigned int exponent = 63 - __builtin_clzl(nofBytes - 1);
+  size_t base = 1ul << exponent;
+  size_t step = base >> 2;
+  // Between 1 and 4, where 4 is the first class of the next power of two.
+  size_t k = (nofBytes - base + step - 1) / step;
+  size_t c = 4 * (exponent - MIN_BLOCK_BITS) + k;
+  if (c >= NOF_SIZE_CLASSES)
+    CS_THROW(Exception::REALLOC_FAILED, nofBytes << " bytes");
+  return c;
+}
+
+// The number of bytes of the given size class.
+size_t classCapacity(size_t c)
+{
+  unsigned int exponent = MIN_BLOCK_BITS + c / 4;
+  return (1ul << exponent) + (c % 4) * (1ul << (exponent - 2));
+}
+
+// The offset of the header in the memory of a block of the given size class.
+// Blocks of at least HUGE_PAGE_BYTES start on a huge page boundary, with the
+// header at the end of the (small) pages before them, so that they do not
+// spill into another huge page.
+size_t headerOffset(size_t c)
+{
+  return classCapacity(c) >= MemoryPool::HUGE_PAGE_BYTES
+    ? MemoryPool::HUGE_PAGE_BYTES - sizeof(BlockHeader) : 0;
+}
+
+// Get a new block of the given size class from the system.
+BlockHeader* allocateFromSystem(size_t c)
+{
+  size_t capacity = classCapacity(c);
+  void* memory = NULL;
+  if (capacity >= MemoryPool::HUGE_PAGE_BYTES)
+  {
+    if (posix_memalign(&memory, MemoryPool::HUGE_PAGE_BYTES,
+                       MemoryPool::HUGE_PAGE_BYTES + capacity) != 0)
+      memory = NULL;
+#ifdef MADV_HUGEPAGE
+    // Only a hint, the block works without huge pages, too.
+    if (memory != NULL)
+      madvise(reinterpret_cast<char*>(memory) + MemoryPool::HUGE_PAGE_BYTES,
+              capacity, MADV_HUGEPAGE);
+#endif
+  }
+  else
+  {
+    memory = malloc(sizeof(BlockHeader) + capacity);
+  }
+  if (memory == NULL)
+    CS_THROW(Exception::REALLOC_FAILED, capacity << " bytes");
+  ++nofBlocksFromSystem;
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(
+      reinterpret_cast<char*>(memory) + headerOffset(c));
+  header->sizeClass = c;
+  header->next = NULL;
+  return header;
+}
+
+// Return the given block to the system.
+void freeToSystem(BlockHeader* header)
+{
+  free(reinterpret_cast<char*>(header) - headerOffset(header->sizeClass));
+}
+
+// Release the cache of a thread that exits.
+void releaseCacheOfExitingThread(void*)
+{
+  isThreadExiting = true;
+  MemoryPool::trimThreadCache(0);
+}
+
+void createCacheKey()
+{
+  pthread_key_create(&cacheKey, releaseCacheOfExitingThread);
+}
+
+BlockHeader* headerOf(const void* block)
+{
+  return reinterpret_cast<BlockHeader*>(const_cast<void*>(block)) - 1;
+}
+}
+
+// _____________________________________________________________________________
+void* MemoryPool::allocate(size_t nofBytes)
+{
+  size_t c = sizeClass(nofBytes);
+  BlockHeader* header = freeBlocks[c];
+  if (header != NULL)
+  {
+    freeBlocks[c] = header->next;
+    nofCachedBytes -= classCapacity(c);
+  }
+  else
+  {
+    header = allocateFromSystem(c);
+  }
+  return header + 1;
+}
+
+// _____________________________________________________________________________
+void* MemoryPool::reallocate(void* block, size_t nofBytesUsed, size_t nofBytes)
+{
+  if (nofBytes == 0)
+  {
+    deallocate(block);
+    return NULL;
+  }
+  if (block == NULL) return allocate(nofBytes);
+  if (headerOf(block)->sizeClass == sizeClass(nofBytes)) return block;
+  void* newBlock = allocate(nofBytes);
+  size_t nofBytesToCopy = std::min(nofBytesUsed,
+      std::min(nofBytes, capacityInBytes(block)));
+  memcpy(newBlock, block, nofBytesToCopy);
+  deallocate(block);
+  return newBlock;
+}
+
+// _____________________________________________________________________________
+void MemoryPool::deallocate(void* block)
+{
+  if (block == NULL) return;
+  BlockHeader* header = headerOf(block);
+  size_t capacity = classCapacity(header->sizeClass);
+  if (isThreadExiting || capacity >= maxCachedBlockBytes
+      || nofCachedBytes + capacity > maxThreadCacheBytes)
+  {
+    freeToSystem(header);
+    return;
+  }
+  if (!isCacheRegistered)
+  {
+    pthread_once(&cacheKeyOnce, createCacheKey);
+    pthread_setspecific(cacheKey, &isCacheRegistered);
+    isCacheRegistered = true;
+  }
+  header->next = freeBlocks[header->sizeClass];
+  freeBlocks[header->sizeClass] = header;
+  nofCachedBytes += capacity;
+}
+
+// _____________________________________________________________________________
+size_t MemoryPool::capacityInBytes(const void* block)
+{
+  return block == NULL ? 0 : classCapacity(headerOf(block)->sizeClass);
+}
+
+// _____________________________________________________________________________
+void MemoryPool::trimThreadCache(size_t maxNofBytes)
+{
+  for (size_t c = NOF_SIZE_CLASSES; c > 0 && nofCachedBytes > maxNofBytes; c--)
+  {
+    while (freeBlocks[c - 1] != NULL && nofCachedBytes > maxNofBytes)
+    {
+      BlockHeader* header = freeBlocks[c - 1];
+      freeBlocks[c - 1] = header->next;
+      nofCachedBytes -= classCapacity(c - 1);
+      freeToSystem(header);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+size_t MemoryPool::threadCacheSizeInBytes()
+{
+  return nofCachedBytes;
+}
+
+// _____________________________________________________________________________
+size_t MemoryPool::nofSystemAllocations()
+{
+  return nofBlocksFromSystem;
+}
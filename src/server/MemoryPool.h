@@ -0,0 +1,100 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_MEMORYPOOL_H_
+#define SERVER_MEMORYPOOL_H_
+
+#include <stddef.h>
+
+// The memory of the arrays of Vector (doc ids, positions, word ids and scores
+// of query results, block buffers, etc.).
+//
+// Processing a query allocates and frees many large arrays, and with malloc
+// each thread contends for the arenas of glibc, and multi-MB arrays are
+// mmap'ed and page-faulted in afresh each time. Instead, blocks are rounded up
+// to size classes (four per power of two, so at most 25% slack), and freed
+// blocks are kept in a cache of the calling thread, from which the next
+// allocation of the same class is served without a lock and with its pages
+// already mapped. Blocks of at least HUGE_PAGE_BYTES are aligned to and
+// advised for transparent huge pages.
+//
+// Each block records its size class in a small header in front of it (for
+// blocks on huge pages, at the end of the small pages before them), so a block
+// can be freed by any thread, at any time: a result that is promoted to the
+// History simply keeps its block, and whichever thread frees it later caches
+// it. The compute threads of the server call trimThreadCache at the end of
+// each request, which returns the cached blocks beyond the limit to the
+// system.
+class MemoryPool
+{
+ public:
+  // Allocate a block of at least the given number of bytes (> 0).
+  static void* allocate(size_t nofBytes);
+
+  // Resize the given block (NULL for a new one) to at least the given number
+  // of bytes, keeping the first nofBytesUsed bytes. Returns the block, which
+  // is the same if it is already of the right size class. For nofBytes = 0,
+  // frees the block and returns NULL.
+  static void* reallocate(void* block, size_t nofBytesUsed, size_t nofBytes);
+
+  // Free the given block (NULL is ignored).
+  static void deallocate(void* block);
+
+  // The number of bytes that fit in the given block.
+  static size_t capacityInBytes(const void* block);
+
+  // Return the cached blocks of the calling thread to the system, the largest
+  // first, until at most maxNofBytes remain cached.
+  static void trimThreadCache(size_t maxNofBytes);
+  static void trimThreadCache() { trimThreadCache(maxTrimmedCacheBytes); }
+
+  // The number of bytes cached by the calling thread.
+  static size_t threadCacheSizeInBytes();
+
+  // The number of blocks that the calling thread got from the system.
+  static size_t nofSystemAllocations();
+
+  // The maximal number of bytes cached per thread while processing a request
+  // (blocks freed beyond that go back to the system), and after a request
+  // (see trimThreadCache). Default 256 MB and 64 MB.
+  static size_t maxThreadCacheBytes;
+  static size_t maxTrimmedCacheBytes;
+
+  // Blocks from this size on are never cached. Default 64 MB.
+  static size_t maxCachedBlockBytes;
+
+  // Blocks from this size on are backed by huge pages, where available.
+  static const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+};
+
+// An allocator that takes its memory from the MemoryPool, for the base class
+// std::vector of Vector (with STL_VECTOR).
+template <class T> class PoolAllocator
+{
+ public:
+  typedef T value_type;
+
+  PoolAllocator() {}
+  template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(size_t n)
+  {
+    return reinterpret_cast<T*>(MemoryPool::allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* block, size_t) { MemoryPool::deallocate(block); }
+};
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+  return false;
+}
+
+#endif  // SERVER_MEMORYPOOL_H_
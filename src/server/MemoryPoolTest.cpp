@@ -0,0 +1,123 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "server/MemoryPool.h"
+#include "server/Vector.h"
+
+// Blocks are rounded up to size classes and reused from the thread cache.
+TEST(MemoryPoolTest, allocateAndReuse)
+{
+  MemoryPool::trimThreadCache(0);
+  ASSERT_EQ(0u, MemoryPool::threadCacheSizeInBytes());
+  void* block = MemoryPool::allocate(1);
+  ASSERT_EQ(64u, MemoryPool::capacityInBytes(block));
+  MemoryPool::deallocate(block);
+  block = MemoryPool::allocate(1000);
+  ASSERT_EQ(1024u, MemoryPool::capacityInBytes(block));
+  MemoryPool::deallocate(block);
+  ASSERT_EQ(1024u + 64u, MemoryPool::threadCacheSizeInBytes());
+  size_t nofSystemAllocations = MemoryPool::nofSystemAllocations();
+  // Same size class, so the cached block.
+  void* block2 = MemoryPool::allocate(900);
+  ASSERT_EQ(block, block2);
+  ASSERT_EQ(nofSystemAllocations, MemoryPool::nofSystemAllocations());
+  ASSERT_EQ(64u, MemoryPool::threadCacheSizeInBytes());
+  ASSERT_EQ(1280u, MemoryPool::capacityInBytes(MemoryPool::allocate(1025)));
+  ASSERT_EQ(nofSystemAllocations + 1, MemoryPool::nofSystemAllocations());
+  MemoryPool::deallocate(block2);
+  MemoryPool::deallocate(NULL);
+  MemoryPool::trimThreadCache(1000);
+  ASSERT_EQ(64u, MemoryPool::threadCacheSizeInBytes());
+  MemoryPool::trimThreadCache(0);
+  ASSERT_EQ(0u, MemoryPool::threadCacheSizeInBytes());
+}
+
+// Reallocation keeps the used bytes and the block if the class is the same.
+TEST(MemoryPoolTest, reallocate)
+{
+  char* block = reinterpret_cast<char*>(MemoryPool::reallocate(NULL, 0, 100));
+  ASSERT_EQ(112u, MemoryPool::capacityInBytes(block));
+  memcpy(block, "0123456789", 10);
+  ASSERT_EQ(block, MemoryPool::reallocate(block, 10, 110));
+  block = reinterpret_cast<char*>(MemoryPool::reallocate(block, 10, 5000));
+  ASSERT_EQ(5120u, MemoryPool::capacityInBytes(block));
+  ASSERT_EQ(0, memcmp(block, "0123456789", 10));
+  block = reinterpret_cast<char*>(MemoryPool::reallocate(block, 5000, 3));
+  ASSERT_EQ(0, memcmp(block, "012", 3));
+  ASSERT_TRUE(MemoryPool::reallocate(block, 3, 0) == NULL);
+}
+
+// Large blocks are not cached, and neither are blocks beyond the cache limit.
+TEST(MemoryPoolTest, limits)
+{
+  MemoryPool::trimThreadCache(0);
+  size_t maxCachedBlockBytes = MemoryPool::maxCachedBlockBytes;
+  MemoryPool::maxCachedBlockBytes = 4 * MemoryPool::HUGE_PAGE_BYTES;
+  void* block = MemoryPool::allocate(4 * MemoryPool::HUGE_PAGE_BYTES);
+  memset(block, 1, 4 * MemoryPool::HUGE_PAGE_BYTES);
+  MemoryPool::deallocate(block);
+  ASSERT_EQ(0u, MemoryPool::threadCacheSizeInBytes());
+  block = MemoryPool::allocate(MemoryPool::HUGE_PAGE_BYTES);
+  MemoryPool::deallocate(block);
+  ASSERT_EQ(MemoryPool::HUGE_PAGE_BYTES, MemoryPool::threadCacheSizeInBytes());
+  MemoryPool::maxCachedBlockBytes = maxCachedBlockBytes;
+
+  size_t maxThreadCacheBytes = MemoryPool::maxThreadCacheBytes;
+  MemoryPool::maxThreadCacheBytes = MemoryPool::HUGE_PAGE_BYTES;
+  MemoryPool::deallocate(MemoryPool::allocate(100));
+  ASSERT_EQ(MemoryPool::HUGE_PAGE_BYTES, MemoryPool::threadCacheSizeInBytes());
+  MemoryPool::maxThreadCacheBytes = maxThreadCacheBytes;
+  MemoryPool::trimThreadCache(0);
+}
+
+// Blocks on huge pages start on a huge page boundary.
+TEST(MemoryPoolTest, hugePages)
+{
+  for (size_t n = 1; n <= 4; n++)
+  {
+    void* block = MemoryPool::allocate(n * MemoryPool::HUGE_PAGE_BYTES);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(block)
+                    % MemoryPool::HUGE_PAGE_BYTES);
+    ASSERT_EQ(n * MemoryPool::HUGE_PAGE_BYTES,
+              MemoryPool::capacityInBytes(block));
+    memset(block, 1, n * MemoryPool::HUGE_PAGE_BYTES);
+    MemoryPool::deallocate(block);
+  }
+  MemoryPool::trimThreadCache(0);
+}
+
+// A block can be freed by another thread than the one that allocated it.
+void* freeVector(void* v)
+{
+  delete reinterpret_cast<Vector<int>*>(v);
+  return NULL;
+}
+
+TEST(MemoryPoolTest, otherThread)
+{
+  MemoryPool::trimThreadCache(0);
+  size_t nofSystemAllocations = MemoryPool::nofSystemAllocations();
+  Vector<int>* v = new Vector<int>();
+  for (int i = 0; i < 1000; i++) v->push_back(i);
+  // The memory of Vector is from the pool.
+  ASSERT_LT(nofSystemAllocations, MemoryPool::nofSystemAllocations());
+  Vector<int> copy = *v;
+  copy = copy;
+  ASSERT_EQ(1000u, copy.size());
+  ASSERT_EQ(999, copy[999]);
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, NULL, freeVector, v));
+  ASSERT_EQ(0, pthread_join(thread, NULL));
+  copy.resize(0);
+  copy.unreserve();
+  ASSERT_EQ(0u, copy.capacity());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+#include "./Metrics.h"
+#include <stdlib.h>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+ServerMetrics serverMetrics;
+
+// _____________________________________________________________________________
+unsigned int metricsShardIndex()
+{
+  static atomic<unsigned int> nextShardIndex(0);
+  static thread_local unsigned int shardIndex
+    = nextShardIndex.fetch_add(1, std::memory_order_relaxed)
+      % METRICS_NOF_SHARDS;
+  return shardIndex;
+}
+
+// Write the header of a metric.
+static void writeHeader(ostream& os, const string& name, const string& help,
+                        const char* type)
+{
+  os << "# HELP " << name << " " << help << "\n"
+     << "# TYPE " << name << " " << type << "\n";
+}
+
+// _____________________________________________________________________________
+Counter::Counter(const string& name, const string& help)
+  : _name(name), _help(help)
+{
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+    _shards[i].value.store(0, std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________
+void Counter::add(uint64_t value)
+{
+  _shards[metricsShardIndex()].value.fetch_add(value,
+                                               std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________
+uint64_t Counter::value() const
+{
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+    value += _shards[i].value.load(std::memory_order_relaxed);
+  return value;
+}
+
+// _____________________________________________________________________________
+void Counter::write(ostream& os) const
+{
+  writeHeader(os, _name, _help, "counter");
+  os << _name << " " << value() << "\n";
+}
+
+// _____________________________________________________________________________
+void* Histogram::operator new(size_t size)
+{
+  void* p;
+  if (posix_memalign(&p, alignof(Shard), size) != 0) throw std::bad_alloc();
+  return p;
+}
+
+// _____________________________________________________________________________
+void Histogram::operator delete(void* p)
+{
+  free(p);
+}
+
+// _____________________________________________________________________________
+Histogram::Histogram(const string& name, const string& help)
+  : _name(name), _help(help)
+{
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+  {
+    for (unsigned int j = 0; j < NOF_BUCKETS; j++)
+      _shards[i].buckets[j].store(0, std::memory_order_relaxed);
+    _shards[i].sum.store(0, std::memory_order_relaxed);
+    _shards[i].count.store(0, std::memory_order_relaxed);
+  }
+}
+
+// _____________________________________________________________________________
+unsigned int Histogram::bucketIndex(uint64_t usecs)
+{
+  if (usecs < NOF_SUB_BUCKETS) return usecs;
+  if (usecs >> MAX_EXPONENT) return NOF_BUCKETS - 1;
+  // Position of the highest bit, at least SUB_BUCKET_BITS here.
+  unsigned int exponent = 63 - __builtin_clzll(usecs);
+  unsigned int subBucket = (usecs >> (exponent - SUB_BUCKET_BITS))
+                           & (NOF_SUB_BUCKETS - 1);
+  return (exponent - SUB_BUCKET_BITS + 1) * NOF_SUB_BUCKETS + subBucket;
+}
+
+// _____________________________________________________________________________
+uint64_t Histogram::bucketLowerBound(unsigned int index)
+{
+  if (index < NOF_SUB_BUCKETS) return index;
+  unsigned int exponent = index / NOF_SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+  uint64_t subBucket = index % NOF_SUB_BUCKETS;
+  return (NOF_SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+// _____________________________________________________________________________
+void Histogram::add(uint64_t usecs)
+{
+  Shard& shard = _shards[metricsShardIndex()];
+  shard.buckets[bucketIndex(usecs)].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(usecs, std::memory_order_relaxed);
+  shard.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________
+uint64_t Histogram::count() const
+{
+  uint64_t count = 0;
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+    count += _shards[i].count.load(std::memory_order_relaxed);
+  return count;
+}
+
+// _____________________________________________________________________________
+uint64_t Histogram::sum() const
+{
+  uint64_t sum = 0;
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+    sum += _shards[i].sum.load(std::memory_order_relaxed);
+  return sum;
+}
+
+// _____________________________________________________________________________
+void Histogram::counts(vector<uint64_t>* counts) const
+{
+  counts->assign(NOF_BUCKETS, 0);
+  for (unsigned int i = 0; i < METRICS_NOF_SHARDS; i++)
+    for (unsigned int j = 0; j < NOF_BUCKETS; j++)
+      (*counts)[j] += _shards[i].buckets[j].load(std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________
+uint64_t Histogram::quantile(double q) const
+{
+  vector<uint64_t> bucketCounts;
+  counts(&bucketCounts);
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < NOF_BUCKETS; i++) total += bucketCounts[i];
+  if (total == 0) return 0;
+  uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+  if (rank == 0) rank = 1;
+  uint64_t seen = 0;
+  for (unsigned int i = 0; i + 1 < NOF_BUCKETS; i++)
+  {
+    seen += bucketCounts[i];
+    if (seen >= rank) return bucketLowerBound(i + 1) - 1;
+  }
+  return bucketLowerBound(NOF_BUCKETS - 1);
+}
+
+// _____________________________________________________________________________
+void Histogram::write(ostream& os) const
+{
+  vector<uint64_t> bucketCounts;
+  counts(&bucketCounts);
+
+  writeHeader(os, _name, _help, "histogram");
+  // Bucket i holds the values up to bucketLowerBound(i + 1) - 1. The same
+  // bounds are written each time, also when their buckets are empty.
+  uint64_t cumulative = 0;
+  const unsigned int step = NOF_SUB_BUCKETS / 2;
+  const uint64_t maxWritten = 1ULL << MAX_WRITTEN_EXPONENT;
+  for (unsigned int i = 0;
+       i + 1 < NOF_BUCKETS && bucketLowerBound(i + 1) <= maxWritten; i++)
+  {
+    cumulative += bucketCounts[i];
+    if ((i + 1) % step != 0) continue;
+    os << _name << "_bucket{le=\""
+       << (bucketLowerBound(i + 1) - 1) / 1000000.0 << "\"} "
+       << cumulative << "\n";
+  }
+  uint64_t count = 0;
+  for (unsigned int i = 0; i < NOF_BUCKETS; i++) count += bucketCounts[i];
+  os << _name << "_bucket{le=\"+Inf\"} " << count << "\n"
+     << _name << "_sum " << sum() / 1000000.0 << "\n"
+     << _name << "_count " << count << "\n";
+}
+
+// _____________________________________________________________________________
+ServerMetrics::ServerMetrics()
+  : requestTime("completesearch_request_duration_seconds",
+        "Time from receiving a request until its response is handed off."),
+    receiveQueryTime("completesearch_receive_query_duration_seconds",
+        "Time for receiving a request."),
+    processQueryTime("completesearch_process_query_duration_seconds",
+        "Time for processing a query (without excerpts)."),
+    intersectionTime("completesearch_intersection_duration_seconds",
+        "Time for intersecting lists per query."),
+    fileReadTime("completesearch_file_read_duration_seconds",
+        "Time for reading blocks from the index file per query."),
+    doclistDecompressionTime(
+        "completesearch_doclist_decompression_duration_seconds",
+        "Time for decompressing doc lists per query."),
+    positionlistDecompressionTime(
+        "completesearch_positionlist_decompression_duration_seconds",
+        "Time for decompressing position lists per query."),
+    wordlistDecompressionTime(
+        "completesearch_wordlist_decompression_duration_seconds",
+        "Time for decompressing word lists per query."),
+    mergeResultsTime("completesearch_merge_results_duration_seconds",
+        "Time for merging lists per query."),
+    scoreDocsTime("completesearch_score_docs_duration_seconds",
+        "Time for aggregating scores and computing the top hits per query."),
+    scoreWordsTime("completesearch_score_words_duration_seconds",
+        "Time for aggregating scores and computing the top completions per "
+        "query."),
+    getExcerptsTime("completesearch_get_excerpts_duration_seconds",
+        "Time for computing the excerpts per query."),
+    buildResultStringTime("completesearch_build_result_string_duration_seconds",
+        "Time for building the response per query."),
+    historyCleanUpTime("completesearch_history_cleanup_duration_seconds",
+        "Time for cleaning up the history per query."),
+    fuzzySearchTime("completesearch_fuzzy_search_duration_seconds",
+        "Time for fuzzy search on the last query word per query."),
+    nofRequests("completesearch_requests_total",
+        "Number of requests answered."),
+    nofErrors("completesearch_errors_total",
+        "Number of requests answered with an error."),
+    nofQueriesFromHistory("completesearch_history_hits_total",
+        "Number of (sub)queries answered from the history."),
+    nofQueriesByFiltering("completesearch_history_filtered_total",
+        "Number of (sub)queries computed by filtering a result from the "
+        "history."),
+    nofBlocksReadFromFile("completesearch_blocks_read_total",
+        "Number of blocks read from the index file."),
+    volumeReadFromFile("completesearch_read_bytes_total",
+        "Number of bytes read from the index file."),
+    doclistVolumeDecompressed("completesearch_doclist_decompressed_bytes_total",
+        "Number of bytes of decompressed doc lists."),
+    nofIntersections("completesearch_intersections_total",
+        "Number of list intersections."),
+    intersectNofPostings("completesearch_intersected_postings_total",
+        "Number of postings in intersected lists."),
+    fuzzySearchNofClusters("completesearch_fuzzy_clusters_total",
+        "Number of clusters used by fuzzy search."),
+    fuzzySearchNofSimilarWords("completesearch_fuzzy_similar_words_total",
+        "Number of similar words found by fuzzy search.")
+{
+  const Histogram* histograms[] = { &requestTime, &receiveQueryTime,
+    &processQueryTime, &intersectionTime, &fileReadTime,
+    &doclistDecompressionTime, &positionlistDecompressionTime,
+    &wordlistDecompressionTime, &mergeResultsTime, &scoreDocsTime,
+    &scoreWordsTime, &getExcerptsTime, &buildResultStringTime,
+    &historyCleanUpTime, &fuzzySearchTime };
+  _histograms.assign(histograms,
+      histograms + sizeof(histograms) / sizeof(histograms[0]));
+  const Counter* counters[] = { &nofRequests, &nofErrors,
+    &nofQueriesFromHistory, &nofQueriesByFiltering, &nofBlocksReadFromFile,
+    &volumeReadFromFile, &doclistVolumeDecompressed, &nofIntersections,
+    &intersectNofPostings, &fuzzySearchNofClusters,
+    &fuzzySearchNofSimilarWords };
+  _counters.assign(counters,
+      counters + sizeof(counters) / sizeof(counters[0]));
+}
+
+// _____________________________________________________________________________
+void ServerMetrics::write(ostream& os) const
+{
+  for (size_t i = 0; i < _counters.size(); i++) _counters[i]->write(os);
+  for (size_t i = 0; i < _histograms.size(); i++) _histograms[i]->write(os);
+}
+
+// _____________________________________________________________________________
+void ServerMetrics::writeGauge(ostream& os, const string& name,
+                               const string& help, double value)
+{
+  writeHeader(os, name, help, "gauge");
+  os << name << " " << value << "\n";
+}
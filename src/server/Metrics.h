@@ -0,0 +1,184 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::atomic;
+using std::ostream;
+using std::string;
+using std::vector;
+
+//! Number of shards of each histogram and counter.
+/*!
+ *   Each thread writes to its own shard (threads are assigned round robin), so
+ *   that concurrent queries do not contend for the same cache lines. The
+ *   shards are only summed up when the metrics are exported.
+ */
+const unsigned int METRICS_NOF_SHARDS = 16;
+
+//! The shard of the calling thread.
+unsigned int metricsShardIndex();
+
+//! A monotonic counter, sharded and lock-free.
+class Counter
+{
+ public:
+  Counter(const string& name, const string& help);
+
+  //! Add the given value (called concurrently).
+  void add(uint64_t value);
+
+  //! Sum over all shards.
+  uint64_t value() const;
+
+  //! Write in the Prometheus text format.
+  void write(ostream& os) const;
+
+  const string& name() const { return _name; }
+
+ private:
+  struct Shard
+  {
+    atomic<uint64_t> value;
+    char padding[64 - sizeof(atomic<uint64_t>)];
+  };
+  string _name;
+  string _help;
+  Shard _shards[METRICS_NOF_SHARDS];
+};
+
+//! A histogram of durations (in microseconds) with logarithmic buckets.
+/*!
+ *   The buckets are as in HDR histograms: each power of two is split into
+ *   2^SUB_BUCKET_BITS linear sub-buckets, so that the relative error of a
+ *   bucket is at most 1 / 2^SUB_BUCKET_BITS (12.5%), for values from one
+ *   microsecond up to 2^MAX_EXPONENT microseconds (about 12 days). Larger
+ *   values go to the last bucket.
+ *
+ *   Recording a value is a relaxed atomic increment in the shard of the
+ *   calling thread, no locks.
+ */
+class Histogram
+{
+ public:
+  static const unsigned int SUB_BUCKET_BITS = 3;
+  static const unsigned int NOF_SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const unsigned int MAX_EXPONENT = 40;
+  static const unsigned int NOF_BUCKETS
+    = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * NOF_SUB_BUCKETS;
+  //! The largest bucket bound written is 2^MAX_WRITTEN_EXPONENT microseconds
+  //! (about two minutes), larger values are only counted in +Inf.
+  static const unsigned int MAX_WRITTEN_EXPONENT = 27;
+
+  Histogram(const string& name, const string& help);
+
+  //! Allocate with the alignment of the shards (the global operator new of
+  //! C++11 only guarantees the alignment of the fundamental types).
+  static void* operator new(size_t size);
+  static void operator delete(void* p);
+
+  //! Record the given value (called concurrently).
+  void add(uint64_t usecs);
+
+  //! Index of the bucket for the given value.
+  static unsigned int bucketIndex(uint64_t usecs);
+
+  //! Smallest value of the given bucket (the largest is that of the next one
+  //! minus one).
+  static uint64_t bucketLowerBound(unsigned int index);
+
+  //! Number of values, summed over all shards.
+  uint64_t count() const;
+
+  //! Sum of all values, summed over all shards.
+  uint64_t sum() const;
+
+  //! Approximate quantile (upper bound of the bucket containing it). For
+  //! tests and the log, Prometheus computes quantiles from the buckets.
+  uint64_t quantile(double q) const;
+
+  //! Write in the Prometheus text format. The values are converted to seconds
+  //! and only the bucket bounds at powers of two and halfway in between are
+  //! written, to keep the output small. The bounds written are always the
+  //! same, so that the bucket series do not change between scrapes.
+  void write(ostream& os) const;
+
+  const string& name() const { return _name; }
+
+ private:
+  //! Bucket counts summed over all shards.
+  void counts(vector<uint64_t>* counts) const;
+
+  struct Shard
+  {
+    atomic<uint64_t> buckets[NOF_BUCKETS];
+    atomic<uint64_t> sum;
+    atomic<uint64_t> count;
+  } __attribute__((aligned(64)));
+  string _name;
+  string _help;
+  Shard _shards[METRICS_NOF_SHARDS];
+};
+
+//! Metrics of the completion server, exported at /metrics.
+/*!
+ *   The histograms are fed from the timers of the completer after each
+ *   request (see CompletionServer::recordMetrics), the counters from its
+ *   counters. Values which only change in the server (size of the history,
+ *   number of running threads) are written as gauges on export.
+ */
+class ServerMetrics
+{
+ public:
+  ServerMetrics();
+
+  // Time per request and per stage of query processing.
+  Histogram requestTime;
+  Histogram receiveQueryTime;
+  Histogram processQueryTime;
+  Histogram intersectionTime;
+  Histogram fileReadTime;
+  Histogram doclistDecompressionTime;
+  Histogram positionlistDecompressionTime;
+  Histogram wordlistDecompressionTime;
+  Histogram mergeResultsTime;
+  Histogram scoreDocsTime;
+  Histogram scoreWordsTime;
+  Histogram getExcerptsTime;
+  Histogram buildResultStringTime;
+  Histogram historyCleanUpTime;
+  Histogram fuzzySearchTime;
+
+  // Counters.
+  Counter nofRequests;
+  Counter nofErrors;
+  Counter nofQueriesFromHistory;
+  Counter nofQueriesByFiltering;
+  Counter nofBlocksReadFromFile;
+  Counter volumeReadFromFile;
+  Counter doclistVolumeDecompressed;
+  Counter nofIntersections;
+  Counter intersectNofPostings;
+  Counter fuzzySearchNofClusters;
+  Counter fuzzySearchNofSimilarWords;
+
+  //! Write all metrics in the Prometheus text format.
+  void write(ostream& os) const;
+
+  //! Write a single gauge in the Prometheus text format.
+  static void writeGauge(ostream& os, const string& name, const string& help,
+                         double value);
+
+ private:
+  vector<const Histogram*> _histograms;
+  vector<const Counter*> _counters;
+};
+
+//! The metrics of this process.
+extern ServerMetrics serverMetrics;
+
+#endif
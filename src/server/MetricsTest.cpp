@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <algorithm>
+#include <sstream>
+#include "./Metrics.h"
+
+// _____________________________________________________________________________
+TEST(Histogram, bucketIndex)
+{
+  // Small values have a bucket of their own.
+  for (uint64_t i = 0; i < Histogram::NOF_SUB_BUCKETS; i++)
+  {
+    ASSERT_EQ(i, Histogram::bucketIndex(i));
+    ASSERT_EQ(i, Histogram::bucketLowerBound(i));
+  }
+  // Each value lies between the lower bound of its bucket and that of the
+  // next, and the buckets are at most 12.5% wide.
+  for (uint64_t v = 1; v < (1ULL << 30); v = v * 3 / 2 + 1)
+  {
+    unsigned int i = Histogram::bucketIndex(v);
+    ASSERT_LE(Histogram::bucketLowerBound(i), v);
+    ASSERT_GT(Histogram::bucketLowerBound(i + 1), v);
+    ASSERT_LE(Histogram::bucketLowerBound(i + 1) - Histogram::bucketLowerBound(i),
+              Histogram::bucketLowerBound(i) / 8 + 1);
+  }
+  ASSERT_EQ(8U, Histogram::bucketIndex(8));
+  ASSERT_EQ(15U, Histogram::bucketIndex(15));
+  ASSERT_EQ(16U, Histogram::bucketIndex(16));
+  ASSERT_EQ(16U, Histogram::bucketIndex(17));
+  ASSERT_EQ(17U, Histogram::bucketIndex(18));
+  ASSERT_EQ(Histogram::NOF_BUCKETS - 1, Histogram::bucketIndex(1ULL << 50));
+}
+
+// _____________________________________________________________________________
+TEST(Histogram, quantileAndWrite)
+{
+  Histogram histogram("test_seconds", "Test.");
+  for (uint64_t v = 1; v <= 1000; v++) histogram.add(v);
+  ASSERT_EQ(1000U, histogram.count());
+  ASSERT_EQ(500500U, histogram.sum());
+  // At most 12.5% off.
+  ASSERT_LE(500U, histogram.quantile(0.5));
+  ASSERT_GE(563U, histogram.quantile(0.5));
+  ASSERT_LE(990U, histogram.quantile(0.99));
+  ASSERT_GE(1114U, histogram.quantile(0.99));
+
+  std::ostringstream os;
+  histogram.write(os);
+  string output = os.str();
+  ASSERT_NE(string::npos, output.find("# TYPE test_seconds histogram\n"));
+  ASSERT_NE(string::npos, output.find("test_seconds_bucket{le=\"3e-06\"} 3\n"));
+  ASSERT_NE(string::npos, output.find("test_seconds_bucket{le=\"+Inf\"} 1000\n"));
+  ASSERT_NE(string::npos, output.find("test_seconds_sum 0.5005\n"));
+  ASSERT_NE(string::npos, output.find("test_seconds_count 1000\n"));
+}
+
+// _____________________________________________________________________________
+// The same buckets are written, however large the values recorded so far.
+TEST(Histogram, writeSameBuckets)
+{
+  Histogram histogram("test_seconds", "Test.");
+  std::ostringstream os;
+  histogram.write(os);
+  string empty = os.str();
+  histogram.add(10);
+  histogram.add(1ULL << 35);
+  os.str("");
+  histogram.write(os);
+  string output = os.str();
+  ASSERT_EQ(std::count(empty.begin(), empty.end(), '\n'),
+            std::count(output.begin(), output.end(), '\n'));
+  ASSERT_NE(string::npos,
+            empty.find("test_seconds_bucket{le=\"134.218\"} 0\n"));
+  ASSERT_NE(string::npos,
+            output.find("test_seconds_bucket{le=\"134.218\"} 1\n"));
+  ASSERT_NE(string::npos, output.find("test_seconds_bucket{le=\"+Inf\"} 2\n"));
+}
+
+// _____________________________________________________________________________
+TEST(Histogram, alignedOnHeap)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    Histogram* histogram = new Histogram("test_seconds", "Test.");
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(histogram) % 64);
+    histogram->add(1);
+    ASSERT_EQ(1U, histogram->count());
+    delete histogram;
+  }
+}
+
+// _____________________________________________________________________________
+void* addToCounter(void* counter)
+{
+  for (int i = 0; i < 100000; i++) static_cast<Counter*>(counter)->add(1);
+  return NULL;
+}
+
+// _____________________________________________________________________________
+TEST(Counter, concurrentAdd)
+{
+  Counter counter("test_total", "Test.");
+  pthread_t threads[8];
+  for (int i = 0; i < 8; i++)
+    pthread_create(&threads[i], NULL, addToCounter, &counter);
+  for (int i = 0; i < 8; i++) pthread_join(threads[i], NULL);
+  ASSERT_EQ(800000U, counter.value());
+  std::ostringstream os;
+  counter.write(os);
+  ASSERT_EQ("# HELP test_total Test.\n# TYPE test_total counter\n"
+            "test_total 800000\n", os.str());
+}
+
+// _____________________________________________________________________________
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
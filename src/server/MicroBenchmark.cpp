@@ -0,0 +1,215 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/MicroBenchmark.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include "server/Exception.h"
+
+using std::endl;
+using std::setw;
+
+volatile uint64_t MicroBenchmarks::sink = 0;
+
+namespace
+{
+// Nanoseconds on the monotonic clock.
+uint64_t nowNsecs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// The median of the given values (which are reordered).
+double median(vector<double>* values)
+{
+  size_t n = values->size();
+  std::sort(values->begin(), values->end());
+  return n % 2 == 1 ? (*values)[n / 2]
+                    : ((*values)[n / 2 - 1] + (*values)[n / 2]) / 2;
+}
+
+// The given number of nanoseconds with a unit, e.g. "1.25 us".
+string formatNsecs(double nsecs)
+{
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(nsecs < 10 ? 2 : 1);
+  if (nsecs < 1e3) os << nsecs << " ns";
+  else if (nsecs < 1e6) os << nsecs / 1e3 << " us";
+  else if (nsecs < 1e9) os << nsecs / 1e6 << " ms";
+  else os << nsecs / 1e9 << " s";
+  return os.str();
+}
+
+// The number after "\"<key>\": " in the given line, or -1.
+double jsonNumber(const string& line, const string& key)
+{
+  size_t pos = line.find("\"" + key + "\": ");
+  if (pos == string::npos) return -1;
+  return atof(line.c_str() + pos + key.size() + 4);
+}
+}
+
+// _____________________________________________________________________________
+void MicroBenchmarks::add(const string& name, uint64_t nofItems,
+                          const Function& function)
+{
+  _names.push_back(name);
+  _nofItems.push_back(nofItems);
+  _functions.push_back(function);
+}
+
+// _____________________________________________________________________________
+void MicroBenchmarks::run(ostream& log)
+{
+  for (size_t i = 0; i < _functions.size(); i++)
+  {
+    if (_names[i].find(_options.filter) == string::npos) continue;
+    const Function& function = _functions[i];
+
+    // Calibrate the number of iterations per run.
+    uint64_t minNsecs = static_cast<uint64_t>(_options.minMsecsPerRun * 1e6);
+    size_t nofIterations = 1;
+    while (true)
+    {
+      uint64_t start = nowNsecs();
+      function(nofIterations);
+      uint64_t nsecs = nowNsecs() - start;
+      if (nsecs >= minNsecs || nofIterations >= (1u << 30)) break;
+      nofIterations *= nsecs < minNsecs / 1024
+        ? 1024 : std::max<uint64_t>(2, minNsecs / nsecs + 1);
+    }
+
+    for (size_t j = 0; j < _options.nofWarmupRuns; j++) function(nofIterations);
+    vector<double> nsecs;
+    for (size_t j = 0; j < std::max<size_t>(_options.nofRuns, 1); j++)
+    {
+      uint64_t start = nowNsecs();
+      function(nofIterations);
+      nsecs.push_back(static_cast<double>(nowNsecs() - start) / nofIterations);
+    }
+    Result result = statistics(_names[i], _nofItems[i], nofIterations, nsecs);
+    _results.push_back(result);
+    log << std::left << setw(64) << result.name << std::right
+        << setw(12) << formatNsecs(result.medianNsecs) << " +- "
+        << std::fixed << std::setprecision(1) << setw(4)
+        << (result.medianNsecs > 0
+            ? 100 * result.madNsecs / result.medianNsecs : 0) << "%";
+    if (result.nofItems > 1 && result.medianNsecs > 0)
+    {
+      double itemsPerSec = result.nofItems * 1e9 / result.medianNsecs;
+      log << setw(10) << std::setprecision(1);
+      if (itemsPerSec >= 1e6) log << itemsPerSec / 1e6 << " M items/s";
+      else log << itemsPerSec / 1e3 << " K items/s";
+    }
+    log << endl;
+  }
+}
+
+// _____________________________________________________________________________
+MicroBenchmarks::Result MicroBenchmarks::statistics(const string& name,
+    uint64_t nofItems, uint64_t nofIterations, vector<double> nsecs)
+{
+  Result result;
+  result.name = name;
+  result.nofItems = nofItems;
+  result.nofIterations = nofIterations;
+  result.medianNsecs = 0;
+  result.madNsecs = 0;
+  result.minNsecs = 0;
+  if (nsecs.empty()) return result;
+  result.minNsecs = *std::min_element(nsecs.begin(), nsecs.end());
+  result.medianNsecs = median(&nsecs);
+  for (size_t i = 0; i < nsecs.size(); i++)
+    nsecs[i] = fabs(nsecs[i] - result.medianNsecs);
+  result.madNsecs = median(&nsecs);
+  return result;
+}
+
+// _____________________________________________________________________________
+void MicroBenchmarks::writeJson(ostream& os) const
+{
+  os << "{" << endl << "  \"benchmarks\": [" << endl;
+  for (size_t i = 0; i < _results.size(); i++)
+  {
+    const Result& r = _results[i];
+    os << std::fixed << std::setprecision(3)
+       << "    {\"name\": \"" << r.name << "\", \"items\": " << r.nofItems
+       << ", \"iterations\": " << r.nofIterations
+       << ", \"median_ns\": " << r.medianNsecs
+       << ", \"mad_ns\": " << r.madNsecs
+       << ", \"min_ns\": " << r.minNsecs << "}"
+       << (i + 1 < _results.size() ? "," : "") << endl;
+  }
+  os << "  ]" << endl << "}" << endl;
+}
+
+// _____________________________________________________________________________
+void MicroBenchmarks::readJson(istream& is, vector<Result>* results)
+{
+  results->clear();
+  string line;
+  while (std::getline(is, line))
+  {
+    size_t pos = line.find("\"name\": \"");
+    if (pos == string::npos) continue;
+    pos += 9;
+    size_t end = line.find('"', pos);
+    if (end == string::npos) continue;
+    Result r;
+    r.name = line.substr(pos, end - pos);
+    r.nofItems = jsonNumber(line, "items");
+    r.nofIterations = jsonNumber(line, "iterations");
+    r.medianNsecs = jsonNumber(line, "median_ns");
+    r.madNsecs = jsonNumber(line, "mad_ns");
+    r.minNsecs = jsonNumber(line, "min_ns");
+    if (r.medianNsecs < 0) continue;
+    results->push_back(r);
+  }
+  if (results->empty())
+    CS_THROW(Exception::OTHER, "no benchmark results found");
+}
+
+// _____________________________________________________________________________
+size_t MicroBenchmarks::compare(const vector<Result>& baseline,
+                                double threshold, ostream& os) const
+{
+  std::map<string, const Result*> baselineByName;
+  for (size_t i = 0; i < baseline.size(); i++)
+    baselineByName[baseline[i].name] = &baseline[i];
+  size_t nofSlower = 0;
+  for (size_t i = 0; i < _results.size(); i++)
+  {
+    const Result& r = _results[i];
+    os << std::left << setw(64) << r.name << std::right;
+    std::map<string, const Result*>::const_iterator it
+      = baselineByName.find(r.name);
+    if (it == baselineByName.end())
+    {
+      os << "  not in baseline" << endl;
+      continue;
+    }
+    const Result& b = *it->second;
+    double difference = r.medianNsecs - b.medianNsecs;
+    double noise = 3 * (r.madNsecs + b.madNsecs);
+    const char* verdict = "same";
+    if (fabs(difference) > noise && fabs(difference) > threshold * b.medianNsecs)
+    {
+      verdict = difference > 0 ? "SLOWER" : "faster";
+      if (difference > 0) nofSlower++;
+    }
+    os << setw(12) << formatNsecs(b.medianNsecs) << " -> " << setw(10)
+       << formatNsecs(r.medianNsecs) << std::fixed << std::setprecision(1)
+       << setw(8) << std::showpos
+       << (b.medianNsecs > 0 ? 100 * difference / b.medianNsecs : 0)
+       << std::noshowpos << "%  " << verdict << endl;
+  }
+  return nofSlower;
+}
@@ -0,0 +1,102 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_MICROBENCHMARK_H_
+#define SERVER_MICROBENCHMARK_H_
+
+#include <stdint.h>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using std::istream;
+using std::ostream;
+using std::string;
+using std::vector;
+
+// Runs micro-benchmarks with stable statistics and compares them to a
+// baseline (see MicroBenchmarkPerf.cpp for the benchmarks themselves).
+//
+// A benchmark is a function which does the measured operation a given number
+// of times. The number of iterations is first increased until one run takes at
+// least minMsecsPerRun, then there are nofWarmupRuns runs which are not
+// measured, and nofRuns measured ones. The result is the median time per
+// iteration over the runs, with the median absolute deviation (MAD) as
+// measure of the noise, which unlike the mean and the standard deviation is
+// not thrown off by the odd run which was interrupted.
+//
+// A benchmark is slower than in the baseline if its median is larger by more
+// than the given threshold (relative) and by more than three times the sum of
+// both MADs (so that noise is not reported as a regression).
+class MicroBenchmarks
+{
+ public:
+  struct Options
+  {
+    Options() : minMsecsPerRun(20), nofWarmupRuns(1), nofRuns(11) { }
+    double minMsecsPerRun;
+    size_t nofWarmupRuns;
+    size_t nofRuns;
+    // Only run the benchmarks whose name contains this string.
+    string filter;
+  };
+
+  // The result of one benchmark; the times are per iteration.
+  struct Result
+  {
+    string name;
+    // The number of items per iteration (e.g. postings), for the throughput.
+    uint64_t nofItems;
+    uint64_t nofIterations;
+    double medianNsecs;
+    double madNsecs;
+    double minNsecs;
+  };
+
+  // Does the measured operation the given number of times.
+  typedef std::function<void(size_t)> Function;
+
+  explicit MicroBenchmarks(const Options& options) : _options(options) { }
+
+  // Add a benchmark with the given name (which should contain its
+  // parameters, e.g. "simple9/decode n=100000") and number of items per
+  // iteration.
+  void add(const string& name, uint64_t nofItems, const Function& function);
+
+  // Run the benchmarks (those matching the filter), writing one line per
+  // benchmark to the given stream.
+  void run(ostream& log);
+
+  const vector<Result>& getResults() const { return _results; }
+
+  // The statistics for the given times per iteration (one per run).
+  static Result statistics(const string& name, uint64_t nofItems,
+                           uint64_t nofIterations, vector<double> nsecs);
+
+  // Write the results as JSON, one benchmark per line.
+  void writeJson(ostream& os) const;
+
+  // Read results written by writeJson. Throws an exception if there are
+  // none.
+  static void readJson(istream& is, vector<Result>* results);
+
+  // Compare the results to the given baseline (by name), writing one line per
+  // benchmark. Returns the number of benchmarks which got slower.
+  size_t compare(const vector<Result>& baseline, double threshold,
+                 ostream& os) const;
+
+  // A sink for values computed by the benchmarks, so that the compiler cannot
+  // optimize the computation away.
+  static volatile uint64_t sink;
+
+ private:
+  Options _options;
+  vector<string> _names;
+  vector<uint64_t> _nofItems;
+  vector<Function> _functions;
+  vector<Result> _results;
+};
+
+#endif  // SERVER_MICROBENCHMARK_H_
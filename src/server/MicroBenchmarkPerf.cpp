@@ -0,0 +1,645 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+// Micro-benchmarks of the kernels of query processing: Simple9 and Zipf
+// encoding and decoding, intersectTwoPostingLists for every separator and
+// score aggregation, sortAndAggregateByWordId, partialSortParallel, the
+// DocIdBitmap operations, Vocabulary::findWord, the edit distances and
+// DocsDB::getDocument. On
+// synthetic data with Zipfian word ids, and optionally on the two largest
+// blocks, the vocabulary and the docs DB of a HYB index. See printUsage below
+// and MicroBenchmark.h for how the statistics are computed.
+//
+// Typical use: run with -j base.json before a change and with -b base.json
+// after it; the exit code is 2 if a benchmark got slower.
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "server/CompleterBase.h"
+#include "server/DocsDB.h"
+#include "server/DocIdBitmap.h"
+#include "server/Document.h"
+#include "server/HYBCompleter.h"
+#include "server/MicroBenchmark.h"
+#include "server/ScoreAggregators.h"
+#include "server/Simple9CompressionAlgorithm.h"
+#include "server/Vocabulary.h"
+#include "server/ZipfCompressionAlgorithm.h"
+#include "fuzzysearch/StringDistances.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::pair;
+
+typedef HybCompleter<WITH_SCORES + WITH_POS + WITH_DUPS> Completer;
+
+void printUsage()
+{
+  cout << "Usage: MicroBenchmarkPerf [options]" << endl << endl
+       << "Runs the micro-benchmarks and writes the median time per "
+          "iteration, its median" << endl
+       << "absolute deviation and the throughput of each." << endl << endl
+       << "-f <string>  Only run the benchmarks whose name contains this "
+          "string." << endl
+       << "-n <n>       Number of postings of the larger synthetic list "
+          "(default: 100000)." << endl
+       << "-z <s>       Exponent of the Zipf distribution of the synthetic "
+          "word ids (default: 1)." << endl
+       << "-r <n>       Number of measured runs per benchmark (default: 11)."
+       << endl
+       << "-t <msecs>   Minimal time of one run (default: 20)." << endl
+       << "-i <file>    Also benchmark on the two largest blocks and the "
+          "vocabulary of this" << endl
+       << "             HYB index (and its docs DB, if there is one)." << endl
+       << "-j <file>    Write the results as JSON to this file." << endl
+       << "-b <file>    Compare the results to this JSON file from an "
+          "earlier run." << endl
+       << "-T <ratio>   Relative slowdown which counts as a regression "
+          "(default: 0.05)." << endl
+       << endl;
+}
+
+// Draws from {0, ..., n - 1} with probability proportional to 1 / (i + 1)^s.
+class ZipfDistribution
+{
+ public:
+  ZipfDistribution(size_t n, double s) : _cdf(n)
+  {
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) _cdf[i] = (sum += 1 / pow(i + 1, s));
+    for (size_t i = 0; i < n; i++) _cdf[i] /= sum;
+  }
+  size_t operator()(std::mt19937* random)
+  {
+    double x = std::uniform_real_distribution<double>(0, 1)(*random);
+    return std::min<size_t>(
+        std::lower_bound(_cdf.begin(), _cdf.end(), x) - _cdf.begin(),
+        _cdf.size() - 1);
+  }
+
+ private:
+  vector<double> _cdf;
+};
+
+// A posting list of the given size over the given number of documents (with
+// uniformly distributed doc ids, so several postings per document) and words
+// (with Zipfian word ids), sorted by doc id and position.
+void syntheticPostings(size_t nofPostings, size_t nofDocs,
+                       ZipfDistribution* wordIds, std::mt19937* random,
+                       QueryResult* list)
+{
+  vector<pair<DocId, Position> > postings(nofPostings);
+  for (size_t i = 0; i < nofPostings; i++)
+  {
+    postings[i].first = (*random)() % nofDocs;
+    postings[i].second = 1 + (*random)() % 100;
+  }
+  std::sort(postings.begin(), postings.end());
+  list->clear();
+  for (size_t i = 0; i < nofPostings; i++)
+  {
+    list->_docIds.push_back(postings[i].first);
+    list->_positions.push_back(postings[i].second);
+    list->_wordIdsOriginal.push_back((*wordIds)(random));
+    list->_scores.push_back(1 + (*random)() % 20);
+  }
+}
+
+// Random words over a skewed alphabet (frequent letters first), sorted and
+// without duplicates.
+void syntheticWords(size_t nofWords, std::mt19937* random,
+                    vector<string>* words)
+{
+  const string letters = "etaoinshrdlcumwfgypbvkjxqz";
+  ZipfDistribution letter(letters.size(), 0.8);
+  words->clear();
+  for (size_t i = 0; i < nofWords; i++)
+  {
+    string word(3 + (*random)() % 10, ' ');
+    for (size_t j = 0; j < word.size(); j++) word[j] = letters[letter(random)];
+    words->push_back(word);
+  }
+  std::sort(words->begin(), words->end());
+  words->erase(std::unique(words->begin(), words->end()), words->end());
+}
+
+// The given word with up to two random edits (substitution, insertion or
+// deletion), like a misspelled query word.
+string misspell(const string& word, std::mt19937* random)
+{
+  string result = word;
+  size_t nofEdits = (*random)() % 3;
+  for (size_t i = 0; i < nofEdits && !result.empty(); i++)
+  {
+    size_t pos = (*random)() % result.size();
+    char c = 'a' + (*random)() % 26;
+    switch ((*random)() % 3)
+    {
+      case 0: result[pos] = c; break;
+      case 1: result.insert(pos, 1, c); break;
+      default: result.erase(pos, 1);
+    }
+  }
+  return result;
+}
+
+// The name of a score aggregation, for the benchmark names.
+const char* aggregationName(ScoreAggregation aggregation)
+{
+  switch (aggregation)
+  {
+    case SCORE_AGG_SUM: return "sum";
+    case SCORE_AGG_MAX: return "max";
+    case SCORE_AGG_SUM_WITH_BONUS: return "sum_with_bonus";
+    default: return "none";
+  }
+}
+
+// Benchmarks of the DocIdBitmap operations on a dense set with half of the
+// given number of docs (like a popular facet value), a set with every 5th doc
+// and the doc ids of the given list, compared to merging sorted lists.
+void addBitmapBenchmarks(size_t nofDocs, const DocList& list,
+                         std::mt19937* random, MicroBenchmarks* benchmarks)
+{
+  DocList* dense = new DocList();
+  DocList* sparse = new DocList();
+  for (DocId d = 0; d < nofDocs; d++)
+  {
+    if ((*random)() % 2 == 0) dense->push_back(d);
+    if (d % 5 == 0) sparse->push_back(d);
+  }
+  DocIdBitmap* denseBitmap = new DocIdBitmap();
+  DocIdBitmap* sparseBitmap = new DocIdBitmap();
+  denseBitmap->build(*dense);
+  sparseBitmap->build(*sparse);
+  std::ostringstream suffix;
+  suffix << " n=" << dense->size() << "+" << list.size();
+  benchmarks->add("bitmap/intersect list" + suffix.str(), list.size(),
+                  [=, &list](size_t nofIterations)
+  {
+    DocList docIds;
+    vector<uint32_t> ranks;
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      docIds.clear();
+      ranks.clear();
+      denseBitmap->intersect(list, &docIds, &ranks);
+      MicroBenchmarks::sink += docIds.size();
+    }
+  });
+  benchmarks->add("merge/intersect list" + suffix.str(), list.size(),
+                  [=, &list](size_t nofIterations)
+  {
+    DocList docIds;
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      docIds.clear();
+      std::set_intersection(dense->begin(), dense->end(), list.begin(),
+                            list.end(), std::back_inserter(docIds));
+      MicroBenchmarks::sink += docIds.size();
+    }
+  });
+  suffix.str("");
+  suffix << " n=" << dense->size() << "+" << sparse->size();
+  size_t n = dense->size() + sparse->size();
+  benchmarks->add("bitmap/intersect bitmap" + suffix.str(), n,
+                  [=](size_t nofIterations)
+  {
+    DocIdBitmap result;
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      DocIdBitmap::intersect(*denseBitmap, *sparseBitmap, &result);
+      MicroBenchmarks::sink += result.count();
+    }
+  });
+  benchmarks->add("bitmap/intersectionCount" + suffix.str(), n,
+                  [=](size_t nofIterations)
+  {
+    for (size_t i = 0; i < nofIterations; i++)
+      MicroBenchmarks::sink
+        += DocIdBitmap::intersectionCount(*denseBitmap, *sparseBitmap);
+  });
+  benchmarks->add("bitmap/unite bitmap" + suffix.str(), n,
+                  [=](size_t nofIterations)
+  {
+    DocIdBitmap result;
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      DocIdBitmap::unite(*denseBitmap, *sparseBitmap, &result);
+      MicroBenchmarks::sink += result.count();
+    }
+  });
+}
+
+// Benchmarks on two posting lists (the smaller one first): compression of the
+// doc ids and word ids of the second, intersection of the two, and the steps of
+// the top-k computation on the second. The label says where the lists are
+// from, e.g. "zipf" or "index".
+void addPostingListBenchmarks(const string& label, const QueryResult& list1,
+                              const QueryResult& list2, Completer* completer,
+                              MicroBenchmarks* benchmarks)
+{
+  size_t n = list2._docIds.size();
+  std::ostringstream suffix;
+  suffix << " " << label << " n=" << n;
+
+  // Simple9 on the doc ids (as gaps) and Zipf on the word ids, like in the
+  // blocks of a HYB index (see HYBIndex.cpp). The buffers are large enough for
+  // the worst case, and shared by the encode and the decode benchmark.
+  WordId maxWordId = 0;
+  for (size_t i = 0; i < n; i++)
+    maxWordId = std::max(maxWordId, list2._wordIdsOriginal[i]);
+  unsigned int* buffer = new unsigned int[n + maxWordId + 64];
+  DocList* docIds = new DocList();
+  docIds->resize(n + 64);
+  WordList* wordIds = new WordList();
+  wordIds->resize(n + 64);
+  Simple9CompressionAlgorithm simple9;
+  size_t simple9Bytes = simple9.compress(list2._docIds, buffer);
+  benchmarks->add("simple9/encode docIds" + suffix.str(), n,
+                  [=, &list2](size_t nofIterations)
+  {
+    Simple9CompressionAlgorithm simple9;
+    for (size_t i = 0; i < nofIterations; i++)
+      MicroBenchmarks::sink += simple9.compress(list2._docIds, buffer);
+  });
+  benchmarks->add("simple9/decode docIds" + suffix.str(), n,
+                  [=, &list2](size_t nofIterations)
+  {
+    Simple9CompressionAlgorithm simple9;
+    simple9.compress(list2._docIds, buffer);
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      simple9.decompress(buffer, &(*docIds)[0], n);
+      MicroBenchmarks::sink += (*docIds)[n - 1];
+    }
+  });
+  benchmarks->add("zipf/encode wordIds" + suffix.str(), n,
+                  [=, &list2](size_t nofIterations)
+  {
+    ZipfCompressionAlgorithm<WordId> zipf;
+    for (size_t i = 0; i < nofIterations; i++)
+      MicroBenchmarks::sink += zipf.compress(list2._wordIdsOriginal, buffer);
+  });
+  benchmarks->add("zipf/decode wordIds" + suffix.str(), n,
+                  [=, &list2](size_t nofIterations)
+  {
+    ZipfCompressionAlgorithm<WordId> zipf;
+    zipf.compress(list2._wordIdsOriginal, buffer);
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      zipf.decompress(buffer, &(*wordIds)[0], n);
+      MicroBenchmarks::sink += (*wordIds)[n - 1];
+    }
+  });
+  cout << "* " << label << ": " << list1._docIds.size() << " and " << n
+       << " postings, doc ids with Simple9 in "
+       << std::fixed << std::setprecision(2) << 8.0 * simple9Bytes / n
+       << " bits per posting" << endl;
+
+  // Intersection for every separator and score aggregation.
+  std::ostringstream sizes;
+  sizes << " " << label << " n=" << list1._docIds.size() << "+" << n;
+  ScoreAggregation aggregations[] =
+    { SCORE_AGG_SUM, SCORE_AGG_MAX, SCORE_AGG_SUM_WITH_BONUS };
+  for (size_t s = 0; s < fixed_separators._separators.size(); s++)
+  {
+    const Separator& separator = fixed_separators._separators[s];
+    for (size_t a = 0; a < 3; a++)
+    {
+      ScoreAggregation aggregation = aggregations[a];
+      benchmarks->add("intersect sep=[" + separator.getSeparatorString()
+                      + "] agg=" + aggregationName(aggregation)
+                      + sizes.str(), list1._docIds.size() + n,
+                      [=, &list1, &list2](size_t nofIterations)
+      {
+        QueryResult result;
+        for (size_t i = 0; i < nofIterations; i++)
+        {
+          result.clear();
+          completer->intersectTwoPostingLists(list1, list2, result, separator,
+                                              aggregation);
+          MicroBenchmarks::sink += result._docIds.size();
+        }
+      });
+    }
+  }
+
+  // Aggregation by word id, as in computeTopCompletions.
+  for (size_t a = 0; a < 2; a++)
+  {
+    benchmarks->add(string("sortAndAggregateByWordId agg=")
+                    + (a == 0 ? "sum" : "max") + suffix.str(), n,
+                    [=, &list2](size_t nofIterations)
+    {
+      DocList docIds;
+      WordList wordIds;
+      ScoreList scores;
+      Vector<unsigned int> docCounts;
+      Vector<unsigned int> occCounts;
+      SumAggregation sum;
+      MaxAggregation max;
+      for (size_t i = 0; i < nofIterations; i++)
+      {
+        if (a == 0)
+          completer->sortAndAggregateByWordId(list2._docIds,
+              list2._wordIdsOriginal, list2._scores, &docIds, &wordIds,
+              &scores, &docCounts, &occCounts, sum, sum);
+        else
+          completer->sortAndAggregateByWordId(list2._docIds,
+              list2._wordIdsOriginal, list2._scores, &docIds, &wordIds,
+              &scores, &docCounts, &occCounts, max, max);
+        MicroBenchmarks::sink += wordIds.size();
+      }
+    });
+  }
+
+  // The top-k hits by score, as in computeTopHits. Includes copying the
+  // lists, since the sort is in place.
+  benchmarks->add("partialSortParallel k=100" + suffix.str(), n,
+                  [=, &list2](size_t nofIterations)
+  {
+    ScoreList scores;
+    Vector<DocId> docIds;
+    for (size_t i = 0; i < nofIterations; i++)
+    {
+      scores = list2._scores;
+      docIds = list2._docIds;
+      scores.partialSortParallel(docIds, 100, SORT_ORDER_DESCENDING);
+      MicroBenchmarks::sink += docIds[0];
+    }
+  });
+}
+
+// Benchmarks on a vocabulary: findWord for words and prefixes of words in it
+// and misspellings of them, and the edit distances between words and their
+// misspellings (as computed by the fuzzy search).
+void addVocabularyBenchmarks(const string& label, const Vocabulary& vocabulary,
+                             std::mt19937* random, MicroBenchmarks* benchmarks)
+{
+  const size_t nofLookups = 1024;
+  vector<string>* words = new vector<string>();
+  vector<string>* queries = new vector<string>();
+  for (size_t i = 0; i < 100 * nofLookups && words->size() < nofLookups
+       && vocabulary.size() > 0; i++)
+  {
+    const string& word = vocabulary[(*random)() % vocabulary.size()];
+    // The edit distances only support words up to MAX_WORD_LEN.
+    if (word.empty() || word.size() > 20) continue;
+    words->push_back(word);
+    queries->push_back(misspell(word, random));
+    if (queries->back().empty()) queries->back() = word;
+  }
+  if (words->empty()) return;
+  std::ostringstream suffix;
+  suffix << " " << label << " words=" << vocabulary.size();
+  benchmarks->add("findWord" + suffix.str(), 2 * words->size(),
+                  [=, &vocabulary](size_t nofIterations)
+  {
+    for (size_t i = 0; i < nofIterations; i++)
+      for (size_t j = 0; j < words->size(); j++)
+      {
+        const string& word = (*words)[j];
+        MicroBenchmarks::sink += vocabulary.findWord(word.substr(0,
+              1 + j % word.size()) + (j % 2 ? "*" : ""));
+        MicroBenchmarks::sink += vocabulary.findWord((*queries)[j]);
+      }
+  });
+  suffix.str("");
+  suffix << " " << label << " pairs=" << words->size();
+  benchmarks->add("editDistance/plain" + suffix.str(), words->size(),
+                  [=](size_t nofIterations)
+  {
+    FuzzySearch::PlainEditDistance distance;
+    for (size_t i = 0; i < nofIterations; i++)
+      for (size_t j = 0; j < words->size(); j++)
+        MicroBenchmarks::sink += distance.calculate((*queries)[j],
+                                                    (*words)[j], 2);
+  });
+  benchmarks->add("editDistance/extension" + suffix.str(), words->size(),
+                  [=](size_t nofIterations)
+  {
+    FuzzySearch::ExtensionEditDistance distance;
+    for (size_t i = 0; i < nofIterations; i++)
+      for (size_t j = 0; j < words->size(); j++)
+      {
+        const string& query = (*queries)[j];
+        MicroBenchmarks::sink += distance.calculate(
+            query.substr(0, std::max<size_t>(query.size() / 2, 1)),
+            (*words)[j], 2);
+      }
+  });
+  benchmarks->add("editDistance/myers" + suffix.str(), words->size(),
+                  [=](size_t nofIterations)
+  {
+    FuzzySearch::CMyersEdistFastPair distance;
+    for (size_t i = 0; i < nofIterations; i++)
+      for (size_t j = 0; j < words->size(); j++)
+        MicroBenchmarks::sink += distance.calculate((*queries)[j],
+                                                    (*words)[j], false);
+  });
+}
+
+// Benchmark DocsDB::getDocument for random documents of the given DB.
+void addDocsDBBenchmark(const string& label, const string& dbFileName,
+                        std::mt19937* random, MicroBenchmarks* benchmarks)
+{
+  DocsDB* docsDB = new DocsDB(dbFileName);
+  if (docsDB->getNofDocs() == 0) return;
+  vector<DocId>* docIds = new vector<DocId>();
+  for (size_t i = 0; i < 256; i++)
+    docIds->push_back(docsDB->getDocIds()[(*random)()
+                                          % docsDB->getNofDocs()]);
+  std::ostringstream name;
+  name << "docsDB/getDocument " << label << " docs=" << docsDB->getNofDocs();
+  benchmarks->add(name.str(), docIds->size(), [=](size_t nofIterations)
+  {
+    Document document;
+    for (size_t i = 0; i < nofIterations; i++)
+      for (size_t j = 0; j < docIds->size(); j++)
+      {
+        docsDB->getDocument((*docIds)[j], document);
+        MicroBenchmarks::sink += document.getText().size();
+      }
+  });
+}
+
+// Write a docs file with the given number of documents of synthetic words and
+// build a docs DB from it (see DocsDB::build).
+void buildSyntheticDocsDB(size_t nofDocs, const vector<string>& words,
+                          std::mt19937* random, string dbFileName)
+{
+  string docsFileName = dbFileName.substr(0, dbFileName.rfind('.'));
+  std::ofstream docs(docsFileName.c_str());
+  for (size_t i = 1; i <= nofDocs; i++)
+  {
+    docs << i << "\tu:http://doc" << i << "\tt:" << words[i % words.size()]
+         << "\tH:";
+    size_t length = 50 + (*random)() % 200;
+    for (size_t j = 0; j < length; j++)
+      docs << (j > 0 ? " " : "") << words[(*random)() % words.size()];
+    docs << endl;
+  }
+  docs.close();
+  DocsDB::build(docsFileName, dbFileName);
+  remove(docsFileName.c_str());
+}
+
+// _____________________________________________________________________________
+int main(int argc, char** argv)
+{
+  MicroBenchmarks::Options options;
+  size_t nofPostings = 100000;
+  double zipfExponent = 1;
+  string indexFileName;
+  string jsonFileName;
+  string baselineFileName;
+  double threshold = 0.05;
+  while (true)
+  {
+    int c = getopt(argc, argv, "f:n:z:r:t:i:j:b:T:");
+    if (c == -1) break;
+    switch (c)
+    {
+      case 'f': options.filter = optarg; break;
+      case 'n': nofPostings = atoi(optarg); break;
+      case 'z': zipfExponent = atof(optarg); break;
+      case 'r': options.nofRuns = atoi(optarg); break;
+      case 't': options.minMsecsPerRun = atof(optarg); break;
+      case 'i': indexFileName = optarg; break;
+      case 'j': jsonFileName = optarg; break;
+      case 'b': baselineFileName = optarg; break;
+      case 'T': threshold = atof(optarg); break;
+      default: printUsage(); exit(1);
+    }
+  }
+  if (optind != argc || nofPostings < 100)
+  {
+    printUsage();
+    exit(1);
+  }
+
+  // Read the baseline first, so that a wrong file name is reported before
+  // running the benchmarks.
+  vector<MicroBenchmarks::Result> baseline;
+  if (!baselineFileName.empty())
+  {
+    std::ifstream is(baselineFileName.c_str());
+    if (!is.is_open())
+    {
+      cerr << "! could not open baseline \"" << baselineFileName << "\""
+           << endl;
+      exit(1);
+    }
+    MicroBenchmarks::readJson(is, &baseline);
+  }
+
+  // Synthetic data: two posting lists with Zipfian word ids, a vocabulary and
+  // a docs DB. With a fixed seed, so that all runs use the same data.
+  std::mt19937 random(42);
+  MicroBenchmarks benchmarks(options);
+  Completer completer;
+  size_t nofWords = std::max<size_t>(nofPostings / 10, 10);
+  ZipfDistribution wordIds(nofWords, zipfExponent);
+  QueryResult list1;
+  QueryResult list2;
+  syntheticPostings(nofPostings / 4, nofPostings, &wordIds, &random, &list1);
+  syntheticPostings(nofPostings, nofPostings, &wordIds, &random, &list2);
+  std::ostringstream label;
+  label << "zipf s=" << zipfExponent;
+  addPostingListBenchmarks(label.str(), list1, list2, &completer, &benchmarks);
+  addBitmapBenchmarks(nofPostings, list1._docIds, &random, &benchmarks);
+  vector<string> words;
+  syntheticWords(nofWords, &random, &words);
+  Vocabulary vocabulary;
+  for (size_t i = 0; i < words.size(); i++) vocabulary.push_back(words[i]);
+  addVocabularyBenchmarks("zipf", vocabulary, &random, &benchmarks);
+  std::ostringstream dbFileName;
+  dbFileName << "MicroBenchmarkPerf." << getpid() << ".docs.DB";
+  buildSyntheticDocsDB(1000, words, &random, dbFileName.str());
+  addDocsDBBenchmark("zipf", dbFileName.str(), &random, &benchmarks);
+
+  // Real data: the two largest blocks (by compressed size) of the given
+  // index, its vocabulary and its docs DB.
+  HYBIndex* index = NULL;
+  Completer* indexCompleter = NULL;
+  TimedHistory history;
+  QueryResult block1;
+  QueryResult block2;
+  if (!indexFileName.empty())
+  {
+    string baseName = indexFileName.substr(0, indexFileName.rfind('.'));
+    try
+    {
+      index = new HYBIndex(indexFileName, baseName + ".vocabulary",
+                           Completer::mode());
+      index->read();
+      indexCompleter = new Completer(index, &history, &nullFuzzySearcher);
+      const vector<off_t>& offsets = indexCompleter->getByteOffsetsForBlocks();
+      vector<pair<off_t, BlockId> > blocks;
+      for (size_t i = 0; i + 2 < offsets.size(); i++)
+        blocks.push_back(std::make_pair(offsets[i + 1] - offsets[i], i));
+      if (blocks.empty()) CS_THROW(Exception::OTHER, "index has no blocks");
+      // With only one block, intersect it with itself.
+      std::sort(blocks.rbegin(), blocks.rend());
+      if (blocks.size() == 1) blocks.push_back(blocks[0]);
+      indexCompleter->getDataForBlockId(blocks[1].second, block1);
+      indexCompleter->getDataForBlockId(blocks[0].second, block2);
+      if (block1._docIds.size() > block2._docIds.size())
+      {
+        block1.clear();
+        block2.clear();
+        indexCompleter->getDataForBlockId(blocks[0].second, block1);
+        indexCompleter->getDataForBlockId(blocks[1].second, block2);
+      }
+    }
+    catch(const Exception& e)
+    {
+      cerr << "! " << e.getFullErrorMessage() << endl;
+      remove(dbFileName.str().c_str());
+      exit(1);
+    }
+    addPostingListBenchmarks("index", block1, block2, &completer, &benchmarks);
+    addVocabularyBenchmarks("index", index->_vocabulary, &random, &benchmarks);
+    FILE* file = fopen((baseName + ".docs.DB").c_str(), "r");
+    if (file != NULL)
+    {
+      fclose(file);
+      addDocsDBBenchmark("index", baseName + ".docs.DB", &random, &benchmarks);
+    }
+  }
+
+  cout << endl;
+  benchmarks.run(cout);
+  remove(dbFileName.str().c_str());
+
+  if (!jsonFileName.empty())
+  {
+    std::ofstream os(jsonFileName.c_str());
+    benchmarks.writeJson(os);
+    cout << endl << "* wrote results to \"" << jsonFileName << "\"" << endl;
+  }
+  if (!baselineFileName.empty())
+  {
+    cout << endl << "* compared to \"" << baselineFileName << "\" (threshold "
+         << 100 * threshold << "%):" << endl << endl;
+    size_t nofSlower = benchmarks.compare(baseline, threshold, cout);
+    cout << endl << "* " << nofSlower << " of " << benchmarks.getResults().size()
+         << " benchmarks got slower" << endl;
+    if (nofSlower > 0) return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "server/MicroBenchmark.h"
+
+// Median and MAD, which an outlier does not change much.
+TEST(MicroBenchmarkTest, statistics)
+{
+  double nsecs[] = { 12, 10, 11, 1000, 10 };
+  MicroBenchmarks::Result result = MicroBenchmarks::statistics(
+      "x", 5, 100, vector<double>(nsecs, nsecs + 5));
+  ASSERT_EQ("x", result.name);
+  ASSERT_EQ(100u, result.nofIterations);
+  ASSERT_DOUBLE_EQ(11, result.medianNsecs);
+  ASSERT_DOUBLE_EQ(1, result.madNsecs);
+  ASSERT_DOUBLE_EQ(10, result.minNsecs);
+  ASSERT_DOUBLE_EQ(11, MicroBenchmarks::statistics(
+      "y", 1, 1, vector<double>(nsecs, nsecs + 2)).medianNsecs);
+}
+
+// Running, writing and reading back, and comparing to a baseline.
+TEST(MicroBenchmarkTest, runAndCompare)
+{
+  MicroBenchmarks::Options options;
+  options.minMsecsPerRun = 1;
+  options.nofRuns = 3;
+  options.filter = "sum";
+  MicroBenchmarks benchmarks(options);
+  size_t nofCalls = 0;
+  benchmarks.add("sum n=1000", 1000, [&](size_t nofIterations)
+  {
+    nofCalls++;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < nofIterations; i++)
+      for (uint64_t j = 0; j < 1000; j++) sum += j ^ i;
+    MicroBenchmarks::sink = sum;
+  });
+  benchmarks.add("other", 1, [](size_t nofIterations) { });
+  std::ostringstream log;
+  benchmarks.run(log);
+  ASSERT_EQ(1u, benchmarks.getResults().size());
+  // At least one calibration run, the warmup run and the measured runs.
+  ASSERT_GE(nofCalls, 5u);
+  const MicroBenchmarks::Result& result = benchmarks.getResults()[0];
+  ASSERT_GT(result.medianNsecs, 0);
+  ASSERT_GE(result.nofIterations * result.medianNsecs, 0.5e6);
+  ASSERT_NE(string::npos, log.str().find("sum n=1000"));
+
+  std::stringstream json;
+  benchmarks.writeJson(json);
+  vector<MicroBenchmarks::Result> baseline;
+  MicroBenchmarks::readJson(json, &baseline);
+  ASSERT_EQ(1u, baseline.size());
+  ASSERT_EQ("sum n=1000", baseline[0].name);
+  ASSERT_EQ(1000u, baseline[0].nofItems);
+  ASSERT_NEAR(result.medianNsecs, baseline[0].medianNsecs, 1e-3);
+
+  // Twice as fast in the baseline (and faster by more than the noise of the
+  // measurement) and without noise: slower. Slower by less than the threshold
+  // or within the noise: the same.
+  std::ostringstream os;
+  baseline[0].medianNsecs = std::min(
+      result.medianNsecs / 2, result.medianNsecs - 4 * result.madNsecs - 1);
+  baseline[0].madNsecs = 0;
+  ASSERT_EQ(1u, benchmarks.compare(baseline, 0.05, os));
+  ASSERT_NE(string::npos, os.str().find("SLOWER"));
+  baseline[0].medianNsecs = result.medianNsecs / 2;
+  ASSERT_EQ(0u, benchmarks.compare(baseline, 1.5, os));
+  baseline[0].madNsecs = result.medianNsecs;
+  ASSERT_EQ(0u, benchmarks.compare(baseline, 0.05, os));
+  baseline[0].name = "renamed";
+  ASSERT_EQ(0u, benchmarks.compare(baseline, 0.05, os));
+  ASSERT_NE(string::npos, os.str().find("not in baseline"));
+
+  std::istringstream empty("{\n}\n");
+  ASSERT_ANY_THROW(MicroBenchmarks::readJson(empty, &baseline));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/PrefixMatcher.h"
+#include "server/Globals.h"
+
+const size_t PrefixMatcher::NOT_FOUND;
+
+// _____________________________________________________________________________
+PrefixMatcher::PrefixMatcher()
+{
+  clear();
+}
+
+// _____________________________________________________________________________
+void PrefixMatcher::clear()
+{
+  _nodes.assign(1, Node());
+  _patterns.clear();
+}
+
+// _____________________________________________________________________________
+uint32_t PrefixMatcher::child(uint32_t node, unsigned char c) const
+{
+  const vector<pair<unsigned char, uint32_t> >& children
+    = _nodes[node].children;
+  for (size_t i = 0; i < children.size(); i++)
+    if (children[i].first == c) return children[i].second;
+  return 0;
+}
+
+// _____________________________________________________________________________
+size_t PrefixMatcher::add(const string& pattern, bool isComplete)
+{
+  size_t id = find(pattern, isComplete);
+  if (id != NOT_FOUND) return id;
+  uint32_t node = 0;
+  for (size_t i = 0; i < pattern.size(); i++)
+  {
+    unsigned char c = pattern[i];
+    uint32_t next = child(node, c);
+    if (next == 0)
+    {
+      next = _nodes.size();
+      _nodes[node].children.push_back(std::make_pair(c, next));
+      _nodes.push_back(Node());
+    }
+    node = next;
+  }
+  id = _patterns.size();
+  _patterns.push_back(std::make_pair(pattern, isComplete));
+  if (isComplete) _nodes[node].completeIds.push_back(id);
+  else _nodes[node].prefixIds.push_back(id);
+  return id;
+}
+
+// _____________________________________________________________________________
+size_t PrefixMatcher::find(const string& pattern, bool isComplete) const
+{
+  uint32_t node = 0;
+  for (size_t i = 0; i < pattern.size(); i++)
+  {
+    node = child(node, pattern[i]);
+    if (node == 0) return NOT_FOUND;
+  }
+  const vector<uint32_t>& ids
+    = isComplete ? _nodes[node].completeIds : _nodes[node].prefixIds;
+  return ids.empty() ? NOT_FOUND : ids[0];
+}
+
+// _____________________________________________________________________________
+void PrefixMatcher::setBits(const vector<uint32_t>& ids, uint64_t* mask)
+{
+  for (size_t i = 0; i < ids.size(); i++)
+    mask[ids[i] / 64] |= 1ul << (ids[i] % 64);
+}
+
+// _____________________________________________________________________________
+void PrefixMatcher::walk(const string& word, size_t start,
+                         bool skipSeparators, uint64_t* mask) const
+{
+  uint32_t node = 0;
+  bool previousCharacterWasSeparator = false;
+  for (size_t i = start; i < word.size(); i++)
+  {
+    if (skipSeparators && word[i] == wordPartSeparator)
+    {
+      if (previousCharacterWasSeparator) return;
+      previousCharacterWasSeparator = true;
+      continue;
+    }
+    previousCharacterWasSeparator = false;
+    node = child(node, word[i]);
+    if (node == 0) return;
+    setBits(_nodes[node].prefixIds, mask);
+    // A complete pattern must end with the last character of the word.
+    if (i + 1 == word.size()) setBits(_nodes[node].completeIds, mask);
+  }
+}
+
+// _____________________________________________________________________________
+void PrefixMatcher::match(const string& word, uint64_t* mask) const
+{
+  // The empty prefix matches every word.
+  setBits(_nodes[0].prefixIds, mask);
+  if (word.empty() || word[0] != wordPartSeparator)
+  {
+    walk(word, 0, false, mask);
+    return;
+  }
+  // From the start of each subword, i.e. after each sequence of ^.
+  size_t start = 0;
+  while (start < word.size())
+  {
+    while (start < word.size() && word[start] == wordPartSeparator) ++start;
+    if (start == word.size()) break;
+    walk(word, start, true, mask);
+    start = word.find(wordPartSeparator, start);
+  }
+}
@@ -0,0 +1,82 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_PREFIXMATCHER_H_
+#define SERVER_PREFIXMATCHER_H_
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+// Matches the words of a document against all words of a query at once, for
+// the highlighting in ExcerptsGenerator.
+//
+// The query words (patterns) are either prefixes (info* without the *) or
+// complete words, and match a document word like ExcerptsGenerator::isPrefix
+// and ExcerptsGenerator::isEqual: a word starting with ^ (wordPartSeparator)
+// consists of subwords, and a pattern may match from the start of any
+// subword on, ignoring single ^ but not crossing ^^. Any other word must
+// start with the pattern (for a prefix) or be equal to it.
+//
+// The patterns are compiled into a trie over the bytes of the normalised
+// (UTF-8) words. A document word is then matched by one walk down the trie
+// from each subword start, no matter how many patterns there are.
+class PrefixMatcher
+{
+ public:
+  PrefixMatcher();
+
+  // Remove all patterns.
+  void clear();
+
+  // Add the given pattern (if not yet there) and return its id. Ids are
+  // consecutive, starting from 0.
+  size_t add(const string& pattern, bool isComplete);
+
+  // The id of the given pattern, or NOT_FOUND.
+  size_t find(const string& pattern, bool isComplete) const;
+  static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  // The number of patterns.
+  size_t size() const { return _patterns.size(); }
+
+  // The number of uint64_t of a match mask, one bit per pattern.
+  size_t maskSize() const { return (_patterns.size() + 63) / 64; }
+
+  // Set the bits of the patterns that match the given word in the given mask
+  // (of maskSize() words, which is not cleared before).
+  void match(const string& word, uint64_t* mask) const;
+
+ private:
+  struct Node
+  {
+    // The children, by byte, unsorted (nodes have few children).
+    vector<pair<unsigned char, uint32_t> > children;
+    // The ids of the prefix and of the complete patterns ending here.
+    vector<uint32_t> prefixIds;
+    vector<uint32_t> completeIds;
+  };
+
+  // The child of the given node for the given byte, or 0 if there is none
+  // (the root is never a child).
+  uint32_t child(uint32_t node, unsigned char c) const;
+
+  // Walk down the trie along the given word from position start on. With
+  // skipSeparators, single ^ are skipped and ^^ ends the walk (for words
+  // starting with ^).
+  void walk(const string& word, size_t start, bool skipSeparators,
+            uint64_t* mask) const;
+
+  static void setBits(const vector<uint32_t>& ids, uint64_t* mask);
+
+  vector<Node> _nodes;
+  // The patterns by id: the string and whether it is complete.
+  vector<pair<string, bool> > _patterns;
+};
+
+#endif  // SERVER_PREFIXMATCHER_H_
@@ -0,0 +1,98 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "server/PrefixMatcher.h"
+
+// The ids of the patterns that match the given word, as a string like "0 2".
+string matchingIds(const PrefixMatcher& matcher, const string& word)
+{
+  vector<uint64_t> mask(matcher.maskSize(), 0);
+  matcher.match(word, &mask[0]);
+  string ids;
+  for (size_t i = 0; i < matcher.size(); i++)
+  {
+    if ((mask[i / 64] >> (i % 64)) & 1)
+      ids += (ids.empty() ? "" : " ") + std::to_string(i);
+  }
+  return ids;
+}
+
+// Adding and finding patterns.
+TEST(PrefixMatcherTest, addAndFind)
+{
+  PrefixMatcher matcher;
+  ASSERT_EQ(0u, matcher.size());
+  ASSERT_EQ(0u, matcher.add("pro", false));
+  ASSERT_EQ(1u, matcher.add("pro", true));
+  ASSERT_EQ(2u, matcher.add("proseminar", true));
+  ASSERT_EQ(0u, matcher.add("pro", false));
+  ASSERT_EQ(3u, matcher.size());
+  ASSERT_EQ(1u, matcher.maskSize());
+  ASSERT_EQ(0u, matcher.find("pro", false));
+  ASSERT_EQ(1u, matcher.find("pro", true));
+  ASSERT_EQ(PrefixMatcher::NOT_FOUND, matcher.find("pr", false));
+  ASSERT_EQ(PrefixMatcher::NOT_FOUND, matcher.find("proseminar", false));
+  ASSERT_EQ(PrefixMatcher::NOT_FOUND, matcher.find("proseminars", true));
+  matcher.clear();
+  ASSERT_EQ(0u, matcher.size());
+  ASSERT_EQ(PrefixMatcher::NOT_FOUND, matcher.find("pro", false));
+}
+
+// Matching words without ^, like ExcerptsGenerator::isPrefix and isEqual.
+TEST(PrefixMatcherTest, matchPlainWords)
+{
+  PrefixMatcher matcher;
+  matcher.add("pro", false);         // 0
+  matcher.add("prose", false);       // 1
+  matcher.add("semir", false);       // 2
+  matcher.add("proseminar", true);   // 3
+  matcher.add("seminar", true);      // 4
+  matcher.add("pro", true);          // 5
+  ASSERT_EQ("0 1 3", matchingIds(matcher, "proseminar"));
+  ASSERT_EQ("0 5", matchingIds(matcher, "pro"));
+  ASSERT_EQ("4", matchingIds(matcher, "seminar"));
+  ASSERT_EQ("", matchingIds(matcher, "pr"));
+  ASSERT_EQ("", matchingIds(matcher, ""));
+  matcher.add("", false);            // 6
+  ASSERT_EQ("6", matchingIds(matcher, "x"));
+}
+
+// Matching words with ^, like ExcerptsGenerator::isPrefix and isEqual.
+TEST(PrefixMatcherTest, matchWordsWithSubwords)
+{
+  PrefixMatcher matcher;
+  matcher.add("pro", false);         // 0
+  matcher.add("semin", false);       // 1
+  matcher.add("prose", false);       // 2
+  matcher.add("ro", false);          // 3
+  matcher.add("prosex", false);      // 4
+  matcher.add("proseminar", true);   // 5
+  matcher.add("seminar", true);      // 6
+  matcher.add("pro", true);          // 7
+  matcher.add("prosemina", true);    // 8
+  ASSERT_EQ("0 1 2 5 6", matchingIds(matcher, "^pro^seminar"));
+  // Not across ^^.
+  ASSERT_EQ("0 1 6", matchingIds(matcher, "^pro^^seminar"));
+  ASSERT_EQ("0", matchingIds(matcher, "^pro^"));
+  ASSERT_EQ("0 1 2 3 5 6", matchingIds(matcher, "^p^ro^seminar"));
+}
+
+// More than 64 patterns.
+TEST(PrefixMatcherTest, manyPatterns)
+{
+  PrefixMatcher matcher;
+  for (int i = 0; i < 100; i++) matcher.add("w" + std::to_string(i), true);
+  matcher.add("w9", false);
+  ASSERT_EQ(2u, matcher.maskSize());
+  ASSERT_EQ("99 100", matchingIds(matcher, "w99"));
+  ASSERT_EQ("9 100", matchingIds(matcher, "w9"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
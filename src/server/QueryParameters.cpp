@@ -1,3 +1,4 @@
+#include <string.h>
 #include "QueryParameters.h"
 #include "ScoreAggregators.h"
 
@@ -74,6 +75,7 @@ void QueryParameters::setToDefaultValues()
   // how to rank
   howToRankDocs  = howToRankDocsDefault;
   howToRankWords = howToRankWordsDefault;
+  docValuesField = "";
   sortOrderDocs  = sortOrderDocsDefault;
   sortOrderWords = sortOrderWordsDefault;
 
@@ -252,62 +254,108 @@ template void QueryParameters::setHowToRank<QueryParameters::HowToRankWordsEnum>
 	        SortOrderEnum& sortOrder);
 
 //! Extract parameters from query in HTTP URL form ?q=<query>&m=10&c=2&...
-bool QueryParameters::extractFromRequestStringHttp(string& queryString)
+bool QueryParameters::extractFromRequestStringHttp(const string& queryString)
 {
-  size_t pos = 0;
-  size_t pos_0;
-  while (pos < queryString.size())
+  string buffer = queryString;
+  return extractFromRequestStringHttp(&buffer[0], &buffer[0] + buffer.size());
+}
+
+//! Extract parameters from the given range of the form ?q=<query>&m=10&c=2&...
+bool QueryParameters::extractFromRequestStringHttp(char* begin, char* end)
+{
+  char* pos = begin;
+  while (pos < end)
   {
     // expecting '&'
-    if (queryString[pos] != '&' && queryString[pos] != '?') {
-      cerr << "! ERROR PARSING QUERY: expected '&' or '?' at position " << pos 
-           << " of queryString \""  << queryString << "\"" << endl;
+    if (*pos != '&' && *pos != '?') {
+      cerr << "! ERROR PARSING QUERY: expected '&' or '?' at position " << pos - begin
+           << " of queryString \""  << string(begin, end) << "\"" << endl;
       return false;
     }
     // advance by one
     ++pos;
-    if (pos >= queryString.size()) {
-      cerr << "! ERROR PARSING QUERY: parameter name expected after '&' at position " << pos 
-           << " of queryString \""  << queryString << "\"" << endl;
+    if (pos >= end) {
+      cerr << "! ERROR PARSING QUERY: parameter name expected after '&' at position " << pos - begin
+           << " of queryString \""  << string(begin, end) << "\"" << endl;
       return false;
     }
     // looking for next '='
-    pos_0 = pos;
-    while (pos < queryString.size() && queryString[pos] != '=') ++pos;
-    if (pos >= queryString.size() || queryString[pos] != '=') {
-      cerr << "! ERROR PARSING QUERY: expected '=' after '&' at position " << pos 
-           << " of queryString \""  << queryString << "\"" << endl;
+    char* name = pos;
+    pos = static_cast<char*>(memchr(pos, '=', end - pos));
+    if (pos == NULL) {
+      cerr << "! ERROR PARSING QUERY: expected '=' after '&' at position " << end - begin
+           << " of queryString \""  << string(begin, end) << "\"" << endl;
       return false;
     }
-    string parameter = queryString.substr(pos_0, pos - pos_0);
+    size_t nameLength = pos - name;
     // advance by one
     ++pos;
-    pos_0 = pos;
+    char* value = pos;
     // looking for next '&' or end of string
-    while (pos < queryString.size() && queryString[pos] != '&') ++pos;
-    string value = (pos_0 != pos ? queryString.substr(pos_0, pos - pos_0) : "");
-    // set queryString parameter
-    if      (parameter == "q")  { query = value; queryType = NORMAL; }
-    else if (parameter == "c")  nofCompletionsToSend = atoi(value.c_str());
-    else if (parameter == "h")  nofHitsToSend        = atoi(value.c_str());
-    else if (parameter == "f")  firstHitToSend       = atoi(value.c_str());
-    else if (parameter == "en") nofExcerptsPerHit    = atoi(value.c_str());
-    else if (parameter == "er") excerptRadius        = atoi(value.c_str());
-    else if (parameter == "rd") setHowToRank(value, howToRankDocs, sortOrderDocs);
-    else if (parameter == "rw") setHowToRank(value, howToRankWords, sortOrderWords);
-    else if (parameter == "n")  setNeighbourhoodSize(value);
-    else if (parameter == "fd") fuzzyDamping         = atof(value.c_str());
-    else if (parameter == "s")  setAllScoreAggregations(value);
-    else if (parameter == "p")  titleIndex           = atoi(value.c_str());
-    else if (parameter == "format")   setResponseFormat(value);
-    else if (parameter == "callback") { callback = value; format = JSONP; }
-    else if (parameter == "exe") { query = value; queryType = EXE; }
-    // NEW (baumgari) 10Jan14: This a a parameter which is usually sent by
-    // AJAX-Requests. Just ignore it.
-    else if (parameter == "_") { }
-    else LOG << "! WARNING PARSING QUERY: unknown parameter \"" << parameter << "\"" << endl;
+    pos = static_cast<char*>(memchr(pos, '&', end - pos));
+    if (pos == NULL) pos = end;
+    // url decode the value (+ -> space, %20 -> space, etc.) and set it
+    size_t valueLength = decodeHexNumbersInPlace(value, pos - value);
+    setParameter(name, nameLength, value, valueLength);
   } 
+  setDerivedValues();
+  return true;
+
+} // end of method extractFromQuery
+
+namespace {
+// The number at the beginning of the given value, like atoi but for a value
+// that is not null-terminated.
+int parseInt(const char* value, size_t length)
+{
+  const char* end = value + length;
+  while (value < end && isspace(*value)) value++;
+  bool negative = value < end && *value == '-';
+  if (value < end && (*value == '-' || *value == '+')) value++;
+  int x = 0;
+  for (; value < end && *value >= '0' && *value <= '9'; value++)
+    x = 10 * x + (*value - '0');
+  return negative ? -x : x;
+}
+
+// Whether the given name is the given string.
+bool isName(const char* name, size_t nameLength, const char* s)
+{
+  return strlen(s) == nameLength && memcmp(name, s, nameLength) == 0;
+}
+}
 
+//! Set the parameter with the given name to the given (decoded) value.
+void QueryParameters::setParameter(const char* name, size_t nameLength,
+                                   const char* value, size_t valueLength)
+{
+  #define PARAMETER(s) isName(name, nameLength, s)
+  if      (PARAMETER("q"))  { query.assign(value, valueLength); queryType = NORMAL; }
+  else if (PARAMETER("c"))  nofCompletionsToSend = parseInt(value, valueLength);
+  else if (PARAMETER("h"))  nofHitsToSend        = parseInt(value, valueLength);
+  else if (PARAMETER("f"))  firstHitToSend       = parseInt(value, valueLength);
+  else if (PARAMETER("en")) nofExcerptsPerHit    = parseInt(value, valueLength);
+  else if (PARAMETER("er")) excerptRadius        = parseInt(value, valueLength);
+  else if (PARAMETER("rd")) setHowToRank(string(value, valueLength), howToRankDocs, sortOrderDocs);
+  else if (PARAMETER("rw")) setHowToRank(string(value, valueLength), howToRankWords, sortOrderWords);
+  else if (PARAMETER("dv")) docValuesField.assign(value, valueLength);
+  else if (PARAMETER("n"))  setNeighbourhoodSize(string(value, valueLength));
+  else if (PARAMETER("fd")) fuzzyDamping         = atof(string(value, valueLength).c_str());
+  else if (PARAMETER("s"))  setAllScoreAggregations(string(value, valueLength));
+  else if (PARAMETER("p"))  titleIndex           = parseInt(value, valueLength);
+  else if (PARAMETER("format"))   setResponseFormat(string(value, valueLength));
+  else if (PARAMETER("callback")) { callback.assign(value, valueLength); format = JSONP; }
+  else if (PARAMETER("exe")) { query.assign(value, valueLength); queryType = EXE; }
+  // NEW (baumgari) 10Jan14: This a a parameter which is usually sent by
+  // AJAX-Requests. Just ignore it.
+  else if (PARAMETER("_")) { }
+  else LOG << "! WARNING PARSING QUERY: unknown parameter \"" << string(name, nameLength) << "\"" << endl;
+  #undef PARAMETER
+}
+
+//! Set the values that are derived from the others.
+void QueryParameters::setDerivedValues()
+{
   // these are currently not user-definable, so set them as follows: compute
   // sufficiently many top hits, and always a certain minimum
   // TODO: this causes a top-k recomputation for every "next page operation",
@@ -319,10 +367,170 @@ bool QueryParameters::extractFromRequestStringHttp(string& queryString)
   // NEW(hagn, 15Jun11): 0.01 <= fuzzyDamping <= 1.00
   fuzzyDamping = MAX(fuzzyDamping, 0.01);
   fuzzyDamping = MIN(fuzzyDamping, 1.00);
+}
 
-  return true;
+namespace {
+// Skip whitespace in a JSON text.
+char* skipSpace(char* pos, char* end)
+{
+  while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) ++pos;
+  return pos;
+}
 
-} // end of method extractFromQuery
+// The value of the given hex digit, or -1 if it is none.
+int hexValue(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// The code point of the four hex digits at the given position, or -1.
+int parseCodePoint(const char* pos, const char* end)
+{
+  if (end - pos < 4) return -1;
+  int x = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    int h = hexValue(pos[i]);
+    if (h < 0) return -1;
+    x = 16 * x + h;
+  }
+  return x;
+}
+
+// Parse the JSON string starting at the given position (at the opening quote)
+// and decode it in place. The decoded string starts at the opening quote + 1
+// and has the returned length; *pos is set to after the closing quote.
+// Returns -1 if the string is malformed.
+long parseJsonString(char** pos, char* end)
+{
+  char* in = *pos + 1;
+  char* out = in;
+  char* begin = in;
+  while (in < end && *in != '"')
+  {
+    if (*in != '\\') { *out++ = *in++; continue; }
+    if (++in >= end) return -1;
+    char c = *in++;
+    switch (c)
+    {
+      case '"': case '\\': case '/': *out++ = c; break;
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      case 'u':
+      {
+        // \uXXXX, possibly a surrogate pair, as UTF-8 (never longer than the
+        // escape sequence).
+        int x = parseCodePoint(in, end);
+        if (x < 0) return -1;
+        in += 4;
+        if (x >= 0xD800 && x < 0xDC00 && end - in >= 6 && in[0] == '\\' && in[1] == 'u')
+        {
+          int y = parseCodePoint(in + 2, end);
+          if (y >= 0xDC00 && y < 0xE000)
+          {
+            x = 0x10000 + ((x - 0xD800) << 10) + (y - 0xDC00);
+            in += 6;
+          }
+        }
+        if (x < 0x80) { *out++ = x; }
+        else if (x < 0x800) { *out++ = 0xC0 | (x >> 6); *out++ = 0x80 | (x & 0x3F); }
+        else if (x < 0x10000)
+        {
+          *out++ = 0xE0 | (x >> 12);
+          *out++ = 0x80 | ((x >> 6) & 0x3F);
+          *out++ = 0x80 | (x & 0x3F);
+        }
+        else
+        {
+          *out++ = 0xF0 | (x >> 18);
+          *out++ = 0x80 | ((x >> 12) & 0x3F);
+          *out++ = 0x80 | ((x >> 6) & 0x3F);
+          *out++ = 0x80 | (x & 0x3F);
+        }
+        break;
+      }
+      default: return -1;
+    }
+  }
+  if (in >= end) return -1;
+  *pos = in + 1;
+  return out - begin;
+}
+}
+
+namespace {
+// Report a malformed JSON request (at the given position) and return false.
+bool malformedJson(const char* begin, const char* end, const char* pos)
+{
+  cerr << "! ERROR PARSING QUERY: malformed JSON request at position " << pos - begin
+       << " of \"" << string(begin, end) << "\"" << endl;
+  return false;
+}
+}
+
+//! Extract parameters from a JSON object {"q":"<query>","c":2,...}
+bool QueryParameters::extractFromJson(char* begin, char* end)
+{
+  char* pos = skipSpace(begin, end);
+  if (pos >= end || *pos != '{') {
+    cerr << "! ERROR PARSING QUERY: expected '{' at the beginning of JSON request \""
+         << string(begin, end) << "\"" << endl;
+    return false;
+  }
+  pos = skipSpace(pos + 1, end);
+  bool first = true;
+  while (pos < end && *pos != '}')
+  {
+    // expecting ',' between the members
+    if (!first) {
+      if (*pos != ',') return malformedJson(begin, end, pos);
+      pos = skipSpace(pos + 1, end);
+    }
+    first = false;
+    // the name
+    if (pos >= end || *pos != '"') return malformedJson(begin, end, pos);
+    char* name = pos + 1;
+    long nameLength = parseJsonString(&pos, end);
+    if (nameLength < 0) return malformedJson(begin, end, pos);
+    pos = skipSpace(pos, end);
+    if (pos >= end || *pos != ':') return malformedJson(begin, end, pos);
+    pos = skipSpace(pos + 1, end);
+    if (pos >= end) return malformedJson(begin, end, pos);
+    // the value: a string, a number, true or false
+    const char* value = pos;
+    long valueLength;
+    if (*pos == '"') {
+      value = pos + 1;
+      valueLength = parseJsonString(&pos, end);
+      if (valueLength < 0) return malformedJson(begin, end, pos);
+    } else if (end - pos >= 4 && memcmp(pos, "true", 4) == 0) {
+      value = "1";
+      valueLength = 1;
+      pos += 4;
+    } else if (end - pos >= 5 && memcmp(pos, "false", 5) == 0) {
+      value = "0";
+      valueLength = 1;
+      pos += 5;
+    } else {
+      while (pos < end && (isdigit(*pos) || *pos == '-' || *pos == '+'
+                           || *pos == '.' || *pos == 'e' || *pos == 'E')) ++pos;
+      valueLength = pos - value;
+      if (valueLength == 0) return malformedJson(begin, end, pos);
+    }
+    setParameter(name, nameLength, value, valueLength);
+    pos = skipSpace(pos, end);
+  }
+  if (pos >= end || skipSpace(pos + 1, end) != end)
+    return malformedJson(begin, end, pos);
+  setDerivedValues();
+  return true;
+}
 
 
 
@@ -362,6 +570,7 @@ std::string QueryParameters::asString(void) const
      << "Use Filtering                        : " << useFiltering << std::endl
      << "Merge (0) or hash (1) join           : " << howToJoin << std::endl
      << "How to rank docs                     : " << howToRankDocs << std::endl
+     << "Doc values field                     : " << docValuesField << std::endl
      << "How to rank words                    : " << howToRankWords << std::endl
      << "Fuzzy damping                        : " << fuzzyDamping << std::endl
      << "Docs sort order                      : " << sortOrderDocs << std::endl
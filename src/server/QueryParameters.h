@@ -5,7 +5,6 @@
 #include "Query.h"
 #include "ScoreAggregators.h"
 #include <fstream>
-#include <regex.h>
 #include "Vector.h"
 
 //extern ofstream* logfile;
@@ -16,17 +15,6 @@ using namespace std;
 //! THE PARAMETERS OF AN AUTOCOMPLETION QUERY (passed as string appended to the query)
 class QueryParameters
 {
-  private:
-
-    // flag telling whether the regex has been compiled (initialized to false below)
-    static bool regexesCompiled;
-    // the regex strings (OLD and HTTP)
-    static const char* regexStringOld;
-    static const char* regexStringHttp;
-    // the compiled regex (OLD and HTTP)
-    static regex_t* compiledRegexOld;
-    static regex_t* compiledRegexHttp;
-
   public:
 
     //! Dump object as string.
@@ -100,8 +88,12 @@ class QueryParameters
       RANK_DOCS_BY_COMPLETION_SCORES = 5,
       GROUP_DOCS_BY_WORD_ID = 6,
       RANK_DOCS_BY_FUZZY_SCORE = 7,
+      RANK_DOCS_BY_DOC_VALUE = 8,
     } howToRankDocs;
 
+    //! Field of the doc values (see DocValues.h) for RANK_DOCS_BY_DOC_VALUE
+    std::string docValuesField;
+
     //! How to rank words
     enum HowToRankWordsEnum {
       RANK_WORDS_BY_SCORE     = 0,
@@ -162,7 +154,7 @@ class QueryParameters
     //! How to aggregate word scores from different documents
     ScoreAggregation wordScoreAggDifferentDocuments;
 
-    //! Constructor: compiles regular expression needed for query parameters parsing (only once for the whole class)
+    //! Constructor: sets the default values
     QueryParameters();
 
     //! Set a single score aggregation via a descriptive character
@@ -204,6 +196,10 @@ class QueryParameters
     //! Set neighbour hood size for nearby search triggered by the operator ..
     void setNeighbourhoodSize(const string& value);
 
+    //! Set the values that are derived from the others (called at the end of
+    //! the extract methods).
+    void setDerivedValues();
+
     //! Get four character description of all four score aggregations
     string getScoreAggregationChars();
 
@@ -216,7 +212,30 @@ class QueryParameters
     static void setHowToRank(const string& value, T& howToRank, SortOrderEnum& sortOrder);
 
     //! Extract query and parameters from query in HTTP request form GET /?q=<query>&m=10&c=2&...
-    bool extractFromRequestStringHttp(string& queryString);
+    bool extractFromRequestStringHttp(const string& queryString);
+
+    //! Same, for the given range of a buffer (e.g. the request buffer).
+    /*!
+     *    The parameters are parsed in one pass over the range and their values
+     *    are url-decoded in place (so the range is changed), nothing else is
+     *    copied. Returns false if the range is not of the form ?p=v&p=v&...
+     */
+    bool extractFromRequestStringHttp(char* begin, char* end);
+
+    //! Extract query and parameters from a JSON object {"q":"<query>","c":2,...}
+    /*!
+     *    This is the body of a POST request with content type application/json.
+     *    The values must be strings, numbers, true or false (given to the
+     *    parameter as 1 or 0); the escape sequences of the strings are decoded
+     *    in place, like extractFromRequestStringHttp. Returns false if the
+     *    range is not such an object.
+     */
+    bool extractFromJson(char* begin, char* end);
+
+    //! Set the parameter with the given name to the given value (as in the HTTP
+    //! request, but already decoded). Unknown parameters are logged and ignored.
+    void setParameter(const char* name, size_t nameLength,
+                      const char* value, size_t valueLength);
 
     //! Output parameters to a stream, e.g. cout
     friend ostream& operator<<(ostream&, QueryParameters&);
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "QueryParameters.h"
 #include <gtest/gtest.h>
 
@@ -98,6 +99,60 @@ TEST(QueryParametersTest, extractFromRequestStringHttp)
   }
 }
 
+TEST(QueryParametersTest, extractFromRequestStringHttpInPlace)
+{
+  // The values are url-decoded in place, the names are not.
+  QueryParameters q;
+  char request[] = "?q=a+b%26c%3A&h=%31%32&cal%6Cback=f&c=7";
+  EXPECT_TRUE(q.extractFromRequestStringHttp(request,
+                                             request + strlen(request)));
+  EXPECT_EQ("a b&c:", q.query);
+  EXPECT_EQ(12u, q.nofHitsToSend);
+  EXPECT_EQ(7u, q.nofCompletionsToSend);
+  EXPECT_EQ("callback", q.callback);
+  EXPECT_EQ(QueryParameters::XML, q.format);
+  // Only the given range is parsed.
+  char request2[] = "?q=test&h=5";
+  EXPECT_TRUE(q.extractFromRequestStringHttp(request2, request2 + 7));
+  EXPECT_EQ("test", q.query);
+  EXPECT_EQ(12u, q.nofHitsToSend);
+}
+
+TEST(QueryParametersTest, extractFromJson)
+{
+  {
+    QueryParameters q;
+    string json = " { \"q\" : \"a\\\"b\\u00e4\\ud83d\\ude00\", \"h\": 20,"
+                  "\"fd\":0.25, \"rw\": \"3a\", \"format\":\"json\" } ";
+    EXPECT_TRUE(q.extractFromJson(&json[0], &json[0] + json.size()));
+    EXPECT_EQ("a\"b\xc3\xa4\xf0\x9f\x98\x80", q.query);
+    EXPECT_EQ(QueryParameters::NORMAL, q.queryType);
+    EXPECT_EQ(20u, q.nofHitsToSend);
+    EXPECT_EQ(100u, q.nofTopHitsToCompute);
+    EXPECT_FLOAT_EQ(0.25, q.fuzzyDamping);
+    EXPECT_EQ(QueryParameters::RANK_WORDS_BY_WORD_ID, q.howToRankWords);
+    EXPECT_EQ(SORT_ORDER_ASCENDING, q.sortOrderWords);
+    EXPECT_EQ(QueryParameters::JSON, q.format);
+  }
+  {
+    QueryParameters q;
+    string json = "{}";
+    EXPECT_TRUE(q.extractFromJson(&json[0], &json[0] + json.size()));
+    EXPECT_EQ("", q.query);
+  }
+  // Malformed objects.
+  const char* malformed[] = { "", "[]", "{", "{\"q\":}", "{\"q\" \"x\"}",
+                              "{\"q\":\"x\" \"h\":1}", "{\"q\":\"x}",
+                              "{\"q\":\"\\x\"}", "{\"q\":[1]}", "{} x" };
+  for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+  {
+    QueryParameters q;
+    string json = malformed[i];
+    EXPECT_FALSE(q.extractFromJson(&json[0], &json[0] + json.size()))
+      << malformed[i];
+  }
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
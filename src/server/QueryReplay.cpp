@@ -0,0 +1,393 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/QueryReplay.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "server/Exception.h"
+
+using std::endl;
+using std::map;
+using std::ostringstream;
+using std::setw;
+
+namespace
+{
+// The number of word and prefix length classes (the last one is "n+").
+const size_t NOF_WORDS_CLASSES = 4;
+const size_t NOF_PREFIX_CLASSES = 7;
+
+// The first class of each group, see getClassNames().
+const size_t WORDS_CLASS = 1;
+const size_t PREFIX_CLASS = WORDS_CLASS + NOF_WORDS_CLASSES;
+const size_t TYPE_CLASS = PREFIX_CLASS + NOF_PREFIX_CLASSES;
+enum { TYPE_PLAIN, TYPE_FUZZY, TYPE_OR, TYPE_JOIN, TYPE_INFIX, NOF_TYPES };
+const char* TYPE_NAMES[NOF_TYPES] = { "plain", "fuzzy", "or", "join", "infix" };
+
+const size_t NOF_OUTCOMES = ReplayStatistics::FAILED + 1;
+
+// The query without a trailing *.
+string withoutStar(const string& query)
+{
+  if (!query.empty() && query[query.size() - 1] == '*')
+    return query.substr(0, query.size() - 1);
+  return query;
+}
+
+// Whether one of the two strings is a prefix of the other.
+bool isPrefixOrExtension(const string& a, const string& b)
+{
+  size_t n = a.size() < b.size() ? a.size() : b.size();
+  return a.compare(0, n, b, 0, n) == 0;
+}
+
+// The names of the classes, in the order given by the constants above.
+vector<string> classNames()
+{
+  vector<string> names;
+  names.push_back("all");
+  for (size_t i = 1; i <= NOF_WORDS_CLASSES; i++)
+  {
+    ostringstream os;
+    os << "words=" << i << (i == NOF_WORDS_CLASSES ? "+" : "");
+    names.push_back(os.str());
+  }
+  for (size_t i = 0; i < NOF_PREFIX_CLASSES; i++)
+  {
+    ostringstream os;
+    os << "prefix=" << i << (i + 1 == NOF_PREFIX_CLASSES ? "+" : "");
+    names.push_back(os.str());
+  }
+  for (size_t i = 0; i < NOF_TYPES; i++) names.push_back(TYPE_NAMES[i]);
+  return names;
+}
+}
+
+// _____________________________________________________________________________
+void QueryLog::read(const string& fileName)
+{
+  std::ifstream file(fileName.c_str());
+  if (!file)
+    CS_THROW(Exception::OTHER, "could not open query log \"" << fileName
+             << "\": " << strerror(errno));
+  parse(file);
+}
+
+// _____________________________________________________________________________
+void QueryLog::parse(istream& is)
+{
+  map<string, uint32_t> sessionsById;
+  for (size_t i = 0; i < _sessionIds.size(); i++)
+    if (!_sessionIds[i].empty()) sessionsById[_sessionIds[i]] = i;
+  string line;
+  while (std::getline(is, line))
+  {
+    while (!line.empty() && isspace(static_cast<unsigned char>(
+             line[line.size() - 1])))
+      line.erase(line.size() - 1);
+    string sessionId;
+    size_t tab = line.find('\t');
+    if (tab != string::npos)
+    {
+      sessionId = line.substr(0, tab);
+      line.erase(0, tab + 1);
+    }
+    if (line.empty()) continue;
+
+    uint32_t session;
+    if (!sessionId.empty())
+    {
+      map<string, uint32_t>::iterator it = sessionsById.find(sessionId);
+      if (it == sessionsById.end())
+      {
+        session = _sessions.size();
+        sessionsById[sessionId] = session;
+        _sessions.push_back(vector<string>());
+        _sessionIds.push_back(sessionId);
+      }
+      else
+      {
+        session = it->second;
+      }
+    }
+    else if (!_order.empty() && _sessionIds[_order.back().first].empty()
+             && isPrefixOrExtension(withoutStar(line), withoutStar(
+                  _sessions[_order.back().first].back())))
+    {
+      session = _order.back().first;
+    }
+    else
+    {
+      session = _sessions.size();
+      _sessions.push_back(vector<string>());
+      _sessionIds.push_back("");
+    }
+    _order.push_back(std::make_pair(session, _sessions[session].size()));
+    _sessions[session].push_back(line);
+  }
+}
+
+// _____________________________________________________________________________
+ReplayStatistics::ReplayStatistics()
+{
+  const vector<string>& names = getClassNames();
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    _histograms.push_back(new Histogram(names[i], ""));
+    for (size_t j = 0; j < NOF_OUTCOMES; j++)
+      _counters.push_back(new Counter(names[i], ""));
+  }
+}
+
+// _____________________________________________________________________________
+ReplayStatistics::~ReplayStatistics()
+{
+  for (size_t i = 0; i < _histograms.size(); i++) delete _histograms[i];
+  for (size_t i = 0; i < _counters.size(); i++) delete _counters[i];
+}
+
+// _____________________________________________________________________________
+const vector<string>& ReplayStatistics::getClassNames()
+{
+  static const vector<string> names = classNames();
+  return names;
+}
+
+// _____________________________________________________________________________
+void ReplayStatistics::classify(const string& query, vector<size_t>* classes)
+{
+  classes->clear();
+  classes->push_back(0);
+
+  // The words of the query, separated by spaces.
+  vector<string> words;
+  std::istringstream is(query);
+  string word;
+  while (is >> word) words.push_back(word);
+
+  size_t nofWords = words.size() < NOF_WORDS_CLASSES
+    ? words.size() : NOF_WORDS_CLASSES;
+  if (nofWords > 0) classes->push_back(WORDS_CLASS + nofWords - 1);
+
+  size_t prefixLength = 0;
+  if (!words.empty())
+  {
+    const string& last = words.back();
+    size_t end = last.size();
+    while (end > 0 && (last[end - 1] == '*' || last[end - 1] == '~')) end--;
+    // For an OR, the prefix is the last alternative.
+    size_t begin = last.find_last_of('|', end);
+    begin = begin == string::npos ? 0 : begin + 1;
+    while (begin < end && last[begin] == '*') begin++;
+    for (size_t i = begin; i < end; i++)
+      if ((last[i] & 0xc0) != 0x80) prefixLength++;
+  }
+  if (prefixLength >= NOF_PREFIX_CLASSES) prefixLength = NOF_PREFIX_CLASSES - 1;
+  classes->push_back(PREFIX_CLASS + prefixLength);
+
+  bool isOfType[NOF_TYPES] = { false };
+  isOfType[TYPE_OR] = query.find('|') != string::npos;
+  isOfType[TYPE_JOIN] = query.find('[') != string::npos;
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    const string& w = words[i];
+    if (w.find('~') != string::npos) isOfType[TYPE_FUZZY] = true;
+    if (w.size() >= 3 && w[0] == '*' && w[w.size() - 1] == '*')
+      isOfType[TYPE_INFIX] = true;
+  }
+  isOfType[TYPE_PLAIN] = !isOfType[TYPE_FUZZY] && !isOfType[TYPE_OR]
+    && !isOfType[TYPE_JOIN] && !isOfType[TYPE_INFIX];
+  for (size_t i = 0; i < NOF_TYPES; i++)
+    if (isOfType[i]) classes->push_back(TYPE_CLASS + i);
+}
+
+// _____________________________________________________________________________
+void ReplayStatistics::record(const string& query, uint64_t usecs,
+                              Outcome outcome)
+{
+  vector<size_t> classes;
+  classify(query, &classes);
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    if (outcome != FAILED) _histograms[classes[i]]->add(usecs);
+    _counters[classes[i] * NOF_OUTCOMES + outcome]->add(1);
+  }
+}
+
+// _____________________________________________________________________________
+uint64_t ReplayStatistics::getCount(size_t classIndex, Outcome outcome) const
+{
+  return _counters[classIndex * NOF_OUTCOMES + outcome]->value();
+}
+
+// _____________________________________________________________________________
+void ReplayStatistics::writeJson(ostream& os, const string& indent) const
+{
+  const vector<string>& names = getClassNames();
+  bool first = true;
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    const Histogram& histogram = *_histograms[i];
+    uint64_t nofFailed = getCount(i, FAILED);
+    if (histogram.count() + nofFailed == 0) continue;
+    if (!first) os << "," << endl;
+    first = false;
+    os << indent << "\"" << names[i] << "\": {"
+       << "\"count\": " << histogram.count()
+       << ", \"errors\": " << nofFailed
+       << ", \"from_history\": " << getCount(i, FROM_HISTORY)
+       << ", \"filtered\": " << getCount(i, FILTERED)
+       << ", \"mean_usecs\": "
+       << (histogram.count() > 0 ? histogram.sum() / histogram.count() : 0)
+       << ", \"p50_usecs\": " << histogram.quantile(0.5)
+       << ", \"p90_usecs\": " << histogram.quantile(0.9)
+       << ", \"p99_usecs\": " << histogram.quantile(0.99)
+       << ", \"p999_usecs\": " << histogram.quantile(0.999)
+       << ", \"max_usecs\": " << histogram.quantile(1.0) << "}";
+  }
+  if (!first) os << endl;
+}
+
+// _____________________________________________________________________________
+void ReplayStatistics::writeTable(ostream& os) const
+{
+  const vector<string>& names = getClassNames();
+  os << std::left << setw(12) << "class" << std::right
+     << setw(9) << "count" << setw(8) << "errors" << setw(8) << "cached"
+     << setw(10) << "mean" << setw(10) << "p50" << setw(10) << "p90"
+     << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "max"
+     << "  (usecs)" << endl;
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    const Histogram& histogram = *_histograms[i];
+    uint64_t nofFailed = getCount(i, FAILED);
+    if (histogram.count() + nofFailed == 0) continue;
+    // The percentage of results from the history, if known.
+    uint64_t nofCached = getCount(i, FROM_HISTORY) + getCount(i, FILTERED);
+    uint64_t nofKnown = nofCached + getCount(i, COMPUTED);
+    ostringstream cached;
+    if (nofKnown > 0) cached << 100 * nofCached / nofKnown << "%";
+    else cached << "-";
+    os << std::left << setw(12) << names[i] << std::right
+       << setw(9) << histogram.count() << setw(8) << nofFailed
+       << setw(8) << cached.str()
+       << setw(10) << (histogram.count() > 0
+                       ? histogram.sum() / histogram.count() : 0)
+       << setw(10) << histogram.quantile(0.5)
+       << setw(10) << histogram.quantile(0.9)
+       << setw(10) << histogram.quantile(0.99)
+       << setw(10) << histogram.quantile(0.999)
+       << setw(10) << histogram.quantile(1.0) << endl;
+  }
+}
+
+// _____________________________________________________________________________
+uint64_t monotonicNsecs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// _____________________________________________________________________________
+QueryReplayer::QueryReplayer(const QueryLog& log, size_t nofClients,
+                             double qps)
+  : _log(log), _nofClients(nofClients > 0 ? nofClients : 1), _qps(qps),
+    _answer(NULL), _statistics(NULL), _startNsecs(0), _next(0)
+{
+}
+
+// _____________________________________________________________________________
+double QueryReplayer::run(const AnswerFunction& answer,
+                          ReplayStatistics* statistics)
+{
+  _answer = &answer;
+  _statistics = statistics;
+  _next = 0;
+  _startNsecs = monotonicNsecs();
+  vector<pthread_t> threads(_nofClients);
+  vector<pair<QueryReplayer*, size_t> > args(_nofClients);
+  for (size_t i = 0; i < _nofClients; i++)
+  {
+    args[i] = std::make_pair(this, i);
+    if (pthread_create(&threads[i], NULL, &clientThread, &args[i]) != 0)
+      CS_THROW(Exception::COULD_NOT_CREATE_THREAD, "client " << i);
+  }
+  for (size_t i = 0; i < _nofClients; i++) pthread_join(threads[i], NULL);
+  return (monotonicNsecs() - _startNsecs) / 1e9;
+}
+
+// _____________________________________________________________________________
+void* QueryReplayer::clientThread(void* arg)
+{
+  pair<QueryReplayer*, size_t>* client
+    = static_cast<pair<QueryReplayer*, size_t>*>(arg);
+  client->first->runClient(client->second);
+  return NULL;
+}
+
+// _____________________________________________________________________________
+void QueryReplayer::runClient(size_t client)
+{
+  const vector<vector<string> >& sessions = _log.getSessions();
+  if (_qps <= 0)
+  {
+    // Closed loop: whole sessions, one query after the other.
+    while (true)
+    {
+      size_t session = _next++;
+      if (session >= sessions.size()) break;
+      for (size_t i = 0; i < sessions[session].size(); i++)
+        answerQuery(client, sessions[session][i], monotonicNsecs());
+    }
+    return;
+  }
+  // Open loop: the queries of the log in order, each when it is due.
+  const vector<pair<uint32_t, uint32_t> >& order = _log.getOrder();
+  while (true)
+  {
+    size_t i = _next++;
+    if (i >= order.size()) break;
+    uint64_t dueNsecs = _startNsecs + static_cast<uint64_t>(i * 1e9 / _qps);
+    struct timespec due;
+    due.tv_sec = dueNsecs / 1000000000;
+    due.tv_nsec = dueNsecs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR)
+    { }
+    answerQuery(client, sessions[order[i].first][order[i].second], dueNsecs);
+  }
+}
+
+// _____________________________________________________________________________
+void QueryReplayer::answerQuery(size_t client, const string& query,
+                                uint64_t startNsecs)
+{
+  ReplayStatistics::Outcome outcome;
+  try
+  {
+    outcome = (*_answer)(client, query);
+  }
+  catch(const Exception& e)
+  {
+    outcome = ReplayStatistics::FAILED;
+    ostringstream os;
+    os << "! query \"" << query << "\": " << e.getFullErrorMessage() << endl;
+    std::cerr << os.str() << std::flush;
+  }
+  catch(const std::exception& e)
+  {
+    outcome = ReplayStatistics::FAILED;
+    ostringstream os;
+    os << "! query \"" << query << "\": " << e.what() << endl;
+    std::cerr << os.str() << std::flush;
+  }
+  if (_statistics != NULL)
+    _statistics->record(query, (monotonicNsecs() - startNsecs) / 1000, outcome);
+}
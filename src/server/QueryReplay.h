@@ -0,0 +1,150 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_QUERYREPLAY_H_
+#define SERVER_QUERYREPLAY_H_
+
+#include <stdint.h>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "server/Metrics.h"
+
+using std::istream;
+using std::ostream;
+using std::pair;
+using std::string;
+using std::vector;
+
+// A query log for replaying (see replayQueries.cpp), grouped into sessions.
+//
+// Each line is either "<query>" or "<session id>\t<query>". Lines with a
+// session id belong to the session with that id, wherever they are in the
+// file. Without a session id, consecutive queries where one is a prefix of the
+// other (ignoring a trailing *) form a session, like the keystrokes of a user
+// typing (and correcting) a query. Empty lines are ignored, as is trailing
+// whitespace.
+class QueryLog
+{
+ public:
+  // Read the log from the given file. Throws an exception if the file cannot
+  // be opened.
+  void read(const string& fileName);
+
+  // Read the log from the given stream (appending to what was read before).
+  void parse(istream& is);
+
+  // The sessions, in the order of their first query in the log.
+  const vector<vector<string> >& getSessions() const { return _sessions; }
+
+  // All queries in the order of the log, as (session, index in session).
+  const vector<pair<uint32_t, uint32_t> >& getOrder() const { return _order; }
+
+  size_t getNofQueries() const { return _order.size(); }
+
+ private:
+  vector<vector<string> > _sessions;
+  vector<pair<uint32_t, uint32_t> > _order;
+  // The session ids of the sessions (empty for sessions without an id).
+  vector<string> _sessionIds;
+};
+
+// Latency histograms and cache hits of a replay, per class of queries: all
+// queries, by number of words (1, 2, 3, 4+), by length of the last word
+// without * and ~ at its ends (0 to 5, 6+, in UTF-8 characters; of the last
+// alternative for an OR), and by type (plain, fuzzy, or, join, infix; a query
+// can have more than one of the last four).
+class ReplayStatistics
+{
+ public:
+  // Where the result of a query came from. UNKNOWN is for queries sent over
+  // HTTP, where the history hits are only known in total (from /metrics).
+  enum Outcome { COMPUTED, FROM_HISTORY, FILTERED, UNKNOWN, FAILED };
+
+  ReplayStatistics();
+  ~ReplayStatistics();
+
+  // The classes of the given query, as indices into getClassNames().
+  static void classify(const string& query, vector<size_t>* classes);
+
+  // The names of all classes, e.g. "all", "words=2", "prefix=6+", "fuzzy".
+  static const vector<string>& getClassNames();
+
+  // Record a query with the given latency (called concurrently). The latency
+  // of failed queries is not recorded, only that they failed.
+  void record(const string& query, uint64_t usecs, Outcome outcome);
+
+  // The latencies of the given class.
+  const Histogram& getHistogram(size_t classIndex) const
+  { return *_histograms[classIndex]; }
+
+  // The number of queries of the given class with the given outcome.
+  uint64_t getCount(size_t classIndex, Outcome outcome) const;
+
+  // Write the statistics of all classes which have queries, as the members of
+  // a JSON object, one class per line, with the given indentation.
+  void writeJson(ostream& os, const string& indent) const;
+
+  // Write a table with one line per class which has queries.
+  void writeTable(ostream& os) const;
+
+ private:
+  vector<Histogram*> _histograms;
+  // One counter per class and outcome.
+  vector<Counter*> _counters;
+};
+
+// Replays a query log, with a given number of clients, either closed-loop
+// (each client sends the queries of a session one after the other, and the
+// next session when that is done) or open-loop at a target rate of queries per
+// second (query i of the log is due at i / qps seconds after the start, and
+// the next free client sends it when it is due).
+//
+// In the open-loop mode, the latency is measured from the time when the query
+// was due, not from when it was sent. So queries which had to wait for a free
+// client count as slow, instead of making the measured load smaller than the
+// target ("coordinated omission"). The queries of a session are sent in order,
+// but the next keystroke may be sent before the previous one is answered, like
+// with a user who types fast.
+class QueryReplayer
+{
+ public:
+  // Answer the given query for the given client (0 to nofClients - 1) and say
+  // where the result came from. May throw an exception, which counts as a
+  // failed query (and is written to stderr).
+  typedef std::function<ReplayStatistics::Outcome(size_t, const string&)>
+    AnswerFunction;
+
+  // Closed-loop if qps is 0.
+  QueryReplayer(const QueryLog& log, size_t nofClients, double qps);
+
+  // Replay the whole log once and record the queries in the given statistics
+  // (if not NULL). Returns the time taken in seconds.
+  double run(const AnswerFunction& answer, ReplayStatistics* statistics);
+
+ private:
+  // The loop of one client thread.
+  static void* clientThread(void* arg);
+  void runClient(size_t client);
+
+  // Answer one query and record it.
+  void answerQuery(size_t client, const string& query, uint64_t startNsecs);
+
+  const QueryLog& _log;
+  size_t _nofClients;
+  double _qps;
+
+  // The state of the current run.
+  const AnswerFunction* _answer;
+  ReplayStatistics* _statistics;
+  uint64_t _startNsecs;
+  atomic<size_t> _next;
+};
+
+// Nanoseconds on the monotonic clock.
+uint64_t monotonicNsecs();
+
+#endif  // SERVER_QUERYREPLAY_H_
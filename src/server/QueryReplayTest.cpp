@@ -0,0 +1,101 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include "server/QueryReplay.h"
+
+// The sessions of the given log, as a string like "a al alg|b".
+string sessionsAsString(const QueryLog& log)
+{
+  string s;
+  for (size_t i = 0; i < log.getSessions().size(); i++)
+  {
+    s += (i > 0 ? "|" : "");
+    for (size_t j = 0; j < log.getSessions()[i].size(); j++)
+      s += (j > 0 ? " " : "") + log.getSessions()[i][j];
+  }
+  return s;
+}
+
+// Sessions from keystrokes and from session ids.
+TEST(QueryReplayTest, parseLog)
+{
+  QueryLog log;
+  std::istringstream keystrokes("a\nal*\nalg \n\nal\nb\nbe*\nc\n");
+  log.parse(keystrokes);
+  ASSERT_EQ("a al* alg al|b be*|c", sessionsAsString(log));
+  ASSERT_EQ(7u, log.getNofQueries());
+
+  QueryLog logWithIds;
+  std::istringstream withIds("u1\tx\nu2\tx\nu1\txy\ny\nyz\n");
+  logWithIds.parse(withIds);
+  ASSERT_EQ("x xy|x|y yz", sessionsAsString(logWithIds));
+  ASSERT_EQ(5u, logWithIds.getOrder().size());
+  ASSERT_EQ(1u, logWithIds.getOrder()[1].first);
+  ASSERT_EQ(0u, logWithIds.getOrder()[2].first);
+  ASSERT_EQ(1u, logWithIds.getOrder()[2].second);
+}
+
+// The names of the classes of the given query, separated by spaces.
+string classesAsString(const string& query)
+{
+  vector<size_t> classes;
+  ReplayStatistics::classify(query, &classes);
+  string s;
+  for (size_t i = 0; i < classes.size(); i++)
+    s += (i > 0 ? " " : "") + ReplayStatistics::getClassNames()[classes[i]];
+  return s;
+}
+
+// Classes by number of words, prefix length and type.
+TEST(QueryReplayTest, classify)
+{
+  ASSERT_EQ("all words=1 prefix=3 plain", classesAsString("alg*"));
+  ASSERT_EQ("all words=2 prefix=6+ fuzzy",
+            classesAsString("algo algorithm~"));
+  ASSERT_EQ("all words=1 prefix=2 or", classesAsString("ab|cd"));
+  ASSERT_EQ("all words=4+ prefix=0 plain", classesAsString("a b c d *"));
+  ASSERT_EQ("all words=1 prefix=3 infix", classesAsString("*gor*"));
+  ASSERT_EQ("all words=1 prefix=2 plain", classesAsString("\xc3\xa4\xc3\xb6"));
+  ASSERT_EQ("all words=3 prefix=4 join", classesAsString("a [b#c#d] ab:c"));
+}
+
+// Closed-loop and open-loop runs answer every query once.
+TEST(QueryReplayTest, run)
+{
+  QueryLog log;
+  std::istringstream is("a\nab\nabc\nb\nba\nc\nd\ne\n");
+  log.parse(is);
+  for (int openLoop = 0; openLoop <= 1; openLoop++)
+  {
+    QueryReplayer replayer(log, 3, openLoop ? 2000 : 0);
+    ReplayStatistics statistics;
+    QueryReplayer::AnswerFunction answer =
+      [](size_t client, const string& query)
+    {
+      if (query == "e") throw std::exception();
+      return query.size() > 1 ? ReplayStatistics::FROM_HISTORY
+                              : ReplayStatistics::COMPUTED;
+    };
+    double secs = replayer.run(answer, &statistics);
+    ASSERT_EQ(7u, statistics.getHistogram(0).count());
+    ASSERT_EQ(1u, statistics.getCount(0, ReplayStatistics::FAILED));
+    ASSERT_EQ(3u, statistics.getCount(0, ReplayStatistics::FROM_HISTORY));
+    if (openLoop)
+    {
+      ASSERT_GE(secs, 7 / 2000.0);
+    }
+    std::ostringstream json;
+    statistics.writeJson(json, "");
+    ASSERT_NE(string::npos, json.str().find(
+        "\"words=1\": {\"count\": 7, \"errors\": 1, \"from_history\": 3"));
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
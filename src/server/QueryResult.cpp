@@ -13,6 +13,9 @@ string QueryResult::FROM_HISTORY_FILTERED_2 = "filtered from history (type 2)";
 string QueryResult::FROM_HISTORY_FILTERED_3 = "filtered from history (type 3)";
 string QueryResult::FROM_HISTORY_INTERSECT =
     "intersected results from history";
+string QueryResult::COUNTS_ONLY =
+    "counts only: counted postings of block(s) read from disk";
+string QueryResult::COUNTS_FROM_HISTORY = "counts fetched from history";
 string QueryResult::ALL_POSTINGS = "[dummy result containing all postings]";
 string QueryResult::OTHER = "[how result was computed: other]";
 
@@ -28,7 +31,6 @@ QueryResult::QueryResult()
   nofTotalHits = 0;
   nofTotalCompletions = 0;
   isLockedForWriting = false;
-  isLockedForReading = false;
   _bufferPosition = 0;
 }
 ;
@@ -42,7 +44,6 @@ QueryResult::QueryResult(bool fullList)
   nofTotalHits = 0;
   nofTotalCompletions = 0;
   isLockedForWriting = false;
-  isLockedForReading = false;
   _bufferPosition = 0;
   if (fullList)
   {
@@ -58,7 +59,6 @@ QueryResult::QueryResult(bool fullList)
 QueryResult::QueryResult(const QueryResult& orig)
 {
   isLockedForWriting = false;
-  isLockedForReading = false;
   _status = orig._status;
   wasInHistory = orig.wasInHistory;
   resultWasFilteredFrom = orig.resultWasFilteredFrom;
@@ -123,6 +123,14 @@ size_t QueryResult::sizeInBytes() const
       + _topCompletions.sizeInBytes();
 }
 
+// _____________________________________________________________________________
+size_t CompletionCounts::sizeInBytes() const
+{
+  return sizeof(CompletionCounts) + wordIds.sizeInBytes()
+      + scores.sizeInBytes() + docCounts.sizeInBytes()
+      + occCounts.sizeInBytes() + lastDocIds.sizeInBytes();
+}
+
 //! Free all extra (reserved) space, once result is finished
 void QueryResult::freeExtraSpace()
 {
@@ -151,7 +159,7 @@ void QueryResult::checkSameNumberOfDocsWordsPositionsScores(unsigned char MODE)
 {
   CS_ASSERT(_wordIdsOriginal.size() == _docIds.size());
   if (MODE & WITH_POS)
-    CS_ASSERT(_positions.size() == _wordIdsOriginal.size())
+    CS_ASSERT(_positions.size() == _wordIdsOriginal.size() || _positions.size() == 0)
   else
   CS_ASSERT(_positions.size() == 0);
   if (MODE & WITH_SCORES)
@@ -79,6 +79,8 @@ class QueryResult
   static string FROM_HISTORY_FILTERED_2;
   static string FROM_HISTORY_FILTERED_3;
   static string FROM_HISTORY_INTERSECT;
+  static string COUNTS_ONLY;
+  static string COUNTS_FROM_HISTORY;
   static string ALL_POSTINGS;
   static string OTHER;
 
@@ -109,7 +111,8 @@ class QueryResult
   WordList _wordIdsOriginal;
   //! Mapped word ids of the matching postings;
   WordList _wordIdsMapped;
-  //! Positions of the matching postings;
+  //! Positions of the matching postings; empty if the positions were not
+  //! needed for the query (see hasPositions and CompleterBase::_positionsNeeded).
   Vector<Position> _positions;
   //! Scores (aggregated) of the matching postings;
   //  Note: these are NOT the raw scores of the last position
@@ -179,26 +182,21 @@ class QueryResult
    */
   unsigned long _bufferPosition; 
 
-  //! TODO: what exactly is this used for?
+  // Set while the result is being computed, to catch two writers. There is no
+  // flag for readers: a result is only read after it is FINISHED, and readers
+  // hold a reference (see History), so it is not freed under them.
   mutable bool isLockedForWriting;
-  
-  //! TODO: what exactly is this used for?
-  mutable bool isLockedForReading;
  
-  // Mark result as locked for reading "r"
-  // or writing "w".
+  // Mark result as locked for writing "w".
   void lock(const char* mode)
   {
     if (strcmp(mode, "w") == 0) isLockedForWriting = true;
-    else if (strcmp(mode, "r") == 0) isLockedForReading = true;
   }
   
-  // Mark result as unlocked for reading "r"
-  // or writing "w".
+  // Mark result as unlocked for writing "w".
   void unlock(const char* mode)
   {
     if (strcmp(mode, "w") == 0) isLockedForWriting = false;
-    else if (strcmp(mode, "r") == 0) isLockedForReading = false;
   }
 
  public:
@@ -352,7 +350,6 @@ class QueryResult
   void unlock() const
   {
     isLockedForWriting = false;
-    isLockedForReading = false;
   }
 
 
@@ -380,6 +377,11 @@ class QueryResult
   //! True iff result is empty (zero matching postings)
   bool isEmpty() const;
 
+  //! True iff there is a position for each posting. The positions are either
+  //! all there or all omitted (when not needed for the query, the index lists
+  //! are read without them).
+  bool hasPositions() const { return _positions.size() == _docIds.size(); }
+
 
   //
   //  5. SORTING
@@ -448,6 +450,35 @@ class QueryResult
 //! Special query result returned for empty query
 extern QueryResult emptyQueryResult;
 
+//! The counts of a result, without its postings.
+/*!
+ *   For a count-only query (see CompleterBase::processCountOnlyQuery): the
+ *   number of hits, and for each completion (by increasing word id) its score,
+ *   doc count and occurrence count, aggregated like in
+ *   CompleterBase::computeTopCompletions, and the largest id of a doc it
+ *   occurs in (for RANK_WORDS_BY_DOC_ID). The top-k completions for any
+ *   ranking can be selected from these, and they are much smaller than the
+ *   postings, so that the history can keep the counts of many queries.
+ */
+class CompletionCounts
+{
+ public:
+  CompletionCounts() : nofTotalHits(0) { }
+
+  //! The number of distinct docs with a matching posting.
+  DocId nofTotalHits;
+
+  //! The completions and their scores and counts, by increasing word id.
+  WordList wordIds;
+  ScoreList scores;
+  Vector<unsigned int> docCounts;
+  Vector<unsigned int> occCounts;
+  DocList lastDocIds;
+
+  //! Number of bytes consumed by the counts.
+  size_t sizeInBytes() const;
+};
+
 // needed for mergeResultLists(const Vector<QueryResult>& inputLists,
 // QueryResult* result)
 class Triple
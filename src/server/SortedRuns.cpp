@@ -0,0 +1,397 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include "server/SortedRuns.h"
+#include "server/Exception.h"
+#include "server/MappedFile.h"
+#include <pthread.h>
+#include <string.h>
+#include <algorithm>
+
+namespace
+{
+const char SORTED_RUNS_MAGIC[8] = { 'C', 'S', 'W', 'D', 'R', 'U', 'N', 'S' };
+const uint32_t SORTED_RUNS_VERSION = 1;
+
+// Size of the read buffer of each run.
+const size_t RUN_BUFFER_SIZE = 256 * 1024;
+
+// The 16-bit digit with the given number of a posting, digit 0 being the least
+// significant one of the key (word id, doc id, position).
+inline uint32_t digit(const SortedRuns::Posting& posting, int i)
+{
+  uint32_t x = i < 2 ? posting.position
+             : i < 4 ? posting.docId
+             : posting.wordId;
+  return i % 2 == 0 ? x & 0xffff : x >> 16;
+}
+
+// A slice of the postings to be sorted by a thread, or two adjacent sorted
+// ranges [postings, postings + middle) and [postings + middle, postings +
+// nofPostings) to be merged into the buffer.
+struct SortTask
+{
+  SortedRuns::Posting* postings;
+  size_t middle;
+  size_t nofPostings;
+  SortedRuns::Posting* buffer;
+};
+
+void* sortThread(void* arg)
+{
+  SortTask* task = static_cast<SortTask*>(arg);
+  SortedRuns::sort(task->postings, task->nofPostings, task->buffer);
+  return NULL;
+}
+
+void* mergeThread(void* arg)
+{
+  SortTask* task = static_cast<SortTask*>(arg);
+  SortedRuns::Posting* middle = task->postings + task->middle;
+  std::merge(task->postings, middle, middle,
+             task->postings + task->nofPostings, task->buffer,
+             &SortedRuns::less);
+  return NULL;
+}
+
+// Run the given function for each of the given tasks, each in its own thread
+// (or directly, if there is only one task).
+void runTasks(void* (*function)(void*), vector<SortTask>* tasks)
+{
+  if (tasks->size() == 1)
+  {
+    function(&(*tasks)[0]);
+    return;
+  }
+  vector<pthread_t> threads(tasks->size());
+  for (size_t i = 0; i < tasks->size(); i++)
+    pthread_create(&threads[i], NULL, function, &(*tasks)[i]);
+  for (size_t i = 0; i < tasks->size(); i++) pthread_join(threads[i], NULL);
+}
+}
+
+// _____________________________________________________________________________
+void SortedRuns::sort(Posting* postings, size_t nofPostings, Posting* buffer)
+{
+  const int NOF_DIGITS = 6;
+  const size_t NOF_BUCKETS = 1 << 16;
+  // Count the occurrences of each digit in one pass.
+  vector<size_t> counts(NOF_DIGITS * NOF_BUCKETS, 0);
+  for (size_t i = 0; i < nofPostings; i++)
+    for (int d = 0; d < NOF_DIGITS; d++)
+      counts[d * NOF_BUCKETS + digit(postings[i], d)]++;
+  // One counting sort per digit, from the least significant one, going back
+  // and forth between postings and buffer.
+  Posting* from = postings;
+  Posting* to = buffer;
+  for (int d = 0; d < NOF_DIGITS; d++)
+  {
+    size_t* count = &counts[d * NOF_BUCKETS];
+    if (nofPostings == 0 || count[digit(from[0], d)] == nofPostings) continue;
+    size_t offset = 0;
+    for (size_t b = 0; b < NOF_BUCKETS; b++)
+    {
+      size_t c = count[b];
+      count[b] = offset;
+      offset += c;
+    }
+    for (size_t i = 0; i < nofPostings; i++)
+      to[count[digit(from[i], d)]++] = from[i];
+    std::swap(from, to);
+  }
+  if (from != postings) memcpy(postings, from, nofPostings * sizeof(Posting));
+}
+
+// _____________________________________________________________________________
+void SortedRuns::sortSlices(Posting* postings, size_t nofPostings,
+                            Posting* buffer, size_t nofSlices)
+{
+  if (nofSlices == 0) return;
+  vector<SortTask> tasks(nofSlices);
+  for (size_t i = 0; i < nofSlices; i++)
+  {
+    size_t begin = i * nofPostings / nofSlices;
+    size_t end = (i + 1) * nofPostings / nofSlices;
+    tasks[i].postings = postings + begin;
+    tasks[i].middle = 0;
+    tasks[i].nofPostings = end - begin;
+    tasks[i].buffer = buffer + begin;
+  }
+  runTasks(&sortThread, &tasks);
+}
+
+// _____________________________________________________________________________
+void SortedRuns::sortInParallel(Posting* postings, size_t nofPostings,
+                                Posting* buffer, size_t nofThreads)
+{
+  size_t nofSlices = std::max(std::min(nofThreads, nofPostings),
+                              static_cast<size_t>(1));
+  sortSlices(postings, nofPostings, buffer, nofSlices);
+  // The boundaries of the sorted ranges.
+  vector<size_t> bounds;
+  for (size_t i = 0; i <= nofSlices; i++)
+    bounds.push_back(i * nofPostings / nofSlices);
+  Posting* from = postings;
+  Posting* to = buffer;
+  while (bounds.size() > 2)
+  {
+    // Merge pairs of ranges; a last range without partner is merged with an
+    // empty range, that is, copied.
+    vector<SortTask> tasks;
+    vector<size_t> newBounds;
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2)
+    {
+      size_t end = bounds[std::min(i + 2, bounds.size() - 1)];
+      SortTask task = { from + bounds[i], bounds[i + 1] - bounds[i],
+                        end - bounds[i], to + bounds[i] };
+      tasks.push_back(task);
+      newBounds.push_back(bounds[i]);
+    }
+    newBounds.push_back(nofPostings);
+    runTasks(&mergeThread, &tasks);
+    bounds.swap(newBounds);
+    std::swap(from, to);
+  }
+  if (from != postings) memcpy(postings, from, nofPostings * sizeof(Posting));
+}
+
+// _____________________________________________________________________________
+SortedRunsWriter::SortedRunsWriter(const string& fileName,
+                                   size_t memoryInBytes, size_t nofThreads)
+  : _fileName(fileName), _nofThreads(nofThreads > 0 ? nofThreads : 1),
+    _offset(0), _nofPostings(0)
+{
+  // Half of the memory for the postings, half for the buffer of the sort.
+  _maxNofPostings = std::max(memoryInBytes / (2 * sizeof(SortedRuns::Posting)),
+                             static_cast<size_t>(1));
+  _file = fopen(fileName.c_str(), "w");
+  if (_file == NULL)
+    CS_THROW(Exception::OTHER, "could not open \"" << fileName
+             << "\" for writing");
+  uint32_t zero = 0;
+  writeOrThrow(_file, SORTED_RUNS_MAGIC, sizeof(SORTED_RUNS_MAGIC), _fileName);
+  writeOrThrow(_file, &SORTED_RUNS_VERSION, sizeof(uint32_t), _fileName);
+  writeOrThrow(_file, &zero, sizeof(uint32_t), _fileName);
+  _offset = sizeof(SORTED_RUNS_MAGIC) + 2 * sizeof(uint32_t);
+}
+
+// _____________________________________________________________________________
+SortedRunsWriter::~SortedRunsWriter()
+{
+  if (_file != NULL) fclose(_file);
+}
+
+// _____________________________________________________________________________
+void SortedRunsWriter::writeRuns()
+{
+  size_t nofPostings = _postings.size();
+  if (nofPostings == 0) return;
+  _buffer.resize(nofPostings);
+  // Sort one slice per thread, and write each as a run.
+  size_t nofSlices = std::min(_nofThreads, nofPostings);
+  SortedRuns::sortSlices(&_postings[0], nofPostings, &_buffer[0], nofSlices);
+  for (size_t i = 0; i < nofSlices; i++)
+  {
+    size_t begin = i * nofPostings / nofSlices;
+    size_t end = (i + 1) * nofPostings / nofSlices;
+    writeRun(&_postings[begin], end - begin);
+  }
+  _postings.clear();
+}
+
+// _____________________________________________________________________________
+void SortedRunsWriter::writeNumber(uint32_t x)
+{
+  unsigned char bytes[5];
+  size_t n = 0;
+  while (x >= 128)
+  {
+    bytes[n++] = (x & 127) | 128;
+    x >>= 7;
+  }
+  bytes[n++] = x;
+  writeOrThrow(_file, bytes, n, _fileName);
+  _offset += n;
+}
+
+// _____________________________________________________________________________
+void SortedRunsWriter::writeRun(const SortedRuns::Posting* postings,
+                                size_t nofPostings)
+{
+  if (nofPostings == 0) return;
+  _runs.push_back(_offset);
+  _runs.push_back(nofPostings);
+  SortedRuns::Posting previous = { 0, 0, 0, 0 };
+  for (size_t i = 0; i < nofPostings; i++)
+  {
+    const SortedRuns::Posting& posting = postings[i];
+    bool sameWord = posting.wordId == previous.wordId;
+    bool sameDoc = sameWord && posting.docId == previous.docId;
+    writeNumber(posting.wordId - previous.wordId);
+    writeNumber(sameWord ? posting.docId - previous.docId : posting.docId);
+    writeNumber(sameDoc ? posting.position - previous.position
+                        : posting.position);
+    writeNumber(posting.score);
+    previous = posting;
+  }
+  _nofPostings += nofPostings;
+}
+
+// _____________________________________________________________________________
+void SortedRunsWriter::finish()
+{
+  writeRuns();
+  uint64_t tableOffset = _offset;
+  uint64_t nofRuns = _runs.size() / 2;
+  if (_runs.size() > 0)
+    writeOrThrow(_file, &_runs[0], _runs.size() * sizeof(uint64_t), _fileName);
+  writeOrThrow(_file, &tableOffset, sizeof(uint64_t), _fileName);
+  writeOrThrow(_file, &nofRuns, sizeof(uint64_t), _fileName);
+  if (fclose(_file) != 0)
+    CS_THROW(Exception::OTHER, "could not write to \"" << _fileName << "\"");
+  _file = NULL;
+  vector<SortedRuns::Posting>().swap(_postings);
+  vector<SortedRuns::Posting>().swap(_buffer);
+}
+
+// _____________________________________________________________________________
+SortedRunsReader::SortedRunsReader(const string& fileName)
+  : _fileName(fileName), _nofPostings(0)
+{
+  // Read the header and the run table.
+  FILE* file = fopen(fileName.c_str(), "r");
+  if (file == NULL)
+    CS_THROW(Exception::OTHER, "could not open runs file \"" << fileName
+             << "\"");
+  char magic[sizeof(SORTED_RUNS_MAGIC)];
+  uint32_t version = 0;
+  uint64_t tableOffset = 0;
+  uint64_t nofRuns = 0;
+  bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+            && memcmp(magic, SORTED_RUNS_MAGIC, sizeof(magic)) == 0
+            && fread(&version, sizeof(uint32_t), 1, file) == 1
+            && fseeko(file, -2 * sizeof(uint64_t), SEEK_END) == 0
+            && fread(&tableOffset, sizeof(uint64_t), 1, file) == 1
+            && fread(&nofRuns, sizeof(uint64_t), 1, file) == 1;
+  if (!ok)
+  {
+    fclose(file);
+    CS_THROW(Exception::OTHER, "\"" << fileName << "\" is not a runs file");
+  }
+  if (version != SORTED_RUNS_VERSION)
+  {
+    fclose(file);
+    CS_THROW(Exception::OTHER, "runs file \"" << fileName << "\" has version "
+             << version << ", expected " << SORTED_RUNS_VERSION);
+  }
+  vector<uint64_t> table(2 * nofRuns);
+  ok = fseeko(file, tableOffset, SEEK_SET) == 0
+       && (nofRuns == 0
+           || fread(&table[0], sizeof(uint64_t), table.size(), file)
+              == table.size());
+  fclose(file);
+  if (!ok)
+    CS_THROW(Exception::OTHER, "runs file \"" << fileName
+             << "\" is truncated or corrupt");
+
+  // Open each run, and read its first posting.
+  _runs.resize(nofRuns);
+  for (size_t i = 0; i < nofRuns; i++)
+  {
+    Run& run = _runs[i];
+    run.file = fopen(fileName.c_str(), "r");
+    if (run.file == NULL)
+      CS_THROW(Exception::OTHER, "could not open runs file \"" << fileName
+               << "\"");
+    _buffers.push_back(new char[RUN_BUFFER_SIZE]);
+    setvbuf(run.file, _buffers.back(), _IOFBF, RUN_BUFFER_SIZE);
+    fseeko(run.file, table[2 * i], SEEK_SET);
+    run.nofPostingsLeft = table[2 * i + 1];
+    run.posting.wordId = 0;
+    run.posting.docId = 0;
+    run.posting.position = 0;
+    _nofPostings += run.nofPostingsLeft;
+    if (advance(&run)) _heap.push_back(i);
+  }
+  for (size_t i = _heap.size() / 2; i > 0; i--) siftDown(i - 1);
+}
+
+// _____________________________________________________________________________
+SortedRunsReader::~SortedRunsReader()
+{
+  for (size_t i = 0; i < _runs.size(); i++)
+    if (_runs[i].file != NULL) fclose(_runs[i].file);
+  for (size_t i = 0; i < _buffers.size(); i++) delete[] _buffers[i];
+}
+
+// _____________________________________________________________________________
+bool SortedRunsReader::advance(Run* run)
+{
+  if (run->nofPostingsLeft == 0) return false;
+  run->nofPostingsLeft--;
+  uint32_t numbers[4];
+  for (int n = 0; n < 4; n++)
+  {
+    uint32_t x = 0;
+    int shift = 0;
+    int c;
+    do
+    {
+      c = getc_unlocked(run->file);
+      if (c == EOF)
+        CS_THROW(Exception::OTHER, "runs file \"" << _fileName
+                 << "\" is truncated or corrupt");
+      x |= static_cast<uint32_t>(c & 127) << shift;
+      shift += 7;
+    }
+    while (c & 128);
+    numbers[n] = x;
+  }
+  SortedRuns::Posting& posting = run->posting;
+  bool sameWord = numbers[0] == 0;
+  bool sameDoc = sameWord && numbers[1] == 0;
+  posting.wordId += numbers[0];
+  posting.docId = sameWord ? posting.docId + numbers[1] : numbers[1];
+  posting.position = sameDoc ? posting.position + numbers[2] : numbers[2];
+  posting.score = numbers[3];
+  return true;
+}
+
+// _____________________________________________________________________________
+bool SortedRunsReader::after(size_t i, size_t j) const
+{
+  const SortedRuns::Posting& x = _runs[i].posting;
+  const SortedRuns::Posting& y = _runs[j].posting;
+  if (SortedRuns::less(y, x)) return true;
+  if (SortedRuns::less(x, y)) return false;
+  return i > j;
+}
+
+// _____________________________________________________________________________
+void SortedRunsReader::siftDown(size_t pos)
+{
+  size_t size = _heap.size();
+  while (2 * pos + 1 < size)
+  {
+    size_t child = 2 * pos + 1;
+    if (child + 1 < size && after(_heap[child], _heap[child + 1])) child++;
+    if (!after(_heap[pos], _heap[child])) break;
+    std::swap(_heap[pos], _heap[child]);
+    pos = child;
+  }
+}
+
+// _____________________________________________________________________________
+bool SortedRunsReader::next(SortedRuns::Posting* posting)
+{
+  if (_heap.empty()) return false;
+  Run& run = _runs[_heap[0]];
+  *posting = run.posting;
+  if (!advance(&run))
+  {
+    _heap[0] = _heap.back();
+    _heap.pop_back();
+  }
+  siftDown(0);
+  return true;
+}
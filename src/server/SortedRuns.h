@@ -0,0 +1,169 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#ifndef SERVER_SORTEDRUNS_H_
+#define SERVER_SORTEDRUNS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Sorted runs of postings, as an alternative to a words file that has to be
+// sorted with an external sort before the index can be built.
+//
+// The parser (option --write-sorted-runs) collects the postings (word id, doc
+// id, score, position) in memory. Whenever the memory budget is used up, it
+// sorts them by word id, doc id, and position (with a radix sort, one slice
+// per thread) and appends the sorted slices as compressed runs to the file
+// <basename>.words-runs. buildIndex (option -f RUNS) then reads a k-way merge
+// of all runs, which gives the postings in the same order as a sorted binary
+// words file.
+//
+// File format (all numbers in host byte order):
+//   "CSWDRUNS" <uint32 version> <uint32 0>
+//   the runs, one after the other
+//   per run: <uint64 offset> <uint64 nofPostings>
+//   <uint64 offset of the run table> <uint64 nofRuns>
+// Within a run, each posting is stored as four variable-byte numbers: the
+// difference of the word id to that of the previous posting, the doc id (as
+// a difference if the word id is the same), the position (as a difference if
+// word id and doc id are the same), and the score.
+class SortedRuns
+{
+ public:
+  // One posting, with the same layout as a record of a binary words file.
+  struct Posting
+  {
+    uint32_t wordId;
+    uint32_t docId;
+    uint32_t score;
+    uint32_t position;
+  };
+
+  // Whether the first posting comes before the second in a run.
+  static bool less(const Posting& x, const Posting& y)
+  {
+    if (x.wordId != y.wordId) return x.wordId < y.wordId;
+    if (x.docId != y.docId) return x.docId < y.docId;
+    return x.position < y.position;
+  }
+
+  // Sort the given postings by word id, doc id, and position (stable, with an
+  // LSD radix sort over 16-bit digits). The buffer must have room for as many
+  // postings; digits that are the same for all postings are skipped.
+  static void sort(Posting* postings, size_t nofPostings, Posting* buffer);
+
+  // Sort the given number of slices of the given postings, each with sort and
+  // in its own thread (without starting a thread if there is only one). Slice
+  // i consists of the postings from i * nofPostings / nofSlices to (i + 1) *
+  // nofPostings / nofSlices.
+  static void sortSlices(Posting* postings, size_t nofPostings,
+                         Posting* buffer, size_t nofSlices);
+
+  // Sort the given postings like sort, but with the given number of threads:
+  // first sort one slice per thread, then merge pairs of sorted ranges (each
+  // pair in its own thread) until there is only one. The result is the same
+  // as that of sort.
+  static void sortInParallel(Posting* postings, size_t nofPostings,
+                             Posting* buffer, size_t nofThreads);
+};
+
+// Writes the runs file, see SortedRuns.
+class SortedRunsWriter
+{
+ public:
+  // Open the given file for writing. A run is written whenever the postings
+  // added since the last one take up the given number of bytes; it is sorted
+  // with the given number of threads (giving one run per thread).
+  SortedRunsWriter(const string& fileName, size_t memoryInBytes,
+                   size_t nofThreads);
+  ~SortedRunsWriter();
+
+  // Add a posting.
+  void add(uint32_t wordId, uint32_t docId, uint32_t score, uint32_t position)
+  {
+    SortedRuns::Posting posting = { wordId, docId, score, position };
+    _postings.push_back(posting);
+    if (_postings.size() >= _maxNofPostings) writeRuns();
+  }
+
+  // Write the remaining postings and the run table, and close the file.
+  void finish();
+
+  // The number of runs and postings written so far.
+  size_t getNofRuns() const { return _runs.size() / 2; }
+  uint64_t getNofPostings() const { return _nofPostings; }
+
+ private:
+  // Sort the postings added since the last call and write them as runs.
+  void writeRuns();
+
+  // Write the given sorted postings as one run.
+  void writeRun(const SortedRuns::Posting* postings, size_t nofPostings);
+
+  // Write the given number with a variable number of bytes.
+  void writeNumber(uint32_t x);
+
+  string _fileName;
+  FILE* _file;
+  size_t _maxNofPostings;
+  size_t _nofThreads;
+  vector<SortedRuns::Posting> _postings;
+  vector<SortedRuns::Posting> _buffer;
+  // Offset and number of postings of each run written so far, one after the
+  // other (as in the run table).
+  vector<uint64_t> _runs;
+  uint64_t _offset;
+  uint64_t _nofPostings;
+};
+
+// Reads the postings of all runs of a runs file in sorted order, see
+// SortedRuns.
+class SortedRunsReader
+{
+ public:
+  // Open the given file. Throws an exception if it does not exist or is not a
+  // runs file.
+  explicit SortedRunsReader(const string& fileName);
+  ~SortedRunsReader();
+
+  // Get the next posting. Returns false when all postings have been read.
+  bool next(SortedRuns::Posting* posting);
+
+  // The number of runs and postings in the file.
+  size_t getNofRuns() const { return _runs.size(); }
+  uint64_t getNofPostings() const { return _nofPostings; }
+
+ private:
+  // The current posting of a run.
+  struct Run
+  {
+    FILE* file;
+    uint64_t nofPostingsLeft;
+    SortedRuns::Posting posting;
+  };
+
+  // Read the next posting of the given run. Returns false if there is none.
+  bool advance(Run* run);
+
+  // Whether the run with the first index has to come after the one with the
+  // second in the heap (ties are broken by the index of the run, so that the
+  // order is the same as that of a stable sort of all postings).
+  bool after(size_t i, size_t j) const;
+
+  // Restore the heap property of _heap starting at the given position.
+  void siftDown(size_t pos);
+
+  string _fileName;
+  vector<Run> _runs;
+  // Indices of the runs that have postings left, as a binary min-heap.
+  vector<size_t> _heap;
+  uint64_t _nofPostings;
+  vector<char*> _buffers;
+};
+
+#endif  // SERVER_SORTEDRUNS_H_
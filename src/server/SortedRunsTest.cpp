@@ -0,0 +1,131 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "server/SortedRuns.h"
+#include "server/Exception.h"
+
+// Random postings with many equal keys (only the score tells them apart).
+vector<SortedRuns::Posting> randomPostings(size_t n, unsigned int seed)
+{
+  srand(seed);
+  vector<SortedRuns::Posting> postings(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    postings[i].wordId = rand() % 100 + (i % 7 == 0 ? 100000 : 0);
+    postings[i].docId = rand() % 50 + (i % 5 == 0 ? 1 << 20 : 0);
+    postings[i].score = i;
+    postings[i].position = rand() % 10;
+  }
+  return postings;
+}
+
+// Whether the two postings are the same.
+bool equal(const SortedRuns::Posting& x, const SortedRuns::Posting& y)
+{
+  return x.wordId == y.wordId && x.docId == y.docId && x.score == y.score
+         && x.position == y.position;
+}
+
+// The radix sort must give the same result as a stable comparison sort.
+TEST(SortedRunsTest, sort)
+{
+  vector<SortedRuns::Posting> postings = randomPostings(10000, 1);
+  vector<SortedRuns::Posting> expected = postings;
+  std::stable_sort(expected.begin(), expected.end(), &SortedRuns::less);
+  vector<SortedRuns::Posting> buffer(postings.size());
+  SortedRuns::sort(&postings[0], postings.size(), &buffer[0]);
+  for (size_t i = 0; i < postings.size(); i++)
+    ASSERT_TRUE(equal(expected[i], postings[i])) << i;
+  // Also with all digits the same.
+  vector<SortedRuns::Posting> same(3, postings[0]);
+  SortedRuns::sort(&same[0], same.size(), &buffer[0]);
+  ASSERT_TRUE(equal(postings[0], same[2]));
+}
+
+// Sorting with several threads must give the same result as with one.
+TEST(SortedRunsTest, sortInParallel)
+{
+  vector<SortedRuns::Posting> postings = randomPostings(10001, 3);
+  vector<SortedRuns::Posting> expected = postings;
+  std::stable_sort(expected.begin(), expected.end(), &SortedRuns::less);
+  vector<SortedRuns::Posting> buffer(postings.size());
+  for (size_t nofThreads = 1; nofThreads <= 5; nofThreads++)
+  {
+    vector<SortedRuns::Posting> sorted = postings;
+    SortedRuns::sortInParallel(&sorted[0], sorted.size(), &buffer[0],
+                               nofThreads);
+    for (size_t i = 0; i < sorted.size(); i++)
+      ASSERT_TRUE(equal(expected[i], sorted[i])) << nofThreads << " " << i;
+  }
+  // More threads than postings.
+  vector<SortedRuns::Posting> two(postings.begin(), postings.begin() + 2);
+  SortedRuns::sortInParallel(&two[0], two.size(), &buffer[0], 4);
+  ASSERT_FALSE(SortedRuns::less(two[1], two[0]));
+}
+
+// Write many runs (with several threads) and read them back merged.
+TEST(SortedRunsTest, writeAndRead)
+{
+  string fileName = "SortedRunsTest.TMP.words-runs";
+  vector<SortedRuns::Posting> postings = randomPostings(10000, 2);
+  for (size_t nofThreads = 1; nofThreads <= 3; nofThreads += 2)
+  {
+    // Room for 1000 postings per run.
+    SortedRunsWriter writer(fileName, 1000 * 2 * sizeof(SortedRuns::Posting),
+                            nofThreads);
+    for (size_t i = 0; i < postings.size(); i++)
+      writer.add(postings[i].wordId, postings[i].docId, postings[i].score,
+                 postings[i].position);
+    writer.finish();
+    ASSERT_EQ(10 * nofThreads, writer.getNofRuns());
+    ASSERT_EQ(10000u, writer.getNofPostings());
+
+    vector<SortedRuns::Posting> expected = postings;
+    std::stable_sort(expected.begin(), expected.end(), &SortedRuns::less);
+    SortedRunsReader reader(fileName);
+    ASSERT_EQ(10 * nofThreads, reader.getNofRuns());
+    ASSERT_EQ(10000u, reader.getNofPostings());
+    SortedRuns::Posting posting;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+      ASSERT_TRUE(reader.next(&posting));
+      ASSERT_TRUE(equal(expected[i], posting)) << i;
+    }
+    ASSERT_FALSE(reader.next(&posting));
+  }
+  remove(fileName.c_str());
+}
+
+// An empty runs file, and a file that is not a runs file.
+TEST(SortedRunsTest, emptyAndInvalidFile)
+{
+  string fileName = "SortedRunsTest.TMP.words-runs";
+  {
+    SortedRunsWriter writer(fileName, 1024, 1);
+    writer.finish();
+    ASSERT_EQ(0u, writer.getNofRuns());
+  }
+  {
+    SortedRunsReader reader(fileName);
+    SortedRuns::Posting posting;
+    ASSERT_EQ(0u, reader.getNofRuns());
+    ASSERT_FALSE(reader.next(&posting));
+  }
+  FILE* file = fopen(fileName.c_str(), "w");
+  fprintf(file, "this is not a runs file\n");
+  fclose(file);
+  ASSERT_THROW(SortedRunsReader reader(fileName), Exception);
+  ASSERT_THROW(SortedRunsReader reader("SortedRunsTest.TMP.nonexisting"),
+               Exception);
+  remove(fileName.c_str());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -29,6 +29,7 @@
 #include "./Exception.h"
 #include "./Timer.h"
 #include "./Globals.h"
+#include "./MemoryPool.h"
 
 // using namespace std;
 // using namespace aucmpl;
@@ -63,12 +64,20 @@ extern bool normalizeWords;
 extern bool rankByGeneralizedEditDistance;
 extern bool fuzzySearchUseClustering;
 extern bool readCustomScores;
+extern bool readDocValues;
+extern bool readFacetIndex;
+extern bool readHotLists;
+extern bool readInfixIndex;
 extern string baseName;
 extern bool showQueryResult;
 extern bool alreadyWellformedXml;
 extern char infoDelim;
 extern char wordPartSepFrontend;
 extern bool corsEnabled;
+extern unsigned int keepAliveTimeoutMsecs;
+extern unsigned int keepAliveMaxNofRequests;
+extern unsigned int nofIoThreads;
+extern unsigned int nofComputeThreads;
 // Default values for ranking and score aggregation
 extern QueryParameters::HowToRankDocsEnum  howToRankDocsDefault;
 extern QueryParameters::HowToRankWordsEnum howToRankWordsDefault;
@@ -210,6 +219,54 @@ void printUsage()
        << endl
        << " -O                   Enables cross-origin resource sharing (CORS) "
                                  "by sending Access-Control-Allow-Origin: *"
+       << endl
+       << " -T timeout           Close a kept-alive connection after <timeout> "
+                                 "msecs without a new request, 0 disables "
+                                 "keep-alive (default: "
+                                 << keepAliveTimeoutMsecs << ")"
+       << endl
+       << " -R max nof requests  Close a kept-alive connection after that many "
+                                 "requests (default: "
+                                 << keepAliveMaxNofRequests << ")"
+       << endl
+       << " -J nof threads       Number of I/O threads (default: "
+                                 << nofIoThreads << ")"
+       << endl
+       << " -j nof threads       Number of compute threads (default: one per "
+                                 "core with -m, otherwise 1)"
+       << endl
+       << " --read-doc-values    Read <db>.docvalues (written by the CSV parser "
+                                 "with --doc-values) for the query"
+       << endl
+       << "                      part " << wordPartSepFrontend << "docvalues"
+       << wordPartSepFrontend << "<field>" << wordPartSepFrontend
+       << "<low>--<high> and for ranking with rd=8 and dv=<field>"
+       << endl
+       << " --read-facet-index   Read <db>.facet-index (written by the CSV "
+                                 "parser with --write-facet-index) to compute"
+       << endl
+       << "                      the completions of " << wordPartSepFrontend
+       << "facet" << wordPartSepFrontend << "<field>" << wordPartSepFrontend
+       << "* without reading the facet lists"
+       << endl
+       << " --read-hot-lists     Read <db>.hot-lists (written by buildIndex "
+                                 "with -H) with the materialised lists of"
+       << endl
+       << "                      hot prefixes, used instead of reading their "
+                                 "blocks"
+       << endl
+       << " --read-infix-index   Read <db>.infix-index (written by buildIndex "
+                                 "with -I) for infix queries *sub*"
+       << endl
+       << " --no-count-only-queries  Compute the full result also for queries "
+                                 "without hits (h=0)"
+       << endl
+       << "                      instead of only counting their hits and "
+                                 "completions"
+       << endl
+       << " --thread-cache-size  Memory of freed vectors kept per compute "
+                                 "thread between requests (default: "
+       << MemoryPool::maxTrimmedCacheBytes / (1024 * 1024) << "M)"
        << endl << endl
        << "Cache/history sizes must be greater than 0 and are given in one of "
           "the forms:"
@@ -283,13 +340,23 @@ int main(int argc, char** argv)
         {"word-part-separator-frontend"       , 1, NULL, 'f'},
         {"word-part-separator-backend"        , 1, NULL, 'b'},
         {"read-custom-scores"                 , 0, NULL, '0'}, 
+        {"read-doc-values"                    , 0, NULL, '1'},
+        {"read-facet-index"                   , 0, NULL, '2'},
+        {"read-hot-lists"                     , 0, NULL, '3'},
+        {"thread-cache-size"                  , 1, NULL, '4'},
+        {"read-infix-index"                   , 0, NULL, '5'},
+        {"no-count-only-queries"              , 0, NULL, '6'},
         {"keep-in-history-queries"            , 1, NULL, 'A'}, 
         {"warm-history-queries"               , 1, NULL, 'I'}, 
         {"enable-cors"                        , 0, NULL, 'O'},
+        {"keep-alive-timeout"                 , 1, NULL, 'T'},
+        {"keep-alive-max-requests"            , 1, NULL, 'R'},
+        {"io-threads"                         , 1, NULL, 'J'},
+        {"compute-threads"                    , 1, NULL, 'j'},
         {NULL                                 , 0, NULL,  0 }
       };
       int c = getopt_long(argc, argv,
-          "A:Bb:Cc:D:d:Ee:Ff:GHh:I:i:Kk:L:l:MmN:o:P:p:Qq:rS:s:t:UVv:Ww:X:YZ0",
+          "A:Bb:Cc:D:d:Ee:Ff:GHh:I:i:J:j:Kk:L:l:MmN:o:P:p:Qq:R:rS:s:T:t:UVv:Ww:X:YZ01234:56",
           long_options, NULL);
 
       if (c == -1) break;
@@ -379,12 +446,32 @@ int main(int argc, char** argv)
 		  break;
         case '0': readCustomScores = true;
                   break;
+        case '1': readDocValues = true;
+                  break;
+        case '2': readFacetIndex = true;
+                  break;
+        case '3': readHotLists = true;
+                  break;
+        case '4': MemoryPool::maxTrimmedCacheBytes = atoi_ext(optarg);
+                  break; /* permits suffix K or M */
+        case '5': readInfixIndex = true;
+                  break;
+        case '6': countOnlyQueries = false;
+                  break;
         case 'A': keepInHistoryQueriesFileName = optarg;
                   break;
         case 'I': warmHistoryQueriesFileName = optarg;
                   break;
         case 'O': corsEnabled = true;
                   break;
+        case 'T': keepAliveTimeoutMsecs = atoi(optarg);
+                  break;
+        case 'R': keepAliveMaxNofRequests = atoi(optarg);
+                  break;
+        case 'J': nofIoThreads = atoi(optarg);
+                  break;
+        case 'j': nofComputeThreads = atoi(optarg);
+                  break;
         default : printUsage();
                   exit(1);
                   break;
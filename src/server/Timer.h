@@ -2,8 +2,33 @@
 #define __TIMER_H__
 
 #include <sys/time.h>
+#include <sys/types.h>
+#include <time.h>
 
-// HOLGER 22Jan06 : changed all suseconds_t to off_t 
+//! Level of detail of the time measurements, fixed at compile time.
+/*!
+ *   1 = only the timers of class Timer (whole requests and the stages of query
+ *       processing, as shown in the one-line summary, the statistics and
+ *       /metrics).
+ *   2 = also the fine-grained timers of class FineTimer (breakdowns of single
+ *       methods, sometimes started and stopped per block or per list). For
+ *       profiling, compile with -DTIMER_DETAIL_LEVEL=2.
+ *
+ *   With level 1, a FineTimer does nothing and its value is always zero.
+ */
+#ifndef TIMER_DETAIL_LEVEL
+#define TIMER_DETAIL_LEVEL 1
+#endif
+
+//! The clock used by the timers. CLOCK_MONOTONIC_RAW is neither set back nor
+//! slewed by NTP and is read via the vDSO (no system call).
+#ifdef CLOCK_MONOTONIC_RAW
+#define TIMER_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define TIMER_CLOCK CLOCK_MONOTONIC
+#endif
+
+// HOLGER 22Jan06 : changed all suseconds_t to off_t
 //
 //! A SIMPLE CLASS FOR TIME MEASUREMENTS.
 //
@@ -11,77 +36,92 @@ class Timer
 {
   private:
 
-    //! The timer value (initially zero)
-    off_t _usecs;
+    //! The timer value in nanoseconds (initially zero)
+    off_t _nsecs;
 
     //! The timer value at the last mark set (initially zero)
-    off_t _usecs_at_mark;
+    off_t _nsecs_at_mark;
 
-    //! Used by the gettimeofday command.
-    struct timeval _tstart;
-    
-    //! Used by the gettimeofday command.
-    struct timeval _tend;
-    
-    //! Used by the gettimeofday command.
-    struct timezone _tz;
+    //! Point in time when the current measurement was started (in nanoseconds).
+    off_t _nsecs_start;
 
     //! Indicates whether a measurement is running.
     bool _running;
 
+    //! The current point in time (in nanoseconds, of a monotonic clock).
+    static inline off_t now()
+    {
+      struct timespec ts;
+      clock_gettime(TIMER_CLOCK, &ts);
+      return (off_t)(1000000000) * (off_t)(ts.tv_sec) + (off_t)(ts.tv_nsec);
+    }
+
   public:
 
     //! The default constructor.
     Timer() { reset(); }
-    
+
     //! Resets the timer value to zero and stops the measurement.
-    void reset() { _usecs = _usecs_at_mark = 0; _running = false; }
+    void reset() { _nsecs = _nsecs_at_mark = 0; _running = false; }
 
     //! Mark the current point in time (to be considered by next usecs_since_mark)
-    void mark() { stop(); _usecs_at_mark = _usecs; cont(); }
+    void mark() { stop(); _nsecs_at_mark = _nsecs; cont(); }
 
     //! Resets the timer value to zero and starts the measurement.
     inline void start()
     {
-      _usecs = _usecs_at_mark = 0;
-      gettimeofday(&_tstart, &_tz);
+      _nsecs = _nsecs_at_mark = 0;
+      _nsecs_start = now();
       _running = true;
     }
 
     //! Continues the measurement without resetting the timer value (no effect if running)
     inline void cont()
-    { 
+    {
       if (_running == false)
       {
-        gettimeofday(&_tstart, &_tz);
+        _nsecs_start = now();
         _running = true;
       }
     }
-    
+
     //! Stops the measurement (does *not* return the timer value anymore)
     inline void stop()
     {
-      gettimeofday(&_tend, &_tz);
-      if(_running){_usecs += (off_t)(1000000) * (off_t)(_tend.tv_sec -
-                             _tstart.tv_sec) + (off_t)(_tend.tv_usec -
-                             _tstart.tv_usec);}
+      if (_running) _nsecs += now() - _nsecs_start;
       _running = false;
-        //return _usecs;
     }
     // (13.10.10 by baumgari for testing codebase/utility/TimerStatistics.h)
     // Sets the totalTime manually.
-    inline void setUsecs(off_t usecs) { _usecs = usecs; }
-    inline void setMsecs(off_t msecs) { _usecs = msecs * (off_t)(1000); }
-    inline void setSecs(off_t secs) { _usecs = secs * (off_t)(1000000); }
+    inline void setUsecs(off_t usecs) { _nsecs = usecs * (off_t)(1000); }
+    inline void setMsecs(off_t msecs) { _nsecs = msecs * (off_t)(1000000); }
+    inline void setSecs(off_t secs) { _nsecs = secs * (off_t)(1000000000); }
 
     //! Time at last stop (initially zero)
-    off_t value() const { return _usecs; } /* in microseconds */
-    off_t usecs() const { return _usecs; } /* in microseconds */
-    off_t msecs() const { return _usecs/1000; } /* in milliseconds */
-    float secs() const { return _usecs/1000000.0; } /* in seconds */
+    off_t value() const { return _nsecs/1000; } /* in microseconds */
+    off_t nsecs() const { return _nsecs; } /* in nanoseconds */
+    off_t usecs() const { return _nsecs/1000; } /* in microseconds */
+    off_t msecs() const { return _nsecs/1000000; } /* in milliseconds */
+    float secs() const { return _nsecs/1000000000.0; } /* in seconds */
 
     //! Time from last mark to last stop (initally zero)
-    off_t usecs_since_mark() const { return _usecs - _usecs_at_mark; }
+    off_t usecs_since_mark() const { return (_nsecs - _nsecs_at_mark)/1000; }
 };
 
+//! A timer for fine-grained measurements, see TIMER_DETAIL_LEVEL.
+#if TIMER_DETAIL_LEVEL >= 2
+typedef Timer FineTimer;
+#else
+class FineTimer : public Timer
+{
+  public:
+    // Hide the measuring methods of Timer, so that the calls compile to
+    // nothing. The value stays zero.
+    void mark() { }
+    void start() { }
+    void cont() { }
+    void stop() { }
+};
+#endif
+
 #endif
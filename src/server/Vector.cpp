@@ -19,7 +19,7 @@ Vector<T>::~Vector()
 #ifndef STL_VECTOR
   if (_data)
   {
-    free(_data);
+    MemoryPool::deallocate(_data);
     _data = NULL;
   }
 #endif
@@ -60,7 +60,7 @@ void Vector<T>::parseFromString(const string& vectorAsString)
 template <class T>
 Vector<T>::Vector(const T& element, unsigned long nofRepetitions)
 #ifdef STL_VECTOR
-  : vector<T>(nofRepetitions, element)
+  : StlVector(nofRepetitions, element)
 #endif
 {
   _isFullList = false;
@@ -108,22 +108,10 @@ void Vector<T>::reserve(size_type n)
      }
      _data = newData;          
      */
-  if(n>0)
-  {
-    _data = (T*) realloc(_data, sizeof(T) * n);
-    if (!_data)
-    {
-      ostringstream os;
-      os << n << " items of size " << sizeof(T);
-      THROW(Exception::REALLOC_FAILED, os.str());
-    }
-    assert(_data);
-  }
-  else
-  {
-    if(_data) {free(_data); _data = NULL;}
-    assert(_data == NULL);
-  }
+  // Memory from the pool of the thread, see MemoryPool.h (it throws if the
+  // allocation fails).
+  _data = (T*) MemoryPool::reallocate(_data, sizeof(T) * _size, sizeof(T) * n);
+  assert((n > 0 && _data) || (n == 0 && _data == NULL));
 
   //          }
   // DECREASE CAPACITY
@@ -181,13 +169,7 @@ Vector<T>::Vector(const Vector& orig)
   assert((orig._data == NULL) || (_size > 0 ));
   if(_size > 0)
   {
-    _data = (T*) realloc(NULL,sizeof(T) * _size);
-    if (!_data) 
-    {
-      ostringstream os;
-      os << _size << " items of size " << sizeof(T);
-      THROW(Exception::REALLOC_FAILED, os.str());
-    }
+    _data = (T*) MemoryPool::allocate(sizeof(T) * _size);
     assert(_data);
     memcpy(_data, orig._data, _size*sizeof(T));
   }
@@ -202,26 +184,18 @@ Vector<T>::Vector(const Vector& orig)
 template <class T>
 Vector<T>& Vector<T>::operator=(const Vector& orig)
 {
+  if (this == &orig) return *this;
   _isFullList = orig._isFullList;
   _size = orig._size;
   _capacity = orig._size; //yes! size! not capacity.
   assert((orig._data == NULL) || (_size > 0 ));
+  // The old elements need not be kept.
+  _data = (T*) MemoryPool::reallocate(_data, 0, sizeof(T) * _size);
   if(_size > 0)
   {
-    _data = (T*) realloc(_data,sizeof(T) * _size);
-    if (!_data) 
-    {
-      ostringstream os;
-      os << _size << " items of size " << sizeof(T);
-      THROW(Exception::REALLOC_FAILED, os.str());
-    }
     assert(_data);
     memcpy(_data, orig._data, _size*sizeof(T));
   }
-  else
-  {
-    _data = NULL;
-  }
 
   return *this;
 }
@@ -16,6 +16,7 @@
 #include <utility>
 #include "./Globals.h"
 #include "./Exception.h"
+#include "./MemoryPool.h"
 
 typedef unsigned long size_type;
 
@@ -41,19 +42,6 @@ template <typename T, typename U> struct Pair_lt
   }
 };
 
-// For sorting pairs in descending order (second component breaks ties, but
-// ASCENDING)
-template <typename T, typename U> struct Pair_gt
-{
-  Pair_gt() {;}
-  inline bool operator()(const pair<T, U>& a, const pair<T, U>& b) const
-  {
-    if (a.first < b.first) {return false;}
-    else if (a.first == b.first) {return (a.second < b.second);}
-    else {return true;}
-  }
-};
-
 // For sorting triples in ascending order (second component breaks ties)
 template < typename T, typename V, typename U> struct Triple_lt
 {
@@ -69,23 +57,6 @@ template < typename T, typename V, typename U> struct Triple_lt
   }
 };
 
-// For sorting triples in descending order (second component breaks ties, but
-// ASCENDING)
-template < typename T, typename V, typename U> struct Triple_gt
-{
-  Triple_gt() {;}
-  inline bool operator()(const pair< pair<T, V> , U>& a,
-                         const pair< pair<T, V>, U>& b) const
-  {
-    if (a.first.first < b.first.first)
-      return false;
-    else if (a.first.first == b.first.first)
-      return (a.first.second < b.first.second);
-    else
-      return true;
-  }
-};
-
 // Class providing comparison for sorting quadruples in ascending order (second
 // component breaks ties, ascending too).
 template <typename T, typename V, typename U, typename W> class Quadruple_lt
@@ -103,34 +74,19 @@ template <typename T, typename V, typename U, typename W> class Quadruple_lt
   }
 };
 
-// Class providing comparison for sorting quadruples in descending order (second
-// component breaks ties, descending too).
-template <typename T, typename V, typename U, typename W> class Quadruple_gt
-{
- public:
-  Quadruple_gt() {;}
-  inline bool operator()(const pair< pair<T, V> , pair <U, W> >& a,
-                         const pair< pair<T, V>, pair<U, W> >& b) const
-  {
-    if (a.first.first > b.first.first)
-      return true;
-    else if (a.first.first == b.first.first)
-      return a.first.second > b.first.second;
-    else
-      return false;
-  }
-};
-
 
 // static unsigned char vectorError;
 
 #ifdef STL_VECTOR
-template <class T> class Vector : public vector<T>
+template <class T> class Vector : public vector<T, PoolAllocator<T> >
 #else
 template <class T> class Vector
 #endif
 {
  public:
+#ifdef STL_VECTOR
+  typedef vector<T, PoolAllocator<T> > StlVector;
+#endif
   // Standard constructor.
   FRIEND_TEST(VectorTest, constructor);
   Vector();
@@ -147,12 +103,12 @@ template <class T> class Vector
   void parseFromString(const string& vectorAsString);
 
 #ifdef STL_VECTOR
-    size_t size() const { return vector<T>::size(); }
-    size_t capacity() const { return vector<T>::capacity(); }
-    void   resize(size_t n, T x = 0) { return vector<T>::resize(n, x); }
-    void   reserve(size_t n) { return vector<T>::reserve(n); }
-    const  T& operator[](size_t i) const { return vector<T>::operator[](i); }
-           T& operator[](size_t i) { return vector<T>::operator[](i); }
+    size_t size() const { return StlVector::size(); }
+    size_t capacity() const { return StlVector::capacity(); }
+    void   resize(size_t n, T x = 0) { return StlVector::resize(n, x); }
+    void   reserve(size_t n) { return StlVector::reserve(n); }
+    const  T& operator[](size_t i) const { return StlVector::operator[](i); }
+           T& operator[](size_t i) { return StlVector::operator[](i); }
 #endif
 
     size_t sizeInBytes() const { return sizeof(T)*size(); }
@@ -261,7 +217,7 @@ template <class T> class Vector
 #ifndef STL_VECTOR
       reserve(size());
 #else
-      vector<T>(*this).swap(*this);
+      StlVector(*this).swap(*this);
 #endif
     }
 
@@ -346,17 +302,17 @@ template <class T> class Vector
 #ifndef STL_VECTOR
       return true;
 #else
-      assert(vector<T>::size()>0);
-      T* array = (T*) &vector<T>::operator[](0);
+      assert(StlVector::size()>0);
+      T* array = (T*) &StlVector::operator[](0);
 
       // actually checks one position more than this
       const unsigned short nofPositionsToCheck = 10;
-      // const unsigned short nofPositionsToCheck = vector<T>::size() -1;
+      // const unsigned short nofPositionsToCheck = StlVector::size() -1;
 
       for (unsigned short k = 0; k <= nofPositionsToCheck; k++)
       {
-        if (array[k*(vector<T>::size()-1)/nofPositionsToCheck] !=
-            vector<T>::operator[](k*(vector<T>::size()-1)/nofPositionsToCheck))
+        if (array[k*(StlVector::size()-1)/nofPositionsToCheck] !=
+            StlVector::operator[](k*(StlVector::size()-1)/nofPositionsToCheck))
         { return false; }
       }
       return true;
@@ -370,13 +326,13 @@ template <class T> class Vector
 #ifndef STL_VECTOR
       if (_data)
       {
-        free(_data);
+        MemoryPool::deallocate(_data);
         _data = NULL;
       }
       _size = 0;
       _capacity = 0;
 #else
-      vector<T>::clear();
+      StlVector::clear();
 #endif
       _isFullList = false;
     }
@@ -500,11 +456,13 @@ template <class T> class Vector
 
 
 
-    // Partial sort TWO vectors. considering them as a vector of pairs
+    // Partial sort TWO vectors in parallel: keep the top k entries (by this
+    // vector, in the given order) and sort them; k = 0 means all.
     /*!
      *    Note: The partial sorts are used for the top-k computation (and
-     *    nowhere else, as of 25Apr08). The routine used to sort in *descending*
-     *    order only.
+     *    nowhere else, as of 25Apr08). Ties are broken by the parallel vector
+     *    (ascending), and then by position. See topKRows for how the top k
+     *    are selected.
      */
     template <typename U>
     void partialSortParallel(Vector<U>&    parallelVector,
@@ -512,59 +470,18 @@ template <class T> class Vector
                              SortOrderEnum sortOrder)
     {
       assert(size() == parallelVector.size());
-      if (k == 0) {k = size();}
-      k = MIN(k, size());
-
-      vector< pair< T, U > > pairedVector;
-      pairedVector.resize(size());
-
-      // build pairs of docid, wordid
-      for (unsigned int i = 0; i < size(); i++)
-      {
-        pairedVector[i].first   = (*this)[i];
-        pairedVector[i].second  = parallelVector[i];
-      }
-
-      // sort according to specified order
-      if (sortOrder == SORT_ORDER_ASCENDING)
-        partial_sort(pairedVector.begin(),
-                     pairedVector.begin() + k,
-                     pairedVector.end(),
-                     Pair_lt<T, U>());
-      else if (sortOrder == SORT_ORDER_DESCENDING)
-        partial_sort(pairedVector.begin(),
-                     pairedVector.begin() + k,
-                     pairedVector.end(),
-                     Pair_gt<T, U>());
-      else
-        CS_THROW(Exception::OTHER, "invalid sort order: " << sortOrder);
-      // partial_sort(pairedVector.begin(),
-      //             pairedVector.begin() + k,
-      //             pairedVector.end(),
-      //             Pair_gt<T, U>());
-
-      pairedVector.resize(k);
-
-      resize(k);
-      parallelVector.resize(k);
-
-      // split into two vectors again
-      for (unsigned int i = 0; i < k; i++)
-      {
-        (*this)[i]        = pairedVector[i].first;
-        parallelVector[i] = pairedVector[i].second;
-      }
-
-      // assert(isReverseSorted());
+      vector<unsigned int> rows;
+      topKRows(k, sortOrder, [&](unsigned int i, unsigned int j)
+               { return parallelVector[i] < parallelVector[j]; }, &rows);
+      gatherRows(*this, rows);
+      gatherRows(parallelVector, rows);
     }
 
 
-    // Partial sort THREE vectors in parallel, considering them as a vector of
-    // triples
+    // Partial sort THREE vectors in parallel, like the two vectors above
     /*!
-     *  Note: The partial sorts are used for the top-k computation (and
-     *  nowhere else, as of 25Apr08). The routine used to sort in *descending*
-     *  order only.
+     *  Ties are broken by the secondary vector (ascending), and then by
+     *  position.
      */
     template <typename U, typename V>
     void partialSortParallel(Vector<V>&    secondaryVector,
@@ -574,62 +491,19 @@ template <class T> class Vector
     {
       assert(size() == secondaryVector.size());
       assert(size() == parallelVector.size());
-      if (k == 0) {k = size();}
-      k = MIN(k, size());
-
-      vector< pair< pair<T, V>, U > > tripledVector;
-      tripledVector.resize(size());
-
-      // build triples
-      for (unsigned long i = 0; i < size(); i++)
-      {
-        tripledVector[i].first.first   = (*this)[i];
-        tripledVector[i].first.second  = secondaryVector[i];
-        tripledVector[i].second        = parallelVector[i];
-      }
-
-      // sort according to specified order
-      if (sortOrder == SORT_ORDER_ASCENDING)
-        partial_sort(tripledVector.begin(),
-                     tripledVector.begin() + k,
-                     tripledVector.end(),
-                     Triple_lt<T, V, U>());
-      else if (sortOrder == SORT_ORDER_DESCENDING)
-        partial_sort(tripledVector.begin(),
-                     tripledVector.begin() + k,
-                     tripledVector.end(),
-                     Triple_gt<T, V, U>());
-      else
-        CS_THROW(Exception::OTHER, "invalid sort order: " << sortOrder);
-      // partial_sort(tripledVector.begin(),
-      //             tripledVector.begin() + k,
-      //             tripledVector.end(),
-      //             Triple_gt<T, V, U>());
-
-      tripledVector.resize(k);
-
-      resize(k);
-      secondaryVector.resize(k);
-      parallelVector.resize(k);
-
-      // split into three vectors again
-      for (unsigned int i = 0; i < k; i++)
-      {
-        (*this)[i]         = tripledVector[i].first.first;
-        secondaryVector[i] = tripledVector[i].first.second;
-        parallelVector[i]  = tripledVector[i].second;
-      }
-
-      // assert(isReverseSorted());
+      vector<unsigned int> rows;
+      topKRows(k, sortOrder, [&](unsigned int i, unsigned int j)
+               { return secondaryVector[i] < secondaryVector[j]; }, &rows);
+      gatherRows(*this, rows);
+      gatherRows(secondaryVector, rows);
+      gatherRows(parallelVector, rows);
     }
 
 
-    // Partial sort FOUR vectors in parallel, consdering them as a vector of
-    // 4-tuples
+    // Partial sort FOUR vectors in parallel, like the two vectors above
     /*!
-     *  Note: The partial sorts are used for the top-k computation (and
-     *  nowhere else, as of 25Apr08). The routine used to sort in *descending*
-     *  order only.
+     *  Ties are broken by the secondary vector (in the given order, too), and
+     *  then by position.
      */
     template <typename U, typename V, typename W>
     void partialSortParallel(Vector<V>&    secondaryVector,
@@ -641,62 +515,95 @@ template <class T> class Vector
       assert(size() == secondaryVector.size());
       assert(size() == firstParallelVector.size());
       assert(size() == secondParallelVector.size());
-      if (k == 0) {k = size();}
-      k = MIN(k, size());
-      // A vector of pairs of pairs
-      vector<pair<pair<T, V>, pair<U, W> > > quadrupledVector;
-      quadrupledVector.resize(size());
+      bool descending = sortOrder == SORT_ORDER_DESCENDING;
+      vector<unsigned int> rows;
+      topKRows(k, sortOrder, [&](unsigned int i, unsigned int j)
+               { return descending ? secondaryVector[j] < secondaryVector[i]
+                                   : secondaryVector[i] < secondaryVector[j]; },
+               &rows);
+      gatherRows(*this, rows);
+      gatherRows(secondaryVector, rows);
+      gatherRows(firstParallelVector, rows);
+      gatherRows(secondParallelVector, rows);
+    }
 
-      // build vector of quadruples
-      for (unsigned long i = 0; i < size(); i++)
+    // The positions of the top k entries of this vector in the given order,
+    // sorted (k = 0 means all). For entries with the same value, the given
+    // function tells whether the one at position i goes before the one at
+    // position j; if neither goes before the other, the one with the smaller
+    // position goes first.
+    /*!
+     *    Only the entries of this vector (the score column) are looked at for
+     *    the selection, and no copy of the rows is made. For a large vector
+     *    and a small k, the value of the top k-th entry is estimated from a
+     *    sample of the entries, with enough margin so that at least k entries
+     *    are at least as good, and only the positions of those are collected
+     *    and partially sorted. If the estimate was too high after all (which
+     *    happens only for very skewed samples), all positions are.
+     */
+    template <class TieBreak>
+    void topKRows(unsigned int k, SortOrderEnum sortOrder,
+                  const TieBreak& goesBefore,
+                  vector<unsigned int>* rows) const
+    {
+      if (sortOrder != SORT_ORDER_ASCENDING
+          && sortOrder != SORT_ORDER_DESCENDING)
+        CS_THROW(Exception::OTHER, "invalid sort order: " << sortOrder);
+      const size_t n = size();
+      if (k == 0) {k = n;}
+      k = MIN(k, n);
+      const bool ascending = sortOrder == SORT_ORDER_ASCENDING;
+      const Vector<T>& values = *this;
+      auto isBetter = [&](const T& x, const T& y)
+                      { return ascending ? x < y : y < x; };
+      auto isBefore = [&](unsigned int i, unsigned int j)
+      {
+        if (isBetter(values[i], values[j])) return true;
+        if (isBetter(values[j], values[i])) return false;
+        if (goesBefore(i, j)) return true;
+        if (goesBefore(j, i)) return false;
+        return i < j;
+      };
+
+      // Estimate a threshold from an evenly spaced sample: about twice as
+      // many entries as needed (plus a margin) are expected to be at least as
+      // good as the sample entry of rank r.
+      rows->clear();
+      const size_t sampleSize = 1024;
+      const size_t r = 2 * k * sampleSize / MAX(n, 1) + 8;
+      if (n >= 8 * sampleSize && r < sampleSize / 2)
       {
-        quadrupledVector[i].first.first   = (*this)[i];
-        quadrupledVector[i].first.second  = secondaryVector[i];
-        quadrupledVector[i].second.first  = firstParallelVector[i];
-        quadrupledVector[i].second.second = secondParallelVector[i];
+        vector<T> sample(sampleSize);
+        for (size_t i = 0; i < sampleSize; i++)
+          sample[i] = values[i * n / sampleSize];
+        std::nth_element(sample.begin(), sample.begin() + r, sample.end(),
+                         isBetter);
+        const T threshold = sample[r];
+        for (size_t i = 0; i < n; i++)
+          if (!isBetter(threshold, values[i])) rows->push_back(i);
+        if (rows->size() < k) rows->clear();
       }
-
-      // sort according to specified order
-      if (sortOrder == SORT_ORDER_ASCENDING)
-        partial_sort(quadrupledVector.begin(),
-                     quadrupledVector.begin() + k,
-                     quadrupledVector.end(),
-                     Quadruple_lt<T, V, U, W>());
-      else if (sortOrder == SORT_ORDER_DESCENDING)
-        partial_sort(quadrupledVector.begin(),
-                     quadrupledVector.begin() + k,
-                     quadrupledVector.end(),
-                     Quadruple_gt<T, V, U, W>());
-      else
-        CS_THROW(Exception::OTHER, "invalid sort order: " << sortOrder);
-      // partial_sort(quadrupledVector.begin(),
-      //             quadrupledVector.begin()+k,
-      //             quadrupledVector.end(),
-      //             Quadruple_gt<T, V, U, W>());
-
-      quadrupledVector.resize(k);
-
-      resize(k);
-      secondaryVector.resize(k);
-      firstParallelVector.resize(k);
-      secondParallelVector.resize(k);
-
-      // split into four vectors again
-      for (unsigned int i = 0; i < k; i++)
+      if (rows->size() == 0)
       {
-        Vector<T>::operator[](i) = quadrupledVector[i].first.first;
-        secondaryVector.operator[](i) = quadrupledVector[i].first.second;
-        firstParallelVector.operator[](i) = quadrupledVector[i].second.first;
-        secondParallelVector.operator[](i) = quadrupledVector[i].second.second;
+        rows->resize(n);
+        for (size_t i = 0; i < n; i++) (*rows)[i] = i;
       }
-
-      // assert(isReverseSorted());
+      std::partial_sort(rows->begin(), rows->begin() + k, rows->end(),
+                        isBefore);
+      rows->resize(k);
     }
 
-
-
-
-
+    // Replace the given vector by its entries at the given positions, in that
+    // order.
+    template <typename U>
+    static void gatherRows(Vector<U>& column,
+                           const vector<unsigned int>& rows)
+    {
+      vector<U> gathered(rows.size());
+      for (size_t i = 0; i < rows.size(); i++) gathered[i] = column[rows[i]];
+      column.resize(rows.size());
+      for (size_t i = 0; i < rows.size(); i++) column[i] = gathered[i];
+    }
 
     // Simply checks if all the elements are > 0. Also returns true for empty
     // vector.
@@ -963,11 +870,11 @@ template <class T> class Vector
     // TODO(INGMAR): Write a user defined unique function, which could also do
     // scoring e.g. by counting how often something occurs and returning pairs
     GlobalTimers::uniqueTimer.cont();
-    const typename vector<T>::iterator new_end
-      = unique(vector<T>::begin(), vector<T>::end());
+    const typename StlVector::iterator new_end
+      = unique(StlVector::begin(), StlVector::end());
     GlobalTimers::uniqueTimer.stop();
     // then cut to right length
-    resize(distance(vector<T>::begin(), new_end));  // yes, no +1 here!
+    resize(distance(StlVector::begin(), new_end));  // yes, no +1 here!
     assert(isSorted(true));
     }
     */
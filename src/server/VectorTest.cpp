@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "Vector.h"
 
 // _____________________________________________________________________________
@@ -28,6 +31,89 @@ TEST(Vector, parseFromString)
   ASSERT_EQ(3, v[2]);
 }
 
+// _____________________________________________________________________________
+TEST(Vector, partialSortParallelSmall)
+{
+  Vector<int> scores, docIds;
+  scores.parseFromString("3 1 4 1 5 9 2 6 5 3");
+  docIds.parseFromString("9 8 7 6 5 4 3 2 1 0");
+  scores.partialSortParallel(docIds, 4, SORT_ORDER_DESCENDING);
+  ASSERT_EQ("[9 6 5 5]", scores.asString());
+  ASSERT_EQ("[4 2 1 5]", docIds.asString());
+  scores.partialSortParallel(docIds, 0, SORT_ORDER_ASCENDING);
+  ASSERT_EQ("[5 5 6 9]", scores.asString());
+  ASSERT_EQ("[1 5 2 4]", docIds.asString());
+  ASSERT_ANY_THROW(scores.partialSortParallel(docIds, 2, SORT_ORDER_UNDEFINED));
+
+  // Ties in the secondary vector, too: then by position.
+  Vector<int> wordIds, docCounts, occCounts;
+  scores.parseFromString("2 7 7 7 2");
+  docCounts.parseFromString("1 3 3 1 1");
+  occCounts.parseFromString("0 0 0 0 0");
+  wordIds.parseFromString("10 11 12 13 14");
+  scores.partialSortParallel(docCounts, occCounts, wordIds, 4,
+                             SORT_ORDER_DESCENDING);
+  ASSERT_EQ("[11 12 13 10]", wordIds.asString());
+}
+
+// _____________________________________________________________________________
+// Large vectors (for which the top k are selected with a threshold from a
+// sample) give the same top k as sorting everything, also for many ties and
+// for sorted input.
+TEST(Vector, partialSortParallelLarge)
+{
+  typedef std::pair<std::pair<unsigned int, unsigned int>, size_t> Row;
+  const size_t n = 100000;
+  for (int input = 0; input < 3; input++)
+  for (int order = 1; order <= 2; order++)
+  for (int nofVectors = 3; nofVectors <= 4; nofVectors++)
+  for (unsigned int k = 1; k <= 10000; k *= 10)
+  {
+    SortOrderEnum sortOrder = static_cast<SortOrderEnum>(order);
+    bool ascending = sortOrder == SORT_ORDER_ASCENDING;
+    Vector<unsigned int> scores, docIds, positions, others;
+    vector<Row> rows;
+    for (size_t i = 0; i < n; i++)
+    {
+      unsigned int score = input == 0 ? (i * 7919) % 100003
+                         : input == 1 ? (i * 31) % 17 : i;
+      scores.push_back(score);
+      docIds.push_back((i * 13) % 5);
+      positions.push_back(i);
+      others.push_back(0);
+      rows.push_back(Row(std::make_pair(score, (i * 13) % 5), i));
+    }
+    // The expected order: by score, then by doc id (ascending, or with four
+    // vectors in the sort order), then by position.
+    bool docIdsAscending = nofVectors == 3 || ascending;
+    std::stable_sort(rows.begin(), rows.end(),
+        [&](const Row& x, const Row& y)
+        {
+          if (x.first.first != y.first.first)
+            return ascending == (x.first.first < y.first.first);
+          if (x.first.second != y.first.second)
+            return docIdsAscending == (x.first.second < y.first.second);
+          return false;
+        });
+    if (nofVectors == 3)
+      scores.partialSortParallel(docIds, positions, k, sortOrder);
+    else
+      scores.partialSortParallel(docIds, positions, others, k, sortOrder);
+    ASSERT_EQ(k, scores.size());
+    ASSERT_EQ(k, docIds.size());
+    ASSERT_EQ(k, positions.size());
+    ASSERT_EQ(nofVectors == 3 ? n : k, others.size());
+    for (size_t i = 0; i < k; i++)
+    {
+      ASSERT_EQ(rows[i].second, positions[i])
+        << "input " << input << ", order " << order << ", nofVectors "
+        << nofVectors << ", k = " << k << ", i = " << i;
+      ASSERT_EQ(rows[i].first.first, scores[i]);
+      ASSERT_EQ(rows[i].first.second, docIds[i]);
+    }
+  }
+}
+
 // _____________________________________________________________________________
 int main(int argc, char **argv)
 {
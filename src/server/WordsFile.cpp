@@ -12,6 +12,7 @@ WordsFile::WordsFile(string fileName)
 {
   _format = FORMAT_HTDIG;
   _fileName = fileName;
+  _runsReader = NULL;
   _skipLineWithSameWordAndDoc = false;
   _maintainSetOfDistinctDocIds = false;
   _distinctDocIds.set_empty_key(std::numeric_limits<DocId>::max());
@@ -49,6 +50,7 @@ WordsFile::~WordsFile()
 {
   if (_file != NULL) fclose(_file);
   if (_fileBuffer != NULL) delete[] _fileBuffer;
+  if (_runsReader != NULL) delete _runsReader;
   if (_line != NULL) delete[] _line;
   if (_word != NULL) delete[] _word;
 }
@@ -71,6 +73,8 @@ void WordsFile::setFormat(const WordsFile::Format& format)
     exit(1);
   }
   _format = format;
+  if (format == FORMAT_RUNS && _runsReader == NULL)
+    _runsReader = new SortedRunsReader(_fileName);
 }
 
 
@@ -111,6 +115,14 @@ bool WordsFile::getNextLine(string& word, WordId& wordId, DocId& docId,
       exit(1);
     }
   }
+  else if (_format == FORMAT_RUNS)
+  {
+    // Same layout as a record of a binary words file.
+    assert(sizeof(SortedRuns::Posting) == 16);
+    SortedRuns::Posting* posting = reinterpret_cast<SortedRuns::Posting*>(_line);
+    nofBytesRead = _runsReader->next(posting) ? 16 : 0;
+    _isEof = (nofBytesRead == 0);
+  }
   else
   {
     cerr << MSG_BEG << "! Invalid words file format (" << _format << ")"
@@ -125,7 +137,7 @@ bool WordsFile::getNextLine(string& word, WordId& wordId, DocId& docId,
   // whole line and return false.
   if (nofBytesRead > MAX_LINE_LENGTH + 1)
   {
-    assert(_format != FORMAT_BINARY);
+    assert(!formatIsBinary());
     cerr << MSG_BEG << "WARNING while reading \"" << _fileName << "\""
          << " (line " << _lineNumber << " longer than " << MAX_LINE_LENGTH
          << " characters)" << " *ignoring this line*" << MSG_END << flush;
@@ -142,7 +154,7 @@ bool WordsFile::getNextLine(string& word, WordId& wordId, DocId& docId,
   }
 
   // 2b. If this is the first line, and it starts with a #, ignore it.
-  if (_format != FORMAT_BINARY && _lineNumber == 1 && _line[0] == '#')
+  if (!formatIsBinary() && _lineNumber == 1 && _line[0] == '#')
   {
     return false;
   }
@@ -163,6 +175,7 @@ bool WordsFile::getNextLine(string& word, WordId& wordId, DocId& docId,
       rawScore = 0;
       break;
     case FORMAT_BINARY:
+    case FORMAT_RUNS:
       allTokensParsed = (nofBytesRead == 16);
       assert(allTokensParsed);
       word = "";
@@ -226,8 +239,8 @@ bool WordsFile::getNextLine(string& word, WordId& wordId, DocId& docId,
   // Optionally skip lines with same word and doc id as previous line.
   word = _word;
   if (_skipLineWithSameWordAndDoc && docId == _lastDocId &&
-      ((_format != FORMAT_BINARY && word == _lastWord) ||
-       (_format == FORMAT_BINARY && wordId == _lastWordId)))
+      ((!formatIsBinary() && word == _lastWord) ||
+       (formatIsBinary() && wordId == _lastWordId)))
   {
     return false;
   }
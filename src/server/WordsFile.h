@@ -9,6 +9,7 @@
 #include <iostream>
 #include <string>
 #include "./Globals.h"
+#include "./SortedRuns.h"
 
 // #include <ext/hash_set>  // Used to maintain distinct doc ids.
 // #include <hash_set>
@@ -34,7 +35,8 @@ class WordsFile
     FORMAT_HTDIG       = 1,
     FORMAT_SHORT       = 2,
     FORMAT_BINARY      = 3,
-    FORMAT_INVALID_UPP = 4
+    FORMAT_RUNS        = 4,
+    FORMAT_INVALID_UPP = 5
   };
 
   // Get next line from a words file. Returns false iff (1) end of file if
@@ -56,7 +58,9 @@ class WordsFile
   off_t getLineNumber() const { return _lineNumber; }
   DocId maxDocId() const { return _maxDocId; }
   off_t totalNumBytesRead() const { return _totalNumBytesRead; }
-  bool formatIsBinary() const { return _format == FORMAT_BINARY; }
+  // True also for FORMAT_RUNS, which has word ids like FORMAT_BINARY.
+  bool formatIsBinary() const
+  { return _format == FORMAT_BINARY || _format == FORMAT_RUNS; }
   // Returns number of distinct doc ids when _maintainSetOfDistinctDocIds ==
   // true, otherwise returns max doc id.
   DocId numDocs() const;
@@ -68,6 +72,8 @@ class WordsFile
   FILE* _file;
   // Explicit buffer for reading from file.
   char* _fileBuffer;
+  // Merge of the runs (only for FORMAT_RUNS, see SortedRuns.h).
+  SortedRunsReader* _runsReader;
   // Format (see enum above).
   Format _format;
   // Whether to skip lines with same word and doc as previous line.
@@ -14,12 +14,16 @@ void printUsage()
           "   9 (max. compr., slow); -1 is like 0 but about 10 times faster"
           "   because it doesn't use zlib (which computes checksums etc.)" << endl
        << "-m to specify the minimum size, below which a document is not compressed" << endl
+       << "-b to specify the block size, in which the text of documents with"
+          "   word positions (field p:, see --position-offsets of the CSV"
+          "   parser) is compressed, for fast excerpts from positions" << endl
        << "-f forces overwrite, if <db>.docs.DB already exists" << endl
        << endl;
 }
 
 int compressionLevel = 6; // default value (from 0..9)
 unsigned int minSize = 100; // no compression for docs with less bytes
+unsigned int blockSize = 16 * 1024; // for docs with word positions
 bool forceOverwrite = false;
 
 // NOTE 07Aug07 (Holger): I checked that for lines of less than a hundred bytes,
@@ -40,12 +44,13 @@ int main(int argc, char** argv)
   // PARSE COMMAND LINE
   while (true)
   {
-    int c = getopt(argc, argv, "l:m:f");
+    int c = getopt(argc, argv, "l:m:b:f");
     if (c == -1) break;
     switch (c)
     {
       case 'l': compressionLevel = atoi(optarg); break;
       case 'm': minSize = atoi(optarg); break;
+      case 'b': blockSize = atoi(optarg); break;
       case 'f': forceOverwrite = true; break;
       default : printUsage(); exit(1); break;
     }
@@ -69,6 +74,11 @@ int main(int argc, char** argv)
          << endl;
     exit(1);
   }
+  if (blockSize == 0)
+  {
+    cerr << "block size must be positive" << endl;
+    exit(1);
+  }
 
   // SHOW PARAMETERS
   cout << "compression level is " << compressionLevel;
@@ -77,7 +87,7 @@ int main(int argc, char** argv)
   cout << endl << endl;
 
   // ACTUAL BUILD
-  DocsDB::build(inFileName, outFileName, compressionLevel, minSize);
+  DocsDB::build(inFileName, outFileName, compressionLevel, minSize, blockSize);
 
   return 0;
 }
@@ -3,6 +3,8 @@
 #include "CompleterBase.h"
 #include "INVCompleter.h"
 #include "HYBCompleter.h"
+#include "BlockBoundaries.h"
+#include "InfixIndex.h"
 
 using namespace std;
 
@@ -32,14 +34,42 @@ void printUsage()
        << "     do *not* include scores in build" << endl
        << "     *** NOTE: the old -s option did the opposite, scores are now default ***" << endl
        << endl
-       << "-f [ASCII|BINARY|SHORT]" << endl
+       << "-f [ASCII|BINARY|SHORT|RUNS]" << endl
        << "     format of words file. Default is ASCII: four columns separated by tabs (1 = word, 2 = doc id, 3 = score,"
        << "     4 = position), all written in ASCII. BINARY is the same thing with each of the four writte as a 4-byte"
-       << "     integer. SHORT is like ASCII but without position." << endl
+       << "     integer. SHORT is like ASCII but without position. RUNS merges the sorted runs written by the parser"
+       << "     with --write-sorted-runs (file .words-runs) and merges them, no separate sort needed." << endl
        << endl
        << "-M max_block_volume" << endl
        << "     ignore blocks with more than the specified number of items. To avoid program crash for blocks > 2GB," << endl
        << "     e.g., 'the' for terabyte. Default value is UINT_MAX." << endl
+       << endl
+       << "-t nof_threads" << endl
+       << "     sort and compress the blocks of a HYB index with this many threads, while the words file is" << endl
+       << "     read and the blocks are written in order. The index is the same as with one thread. Default 1." << endl
+       << endl
+       << "-H queries_file" << endl
+       << "     write the materialised posting lists of the hot prefixes to <db>.hot-lists (HYB only), for the" << endl
+       << "     server option --read-hot-lists. The prefixes are the words ending in * in the given file (one query" << endl
+       << "     per line, e.g. from a query log); those whose lists cost most (count times blocks read) are taken." << endl
+       << "     Exact words like :facet:type:article count, too, if their list is dense (then stored as a bitmap)." << endl
+       << endl
+       << "-N max_nof_hot_lists" << endl
+       << "     write at most this many hot lists (see -H). Default 100." << endl
+       << endl
+       << "-Q query_log" << endl
+       << "     choose the block boundaries of a HYB index for the given query log (one query per line), so that" << endl
+       << "     the expected number of postings decoded per query word is least, with at most as many blocks as" << endl
+       << "     for the block volume of -b. Writes the boundaries to <db>.block-boundaries and the predicted" << endl
+       << "     costs to <db>.block-costs (see also computeBlockBoundaries)." << endl
+       << endl
+       << "-I" << endl
+       << "     write an FM-index of the vocabulary to <db>.infix-index, for infix queries *sub* with the server" << endl
+       << "     option --read-infix-index (instead of partial words in the words file)." << endl
+       << endl
+       << "-m maps_directory" << endl
+       << "     directory with the character mapping files, for normalising the prefixes of -H like the server" << endl
+       << "     does. Default codebase/utility." << endl
        << endl;
 }
 
@@ -50,6 +80,69 @@ string wordsFileName;
 string vocFileName;
 string indexFileName;
 string format;
+string hotPrefixesFileName;
+string hotListsFileName;
+string infixIndexFileName;
+bool writeInfixIndex = false;
+size_t maxNofHotLists = 100;
+string mapsDirectory = "codebase/utility";
+string queryLogFileName;
+string blockBoundariesFileName;
+string blockCostsFileName;
+
+//
+// CHOOSE THE HYB BLOCK BOUNDARIES FOR A QUERY LOG (see BlockBoundaries.h)
+//
+void computeBlockBoundaries()
+{
+  BlockBoundaries boundaries;
+  boundaries.countWordVolumes(wordsFileName, format, vocFileName);
+  boundaries.readQueryLog(queryLogFileName);
+  vector<size_t> baseline = boundaries.volumeLayout(HYB_BLOCK_VOLUME);
+  vector<size_t> layout = boundaries.optimize(baseline.size());
+  boundaries.writeBoundaries(layout, blockBoundariesFileName);
+  ofstream costsFile(blockCostsFileName.c_str());
+  boundaries.writeReport(layout, baseline, costsFile);
+  BlockBoundaries::Cost cost = boundaries.predictCost(layout);
+  BlockBoundaries::Cost baselineCost = boundaries.predictCost(baseline);
+  cout << "* block boundaries for " << commaStr(boundaries.getNofQueryWords())
+       << " query words from \"" << queryLogFileName << "\" written to \""
+       << blockBoundariesFileName << "\"" << endl
+       << "* predicted postings decoded per query word: "
+       << commaStr(static_cast<off_t>(cost.postingsPerQuery)) << " in "
+       << cost.nofBlocks << " blocks (instead of "
+       << commaStr(static_cast<off_t>(baselineCost.postingsPerQuery)) << " in "
+       << baselineCost.nofBlocks << " blocks of volume "
+       << commaStr(HYB_BLOCK_VOLUME) << "), see \"" << blockCostsFileName
+       << "\"" << endl;
+  HYB_BOUNDARY_WORDS_FILE_NAME = blockBoundariesFileName;
+}
+
+//
+// WRITE THE MATERIALISED LISTS OF HOT PREFIXES (see HotLists.h; HYB only)
+//
+template<class Completer>
+void writeHotLists(INVIndex* index)
+{
+  cout << "! hot lists are only supported for HYB, option -H ignored" << endl;
+}
+
+template<class Completer>
+void writeHotLists(HYBIndex* index)
+{
+  // The prefixes are normalised like in queries, which needs the conversion
+  // maps.
+  if (globalStringConverter.init(mapsDirectory) == false)
+  {
+    cout << "! " << globalStringConverter.getLastError() << endl << endl;
+    exit(1);
+  }
+  TimedHistory history;
+  FuzzySearch::FuzzySearcherUtf8 nullFuzzySearcher;
+  Completer completer(index, &history, &nullFuzzySearcher);
+  completer.writeHotLists(HotLists::countPrefixes(hotPrefixesFileName),
+                          maxNofHotLists, hotListsFileName);
+}
 
 //
 // BUILD AN INDEX (index file names, etc. from global variables)
@@ -65,6 +158,13 @@ void buildIndex()
   Index index(indexFileName, vocFileName, Completer::mode());
   index.build(wordsFileName, format);
   index.showMetaInfo();
+  if (!hotPrefixesFileName.empty()) writeHotLists<Completer>(&index);
+  if (writeInfixIndex)
+  {
+    InfixIndex::build(index._vocabulary, infixIndexFileName);
+    cout << "* infix index of " << commaStr(index._vocabulary.size())
+         << " words written to \"" << infixIndexFileName << "\"" << endl;
+  }
   //  Completer completer();
   //  completer.buildIndex(wordsFileName, indexFileName, vocFileName, format);
   //  completer.showMetaInfo();
@@ -90,7 +190,7 @@ int main(int argc, char *argv[])
   format = "ASCII";
   while (true)
   {
-    char c = getopt(argc, argv, "Cb:f:o:LSM:");
+    char c = getopt(argc, argv, "Cb:f:o:LSM:t:H:N:Im:Q:");
     if (c == -1) break;
     switch (c)
     {
@@ -117,6 +217,25 @@ int main(int argc, char *argv[])
       case 'M':
         maxBlockVolume = atoi(optarg);
         break;
+      case 't':
+        // HYB_BUILD_NOF_THREADS defined in Globals.h
+        HYB_BUILD_NOF_THREADS = atoi(optarg) > 0 ? atoi(optarg) : 1;
+        break;
+      case 'H':
+        hotPrefixesFileName = optarg;
+        break;
+      case 'N':
+        maxNofHotLists = atoi(optarg);
+        break;
+      case 'I':
+        writeInfixIndex = true;
+        break;
+      case 'm':
+        mapsDirectory = optarg;
+        break;
+      case 'Q':
+        queryLogFileName = optarg;
+        break;
       default:
         cout << endl << "! ERROR in processing options (getopt returned '" << c << "')" << endl << endl;
         exit(1);
@@ -145,8 +264,13 @@ int main(int argc, char *argv[])
     else { cout << endl << "! YOU SHOULD NEVER SEE THIS" << endl << endl;  exit(1); }
   }
   vocFileName = dbName + ".vocabulary";
+  hotListsFileName = dbName + ".hot-lists";
+  infixIndexFileName = dbName + ".infix-index";
+  blockBoundariesFileName = dbName + ".block-boundaries";
+  blockCostsFileName = dbName + ".block-costs";
   if (format == "ASCII") wordsFileName = dbName + ".words-sorted.ascii";
   if (format == "BINARY") wordsFileName = dbName + ".words-sorted.binary";
+  if (format == "RUNS") wordsFileName = dbName + ".words-runs";
 
   //
   // BUILD AN INDEX of the specified type
@@ -155,6 +279,11 @@ int main(int argc, char *argv[])
   MODE += ((useLocations) ? (2) : (0)) + ((useScores) ? (4) : (0));
   try 
   {
+    if (!queryLogFileName.empty())
+    {
+      if (method == "HYB") computeBlockBoundaries();
+      else cout << "! block boundaries are only for HYB, option -Q ignored" << endl;
+    }
     if (method == "HYB" && MODE == WITH_POS + WITH_SCORES)
         buildIndex< HybCompleter<WITH_DUPS + WITH_POS + WITH_SCORES>, HYBIndex >();
     #ifdef COMPILE_INV
@@ -0,0 +1,118 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "server/BlockBoundaries.h"
+#include "server/Exception.h"
+#include "server/Globals.h"
+
+using std::cout;
+using std::endl;
+
+// _____________________________________________________________________________
+void printUsage()
+{
+  cout << EMPH_ON << "Usage: computeBlockBoundaries [-f ASCII|BINARY|RUNS] "
+       << "[-b block_volume] [-n nof_blocks] [-c block_overhead] "
+       << "[-w background_weight] <db>.words <query_log>" << EMPH_OFF << endl
+       << endl
+       << "Computes the block boundaries of a HYB index that minimise the "
+       << "expected number of postings" << endl
+       << "decoded per query word of the given query log (one query per line), "
+       << "for the words file of" << endl
+       << "buildIndex (the name is derived from <db> like there). Writes "
+       << "<db>.block-boundaries, for" << endl
+       << "buildIndex -b, and the predicted costs, compared to blocks of the "
+       << "given volume, to" << endl
+       << "<db>.block-costs." << endl
+       << endl
+       << "-f    format of the words file, as for buildIndex. Default ASCII."
+       << endl
+       << "-b    block volume of the baseline, and the number of blocks is the "
+       << "number of blocks of" << endl
+       << "      that volume. Default " << HYB_BLOCK_VOLUME << "." << endl
+       << "-n    number of blocks (at most), instead of the one from -b." << endl
+       << "-c    predicted cost of reading a block, in postings. Default 1000."
+       << endl
+       << "-w    weight of the queries not in the log, relative to those in "
+       << "it. Default 0.1." << endl
+       << endl;
+}
+
+// _____________________________________________________________________________
+int main(int argc, char** argv)
+{
+  cout << endl << EMPH_ON << "COMPUTE HYB BLOCK BOUNDARIES (" << VERSION << ")"
+       << EMPH_OFF << endl << endl;
+
+  string format = "ASCII";
+  size_t nofBlocks = 0;
+  BlockBoundaries boundaries;
+  while (true)
+  {
+    int c = getopt(argc, argv, "f:b:n:c:w:");
+    if (c == -1) break;
+    switch (c)
+    {
+      case 'f': format = optarg; break;
+      case 'b': HYB_BLOCK_VOLUME = atoi(optarg); break;
+      case 'n': nofBlocks = atoi(optarg); break;
+      case 'c': boundaries.setBlockOverhead(atof(optarg)); break;
+      case 'w': boundaries.setBackgroundWeight(atof(optarg)); break;
+      default: printUsage(); exit(1);
+    }
+  }
+  if (optind + 2 != argc || HYB_BLOCK_VOLUME == 0)
+  {
+    printUsage();
+    exit(1);
+  }
+  string dbName = argv[optind++];
+  string queryLogFileName = argv[optind++];
+  dbName.erase(dbName.rfind('.'));
+  string wordsFileName = dbName + ".words-sorted.ascii";
+  if (format == "BINARY") wordsFileName = dbName + ".words-sorted.binary";
+  if (format == "RUNS") wordsFileName = dbName + ".words-runs";
+  string boundariesFileName = dbName + ".block-boundaries";
+  string costsFileName = dbName + ".block-costs";
+
+  try
+  {
+    cout << "* counting postings per word in \"" << wordsFileName << "\" ... "
+         << std::flush;
+    boundaries.countWordVolumes(wordsFileName, format,
+                                dbName + ".vocabulary");
+    cout << "done (" << commaStr(boundaries.getNofWords()) << " words, "
+         << commaStr(boundaries.getTotalVolume()) << " postings)" << endl;
+    boundaries.readQueryLog(queryLogFileName);
+    cout << "* read " << commaStr(boundaries.getNofQueryWords())
+         << " distinct query words from \"" << queryLogFileName << "\""
+         << endl;
+    vector<size_t> baseline = boundaries.volumeLayout(HYB_BLOCK_VOLUME);
+    if (nofBlocks == 0) nofBlocks = baseline.size();
+    vector<size_t> layout = boundaries.optimize(nofBlocks);
+    boundaries.writeBoundaries(layout, boundariesFileName);
+    cout << "* wrote " << commaStr(layout.size()) << " block boundaries to \""
+         << boundariesFileName << "\"" << endl;
+    std::ofstream costsFile(costsFileName.c_str());
+    boundaries.writeReport(layout, baseline, costsFile);
+    costsFile.close();
+    if (costsFile.fail())
+      CS_THROW(Exception::OTHER, "could not write to \"" << costsFileName
+               << "\"");
+    cout << "* wrote predicted costs to \"" << costsFileName << "\"" << endl
+         << endl;
+    boundaries.writeReport(layout, baseline, cout);
+    cout << endl;
+  }
+  catch(const Exception& e)
+  {
+    cout << "! " << e.getFullErrorMessage() << endl << endl;
+    exit(1);
+  }
+  return 0;
+}
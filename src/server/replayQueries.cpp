@@ -0,0 +1,544 @@
+// Copyright 2026, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+
+// Replay a query log against a HYB index, in process or over HTTP against a
+// running startCompletionServer, with N closed-loop clients or at a target
+// rate. Writes latency percentiles per class of queries, history hit rates and
+// CPU and memory usage, as a table and optionally as JSON (for comparing
+// releases). See printUsage below and QueryReplay.h.
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <clocale>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "server/CompleterBase.h"
+#include "server/HYBCompleter.h"
+#include "server/QueryReplay.h"
+#include "fuzzysearch/FuzzySearcher.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ostringstream;
+
+extern bool fuzzySearchEnabled;
+extern string baseName;
+
+size_t atoi_ext(string s);
+
+void printUsage()
+{
+  cout << "Usage: replayQueries [options] <query log> <index file>" << endl
+       << "       replayQueries [options] <query log> <host>:<port>" << endl
+       << endl
+       << "Replays the queries of the log (one per line, optionally preceded "
+          "by a session id" << endl
+       << "and a tab; see QueryLog in QueryReplay.h) against the given "
+          "index (file with" << endl
+       << "ending .hybrid, queried in this process) or a running completion "
+          "server." << endl << endl
+       << "-c <n>       Number of clients (default: 1)." << endl
+       << "-Q <qps>     Send the queries at this rate (open loop). Default: "
+          "each client sends" << endl
+       << "             the next query when the previous one is answered "
+          "(closed loop)." << endl
+       << "-w           Warm cache: replay the log once before measuring. "
+          "Default is a cold" << endl
+       << "             cache: an empty history and, in process, the index "
+          "files dropped" << endl
+       << "             from the page cache (over HTTP, restart the server "
+          "for that)." << endl
+       << "-j <file>    Also write the results as JSON to this file." << endl
+       << "-p <params>  Parameters to append to each HTTP request, e.g. "
+          "\"h=10&c=5\"." << endl
+       << "-h <size>    Maximal size of the history in process, e.g. 64M "
+          "(default: as the server)." << endl
+       << "-L <locale>  Locale of the index, e.g. en_US.iso88591 (in process; "
+          "default: utf-8)." << endl
+       << "-M <dir>     Directory with the maps of StringConverter (in "
+          "process; default:" << endl
+       << "             codebase/utility, as for the server)." << endl
+       << "-Y           Enable fuzzy search (in process)." << endl
+       << endl;
+}
+
+// The result of a request over HTTP: the status code and the body.
+struct HttpResponse
+{
+  int status;
+  string body;
+};
+
+// A keep-alive connection to a completion server, reopened when the server
+// closes it (after keepAliveMaxNofRequests requests, or on errors).
+class HttpClient
+{
+ public:
+  HttpClient(const string& host, const string& port)
+    : _host(host), _port(port), _socket(-1) { }
+  ~HttpClient() { close(); }
+
+  // Send a GET request for the given target and read the response. Throws an
+  // exception if the server cannot be reached or the response is malformed.
+  HttpResponse get(const string& target)
+  {
+    // A connection which was kept open may have been closed by the server in
+    // the meantime, so try once more on a new connection.
+    for (int attempt = 0; ; attempt++)
+    {
+      bool wasOpen = _socket >= 0;
+      try
+      {
+        if (!wasOpen) open();
+        return request(target);
+      }
+      catch(const Exception& e)
+      {
+        close();
+        if (!wasOpen || attempt > 0) throw;
+      }
+    }
+  }
+
+ private:
+  void open()
+  {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses;
+    int error = getaddrinfo(_host.c_str(), _port.c_str(), &hints, &addresses);
+    if (error != 0)
+      CS_THROW(Exception::COULD_NOT_CREATE_SOCKET, _host << ":" << _port
+               << ": " << gai_strerror(error));
+    for (struct addrinfo* a = addresses; a != NULL; a = a->ai_next)
+    {
+      _socket = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (_socket < 0) continue;
+      if (connect(_socket, a->ai_addr, a->ai_addrlen) == 0) break;
+      ::close(_socket);
+      _socket = -1;
+    }
+    freeaddrinfo(addresses);
+    if (_socket < 0)
+      CS_THROW(Exception::COULD_NOT_CREATE_SOCKET, "could not connect to "
+               << _host << ":" << _port << ": " << strerror(errno));
+    _buffer.clear();
+  }
+
+  void close()
+  {
+    if (_socket >= 0) ::close(_socket);
+    _socket = -1;
+  }
+
+  HttpResponse request(const string& target)
+  {
+    string request = "GET " + target + " HTTP/1.1\r\nHost: " + _host
+      + "\r\n\r\n";
+    for (size_t sent = 0; sent < request.size(); )
+    {
+      ssize_t n = send(_socket, request.data() + sent, request.size() - sent,
+                       MSG_NOSIGNAL);
+      if (n <= 0)
+        CS_THROW(Exception::OTHER, "sending request: " << strerror(errno));
+      sent += n;
+    }
+    size_t headerEnd;
+    while ((headerEnd = _buffer.find("\r\n\r\n")) == string::npos) receive();
+    string header = _buffer.substr(0, headerEnd);
+    _buffer.erase(0, headerEnd + 4);
+
+    HttpResponse response;
+    if (sscanf(header.c_str(), "HTTP/%*d.%*d %d", &response.status) != 1)
+      CS_THROW(Exception::OTHER, "malformed response: " << header);
+    size_t contentLength = 0;
+    bool keepAlive = true;
+    std::istringstream lines(header);
+    string line;
+    while (std::getline(lines, line))
+    {
+      if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0)
+        contentLength = atol(line.c_str() + 15);
+      else if (strncasecmp(line.c_str(), "Connection:", 11) == 0)
+        keepAlive = line.find("close") == string::npos;
+    }
+    while (_buffer.size() < contentLength) receive();
+    response.body = _buffer.substr(0, contentLength);
+    _buffer.erase(0, contentLength);
+    if (!keepAlive) close();
+    return response;
+  }
+
+  void receive()
+  {
+    char data[65536];
+    ssize_t n = recv(_socket, data, sizeof(data), 0);
+    if (n <= 0)
+      CS_THROW(Exception::OTHER, "connection closed by the server");
+    _buffer.append(data, n);
+  }
+
+  string _host;
+  string _port;
+  int _socket;
+  string _buffer;
+};
+
+// The query URL-encoded, for the q parameter.
+string urlEncode(const string& s)
+{
+  static const char* HEX = "0123456789ABCDEF";
+  string encoded;
+  for (size_t i = 0; i < s.size(); i++)
+  {
+    unsigned char c = s[i];
+    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '*')
+    {
+      encoded += c;
+    }
+    else
+    {
+      encoded += '%';
+      encoded += HEX[c >> 4];
+      encoded += HEX[c & 15];
+    }
+  }
+  return encoded;
+}
+
+// The value of the given metric in the Prometheus text format, -1 if it is
+// not there.
+double metricValue(const string& metrics, const string& name)
+{
+  string prefix = "\n" + name + " ";
+  size_t pos = metrics.find(prefix);
+  if (pos == string::npos) return -1;
+  return atof(metrics.c_str() + pos + prefix.size());
+}
+
+// The resources used by a process: CPU seconds (user and system) and the
+// maximal resident set size in bytes.
+struct ResourceUsage
+{
+  double cpuSecs;
+  double maxResidentBytes;
+  // For HTTP, the history counters of the server.
+  double nofQueriesFromHistory;
+  double nofQueriesByFiltering;
+};
+
+// The resources used by this process.
+ResourceUsage ownResourceUsage()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  ResourceUsage result;
+  result.cpuSecs = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  result.maxResidentBytes = usage.ru_maxrss * 1024.0;
+  result.nofQueriesFromHistory = -1;
+  result.nofQueriesByFiltering = -1;
+  return result;
+}
+
+// The resources used by the server, from its /metrics (all -1 if they cannot
+// be read).
+ResourceUsage serverResourceUsage(HttpClient* client)
+{
+  string metrics;
+  try
+  {
+    HttpResponse response = client->get("/metrics");
+    if (response.status != 200)
+      CS_THROW(Exception::OTHER, "/metrics returned " << response.status);
+    metrics = "\n" + response.body;
+  }
+  catch(const Exception& e)
+  {
+    cerr << "! " << e.getFullErrorMessage() << endl;
+  }
+  ResourceUsage result;
+  result.cpuSecs = metricValue(metrics, "completesearch_process_cpu_seconds");
+  result.maxResidentBytes
+    = metricValue(metrics, "completesearch_process_max_resident_bytes");
+  result.nofQueriesFromHistory
+    = metricValue(metrics, "completesearch_history_hits_total");
+  result.nofQueriesByFiltering
+    = metricValue(metrics, "completesearch_history_filtered_total");
+  return result;
+}
+
+// Drop the given file from the page cache (only clean pages are dropped).
+void dropFromPageCache(const string& fileName)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+// _____________________________________________________________________________
+int main(int argc, char** argv)
+{
+  size_t nofClients = 1;
+  double qps = 0;
+  bool warmCache = false;
+  string jsonFileName;
+  string httpParameters;
+  string mapsDirectory = "codebase/utility";
+  fuzzySearchEnabled = false;
+  while (true)
+  {
+    int c = getopt(argc, argv, "c:Q:wj:p:h:L:M:Y");
+    if (c == -1) break;
+    switch (c)
+    {
+      case 'c': nofClients = atoi(optarg); break;
+      case 'Q': qps = atof(optarg); break;
+      case 'w': warmCache = true; break;
+      case 'j': jsonFileName = optarg; break;
+      case 'p': httpParameters = optarg; break;
+      case 'h': historyMaxSizeInBytes = atoi_ext(optarg); break;
+      case 'L': localeString = optarg; break;
+      case 'M': mapsDirectory = optarg; break;
+      case 'Y': fuzzySearchEnabled = true; break;
+      default: printUsage(); exit(1);
+    }
+  }
+  if (optind + 2 != argc || nofClients == 0)
+  {
+    printUsage();
+    exit(1);
+  }
+  string logFileName = argv[optind];
+  string target = argv[optind + 1];
+  size_t colon = target.rfind(':');
+  bool overHttp = colon != string::npos
+    && target.find_first_not_of("0123456789", colon + 1) == string::npos;
+
+  QueryLog log;
+  try
+  {
+    log.read(logFileName);
+  }
+  catch(const Exception& e)
+  {
+    cerr << "! " << e.getFullErrorMessage() << endl;
+    exit(1);
+  }
+  cout << "* read " << log.getNofQueries() << " queries in "
+       << log.getSessions().size() << " sessions from \"" << logFileName
+       << "\"" << endl;
+
+  QueryReplayer replayer(log, nofClients, qps);
+  ReplayStatistics statistics;
+  ResourceUsage before, after;
+  double secs;
+  logVerbosity = LogVerbosity::ZERO;
+
+  if (overHttp)
+  {
+    string host = target.substr(0, colon);
+    string port = target.substr(colon + 1);
+    vector<HttpClient*> clients;
+    for (size_t i = 0; i < nofClients; i++)
+      clients.push_back(new HttpClient(host, port));
+    string parameters = httpParameters.empty() ? "" : "&" + httpParameters;
+    QueryReplayer::AnswerFunction answer =
+      [&](size_t client, const string& query)
+    {
+      HttpResponse response
+        = clients[client]->get("/?q=" + urlEncode(query) + parameters);
+      if (response.status != 200)
+        CS_THROW(Exception::OTHER, "status " << response.status);
+      return ReplayStatistics::UNKNOWN;
+    };
+    if (warmCache)
+    {
+      cout << "* warming up ... " << flush;
+      replayer.run(answer, NULL);
+      cout << "done" << endl;
+    }
+    HttpClient metricsClient(host, port);
+    before = serverResourceUsage(&metricsClient);
+    cout << "* replaying against " << target << " ... " << flush;
+    secs = replayer.run(answer, &statistics);
+    cout << "done" << endl;
+    after = serverResourceUsage(&metricsClient);
+    for (size_t i = 0; i < clients.size(); i++) delete clients[i];
+  }
+  else
+  {
+    if (globalStringConverter.init(mapsDirectory) == false)
+    {
+      cerr << "! " << globalStringConverter.getLastError() << endl;
+      exit(1);
+    }
+    bool isUtf8 = localeString.empty()
+      || localeString.find("utf8") != string::npos;
+    if (!localeString.empty()) setlocale(LC_ALL, localeString.c_str());
+    encoding = isUtf8 ? Encoding::UTF8 : Encoding::ISO88591;
+    string vocFileName = target;
+    vocFileName = vocFileName.erase(vocFileName.rfind('.')) + ".vocabulary";
+    if (!warmCache)
+    {
+      dropFromPageCache(target);
+      dropFromPageCache(vocFileName);
+    }
+    typedef HybCompleter<WITH_DUPS + WITH_POS + WITH_SCORES> Completer;
+    HYBIndex index(target, vocFileName, Completer::mode());
+    index.read();
+    FuzzySearch::FuzzySearcherBase* fuzzySearcher = &nullFuzzySearcher;
+    if (fuzzySearchEnabled)
+    {
+      baseName = target.substr(0, target.rfind('.'));
+      if (isUtf8) fuzzySearcher = new FuzzySearch::FuzzySearcherUtf8();
+      else fuzzySearcher = new FuzzySearch::FuzzySearcherIso88591();
+      fuzzySearcher->init(baseName);
+    }
+    TimedHistory history;
+    pthread_mutex_t clientsMutex = PTHREAD_MUTEX_INITIALIZER;
+    size_t nofClientsInQuery = 0;
+    QueryReplayer::AnswerFunction answer =
+      [&](size_t client, const string& queryString)
+    {
+      // Like CompletionServer::processRequest: a completer per query, all
+      // sharing the index and the history. The history is cut down after a
+      // query only if no other client is processing one (see there).
+      Completer completer(&index, &history, fuzzySearcher);
+      completer.log.setId(client);
+      QueryParameters queryParameters;
+      completer.setQueryParameters(queryParameters);
+      Query query(queryString);
+      completer.setQuery(query);
+      QueryResult* result = NULL;
+      pthread_mutex_lock(&clientsMutex);
+      ++nofClientsInQuery;
+      pthread_mutex_unlock(&clientsMutex);
+      try
+      {
+        completer.processQuery(query, result);
+      }
+      catch (...)
+      {
+        pthread_mutex_lock(&clientsMutex);
+        --nofClientsInQuery;
+        pthread_mutex_unlock(&clientsMutex);
+        throw;
+      }
+      ReplayStatistics::Outcome outcome = result->wasInHistory
+        ? ReplayStatistics::FROM_HISTORY
+        : !result->resultWasFilteredFrom.empty()
+          ? ReplayStatistics::FILTERED : ReplayStatistics::COMPUTED;
+      pthread_mutex_lock(&clientsMutex);
+      if (nofClientsInQuery == 1)
+        history.cutToSizeAndNumber(historyMaxSizeInBytes,
+                                   historyMaxNofQueries);
+      --nofClientsInQuery;
+      pthread_mutex_unlock(&clientsMutex);
+      return outcome;
+    };
+    if (warmCache)
+    {
+      cout << "* warming up ... " << flush;
+      replayer.run(answer, NULL);
+      cout << "done" << endl;
+    }
+    before = ownResourceUsage();
+    cout << "* replaying against " << target << " ... " << flush;
+    secs = replayer.run(answer, &statistics);
+    cout << "done" << endl;
+    after = ownResourceUsage();
+  }
+
+  // Summary over all queries.
+  const Histogram& all = statistics.getHistogram(0);
+  uint64_t nofErrors = statistics.getCount(0, ReplayStatistics::FAILED);
+  double fromHistory = overHttp
+    ? after.nofQueriesFromHistory - before.nofQueriesFromHistory
+    : statistics.getCount(0, ReplayStatistics::FROM_HISTORY);
+  double byFiltering = overHttp
+    ? after.nofQueriesByFiltering - before.nofQueriesByFiltering
+    : statistics.getCount(0, ReplayStatistics::FILTERED);
+  double nofAnswered = all.count() > 0 ? all.count() : 1;
+  double cpuSecs = after.cpuSecs - before.cpuSecs;
+
+  cout << endl;
+  statistics.writeTable(cout);
+  cout << endl << std::fixed << std::setprecision(2)
+       << "queries: " << all.count() + nofErrors << " in " << secs
+       << " secs (" << (all.count() + nofErrors) / secs << " per sec), "
+       << nofErrors << " errors" << endl
+       << "history hits: " << 100 * fromHistory / nofAnswered
+       << "% from the history, " << 100 * byFiltering / nofAnswered
+       << "% by filtering" << endl
+       << "cpu: " << cpuSecs << " secs, max resident: "
+       << after.maxResidentBytes / (1024 * 1024) << " MB"
+       << (overHttp ? " (server)" : "") << endl << endl;
+
+  if (!jsonFileName.empty())
+  {
+    std::ofstream json(jsonFileName.c_str());
+    json << std::fixed << std::setprecision(3)
+         << "{" << endl
+         << "  \"backend\": \"" << (overHttp ? "http" : "in-process")
+         << "\"," << endl
+         << "  \"cache\": \"" << (warmCache ? "warm" : "cold") << "\"," << endl
+         << "  \"clients\": " << nofClients << "," << endl
+         << "  \"target_qps\": " << qps << "," << endl
+         << "  \"queries\": " << all.count() + nofErrors << "," << endl
+         << "  \"errors\": " << nofErrors << "," << endl
+         << "  \"seconds\": " << secs << "," << endl
+         << "  \"qps\": " << (all.count() + nofErrors) / secs << "," << endl
+         << "  \"history_hit_rate\": " << fromHistory / nofAnswered << ","
+         << endl
+         << "  \"filtered_rate\": " << byFiltering / nofAnswered << "," << endl
+         << "  \"cpu_seconds\": " << cpuSecs << "," << endl
+         << "  \"max_resident_bytes\": "
+         << std::setprecision(0) << after.maxResidentBytes << "," << endl
+         << "  \"classes\": {" << endl;
+    statistics.writeJson(json, "    ");
+    json << "  }" << endl << "}" << endl;
+    if (!json)
+    {
+      cerr << "! ERROR writing \"" << jsonFileName << "\"" << endl;
+      exit(1);
+    }
+    cout << "* wrote results to \"" << jsonFileName << "\"" << endl;
+  }
+  return 0;
+}
+
+// _____________________________________________________________________________
+// CONVERT TO INTEGER
+// accepting things like 10K (=10*1024) or 10M (=10*1024*1024)
+size_t atoi_ext(string s)
+{
+  if (s.length() == 0) return 0;
+  switch (s[s.length()-1])
+  {
+    case 'k': case 'K':
+      return (size_t)(atoi(s.substr(0, s.length()-1).c_str()))*1024;
+    case 'm': case 'M':
+      return (size_t)(atoi(s.substr(0, s.length()-1).c_str()))*1024*1024;
+    case 'g': case 'G':
+      return (size_t)(atoi(s.substr(0, s.length()-1).c_str()))*1024*1024*1024;
+    default:
+      return (size_t)(atoi(s.c_str()));
+  }
+}